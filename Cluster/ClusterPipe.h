@@ -84,6 +84,27 @@ class ClusterPipe
 	virtual void couple(bool newReadCoupled,bool newWriteCoupled); // Couples or decouples the reading and writing side of the pipe
 	virtual void barrier(void); // Blocks the calling thread until all nodes in a cluster pipe have reached the same point in the program
 	virtual unsigned int gather(unsigned int value,GatherOperation::OpCode op); // Blocks the calling thread until all nodes in a cluster pipe have exchanged a value; returns final accumulated value
+	template <class ValueParam>
+	void gather(ValueParam* values,size_t numValues,GatherOperation::OpCode op) // Blocks the calling thread until all nodes in a cluster pipe have exchanged an array of values of the same size; replaces the array with the element-wise accumulated values
+		{
+		/* Send any unsent data and exchange the values in a single round: */
+		flushPipe();
+		multiplexer->gather(pipeId,values,numValues,GatherValueType<ValueParam>::valueType,op);
+		}
+	template <class ValueParam>
+	void allGather(const ValueParam& value,ValueParam* values) // Blocks the calling thread until all nodes in a cluster pipe have exchanged a value; stores all nodes' values in order of node index in the given array of size getNumNodes()
+		{
+		/* Send any unsent data and exchange the values in a single round: */
+		flushPipe();
+		multiplexer->allGather(pipeId,&value,sizeof(ValueParam),values);
+		}
+	template <class ValueParam>
+	void allGather(const ValueParam* value,size_t numValues,ValueParam* values) // Ditto for arrays of values of the same size; stores all nodes' arrays back-to-back
+		{
+		/* Send any unsent data and exchange the values in a single round: */
+		flushPipe();
+		multiplexer->allGather(pipeId,value,numValues*sizeof(ValueParam),values);
+		}
 	};
 
 }
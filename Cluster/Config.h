@@ -23,9 +23,18 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #define CLUSTER_CONFIG_INCLUDED
 
 #define CLUSTER_CONFIG_MTU_SIZE 1500
+#define CLUSTER_CONFIG_MIN_MTU_SIZE 576
+#define CLUSTER_CONFIG_MAX_MTU_SIZE 9000
 #define CLUSTER_CONFIG_IP_HEADER_SIZE 20
 #define CLUSTER_CONFIG_UDP_HEADER_SIZE 8
 
+#define CLUSTER_CONFIG_MAX_BATCH_SIZE 32
+#ifdef __linux__
+#define CLUSTER_CONFIG_HAVE_MMSG 1
+#else
+#define CLUSTER_CONFIG_HAVE_MMSG 0
+#endif
+
 #define CLUSTER_CONFIG_DEBUG_MULTIPLEXER 0
 #define CLUSTER_CONFIG_DEBUG_MULTIPLEXER_VERBOSE 0
 
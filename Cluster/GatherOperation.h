@@ -24,6 +24,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef CLUSTER_GATHEROPERATION_INCLUDED
 #define CLUSTER_GATHEROPERATION_INCLUDED
 
+#include <stddef.h>
+
 namespace Cluster {
 
 class GatherOperation
@@ -36,6 +38,68 @@ class GatherOperation
 		MIN,MAX, // Range operations
 		SUM,PRODUCT // Arithmetic operations
 		};
+	
+	enum ValueType // Enumerated type for value types supported by vector gathering operations
+		{
+		INT,UINT, // Integer types
+		FLOAT,DOUBLE // Floating-point types
+		};
+	
+	/* Methods: */
+	static size_t getValueSize(ValueType valueType) // Returns the size of a single value of the given type in bytes
+		{
+		switch(valueType)
+			{
+			case INT:
+				return sizeof(int);
+			
+			case UINT:
+				return sizeof(unsigned int);
+			
+			case FLOAT:
+				return sizeof(float);
+			
+			case DOUBLE:
+				return sizeof(double);
+			}
+		
+		return 0;
+		}
+	};
+
+template <class ValueParam>
+class GatherValueType; // Helper class to map C++ types to vector gathering value types; only defined for supported types
+
+template <>
+class GatherValueType<int>
+	{
+	/* Elements: */
+	public:
+	static const GatherOperation::ValueType valueType=GatherOperation::INT;
+	};
+
+template <>
+class GatherValueType<unsigned int>
+	{
+	/* Elements: */
+	public:
+	static const GatherOperation::ValueType valueType=GatherOperation::UINT;
+	};
+
+template <>
+class GatherValueType<float>
+	{
+	/* Elements: */
+	public:
+	static const GatherOperation::ValueType valueType=GatherOperation::FLOAT;
+	};
+
+template <>
+class GatherValueType<double>
+	{
+	/* Elements: */
+	public:
+	static const GatherOperation::ValueType valueType=GatherOperation::DOUBLE;
 	};
 
 }
@@ -47,7 +47,7 @@ size_t MulticastPipe::readData(IO::File::Byte* buffer,size_t bufferSize)
 	packet=multiplexer->receivePacket(pipeId);
 	
 	/* Install the new packet as the buffered file's read buffer: */
-	setReadBuffer(Packet::maxPacketSize,reinterpret_cast<Byte*>(packet->packet),false);
+	setReadBuffer(packet->capacity,reinterpret_cast<Byte*>(packet->packet),false);
 	
 	return packet->packetSize;
 	}
@@ -64,7 +64,7 @@ void MulticastPipe::writeData(const IO::File::Byte* buffer,size_t bufferSize)
 	
 	/* Install a fresh cluster packet as the write buffer: */
 	packet=multiplexer->newPacket();
-	setWriteBuffer(Packet::maxPacketSize,reinterpret_cast<Byte*>(packet->packet),false);
+	setWriteBuffer(multiplexer->getMaxPacketSize(),reinterpret_cast<Byte*>(packet->packet),false);
 	}
 
 size_t MulticastPipe::writeDataUpTo(const IO::File::Byte* buffer,size_t bufferSize)
@@ -79,7 +79,7 @@ size_t MulticastPipe::writeDataUpTo(const IO::File::Byte* buffer,size_t bufferSi
 	
 	/* Install a fresh cluster packet as the write buffer: */
 	packet=multiplexer->newPacket();
-	setWriteBuffer(Packet::maxPacketSize,reinterpret_cast<Byte*>(packet->packet),false);
+	setWriteBuffer(multiplexer->getMaxPacketSize(),reinterpret_cast<Byte*>(packet->packet),false);
 	
 	return bufferSize;
 	}
@@ -99,7 +99,7 @@ MulticastPipe::MulticastPipe(Multiplexer* sMultiplexer)
 		{
 		/* Install a fresh cluster packet as the write buffer: */
 		packet=multiplexer->newPacket();
-		setWriteBuffer(Packet::maxPacketSize,reinterpret_cast<Byte*>(packet->packet),false);
+		setWriteBuffer(multiplexer->getMaxPacketSize(),reinterpret_cast<Byte*>(packet->packet),false);
 		
 		/* Disable direct writes: */
 		canWriteThrough=false;
@@ -145,19 +145,19 @@ MulticastPipe::~MulticastPipe(void)
 size_t MulticastPipe::getReadBufferSize(void) const
 	{
 	/* Return the maximum cluster packet size: */
-	return Packet::maxPacketSize;
+	return multiplexer->getMaxPacketSize();
 	}
 
 size_t MulticastPipe::getWriteBufferSize(void) const
 	{
 	/* Return the maximum cluster packet size: */
-	return Packet::maxPacketSize;
+	return multiplexer->getMaxPacketSize();
 	}
 
 size_t MulticastPipe::resizeReadBuffer(size_t newReadBufferSize)
 	{
 	/* Ignore the request and return the maximum cluster packet size: */
-	return Packet::maxPacketSize;
+	return multiplexer->getMaxPacketSize();
 	}
 
 void MulticastPipe::resizeWriteBuffer(size_t newWriteBufferSize)
@@ -29,6 +29,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
@@ -70,7 +71,7 @@ Multiplexer::PipeState::PacketList::~PacketList(void)
 	while(head!=0)
 		{
 		Packet* succ=head->succ;
-		delete head;
+		Packet::destroy(head);
 		head=succ;
 		}
 	}
@@ -123,7 +124,8 @@ Multiplexer::PipeState::PipeState(unsigned int nodeIndex,unsigned int numSlaves)
 	 headStreamPos(0),
 	 slaveStreamPosOffsets(0),numHeadSlaves(0),
 	 barrierId(0),slaveBarrierIds(0),minSlaveBarrierId(0),
-	 slaveGatherValues(0)
+	 slaveGatherValues(0),
+	 slaveGatherData(0),slaveGatherDataSizes(0),gatherData(0),gatherDataSize(0)
 	 #if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 	 ,
 	 numResentPackets(0),numResentBytes(0)
@@ -162,6 +164,11 @@ Multiplexer::PipeState::~PipeState(void)
 	
 	/* Destroy slave gather value array: */
 	delete[] slaveGatherValues;
+	
+	/* Destroy gather data buffers: */
+	delete[] slaveGatherData;
+	delete[] slaveGatherDataSizes;
+	delete[] gatherData;
 	}
 	}
 
@@ -183,7 +190,8 @@ struct Message // Structure for protocol messages exchanged between master and s
 		ACKNOWLEDGMENT, // Signal that slave has received some stream packets
 		PACKETLOSS, // Signal that slave lost a stream packet
 		BARRIER, // Barrier message sent from slaves to master
-		GATHER // Message conveying a slave's gather value in a gather operation
+		GATHER, // Message conveying a slave's gather value in a gather operation
+		GATHERDATA // Message conveying a slave's gather data or the final gather data in a vector gather operation
 		};
 	
 	/* Elements: */
@@ -197,6 +205,19 @@ struct Message // Structure for protocol messages exchanged between master and s
 		}
 	};
 
+struct ConnectionMessage:public Message
+	{
+	/* Elements: */
+	public:
+	unsigned int mtuSize; // MTU size of packets sent by the master
+	
+	/* Constructors and destructors: */
+	ConnectionMessage(unsigned int sMTUSize)
+		:Message(0,CONNECTION),mtuSize(sMTUSize)
+		{
+		}
+	};
+
 struct PipeMessage:public Message
 	{
 	/* Elements: */
@@ -268,6 +289,68 @@ struct GatherMessage:public BarrierMessage
 		}
 	};
 
+struct GatherDataMessage:public BarrierMessage
+	{
+	/* Elements: */
+	public:
+	unsigned int dataSize; // Size of the gather data following the message header in bytes
+	
+	/* Constructors and destructors: */
+	GatherDataMessage(unsigned int sNodeIndex,unsigned int sPipeId,unsigned int sBarrierId,unsigned int sDataSize)
+		:BarrierMessage(sNodeIndex,GATHERDATA,sPipeId,sBarrierId),
+		 dataSize(sDataSize)
+		{
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+inline size_t calcMaxGatherDataSize(size_t mtuSize) // Returns the largest multiple of the size of a double that fits into a single gather data datagram of the given MTU size
+	{
+	return (Packet::getRawPacketSize(mtuSize)-sizeof(GatherDataMessage))&~size_t(sizeof(double)-1);
+	}
+
+template <class ValueParam>
+inline void accumulateValues(ValueParam* values,const ValueParam* otherValues,size_t numValues,GatherOperation::OpCode op) // Accumulates the given other values into the given values element-wise
+	{
+	switch(op)
+		{
+		case GatherOperation::AND:
+			for(size_t i=0;i<numValues;++i)
+				values[i]=values[i]&&otherValues[i];
+			break;
+		
+		case GatherOperation::OR:
+			for(size_t i=0;i<numValues;++i)
+				values[i]=values[i]||otherValues[i];
+			break;
+		
+		case GatherOperation::MIN:
+			for(size_t i=0;i<numValues;++i)
+				if(values[i]>otherValues[i])
+					values[i]=otherValues[i];
+			break;
+		
+		case GatherOperation::MAX:
+			for(size_t i=0;i<numValues;++i)
+				if(values[i]<otherValues[i])
+					values[i]=otherValues[i];
+			break;
+		
+		case GatherOperation::SUM:
+			for(size_t i=0;i<numValues;++i)
+				values[i]+=otherValues[i];
+			break;
+		
+		case GatherOperation::PRODUCT:
+			for(size_t i=0;i<numValues;++i)
+				values[i]*=otherValues[i];
+			break;
+		}
+	}
+
 }
 
 /****************************
@@ -276,7 +359,31 @@ Methods of class Multiplexer:
 
 Packet* Multiplexer::allocatePacket(void)
 	{
-	return new Packet;
+	return Packet::create(maxPacketSize);
+	}
+
+void Multiplexer::updateMTUSize(size_t newMTUSize)
+	{
+	/* Limit the MTU size to the supported range: */
+	if(newMTUSize>CLUSTER_CONFIG_MAX_MTU_SIZE)
+		newMTUSize=CLUSTER_CONFIG_MAX_MTU_SIZE;
+	if(newMTUSize<CLUSTER_CONFIG_MIN_MTU_SIZE)
+		newMTUSize=CLUSTER_CONFIG_MIN_MTU_SIZE;
+	
+	Threads::Spinlock::Lock packetPoolLock(packetPoolMutex);
+	
+	/* Calculate the new maximum payload size of packets: */
+	mtuSize=newMTUSize;
+	maxPacketSize=Packet::getMaxPacketSize(mtuSize);
+	maxGatherDataSize=calcMaxGatherDataSize(mtuSize);
+	
+	/* Delete all pooled packets, which were allocated for the previous MTU size: */
+	while(packetPoolHead!=0)
+		{
+		Packet* succ=packetPoolHead->succ;
+		Packet::destroy(packetPoolHead);
+		packetPoolHead=succ;
+		}
 	}
 
 void Multiplexer::processAcknowledgment(Multiplexer::LockedPipe& pipeState,int slaveIndex,unsigned int streamPos)
@@ -356,416 +463,871 @@ void Multiplexer::processAcknowledgment(Multiplexer::LockedPipe& pipeState,int s
 		}
 	}
 
-void* Multiplexer::packetHandlingThreadMaster(void)
+void Multiplexer::resendPackets(Multiplexer::LockedPipe& pipeState,Packet* packet)
 	{
-	Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
-	// Threads::Thread::setCancelType(Threads::Thread::CANCEL_ASYNCHRONOUS);
+	// SocketMutex::Lock socketLock(socketMutex);
+	#if CLUSTER_CONFIG_HAVE_MMSG
 	
-	/* Handle message exchange during multiplexer initialization: */
-	bool* slaveConnecteds=new bool[numSlaves];
-	for(unsigned int i=0;i<numSlaves;++i)
-		slaveConnecteds[i]=false;
-	unsigned int numConnectedSlaves=0;
-	while(numConnectedSlaves<numSlaves)
+	/* Resend the packets in batches of at most the current batch size: */
+	struct iovec iovecs[CLUSTER_CONFIG_MAX_BATCH_SIZE];
+	struct mmsghdr messages[CLUSTER_CONFIG_MAX_BATCH_SIZE];
+	unsigned int maxNumMessages=batchSize;
+	while(packet!=0)
 		{
-		/* Wait for a connection initialization packet: */
-		ssize_t numBytesReceived=recv(socketFd,messageBuffer,Packet::maxRawPacketSize,0);
-		if(numBytesReceived==sizeof(Message))
+		/* Collect the next batch of packets: */
+		unsigned int numMessages;
+		for(numMessages=0;numMessages<maxNumMessages&&packet!=0;++numMessages,packet=packet->succ)
 			{
-			Message* msg=static_cast<Message*>(messageBuffer);
-			if(msg->nodeIndex&0x80000000U) // Check if the message is from a slave
-				{
-				unsigned int slaveIndex=(msg->nodeIndex&0x7fffffffU)-1;
-				if(msg->messageId==Message::CONNECTION&&slaveIndex<numSlaves&&!slaveConnecteds[slaveIndex])
-					{
-					/* Mark the slave as connected: */
-					slaveConnecteds[slaveIndex]=true;
-					++numConnectedSlaves;
-					}
-				}
+			iovecs[numMessages].iov_base=&packet->pipeId;
+			iovecs[numMessages].iov_len=packet->packetSize+2*sizeof(unsigned int);
+			memset(&messages[numMessages].msg_hdr,0,sizeof(struct msghdr));
+			messages[numMessages].msg_hdr.msg_name=otherAddress;
+			messages[numMessages].msg_hdr.msg_namelen=sizeof(sockaddr_in);
+			messages[numMessages].msg_hdr.msg_iov=&iovecs[numMessages];
+			messages[numMessages].msg_hdr.msg_iovlen=1;
+			#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+			++pipeState->numResentPackets;
+			pipeState->numResentBytes+=packet->packetSize;
+			#endif
+			}
+		
+		/* Send the batch; drop its remainder on errors like sendto would, and let the slaves ask again: */
+		unsigned int numSent=0;
+		while(numSent<numMessages)
+			{
+			int sendResult=sendmmsg(socketFd,messages+numSent,numMessages-numSent,0);
+			if(sendResult<=0)
+				break;
+			numSent+=(unsigned int)sendResult;
 			}
 		}
-	delete[] slaveConnecteds;
 	
-	/* Send connection message to slaves: */
-	Message msg(0,Message::CONNECTION);
+	#else
+	
+	/* Resend the packets one at a time: */
+	for(;packet!=0;packet=packet->succ)
+		{
+		sendto(socketFd,&packet->pipeId,packet->packetSize+2*sizeof(unsigned int),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
+		#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+		++pipeState->numResentPackets;
+		pipeState->numResentBytes+=packet->packetSize;
+		#endif
+		}
+	
+	#endif
+	}
+
+void Multiplexer::resetFlowControl(Multiplexer::LockedPipe& pipeState)
+	{
+	/* Reset the pipe's flow control state: */
+	pipeState->headStreamPos=pipeState->streamPos;
+	for(unsigned int i=0;i<numSlaves;++i)
+		pipeState->slaveStreamPosOffsets[i]=0;
+	pipeState->numHeadSlaves=numSlaves;
+	
+	/* Add all packets in the list to the list of free packets: */
+	if(pipeState->packetList.numPackets>0)
+		{
+		{
+		Threads::Spinlock::Lock packetPoolLock(packetPoolMutex);
+		pipeState->packetList.tail->succ=packetPoolHead;
+		packetPoolHead=pipeState->packetList.head;
+		}
+		pipeState->packetList.numPackets=0;
+		pipeState->packetList.head=0;
+		pipeState->packetList.tail=0;
+		}
+	}
+
+void Multiplexer::sendGatherData(unsigned int pipeId,unsigned int barrierId,const void* data,size_t dataSize)
+	{
+	/* Send the message header and the gather data as a single datagram without copying the data: */
+	GatherDataMessage msg(nodeIndex!=0?nodeIndex|0x80000000U:0U,pipeId,barrierId,(unsigned int)dataSize);
+	struct iovec iovecs[2];
+	iovecs[0].iov_base=&msg;
+	iovecs[0].iov_len=sizeof(GatherDataMessage);
+	iovecs[1].iov_base=const_cast<void*>(data);
+	iovecs[1].iov_len=dataSize;
+	struct msghdr message;
+	memset(&message,0,sizeof(struct msghdr));
+	message.msg_name=otherAddress;
+	message.msg_namelen=sizeof(sockaddr_in);
+	message.msg_iov=iovecs;
+	message.msg_iovlen=2;
 	{
 	// SocketMutex::Lock socketLock(socketMutex);
-	for(int i=0;i<masterMessageBurstSize;++i)
-		sendto(socketFd,&msg,sizeof(Message),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
+	sendmsg(socketFd,&message,0);
 	}
-	
-	/* Signal connection establishment: */
+	}
+
+bool Multiplexer::exchangeGatherData(Multiplexer::LockedPipe& pipeState,unsigned int pipeId,unsigned int nextBarrierId,const void* data,size_t dataSize,size_t finalDataSize)
 	{
-	Threads::MutexCond::Lock connectionCondLock(connectionCond);
-	connected=true;
-	connectionCond.broadcast();
+	if(nodeIndex==0)
+		{
+		/* Wait until gather data messages from all slaves have been received: */
+		while(pipeState->minSlaveBarrierId<nextBarrierId)
+			{
+			/* Wait until the next barrier message: */
+			pipeState->barrierCond.wait(pipeState->stateMutex);
+			}
+		
+		/* Mark the gathering operation as completed: */
+		pipeState->barrierId=nextBarrierId;
+		
+		/* Allocate the final gather data buffer on first use: */
+		if(pipeState->gatherData==0)
+			pipeState->gatherData=new unsigned char[maxGatherDataSize];
+		
+		/* Check that all slaves sent the same amount of data as the master: */
+		bool result=true;
+		for(unsigned int i=0;i<numSlaves;++i)
+			result=result&&pipeState->slaveGatherDataSizes[i]==dataSize;
+		return result;
+		}
+	else
+		{
+		/* Send gather data messages to master until gather completion message is received: */
+		Misc::Time waitTimeout=Misc::Time::now();
+		while(pipeState->barrierId<nextBarrierId)
+			{
+			/* Send gather data message to master: */
+			sendGatherData(pipeId,nextBarrierId,data,dataSize);
+			
+			/* Wait for arrival of gather completion message: */
+			waitTimeout+=barrierWaitTimeout;
+			pipeState->barrierCond.timedWait(pipeState->stateMutex,waitTimeout);
+			}
+		
+		/* The master sends empty final data if the nodes' data sizes did not match: */
+		return pipeState->gatherDataSize==finalDataSize;
+		}
 	}
-	
-	/* Handle messages from the slaves: */
-	while(true)
+
+void Multiplexer::processSlaveMessage(void* messageBuffer,size_t numBytesReceived)
+	{
+	if(numBytesReceived>=sizeof(Message))
 		{
-		/* Wait for a message from any slave: */
-		ssize_t numBytesReceived=recv(socketFd,messageBuffer,Packet::maxRawPacketSize,0);
-		if(numBytesReceived>0&&size_t(numBytesReceived)>=sizeof(Message))
+		/* Check that the message is not the echo of a server message: */
+		if(static_cast<Message*>(messageBuffer)->nodeIndex&0x80000000U)
 			{
-			/* Check that the message is not the echo of a server message: */
-			if(static_cast<Message*>(messageBuffer)->nodeIndex&0x80000000U)
+			/* Remove the slave message indicator bit from the message's node index: */
+			unsigned int msgNodeIndex=static_cast<Message*>(messageBuffer)->nodeIndex&0x7fffffffU;
+			
+			switch(static_cast<Message*>(messageBuffer)->messageId)
 				{
-				/* Remove the slave message indicator bit from the message's node index: */
-				unsigned int msgNodeIndex=static_cast<Message*>(messageBuffer)->nodeIndex&0x7fffffffU;
+				case Message::CONNECTION:
+					{
+					/* One slave must have missed the connection establishment packet; send another one: */
+					ConnectionMessage msg(mtuSize);
+					{
+					// SocketMutex::Lock socketLock(socketMutex);
+					sendto(socketFd,&msg,sizeof(ConnectionMessage),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
+					}
+					break;
+					}
 				
-				switch(static_cast<Message*>(messageBuffer)->messageId)
+				case Message::PING:
 					{
-					case Message::CONNECTION:
-						{
-						/* One slave must have missed the connection establishment packet; send another one: */
-						Message msg(0,Message::CONNECTION);
-						{
-						// SocketMutex::Lock socketLock(socketMutex);
-						sendto(socketFd,&msg,sizeof(Message),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
-						}
-						break;
-						}
-					
-					case Message::PING:
-						{
-						/* Broadcast a ping reply to all slaves: */
-						Message msg(0,Message::PING);
+					/* Broadcast a ping reply to all slaves: */
+					Message msg(0,Message::PING);
+					{
+					// SocketMutex::Lock socketLock(socketMutex);
+					sendto(socketFd,&msg,sizeof(Message),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
+					}
+					break;
+					}
+				
+				case Message::CREATEPIPE1:
+					{
+					CreatePipe1Message* msg=static_cast<CreatePipe1Message*>(messageBuffer);
+					if(numBytesReceived>=sizeof(CreatePipe1Message)&&numBytesReceived==sizeof(CreatePipe1Message)+msg->idNumParts*sizeof(unsigned int))
 						{
-						// SocketMutex::Lock socketLock(socketMutex);
-						sendto(socketFd,&msg,sizeof(Message),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
-						}
-						break;
-						}
-					
-					case Message::CREATEPIPE1:
+						/* Extract the originating thread's ID from the message: */
+						Threads::Thread::ID senderId(msg->idNumParts,reinterpret_cast<unsigned int*>(msg+1));
+						
+						/* Find the new pipe state corresponding to the thread ID: */
+						PipeState* newPipeState;
 						{
-						CreatePipe1Message* msg=static_cast<CreatePipe1Message*>(messageBuffer);
-						if(size_t(numBytesReceived)>=sizeof(CreatePipe1Message)&&size_t(numBytesReceived)==sizeof(CreatePipe1Message)+msg->idNumParts*sizeof(unsigned int))
+						Threads::Mutex::Lock pipeStateTableLock(pipeStateTableMutex);
+						NewPipeHasher::Iterator npIt=newPipes.findEntry(senderId);
+						if(npIt.isFinished())
 							{
-							/* Extract the originating thread's ID from the message: */
-							Threads::Thread::ID senderId(msg->idNumParts,reinterpret_cast<unsigned int*>(msg+1));
+							/* If the new pipe state hasn't been created already, do it here: */
+							newPipeState=new PipeState(nodeIndex,numSlaves);
 							
-							/* Find the new pipe state corresponding to the thread ID: */
-							PipeState* newPipeState;
+							/* Add the new pipe state to the new pipe map: */
+							newPipes[senderId]=newPipeState;
+							}
+						else
+							newPipeState=npIt->getDest();
+						}
+						
+						/* Lock the new pipe: */
+						LockedPipe pipeState(newPipeState);
+						
+						/* Check the pipe's barrier state for first-stage completion: */
+						bool sendReply=false;
+						if(pipeState->barrierId<1)
 							{
-							Threads::Mutex::Lock pipeStateTableLock(pipeStateTableMutex);
-							NewPipeHasher::Iterator npIt=newPipes.findEntry(senderId);
-							if(npIt.isFinished())
+							/* Remember the slave's barrier completion: */
+							pipeState->slaveBarrierIds[msgNodeIndex-1]=1;
+							
+							/* Check if the current barrier is complete: */
+							pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[0];
+							for(unsigned int i=1;i<numSlaves;++i)
+								if(pipeState->minSlaveBarrierId>pipeState->slaveBarrierIds[i])
+									pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[i];
+							if(pipeState->minSlaveBarrierId>=1)
 								{
-								/* If the new pipe state hasn't been created already, do it here: */
-								newPipeState=new PipeState(nodeIndex,numSlaves);
+								/* Complete the first barrier: */
+								pipeState->barrierId=1;
+								
+								/* Assign a pipe ID to the new pipe and store it in the pipe state table: */
+								Threads::Mutex::Lock pipeStateTableLock(pipeStateTableMutex);
+								do
+									{
+									++lastPipeId;
+									if(lastPipeId==0x80000000U) // Ensure that pipeId never has the MSB set
+										lastPipeId=1;
+									}
+								while(pipeStateTable.isEntry(lastPipeId));
+								pipeState->pipeId=lastPipeId;
+								pipeStateTable[lastPipeId]=newPipeState;
 								
-								/* Add the new pipe state to the new pipe map: */
-								newPipes[senderId]=newPipeState;
+								/* Wake up the thread blocked on the new pipe: */
+								pipeState->barrierCond.signal();
+								
+								/* Send a stage-one pipe creation completion message: */
+								sendReply=true;
 								}
-							else
-								newPipeState=npIt->getDest();
 							}
-							
-							/* Lock the new pipe: */
-							LockedPipe pipeState(newPipeState);
-							
-							/* Check the pipe's barrier state for first-stage completion: */
-							bool sendReply=false;
-							if(pipeState->barrierId<1)
+						else
+							{
+							/* One slave must have missed a stage-one pipe creation completion message; send another one: */
+							sendReply=true;
+							}
+						
+						if(sendReply)
+							{
+							CreatePipe1Message* msg2=static_cast<CreatePipe1Message*>(messageBuffer);
+							msg2->nodeIndex=0;
+							msg2->messageId=Message::CREATEPIPE1;
+							msg2->pipeId=pipeState->pipeId;
+							msg2->idNumParts=senderId.getNumParts();
+							for(unsigned int i=0;i<msg2->idNumParts;++i)
+								reinterpret_cast<unsigned int*>(msg2+1)[i]=senderId.getPart(i);
+							{
+							// SocketMutex::Lock socketLock(socketMutex);
+							sendto(socketFd,messageBuffer,sizeof(CreatePipe1Message)+msg2->idNumParts*sizeof(unsigned int),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
+							}
+							}
+						}
+					#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+					else
+						std::cerr<<"Node "<<nodeIndex<<": received CREATEPIPE1 message of wrong size "<<numBytesReceived<<std::endl;
+					#endif
+					break;
+					}
+				
+				case Message::CREATEPIPE2:
+					{
+					if(numBytesReceived==sizeof(PipeMessage))
+						{
+						PipeMessage* msg=static_cast<PipeMessage*>(messageBuffer);
+						
+						/* Get a handle on the state object of the pipe the packet is meant for: */
+						LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
+						
+						if(pipeState.isValid())
+							{
+							/* Check the pipe's barrier state for second-stage completion: */
+							if(pipeState->barrierId<2)
 								{
 								/* Remember the slave's barrier completion: */
-								pipeState->slaveBarrierIds[msgNodeIndex-1]=1;
+								pipeState->slaveBarrierIds[msgNodeIndex-1]=2;
 								
 								/* Check if the current barrier is complete: */
 								pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[0];
 								for(unsigned int i=1;i<numSlaves;++i)
 									if(pipeState->minSlaveBarrierId>pipeState->slaveBarrierIds[i])
 										pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[i];
-								if(pipeState->minSlaveBarrierId>=1)
+								if(pipeState->minSlaveBarrierId>=2)
 									{
-									/* Complete the first barrier: */
-									pipeState->barrierId=1;
-									
-									/* Assign a pipe ID to the new pipe and store it in the pipe state table: */
-									Threads::Mutex::Lock pipeStateTableLock(pipeStateTableMutex);
-									do
-										{
-										++lastPipeId;
-										if(lastPipeId==0x80000000U) // Ensure that pipeId never has the MSB set
-											lastPipeId=1;
-										}
-									while(pipeStateTable.isEntry(lastPipeId));
-									pipeState->pipeId=lastPipeId;
-									pipeStateTable[lastPipeId]=newPipeState;
-									
+									/* Complete the second barrier: */
+									pipeState->barrierId=2;
+
 									/* Wake up the thread blocked on the new pipe: */
 									pipeState->barrierCond.signal();
-									
-									/* Send a stage-one pipe creation completion message: */
-									sendReply=true;
 									}
 								}
-							else
-								{
-								/* One slave must have missed a stage-one pipe creation completion message; send another one: */
-								sendReply=true;
-								}
-							
-							if(sendReply)
-								{
-								CreatePipe1Message* msg2=static_cast<CreatePipe1Message*>(messageBuffer);
-								msg2->nodeIndex=0;
-								msg2->messageId=Message::CREATEPIPE1;
-								msg2->pipeId=pipeState->pipeId;
-								msg2->idNumParts=senderId.getNumParts();
-								for(unsigned int i=0;i<msg2->idNumParts;++i)
-									reinterpret_cast<unsigned int*>(msg2+1)[i]=senderId.getPart(i);
-								{
-								// SocketMutex::Lock socketLock(socketMutex);
-								sendto(socketFd,messageBuffer,sizeof(CreatePipe1Message)+msg2->idNumParts*sizeof(unsigned int),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
-								}
-								}
 							}
 						#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 						else
-							std::cerr<<"Node "<<nodeIndex<<": received CREATEPIPE1 message of wrong size "<<numBytesReceived<<std::endl;
+							std::cerr<<"Node "<<nodeIndex<<": received CREATEPIPE2 message for non-existent pipe "<<msg->pipeId<<std::endl;
 						#endif
-						break;
 						}
-					
-					case Message::CREATEPIPE2:
+					#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+					else
+						std::cerr<<"Node "<<nodeIndex<<": received CREATEPIPE2 message of wrong size "<<numBytesReceived<<std::endl;
+					#endif
+					break;
+					}
+				
+				case Message::ACKNOWLEDGMENT:
+					{
+					if(numBytesReceived==sizeof(StreamMessage))
 						{
-						if(numBytesReceived==sizeof(PipeMessage))
+						StreamMessage* msg=static_cast<StreamMessage*>(messageBuffer);
+						
+						/* Get a handle on the state object of the pipe the packet is meant for: */
+						LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
+						
+						if(pipeState.isValid())
 							{
-							PipeMessage* msg=static_cast<PipeMessage*>(messageBuffer);
-							
-							/* Get a handle on the state object of the pipe the packet is meant for: */
-							LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
-							
-							if(pipeState.isValid())
-								{
-								/* Check the pipe's barrier state for second-stage completion: */
-								if(pipeState->barrierId<2)
-									{
-									/* Remember the slave's barrier completion: */
-									pipeState->slaveBarrierIds[msgNodeIndex-1]=2;
-									
-									/* Check if the current barrier is complete: */
-									pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[0];
-									for(unsigned int i=1;i<numSlaves;++i)
-										if(pipeState->minSlaveBarrierId>pipeState->slaveBarrierIds[i])
-											pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[i];
-									if(pipeState->minSlaveBarrierId>=2)
-										{
-										/* Complete the second barrier: */
-										pipeState->barrierId=2;
-
-										/* Wake up the thread blocked on the new pipe: */
-										pipeState->barrierCond.signal();
-										}
-									}
-								}
-							#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
-							else
-								std::cerr<<"Node "<<nodeIndex<<": received CREATEPIPE2 message for non-existent pipe "<<msg->pipeId<<std::endl;
-							#endif
+							/* Process the acknowledgment packet: */
+							processAcknowledgment(pipeState,msgNodeIndex-1,msg->streamPos);
 							}
 						#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 						else
-							std::cerr<<"Node "<<nodeIndex<<": received CREATEPIPE2 message of wrong size "<<numBytesReceived<<std::endl;
+							std::cerr<<"Node "<<nodeIndex<<": received ACKNOWLEDGMENT message for non-existent pipe "<<msg->pipeId<<std::endl;
 						#endif
-						break;
 						}
-					
-					case Message::ACKNOWLEDGMENT:
+					#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+					else
+						std::cerr<<"Node "<<nodeIndex<<": received ACKNOWLEDGMENT message of wrong size "<<numBytesReceived<<std::endl;
+					#endif
+					break;
+					}
+				
+				case Message::PACKETLOSS:
+					{
+					if(numBytesReceived==sizeof(StreamMessage))
 						{
-						if(numBytesReceived==sizeof(StreamMessage))
+						StreamMessage* msg=static_cast<StreamMessage*>(messageBuffer);
+						
+						/* Get a handle on the state object of the pipe the packet is meant for: */
+						LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
+						
+						if(pipeState.isValid())
 							{
-							StreamMessage* msg=static_cast<StreamMessage*>(messageBuffer);
+							/* Use the stream position reported by the client as positive acknowledgment: */
+							processAcknowledgment(pipeState,msgNodeIndex-1,msg->streamPos);
 							
-							/* Get a handle on the state object of the pipe the packet is meant for: */
-							LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
-							
-							if(pipeState.isValid())
+							/* Resend requested packets if there are any; otherwise, do nothing because master is busy: */
+							if(msg->streamPos!=pipeState->streamPos)
 								{
-								/* Process the acknowledgment packet: */
-								processAcknowledgment(pipeState,msgNodeIndex-1,msg->streamPos);
+								#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER_VERBOSE
+								std::cerr<<"Packet loss of "<<msg->packetPos-msg->streamPos<<" bytes from "<<msg->streamPos<<" detected by node "<<msgNodeIndex<<", stream pos is "<<pipeState->streamPos<<", buffer starts at "<<pipeState->headStreamPos<<std::endl;
+								#endif
+								
+								/* Find the recently-sent packet starting at the slave's current stream position: */
+								Packet* packet;
+								for(packet=pipeState->packetList.front();packet!=0&&packet->streamPos!=msg->streamPos;packet=packet->succ)
+									;
+								
+								/* Signal a fatal error if the required packet has already been discarded: */
+								if(packet==0)
+									Misc::throwStdErr("Cluster::Multiplexer: Node %u: Fatal packet loss detected at stream position %u",msgNodeIndex,msg->streamPos);
+								
+								/* Resend all recent packets in order: */
+								resendPackets(pipeState,packet);
 								}
-							#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
-							else
-								std::cerr<<"Node "<<nodeIndex<<": received ACKNOWLEDGMENT message for non-existent pipe "<<msg->pipeId<<std::endl;
-							#endif
 							}
 						#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 						else
-							std::cerr<<"Node "<<nodeIndex<<": received ACKNOWLEDGMENT message of wrong size "<<numBytesReceived<<std::endl;
+							std::cerr<<"Node "<<nodeIndex<<": received PACKETLOSS message for non-existent pipe "<<msg->pipeId<<std::endl;
 						#endif
-						break;
 						}
-					
-					case Message::PACKETLOSS:
+					#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+					else
+						std::cerr<<"Node "<<nodeIndex<<": received PACKETLOSS message of wrong size "<<numBytesReceived<<std::endl;
+					#endif
+					break;
+					}
+				
+				case Message::BARRIER:
+					{
+					if(numBytesReceived==sizeof(BarrierMessage))
 						{
-						if(numBytesReceived==sizeof(StreamMessage))
+						BarrierMessage* msg=static_cast<BarrierMessage*>(messageBuffer);
+						
+						/* Get a handle on the state object of the pipe the packet is meant for: */
+						LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
+						
+						if(pipeState.isValid())
 							{
-							StreamMessage* msg=static_cast<StreamMessage*>(messageBuffer);
-							
-							/* Get a handle on the state object of the pipe the packet is meant for: */
-							LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
-							
-							if(pipeState.isValid())
+							/* Update the barrier ID array: */
+							if(pipeState->barrierId>=msg->barrierId)
+								{
+								/* One slave must have missed a barrier completion message; send another one: */
+								BarrierMessage msg2(0,Message::BARRIER,msg->pipeId,msg->barrierId);
 								{
-								/* Use the stream position reported by the client as positive acknowledgment: */
-								processAcknowledgment(pipeState,msgNodeIndex-1,msg->streamPos);
+								// SocketMutex::Lock socketLock(socketMutex);
+								sendto(socketFd,&msg2,sizeof(BarrierMessage),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
+								}
+								}
+							else
+								{
+								pipeState->slaveBarrierIds[msgNodeIndex-1]=msg->barrierId;
 								
-								/* Resend requested packets if there are any; otherwise, do nothing because master is busy: */
-								if(msg->streamPos!=pipeState->streamPos)
-									{
-									#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER_VERBOSE
-									std::cerr<<"Packet loss of "<<msg->packetPos-msg->streamPos<<" bytes from "<<msg->streamPos<<" detected by node "<<msgNodeIndex<<", stream pos is "<<pipeState->streamPos<<", buffer starts at "<<pipeState->headStreamPos<<std::endl;
-									#endif
-									
-									/* Find the recently-sent packet starting at the slave's current stream position: */
-									Packet* packet;
-									for(packet=pipeState->packetList.front();packet!=0&&packet->streamPos!=msg->streamPos;packet=packet->succ)
-										;
-									
-									/* Signal a fatal error if the required packet has already been discarded: */
-									if(packet==0)
-										Misc::throwStdErr("Cluster::Multiplexer: Node %u: Fatal packet loss detected at stream position %u",msgNodeIndex,msg->streamPos);
-									
+								/* Check if the current barrier is complete: */
+								pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[0];
+								for(unsigned int i=1;i<numSlaves;++i)
+									if(pipeState->minSlaveBarrierId>pipeState->slaveBarrierIds[i])
+										pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[i];
+								if(pipeState->minSlaveBarrierId>pipeState->barrierId)
 									{
-									/* Resend all recent packets in order: */
-									// SocketMutex::Lock socketLock(socketMutex);
-									for(;packet!=0;packet=packet->succ)
-										{
-										sendto(socketFd,&packet->pipeId,packet->packetSize+2*sizeof(unsigned int),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
-										#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
-										++pipeState->numResentPackets;
-										pipeState->numResentBytes+=packet->packetSize;
-										#endif
-										}
-									}
+									/* Wake up thread waiting on barrier: */
+									pipeState->barrierCond.signal();
 									}
 								}
-							#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
-							else
-								std::cerr<<"Node "<<nodeIndex<<": received PACKETLOSS message for non-existent pipe "<<msg->pipeId<<std::endl;
-							#endif
 							}
-						#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 						else
-							std::cerr<<"Node "<<nodeIndex<<": received PACKETLOSS message of wrong size "<<numBytesReceived<<std::endl;
-						#endif
-						break;
+							{
+							/* One slave must have missed the completion message for a pipe-closing barrier; send another one: */
+							BarrierMessage msg2(0,Message::BARRIER,msg->pipeId,msg->barrierId);
+							{
+							// SocketMutex::Lock socketLock(socketMutex);
+							sendto(socketFd,&msg2,sizeof(BarrierMessage),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
+							}
+							}
 						}
-					
-					case Message::BARRIER:
+					#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+					else
+						std::cerr<<"Node "<<nodeIndex<<": received BARRIER message of wrong size "<<numBytesReceived<<std::endl;
+					#endif
+					break;
+					}
+				
+				case Message::GATHER:
+					{
+					if(numBytesReceived==sizeof(GatherMessage))
 						{
-						if(numBytesReceived==sizeof(BarrierMessage))
+						GatherMessage* msg=static_cast<GatherMessage*>(messageBuffer);
+						
+						/* Get a handle on the state object of the pipe the packet is meant for: */
+						LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
+						
+						if(pipeState.isValid())
 							{
-							BarrierMessage* msg=static_cast<BarrierMessage*>(messageBuffer);
-							
-							/* Get a handle on the state object of the pipe the packet is meant for: */
-							LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
-							
-							if(pipeState.isValid())
+							/* Update the barrier ID array: */
+							if(pipeState->barrierId>=msg->barrierId)
 								{
-								/* Update the barrier ID array: */
-								if(pipeState->barrierId>=msg->barrierId)
-									{
-									/* One slave must have missed a barrier completion message; send another one: */
-									BarrierMessage msg2(0,Message::BARRIER,msg->pipeId,msg->barrierId);
-									{
-									// SocketMutex::Lock socketLock(socketMutex);
-									sendto(socketFd,&msg2,sizeof(BarrierMessage),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
-									}
-									}
-								else
-									{
-									pipeState->slaveBarrierIds[msgNodeIndex-1]=msg->barrierId;
-									
-									/* Check if the current barrier is complete: */
-									pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[0];
-									for(unsigned int i=1;i<numSlaves;++i)
-										if(pipeState->minSlaveBarrierId>pipeState->slaveBarrierIds[i])
-											pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[i];
-									if(pipeState->minSlaveBarrierId>pipeState->barrierId)
-										{
-										/* Wake up thread waiting on barrier: */
-										pipeState->barrierCond.signal();
-										}
-									}
-								}
-							else
-								{
-								/* One slave must have missed the completion message for a pipe-closing barrier; send another one: */
-								BarrierMessage msg2(0,Message::BARRIER,msg->pipeId,msg->barrierId);
+								/* One slave must have missed a gather completion message; send another one: */
+								GatherMessage msg2(0,Message::GATHER,msg->pipeId,msg->barrierId,pipeState->masterGatherValue);
 								{
 								// SocketMutex::Lock socketLock(socketMutex);
-								sendto(socketFd,&msg2,sizeof(BarrierMessage),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
+								sendto(socketFd,&msg2,sizeof(GatherMessage),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
 								}
 								}
+							else
+								{
+								pipeState->slaveBarrierIds[msgNodeIndex-1]=msg->barrierId;
+								pipeState->slaveGatherValues[msgNodeIndex-1]=msg->value;
+								
+								/* Check if the current gather operation is complete: */
+								pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[0];
+								for(unsigned int i=1;i<numSlaves;++i)
+									if(pipeState->minSlaveBarrierId>pipeState->slaveBarrierIds[i])
+										pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[i];
+								if(pipeState->minSlaveBarrierId>pipeState->barrierId)
+									{
+									/* Wake up thread waiting on barrier: */
+									pipeState->barrierCond.signal();
+									}
+								}
 							}
 						#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 						else
-							std::cerr<<"Node "<<nodeIndex<<": received BARRIER message of wrong size "<<numBytesReceived<<std::endl;
+							std::cerr<<"Node "<<nodeIndex<<": received GATHER message for non-existent pipe "<<msg->pipeId<<std::endl;
 						#endif
-						break;
 						}
-					
-					case Message::GATHER:
+					#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+					else
+						std::cerr<<"Node "<<nodeIndex<<": received GATHER message of wrong size "<<numBytesReceived<<std::endl;
+					#endif
+					break;
+					}
+				
+				case Message::GATHERDATA:
+					{
+					GatherDataMessage* msg=static_cast<GatherDataMessage*>(messageBuffer);
+					if(numBytesReceived>=sizeof(GatherDataMessage)&&numBytesReceived==sizeof(GatherDataMessage)+msg->dataSize&&msg->dataSize<=maxGatherDataSize)
 						{
-						if(numBytesReceived==sizeof(GatherMessage))
+						/* Get a handle on the state object of the pipe the packet is meant for: */
+						LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
+						
+						if(pipeState.isValid())
 							{
-							GatherMessage* msg=static_cast<GatherMessage*>(messageBuffer);
-							
-							/* Get a handle on the state object of the pipe the packet is meant for: */
-							LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
-							
-							if(pipeState.isValid())
+							/* Update the barrier ID array: */
+							if(pipeState->barrierId>=msg->barrierId)
 								{
-								/* Update the barrier ID array: */
-								if(pipeState->barrierId>=msg->barrierId)
-									{
-									/* One slave must have missed a gather completion message; send another one: */
-									GatherMessage msg2(0,Message::GATHER,msg->pipeId,msg->barrierId,pipeState->masterGatherValue);
+								/* One slave must have missed a gather completion message; send another one if the most recent operation was a vector gather: */
+								if(pipeState->barrierId==msg->barrierId&&pipeState->gatherData!=0)
+									sendGatherData(msg->pipeId,msg->barrierId,pipeState->gatherData,pipeState->gatherDataSize);
+								}
+							else
+								{
+								/* Allocate the slave gather data buffers on first use: */
+								if(pipeState->slaveGatherData==0)
 									{
-									// SocketMutex::Lock socketLock(socketMutex);
-									sendto(socketFd,&msg2,sizeof(GatherMessage),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
-									}
+									pipeState->slaveGatherData=new unsigned char[numSlaves*maxGatherDataSize];
+									pipeState->slaveGatherDataSizes=new size_t[numSlaves];
 									}
-								else
+								
+								/* Store the slave's gather data: */
+								pipeState->slaveBarrierIds[msgNodeIndex-1]=msg->barrierId;
+								memcpy(pipeState->slaveGatherData+(msgNodeIndex-1)*maxGatherDataSize,msg+1,msg->dataSize);
+								pipeState->slaveGatherDataSizes[msgNodeIndex-1]=msg->dataSize;
+								
+								/* Check if the current gather operation is complete: */
+								pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[0];
+								for(unsigned int i=1;i<numSlaves;++i)
+									if(pipeState->minSlaveBarrierId>pipeState->slaveBarrierIds[i])
+										pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[i];
+								if(pipeState->minSlaveBarrierId>pipeState->barrierId)
 									{
-									pipeState->slaveBarrierIds[msgNodeIndex-1]=msg->barrierId;
-									pipeState->slaveGatherValues[msgNodeIndex-1]=msg->value;
-									
-									/* Check if the current gather operation is complete: */
-									pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[0];
-									for(unsigned int i=1;i<numSlaves;++i)
-										if(pipeState->minSlaveBarrierId>pipeState->slaveBarrierIds[i])
-											pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[i];
-									if(pipeState->minSlaveBarrierId>pipeState->barrierId)
-										{
-										/* Wake up thread waiting on barrier: */
-										pipeState->barrierCond.signal();
-										}
+									/* Wake up thread waiting on barrier: */
+									pipeState->barrierCond.signal();
 									}
 								}
-							#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
-							else
-								std::cerr<<"Node "<<nodeIndex<<": received GATHER message for non-existent pipe "<<msg->pipeId<<std::endl;
-							#endif
 							}
 						#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 						else
-							std::cerr<<"Node "<<nodeIndex<<": received GATHER message of wrong size "<<numBytesReceived<<std::endl;
+							std::cerr<<"Node "<<nodeIndex<<": received GATHERDATA message for non-existent pipe "<<msg->pipeId<<std::endl;
 						#endif
-						break;
 						}
+					#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+					else
+						std::cerr<<"Node "<<nodeIndex<<": received GATHERDATA message of wrong size "<<numBytesReceived<<std::endl;
+					#endif
+					break;
+					}
+				}
+			}
+		}
+	#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+	else
+		std::cerr<<"Node "<<nodeIndex<<": received short message of size "<<numBytesReceived<<std::endl;
+	#endif
+	}
+
+bool Multiplexer::processMasterPacket(Packet* packet,unsigned int sendNodeIndex,unsigned int& sendAckIn)
+	{
+	bool result=false;
+	
+	/* Reconstruct the size of the received datagram to check message sizes: */
+	size_t numBytesReceived=packet->packetSize+2*sizeof(unsigned int);
+	
+	if(packet->pipeId==0)
+		{
+		/* It's a message for the pipe multiplexer itself: */
+		void* messageBuffer=&packet->pipeId;
+		switch(static_cast<Message*>(messageBuffer)->messageId)
+			{
+			case Message::CONNECTION:
+				/* Signal connection establishment: */
+				{
+				Threads::MutexCond::Lock connectionCondLock(connectionCond);
+				if(!connected)
+					{
+					/* Adopt the master's MTU size to receive its packets: */
+					if(numBytesReceived>=sizeof(ConnectionMessage))
+						updateMTUSize(static_cast<ConnectionMessage*>(messageBuffer)->mtuSize);
+					
+					connected=true;
+					connectionCond.broadcast();
+					}
+				}
+				break;
+			
+			case Message::PING:
+				/* Just ignore the packet... */
+				break;
+			
+			case Message::CREATEPIPE1:
+				{
+				CreatePipe1Message* msg=static_cast<CreatePipe1Message*>(messageBuffer);
+				if(numBytesReceived>=sizeof(CreatePipe1Message)&&numBytesReceived==sizeof(CreatePipe1Message)+msg->idNumParts*sizeof(unsigned int))
+					{
+					{
+					Threads::Mutex::Lock pipeStateTableLock(pipeStateTableMutex);
+					
+					/* Check if the pipe is not yet in the pipe state table: */
+					if(!pipeStateTable.isEntry(msg->pipeId))
+						{
+						/* Extract the originating thread's ID from the message: */
+						Threads::Thread::ID senderId(msg->idNumParts,reinterpret_cast<unsigned int*>(msg+1));
+						
+						/* Find the new pipe state corresponding to the thread ID: */
+						NewPipeHasher::Iterator npIt=newPipes.findEntry(senderId);
+						PipeState* newPipeState=npIt->getDest();
+						
+						/* Remove the new pipe state from the new pipe map and insert it into the pipe state table: */
+						newPipes.removeEntry(npIt);
+						pipeStateTable[msg->pipeId]=newPipeState;
+						
+						/* Signal pipe creation completion: */
+						{
+						Threads::Mutex::Lock pipeStateLock(newPipeState->stateMutex);
+						newPipeState->pipeId=msg->pipeId;
+						newPipeState->barrierId=2;
+						newPipeState->barrierCond.signal();
+						}
+						}
+					}
+					
+					/* Send a stage-two pipe creation message to the master: */
+					PipeMessage msg2(sendNodeIndex,Message::CREATEPIPE2,msg->pipeId);
+					{
+					// SocketMutex::Lock socketLock(socketMutex);
+					for(int i=0;i<slaveMessageBurstSize;++i)
+						sendto(socketFd,&msg2,sizeof(PipeMessage),0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
+					}
+					}
+				#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+				else
+					std::cerr<<"Node "<<nodeIndex<<": received CREATEPIPE1 message of wrong size "<<numBytesReceived<<std::endl;
+				#endif
+				break;
+				}
+			
+			case Message::BARRIER:
+				{
+				if(numBytesReceived==sizeof(BarrierMessage))
+					{
+					BarrierMessage* msg=static_cast<BarrierMessage*>(messageBuffer);
+					
+					/* Get a handle on the state object of the pipe the packet is meant for: */
+					LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
+					
+					if(pipeState.isValid())
+						{
+						/* Signal barrier completion if the completion message is for the current barrier: */
+						if(pipeState->barrierId<msg->barrierId)
+							{
+							pipeState->barrierId=msg->barrierId;
+							pipeState->barrierCond.signal();
+							}
+						}
+					#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+					else
+						std::cerr<<"Node "<<nodeIndex<<": received BARRIER message for non-existent pipe "<<msg->pipeId<<std::endl;
+					#endif
+					}
+				#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+				else
+					std::cerr<<"Node "<<nodeIndex<<": received BARRIER message of wrong size "<<numBytesReceived<<std::endl;
+				#endif
+				break;
+				}
+			
+			case Message::GATHER:
+				{
+				if(numBytesReceived==sizeof(GatherMessage))
+					{
+					GatherMessage* msg=static_cast<GatherMessage*>(messageBuffer);
+					
+					/* Get a handle on the state object of the pipe the packet is meant for: */
+					LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
+					
+					if(pipeState.isValid())
+						{
+						/* Signal barrier completion if the completion message is for the current barrier: */
+						if(pipeState->barrierId<msg->barrierId)
+							{
+							pipeState->barrierId=msg->barrierId;
+							pipeState->masterGatherValue=msg->value;
+							pipeState->barrierCond.signal();
+							}
+						}
+					#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+					else
+						std::cerr<<"Node "<<nodeIndex<<": received GATHER message for non-existent pipe "<<msg->pipeId<<std::endl;
+					#endif
+					}
+				#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+				else
+					std::cerr<<"Node "<<nodeIndex<<": received GATHER message of wrong size "<<numBytesReceived<<std::endl;
+				#endif
+				break;
+				}
+			
+			case Message::GATHERDATA:
+				{
+				GatherDataMessage* msg=static_cast<GatherDataMessage*>(messageBuffer);
+				if(numBytesReceived>=sizeof(GatherDataMessage)&&numBytesReceived==sizeof(GatherDataMessage)+msg->dataSize&&msg->dataSize<=maxGatherDataSize)
+					{
+					/* Get a handle on the state object of the pipe the packet is meant for: */
+					LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
+					
+					if(pipeState.isValid())
+						{
+						/* Signal barrier completion if the completion message is for the current barrier: */
+						if(pipeState->barrierId<msg->barrierId)
+							{
+							/* Store the final gather data: */
+							if(pipeState->gatherData==0)
+								pipeState->gatherData=new unsigned char[maxGatherDataSize];
+							memcpy(pipeState->gatherData,msg+1,msg->dataSize);
+							pipeState->gatherDataSize=msg->dataSize;
+							
+							pipeState->barrierId=msg->barrierId;
+							pipeState->barrierCond.signal();
+							}
+						}
+					#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+					else
+						std::cerr<<"Node "<<nodeIndex<<": received GATHERDATA message for non-existent pipe "<<msg->pipeId<<std::endl;
+					#endif
+					}
+				#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+				else
+					std::cerr<<"Node "<<nodeIndex<<": received GATHERDATA message of wrong size "<<numBytesReceived<<std::endl;
+				#endif
+				break;
+				}
+			}
+		}
+	else
+		{
+		/* Get a handle on the state object of the pipe the packet is meant for: */
+		LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,packet->pipeId);
+		
+		if(pipeState.isValid())
+			{
+			/* Check if the received packet is the next expected one: */
+			if(pipeState->streamPos==packet->streamPos)
+				{
+				/* Disable packet loss mode: */
+				pipeState->packetLossMode=false;
+				
+				++sendAckIn;
+				if(sendAckIn==numSlaves)
+					{
+					/* Send positive acknowledgment to the master: */
+					StreamMessage msg(sendNodeIndex,Message::ACKNOWLEDGMENT,packet->pipeId,pipeState->streamPos,packet->streamPos);
+					{
+					// SocketMutex::Lock socketLock(socketMutex);
+					sendto(socketFd,&msg,sizeof(StreamMessage),0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
+					}
+					sendAckIn=0;
+					}
+				
+				/* Wake up sleeping receivers if the delivery queue is currently empty: */
+				if(pipeState->packetList.empty())
+					pipeState->receiveCond.signal();
+				
+				/* Append the packet to the pipe state's delivery queue: */
+				pipeState->streamPos+=packet->packetSize;
+				pipeState->packetList.push_back(packet);
+				
+				/* Hand the packet over to the delivery queue: */
+				result=true;
+				}
+			else
+				{
+				/* Check if there is data missing between the packet's stream position and the pipe's stream position; watch for stream position wrap-around: */
+				if(!pipeState->packetLossMode&&packet->streamPos-pipeState->streamPos<=0x80000000U)
+					{
+					/* At least one packet must have been lost; send negative acknowledgment to the master: */
+					StreamMessage msg(sendNodeIndex,Message::PACKETLOSS,packet->pipeId,pipeState->streamPos,packet->streamPos);
+					{
+					// SocketMutex::Lock socketLock(socketMutex);
+					for(int i=0;i<slaveMessageBurstSize;++i)
+						sendto(socketFd,&msg,sizeof(StreamMessage),0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
+					}
+
+					/* Enable packet loss mode to prohibit sending further loss messages until the missing packet arrives: */
+					pipeState->packetLossMode=true;
+					}
+				}
+			}
+		#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+		else
+			std::cerr<<"Node "<<nodeIndex<<": received stream packet for non-existent pipe "<<packet->pipeId<<std::endl;
+		#endif
+		}
+	
+	return result;
+	}
+
+void* Multiplexer::packetHandlingThreadMaster(void)
+	{
+	Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
+	// Threads::Thread::setCancelType(Threads::Thread::CANCEL_ASYNCHRONOUS);
+	
+	/* Handle message exchange during multiplexer initialization: */
+	bool* slaveConnecteds=new bool[numSlaves];
+	for(unsigned int i=0;i<numSlaves;++i)
+		slaveConnecteds[i]=false;
+	unsigned int numConnectedSlaves=0;
+	while(numConnectedSlaves<numSlaves)
+		{
+		/* Wait for a connection initialization packet: */
+		ssize_t numBytesReceived=recv(socketFd,messageBuffers,Packet::maxSupportedRawPacketSize,0);
+		if(numBytesReceived==sizeof(Message))
+			{
+			Message* msg=reinterpret_cast<Message*>(messageBuffers);
+			if(msg->nodeIndex&0x80000000U) // Check if the message is from a slave
+				{
+				unsigned int slaveIndex=(msg->nodeIndex&0x7fffffffU)-1;
+				if(msg->messageId==Message::CONNECTION&&slaveIndex<numSlaves&&!slaveConnecteds[slaveIndex])
+					{
+					/* Mark the slave as connected: */
+					slaveConnecteds[slaveIndex]=true;
+					++numConnectedSlaves;
 					}
 				}
 			}
-		#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
-		else
-			std::cerr<<"Node "<<nodeIndex<<": received short message of size "<<numBytesReceived<<std::endl;
+		}
+	delete[] slaveConnecteds;
+	
+	/* Signal connection establishment, which also fixes the MTU size: */
+	{
+	Threads::MutexCond::Lock connectionCondLock(connectionCond);
+	connected=true;
+	connectionCond.broadcast();
+	}
+	
+	/* Send connection message containing the MTU size to slaves: */
+	ConnectionMessage msg(mtuSize);
+	{
+	// SocketMutex::Lock socketLock(socketMutex);
+	for(int i=0;i<masterMessageBurstSize;++i)
+		sendto(socketFd,&msg,sizeof(ConnectionMessage),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
+	}
+	
+	/* Handle messages from the slaves: */
+	while(true)
+		{
+		#if CLUSTER_CONFIG_HAVE_MMSG
+		
+		/* Wait for a batch of messages from any slaves: */
+		struct iovec iovecs[CLUSTER_CONFIG_MAX_BATCH_SIZE];
+		struct mmsghdr messages[CLUSTER_CONFIG_MAX_BATCH_SIZE];
+		unsigned int maxNumMessages=batchSize;
+		for(unsigned int i=0;i<maxNumMessages;++i)
+			{
+			iovecs[i].iov_base=messageBuffers+i*Packet::maxSupportedRawPacketSize;
+			iovecs[i].iov_len=Packet::maxSupportedRawPacketSize;
+			memset(&messages[i].msg_hdr,0,sizeof(struct msghdr));
+			messages[i].msg_hdr.msg_iov=&iovecs[i];
+			messages[i].msg_hdr.msg_iovlen=1;
+			}
+		int numMessages=recvmmsg(socketFd,messages,maxNumMessages,MSG_WAITFORONE,0);
+		
+		/* Process all received messages in order: */
+		for(int i=0;i<numMessages;++i)
+			processSlaveMessage(messageBuffers+i*Packet::maxSupportedRawPacketSize,messages[i].msg_len);
+		
+		#else
+		
+		/* Wait for a message from any slave: */
+		ssize_t numBytesReceived=recv(socketFd,messageBuffers,Packet::maxSupportedRawPacketSize,0);
+		if(numBytesReceived>=0)
+			processSlaveMessage(messageBuffers,size_t(numBytesReceived));
+		
 		#endif
 		}
 	
@@ -833,216 +1395,84 @@ void* Multiplexer::packetHandlingThreadSlave(void)
 			Misc::throwStdErr("Cluster::Multiplexer: Node %u: Communication error",nodeIndex);
 			}
 		
+		#if CLUSTER_CONFIG_HAVE_MMSG
+		
+		/* Read all waiting packets directly into the packet handling thread's receive packets: */
+		struct iovec iovecs[CLUSTER_CONFIG_MAX_BATCH_SIZE];
+		struct mmsghdr messages[CLUSTER_CONFIG_MAX_BATCH_SIZE];
+		unsigned int maxNumPackets=batchSize;
+		for(unsigned int i=0;i<maxNumPackets;++i)
+			{
+			/* Replace receive packets that were allocated for a smaller MTU size: */
+			if(slaveThreadPackets[i]!=0&&slaveThreadPackets[i]->capacity<maxPacketSize)
+				{
+				Packet::destroy(slaveThreadPackets[i]);
+				slaveThreadPackets[i]=0;
+				}
+			
+			/* Replace receive packets that were handed to a delivery queue during the previous batch: */
+			if(slaveThreadPackets[i]==0)
+				slaveThreadPackets[i]=newPacket();
+			
+			iovecs[i].iov_base=&slaveThreadPackets[i]->pipeId;
+			iovecs[i].iov_len=2*sizeof(unsigned int)+slaveThreadPackets[i]->capacity;
+			memset(&messages[i].msg_hdr,0,sizeof(struct msghdr));
+			messages[i].msg_hdr.msg_iov=&iovecs[i];
+			messages[i].msg_hdr.msg_iovlen=1;
+			}
+		int numPackets=recvmmsg(socketFd,messages,maxNumPackets,MSG_DONTWAIT,0);
+		#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+		if(numPackets<0)
+			std::cerr<<"Node "<<nodeIndex<<": Error "<<errno<<" on receive"<<std::endl;
+		#endif
+		
+		/* Process all received packets in order: */
+		for(int i=0;i<numPackets;++i)
+			{
+			if(messages[i].msg_len>=2*sizeof(unsigned int))
+				{
+				slaveThreadPackets[i]->packetSize=size_t(messages[i].msg_len-2*sizeof(unsigned int));
+				if(processMasterPacket(slaveThreadPackets[i],sendNodeIndex,sendAckIn))
+					slaveThreadPackets[i]=0;
+				}
+			#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+			else
+				std::cerr<<"Node "<<nodeIndex<<": received short message of size "<<messages[i].msg_len<<std::endl;
+			#endif
+			}
+		
+		#else
+		
+		/* Replace the receive packet if it was allocated for a smaller MTU size: */
+		if(slaveThreadPackets[0]->capacity<maxPacketSize)
+			{
+			Packet::destroy(slaveThreadPackets[0]);
+			slaveThreadPackets[0]=newPacket();
+			}
+		
 		/* Read the waiting packet: */
-		ssize_t numBytesReceived=recv(socketFd,&slaveThreadPacket->pipeId,Packet::maxRawPacketSize,0);
+		ssize_t numBytesReceived=recv(socketFd,&slaveThreadPackets[0]->pipeId,2*sizeof(unsigned int)+slaveThreadPackets[0]->capacity,0);
 		if(numBytesReceived<0)
 			{
 			/* Try to recover from this error: */
 			#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
-			std::cerr<<"Node "<<nodeIndex<<": Error "<<errno<<" on receive, slaveThreadPacket="<<slaveThreadPacket<<std::endl;
+			std::cerr<<"Node "<<nodeIndex<<": Error "<<errno<<" on receive, slaveThreadPacket="<<slaveThreadPackets[0]<<std::endl;
 			#endif
-			delete slaveThreadPacket;
-			slaveThreadPacket=newPacket();
+			Packet::destroy(slaveThreadPackets[0]);
+			slaveThreadPackets[0]=newPacket();
 			}
 		else if(size_t(numBytesReceived)>=2*sizeof(unsigned int))
 			{
-			slaveThreadPacket->packetSize=size_t(numBytesReceived-2*sizeof(unsigned int));
-			
-			if(slaveThreadPacket->pipeId==0)
-				{
-				/* It's a message for the pipe multiplexer itself: */
-				void* messageBuffer=&slaveThreadPacket->pipeId;
-				switch(static_cast<Message*>(messageBuffer)->messageId)
-					{
-					case Message::CONNECTION:
-						/* Signal connection establishment: */
-						{
-						Threads::MutexCond::Lock connectionCondLock(connectionCond);
-						if(!connected)
-							{
-							connected=true;
-							connectionCond.broadcast();
-							}
-						}
-						break;
-					
-					case Message::PING:
-						/* Just ignore the packet... */
-						break;
-					
-					case Message::CREATEPIPE1:
-						{
-						CreatePipe1Message* msg=static_cast<CreatePipe1Message*>(messageBuffer);
-						if(size_t(numBytesReceived)>=sizeof(CreatePipe1Message)&&size_t(numBytesReceived)==sizeof(CreatePipe1Message)+msg->idNumParts*sizeof(unsigned int))
-							{
-							{
-							Threads::Mutex::Lock pipeStateTableLock(pipeStateTableMutex);
-							
-							/* Check if the pipe is not yet in the pipe state table: */
-							if(!pipeStateTable.isEntry(msg->pipeId))
-								{
-								/* Extract the originating thread's ID from the message: */
-								Threads::Thread::ID senderId(msg->idNumParts,reinterpret_cast<unsigned int*>(msg+1));
-								
-								/* Find the new pipe state corresponding to the thread ID: */
-								NewPipeHasher::Iterator npIt=newPipes.findEntry(senderId);
-								PipeState* newPipeState=npIt->getDest();
-								
-								/* Remove the new pipe state from the new pipe map and insert it into the pipe state table: */
-								newPipes.removeEntry(npIt);
-								pipeStateTable[msg->pipeId]=newPipeState;
-								
-								/* Signal pipe creation completion: */
-								{
-								Threads::Mutex::Lock pipeStateLock(newPipeState->stateMutex);
-								newPipeState->pipeId=msg->pipeId;
-								newPipeState->barrierId=2;
-								newPipeState->barrierCond.signal();
-								}
-								}
-							}
-							
-							/* Send a stage-two pipe creation message to the master: */
-							PipeMessage msg2(sendNodeIndex,Message::CREATEPIPE2,msg->pipeId);
-							{
-							// SocketMutex::Lock socketLock(socketMutex);
-							for(int i=0;i<slaveMessageBurstSize;++i)
-								sendto(socketFd,&msg2,sizeof(PipeMessage),0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
-							}
-							}
-						#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
-						else
-							std::cerr<<"Node "<<nodeIndex<<": received CREATEPIPE1 message of wrong size "<<numBytesReceived<<std::endl;
-						#endif
-						break;
-						}
-					
-					case Message::BARRIER:
-						{
-						if(numBytesReceived==sizeof(BarrierMessage))
-							{
-							BarrierMessage* msg=static_cast<BarrierMessage*>(messageBuffer);
-							
-							/* Get a handle on the state object of the pipe the packet is meant for: */
-							LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
-							
-							if(pipeState.isValid())
-								{
-								/* Signal barrier completion if the completion message is for the current barrier: */
-								if(pipeState->barrierId<msg->barrierId)
-									{
-									pipeState->barrierId=msg->barrierId;
-									pipeState->barrierCond.signal();
-									}
-								}
-							#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
-							else
-								std::cerr<<"Node "<<nodeIndex<<": received BARRIER message for non-existent pipe "<<msg->pipeId<<std::endl;
-							#endif
-							}
-						#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
-						else
-							std::cerr<<"Node "<<nodeIndex<<": received BARRIER message of wrong size "<<numBytesReceived<<std::endl;
-						#endif
-						break;
-						}
-					
-					case Message::GATHER:
-						{
-						if(numBytesReceived==sizeof(GatherMessage))
-							{
-							GatherMessage* msg=static_cast<GatherMessage*>(messageBuffer);
-							
-							/* Get a handle on the state object of the pipe the packet is meant for: */
-							LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
-							
-							if(pipeState.isValid())
-								{
-								/* Signal barrier completion if the completion message is for the current barrier: */
-								if(pipeState->barrierId<msg->barrierId)
-									{
-									pipeState->barrierId=msg->barrierId;
-									pipeState->masterGatherValue=msg->value;
-									pipeState->barrierCond.signal();
-									}
-								}
-							#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
-							else
-								std::cerr<<"Node "<<nodeIndex<<": received GATHER message for non-existent pipe "<<msg->pipeId<<std::endl;
-							#endif
-							}
-						#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
-						else
-							std::cerr<<"Node "<<nodeIndex<<": received GATHER message of wrong size "<<numBytesReceived<<std::endl;
-						#endif
-						break;
-						}
-					}
-				}
-			else
-				{
-				/* Get a handle on the state object of the pipe the packet is meant for: */
-				LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,slaveThreadPacket->pipeId);
-				
-				if(pipeState.isValid())
-					{
-					/* Check if the received packet is the next expected one: */
-					if(pipeState->streamPos==slaveThreadPacket->streamPos)
-						{
-						/* Disable packet loss mode: */
-						pipeState->packetLossMode=false;
-						
-						++sendAckIn;
-						if(sendAckIn==numSlaves)
-							{
-							/* Send positive acknowledgment to the master: */
-							StreamMessage msg(sendNodeIndex,Message::ACKNOWLEDGMENT,slaveThreadPacket->pipeId,pipeState->streamPos,slaveThreadPacket->streamPos);
-							{
-							// SocketMutex::Lock socketLock(socketMutex);
-							sendto(socketFd,&msg,sizeof(StreamMessage),0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
-							}
-							sendAckIn=0;
-							}
-						
-						/* Wake up sleeping receivers if the delivery queue is currently empty: */
-						if(pipeState->packetList.empty())
-							pipeState->receiveCond.signal();
-						
-						/* Append the packet to the pipe state's delivery queue: */
-						pipeState->streamPos+=slaveThreadPacket->packetSize;
-						pipeState->packetList.push_back(slaveThreadPacket);
-						
-						/* Get a new packet: */
-						slaveThreadPacket=newPacket();
-						}
-					else
-						{
-						/* Check if there is data missing between the packet's stream position and the pipe's stream position; watch for stream position wrap-around: */
-						if(!pipeState->packetLossMode&&slaveThreadPacket->streamPos-pipeState->streamPos<=0x80000000U)
-							{
-							/* At least one packet must have been lost; send negative acknowledgment to the master: */
-							StreamMessage msg(sendNodeIndex,Message::PACKETLOSS,slaveThreadPacket->pipeId,pipeState->streamPos,slaveThreadPacket->streamPos);
-							{
-							// SocketMutex::Lock socketLock(socketMutex);
-							for(int i=0;i<slaveMessageBurstSize;++i)
-								sendto(socketFd,&msg,sizeof(StreamMessage),0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
-							}
-
-							/* Enable packet loss mode to prohibit sending further loss messages until the missing packet arrives: */
-							pipeState->packetLossMode=true;
-							}
-						}
-					}
-				#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
-				else
-					std::cerr<<"Node "<<nodeIndex<<": received stream packet for non-existent pipe "<<slaveThreadPacket->pipeId<<std::endl;
-				#endif
-				}
+			slaveThreadPackets[0]->packetSize=size_t(numBytesReceived-2*sizeof(unsigned int));
+			if(processMasterPacket(slaveThreadPackets[0],sendNodeIndex,sendAckIn))
+				slaveThreadPackets[0]=newPacket();
 			}
 		#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 		else
 			std::cerr<<"Node "<<nodeIndex<<": received short message of size "<<numBytesReceived<<std::endl;
 		#endif
+		
+		#endif
 		}
 	
 	return 0;
@@ -1057,9 +1487,11 @@ Multiplexer::Multiplexer(unsigned int sNumSlaves,unsigned int sNodeIndex,std::st
 	 newPipes(17),
 	 lastPipeId(0),
 	 pipeStateTable(17),
-	 messageBuffer(0),
-	 slaveThreadPacket(0),
+	 messageBuffers(0),
+	 slaveThreadPackets(0),
 	 masterMessageBurstSize(1),slaveMessageBurstSize(1),
+	 mtuSize(CLUSTER_CONFIG_MTU_SIZE),maxPacketSize(Packet::getMaxPacketSize(mtuSize)),maxGatherDataSize(calcMaxGatherDataSize(mtuSize)),
+	 batchSize(16),
 	 connectionWaitTimeout(0.5),
 	 pingTimeout(10.0),maxPingRequests(3),
 	 receiveWaitTimeout(0.25),
@@ -1165,12 +1597,18 @@ Multiplexer::Multiplexer(unsigned int sNumSlaves,unsigned int sNodeIndex,std::st
 	/* Create the packet handling thread: */
 	if(nodeIndex==0)
 		{
-		messageBuffer=new unsigned char[Packet::maxRawPacketSize];
+		messageBuffers=new unsigned char[CLUSTER_CONFIG_MAX_BATCH_SIZE*Packet::maxSupportedRawPacketSize];
 		packetHandlingThread.start(this,&Multiplexer::packetHandlingThreadMaster);
 		}
 	else
 		{
-		slaveThreadPacket=newPacket();
+		/* Receive packets at the largest supported MTU size until the master's MTU size is known, so that packets arriving in the same batch as the connection message are not truncated: */
+		updateMTUSize(CLUSTER_CONFIG_MAX_MTU_SIZE);
+		
+		slaveThreadPackets=new Packet*[CLUSTER_CONFIG_MAX_BATCH_SIZE];
+		slaveThreadPackets[0]=newPacket();
+		for(int i=1;i<CLUSTER_CONFIG_MAX_BATCH_SIZE;++i)
+			slaveThreadPackets[i]=0;
 		packetHandlingThread.start(this,&Multiplexer::packetHandlingThreadSlave);
 		}
 	}
@@ -1181,9 +1619,15 @@ Multiplexer::~Multiplexer(void)
 	packetHandlingThread.cancel();
 	packetHandlingThread.join();
 	
-	/* Delete the packet handling thread's receive packet: */
-	delete slaveThreadPacket;
-	delete[] static_cast<unsigned char*>(messageBuffer);
+	/* Delete the packet handling thread's receive packets: */
+	if(slaveThreadPackets!=0)
+		{
+		for(int i=0;i<CLUSTER_CONFIG_MAX_BATCH_SIZE;++i)
+			if(slaveThreadPackets[i]!=0)
+				Packet::destroy(slaveThreadPackets[i]);
+		delete[] slaveThreadPackets;
+		}
+	delete[] messageBuffers;
 	
 	/* Close all leftover pipes: */
 	for(PipeHasher::Iterator psIt=pipeStateTable.begin();psIt!=pipeStateTable.end();++psIt)
@@ -1200,7 +1644,7 @@ Multiplexer::~Multiplexer(void)
 	while(packetPoolHead!=0)
 		{
 		Packet* succ=packetPoolHead->succ;
-		delete packetPoolHead;
+		Packet::destroy(packetPoolHead);
 		packetPoolHead=succ;
 		}
 	}
@@ -1248,6 +1692,26 @@ void Multiplexer::setSendBufferSize(unsigned int newSendBufferSize)
 	sendBufferSize=newSendBufferSize;
 	}
 
+void Multiplexer::setMTUSize(size_t newMTUSize)
+	{
+	/* Slaves receive the MTU size from the master while connecting, so it can not change afterwards: */
+	Threads::MutexCond::Lock connectionCondLock(connectionCond);
+	if(connected)
+		Misc::throwStdErr("Cluster::Multiplexer: Node %u: Attempt to change MTU size after connection was established",nodeIndex);
+	
+	updateMTUSize(newMTUSize);
+	}
+
+void Multiplexer::setBatchSize(unsigned int newBatchSize)
+	{
+	/* Limit the batch size to the range supported by the packet handling thread: */
+	if(newBatchSize>CLUSTER_CONFIG_MAX_BATCH_SIZE)
+		newBatchSize=CLUSTER_CONFIG_MAX_BATCH_SIZE;
+	if(newBatchSize<1)
+		newBatchSize=1;
+	batchSize=newBatchSize;
+	}
+
 void Multiplexer::waitForConnection(void)
 	{
 	{
@@ -1266,7 +1730,7 @@ unsigned int Multiplexer::openPipe(void)
 	const Threads::Thread::ID& threadId=Threads::Thread::getThreadObject()->getId();
 	
 	/* Check if the configured multicast packet size can handle the current thread's ID: */
-	if(sizeof(CreatePipe1Message)+threadId.getNumParts()*sizeof(unsigned int)>Packet::maxRawPacketSize)
+	if(sizeof(CreatePipe1Message)+threadId.getNumParts()*sizeof(unsigned int)>Packet::getRawPacketSize(mtuSize))
 		Misc::throwStdErr("Cluster::Multiplexer: Threads nested too deply to open new multicast pipe");
 	
 	/* Add a new pipe state to the new pipe map: */
@@ -1531,23 +1995,7 @@ void Multiplexer::barrier(unsigned int pipeId)
 		}
 		
 		/* Reset the pipe's flow control state: */
-		pipeState->headStreamPos=pipeState->streamPos;
-		for(unsigned int i=0;i<numSlaves;++i)
-			pipeState->slaveStreamPosOffsets[i]=0;
-		pipeState->numHeadSlaves=numSlaves;
-		
-		/* Add all packets in the list to the list of free packets: */
-		if(pipeState->packetList.numPackets>0)
-			{
-			{
-			Threads::Spinlock::Lock packetPoolLock(packetPoolMutex);
-			pipeState->packetList.tail->succ=packetPoolHead;
-			packetPoolHead=pipeState->packetList.head;
-			}
-			pipeState->packetList.numPackets=0;
-			pipeState->packetList.head=0;
-			pipeState->packetList.tail=0;
-			}
+		resetFlowControl(pipeState);
 		}
 	else
 		{
@@ -1636,23 +2084,7 @@ unsigned int Multiplexer::gather(unsigned int pipeId,unsigned int value,GatherOp
 		}
 		
 		/* Reset the pipe's flow control state: */
-		pipeState->headStreamPos=pipeState->streamPos;
-		for(unsigned int i=0;i<numSlaves;++i)
-			pipeState->slaveStreamPosOffsets[i]=0;
-		pipeState->numHeadSlaves=numSlaves;
-		
-		/* Add all packets in the list to the list of free packets: */
-		if(pipeState->packetList.numPackets>0)
-			{
-			{
-			Threads::Spinlock::Lock packetPoolLock(packetPoolMutex);
-			pipeState->packetList.tail->succ=packetPoolHead;
-			packetPoolHead=pipeState->packetList.head;
-			}
-			pipeState->packetList.numPackets=0;
-			pipeState->packetList.head=0;
-			pipeState->packetList.tail=0;
-			}
+		resetFlowControl(pipeState);
 		}
 	else
 		{
@@ -1677,4 +2109,112 @@ unsigned int Multiplexer::gather(unsigned int pipeId,unsigned int value,GatherOp
 	return pipeState->masterGatherValue;
 	}
 
+void Multiplexer::gather(unsigned int pipeId,void* values,size_t numValues,GatherOperation::ValueType valueType,GatherOperation::OpCode op)
+	{
+	/* Check if the values fit into a single datagram: */
+	size_t dataSize=numValues*GatherOperation::getValueSize(valueType);
+	if(dataSize>maxGatherDataSize)
+		Misc::throwStdErr("Cluster::Multiplexer: Node %u: Attempt to gather %u bytes; maximum is %u bytes",nodeIndex,(unsigned int)dataSize,(unsigned int)maxGatherDataSize);
+	
+	/* Get a handle on the state object for the given pipe: */
+	LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,pipeId);
+	if(!pipeState.isValid())
+		Misc::throwStdErr("Cluster::Multiplexer: Node %u: Attempt to gather on closed pipe",nodeIndex);
+	
+	/* Bump up barrier ID: */
+	unsigned int nextBarrierId=pipeState->barrierId+1;
+	
+	/* Exchange the gather data: */
+	bool sizesMatch=exchangeGatherData(pipeState,pipeId,nextBarrierId,values,dataSize,dataSize);
+	
+	if(nodeIndex==0)
+		{
+		/* Calculate the final gather values: */
+		pipeState->gatherDataSize=0;
+		if(sizesMatch)
+			{
+			memcpy(pipeState->gatherData,values,dataSize);
+			for(unsigned int i=0;i<numSlaves;++i)
+				{
+				void* slaveValues=pipeState->slaveGatherData+i*maxGatherDataSize;
+				switch(valueType)
+					{
+					case GatherOperation::INT:
+						accumulateValues(reinterpret_cast<int*>(pipeState->gatherData),static_cast<const int*>(slaveValues),numValues,op);
+						break;
+					
+					case GatherOperation::UINT:
+						accumulateValues(reinterpret_cast<unsigned int*>(pipeState->gatherData),static_cast<const unsigned int*>(slaveValues),numValues,op);
+						break;
+					
+					case GatherOperation::FLOAT:
+						accumulateValues(reinterpret_cast<float*>(pipeState->gatherData),static_cast<const float*>(slaveValues),numValues,op);
+						break;
+					
+					case GatherOperation::DOUBLE:
+						accumulateValues(reinterpret_cast<double*>(pipeState->gatherData),static_cast<const double*>(slaveValues),numValues,op);
+						break;
+					}
+				}
+			pipeState->gatherDataSize=dataSize;
+			}
+		
+		/* Send gather completion message to all slaves: */
+		sendGatherData(pipeId,nextBarrierId,pipeState->gatherData,pipeState->gatherDataSize);
+		
+		/* Reset the pipe's flow control state: */
+		resetFlowControl(pipeState);
+		}
+	
+	if(!sizesMatch)
+		Misc::throwStdErr("Cluster::Multiplexer: Node %u: Mismatching numbers of values in vector gather operation",nodeIndex);
+	
+	/* Return the final gather values: */
+	memcpy(values,pipeState->gatherData,dataSize);
+	}
+
+void Multiplexer::allGather(unsigned int pipeId,const void* value,size_t valueSize,void* values)
+	{
+	/* Check if all nodes' values fit into a single datagram: */
+	size_t gatherDataSize=(numSlaves+1)*valueSize;
+	if(gatherDataSize>maxGatherDataSize)
+		Misc::throwStdErr("Cluster::Multiplexer: Node %u: Attempt to gather %u bytes; maximum is %u bytes",nodeIndex,(unsigned int)gatherDataSize,(unsigned int)maxGatherDataSize);
+	
+	/* Get a handle on the state object for the given pipe: */
+	LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,pipeId);
+	if(!pipeState.isValid())
+		Misc::throwStdErr("Cluster::Multiplexer: Node %u: Attempt to gather on closed pipe",nodeIndex);
+	
+	/* Bump up barrier ID: */
+	unsigned int nextBarrierId=pipeState->barrierId+1;
+	
+	/* Exchange the gather data: */
+	bool sizesMatch=exchangeGatherData(pipeState,pipeId,nextBarrierId,value,valueSize,gatherDataSize);
+	
+	if(nodeIndex==0)
+		{
+		/* Concatenate all nodes' values in order of node index: */
+		pipeState->gatherDataSize=0;
+		if(sizesMatch)
+			{
+			memcpy(pipeState->gatherData,value,valueSize);
+			for(unsigned int i=0;i<numSlaves;++i)
+				memcpy(pipeState->gatherData+(i+1)*valueSize,pipeState->slaveGatherData+i*maxGatherDataSize,valueSize);
+			pipeState->gatherDataSize=gatherDataSize;
+			}
+		
+		/* Send gather completion message to all slaves: */
+		sendGatherData(pipeId,nextBarrierId,pipeState->gatherData,pipeState->gatherDataSize);
+		
+		/* Reset the pipe's flow control state: */
+		resetFlowControl(pipeState);
+		}
+	
+	if(!sizesMatch)
+		Misc::throwStdErr("Cluster::Multiplexer: Node %u: Mismatching value sizes in all-gather operation",nodeIndex);
+	
+	/* Return all nodes' values: */
+	memcpy(values,pipeState->gatherData,gatherDataSize);
+	}
+
 }
@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <string>
 #include <Misc/HashTable.h>
+#include <Misc/FlatHashTable.h>
 #include <Misc/Time.h>
 #include <Threads/Thread.h>
 #include <Threads/Mutex.h>
@@ -98,6 +99,10 @@ class Multiplexer
 		unsigned int minSlaveBarrierId; // Smallest barrier ID currently in the state array
 		unsigned int* slaveGatherValues; // Array of most recently received gather values from the slaves
 		unsigned int masterGatherValue; // Final value of last completed gather operation in pipe
+		unsigned char* slaveGatherData; // Array of most recently received gather data blocks from the slaves, allocated on first use
+		size_t* slaveGatherDataSizes; // Array of sizes of most recently received gather data blocks
+		unsigned char* gatherData; // Final data of last completed vector gather operation in pipe, allocated on first use
+		size_t gatherDataSize; // Size of final data of last completed vector gather operation in bytes
 		#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 		size_t numResentPackets;
 		size_t numResentBytes;
@@ -109,7 +114,7 @@ class Multiplexer
 		};
 	
 	typedef Misc::HashTable<Threads::Thread::ID,PipeState*,Threads::Thread::ID> NewPipeHasher; // Hash table to map from thread IDs to pipe state table entries during pipe creation
-	typedef Misc::HashTable<unsigned int,PipeState*> PipeHasher; // Hash table to map from pipe IDs to pipe state table entries
+	typedef Misc::FlatHashTable<unsigned int,PipeState*> PipeHasher; // Hash table to map from pipe IDs to pipe state table entries; looked up for every packet
 	
 	class LockedPipe // Helper class to obtain locks on pipe state objects retrieved by pipe ID
 		{
@@ -189,11 +194,15 @@ class Multiplexer
 	NewPipeHasher newPipes; // Hash table to map from thread IDs to pipe states not completely opened yet
 	unsigned int lastPipeId; // ID of the most-recently created pipe
 	PipeHasher pipeStateTable; // Hash table to map from pipe IDs to pipe state table entries
-	void* messageBuffer; // A buffer to receive message packets on the master node
+	unsigned char* messageBuffers; // Array of buffers sized for the largest supported MTU size to receive batches of message packets on the master node
 	Threads::Thread packetHandlingThread; // Packet handling thread
-	Packet* slaveThreadPacket; // Pointer to the one packet always held by the packet handling thread on slave nodes
+	Packet** slaveThreadPackets; // Array of packets held by the packet handling thread on slave nodes to receive batches of packets; unused slots are NULL
 	int masterMessageBurstSize; // Number of server messages sent in a single burst
 	int slaveMessageBurstSize; // Number of client messages sent in a single burst
+	size_t mtuSize; // MTU size of packets sent from the master; slaves use the largest supported MTU size until they adopt the master's when connecting
+	size_t maxPacketSize; // Maximum payload size of packets, derived from the MTU size; also the capacity of newly allocated packets
+	size_t maxGatherDataSize; // Maximum amount of data exchanged in a single vector gather operation, limited by the size of a single datagram at the MTU size
+	volatile unsigned int batchSize; // Maximum number of packets sent or received in a single system call
 	Misc::Time connectionWaitTimeout; // Timeout between connection messages from the slaves
 	Misc::Time pingTimeout; // Timeout between ping requests from the slaves
 	int maxPingRequests; // Maximum number of consecutive ping requests before the slave signals a communication error
@@ -205,7 +214,14 @@ class Multiplexer
 	
 	/* Private methods: */
 	Packet* allocatePacket(void);
+	void updateMTUSize(size_t newMTUSize); // Sets the MTU size and derived sizes, and discards pooled packets allocated for the previous MTU size
 	void processAcknowledgment(LockedPipe& pipeState,int slaveIndex,unsigned int streamPos); // Processes an acknowlegment (positive or implied-positive) from a slave
+	void resendPackets(LockedPipe& pipeState,Packet* packet); // Resends the given packet and all its successors in the given pipe's packet list
+	void processSlaveMessage(void* messageBuffer,size_t numBytesReceived); // Processes a message received from a slave on the master node
+	bool processMasterPacket(Packet* packet,unsigned int sendNodeIndex,unsigned int& sendAckIn); // Processes a packet received from the master on a slave node; returns true if the packet was appended to a pipe's delivery queue
+	void resetFlowControl(LockedPipe& pipeState); // Resets the given pipe's flow control state and releases its sent packets after a completed barrier on the master
+	void sendGatherData(unsigned int pipeId,unsigned int barrierId,const void* data,size_t dataSize); // Sends a gather data message for the given vector gather operation to the other end of the connection
+	bool exchangeGatherData(LockedPipe& pipeState,unsigned int pipeId,unsigned int nextBarrierId,const void* data,size_t dataSize,size_t finalDataSize); // Executes the communication part of a vector gather operation; returns true if all nodes contributed the same amount of data
 	void* packetHandlingThreadMaster(void); // Packet handling thread method for the master
 	void* packetHandlingThreadSlave(void); // Packet handling thread method for the slaves
 	
@@ -231,8 +247,13 @@ class Multiplexer
 	void deletePacket(Packet* packet) // Deletes the given multicast packet
 		{
 		Threads::Spinlock::Lock packetPoolLock(packetPoolMutex);
-		packet->succ=packetPoolHead;
-		packetPoolHead=packet;
+		if(packet->capacity==maxPacketSize)
+			{
+			packet->succ=packetPoolHead;
+			packetPoolHead=packet;
+			}
+		else
+			Packet::destroy(packet);
 		}
 	bool isMaster(void) const // Returns true if the local multiplexer is the master node
 		{
@@ -256,6 +277,16 @@ class Multiplexer
 	void setReceiveWaitTimeout(Misc::Time newReceiveWaitTimeout); // Sets the timeout when waiting for data packages
 	void setBarrierWaitTimeout(Misc::Time newBarrierWaitTimeout); // Sets the timeout when waiting for barrier messages
 	void setSendBufferSize(unsigned int newSendBufferSize); // Sets the maximum number of packets held in each pipe's send queue
+	void setMTUSize(size_t newMTUSize); // Sets the maximum transmission unit for packets sent from the master, clamped to [CLUSTER_CONFIG_MIN_MTU_SIZE, CLUSTER_CONFIG_MAX_MTU_SIZE]; must be called on the master before the slaves connect; slaves adopt the master's MTU size when connecting
+	size_t getMTUSize(void) const // Returns the maximum transmission unit for packets sent from the master
+		{
+		return mtuSize;
+		}
+	size_t getMaxPacketSize(void) const // Returns the maximum payload size of packets sent on this multiplexer's pipes
+		{
+		return maxPacketSize;
+		}
+	void setBatchSize(unsigned int newBatchSize); // Sets the maximum number of packets sent or received in a single system call, up to CLUSTER_CONFIG_MAX_BATCH_SIZE
 	void waitForConnection(void); // Waits until all slaves have connected to the master
 	
 	/* Pipe management interface: */
@@ -267,6 +298,12 @@ class Multiplexer
 	Packet* receivePacket(unsigned int pipeId); // Receives a packet from the master
 	void barrier(unsigned int pipeId); // Waits until all nodes (master + slaves) have reached the same point in the program
 	unsigned int gather(unsigned int pipeId,unsigned int value,GatherOperation::OpCode op); // Exchanges a single value between all nodes (master + slaves); implies a barrier
+	size_t getMaxGatherDataSize(void) const // Returns the maximum amount of data in bytes that can be exchanged in a single vector gather operation
+		{
+		return maxGatherDataSize;
+		}
+	void gather(unsigned int pipeId,void* values,size_t numValues,GatherOperation::ValueType valueType,GatherOperation::OpCode op); // Combines arrays of values of the same size element-wise between all nodes in a single exchange and replaces the given array with the final values; implies a barrier
+	void allGather(unsigned int pipeId,const void* value,size_t valueSize,void* values); // Exchanges a data block of the same size between all nodes, and stores all nodes' blocks in order of node index in the given array; implies a barrier
 	};
 
 }
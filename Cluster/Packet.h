@@ -23,7 +23,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef CLUSTER_PACKET_INCLUDED
 #define CLUSTER_PACKET_INCLUDED
 
+#include <stddef.h>
 #include <string.h>
+#include <new>
 #include <Cluster/Config.h>
 
 namespace Cluster {
@@ -33,7 +35,17 @@ struct Packet
 	/* Embedded classes: */
 	public:
 	static const size_t maxRawPacketSize=CLUSTER_CONFIG_MTU_SIZE-CLUSTER_CONFIG_IP_HEADER_SIZE-CLUSTER_CONFIG_UDP_HEADER_SIZE; // Configured MTU size minus IP header size minus UDP header size
-	static const size_t maxPacketSize=CLUSTER_CONFIG_MTU_SIZE-CLUSTER_CONFIG_IP_HEADER_SIZE-CLUSTER_CONFIG_UDP_HEADER_SIZE-2*sizeof(unsigned int); // Maximum size of multicast packet data payload in bytes
+	static const size_t maxPacketSize=CLUSTER_CONFIG_MTU_SIZE-CLUSTER_CONFIG_IP_HEADER_SIZE-CLUSTER_CONFIG_UDP_HEADER_SIZE-2*sizeof(unsigned int); // Maximum size of multicast packet data payload in bytes at the configured MTU size; Multiplexer::getMaxPacketSize() returns the size for the MTU size in use
+	static const size_t maxSupportedRawPacketSize=CLUSTER_CONFIG_MAX_MTU_SIZE-CLUSTER_CONFIG_IP_HEADER_SIZE-CLUSTER_CONFIG_UDP_HEADER_SIZE; // Largest supported MTU size minus IP header size minus UDP header size
+	
+	static size_t getRawPacketSize(size_t mtuSize) // Returns the size of a datagram's UDP payload for the given MTU size
+		{
+		return mtuSize-CLUSTER_CONFIG_IP_HEADER_SIZE-CLUSTER_CONFIG_UDP_HEADER_SIZE;
+		}
+	static size_t getMaxPacketSize(size_t mtuSize) // Returns the maximum size of multicast packet data payload in bytes for the given MTU size
+		{
+		return mtuSize-CLUSTER_CONFIG_IP_HEADER_SIZE-CLUSTER_CONFIG_UDP_HEADER_SIZE-2*sizeof(unsigned int);
+		}
 	
 	class Reader // Simple class to read data from packets
 		{
@@ -109,15 +121,32 @@ struct Packet
 	
 	/* Elements: */
 	Packet* succ; // Pointer to successor in packet queues
+	size_t capacity; // Size of the packet data buffer in bytes
 	size_t packetSize; // Actual size of packet
 	unsigned int pipeId; // ID of the pipe this packet is intended for
 	unsigned int streamPos; // Position of packet data in entire stream that has been sent on pipe so far
-	char packet[maxPacketSize]; // Packet data
+	char packet[1]; // Packet data; extends to the packet's capacity
 	
 	/* Constructors and destructors: */
-	Packet(void) // Creates empty packet
-		:succ(0),packetSize(0)
+	private:
+	Packet(size_t sCapacity) // Creates empty packet with the given data capacity
+		:succ(0),capacity(sCapacity),packetSize(0)
+		{
+		}
+	
+	/* Methods: */
+	public:
+	static Packet* create(size_t capacity) // Allocates an empty packet whose data buffer holds the given number of bytes
+		{
+		/* Allocate a memory block large enough for the packet header and the data buffer: */
+		size_t blockSize=offsetof(Packet,packet)+capacity;
+		if(blockSize<sizeof(Packet))
+			blockSize=sizeof(Packet);
+		return new(new char[blockSize]) Packet(capacity);
+		}
+	static void destroy(Packet* packet) // Releases a packet allocated with create()
 		{
+		delete[] reinterpret_cast<char*>(packet);
 		}
 	};
 
@@ -334,7 +334,7 @@ void StandardFileMaster::openFile(const char* fileName,IO::File::AccessMode acce
 	/* Install a read buffer the size of a multicast packet: */
 	canReadThrough=false;
 	if(accessMode==ReadOnly||accessMode==ReadWrite)
-		IO::SeekableFile::resizeReadBuffer(Packet::maxPacketSize);
+		IO::SeekableFile::resizeReadBuffer(multiplexer->getMaxPacketSize());
 	}
 
 StandardFileMaster::StandardFileMaster(Multiplexer* sMultiplexer,const char* fileName,IO::File::AccessMode accessMode)
@@ -380,7 +380,7 @@ int StandardFileMaster::getFd(void) const
 size_t StandardFileMaster::resizeReadBuffer(size_t newReadBufferSize)
 	{
 	/* Ignore the change and return the size of a multicast packet: */
-	return Packet::maxPacketSize;
+	return multiplexer->getMaxPacketSize();
 	}
 
 IO::SeekableFile::Offset StandardFileMaster::getSize(void) const
@@ -429,7 +429,7 @@ size_t StandardFileSlave::readData(IO::File::Byte* buffer,size_t bufferSize)
 			if(packet!=0)
 				multiplexer->deletePacket(packet);
 			packet=newPacket;
-			setReadBuffer(Packet::maxPacketSize,reinterpret_cast<Byte*>(packet->packet),false);
+			setReadBuffer(packet->capacity,reinterpret_cast<Byte*>(packet->packet),false);
 			
 			/* Advance the read pointer: */
 			readPos+=packet->packetSize;
@@ -570,13 +570,13 @@ int StandardFileSlave::getFd(void) const
 size_t StandardFileSlave::getReadBufferSize(void) const
 	{
 	/* Return the size of a multicast packet: */
-	return Packet::maxPacketSize;
+	return multiplexer->getMaxPacketSize();
 	}
 
 size_t StandardFileSlave::resizeReadBuffer(size_t newReadBufferSize)
 	{
 	/* Ignore the change and return the size of a multicast packet: */
-	return Packet::maxPacketSize;
+	return multiplexer->getMaxPacketSize();
 	}
 
 IO::SeekableFile::Offset StandardFileSlave::getSize(void) const
@@ -413,7 +413,7 @@ TCPPipeMaster::TCPPipeMaster(Multiplexer* sMultiplexer,const char* hostName,int
 	statusPipeId=multiplexer->openPipe();
 	
 	/* Install a read buffer the size of a multicast packet: */
-	Comm::Pipe::resizeReadBuffer(Packet::maxPacketSize);
+	Comm::Pipe::resizeReadBuffer(multiplexer->getMaxPacketSize());
 	canReadThrough=false;
 	}
 
@@ -439,7 +439,7 @@ int TCPPipeMaster::getFd(void) const
 size_t TCPPipeMaster::resizeReadBuffer(size_t newReadBufferSize)
 	{
 	/* Ignore the change and return the size of a multicast packet: */
-	return Packet::maxPacketSize;
+	return multiplexer->getMaxPacketSize();
 	}
 
 bool TCPPipeMaster::waitForData(void) const
@@ -818,7 +818,7 @@ size_t TCPPipeSlave::readData(IO::File::Byte* buffer,size_t bufferSize)
 			if(packet!=0)
 				multiplexer->deletePacket(packet);
 			packet=newPacket;
-			setReadBuffer(Packet::maxPacketSize,reinterpret_cast<Byte*>(packet->packet),false);
+			setReadBuffer(packet->capacity,reinterpret_cast<Byte*>(packet->packet),false);
 			
 			return packet->packetSize;
 			}
@@ -939,13 +939,13 @@ int TCPPipeSlave::getFd(void) const
 size_t TCPPipeSlave::getReadBufferSize(void) const
 	{
 	/* Return the size of a multicast packet: */
-	return Packet::maxPacketSize;
+	return multiplexer->getMaxPacketSize();
 	}
 
 size_t TCPPipeSlave::resizeReadBuffer(size_t newReadBufferSize)
 	{
 	/* Ignore the change and return the size of a multicast packet: */
-	return Packet::maxPacketSize;
+	return multiplexer->getMaxPacketSize();
 	}
 
 bool TCPPipeSlave::waitForData(void) const
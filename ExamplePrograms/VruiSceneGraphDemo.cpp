@@ -19,6 +19,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 ***********************************************************************/
 
+#include <string.h>
 #include <stdio.h>
 #include <string>
 #include <vector>
@@ -93,8 +94,16 @@ VruiSceneGraphDemo::VruiSceneGraphDemo(int& argc,char**& argv)
 		SceneGraph::NodeCreator nodeCreator;
 		
 		/* Load all VRML files from the command line: */
+		bool useCache=false;
 		for(int i=1;i<argc;++i)
 			{
+			if(strcasecmp(argv[i],"-cache")==0)
+				{
+				/* Parse all following VRML files through binary cache files: */
+				useCache=true;
+				continue;
+				}
+			
 			try
 				{
 				/* Create the new scene graph's root node: */
@@ -102,6 +111,7 @@ VruiSceneGraphDemo::VruiSceneGraphDemo(int& argc,char**& argv)
 				
 				/* Load and parse the VRML file: */
 				SceneGraph::VRMLFile vrmlFile(argv[i],Vrui::openFile(argv[i]),nodeCreator,Vrui::getClusterMultiplexer());
+				vrmlFile.setUseCache(useCache);
 				vrmlFile.parse(root);
 				
 				/* Add the new scene graph to the list: */
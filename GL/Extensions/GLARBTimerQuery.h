@@ -0,0 +1,148 @@
+/***********************************************************************
+GLARBTimerQuery - OpenGL extension class for the GL_ARB_timer_query
+extension. Also provides the OpenGL 1.5 query object entry points on
+which the extension is based.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the OpenGL Support Library (GLSupport).
+
+The OpenGL Support Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The OpenGL Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the OpenGL Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef GLEXTENSIONS_GLARBTIMERQUERY_INCLUDED
+#define GLEXTENSIONS_GLARBTIMERQUERY_INCLUDED
+
+#include <GL/gl.h>
+#include <GL/TLSHelper.h>
+#include <GL/Extensions/GLExtension.h>
+
+/********************************
+Extension-specific parts of gl.h:
+********************************/
+
+#ifndef GL_VERSION_1_5
+
+/* Query object functions from OpenGL 1.5: */
+typedef void (APIENTRY * PFNGLGENQUERIESPROC) (GLsizei n, GLuint *ids);
+typedef void (APIENTRY * PFNGLDELETEQUERIESPROC) (GLsizei n, const GLuint *ids);
+typedef void (APIENTRY * PFNGLBEGINQUERYPROC) (GLenum target, GLuint id);
+typedef void (APIENTRY * PFNGLENDQUERYPROC) (GLenum target);
+typedef void (APIENTRY * PFNGLGETQUERYOBJECTIVPROC) (GLuint id, GLenum pname, GLint *params);
+
+/* Query object constants from OpenGL 1.5: */
+#define GL_QUERY_COUNTER_BITS             0x8864
+#define GL_CURRENT_QUERY                  0x8865
+#define GL_QUERY_RESULT                   0x8866
+#define GL_QUERY_RESULT_AVAILABLE         0x8867
+
+#endif
+
+#ifndef GL_ARB_timer_query
+#define GL_ARB_timer_query 1
+
+/* Extension-specific types: */
+typedef long long GLint64;
+typedef unsigned long long GLuint64;
+
+/* Extension-specific functions: */
+typedef void (APIENTRY * PFNGLQUERYCOUNTERPROC) (GLuint id, GLenum target);
+typedef void (APIENTRY * PFNGLGETQUERYOBJECTI64VPROC) (GLuint id, GLenum pname, GLint64 *params);
+typedef void (APIENTRY * PFNGLGETQUERYOBJECTUI64VPROC) (GLuint id, GLenum pname, GLuint64 *params);
+
+/* Extension-specific constants: */
+#define GL_TIME_ELAPSED                   0x88BF
+#define GL_TIMESTAMP                      0x8E28
+
+#endif
+
+/* Forward declarations of friend functions: */
+void glGenQueries(GLsizei n,GLuint* ids);
+void glDeleteQueries(GLsizei n,const GLuint* ids);
+void glBeginQuery(GLenum target,GLuint id);
+void glEndQuery(GLenum target);
+void glGetQueryObjectiv(GLuint id,GLenum pname,GLint* params);
+void glQueryCounter(GLuint id,GLenum target);
+void glGetQueryObjecti64v(GLuint id,GLenum pname,GLint64* params);
+void glGetQueryObjectui64v(GLuint id,GLenum pname,GLuint64* params);
+
+class GLARBTimerQuery:public GLExtension
+	{
+	/* Elements: */
+	private:
+	static GL_THREAD_LOCAL(GLARBTimerQuery*) current; // Pointer to extension object for current OpenGL context
+	static const char* name; // Extension name
+	PFNGLGENQUERIESPROC glGenQueriesProc;
+	PFNGLDELETEQUERIESPROC glDeleteQueriesProc;
+	PFNGLBEGINQUERYPROC glBeginQueryProc;
+	PFNGLENDQUERYPROC glEndQueryProc;
+	PFNGLGETQUERYOBJECTIVPROC glGetQueryObjectivProc;
+	PFNGLQUERYCOUNTERPROC glQueryCounterProc;
+	PFNGLGETQUERYOBJECTI64VPROC glGetQueryObjecti64vProc;
+	PFNGLGETQUERYOBJECTUI64VPROC glGetQueryObjectui64vProc;
+	
+	/* Constructors and destructors: */
+	private:
+	GLARBTimerQuery(void);
+	public:
+	virtual ~GLARBTimerQuery(void);
+	
+	/* Methods: */
+	public:
+	virtual const char* getExtensionName(void) const;
+	virtual void activate(void);
+	virtual void deactivate(void);
+	static bool isSupported(void); // Returns true if the extension is supported in the current OpenGL context
+	static void initExtension(void); // Initializes the extension in the current OpenGL context
+	
+	/* Extension entry points: */
+	inline friend void glGenQueries(GLsizei n,GLuint* ids)
+		{
+		GLARBTimerQuery::current->glGenQueriesProc(n,ids);
+		}
+	inline friend void glDeleteQueries(GLsizei n,const GLuint* ids)
+		{
+		GLARBTimerQuery::current->glDeleteQueriesProc(n,ids);
+		}
+	inline friend void glBeginQuery(GLenum target,GLuint id)
+		{
+		GLARBTimerQuery::current->glBeginQueryProc(target,id);
+		}
+	inline friend void glEndQuery(GLenum target)
+		{
+		GLARBTimerQuery::current->glEndQueryProc(target);
+		}
+	inline friend void glGetQueryObjectiv(GLuint id,GLenum pname,GLint* params)
+		{
+		GLARBTimerQuery::current->glGetQueryObjectivProc(id,pname,params);
+		}
+	inline friend void glQueryCounter(GLuint id,GLenum target)
+		{
+		GLARBTimerQuery::current->glQueryCounterProc(id,target);
+		}
+	inline friend void glGetQueryObjecti64v(GLuint id,GLenum pname,GLint64* params)
+		{
+		GLARBTimerQuery::current->glGetQueryObjecti64vProc(id,pname,params);
+		}
+	inline friend void glGetQueryObjectui64v(GLuint id,GLenum pname,GLuint64* params)
+		{
+		GLARBTimerQuery::current->glGetQueryObjectui64vProc(id,pname,params);
+		}
+	};
+
+/*******************************
+Extension-specific entry points:
+*******************************/
+
+#endif
@@ -37,24 +37,52 @@ GL_THREAD_LOCAL(GLContextData*) GLContextData::currentContextData=0;
 Methods of class GLContextData:
 ******************************/
 
-GLContextData::GLContextData(int sTableSize,float sWaterMark,float sGrowRate)
-	:context(sTableSize,sWaterMark,sGrowRate),
+void GLContextData::growDataItems(unsigned int slot)
+	{
+	/* Grow the data item array geometrically, but at least far enough to hold the given slot: */
+	unsigned int newNumSlots=numSlots*2U;
+	if(newNumSlots<=slot)
+		newNumSlots=slot+1U;
+	
+	/* Copy the existing data items and clear the new slots: */
+	GLObject::DataItem** newDataItems=new GLObject::DataItem*[newNumSlots];
+	for(unsigned int i=0;i<numSlots;++i)
+		newDataItems[i]=dataItems[i];
+	for(unsigned int i=numSlots;i<newNumSlots;++i)
+		newDataItems[i]=0;
+	delete[] dataItems;
+	numSlots=newNumSlots;
+	dataItems=newDataItems;
+	}
+
+GLContextData::GLContextData(int sNumSlots)
+	:numSlots(sNumSlots>0?(unsigned int)(sNumSlots):1U),
+	 dataItems(new GLObject::DataItem*[numSlots]),
 	 lightTracker(new GLLightTracker),
 	 clipPlaneTracker(new GLClipPlaneTracker)
 	{
+	/* Initialize all data item slots: */
+	for(unsigned int i=0;i<numSlots;++i)
+		dataItems[i]=0;
 	}
 
 GLContextData::~GLContextData(void)
 	{
 	/* Delete all data items in this context: */
-	for(ItemHash::Iterator it=context.begin();!it.isFinished();++it)
-		delete it->getDest();
+	for(unsigned int i=0;i<numSlots;++i)
+		delete dataItems[i];
+	delete[] dataItems;
 	
 	/* Delete the state trackers: */
 	delete lightTracker;
 	delete clipPlaneTracker;
 	}
 
+unsigned int GLContextData::allocateThingSlot(void)
+	{
+	return GLThingManager::theThingManager.allocateSlot();
+	}
+
 void GLContextData::initThing(const GLObject* thing)
 	{
 	GLThingManager::theThingManager.initThing(thing);
@@ -62,7 +90,7 @@ void GLContextData::initThing(const GLObject* thing)
 
 void GLContextData::destroyThing(const GLObject* thing)
 	{
-	GLThingManager::theThingManager.destroyThing(thing);
+	GLThingManager::theThingManager.destroyThing(thing,thing->contextDataSlot);
 	}
 
 void GLContextData::orderThings(const GLObject* thing1,const GLObject* thing2)
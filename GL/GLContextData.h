@@ -23,7 +23,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef GLCONTEXTDATA_INCLUDED
 #define GLCONTEXTDATA_INCLUDED
 
-#include <Misc/HashTable.h>
 #include <Misc/CallbackData.h>
 #include <Misc/CallbackList.h>
 #include <GL/TLSHelper.h>
@@ -32,9 +31,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 /* Forward declarations: */
 class GLLightTracker;
 class GLClipPlaneTracker;
+class GLThingManager;
 
 class GLContextData
 	{
+	friend class GLThingManager;
+	
 	/* Embedded classes: */
 	public:
 	struct CurrentContextDataChangedCallbackData:public Misc::CallbackData
@@ -51,22 +53,34 @@ class GLContextData
 			}
 		};
 	
-	private:
-	typedef Misc::HashTable<const GLObject*,GLObject::DataItem*> ItemHash; // Class for hash table mapping pointers to data items
-	
 	/* Elements: */
+	private:
 	static Misc::CallbackList currentContextDataChangedCallbacks; // List of callbacks called whenever the current context data object changes
 	static GL_THREAD_LOCAL(GLContextData*) currentContextData; // Pointer to the current context data object (associated with the current OpenGL context)
-	ItemHash context; // A hash table for the context
+	unsigned int numSlots; // Number of allocated data item slots
+	GLObject::DataItem** dataItems; // Array of data items, indexed by the context data slots of their associated things; null for things without data items
 	GLLightTracker* lightTracker; // An object to track the OpenGL context's lighting state
 	GLClipPlaneTracker* clipPlaneTracker; // An object to track the OpenGL context's clipping plane state
 	
+	/* Private methods: */
+	void growDataItems(unsigned int slot); // Grows the data item array to hold at least the given slot
+	void removeSlotDataItem(unsigned int slot) // Deletes the data item in the given slot, if there is one
+		{
+		if(slot<numSlots)
+			{
+			/* Delete the data item (hopefully freeing all resources): */
+			delete dataItems[slot];
+			dataItems[slot]=0;
+			}
+		}
+	
 	/* Constructors and destructors: */
 	public:
-	GLContextData(int sTableSize,float sWaterMark =0.9f,float sGrowRate =1.7312543); // Constructs an empty context
+	GLContextData(int sNumSlots); // Constructs an empty context with room for data items of the given number of things
 	~GLContextData(void);
 	
 	/* Methods to manage object initializations and clean-ups: */
+	static unsigned int allocateThingSlot(void); // Returns an unused context data slot for a newly-created thing
 	static void initThing(const GLObject* thing); // Marks a thing for context initialization
 	static void destroyThing(const GLObject* thing); // Marks a thing for context data removal
 	static void orderThings(const GLObject* thing1,const GLObject* thing2); // Asks thing manager to always initialize thing1 before thing2
@@ -88,37 +102,29 @@ class GLContextData
 	/* Methods to store/retrieve context data items: */
 	bool isRealized(const GLObject* thing) const
 		{
-		return context.isEntry(thing);
+		return thing->contextDataSlot<numSlots&&dataItems[thing->contextDataSlot]!=0;
 		}
 	void addDataItem(const GLObject* thing,GLObject::DataItem* dataItem)
 		{
-		context.setEntry(ItemHash::Entry(thing,dataItem));
+		/* Make room for the thing's slot if necessary: */
+		if(thing->contextDataSlot>=numSlots)
+			growDataItems(thing->contextDataSlot);
+		
+		dataItems[thing->contextDataSlot]=dataItem;
 		}
 	template <class DataItemParam>
 	DataItemParam* retrieveDataItem(const GLObject* thing)
 		{
 		/* Find the data item associated with the given thing: */
-		ItemHash::Iterator dataIt=context.findEntry(thing);
-		if(dataIt.isFinished())
+		if(thing->contextDataSlot>=numSlots)
 			return 0;
-		else
-			{
-			/* Cast the data item's pointer to the requested type and return it: */
-			return dynamic_cast<DataItemParam*>(dataIt->getDest());
-			}
+		
+		/* Cast the data item's pointer to the requested type and return it: */
+		return dynamic_cast<DataItemParam*>(dataItems[thing->contextDataSlot]);
 		}
 	void removeDataItem(const GLObject* thing)
 		{
-		/* Find the data item associated with the given thing: */
-		ItemHash::Iterator dataIt=context.findEntry(thing);
-		if(!dataIt.isFinished())
-			{
-			/* Delete the data item (hopefully freeing all resources): */
-			delete dataIt->getDest();
-			
-			/* Remove the data item from the hash table: */
-			context.removeEntry(dataIt);
-			}
+		removeSlotDataItem(thing->contextDataSlot);
 		}
 	
 	/* Methods to retrieve other context-related state: */
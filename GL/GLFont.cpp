@@ -32,8 +32,48 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLTexEnvTemplates.h>
 #include <GL/GLTexCoordTemplates.h>
 #include <GL/GLVertexTemplates.h>
+#include <GL/GLContextData.h>
 #include <GL/Config.h>
 
+/****************
+Helper functions:
+****************/
+
+static void lowpassFilter(GLubyte* image,GLsizei width,GLsizei height,GLsizei stride)
+	{
+	/* Low-pass filter each image column using a 1D tent filter: */
+	for(GLsizei x=0;x<width;++x)
+		{
+		GLubyte* iPtr=image+x;
+		GLuint last=iPtr[0];
+		iPtr[0]=GLubyte((last*3U+GLuint(iPtr[stride])+2U)>>2);
+		iPtr+=stride;
+		for(GLsizei y=2;y<height;++y,iPtr+=stride)
+			{
+			GLuint nextLast=iPtr[0];
+			iPtr[0]=GLubyte((last+nextLast*2U+GLuint(iPtr[stride])+2U)>>2);
+			last=nextLast;
+			}
+		iPtr[0]=GLubyte((last+GLuint(iPtr[0])*3U+2U)>>2);
+		}
+	
+	/* Low-pass filter each image row using a 1D tent filter: */
+	for(GLsizei y=0;y<height;++y)
+		{
+		GLubyte* iPtr=image+y*stride;
+		GLuint last=iPtr[0];
+		iPtr[0]=GLubyte((last*3U+GLuint(iPtr[1])+2U)>>2);
+		++iPtr;
+		for(GLsizei x=2;x<width;++x,++iPtr)
+			{
+			GLuint nextLast=iPtr[0];
+			iPtr[0]=GLubyte((last+nextLast*2U+GLuint(iPtr[1])+2U)>>2);
+			last=nextLast;
+			}
+		iPtr[0]=GLubyte((last+GLuint(iPtr[0])*3U+2U)>>2);
+		}
+	}
+
 /*********************************
 Methods of class GLFont::CharInfo:
 *********************************/
@@ -48,6 +88,23 @@ void GLFont::CharInfo::read(IO::File& file)
 	file.read(spanOffset);
 	}
 
+/*********************************
+Methods of class GLFont::DataItem:
+*********************************/
+
+GLFont::DataItem::DataItem(void)
+	{
+	for(int i=0;i<2;++i)
+		atlasTextureObjectIds[i]=0;
+	}
+
+GLFont::DataItem::~DataItem(void)
+	{
+	for(int i=0;i<2;++i)
+		if(atlasTextureObjectIds[i]!=0)
+			glDeleteTextures(1,&atlasTextureObjectIds[i]);
+	}
+
 /***********************
 Methods of class GLFont:
 ***********************/
@@ -456,14 +513,156 @@ void GLFont::loadFont(IO::File& file)
 	for(GLint i=0;i<10;++i)
 		totalWidth+=characters[i+GLint('0')-firstCharacter].width;
 	averageWidth=GLfloat(totalWidth)/(10.0f*GLfloat(fontHeight));
+	
+	/* Pack all glyphs into the glyph atlas: */
+	layoutGlyphAtlas();
+	}
+
+void GLFont::layoutGlyphAtlas(void)
+	{
+	/* Calculate the extents of all glyphs' set pixels: */
+	glyphs=new GlyphInfo[numCharacters];
+	GLsizei totalArea=4*4;
+	GLsizei maxGlyphWidth=4;
+	for(GLsizei i=0;i<numCharacters;++i)
+		{
+		const CharInfo& ci=characters[i];
+		const unsigned char* rasterLine=&rasterLines[ci.rasterLineOffset];
+		const unsigned char* span=&spans[ci.spanOffset];
+		int left=ci.glyphOffset+ci.width+maxRightLap+1;
+		int right=ci.glyphOffset-maxLeftLap-1;
+		for(int y=0;y<ci.descent+ci.ascent;++y,++rasterLine)
+			{
+			int x=ci.glyphOffset;
+			int numSpans=int(*rasterLine);
+			for(int j=0;j<numSpans;++j,++span)
+				{
+				x+=int((*span)>>3);
+				int numPixels=int((*span)&0x07);
+				if(numPixels>0)
+					{
+					if(left>x)
+						left=x;
+					x+=numPixels;
+					if(right<x)
+						right=x;
+					}
+				}
+			}
+		
+		GlyphInfo& gi=glyphs[i];
+		if(left<right)
+			{
+			/* Account for the glyph and a one-texel border around it: */
+			gi.inkLeft=GLshort(left);
+			gi.inkRight=GLshort(right);
+			GLsizei glyphWidth=GLsizei(right-left)+2;
+			totalArea+=glyphWidth*GLsizei(ci.descent+ci.ascent+2);
+			if(maxGlyphWidth<glyphWidth)
+				maxGlyphWidth=glyphWidth;
+			}
+		else
+			gi.inkLeft=gi.inkRight=0;
+		gi.atlasX=gi.atlasY=0;
+		}
+	
+	/* Calculate the atlas texture width: */
+	for(atlasWidth=64;atlasWidth*atlasWidth<totalArea||atlasWidth<maxGlyphWidth;atlasWidth<<=1)
+		;
+	
+	/* Pack the glyphs into rows of the font's height, starting with a fully opaque block for string backgrounds: */
+	GLsizei rowHeight=fontHeight>4?fontHeight:4;
+	GLsizei x=4;
+	GLsizei y=0;
+	for(GLsizei i=0;i<numCharacters;++i)
+		{
+		GlyphInfo& gi=glyphs[i];
+		if(gi.inkLeft<gi.inkRight)
+			{
+			/* Start a new row if the glyph does not fit into the current one: */
+			GLsizei glyphWidth=GLsizei(gi.inkRight-gi.inkLeft)+2;
+			if(x+glyphWidth>atlasWidth)
+				{
+				x=0;
+				y+=rowHeight;
+				}
+			
+			/* Place the glyph's set pixels inside its border: */
+			gi.atlasX=GLshort(x+1);
+			gi.atlasY=GLshort(y+1);
+			x+=glyphWidth;
+			}
+		}
+	
+	/* Calculate the atlas texture height: */
+	for(atlasHeight=1;atlasHeight<y+rowHeight;atlasHeight<<=1)
+		;
+	}
+
+void GLFont::uploadGlyphAtlas(bool atlasAntialiasing) const
+	{
+	/* Create an alpha-only texture image of appropriate size: */
+	GLubyte* image=new GLubyte[atlasWidth*atlasHeight];
+	memset(image,0,atlasWidth*atlasHeight);
+	
+	/* Create the fully opaque block used to render string backgrounds: */
+	for(GLsizei y=0;y<4;++y)
+		memset(image+y*atlasWidth,255,4);
+	
+	/* Copy all glyphs into the texture image: */
+	for(GLsizei i=0;i<numCharacters;++i)
+		{
+		const CharInfo& ci=characters[i];
+		const GlyphInfo& gi=glyphs[i];
+		if(gi.inkLeft<gi.inkRight)
+			{
+			const unsigned char* rasterLine=&rasterLines[ci.rasterLineOffset];
+			const unsigned char* span=&spans[ci.spanOffset];
+			
+			/* Copy all raster lines: */
+			for(int y=0;y<ci.descent+ci.ascent;++y,++rasterLine)
+				{
+				/* Copy all spans in this line: */
+				GLubyte* texPtr=&image[atlasWidth*(gi.atlasY+y)+gi.atlasX-gi.inkLeft+ci.glyphOffset];
+				int numSpans=int(*rasterLine);
+				for(int j=0;j<numSpans;++j,++span)
+					{
+					texPtr+=int((*span)>>3);
+					int numPixels=int((*span)&0x07);
+					for(int k=0;k<numPixels;++k,++texPtr)
+						*texPtr=GLubyte(255);
+					}
+				}
+			
+			/* Low-pass filter the glyph and its border: */
+			if(atlasAntialiasing)
+				lowpassFilter(&image[atlasWidth*(gi.atlasY-1)+gi.atlasX-1],GLsizei(gi.inkRight-gi.inkLeft)+2,GLsizei(ci.descent+ci.ascent)+2,atlasWidth);
+			}
+		}
+	
+	/* Upload the created texture image: */
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS,0);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH,0);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS,0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+	glTexImage2D(GL_TEXTURE_2D,0,GL_ALPHA8,atlasWidth,atlasHeight,0,GL_ALPHA,GL_UNSIGNED_BYTE,image);
+	
+	/* Clean up and return: */
+	delete[] image;
 	}
 
 GLFont::GLFont(const char* fontName)
-	:firstCharacter(0),numCharacters(0),maxAscent(0),maxDescent(0),
+	:GLObject(false),
+	 firstCharacter(0),numCharacters(0),maxAscent(0),maxDescent(0),
 	 maxLeftLap(0),maxRightLap(0),characters(0),
 	 numRasterLines(0),rasterLines(0),
 	 numSpans(0),spans(0),
 	 fontHeight(0),textureHeight(0),
+	 glyphs(0),atlasWidth(0),atlasHeight(0),
 	 textHeight(1.0),hAlignment(Left),vAlignment(Baseline),
 	 antialiasing(false)
 	{
@@ -524,6 +723,14 @@ GLFont::~GLFont(void)
 	delete[] characters;
 	delete[] rasterLines;
 	delete[] spans;
+	delete[] glyphs;
+	}
+
+void GLFont::initContext(GLContextData& contextData) const
+	{
+	/* Create a data item; glyph atlas textures are created on first use: */
+	DataItem* dataItem=new DataItem;
+	contextData.addDataItem(this,dataItem);
 	}
 
 GLFont::Vector GLFont::calcStringSize(GLsizei stringWidth) const
@@ -751,3 +958,95 @@ void GLFont::drawString(const GLFont::Vector& origin,const char* string) const
 	glEnd();
 	glPopAttrib();
 	}
+
+void GLFont::calcGlyphQuads(const char* string,GLsizei textureWidth,const GLFont::TBox& stringTexCoords,const GLFont::Box& stringBox,std::vector<GLFont::GlyphQuad>& quads) const
+	{
+	if(string==0)
+		return;
+	
+	/* Calculate the mapping from string texel space to model space: */
+	GLfloat scale[2],offset[2];
+	GLfloat texSize[2]={GLfloat(textureWidth),GLfloat(textureHeight)};
+	for(int i=0;i<2;++i)
+		{
+		if(!(stringTexCoords.size[i]>0.0f&&stringBox.size[i]>0.0f))
+			return;
+		scale[i]=stringBox.size[i]/(stringTexCoords.size[i]*texSize[i]);
+		offset[i]=stringBox.origin[i]-stringTexCoords.origin[i]*texSize[i]*scale[i];
+		}
+	GLfloat atlasSize[2]={GLfloat(atlasWidth),GLfloat(atlasHeight)};
+	
+	/* Create a quad for each character's glyph and its one-texel border: */
+	int x=maxLeftLap+1;
+	for(const char* cPtr=string;*cPtr!=0;++cPtr)
+		{
+		int charIndex=int(*cPtr)-firstCharacter;
+		if(charIndex>=0&&charIndex<numCharacters)
+			{
+			const CharInfo& ci=characters[charIndex];
+			const GlyphInfo& gi=glyphs[charIndex];
+			if(gi.inkLeft<gi.inkRight)
+				{
+				/* Calculate the glyph's texel-space box in the string's and the atlas's texture images: */
+				GLfloat t0[2]={GLfloat(x+gi.inkLeft-1),GLfloat(baseLine-ci.descent-1)};
+				GLfloat t1[2]={GLfloat(x+gi.inkRight+1),GLfloat(baseLine+ci.ascent+1)};
+				GLfloat a0[2]={GLfloat(gi.atlasX-1),GLfloat(gi.atlasY-1)};
+				
+				/* Map the glyph to model space and clip it against the string box: */
+				GlyphQuad q;
+				bool visible=true;
+				for(int i=0;i<2&&visible;++i)
+					{
+					GLfloat m0=offset[i]+t0[i]*scale[i];
+					GLfloat m1=offset[i]+t1[i]*scale[i];
+					GLfloat a1=a0[i]+(t1[i]-t0[i]);
+					if(m0<stringBox.origin[i])
+						{
+						a0[i]+=(stringBox.origin[i]-m0)/scale[i];
+						m0=stringBox.origin[i];
+						}
+					if(m1>stringBox.origin[i]+stringBox.size[i])
+						{
+						a1-=(m1-(stringBox.origin[i]+stringBox.size[i]))/scale[i];
+						m1=stringBox.origin[i]+stringBox.size[i];
+						}
+					visible=m0<m1;
+					q.box.origin[i]=m0;
+					q.box.size[i]=m1-m0;
+					q.texBox.origin[i]=a0[i]/atlasSize[i];
+					q.texBox.size[i]=(a1-a0[i])/atlasSize[i];
+					}
+				if(visible)
+					{
+					q.box.origin[2]=stringBox.origin[2];
+					q.box.size[2]=0.0f;
+					quads.push_back(q);
+					}
+				}
+			
+			x+=ci.width;
+			}
+		}
+	}
+
+void GLFont::bindGlyphAtlas(GLContextData& contextData) const
+	{
+	/* Retrieve the context data item, or create it if the font was created after the current context was initialized: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	if(dataItem==0)
+		{
+		dataItem=new DataItem;
+		contextData.addDataItem(this,dataItem);
+		}
+	
+	/* Bind the glyph atlas texture for the current antialiasing mode, and create it on first use: */
+	GLuint& textureObjectId=dataItem->atlasTextureObjectIds[antialiasing?1:0];
+	if(textureObjectId==0)
+		{
+		glGenTextures(1,&textureObjectId);
+		glBindTexture(GL_TEXTURE_2D,textureObjectId);
+		uploadGlyphAtlas(antialiasing);
+		}
+	else
+		glBindTexture(GL_TEXTURE_2D,textureObjectId);
+	}
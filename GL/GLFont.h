@@ -22,19 +22,22 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef GLFONT_INCLUDED
 #define GLFONT_INCLUDED
 
+#include <vector>
 #include <Misc/Endianness.h>
 #include <GL/gl.h>
 #include <GL/GLColor.h>
 #include <GL/GLVector.h>
 #include <GL/GLBox.h>
 #include <GL/GLString.h>
+#include <GL/GLObject.h>
 
 /* Forward declarations: */
 namespace IO {
 class File;
 }
+class GLContextData;
 
-class GLFont
+class GLFont:public GLObject
 	{
 	/* Embedded classes: */
 	public:
@@ -53,6 +56,14 @@ class GLFont
 		Top,VCenter,Baseline,Bottom
 		};
 	
+	struct GlyphQuad // Structure describing a textured quad rendering a single character glyph from the font's glyph atlas
+		{
+		/* Elements: */
+		public:
+		TBox texBox; // Texture coordinates of the glyph in the glyph atlas
+		Box box; // Model-space box of the glyph
+		};
+	
 	private:
 	struct CharInfo
 		{
@@ -69,6 +80,25 @@ class GLFont
 		void read(IO::File& file); // Reads a CharInfo structure from a font file
 		};
 	
+	struct GlyphInfo // Structure describing a character's glyph in the glyph atlas
+		{
+		/* Elements: */
+		public:
+		GLshort inkLeft,inkRight; // Horizontal extent of the glyph's set pixels relative to the left edge of the character box; empty if inkLeft>=inkRight
+		GLshort atlasX,atlasY; // Position of the glyph's set pixels in the glyph atlas
+		};
+	
+	struct DataItem:public GLObject::DataItem
+		{
+		/* Elements: */
+		public:
+		GLuint atlasTextureObjectIds[2]; // IDs of glyph atlas texture objects without and with antialiasing, or 0 if not yet created
+		
+		/* Constructors and destructors: */
+		DataItem(void);
+		virtual ~DataItem(void);
+		};
+	
 	/* Elements: */
 	GLint firstCharacter; // Index of first character in font
 	GLsizei numCharacters; // Number of characters in font
@@ -83,6 +113,8 @@ class GLFont
 	GLint baseLine; // Position of baseline
 	GLsizei textureHeight; // Height of a texture image to hold a single line of text
 	GLfloat averageWidth; // Average width of a character box
+	GlyphInfo* glyphs; // Array of glyph atlas descriptors for all characters
+	GLsizei atlasWidth,atlasHeight; // Size of the glyph atlas texture image
 	
 	/* Current font status: */
 	GLfloat textHeight; // Scaled height of font
@@ -98,13 +130,18 @@ class GLFont
 	void uploadStringTexture(const char* string,const Color& stringBackgroundColor,const Color& stringForegroundColor,GLsizei stringWidth,GLsizei textureWidth) const; // Creates and uploads a texture for a string using the given colors
 	void uploadStringTexture(const char* string,const Color& stringBackgroundColor,const Color& stringForegroundColor,GLsizei selectionStart,GLsizei selectionEnd,const Color& selectionBackgroundColor,const Color& selectionForegroundColor,GLsizei stringWidth,GLsizei textureWidth) const; // Creates and uploads a texture for a string using the given colors, selection range, and selection colors
 	void loadFont(IO::File& file); // Loads font from given file
+	void layoutGlyphAtlas(void); // Packs all character glyphs into a glyph atlas texture image
+	void uploadGlyphAtlas(bool atlasAntialiasing) const; // Creates and uploads the glyph atlas texture image with or without antialiasing
 	
 	/* Constructors and Destructors: */
 	public:
 	GLFont(const char* fontName); // Creates a GL font from a font file
-	~GLFont(void);
+	virtual ~GLFont(void);
+	
+	/* Methods from GLObject: */
+	virtual void initContext(GLContextData& contextData) const;
 	
-	/* Methods: */
+	/* New methods: */
 	bool isValid(void) const // Checks if the font object was created successfully
 		{
 		return characters!=0;
@@ -219,6 +256,18 @@ class GLFont
 	void uploadStringTexture(const char* string,const Color& stringBackgroundColor,const Color& stringForegroundColor,GLsizei selectionStart,GLsizei selectionEnd,const Color& selectionBackgroundColor,const Color& selectionForegroundColor) const; // Uploads a string's texture image with the given colors, selection range, and selection colors
 	void uploadStringTexture(const GLString& string,const Color& stringBackgroundColor,const Color& stringForegroundColor,GLsizei selectionStart,GLsizei selectionEnd,const Color& selectionBackgroundColor,const Color& selectionForegroundColor) const; // Ditto
 	void drawString(const Vector& origin,const char* string) const; // Draws a simple, one-line string
+	
+	/* Glyph atlas methods: */
+	TBox::Vector getGlyphAtlasSolidTexCoord(void) const // Returns a texture coordinate at which the glyph atlas is fully opaque, to render string backgrounds
+		{
+		return TBox::Vector(2.0f/GLfloat(atlasWidth),2.0f/GLfloat(atlasHeight));
+		}
+	void calcGlyphQuads(const char* string,GLsizei textureWidth,const TBox& stringTexCoords,const Box& stringBox,std::vector<GlyphQuad>& quads) const; // Appends quads rendering the given string's glyphs from the glyph atlas to the given list, mapping the string's texture coordinate box to the given model-space box and clipping glyphs against it
+	void calcGlyphQuads(const GLString& string,const Box& stringBox,std::vector<GlyphQuad>& quads) const // Ditto, for a GL string
+		{
+		calcGlyphQuads(string.string,string.textureWidth,string.textureBox,stringBox,quads);
+		}
+	void bindGlyphAtlas(GLContextData& contextData) const; // Binds the glyph atlas texture for the current antialiasing mode to GL_TEXTURE_2D in the current OpenGL context
 	};
 
 #endif
@@ -21,16 +21,32 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <GL/GLLabel.h>
 
+#include <algorithm>
 #include <GL/gl.h>
 #include <GL/GLColorTemplates.h>
 #include <GL/GLTexCoordTemplates.h>
 #include <GL/GLVertexTemplates.h>
 #include <GL/GLTexEnvTemplates.h>
 #include <GL/GLVector.h>
+#include <GL/GLVertexArrayParts.h>
 #include <GL/GLLightTracker.h>
 #include <GL/GLFont.h>
 #include <GL/GLContextData.h>
 
+/****************
+Helper functions:
+****************/
+
+struct FontOrder // Functor to order labels by their fonts
+	{
+	/* Methods: */
+	public:
+	bool operator()(const GLLabel* l1,const GLLabel* l2) const
+		{
+		return l1->getFont()<l2->getFont();
+		}
+	};
+
 /**************************************************
 Static elements of class GLLabel::DeferredRenderer:
 **************************************************/
@@ -64,61 +80,35 @@ void GLLabel::DeferredRenderer::draw(void)
 	if(gatheredLabels.empty())
 		return;
 	
-	/* Save and set up OpenGL state: */
-	GLLightTracker* lt=contextData.getLightTracker();
-	if(lt->isLightingEnabled()&&!lt->isSpecularColorSeparate())
-		{
-		/* Temporarily turn on separate specular color handling: */
-		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SEPARATE_SPECULAR_COLOR);
-		}
+	/* Group the gathered labels by font, retaining their order within each group: */
+	std::stable_sort(gatheredLabels.begin(),gatheredLabels.end(),FontOrder());
 	
-	/* Set appropriate texture mode for current lighting state: */
-	glPushAttrib(GL_ENABLE_BIT|GL_TEXTURE_BIT);
-	glEnable(GL_TEXTURE_2D);
-	glTexEnvMode(GLTexEnvEnums::TEXTURE_ENV,lt->isLightingEnabled()?GLTexEnvEnums::MODULATE:GLTexEnvEnums::REPLACE);
-	
-	/* Draw each gathered label: */
-	for(std::vector<const GLLabel*>::iterator lIt=gatheredLabels.begin();lIt!=gatheredLabels.end();++lIt)
+	/* Draw each group of labels sharing a font as a single batch: */
+	std::vector<const GLLabel*>::iterator groupBegin=gatheredLabels.begin();
+	while(groupBegin!=gatheredLabels.end())
 		{
-		const GLLabel* l=*lIt;
+		const GLFont* font=(*groupBegin)->font;
 		
-		/* Retrieve the context data item: */
-		GLLabel::DataItem* dataItem=contextData.retrieveDataItem<GLLabel::DataItem>(*lIt);
+		/* Collect the background quads of all labels in the group: */
+		std::vector<const GLLabel*>::iterator groupEnd;
+		batchVertices.clear();
+		for(groupEnd=groupBegin;groupEnd!=gatheredLabels.end()&&(*groupEnd)->font==font;++groupEnd)
+			if(!(*groupEnd)->vertices.empty())
+				batchVertices.insert(batchVertices.end(),(*groupEnd)->vertices.begin(),(*groupEnd)->vertices.begin()+4);
+		GLsizei numBackgroundVertices=GLsizei(batchVertices.size());
 		
-		/* Bind the label texture: */
-		glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectId);
+		/* Collect the glyph quads of all labels in the group: */
+		for(std::vector<const GLLabel*>::iterator lIt=groupBegin;lIt!=groupEnd;++lIt)
+			if(!(*lIt)->vertices.empty())
+				batchVertices.insert(batchVertices.end(),(*lIt)->vertices.begin()+4,(*lIt)->vertices.end());
 		
-		/* Check if the texture object needs to be updated: */
-		if(dataItem->version!=l->version)
-			{
-			/* Upload the string's texture image: */
-			l->font->uploadStringTexture(*l,l->background,l->foreground);
-			
-			/* Update the texture version number: */
-			dataItem->version=l->version;
-			}
+		/* Draw the batch: */
+		if(numBackgroundVertices>0)
+			GLLabel::drawVertices(*font,&batchVertices[0],numBackgroundVertices,GLsizei(batchVertices.size())-numBackgroundVertices,contextData);
 		
-		/* Draw a textured quad: */
-		glColor4f(1.0f,1.0f,1.0f,l->background[3]);
-		glBegin(GL_QUADS);
-		glNormal3f(0.0f,0.0f,1.0f);
-		glTexCoord(l->textureBox.getCorner(0));
-		glVertex(l->labelBox.getCorner(0));
-		glTexCoord(l->textureBox.getCorner(1));
-		glVertex(l->labelBox.getCorner(1));
-		glTexCoord(l->textureBox.getCorner(3));
-		glVertex(l->labelBox.getCorner(3));
-		glTexCoord(l->textureBox.getCorner(2));
-		glVertex(l->labelBox.getCorner(2));
-		glEnd();
+		groupBegin=groupEnd;
 		}
 	
-	/* Reset OpenGL state: */
-	glBindTexture(GL_TEXTURE_2D,0);
-	glPopAttrib();
-	if(lt->isLightingEnabled()&&!lt->isSpecularColorSeparate())
-		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SINGLE_COLOR);
-	
 	/* Clear the list of labels: */
 	gatheredLabels.clear();
 	}
@@ -139,12 +129,88 @@ bool GLLabel::DeferredRenderer::addLabel(const GLLabel* label)
 Methods of class GLLabel:
 ************************/
 
+void GLLabel::updateVertices(void)
+	{
+	vertices.clear();
+	if(font==0)
+		return;
+	
+	/* Create the background quad, textured from the glyph atlas's opaque block: */
+	Vertex v;
+	v.texCoord=font->getGlyphAtlasSolidTexCoord();
+	v.color=background;
+	static const int quadCorners[4]={0,1,3,2};
+	for(int i=0;i<4;++i)
+		{
+		v.position=labelBox.getCorner(quadCorners[i]);
+		vertices.push_back(v);
+		}
+	
+	/* Create the glyph quads: */
+	std::vector<GLFont::GlyphQuad> quads;
+	font->calcGlyphQuads(*this,labelBox,quads);
+	v.color=foreground;
+	for(std::vector<GLFont::GlyphQuad>::iterator qIt=quads.begin();qIt!=quads.end();++qIt)
+		for(int i=0;i<4;++i)
+			{
+			v.texCoord=qIt->texBox.getCorner(quadCorners[i]);
+			v.position=qIt->box.getCorner(quadCorners[i]);
+			vertices.push_back(v);
+			}
+	}
+
+void GLLabel::drawVertices(const GLFont& font,const GLLabel::Vertex* vertices,GLsizei numBackgroundVertices,GLsizei numGlyphVertices,GLContextData& contextData)
+	{
+	/* Save and set up OpenGL state: */
+	GLLightTracker* lt=contextData.getLightTracker();
+	if(lt->isLightingEnabled()&&!lt->isSpecularColorSeparate())
+		{
+		/* Temporarily turn on separate specular color handling: */
+		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SEPARATE_SPECULAR_COLOR);
+		}
+	
+	/* Modulate the vertex colors with the glyph atlas's coverage: */
+	glPushAttrib(GL_COLOR_BUFFER_BIT|GL_ENABLE_BIT|GL_POLYGON_BIT|GL_TEXTURE_BIT);
+	glEnable(GL_TEXTURE_2D);
+	glTexEnvMode(GLTexEnvEnums::TEXTURE_ENV,GLTexEnvEnums::MODULATE);
+	font.bindGlyphAtlas(contextData);
+	
+	/* Set up the vertex array: */
+	GLVertexArrayParts::enable(Vertex::getPartsMask());
+	glNormal3f(0.0f,0.0f,1.0f);
+	glVertexPointer(vertices);
+	
+	/* Draw all background quads: */
+	glDrawArrays(GL_QUADS,0,numBackgroundVertices);
+	
+	if(numGlyphVertices>0)
+		{
+		/* Blend all glyph quads on top of the background quads: */
+		glEnable(GL_POLYGON_OFFSET_FILL);
+		glPolygonOffset(-1.0f,-1.0f);
+		glEnable(GL_ALPHA_TEST);
+		glAlphaFunc(GL_GREATER,0.0f);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
+		glDrawArrays(GL_QUADS,numBackgroundVertices,numGlyphVertices);
+		}
+	
+	/* Reset OpenGL state: */
+	GLVertexArrayParts::disable(Vertex::getPartsMask());
+	glBindTexture(GL_TEXTURE_2D,0);
+	glPopAttrib();
+	if(lt->isLightingEnabled()&&!lt->isSpecularColorSeparate())
+		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SINGLE_COLOR);
+	}
+
 GLLabel::GLLabel(const char* sString,const GLFont& sFont)
 	:GLString(sString,sFont),font(&sFont),
 	 background(font->getBackgroundColor()),foreground(font->getForegroundColor()),
 	 version(1),
 	 labelBox(Box::Vector(0.0f,0.0f,0.0f),font->calcStringSize(texelWidth))
 	{
+	/* Calculate the label's vertices: */
+	updateVertices();
 	}
 
 GLLabel::GLLabel(const char* sStringBegin,const char* sStringEnd,const GLFont& sFont)
@@ -153,6 +219,8 @@ GLLabel::GLLabel(const char* sStringBegin,const char* sStringEnd,const GLFont& s
 	 version(1),
 	 labelBox(Box::Vector(0.0f,0.0f,0.0f),font->calcStringSize(texelWidth))
 	{
+	/* Calculate the label's vertices: */
+	updateVertices();
 	}
 
 GLLabel::GLLabel(const GLString& sString,const GLFont& sFont)
@@ -161,6 +229,8 @@ GLLabel::GLLabel(const GLString& sString,const GLFont& sFont)
 	 version(1),
 	 labelBox(Box::Vector(0.0f,0.0f,0.0f),font->calcStringSize(texelWidth))
 	{
+	/* Calculate the label's vertices: */
+	updateVertices();
 	}
 
 GLLabel::GLLabel(const GLLabel& source)
@@ -169,6 +239,8 @@ GLLabel::GLLabel(const GLLabel& source)
 	 version(1),
 	 labelBox(Box::Vector(0.0f,0.0f,0.0f),font->calcStringSize(texelWidth))
 	{
+	/* Calculate the label's vertices: */
+	updateVertices();
 	}
 
 GLLabel& GLLabel::operator=(const GLLabel& source)
@@ -188,6 +260,9 @@ GLLabel& GLLabel::operator=(const GLLabel& source)
 		
 		/* Copy the label box: */
 		labelBox=source.labelBox;
+		
+		/* Update the label's vertices: */
+		updateVertices();
 		}
 	
 	return *this;
@@ -204,6 +279,9 @@ void GLLabel::setString(const char* newString,const GLFont& newFont)
 	
 	/* Update the label box size: */
 	labelBox.size=font->calcStringSize(texelWidth);
+	
+	/* Update the label's vertices: */
+	updateVertices();
 	}
 
 void GLLabel::setString(const char* newStringBegin,const char* newStringEnd,const GLFont& newFont)
@@ -217,6 +295,9 @@ void GLLabel::setString(const char* newStringBegin,const char* newStringEnd,cons
 	
 	/* Update the label box size: */
 	labelBox.size=font->calcStringSize(texelWidth);
+	
+	/* Update the label's vertices: */
+	updateVertices();
 	}
 
 void GLLabel::adoptString(char* newString,const GLFont& newFont)
@@ -230,6 +311,9 @@ void GLLabel::adoptString(char* newString,const GLFont& newFont)
 	
 	/* Update the label box size: */
 	labelBox.size=font->calcStringSize(texelWidth);
+	
+	/* Update the label's vertices: */
+	updateVertices();
 	}
 
 void GLLabel::adoptString(GLsizei newLength,char* newString,const GLFont& newFont)
@@ -243,6 +327,9 @@ void GLLabel::adoptString(GLsizei newLength,char* newString,const GLFont& newFon
 	
 	/* Update the label box size: */
 	labelBox.size=font->calcStringSize(texelWidth);
+	
+	/* Update the label's vertices: */
+	updateVertices();
 	}
 
 void GLLabel::setFont(const GLFont& newFont)
@@ -258,6 +345,9 @@ void GLLabel::setFont(const GLFont& newFont)
 	
 	/* Update the label box size: */
 	labelBox.size=font->calcStringSize(texelWidth);
+	
+	/* Update the label's vertices: */
+	updateVertices();
 	}
 
 void GLLabel::initContext(GLContextData& contextData) const
@@ -283,6 +373,9 @@ void GLLabel::setString(const char* newString)
 	
 	/* Update the label box size: */
 	labelBox.size=font->calcStringSize(texelWidth);
+	
+	/* Update the label's vertices: */
+	updateVertices();
 	}
 
 void GLLabel::setString(const char* newStringBegin,const char* newStringEnd)
@@ -295,6 +388,9 @@ void GLLabel::setString(const char* newStringBegin,const char* newStringEnd)
 	
 	/* Update the label box size: */
 	labelBox.size=font->calcStringSize(texelWidth);
+	
+	/* Update the label's vertices: */
+	updateVertices();
 	}
 
 void GLLabel::setString(const GLString& newString)
@@ -307,6 +403,9 @@ void GLLabel::setString(const GLString& newString)
 	
 	/* Update the label box size: */
 	labelBox.size=font->calcStringSize(texelWidth);
+	
+	/* Update the label's vertices: */
+	updateVertices();
 	}
 
 void GLLabel::adoptString(char* newString)
@@ -319,6 +418,9 @@ void GLLabel::adoptString(char* newString)
 	
 	/* Update the label box size: */
 	labelBox.size=font->calcStringSize(texelWidth);
+	
+	/* Update the label's vertices: */
+	updateVertices();
 	}
 
 void GLLabel::adoptString(GLsizei newLength,char* newString)
@@ -331,6 +433,9 @@ void GLLabel::adoptString(GLsizei newLength,char* newString)
 	
 	/* Update the label box size: */
 	labelBox.size=font->calcStringSize(texelWidth);
+	
+	/* Update the label's vertices: */
+	updateVertices();
 	}
 
 void GLLabel::resetBox(void)
@@ -341,11 +446,17 @@ void GLLabel::resetBox(void)
 	/* Re-calculate the label box: */
 	labelBox.origin=Box::Vector(0.0f,0.0f,0.0f);
 	labelBox.size=font->calcStringSize(texelWidth);
+	
+	/* Update the label's vertices: */
+	updateVertices();
 	}
 
 void GLLabel::setOrigin(const GLLabel::Box::Vector& newOrigin)
 	{
 	labelBox.origin=newOrigin;
+	
+	/* Update the label's vertices: */
+	updateVertices();
 	}
 
 void GLLabel::clipBox(const GLLabel::Box& clipBox)
@@ -370,6 +481,9 @@ void GLLabel::clipBox(const GLLabel::Box& clipBox)
 			labelBox.size[i]-=dMax;
 			}
 		}
+	
+	/* Update the label's vertices: */
+	updateVertices();
 	}
 
 GLint GLLabel::calcCharacterIndex(GLfloat modelPos) const
@@ -396,54 +510,9 @@ void GLLabel::draw(GLContextData& contextData) const
 	if(DeferredRenderer::addLabel(this))
 		return;
 	
-	/* Retrieve the context data item: */
-	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
-	
-	/* Save and set up OpenGL state: */
-	GLLightTracker* lt=contextData.getLightTracker();
-	if(lt->isLightingEnabled()&&!lt->isSpecularColorSeparate())
-		{
-		/* Temporarily turn on separate specular color handling: */
-		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SEPARATE_SPECULAR_COLOR);
-		}
-	
-	/* Set appropriate texture mode for current lighting state: */
-	glPushAttrib(GL_ENABLE_BIT|GL_TEXTURE_BIT);
-	glEnable(GL_TEXTURE_2D);
-	glTexEnvMode(GLTexEnvEnums::TEXTURE_ENV,lt->isLightingEnabled()?GLTexEnvEnums::MODULATE:GLTexEnvEnums::REPLACE);
-	
-	/* Bind the label texture: */
-	glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectId);
-	
-	/* Check if the texture object needs to be updated: */
-	if(dataItem->version!=version)
-		{
-		/* Upload the string's texture image: */
-		font->uploadStringTexture(*this,background,foreground);
-		
-		/* Update the texture version number: */
-		dataItem->version=version;
-		}
-	
-	/* Draw a textured quad: */
-	glColor4f(1.0f,1.0f,1.0f,background[3]);
-	glBegin(GL_QUADS);
-	glNormal3f(0.0f,0.0f,1.0f);
-	glTexCoord(textureBox.getCorner(0));
-	glVertex(labelBox.getCorner(0));
-	glTexCoord(textureBox.getCorner(1));
-	glVertex(labelBox.getCorner(1));
-	glTexCoord(textureBox.getCorner(3));
-	glVertex(labelBox.getCorner(3));
-	glTexCoord(textureBox.getCorner(2));
-	glVertex(labelBox.getCorner(2));
-	glEnd();
-	
-	/* Reset OpenGL state: */
-	glBindTexture(GL_TEXTURE_2D,0);
-	glPopAttrib();
-	if(lt->isLightingEnabled()&&!lt->isSpecularColorSeparate())
-		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SINGLE_COLOR);
+	/* Draw the label's background and glyph quads: */
+	if(!vertices.empty())
+		drawVertices(*font,&vertices[0],4,GLsizei(vertices.size())-4,contextData);
 	}
 
 void GLLabel::draw(GLsizei selectionStart,GLsizei selectionEnd,const GLLabel::Color& selectionBackgroundColor,const GLLabel::Color& selectionForegroundColor,GLContextData& contextData) const
@@ -464,6 +533,10 @@ void GLLabel::draw(GLsizei selectionStart,GLsizei selectionEnd,const GLLabel::Co
 	glEnable(GL_TEXTURE_2D);
 	glTexEnvMode(GLTexEnvEnums::TEXTURE_ENV,lt->isLightingEnabled()?GLTexEnvEnums::MODULATE:GLTexEnvEnums::REPLACE);
 	
+	/* Create the label texture on first use: */
+	if(dataItem->textureObjectId==0)
+		glGenTextures(1,&dataItem->textureObjectId);
+	
 	/* Bind the label texture: */
 	glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectId);
 	
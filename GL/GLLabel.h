@@ -27,6 +27,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/TLSHelper.h>
 #include <GL/GLColor.h>
 #include <GL/GLBox.h>
+#include <GL/GLVertex.h>
 #include <GL/GLString.h>
 #include <GL/GLObject.h>
 
@@ -39,8 +40,9 @@ class GLLabel:public GLString,public GLObject
 	public:
 	typedef GLColor<GLfloat,4> Color; // Type for colors
 	typedef GLBox<GLfloat,3> Box; // Type for model-space boxes
+	typedef GLVertex<GLfloat,2,GLubyte,4,void,GLfloat,3> Vertex; // Type for vertices rendering a label from its font's glyph atlas
 	
-	class DeferredRenderer // Class to gather GLLabel objects during a rendering pass and draw them en-bloc at the end of the pass
+	class DeferredRenderer // Class to gather GLLabel objects during a rendering pass and draw them en-bloc at the end of the pass, batched by font
 		{
 		/* Elements: */
 		private:
@@ -48,6 +50,7 @@ class GLLabel:public GLString,public GLObject
 		GLContextData& contextData; // Reference to the OpenGL context data object
 		DeferredRenderer* previousDeferredRenderer; // Pointer to the deferred renderer that was suspended when this one was installed
 		std::vector<const GLLabel*> gatheredLabels; // List of gathered GLLabel objects
+		std::vector<Vertex> batchVertices; // Vertex array holding the backgrounds and glyphs of all gathered labels sharing a font
 		
 		/* Constructors and destructors: */
 		public:
@@ -64,18 +67,18 @@ class GLLabel:public GLString,public GLObject
 		{
 		/* Elements: */
 		public:
-		GLuint textureObjectId;
+		GLuint textureObjectId; // ID of texture object holding the string and its selection, or 0 if the label was never drawn with a selection
 		unsigned int version; // Version number of string currently in texture object
 
 		/* Constructors and destructors: */
 		DataItem(void)
-			:version(0)
+			:textureObjectId(0),version(0)
 			{
-			glGenTextures(1,&textureObjectId);
 			}
 		~DataItem(void)
 			{
-			glDeleteTextures(1,&textureObjectId);
+			if(textureObjectId!=0)
+				glDeleteTextures(1,&textureObjectId);
 			}
 		};
 	
@@ -87,6 +90,11 @@ class GLLabel:public GLString,public GLObject
 	Color foreground; // String's foreground color
 	unsigned int version; // Monotonically increasing version number of string
 	Box labelBox; // Position of label in model space
+	std::vector<Vertex> vertices; // Vertices rendering the label's background quad followed by its glyph quads from its font's glyph atlas
+	
+	/* Private methods: */
+	void updateVertices(void); // Recalculates the label's vertices after its string, font, colors, or box changed
+	static void drawVertices(const GLFont& font,const Vertex* vertices,GLsizei numBackgroundVertices,GLsizei numGlyphVertices,GLContextData& contextData); // Draws background quads and then glyph quads from the given vertex array using the given font's glyph atlas
 	
 	/* Constructors and destructors: */
 	public:
@@ -149,6 +157,9 @@ class GLLabel:public GLString,public GLObject
 		
 		/* Increment the version number: */
 		++version;
+		
+		/* Update the label's vertices: */
+		updateVertices();
 		}
 	template <class InputColorType>
 	void setForeground(const InputColorType& newForeground) // Sets the foreground color
@@ -158,6 +169,9 @@ class GLLabel:public GLString,public GLObject
 		
 		/* Increment the version number: */
 		++version;
+		
+		/* Update the label's vertices: */
+		updateVertices();
 		}
 	void resetBox(void); // Resets the label box to the default defined by the label's font
 	void setOrigin(const Box::Vector& newOrigin); // Moves the label's origin to the given model-space position
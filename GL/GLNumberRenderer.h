@@ -26,7 +26,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLVector.h>
 #include <GL/GLObject.h>
 
-class GLNumberRenderer:public GLObject
+class GLNumberRenderer:public GLObject // Draws digits as vector line strokes from per-context display lists; does not use GLFont's glyph atlas, because it has no font bitmaps and never uploads per-string textures, and atlas glyphs would change its look from scalable strokes to filtered bitmaps
 	{
 	/* Embedded classes: */
 	public:
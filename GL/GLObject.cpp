@@ -41,6 +41,7 @@ void GLObject::init(void)
 	}
 
 GLObject::GLObject(bool autoInit)
+	:contextDataSlot(GLContextData::allocateThingSlot())
 	{
 	if(autoInit)
 		{
@@ -50,6 +51,7 @@ GLObject::GLObject(bool autoInit)
 	}
 
 GLObject::GLObject(const GLObject& source)
+	:contextDataSlot(GLContextData::allocateThingSlot())
 	{
 	/* Mark the object for context initialization: */
 	GLContextData::initThing(this);
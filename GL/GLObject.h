@@ -28,6 +28,8 @@ class GLContextData;
 
 class GLObject
 	{
+	friend class GLContextData;
+	
 	/* Embedded classes: */
 	public:
 	struct DataItem // Base class for context data items
@@ -39,6 +41,10 @@ class GLObject
 			}
 		};
 	
+	/* Elements: */
+	private:
+	unsigned int contextDataSlot; // Index of this object's data items in all context data objects
+	
 	/* Protected methods: */
 	protected:
 	void dependsOn(const GLObject* thing) const; // Method declaring that this GLObject depends on another GLObject being initialized before it in every context
@@ -47,7 +53,11 @@ class GLObject
 	/* Constructors and destructors: */
 	public:
 	GLObject(bool autoInit =true); // Marks the object for context initialization if the given flag is true; otherwise, init() method must be called at some later point
-	GLObject(const GLObject& source); // Copy constructor
+	GLObject(const GLObject& source); // Copy constructor; copy receives its own context data slot
+	GLObject& operator=(const GLObject& source) // Assignment operator; keeps the object's context data slot
+		{
+		return *this;
+		}
 	virtual ~GLObject(void); // Destroys the object and its associated context data item
 	
 	/* Methods: */
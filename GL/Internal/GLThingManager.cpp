@@ -35,10 +35,27 @@ GLThingManager GLThingManager::theThingManager;
 Methods of class GLThingManager:
 *******************************/
 
+void GLThingManager::deleteProcessActions(void)
+	{
+	/* Delete the process list: */
+	Threads::Mutex::Lock slotLock(slotMutex);
+	while(firstProcessAction!=0)
+		{
+		/* Every context has removed a destroyed thing's data item by now; release its slot for re-use: */
+		if(firstProcessAction->action==ThingAction::DESTROY)
+			freeSlots.push_back(firstProcessAction->slot);
+		
+		ThingAction* succ=firstProcessAction->succ;
+		delete firstProcessAction;
+		firstProcessAction=succ;
+		}
+	}
+
 GLThingManager::GLThingManager(void)
 	:active(true),
 	 firstNewAction(0),lastNewAction(0),
-	 firstProcessAction(0)
+	 firstProcessAction(0),
+	 numSlots(0)
 	{
 	}
 
@@ -66,12 +83,7 @@ GLThingManager::~GLThingManager(void)
 void GLThingManager::shutdown(void)
 	{
 	/* Delete all pending actions: */
-	while(firstProcessAction!=0)
-		{
-		ThingAction* succ=firstProcessAction->succ;
-		delete firstProcessAction;
-		firstProcessAction=succ;
-		}
+	deleteProcessActions();
 	
 	/* Mark the thing manager as inactive: */
 	{
@@ -86,6 +98,22 @@ void GLThingManager::shutdown(void)
 	}
 	}
 
+unsigned int GLThingManager::allocateSlot(void)
+	{
+	Threads::Mutex::Lock slotLock(slotMutex);
+	
+	/* Re-use the most recently released slot to keep the context data arrays dense: */
+	if(!freeSlots.empty())
+		{
+		unsigned int result=freeSlots.back();
+		freeSlots.pop_back();
+		return result;
+		}
+	
+	/* Hand out a new slot: */
+	return numSlots++;
+	}
+
 void GLThingManager::initThing(const GLObject* thing)
 	{
 	{
@@ -95,6 +123,7 @@ void GLThingManager::initThing(const GLObject* thing)
 		/* Append the new thing action to the new action list: */
 		ThingAction* newAction=new ThingAction;
 		newAction->thing=thing;
+		newAction->slot=0;
 		newAction->action=ThingAction::INIT;
 		newAction->succ=0;
 		if(lastNewAction!=0)
@@ -106,7 +135,7 @@ void GLThingManager::initThing(const GLObject* thing)
 	}
 	}
 
-void GLThingManager::destroyThing(const GLObject* thing)
+void GLThingManager::destroyThing(const GLObject* thing,unsigned int slot)
 	{
 	Threads::Mutex::Lock newActionLock(newActionMutex);
 	if(active)
@@ -129,19 +158,23 @@ void GLThingManager::destroyThing(const GLObject* thing)
 				lastNewAction=taPtr1;
 			delete taPtr2;
 			}
+		
+		/*******************************************************************
+		Append a destruction action to the list even if the thing was never
+		initialized, as it might have added data items on-demand, and its
+		slot can only be re-used once all contexts have processed it:
+		*******************************************************************/
+		
+		ThingAction* newAction=new ThingAction;
+		newAction->thing=thing;
+		newAction->slot=slot;
+		newAction->action=ThingAction::DESTROY;
+		newAction->succ=0;
+		if(lastNewAction!=0)
+			lastNewAction->succ=newAction;
 		else
-			{
-			/* Append a destruction action to the list: */
-			ThingAction* newAction=new ThingAction;
-			newAction->thing=thing;
-			newAction->action=ThingAction::DESTROY;
-			newAction->succ=0;
-			if(lastNewAction!=0)
-				lastNewAction->succ=newAction;
-			else
-				firstNewAction=newAction;
-			lastNewAction=newAction;
-			}
+			firstNewAction=newAction;
+		lastNewAction=newAction;
 		}
 	}
 
@@ -159,8 +192,8 @@ void GLThingManager::orderThings(const GLObject* thing1,const GLObject* thing2)
 		ThingAction* thing2Ptr=0;
 		ThingAction* ta1Ptr=0;
 		ThingAction* ta2Ptr;
-		for(ta2Ptr=firstNewAction;ta2Ptr!=0&&ta2Ptr->thing!=thing1;ta1Ptr=ta2Ptr,ta2Ptr=ta2Ptr->succ)
-			if(ta2Ptr->thing==thing2)
+		for(ta2Ptr=firstNewAction;ta2Ptr!=0&&(ta2Ptr->thing!=thing1||ta2Ptr->action!=ThingAction::INIT);ta1Ptr=ta2Ptr,ta2Ptr=ta2Ptr->succ)
+			if(ta2Ptr->thing==thing2&&ta2Ptr->action==ThingAction::INIT)
 				{
 				thing2PredPtr=ta1Ptr;
 				thing2Ptr=ta2Ptr;
@@ -186,12 +219,7 @@ void GLThingManager::orderThings(const GLObject* thing1,const GLObject* thing2)
 void GLThingManager::processActions(void)
 	{
 	/* Delete the old process list: */
-	while(firstProcessAction!=0)
-		{
-		ThingAction* succ=firstProcessAction->succ;
-		delete firstProcessAction;
-		firstProcessAction=succ;
-		}
+	deleteProcessActions();
 	
 	/* Move the new action list to the process list: */
 	{
@@ -214,8 +242,8 @@ void GLThingManager::updateThings(GLContextData& contextData) const
 			}
 		else
 			{
-			/* Delete the context data item associated with the thing: */
-			contextData.removeDataItem(taPtr->thing);
+			/* Delete the context data item in the thing's slot; the thing itself is already gone: */
+			contextData.removeSlotDataItem(taPtr->slot);
 			}
 		}
 	}
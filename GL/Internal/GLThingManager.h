@@ -23,6 +23,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef GLTHINGMANAGER_INCLUDED
 #define GLTHINGMANAGER_INCLUDED
 
+#include <vector>
 #include <Threads/Mutex.h>
 
 /* Forward declarations: */
@@ -46,6 +47,7 @@ class GLThingManager
 		
 		/* Elements: */
 		const GLObject* thing; // Thing this action relates to
+		unsigned int slot; // Context data slot of the thing this action relates to
 		Action action; // The action
 		ThingAction* succ; // Pointer to the next action in the chain
 		};
@@ -58,6 +60,12 @@ class GLThingManager
 	ThingAction* firstNewAction; // List of actions added to by users
 	ThingAction* lastNewAction; // Pointer to last element in new action list
 	ThingAction* firstProcessAction; // List of actions initialized in the current render cycle
+	Threads::Mutex slotMutex; // Mutex protecting the context data slot allocator
+	unsigned int numSlots; // Number of context data slots ever handed out
+	std::vector<unsigned int> freeSlots; // Stack of context data slots released by destroyed things that have been processed by all contexts
+	
+	/* Private methods: */
+	void deleteProcessActions(void); // Deletes the process list and releases the context data slots of all destroyed things
 	
 	/* Constructors and destructors: */
 	public:
@@ -66,8 +74,9 @@ class GLThingManager
 	
 	/* Methods: */
 	void shutdown(void); // Shuts down the thing manager
+	unsigned int allocateSlot(void); // Returns an unused context data slot
 	void initThing(const GLObject* thing); // Marks the given thing for initialization
-	void destroyThing(const GLObject* thing); // Marks the given thing for destruction
+	void destroyThing(const GLObject* thing,unsigned int slot); // Marks the given thing, which uses the given context data slot, for destruction
 	void orderThings(const GLObject* thing1,const GLObject* thing2); // Orders process list such that thing1 is initialized before thing2; assumes both things exist and have not been initialized yet
 	void processActions(void); // Moves all new actions to the process list
 	void updateThings(GLContextData& contextData) const; // Performs all actions for the current render cycle
@@ -478,6 +478,9 @@ void HSVColorSelector::setIndicatorSize(GLfloat newIndicatorSize)
 	{
 	/* Set the new indicator size: */
 	indicatorSize=newIndicatorSize;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 Color HSVColorSelector::getCurrentColor(void) const
@@ -642,6 +645,9 @@ void HSVColorSelector::setCurrentColor(const Color& newColor)
 	
 	/* Set the slider's current value: */
 	slider->setValue(currentValue);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
@@ -117,6 +117,7 @@ void ListBox::updatePageSlots(void)
 	
 	/* Update the page slots version number: */
 	++version;
+	update();
 	}
 
 ListBox::ListBox(const char* sName,Container* sParent,ListBox::SelectionMode sSelectionMode,int sPreferredWidth,int sPreferredPageSize,bool sManageChild)
@@ -791,6 +792,7 @@ void ListBox::removeItem(int index)
 				/* Update the item's page slot and invalidate the cache: */
 				pageSlots[lastSelectedItem-position].selected=true;
 				++version;
+				update();
 				}
 			
 			/* Call the selection change callbacks: */
@@ -1027,6 +1029,7 @@ void ListBox::selectItem(int index,bool moveToPage)
 			{
 			pageSlots[lastSelectedItem-position].selected=false;
 			++version;
+			update();
 			}
 		}
 	
@@ -1054,6 +1057,7 @@ void ListBox::selectItem(int index,bool moveToPage)
 				/* Update the page slot and invalidate the cache: */
 				pageSlots[index-position].selected=true;
 				++version;
+				update();
 				}
 			}
 		else
@@ -1063,6 +1067,7 @@ void ListBox::selectItem(int index,bool moveToPage)
 				{
 				pageSlots[index-position].selected=true;
 				++version;
+				update();
 				}
 			}
 		}
@@ -1115,6 +1120,7 @@ void ListBox::deselectItem(int index,bool moveToPage)
 			{
 			pageSlots[index-position].selected=false;
 			++version;
+			update();
 			}
 		}
 	
@@ -1179,6 +1185,7 @@ void ListBox::clearSelection(void)
 			{
 			pageSlots[lastSelectedItem-position].selected=false;
 			++version;
+			update();
 			}
 		}
 	
@@ -25,9 +25,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/gl.h>
 #include <GL/GLColorTemplates.h>
 #include <GL/GLVertexTemplates.h>
-#if GLMOTIF_POPUPWINDOW_USE_RENDERCACHE
-#include <GL/GLContextData.h>
-#endif
 #include <GL/GLFont.h>
 #include <GLMotif/StyleSheet.h>
 #include <GLMotif/Event.h>
@@ -65,9 +62,6 @@ PopupWindow::PopupWindow(const char* sName,WidgetManager* sManager,const char* s
 	 childBorderWidth(0.0f),
 	 child(0),
 	 isResizing(false)
-	 #if GLMOTIF_POPUPWINDOW_USE_RENDERCACHE
-	 ,version(1)
-	 #endif
 	{
 	/* Get the style sheet: */
 	const StyleSheet* ss=manager->getStyleSheet();
@@ -96,9 +90,6 @@ PopupWindow::PopupWindow(const char* sName,WidgetManager* sManager,const char* s
 	 childBorderWidth(0.0f),
 	 child(0),
 	 isResizing(false)
-	 #if GLMOTIF_POPUPWINDOW_USE_RENDERCACHE
-	 ,version(1)
-	 #endif
 	{
 	/* Get the style sheet: */
 	const StyleSheet* ss=manager->getStyleSheet();
@@ -269,38 +260,8 @@ Vector PopupWindow::calcHotSpot(void) const
 	return titleBar->calcHotSpot();
 	}
 
-#if GLMOTIF_POPUPWINDOW_USE_RENDERCACHE
-
-void PopupWindow::update(void)
-	{
-	/* Increment the visual representation's version number: */
-	++version;
-	}
-
-#endif
-
 void PopupWindow::draw(GLContextData& contextData) const
 	{
-	#if GLMOTIF_POPUPWINDOW_USE_RENDERCACHE
-	/* Retrieve the data item: */
-	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
-	
-	/* Check if the display list's contents are current: */
-	if(dataItem->version==version)
-		{
-		/* Render the geometry stored in the display list: */
-		glCallList(dataItem->displayListId);
-		
-		/* Bail out: */
-		return;
-		}
-	else
-		{
-		/* Cache the popup window's visual representation into the display list: */
-		glNewList(dataItem->displayListId,GL_COMPILE_AND_EXECUTE);
-		}
-	#endif
-	
 	/* Draw the popup window's back side: */
 	Box back=getExterior().offset(Vector(0.0,0.0,getZRange().first));
 	glColor(borderColor);
@@ -387,17 +348,6 @@ void PopupWindow::draw(GLContextData& contextData) const
 	/* Draw the child: */
 	if(child!=0)
 		child->draw(contextData);
-	
-	#if GLMOTIF_POPUPWINDOW_USE_RENDERCACHE
-	if(dataItem->version!=version)
-		{
-		/* Finish caching the popup window's visual representation: */
-		glEndList();
-		
-		/* Mark the display list as up-to-date: */
-		dataItem->version=version;
-		}
-	#endif
 	}
 
 bool PopupWindow::findRecipient(Event& event)
@@ -630,17 +580,6 @@ Widget* PopupWindow::getNextChild(Widget*)
 	return 0;
 	}
 
-#if GLMOTIF_POPUPWINDOW_USE_RENDERCACHE
-
-void PopupWindow::initContext(GLContextData& contextData) const
-	{
-	/* Create a data item and store it in the OpenGL context: */
-	DataItem* dataItem=new DataItem;
-	contextData.addDataItem(this,dataItem);
-	}
-
-#endif
-
 void PopupWindow::setTitleBorderWidth(GLfloat newTitleBorderWidth)
 	{
 	/* Set border width of the title bar: */
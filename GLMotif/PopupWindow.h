@@ -23,14 +23,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef GLMOTIF_POPUPWINDOW_INCLUDED
 #define GLMOTIF_POPUPWINDOW_INCLUDED
 
-#define GLMOTIF_POPUPWINDOW_USE_RENDERCACHE 0
-
 #include <Misc/CallbackData.h>
 #include <Misc/CallbackList.h>
-#if GLMOTIF_POPUPWINDOW_USE_RENDERCACHE
-#include <GL/gl.h>
-#include <GL/GLObject.h>
-#endif
 #include <GLMotif/Container.h>
 
 /* Forward declarations: */
@@ -42,11 +36,7 @@ class NewButton;
 
 namespace GLMotif {
 
-#if GLMOTIF_POPUPWINDOW_USE_RENDERCACHE
-class PopupWindow:public Container,public GLObject
-#else
 class PopupWindow:public Container
-#endif
 	{
 	/* Embedded classes: */
 	public:
@@ -95,26 +85,6 @@ class PopupWindow:public Container
 			}
 		};
 	
-	#if GLMOTIF_POPUPWINDOW_USE_RENDERCACHE
-	struct DataItem:public GLObject::DataItem
-		{
-		/* Elements: */
-		public:
-		GLuint displayListId; // ID of display list caching the rendering of all child widgets
-		unsigned int version; // Version number of display list
-		
-		/* Constructors and destructors: */
-		DataItem(void)
-			:displayListId(glGenLists(1)),version(0)
-			{
-			}
-		virtual ~DataItem(void)
-			{
-			glDeleteLists(displayListId,1);
-			}
-		};
-	#endif
-	
 	/* Elements: */
 	protected:
 	WidgetManager* manager; // Pointer to the widget manager
@@ -131,11 +101,6 @@ class PopupWindow:public Container
 	int resizeBorderMask; // Bit mask of which borders are being dragged 1 - left, 2 - right, 4 - bottom, 8 - top
 	GLfloat resizeOffset[2]; // Offset from the initial resizing position to the relevant border
 	
-	#if GLMOTIF_POPUPWINDOW_USE_RENDERCACHE
-	private:
-	unsigned int version; // Version number of visual representation of popup window and child widgets
-	#endif
-	
 	/* Protected methods: */
 	protected:
 	void hideButtonCallback(Misc::CallbackData* cbData);
@@ -160,9 +125,6 @@ class PopupWindow:public Container
 	virtual ZRange calcZRange(void) const;
 	virtual void resize(const Box& newExterior);
 	virtual Vector calcHotSpot(void) const;
-	#if GLMOTIF_POPUPWINDOW_USE_RENDERCACHE
-	virtual void update(void);
-	#endif
 	virtual void draw(GLContextData& contextData) const;
 	virtual bool findRecipient(Event& event);
 	virtual void pointerButtonDown(Event& event);
@@ -176,11 +138,6 @@ class PopupWindow:public Container
 	virtual Widget* getFirstChild(void);
 	virtual Widget* getNextChild(Widget* child);
 	
-	#if GLMOTIF_POPUPWINDOW_USE_RENDERCACHE
-	/* Methods inherited from GLObject: */
-	virtual void initContext(GLContextData& contextData) const;
-	#endif
-	
 	/* New methods: */
 	void setTitleBorderWidth(GLfloat newTitleBorderWidth); // Changes the title border width
 	void setTitleBarColor(const Color& newTitleBarColor); // Sets the color of the title bar
@@ -952,6 +952,9 @@ void Slider::addNotch(GLfloat newNotchValue)
 	
 	/* Update the notch positions: */
 	positionNotches();
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Slider::removeNotch(GLfloat notchValue)
@@ -967,6 +970,9 @@ void Slider::removeNotch(GLfloat notchValue)
 	
 	/* Update the notch positions: */
 	positionNotches();
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Slider::setValue(GLfloat newValue)
@@ -571,6 +571,9 @@ void TextField::setEditable(bool newEditable)
 	{
 	/* Set the text field's editable flag: */
 	editable=newEditable;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void TextField::setSelection(int newAnchorPos,int newCursorPos)
@@ -261,6 +261,9 @@ void Texture::initContext(GLContextData& contextData) const
 void Texture::updateTexture(void)
 	{
 	++version;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Texture::setSize(const unsigned int newSize[2])
@@ -350,17 +353,26 @@ void Texture::setRegion(const GLfloat newRegion[4])
 	
 	/* Invalidate the cached region: */
 	++regionVersion;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Texture::setInterpolationMode(GLenum newInterpolationMode)
 	{
 	interpolationMode=newInterpolationMode;
 	++settingsVersion;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Texture::setIlluminated(bool newIlluminated)
 	{
 	illuminated=newIlluminated;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
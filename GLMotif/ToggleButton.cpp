@@ -190,6 +190,9 @@ void ToggleButton::setSet(bool newSet)
 		for(int i=0;i<4;++i)
 			toggleInner[i][2]=decorationBox.origin[2]+toggleBorderWidth;
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 ToggleButton::ToggleButton(const char* sName,Container* sParent,const char* sLabel,const GLFont* sFont,bool sManageChild)
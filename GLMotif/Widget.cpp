@@ -263,10 +263,20 @@ void Widget::setForegroundColor(const Color& newForegroundColor)
 
 void Widget::update(void)
 	{
-	if(parent!=0&&isManaged)
+	if(parent!=0)
+		{
+		if(isManaged)
+			{
+			/* Notify the parent widget of the update: */
+			parent->update();
+			}
+		}
+	else
 		{
-		/* Notify the parent widget of the update: */
-		parent->update();
+		/* Notify the widget manager that this top-level widget's visual representation changed: */
+		WidgetManager* manager=getManager();
+		if(manager!=0)
+			manager->updateTopLevelWidget(this);
 		}
 	}
 
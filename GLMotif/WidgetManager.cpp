@@ -23,7 +23,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GLMotif/WidgetManager.h>
 
 #include <string.h>
+#include <vector>
 #include <GL/gl.h>
+#include <GL/GLLightTracker.h>
+#include <GL/GLContextData.h>
 #include <GL/GLLabel.h>
 #include <GL/GLTransformationWrappers.h>
 #include <GLMotif/WidgetArranger.h>
@@ -33,12 +36,28 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 namespace GLMotif {
 
+/****************************************
+Methods of class WidgetManager::DataItem:
+****************************************/
+
+WidgetManager::DataItem::DataItem(void)
+	:cachedWidgets(31),drawPass(0),renderCacheDisabled(false)
+	{
+	}
+
+WidgetManager::DataItem::~DataItem(void)
+	{
+	/* Delete all display lists: */
+	for(CachedWidgetMap::Iterator cwIt=cachedWidgets.begin();!cwIt.isFinished();++cwIt)
+		glDeleteLists(cwIt->getDest().displayListId,1);
+	}
+
 /********************************************
 Methods of class WidgetManager::PopupBinding:
 ********************************************/
 
-WidgetManager::PopupBinding::PopupBinding(Widget* sTopLevelWidget,const WidgetManager::Transformation& sWidgetToWorld,WidgetManager::PopupBinding* sParent,WidgetManager::PopupBinding* sSucc)
-	:topLevelWidget(sTopLevelWidget),widgetToWorld(sWidgetToWorld),visible(true),
+WidgetManager::PopupBinding::PopupBinding(Widget* sTopLevelWidget,const WidgetManager::Transformation& sWidgetToWorld,unsigned int sVersion,WidgetManager::PopupBinding* sParent,WidgetManager::PopupBinding* sSucc)
+	:topLevelWidget(sTopLevelWidget),widgetToWorld(sWidgetToWorld),visible(true),version(sVersion),
 	 parent(sParent),pred(0),succ(sSucc),firstSecondary(0)
 	{
 	}
@@ -131,7 +150,83 @@ WidgetManager::PopupBinding* WidgetManager::PopupBinding::findTopLevelWidget(con
 	return foundBinding;
 	}
 
-void WidgetManager::PopupBinding::draw(bool overlayWidgets,GLContextData& contextData) const
+void WidgetManager::PopupBinding::drawTopLevelWidget(WidgetManager::DataItem* dataItem,GLContextData& contextData) const
+	{
+	CachedWidget* cw=0;
+	bool compile=false;
+	if(dataItem!=0)
+		{
+		/* Find the top level widget's render cache entry: */
+		CachedWidgetMap::Iterator cwIt=dataItem->cachedWidgets.findEntry(topLevelWidget);
+		if(cwIt.isFinished())
+			{
+			/* Create a new render cache entry: */
+			CachedWidget newCw;
+			newCw.displayListId=glGenLists(1);
+			newCw.version=0;
+			newCw.lightingVersion=0;
+			newCw.compiled=false;
+			dataItem->cachedWidgets.setEntry(CachedWidgetMap::Entry(topLevelWidget,newCw));
+			cwIt=dataItem->cachedWidgets.findEntry(topLevelWidget);
+			}
+		cw=&cwIt->getDest();
+		cw->lastDrawn=dataItem->drawPass;
+		
+		/* Check if the visual representation changed since the widget was last drawn: */
+		unsigned int lightingVersion=contextData.getLightTracker()->getVersion();
+		if(cw->version==version&&cw->lightingVersion==lightingVersion)
+			{
+			if(cw->compiled)
+				{
+				/* Render the top level widget from the display list: */
+				glCallList(cw->displayListId);
+				return;
+				}
+			
+			/*****************************************************************
+			The widget was already drawn directly at its current version, so
+			all textures and other per-context state it uses are up-to-date
+			and will not be captured in the display list by accident. Cache the
+			visual representation now.
+			*****************************************************************/
+			
+			glNewList(cw->displayListId,GL_COMPILE_AND_EXECUTE);
+			compile=true;
+			}
+		else
+			{
+			/* Draw the widget directly, and cache it the next time if it does not change in the meantime: */
+			cw->version=version;
+			cw->lightingVersion=lightingVersion;
+			cw->compiled=false;
+			}
+		
+		dataItem->renderCacheDisabled=false;
+		}
+	
+	/* Draw the top level widget: */
+	{
+	GLLabel::DeferredRenderer dr(contextData);
+	topLevelWidget->draw(contextData);
+	dr.draw();
+	}
+	
+	if(compile)
+		{
+		/* Finish caching the visual representation: */
+		glEndList();
+		cw->compiled=true;
+		}
+	
+	if(cw!=0&&dataItem->renderCacheDisabled)
+		{
+		/* Draw the widget directly again the next time: */
+		cw->version=0;
+		cw->compiled=false;
+		}
+	}
+
+void WidgetManager::PopupBinding::draw(bool overlayWidgets,WidgetManager::DataItem* dataItem,GLContextData& contextData) const
 	{
 	if(visible)
 		{
@@ -142,14 +237,10 @@ void WidgetManager::PopupBinding::draw(bool overlayWidgets,GLContextData& contex
 		
 		/* Draw all its secondary top level widgets: */
 		for(PopupBinding* bPtr=firstSecondary;bPtr!=0;bPtr=bPtr->succ)
-			bPtr->draw(overlayWidgets,contextData);
+			bPtr->draw(overlayWidgets,dataItem,contextData);
 		
 		/* Draw the top level widget: */
-		{
-		GLLabel::DeferredRenderer dr(contextData);
-		topLevelWidget->draw(contextData);
-		dr.draw();
-		}
+		drawTopLevelWidget(dataItem,contextData);
 		
 		if(overlayWidgets)
 			{
@@ -160,11 +251,7 @@ void WidgetManager::PopupBinding::draw(bool overlayWidgets,GLContextData& contex
 			GLboolean colorMask[4];
 			glGetBooleanv(GL_COLOR_WRITEMASK,colorMask);
 			glColorMask(GL_FALSE,GL_FALSE,GL_FALSE,GL_FALSE);
-			{
-			GLLabel::DeferredRenderer dr(contextData);
-			topLevelWidget->draw(contextData);
-			dr.draw();
-			}
+			drawTopLevelWidget(dataItem,contextData);
 			glColorMask(colorMask[0],colorMask[1],colorMask[2],colorMask[3]);
 			glDepthRange(depthRange[0],depthRange[1]);
 			}
@@ -195,7 +282,7 @@ void WidgetManager::popupPrimaryWidgetAt(Widget* topLevelWidget,const WidgetMana
 	if(!popupBindingMap.isEntry(topLevelWidget))
 		{
 		/* Pop up the widget: */
-		PopupBinding* newBinding=new PopupBinding(topLevelWidget,widgetToWorld,0,firstBinding);
+		PopupBinding* newBinding=new PopupBinding(topLevelWidget,widgetToWorld,++lastVersion,0,firstBinding);
 		if(firstBinding!=0)
 			firstBinding->pred=newBinding;
 		firstBinding=newBinding;
@@ -272,10 +359,11 @@ void WidgetManager::deleteQueuedWidgets(void)
 	}
 
 WidgetManager::WidgetManager(void)
-	:styleSheet(0),arranger(0),
-	 timerEventScheduler(0),drawOverlayWidgets(false),
+	:GLObject(false),
+	 styleSheet(0),arranger(0),
+	 timerEventScheduler(0),drawOverlayWidgets(false),cacheWidgetRendering(false),
 	 widgetAttributeMap(101),
-	 firstBinding(0),popupBindingMap(31),
+	 firstBinding(0),popupBindingMap(31),lastVersion(0),
 	 time(0.0),
 	 hardGrab(false),pointerGrabWidget(0),
 	 textFocusWidget(0),
@@ -329,6 +417,11 @@ void WidgetManager::setDrawOverlayWidgets(bool newDrawOverlayWidgets)
 	drawOverlayWidgets=newDrawOverlayWidgets;
 	}
 
+void WidgetManager::setCacheWidgetRendering(bool newCacheWidgetRendering)
+	{
+	cacheWidgetRendering=newCacheWidgetRendering;
+	}
+
 void WidgetManager::unmanageWidget(Widget* widget)
 	{
 	/* Check if the widget has an attribute: */
@@ -341,6 +434,22 @@ void WidgetManager::unmanageWidget(Widget* widget)
 		}
 	}
 
+void WidgetManager::updateTopLevelWidget(const Widget* topLevelWidget)
+	{
+	/* Invalidate the top level widget's cached visual representation if it is popped up: */
+	PopupBindingMap::Iterator pbmIt=popupBindingMap.findEntry(topLevelWidget);
+	if(!pbmIt.isFinished())
+		pbmIt->getDest()->version=++lastVersion;
+	}
+
+void WidgetManager::disableRenderCache(GLContextData& contextData) const
+	{
+	/* Mark the currently drawn top level widget as uncacheable: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	if(dataItem!=0)
+		dataItem->renderCacheDisabled=true;
+	}
+
 void WidgetManager::popupPrimaryWidget(Widget* topLevelWidget)
 	{
 	/* Pop up with a default widget transformation: */
@@ -369,7 +478,7 @@ void WidgetManager::popupSecondaryWidget(Widget* owner,Widget* topLevelWidget,co
 		if(ownerBinding!=0)
 			{
 			Transformation widgetToWorld=Transformation::translate(Transformation::Vector(offset.getXyzw()));
-			PopupBinding* newBinding=new PopupBinding(topLevelWidget,widgetToWorld,ownerBinding,ownerBinding->firstSecondary);
+			PopupBinding* newBinding=new PopupBinding(topLevelWidget,widgetToWorld,++lastVersion,ownerBinding,ownerBinding->firstSecondary);
 			if(ownerBinding->firstSecondary!=0)
 				ownerBinding->firstSecondary->pred=newBinding;
 			ownerBinding->firstSecondary=newBinding;
@@ -570,11 +679,45 @@ void WidgetManager::setTime(double newTime)
 	time=newTime;
 	}
 
+void WidgetManager::initContext(GLContextData& contextData) const
+	{
+	/* Create and register a data item: */
+	DataItem* dataItem=new DataItem;
+	contextData.addDataItem(this,dataItem);
+	}
+
 void WidgetManager::draw(GLContextData& contextData) const
 	{
+	DataItem* dataItem=0;
+	if(cacheWidgetRendering)
+		{
+		/* Retrieve the context data item, or create one if the widget manager was not yet initialized in this context: */
+		dataItem=contextData.retrieveDataItem<DataItem>(this);
+		if(dataItem==0)
+			{
+			dataItem=new DataItem;
+			contextData.addDataItem(this,dataItem);
+			}
+		++dataItem->drawPass;
+		}
+	
 	/* Traverse all primary top level widgets: */
 	for(const PopupBinding* bPtr=firstBinding;bPtr!=0;bPtr=bPtr->succ)
-		bPtr->draw(drawOverlayWidgets,contextData);
+		bPtr->draw(drawOverlayWidgets,dataItem,contextData);
+	
+	if(dataItem!=0)
+		{
+		/* Release the render caches of all top level widgets that were popped down, hidden, or deleted: */
+		std::vector<const Widget*> staleWidgets;
+		for(CachedWidgetMap::Iterator cwIt=dataItem->cachedWidgets.begin();!cwIt.isFinished();++cwIt)
+			if(cwIt->getDest().lastDrawn!=dataItem->drawPass)
+				{
+				glDeleteLists(cwIt->getDest().displayListId,1);
+				staleWidgets.push_back(cwIt->getSource());
+				}
+		for(std::vector<const Widget*>::iterator swIt=staleWidgets.begin();swIt!=staleWidgets.end();++swIt)
+			dataItem->cachedWidgets.removeEntry(*swIt);
+		}
 	}
 
 bool WidgetManager::pointerButtonDown(Event& event)
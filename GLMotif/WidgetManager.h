@@ -29,6 +29,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/HashTable.h>
 #include <Misc/ThrowStdErr.h>
 #include <Geometry/OrthogonalTransformation.h>
+#include <GL/gl.h>
+#include <GL/GLObject.h>
 #include <GLMotif/Types.h>
 #include <GLMotif/WidgetAttribute.h>
 
@@ -48,7 +50,7 @@ class Widget;
 
 namespace GLMotif {
 
-class WidgetManager
+class WidgetManager:public GLObject
 	{
 	/* Embedded classes: */
 	public:
@@ -98,6 +100,32 @@ class WidgetManager
 		};
 	
 	private:
+	struct CachedWidget // Structure describing the cached visual representation of a top level widget in an OpenGL context
+		{
+		/* Elements: */
+		public:
+		GLuint displayListId; // ID of display list containing the widget's visual representation
+		unsigned int version; // Version number of the widget's visual representation when it was last drawn
+		unsigned int lightingVersion; // Version number of the lighting state when the widget was last drawn
+		bool compiled; // Flag whether the display list contains the visual representation of the current version
+		unsigned int lastDrawn; // Index of the drawing pass in which the widget was last drawn
+		};
+	
+	typedef Misc::HashTable<const Widget*,CachedWidget> CachedWidgetMap; // Type to map top-level widgets to their cached visual representations
+	
+	struct DataItem:public GLObject::DataItem
+		{
+		/* Elements: */
+		public:
+		CachedWidgetMap cachedWidgets; // Map of cached top-level widgets
+		unsigned int drawPass; // Index of the current drawing pass
+		bool renderCacheDisabled; // Flag whether the currently drawn top-level widget must not be cached
+		
+		/* Constructors and destructors: */
+		DataItem(void);
+		virtual ~DataItem(void);
+		};
+	
 	struct PopupBinding // Structure to bind top level widgets
 		{
 		/* Elements: */
@@ -105,13 +133,14 @@ class WidgetManager
 		Widget* topLevelWidget; // Pointer to top level widget
 		Transformation widgetToWorld; // Transformation from widget to world coordinates or owner widget's coordinates
 		bool visible; // Flag if top level widget should be drawn
+		unsigned int version; // Version number of the top level widget's visual representation
 		PopupBinding* parent; // Pointer to the binding this binding is secondary to
 		PopupBinding* pred; // Pointer to previous binding in same hierarchy level
 		PopupBinding* succ; // Pointer to next binding in same hierarchy level
 		PopupBinding* firstSecondary; // Pointer to first secondary top level window
 		
 		/* Constructors and destructors: */
-		PopupBinding(Widget* sTopLevelWidget,const Transformation& sWidgetToWorld,PopupBinding* sParent,PopupBinding* sSucc);
+		PopupBinding(Widget* sTopLevelWidget,const Transformation& sWidgetToWorld,unsigned int sVersion,PopupBinding* sParent,PopupBinding* sSucc);
 		~PopupBinding(void);
 		
 		/* Methods: */
@@ -119,7 +148,8 @@ class WidgetManager
 		PopupBinding* getSucc(void); // Ditto
 		PopupBinding* findTopLevelWidget(const Point& point);
 		PopupBinding* findTopLevelWidget(const Ray& ray);
-		void draw(bool overlayWidgets,GLContextData& contextData) const;
+		void drawTopLevelWidget(DataItem* dataItem,GLContextData& contextData) const; // Draws the top level widget, from its render cache if possible
+		void draw(bool overlayWidgets,DataItem* dataItem,GLContextData& contextData) const;
 		};
 	
 	typedef Misc::HashTable<const Widget*,PopupBinding*> PopupBindingMap; // Type to map top-level widgets to their popup bindings
@@ -227,9 +257,11 @@ class WidgetManager
 	WidgetArranger* arranger; // Helper class to arrange top-level widgets in 3D display space
 	Misc::TimerEventScheduler* timerEventScheduler; // Pointer to a scheduler for timer events managed by the OS/window system binding layer
 	bool drawOverlayWidgets; // Flag whether widgets are drawn in an overlay layer on top of all other 3D imagery
+	bool cacheWidgetRendering; // Flag whether the visual representations of top-level widgets are cached in per-context display lists; off by default, as widgets whose draw methods read state that changes without calling update() would not be redrawn
 	WidgetAttributeMap widgetAttributeMap; // Map from widgets to widget attributes
 	PopupBinding* firstBinding; // Pointer to first bound top level widget
 	PopupBindingMap popupBindingMap; // Map from currently popped-up top-level widgets to their popup bindings
+	unsigned int lastVersion; // Most recently assigned version number of any top-level widget's visual representation
 	double time; // The time reported to widgets
 	bool hardGrab; // Flag if the current pointer grab is a hard one
 	Widget* pointerGrabWidget; // Pointer to the widget grabbing the input
@@ -280,7 +312,14 @@ class WidgetManager
 		{
 		return drawOverlayWidgets;
 		}
+	void setCacheWidgetRendering(bool newCacheWidgetRendering); // Enables or disables caching of top-level widgets' visual representations; all popped-up widgets must call update() whenever their visual representation changes, or call disableRenderCache() from their draw methods
+	bool getCacheWidgetRendering(void) const // Returns true if top-level widgets' visual representations are cached
+		{
+		return cacheWidgetRendering;
+		}
 	void unmanageWidget(Widget* widget); // Tells the widget manager that the given widget is about to be destroyed; only called from Widget's destructor
+	void updateTopLevelWidget(const Widget* topLevelWidget); // Tells the widget manager that the visual representation of the given top-level widget has changed; only called from Widget's update method
+	void disableRenderCache(GLContextData& contextData) const; // Prevents caching the visual representation of the top-level widget currently drawn in the given OpenGL context; called from draw methods of widgets showing animated content
 	template <class AttributeParam>
 	void setWidgetAttribute(const Widget* widget,const AttributeParam& attribute) // Associates an attribute of arbitrary type with a widget; deletes previous attribute
 		{
@@ -346,6 +385,7 @@ class WidgetManager
 		{
 		return time;
 		}
+	virtual void initContext(GLContextData& contextData) const;
 	void draw(GLContextData& contextData) const;
 	bool pointerButtonDown(Event& event); // Handles a button down event
 	bool pointerButtonUp(Event& event); // Handles a button up event
@@ -25,6 +25,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef GEOMETRY_ARRAYKDTREE_INCLUDED
 #define GEOMETRY_ARRAYKDTREE_INCLUDED
 
+#include <Threads/Atomic.h>
 #include <Geometry/Point.h>
 #include <Geometry/Box.h>
 #include <Geometry/ClosePointSet.h>
@@ -53,10 +54,44 @@ class ArrayKdTree
 		int left,right;
 		int splitDimension;
 		int numThreads;
+		StoredPoint* buffer; // Temporary point array for parallel partitioning, or null
 		
 		/* Constructors and destructors: */
-		CreateSubTreeArgs(int sLeft,int sRight,int sSplitDimension,int sNumThreads)
-			:left(sLeft),right(sRight),splitDimension(sSplitDimension),numThreads(sNumThreads)
+		CreateSubTreeArgs(int sLeft,int sRight,int sSplitDimension,int sNumThreads,StoredPoint* sBuffer)
+			:left(sLeft),right(sRight),splitDimension(sSplitDimension),numThreads(sNumThreads),buffer(sBuffer)
+			{
+			}
+		};
+	
+	struct PartitionArgs // Structure to hold arguments for parallel partitioning threads
+		{
+		/* Elements: */
+		public:
+		int left,right; // Range of points handled by the thread
+		int splitDimension;
+		int numSplitters; // Number of bucket boundaries
+		const Scalar* splitters; // Sorted array of bucket boundaries
+		int* bucketOffsets; // Array of the thread's per-bucket point counts, or its per-bucket write positions during scattering
+		StoredPoint* buffer; // Temporary point array
+		};
+	
+	struct BatchQueryArgs // Structure to hold arguments for batched query threads
+		{
+		/* Elements: */
+		public:
+		const ArrayKdTree* tree; // The queried kd-tree
+		const Point* queryPositions; // Array of query positions
+		const int* queryOrder; // Array of query indices in processing order
+		int numQueries; // Number of queries
+		int maxNumPoints; // Maximum number of closest points per query, or 0 to find only the closest point
+		Scalar maxSqrDist; // Maximum squared distance of closest points
+		const StoredPoint** closestPoints; // Array of result point pointers
+		int* numClosestPoints; // Array of result point counts, or null when finding only the closest point
+		Threads::Atomic<int> nextQuery; // Position of the next chunk of queries to be processed
+		
+		/* Constructors and destructors: */
+		BatchQueryArgs(void)
+			:nextQuery(0)
 			{
 			}
 		};
@@ -69,6 +104,16 @@ class ArrayKdTree
 	/* Private methods: */
 	void createTree(int left,int right,int splitDimension); // Creates sub-kd-tree
 	void* createTreeThreaded(const CreateSubTreeArgs* args); // Creates sub-kd-tree using multiple threads
+	void createTreeThreaded(int numThreads); // Creates the entire kd-tree using multiple threads
+	void* countBuckets(PartitionArgs* args); // Counts the points in a range that fall into each partition bucket
+	void* scatterBuckets(PartitionArgs* args); // Copies the points in a range into their partition buckets in the temporary point array
+	void* copyBuckets(PartitionArgs* args); // Copies a range of partitioned points back from the temporary point array
+	void runPartitionPhase(void* (ArrayKdTree::*phaseMethod)(PartitionArgs*),PartitionArgs* args,int numThreads); // Runs one phase of parallel partitioning on the given number of threads
+	void partitionThreaded(int left,int right,int mid,int splitDimension,int numThreads,StoredPoint* buffer); // Moves the median of a point range into place using multiple threads
+	int findLeaf(const Point& queryPosition) const; // Returns the index of the node at which the query position would be inserted into the tree
+	void sortQueries(int numQueries,const Point queryPositions[],int queryOrder[]) const; // Sorts queries into tree order for cache-friendly batched queries
+	static void* batchQueryThread(BatchQueryArgs* args); // Processes chunks of queries from a batch until all are done
+	void runBatchQuery(BatchQueryArgs& args,int numThreads) const; // Processes a batch of queries using multiple threads
 	void checkTree(int left,int right,int splitDimension,Scalar bbMin[],Scalar bbMax[]) const; // Checks if kd-tree has correct structure
 	template <class TraversalFunctionParam>
 	void traverseTree(int left,int right,TraversalFunctionParam& traversalFunction) const // Traverses sub-kd-tree in prefix order and calls traversal function for each node
@@ -132,8 +177,7 @@ class ArrayKdTree
 	void releasePoints(int numThreads) // Ditto, but uses multiple threads
 		{
 		/* Create new tree: */
-		CreateSubTreeArgs args(0,numNodes-1,0,numThreads);
-		createTreeThreaded(&args);
+		createTreeThreaded(numThreads);
 		}
 	void setPoints(int newNumNodes,const StoredPoint newNodes[]); // Creates balanced kd-tree from point array
 	void setPoints(int newNumNodes,const StoredPoint newNodes[],int numThreads); // Ditto, but uses multiple threads
@@ -174,6 +218,8 @@ class ArrayKdTree
 	const StoredPoint& findClosePoint(const Point& queryPosition) const; // Returns a stored point that is close to the query position
 	const StoredPoint& findClosestPoint(const Point& queryPosition) const; // Returns the stored point closest to the query position
 	ClosePointSet& findClosestPoints(const Point& queryPosition,ClosePointSet& closestPoints) const; // Returns a set of closest points
+	void findClosestPoints(int numQueries,const Point queryPositions[],const StoredPoint* closestPoints[],int numThreads) const; // Stores the stored point closest to each of the query positions in the result array, using multiple threads
+	void findClosestPoints(int numQueries,const Point queryPositions[],int maxNumPoints,Scalar maxSqrDist,const StoredPoint* closestPoints[],int numClosestPoints[],int numThreads) const; // Finds up to the given number of closest points within the given squared distance for each of the query positions using multiple threads; stores results sorted by distance in consecutive groups of maxNumPoints entries, and the number of found points per query in the count array
 	};
 
 }
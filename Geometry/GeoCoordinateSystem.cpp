@@ -25,6 +25,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Misc/SelfDestructPointer.h>
 #include <Misc/ThrowStdErr.h>
+#include <Threads/Thread.h>
 #include <IO/ValueSource.h>
 #include <Geometry/Geoid.h>
 #include <Geometry/AlbersEqualAreaProjection.h>
@@ -35,6 +36,144 @@ namespace Geometry {
 
 namespace {
 
+/*****************************************************************
+Helper structure and functions for multithreaded batch conversion:
+*****************************************************************/
+
+struct BatchSlice // Structure describing a slice of a batch conversion to be processed by a single thread
+	{
+	/* Elements: */
+	public:
+	const GeoCoordinateSystem* system; // Coordinate system performing the conversion, or null
+	bool fromCartesian; // Flag whether the coordinate system converts from Cartesian coordinates
+	const GeoReprojector* reprojector; // Reprojector performing the conversion, or null
+	const GeoCoordinateSystem::Point* sources; // Slice of source points
+	GeoCoordinateSystem::Point* dests; // Slice of destination points
+	size_t numPoints; // Number of points in the slice
+	};
+
+void* batchSliceThread(BatchSlice* slice)
+	{
+	/* Convert the slice's points: */
+	if(slice->reprojector!=0)
+		slice->reprojector->convert(slice->sources,slice->dests,slice->numPoints);
+	else if(slice->fromCartesian)
+		slice->system->fromCartesian(slice->sources,slice->dests,slice->numPoints);
+	else
+		slice->system->toCartesian(slice->sources,slice->dests,slice->numPoints);
+	
+	return 0;
+	}
+
+void runBatchSlices(const BatchSlice& batch,unsigned int numThreads)
+	{
+	/* Don't split batches into slices too small to amortize thread creation: */
+	const size_t minSliceSize=4096;
+	if(size_t(numThreads)>batch.numPoints/minSliceSize)
+		numThreads=(unsigned int)(batch.numPoints/minSliceSize);
+	if(numThreads<=1)
+		{
+		/* Convert the entire batch in the calling thread: */
+		BatchSlice slice=batch;
+		batchSliceThread(&slice);
+		return;
+		}
+	
+	/* Split the batch into equal-sized slices and start helper threads for all but the last slice: */
+	BatchSlice* slices=new BatchSlice[numThreads];
+	Threads::Thread* threads=new Threads::Thread[numThreads-1];
+	size_t sliceStart=0;
+	for(unsigned int i=0;i<numThreads;++i)
+		{
+		size_t sliceEnd=(batch.numPoints*(i+1))/numThreads;
+		slices[i]=batch;
+		slices[i].sources=batch.sources+sliceStart;
+		slices[i].dests=batch.dests+sliceStart;
+		slices[i].numPoints=sliceEnd-sliceStart;
+		if(i<numThreads-1)
+			threads[i].start(batchSliceThread,&slices[i]);
+		sliceStart=sliceEnd;
+		}
+	
+	/* Convert the last slice in the calling thread: */
+	batchSliceThread(&slices[numThreads-1]);
+	
+	/* Wait for the helper threads to finish: */
+	for(unsigned int i=0;i<numThreads-1;++i)
+		threads[i].join();
+	delete[] threads;
+	delete[] slices;
+	}
+
+}
+
+/************************************
+Methods of class GeoCoordinateSystem:
+************************************/
+
+void GeoCoordinateSystem::toCartesian(const GeoCoordinateSystem::Point* systems,GeoCoordinateSystem::Point* cartesians,size_t numPoints) const
+	{
+	/* Transform all points individually: */
+	for(size_t i=0;i<numPoints;++i)
+		cartesians[i]=toCartesian(systems[i]);
+	}
+
+void GeoCoordinateSystem::fromCartesian(const GeoCoordinateSystem::Point* cartesians,GeoCoordinateSystem::Point* systems,size_t numPoints) const
+	{
+	/* Transform all points individually: */
+	for(size_t i=0;i<numPoints;++i)
+		systems[i]=fromCartesian(cartesians[i]);
+	}
+
+void GeoCoordinateSystem::toCartesian(const GeoCoordinateSystem::Point* systems,GeoCoordinateSystem::Point* cartesians,size_t numPoints,unsigned int numThreads) const
+	{
+	BatchSlice batch;
+	batch.system=this;
+	batch.fromCartesian=false;
+	batch.reprojector=0;
+	batch.sources=systems;
+	batch.dests=cartesians;
+	batch.numPoints=numPoints;
+	runBatchSlices(batch,numThreads);
+	}
+
+void GeoCoordinateSystem::fromCartesian(const GeoCoordinateSystem::Point* cartesians,GeoCoordinateSystem::Point* systems,size_t numPoints,unsigned int numThreads) const
+	{
+	BatchSlice batch;
+	batch.system=this;
+	batch.fromCartesian=true;
+	batch.reprojector=0;
+	batch.sources=cartesians;
+	batch.dests=systems;
+	batch.numPoints=numPoints;
+	runBatchSlices(batch,numThreads);
+	}
+
+/*******************************
+Methods of class GeoReprojector:
+*******************************/
+
+void GeoReprojector::convert(const GeoReprojector::Point* sources,GeoReprojector::Point* dests,size_t numPoints) const
+	{
+	/* Transform all points individually: */
+	for(size_t i=0;i<numPoints;++i)
+		dests[i]=convert(sources[i]);
+	}
+
+void GeoReprojector::convert(const GeoReprojector::Point* sources,GeoReprojector::Point* dests,size_t numPoints,unsigned int numThreads) const
+	{
+	BatchSlice batch;
+	batch.system=0;
+	batch.fromCartesian=false;
+	batch.reprojector=this;
+	batch.sources=sources;
+	batch.dests=dests;
+	batch.numPoints=numPoints;
+	runBatchSlices(batch,numThreads);
+	}
+
+namespace {
+
 /******************************************
 Derived geodetic coordinate system classes:
 ******************************************/
@@ -56,6 +195,8 @@ class GeocentricCoordinateSystem:public GeoCoordinateSystem // Class for geocent
 	/* Methods from GeoCoordinateSystem: */
 	virtual Point toCartesian(const Point& system) const;
 	virtual Point fromCartesian(const Point& system) const;
+	virtual void toCartesian(const Point* systems,Point* cartesians,size_t numPoints) const;
+	virtual void fromCartesian(const Point* cartesians,Point* systems,size_t numPoints) const;
 	
 	/* New methods: */
 	Scalar getMeterScale(void) const // Returns the system's scaling factor to meters
@@ -88,6 +229,8 @@ class GeographicCoordinateSystem:public GeoCoordinateSystem // Class for geograp
 	/* Methods from GeoCoordinateSystem: */
 	virtual Point toCartesian(const Point& system) const;
 	virtual Point fromCartesian(const Point& system) const;
+	virtual void toCartesian(const Point* systems,Point* cartesians,size_t numPoints) const;
+	virtual void fromCartesian(const Point* cartesians,Point* systems,size_t numPoints) const;
 	
 	/* New methods: */
 	const Geoid& getGeoid(void) const // Returns the coordinate system's reference ellipsoid
@@ -143,6 +286,8 @@ class PCS:public ProjectedCoordinateSystem // Concrete class for projected coord
 	/* Methods from GeoCoordinateSystem: */
 	virtual Point toCartesian(const Point& system) const;
 	virtual Point fromCartesian(const Point& system) const;
+	virtual void toCartesian(const Point* systems,Point* cartesians,size_t numPoints) const;
+	virtual void fromCartesian(const Point* cartesians,Point* systems,size_t numPoints) const;
 	
 	/* Methods from GeographicCoordinateSystem: */
 	virtual Point toGeographic(const Point& system) const;
@@ -165,6 +310,22 @@ GeoCoordinateSystem::Point GeocentricCoordinateSystem::fromCartesian(const GeoCo
 	return Point(cartesian[0]*invMeterScale,cartesian[1]*invMeterScale,cartesian[2]*invMeterScale);
 	}
 
+void GeocentricCoordinateSystem::toCartesian(const GeoCoordinateSystem::Point* systems,GeoCoordinateSystem::Point* cartesians,size_t numPoints) const
+	{
+	/* Scale all points to meters: */
+	for(size_t i=0;i<numPoints;++i)
+		for(int j=0;j<3;++j)
+			cartesians[i][j]=systems[i][j]*meterScale;
+	}
+
+void GeocentricCoordinateSystem::fromCartesian(const GeoCoordinateSystem::Point* cartesians,GeoCoordinateSystem::Point* systems,size_t numPoints) const
+	{
+	/* Scale all points from meters: */
+	for(size_t i=0;i<numPoints;++i)
+		for(int j=0;j<3;++j)
+			systems[i][j]=cartesians[i][j]*invMeterScale;
+	}
+
 void GeocentricCoordinateSystem::setMeterScale(GeoCoordinateSystem::Scalar newMeterScale)
 	{
 	/* Update the scaling factors: */
@@ -207,6 +368,38 @@ GeoCoordinateSystem::Point GeographicCoordinateSystem::fromCartesian(const GeoCo
 	return Point(geoPoint[invAxisIndices[0]]*invAxisScales[0],geoPoint[invAxisIndices[1]]*invAxisScales[1],geoPoint[invAxisIndices[2]]*invAxisScales[2]);
 	}
 
+void GeographicCoordinateSystem::toCartesian(const GeoCoordinateSystem::Point* systems,GeoCoordinateSystem::Point* cartesians,size_t numPoints) const
+	{
+	/* Convert all system points to (longitude, latitude, ellipsoid height) in (radians, radians, meters): */
+	for(size_t i=0;i<numPoints;++i)
+		{
+		Point system=systems[i];
+		for(int j=0;j<3;++j)
+			cartesians[i][j]=system[axisIndices[j]]*axisScales[j];
+		}
+	
+	/* Convert the geographic points to Cartesian in-place: */
+	geoid.geodeticToCartesian(cartesians,cartesians,numPoints);
+	for(size_t i=0;i<numPoints;++i)
+		cartesians[i]+=geoidOffset;
+	}
+
+void GeographicCoordinateSystem::fromCartesian(const GeoCoordinateSystem::Point* cartesians,GeoCoordinateSystem::Point* systems,size_t numPoints) const
+	{
+	/* Convert all Cartesian points to geographic: */
+	for(size_t i=0;i<numPoints;++i)
+		systems[i]=cartesians[i]-geoidOffset;
+	geoid.cartesianToGeodetic(systems,systems,numPoints);
+	
+	/* Convert the geographic points from (longitude, latitude, ellipsoid height) in (radians, radians, meters) to system in-place: */
+	for(size_t i=0;i<numPoints;++i)
+		{
+		Point geoPoint=systems[i];
+		for(int j=0;j<3;++j)
+			systems[i][j]=geoPoint[invAxisIndices[j]]*invAxisScales[j];
+		}
+	}
+
 void GeographicCoordinateSystem::setAxisIndices(int longitudeIndex,int latitudeIndex,int ellipsoidHeightIndex)
 	{
 	/* Set the axis indices: */
@@ -270,6 +463,30 @@ PCS<ProjectionParam>::fromCartesian(
 	return projection.cartesianToMap(cartesian);
 	}
 
+template <class ProjectionParam>
+inline
+void
+PCS<ProjectionParam>::toCartesian(
+	const GeoCoordinateSystem::Point* systems,
+	GeoCoordinateSystem::Point* cartesians,
+	size_t numPoints) const
+	{
+	/* Pass through to the projection object: */
+	projection.mapToCartesian(systems,cartesians,numPoints);
+	}
+
+template <class ProjectionParam>
+inline
+void
+PCS<ProjectionParam>::fromCartesian(
+	const GeoCoordinateSystem::Point* cartesians,
+	GeoCoordinateSystem::Point* systems,
+	size_t numPoints) const
+	{
+	/* Pass through to the projection object: */
+	projection.cartesianToMap(cartesians,systems,numPoints);
+	}
+
 template <class ProjectionParam>
 inline
 GeoCoordinateSystem::Point
@@ -694,7 +911,7 @@ PCS<AlbersEqualAreaProjection<double> >* WktFileParser::parseAlbersEqualAreaProj
 			int axis0=parseAxis();
 			
 			skipSeparator();
-		
+			
 			/* Read the second axis specification: */
 			skipTag("AXIS");
 			int axis1=parseAxis();
@@ -782,7 +999,7 @@ PCS<LambertConformalProjection<double> >* WktFileParser::parseLambertConformalPr
 			int axis0=parseAxis();
 			
 			skipSeparator();
-		
+			
 			/* Read the second axis specification: */
 			skipTag("AXIS");
 			int axis1=parseAxis();
@@ -869,7 +1086,7 @@ PCS<TransverseMercatorProjection<double> >* WktFileParser::parseTransverseMercat
 			int axis0=parseAxis();
 			
 			skipSeparator();
-		
+			
 			/* Read the second axis specification: */
 			skipTag("AXIS");
 			int axis1=parseAxis();
@@ -1030,6 +1247,7 @@ class IdentityReprojector:public GeoReprojector // Class for identity conversion
 	public:
 	virtual Point convert(const Point& source) const;
 	virtual Box convert(const Box& source) const;
+	virtual void convert(const Point* sources,Point* dests,size_t numPoints) const;
 	};
 
 class GeocentricToGeocentricReprojector:public GeoReprojector // Class to convert between geocentric coordinate systems
@@ -1045,6 +1263,7 @@ class GeocentricToGeocentricReprojector:public GeoReprojector // Class to conver
 	/* Methods from GeoReprojector: */
 	virtual Point convert(const Point& source) const;
 	virtual Box convert(const Box& source) const;
+	virtual void convert(const Point* sources,Point* dests,size_t numPoints) const;
 	};
 
 class GeocentricToGeographicReprojector:public GeoReprojector // Class to convert from geocentric to geographic coordinate systems
@@ -1064,6 +1283,7 @@ class GeocentricToGeographicReprojector:public GeoReprojector // Class to conver
 	/* Methods from GeoReprojector: */
 	virtual Point convert(const Point& source) const;
 	virtual Box convert(const Box& source) const;
+	virtual void convert(const Point* sources,Point* dests,size_t numPoints) const;
 	};
 
 class GeographicToGeocentricReprojector:public GeoReprojector // Class to convert from geographic to geocentric coordinate systems
@@ -1083,6 +1303,7 @@ class GeographicToGeocentricReprojector:public GeoReprojector // Class to conver
 	/* Methods from GeoReprojector: */
 	virtual Point convert(const Point& source) const;
 	virtual Box convert(const Box& source) const;
+	virtual void convert(const Point* sources,Point* dests,size_t numPoints) const;
 	};
 
 /************************************
@@ -1099,6 +1320,14 @@ GeoReprojector::Box IdentityReprojector::convert(const GeoReprojector::Box& sour
 	return source;
 	}
 
+void IdentityReprojector::convert(const GeoReprojector::Point* sources,GeoReprojector::Point* dests,size_t numPoints) const
+	{
+	/* Copy the points if the destination array is separate: */
+	if(dests!=sources)
+		for(size_t i=0;i<numPoints;++i)
+			dests[i]=sources[i];
+	}
+
 /**************************************************
 Methods of class GeocentricToGeocentricReprojector:
 **************************************************/
@@ -1124,6 +1353,13 @@ GeoReprojector::Box GeocentricToGeocentricReprojector::convert(const GeoReprojec
 	return result;
 	}
 
+void GeocentricToGeocentricReprojector::convert(const GeoReprojector::Point* sources,GeoReprojector::Point* dests,size_t numPoints) const
+	{
+	for(size_t i=0;i<numPoints;++i)
+		for(int j=0;j<3;++j)
+			dests[i][j]=sources[i][j]*unitFactor;
+	}
+
 /**************************************************
 Methods of class GeocentricToGeographicReprojector:
 **************************************************/
@@ -1176,6 +1412,25 @@ GeoReprojector::Box GeocentricToGeographicReprojector::convert(const GeoReprojec
 	return result;
 	}
 
+void GeocentricToGeographicReprojector::convert(const GeoReprojector::Point* sources,GeoReprojector::Point* dests,size_t numPoints) const
+	{
+	/* Convert all source points to Cartesian in meters relative to the reference ellipsoid's center: */
+	for(size_t i=0;i<numPoints;++i)
+		for(int j=0;j<3;++j)
+			dests[i][j]=sources[i][j]*meterScale-geoidOffset[j];
+	
+	/* Convert the Cartesian points to geographic in-place: */
+	geoid.cartesianToGeodetic(dests,dests,numPoints);
+	
+	/* Convert the geographic points from (longitude, latitude, ellipsoid height) in (radians, radians, meters) to system in-place: */
+	for(size_t i=0;i<numPoints;++i)
+		{
+		Point geoPoint=dests[i];
+		for(int j=0;j<3;++j)
+			dests[i][j]=geoPoint[invAxisIndices[j]]*invAxisScales[j];
+		}
+	}
+
 /**************************************************
 Methods of class GeographicToGeocentricReprojector:
 **************************************************/
@@ -1228,6 +1483,25 @@ GeoReprojector::Box GeographicToGeocentricReprojector::convert(const GeoReprojec
 	return result;
 	}
 
+void GeographicToGeocentricReprojector::convert(const GeoReprojector::Point* sources,GeoReprojector::Point* dests,size_t numPoints) const
+	{
+	/* Convert all source points to (longitude, latitude, ellipsoid height) in (radians, radians, meters): */
+	for(size_t i=0;i<numPoints;++i)
+		{
+		Point source=sources[i];
+		for(int j=0;j<3;++j)
+			dests[i][j]=source[axisIndices[j]]*axisScales[j];
+		}
+	
+	/* Convert the geographic points to Cartesian in-place: */
+	geoid.geodeticToCartesian(dests,dests,numPoints);
+	
+	/* Convert the Cartesian points to destination units: */
+	for(size_t i=0;i<numPoints;++i)
+		for(int j=0;j<3;++j)
+			dests[i][j]=(dests[i][j]+geoidOffset[j])*invMeterScale;
+	}
+
 }
 
 GeoCoordinateSystemPtr parseProjectionFile(IO::DirectoryPtr directory,const char* projectionFileName)
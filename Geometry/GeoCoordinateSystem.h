@@ -24,6 +24,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef GEOMETRY_GEOCOORDINATESYSTEM_INCLUDED
 #define GEOMETRY_GEOCOORDINATESYSTEM_INCLUDED
 
+#include <stddef.h>
 #include <Misc/Autopointer.h>
 #include <Threads/RefCounted.h>
 #include <IO/Directory.h>
@@ -42,6 +43,10 @@ class GeoCoordinateSystem:public Threads::RefCounted
 	/* Methods: */
 	virtual Point toCartesian(const Point& system) const =0; // Transforms a point from this object's coordinate system to geocentric Cartesian coordinates
 	virtual Point fromCartesian(const Point& cartesian) const =0; // Transforms a point from geocentric Cartesian coordinates to this object's coordinate system
+	virtual void toCartesian(const Point* systems,Point* cartesians,size_t numPoints) const; // Transforms an array of points from this object's coordinate system to geocentric Cartesian coordinates; source and destination arrays may be identical
+	virtual void fromCartesian(const Point* cartesians,Point* systems,size_t numPoints) const; // Transforms an array of points from geocentric Cartesian coordinates to this object's coordinate system; source and destination arrays may be identical
+	void toCartesian(const Point* systems,Point* cartesians,size_t numPoints,unsigned int numThreads) const; // Ditto, splitting the array between the given number of threads
+	void fromCartesian(const Point* cartesians,Point* systems,size_t numPoints,unsigned int numThreads) const; // Ditto, splitting the array between the given number of threads
 	};
 
 typedef Misc::Autopointer<GeoCoordinateSystem> GeoCoordinateSystemPtr; // Type for autopointers to geodetic coordinate systems
@@ -57,6 +62,8 @@ class GeoReprojector:public Threads::RefCounted // Abstract base class to reproj
 	/* Methods: */
 	virtual Point convert(const Point& source) const =0; // Transforms a point from the source to the destination coordinate system
 	virtual Box convert(const Box& source) const =0; // Conservatively transforms an axis-aligned box from the source to the destination coordinate system
+	virtual void convert(const Point* sources,Point* dests,size_t numPoints) const; // Transforms an array of points from the source to the destination coordinate system; source and destination arrays may be identical
+	void convert(const Point* sources,Point* dests,size_t numPoints,unsigned int numThreads) const; // Ditto, splitting the array between the given number of threads
 	};
 
 typedef Misc::Autopointer<GeoReprojector> GeoReprojectorPtr; // Type for autopointers to coordinate system reprojectors
@@ -25,6 +25,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef GEOMETRY_GEOID_INCLUDED
 #define GEOMETRY_GEOID_INCLUDED
 
+#include <stddef.h>
 #include <Math/Math.h>
 #include <Math/Constants.h>
 #include <Geometry/Point.h>
@@ -53,6 +54,7 @@ class Geoid
 	double b; // Geoid's semi-minor axis
 	double e2; // Geoid's squared eccentricity, derived from flattening factor
 	double ep2; // Geoid's squared second eccentricity
+	static const size_t batchBlockSize=64; // Number of points converted at once by batch conversions, which evaluate elementary functions on blocks of points using Math::ArrayKernels
 	
 	/* Constructors and destructors: */
 	public:
@@ -103,6 +105,10 @@ class Geoid
 		}
 	Frame geodeticToCartesianFrame(const Point& geodeticBase) const; // Returns a geoid-tangential coordinate frame at the given base point in geodetic coordinates
 	Point cartesianToGeodetic(const Point& cartesian) const; // Transforms a point
+	
+	/* Batch conversions; source and destination arrays may be identical: */
+	void geodeticToCartesian(const Point* geodetic,Point* cartesian,size_t numPoints) const; // Transforms an array of points
+	void cartesianToGeodetic(const Point* cartesian,Point* geodetic,size_t numPoints) const; // Transforms an array of points
 	};
 
 }
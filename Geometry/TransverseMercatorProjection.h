@@ -50,6 +50,7 @@ class TransverseMercatorProjection:public Geoid<ScalarParam>
 	using Geoid<ScalarParam>::flatteningFactor;
 	using Geoid<ScalarParam>::e2;
 	using Geoid<ScalarParam>::ep2;
+	using Geoid<ScalarParam>::batchBlockSize;
 	
 	private:
 	double lng0; // The projection's central meridian
@@ -64,6 +65,10 @@ class TransverseMercatorProjection:public Geoid<ScalarParam>
 	
 	/* Private methods: */
 	void calcProjectionConstants(void); // Calculates UTM projection constants based on the current reference ellipsoid and parameters
+	template <class PointParam>
+	void projectPoints(const PointParam* geodetic,PointParam* map,size_t numPoints) const; // Projects the first two components of an array of points from geodetic to map coordinates; leaves other components of the destination points untouched
+	template <class PointParam>
+	void unprojectPoints(const PointParam* map,PointParam* geodetic,size_t numPoints) const; // Ditto, from map coordinates to geodetic coordinates
 	
 	/* Constructors and destructors: */
 	public:
@@ -140,6 +145,8 @@ class TransverseMercatorProjection:public Geoid<ScalarParam>
 		              Scalar(phi-NbyR*sphi/cphi*(((61.0+(-3.0*C+298.0)*C+(45.0*T+90.0)*T-252.0*ep2)/720.0*D2-(5.0+(-4.0*C+10.0)*C+3.0*T-9.0*ep2)/24.0)*D2+1.0/2.0)*D2));
 		}
 	PBox mapToGeodetic(const PBox& map) const; // Conservatively converts a 2D bounding box in map space to geodetic space
+	void geodeticToMap(const PPoint* geodetic,PPoint* map,size_t numPoints) const; // Converts an array of 2D points from geodetic to map coordinates; source and destination arrays may be identical
+	void mapToGeodetic(const PPoint* map,PPoint* geodetic,size_t numPoints) const; // Converts an array of 2D points from map to geodetic coordinates; source and destination arrays may be identical
 	
 	/* Map coordinate versions of methods from Geoid: */
 	Point mapToCartesian(const Point& map) const // Converts a 3D point in map coordinates with geodetic vertical datum to geoid-centered geoid-fixed Cartesian coordinates
@@ -175,6 +182,8 @@ class TransverseMercatorProjection:public Geoid<ScalarParam>
 		PPoint map=geodeticToMap(PPoint(geodetic[0],geodetic[1]));
 		return Point(map[0],map[1],geodetic[2]);
 		}
+	void mapToCartesian(const Point* map,Point* cartesian,size_t numPoints) const; // Converts an array of 3D points from map coordinates to Cartesian coordinates; source and destination arrays may be identical
+	void cartesianToMap(const Point* cartesian,Point* map,size_t numPoints) const; // Converts an array of 3D points from Cartesian coordinates to map coordinates; source and destination arrays may be identical
 	};
 
 }
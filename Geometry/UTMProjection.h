@@ -52,6 +52,7 @@ class UTMProjection:public Geoid<ScalarParam>
 	using Geoid<ScalarParam>::flatteningFactor;
 	using Geoid<ScalarParam>::e2;
 	using Geoid<ScalarParam>::ep2;
+	using Geoid<ScalarParam>::batchBlockSize;
 	
 	private:
 	int zone; // The UTM zone of this projection
@@ -70,6 +71,10 @@ class UTMProjection:public Geoid<ScalarParam>
 	
 	/* Private methods: */
 	void calcProjectionConstants(void); // Calculates UTM projection constants based on the current reference ellipsoid and parameters
+	template <class PointParam>
+	void projectPoints(const PointParam* geodetic,PointParam* map,size_t numPoints) const; // Projects the first two components of an array of points from geodetic to map coordinates; leaves other components of the destination points untouched
+	template <class PointParam>
+	void unprojectPoints(const PointParam* map,PointParam* geodetic,size_t numPoints) const; // Ditto, from map coordinates to geodetic coordinates
 	
 	/* Constructors and destructors: */
 	public:
@@ -184,6 +189,8 @@ class UTMProjection:public Geoid<ScalarParam>
 		#endif
 		}
 	PBox mapToGeodetic(const PBox& map) const; // Conservatively converts a 2D bounding box in map space to geodetic space
+	void geodeticToMap(const PPoint* geodetic,PPoint* map,size_t numPoints) const; // Converts an array of 2D points from geodetic to map coordinates; source and destination arrays may be identical
+	void mapToGeodetic(const PPoint* map,PPoint* geodetic,size_t numPoints) const; // Converts an array of 2D points from map to geodetic coordinates; source and destination arrays may be identical
 	
 	/* Map coordinate versions of methods from Geoid: */
 	Point mapToCartesian(const Point& map) const // Converts a 3D point in map coordinates with geodetic vertical datum to geoid-centered geoid-fixed Cartesian coordinates
@@ -219,6 +226,8 @@ class UTMProjection:public Geoid<ScalarParam>
 		PPoint map=geodeticToMap(PPoint(geodetic[0],geodetic[1]));
 		return Point(map[0],map[1],geodetic[2]);
 		}
+	void mapToCartesian(const Point* map,Point* cartesian,size_t numPoints) const; // Converts an array of 3D points from map coordinates to Cartesian coordinates; source and destination arrays may be identical
+	void cartesianToMap(const Point* cartesian,Point* map,size_t numPoints) const; // Converts an array of 3D points from Cartesian coordinates to map coordinates; source and destination arrays may be identical
 	};
 
 }
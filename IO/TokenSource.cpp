@@ -23,9 +23,26 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <ctype.h>
 #include <string.h>
+#include <stdlib.h>
+#include <Misc/SizedTypes.h>
 
 namespace IO {
 
+namespace {
+
+/**************************************************************************
+Powers of ten that can be represented exactly as double-precision numbers:
+**************************************************************************/
+
+const double exactPowersOfTen[23]=
+	{
+	1.0e0,1.0e1,1.0e2,1.0e3,1.0e4,1.0e5,1.0e6,1.0e7,1.0e8,1.0e9,
+	1.0e10,1.0e11,1.0e12,1.0e13,1.0e14,1.0e15,1.0e16,1.0e17,1.0e18,1.0e19,
+	1.0e20,1.0e21,1.0e22
+	};
+
+}
+
 /****************************
 Methods of class TokenSource:
 ****************************/
@@ -258,6 +275,181 @@ const char* TokenSource::readNextToken(void)
 	return tokenBuffer;
 	}
 
+bool TokenSource::readNumber(double& value)
+	{
+	/* Reset the token: */
+	tokenSize=0;
+	
+	/* Read an optional sign: */
+	bool negate=lastChar=='-';
+	if(lastChar=='-'||lastChar=='+')
+		appendLastChar();
+	
+	/* Accumulate up to 19 significant decimal digits of the integral and fractional parts in a 64-bit integer: */
+	bool haveDigit=false;
+	bool exact=true;
+	Misc::UInt64 mantissa=0;
+	int numDigits=0;
+	int exponent=0;
+	while(lastChar>='0'&&lastChar<='9')
+		{
+		haveDigit=true;
+		if(numDigits<19)
+			{
+			mantissa=mantissa*10U+Misc::UInt64(lastChar-'0');
+			if(mantissa!=0)
+				++numDigits;
+			}
+		else
+			exact=false;
+		appendLastChar();
+		}
+	if(lastChar=='.')
+		{
+		appendLastChar();
+		while(lastChar>='0'&&lastChar<='9')
+			{
+			haveDigit=true;
+			if(numDigits<19)
+				{
+				mantissa=mantissa*10U+Misc::UInt64(lastChar-'0');
+				if(mantissa!=0)
+					++numDigits;
+				--exponent;
+				}
+			else
+				exact=false;
+			appendLastChar();
+			}
+		}
+	
+	/* Read an optional exponent: */
+	bool valid=haveDigit;
+	if(valid&&(lastChar=='e'||lastChar=='E'))
+		{
+		appendLastChar();
+		bool negateExponent=lastChar=='-';
+		if(lastChar=='-'||lastChar=='+')
+			appendLastChar();
+		valid=lastChar>='0'&&lastChar<='9';
+		int explicitExponent=0;
+		while(lastChar>='0'&&lastChar<='9')
+			{
+			if(explicitExponent<100000)
+				explicitExponent=explicitExponent*10+(lastChar-'0');
+			appendLastChar();
+			}
+		exponent+=negateExponent?-explicitExponent:explicitExponent;
+		}
+	
+	if(!valid||(cc[lastChar]&TOKEN))
+		{
+		if(tokenSize==0&&!(cc[lastChar]&TOKEN))
+			{
+			/* Read the offending punctuation or quoted token for error reporting: */
+			readNextToken();
+			return false;
+			}
+		
+		/* Read the rest of the token and let the C library deal with it: */
+		while(cc[lastChar]&TOKEN)
+			appendLastChar();
+		exact=false;
+		}
+	
+	/* Terminate the token: */
+	tokenBuffer[tokenSize]='\0';
+	
+	bool result=true;
+	if(exact&&mantissa<=(Misc::UInt64(1)<<53)&&exponent>=-22&&exponent<=22)
+		{
+		/* Both the mantissa and the power of ten are exact, so a single IEEE operation produces the correctly rounded result: */
+		value=double(mantissa);
+		if(exponent<0)
+			value/=exactPowersOfTen[-exponent];
+		else
+			value*=exactPowersOfTen[exponent];
+		if(negate)
+			value=-value;
+		}
+	else
+		{
+		/* Fall back to the C library for long mantissas, large exponents, and special values: */
+		char* endPtr=0;
+		value=strtod(tokenBuffer,&endPtr);
+		result=endPtr==tokenBuffer+tokenSize;
+		}
+	
+	/* Skip whitespace: */
+	while(cc[lastChar]&WHITESPACE)
+		lastChar=source->getChar();
+	
+	return result;
+	}
+
+bool TokenSource::readInteger(int& value)
+	{
+	/* Reset the token: */
+	tokenSize=0;
+	
+	/* Read an optional sign: */
+	bool negate=lastChar=='-';
+	if(lastChar=='-'||lastChar=='+')
+		appendLastChar();
+	
+	/* Accumulate up to 18 significant decimal digits in a 64-bit integer: */
+	bool exact=lastChar>='0'&&lastChar<='9';
+	Misc::UInt64 magnitude=0;
+	int numDigits=0;
+	while(lastChar>='0'&&lastChar<='9')
+		{
+		if(numDigits<18)
+			{
+			magnitude=magnitude*10U+Misc::UInt64(lastChar-'0');
+			if(magnitude!=0)
+				++numDigits;
+			}
+		else
+			exact=false;
+		appendLastChar();
+		}
+	
+	if(!exact||(cc[lastChar]&TOKEN))
+		{
+		if(tokenSize==0&&!(cc[lastChar]&TOKEN))
+			{
+			/* Read the offending punctuation or quoted token for error reporting: */
+			readNextToken();
+			return false;
+			}
+		
+		/* Read the rest of the token and let the C library deal with it: */
+		while(cc[lastChar]&TOKEN)
+			appendLastChar();
+		exact=false;
+		}
+	
+	/* Terminate the token: */
+	tokenBuffer[tokenSize]='\0';
+	
+	bool result=true;
+	if(exact)
+		value=int(negate?-Misc::SInt64(magnitude):Misc::SInt64(magnitude));
+	else
+		{
+		/* Fall back to the C library to handle overflow and to signal errors: */
+		char* endPtr=0;
+		value=int(strtol(tokenBuffer,&endPtr,10));
+		result=endPtr==tokenBuffer+tokenSize;
+		}
+	
+	/* Skip whitespace: */
+	while(cc[lastChar]&WHITESPACE)
+		lastChar=source->getChar();
+	
+	return result;
+	}
+
 bool TokenSource::isToken(const char* token) const
 	{
 	return strcmp(tokenBuffer,token)==0;
@@ -53,6 +53,13 @@ class TokenSource
 	/* Private methods: */
 	void initCharacterClasses(void); // Initializes the character classes array
 	void resizeTokenBuffer(void); // Creates additional room in the token buffer
+	void appendLastChar(void) // Appends the last read character to the token buffer and reads the next character
+		{
+		if(tokenSize>=tokenBufferSize)
+			resizeTokenBuffer();
+		tokenBuffer[tokenSize++]=char(lastChar);
+		lastChar=source->getChar();
+		}
 	
 	/* Constructors and destructors: */
 	public:
@@ -77,6 +84,8 @@ class TokenSource
 		return lastChar;
 		}
 	const char* readNextToken(void); // Reads the next token, i.e., either a single punctuation character, or a sequence of non-whitespace and non-punctuation characters, then skips whitespace
+	bool readNumber(double& value); // Reads the next token as a correctly-rounded floating-point number while scanning it, then skips whitespace; returns false if the token is not a valid number
+	bool readInteger(int& value); // Reads the next token as a decimal integer while scanning it, then skips whitespace; returns false if the token is not a valid integer
 	size_t getTokenSize(void) const // Returns the length of the most recently read token
 		{
 		return tokenSize;
@@ -27,6 +27,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string.h>
 #include <stdexcept>
 #include <Math/Math.h>
+#include <Threads/ParallelFor.h>
 #include <GL/Extensions/GLEXTFramebufferObject.h>
 
 namespace Images {
@@ -207,6 +208,63 @@ void addAlphaImpl(const BaseImage& source,BaseImage& dest,double alpha)
 		}
 	}
 
+inline int calcRowGrainSize(unsigned int width) // Returns the number of image rows processed by a single parallel task
+	{
+	/* Process at least 64K pixels per task to amortize task overhead: */
+	int result=int(65536U/(width>0?width:1U));
+	return result>1?result:1;
+	}
+
+template <class ScalarParam,class WeightParam>
+class ToGreyTypedIntRows // Functor to convert a range of image rows to luminance
+	{
+	/* Elements: */
+	private:
+	size_t width; // Image width in pixels
+	unsigned int sNc,dNc; // Number of source and destination channels
+	const ScalarParam* sPixels; // Source image's pixels
+	ScalarParam* dPixels; // Destination image's pixels
+	
+	/* Constructors and destructors: */
+	public:
+	ToGreyTypedIntRows(const BaseImage& source,BaseImage& dest)
+		:width(source.getSize(0)),sNc(source.getNumChannels()),dNc(dest.getNumChannels()),
+		 sPixels(static_cast<const ScalarParam*>(source.getPixels())),
+		 dPixels(static_cast<ScalarParam*>(dest.modifyPixels()))
+		{
+		}
+	
+	/* Methods: */
+	void operator()(int rowBegin,int rowEnd) const
+		{
+		/* Convert all pixels to luminance and retain an existing alpha channel: */
+		const ScalarParam* sPtr=sPixels+size_t(rowBegin)*width*sNc;
+		ScalarParam* dPtr=dPixels+size_t(rowBegin)*width*dNc;
+		size_t numPixels=size_t(rowEnd-rowBegin)*width;
+		if(sNc==4)
+			{
+			/* Convert RGBA to LUMINANCE_ALPHA: */
+			for(size_t i=numPixels;i>0;--i,sPtr+=4)
+				{
+				/* Calculate pixel luminance: */
+				*(dPtr++)=ScalarParam((WeightParam(sPtr[0])*WeightParam(77)+WeightParam(sPtr[1])*WeightParam(150)+WeightParam(sPtr[2])*WeightParam(29))>>WeightParam(8));
+				
+				/* Copy alpha channel: */
+				*(dPtr++)=sPtr[3];
+				}
+			}
+		else
+			{
+			/* Convert RGB to LUMINANCE: */
+			for(size_t i=numPixels;i>0;--i,sPtr+=3)
+				{
+				/* Calculate pixel luminance: */
+				*(dPtr++)=ScalarParam((WeightParam(sPtr[0])*WeightParam(77)+WeightParam(sPtr[1])*WeightParam(150)+WeightParam(sPtr[2])*WeightParam(29))>>WeightParam(8));
+				}
+			}
+		}
+	};
+
 template <class ScalarParam,class WeightParam>
 inline
 void
@@ -214,31 +272,59 @@ toGreyTypedInt(
 	const BaseImage& source,
 	BaseImage& dest)
 	{
-	/* Convert all pixels to luminance and retain an existing alpha channel: */
-	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	if(source.getNumChannels()==4)
+	/* Convert bands of image rows in parallel: */
+	Threads::parallelFor(0,int(source.getSize(1)),calcRowGrainSize(source.getSize(0)),ToGreyTypedIntRows<ScalarParam,WeightParam>(source,dest));
+	}
+
+template <class ScalarParam>
+class ToGreyTypedFloatRows // Functor to convert a range of image rows to luminance
+	{
+	/* Elements: */
+	private:
+	size_t width; // Image width in pixels
+	unsigned int sNc,dNc; // Number of source and destination channels
+	const ScalarParam* sPixels; // Source image's pixels
+	ScalarParam* dPixels; // Destination image's pixels
+	
+	/* Constructors and destructors: */
+	public:
+	ToGreyTypedFloatRows(const BaseImage& source,BaseImage& dest)
+		:width(source.getSize(0)),sNc(source.getNumChannels()),dNc(dest.getNumChannels()),
+		 sPixels(static_cast<const ScalarParam*>(source.getPixels())),
+		 dPixels(static_cast<ScalarParam*>(dest.modifyPixels()))
 		{
-		/* Convert RGBA to LUMINANCE_ALPHA: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=4)
-			{
-			/* Calculate pixel luminance: */
-			*(dPtr++)=ScalarParam((WeightParam(sPtr[0])*WeightParam(77)+WeightParam(sPtr[1])*WeightParam(150)+WeightParam(sPtr[2])*WeightParam(29))>>WeightParam(8));
-			
-			/* Copy alpha channel: */
-			*(dPtr++)=sPtr[3];
-			}
 		}
-	else
+	
+	/* Methods: */
+	void operator()(int rowBegin,int rowEnd) const
 		{
-		/* Convert RGB to LUMINANCE: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=3)
+		/* Convert all pixels to luminance and retain an existing alpha channel: */
+		const ScalarParam* sPtr=sPixels+size_t(rowBegin)*width*sNc;
+		ScalarParam* dPtr=dPixels+size_t(rowBegin)*width*dNc;
+		size_t numPixels=size_t(rowEnd-rowBegin)*width;
+		if(sNc==4)
+			{
+			/* Convert RGBA to LUMINANCE_ALPHA: */
+			for(size_t i=numPixels;i>0;--i,sPtr+=4)
+				{
+				/* Calculate pixel luminance: */
+				*(dPtr++)=sPtr[0]*ScalarParam(0.299)+sPtr[1]*ScalarParam(0.587)+sPtr[2]*ScalarParam(0.114);
+				
+				/* Copy alpha channel: */
+				*(dPtr++)=sPtr[3];
+				}
+			}
+		else
 			{
-			/* Calculate pixel luminance: */
-			*(dPtr++)=ScalarParam((WeightParam(sPtr[0])*WeightParam(77)+WeightParam(sPtr[1])*WeightParam(150)+WeightParam(sPtr[2])*WeightParam(29))>>WeightParam(8));
+			/* Convert RGB to LUMINANCE: */
+			for(size_t i=numPixels;i>0;--i,sPtr+=3)
+				{
+				/* Calculate pixel luminance: */
+				*(dPtr++)=sPtr[0]*ScalarParam(0.299)+sPtr[1]*ScalarParam(0.587)+sPtr[2]*ScalarParam(0.114);
+				}
 			}
 		}
-	}
+	};
 
 template <class ScalarParam>
 inline
@@ -247,30 +333,8 @@ toGreyTypedFloat(
 	const BaseImage& source,
 	BaseImage& dest)
 	{
-	/* Convert all pixels to luminance and retain an existing alpha channel: */
-	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	if(source.getNumChannels()==4)
-		{
-		/* Convert RGBA to LUMINANCE_ALPHA: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=4)
-			{
-			/* Calculate pixel luminance: */
-			*(dPtr++)=sPtr[0]*ScalarParam(0.299)+sPtr[1]*ScalarParam(0.587)+sPtr[2]*ScalarParam(0.114);
-			
-			/* Copy alpha channel: */
-			*(dPtr++)=sPtr[3];
-			}
-		}
-	else
-		{
-		/* Convert RGB to LUMINANCE: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=3)
-			{
-			/* Calculate pixel luminance: */
-			*(dPtr++)=sPtr[0]*ScalarParam(0.299)+sPtr[1]*ScalarParam(0.587)+sPtr[2]*ScalarParam(0.114);
-			}
-		}
+	/* Convert bands of image rows in parallel: */
+	Threads::parallelFor(0,int(source.getSize(1)),calcRowGrainSize(source.getSize(0)),ToGreyTypedFloatRows<ScalarParam>(source,dest));
 	}
 
 void toGreyImpl(const BaseImage& source,BaseImage& dest)
@@ -316,40 +380,68 @@ void toGreyImpl(const BaseImage& source,BaseImage& dest)
 	}
 
 template <class ScalarParam>
-inline
-void
-toRgbTyped(
-	const BaseImage& source,
-	BaseImage& dest)
+class ToRgbTypedRows // Functor to convert a range of greyscale image rows to RGB
 	{
-	/* Convert all pixels to RGB and retain an existing alpha channel: */
-	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	if(source.getNumChannels()==2)
+	/* Elements: */
+	private:
+	size_t width; // Image width in pixels
+	unsigned int sNc,dNc; // Number of source and destination channels
+	const ScalarParam* sPixels; // Source image's pixels
+	ScalarParam* dPixels; // Destination image's pixels
+	
+	/* Constructors and destructors: */
+	public:
+	ToRgbTypedRows(const BaseImage& source,BaseImage& dest)
+		:width(source.getSize(0)),sNc(source.getNumChannels()),dNc(dest.getNumChannels()),
+		 sPixels(static_cast<const ScalarParam*>(source.getPixels())),
+		 dPixels(static_cast<ScalarParam*>(dest.modifyPixels()))
 		{
-		/* Convert LUMINANCE_ALPHA to RGBA: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=2)
-			{
-			/* Copy pixel luminance: */
-			*(dPtr++)=sPtr[0];
-			*(dPtr++)=sPtr[0];
-			*(dPtr++)=sPtr[0];
-			
-			/* Copy alpha channel: */
-			*(dPtr++)=sPtr[1];
-			}
 		}
-	else
+	
+	/* Methods: */
+	void operator()(int rowBegin,int rowEnd) const
 		{
-		/* Convert LUMINANCE to RGB: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,++sPtr)
+		/* Convert all pixels to RGB and retain an existing alpha channel: */
+		const ScalarParam* sPtr=sPixels+size_t(rowBegin)*width*sNc;
+		ScalarParam* dPtr=dPixels+size_t(rowBegin)*width*dNc;
+		size_t numPixels=size_t(rowEnd-rowBegin)*width;
+		if(sNc==2)
+			{
+			/* Convert LUMINANCE_ALPHA to RGBA: */
+			for(size_t i=numPixels;i>0;--i,sPtr+=2)
+				{
+				/* Copy pixel luminance: */
+				*(dPtr++)=sPtr[0];
+				*(dPtr++)=sPtr[0];
+				*(dPtr++)=sPtr[0];
+				
+				/* Copy alpha channel: */
+				*(dPtr++)=sPtr[1];
+				}
+			}
+		else
 			{
-			/* Copy pixel luminance: */
-			*(dPtr++)=sPtr[0];
-			*(dPtr++)=sPtr[0];
-			*(dPtr++)=sPtr[0];
+			/* Convert LUMINANCE to RGB: */
+			for(size_t i=numPixels;i>0;--i,++sPtr)
+				{
+				/* Copy pixel luminance: */
+				*(dPtr++)=sPtr[0];
+				*(dPtr++)=sPtr[0];
+				*(dPtr++)=sPtr[0];
+				}
 			}
 		}
+	};
+
+template <class ScalarParam>
+inline
+void
+toRgbTyped(
+	const BaseImage& source,
+	BaseImage& dest)
+	{
+	/* Convert bands of image rows in parallel: */
+	Threads::parallelFor(0,int(source.getSize(1)),calcRowGrainSize(source.getSize(0)),ToRgbTypedRows<ScalarParam>(source,dest));
 	}
 
 void toRgbImpl(const BaseImage& source,BaseImage& dest)
@@ -394,6 +486,51 @@ void toRgbImpl(const BaseImage& source,BaseImage& dest)
 		}
 	}
 
+template <class ScalarParam,class AccumParam>
+class ShrinkTypedIntRows // Functor to downsample a range of destination image rows
+	{
+	/* Elements: */
+	private:
+	unsigned int width; // Source image width in pixels
+	unsigned int nc; // Number of channels
+	const ScalarParam* sPixels; // Source image's pixels
+	ScalarParam* dPixels; // Destination image's pixels
+	
+	/* Constructors and destructors: */
+	public:
+	ShrinkTypedIntRows(const BaseImage& source,BaseImage& dest)
+		:width(source.getSize(0)),nc(source.getNumChannels()),
+		 sPixels(static_cast<const ScalarParam*>(source.getPixels())),
+		 dPixels(static_cast<ScalarParam*>(dest.modifyPixels()))
+		{
+		}
+	
+	/* Methods: */
+	void operator()(int rowBegin,int rowEnd) const
+		{
+		/* Average all blocks of 2x2 pixels in the source image: */
+		const ptrdiff_t sStride=width*nc;
+		const ScalarParam* sRow0Ptr=sPixels+sStride*2*rowBegin;
+		const ScalarParam* sRow1Ptr=sRow0Ptr+sStride;
+		ScalarParam* dPtr=dPixels+(sStride/2)*rowBegin;
+		for(int y=rowBegin;y<rowEnd;++y,sRow0Ptr+=sStride*2,sRow1Ptr+=sStride*2)
+			{
+			const ScalarParam* s0Ptr=sRow0Ptr;
+			const ScalarParam* s1Ptr=sRow1Ptr;
+			for(unsigned int x=0;x<width;x+=2,s0Ptr+=nc,s1Ptr+=nc)
+				{
+				for(unsigned int i=0;i<nc;++i,++s0Ptr,++s1Ptr,++dPtr)
+					{
+					/* Average the current 2x2 pixel block: */
+					AccumParam sum0=AccumParam(s0Ptr[0])+AccumParam(s0Ptr[nc]);
+					AccumParam sum1=AccumParam(s1Ptr[0])+AccumParam(s1Ptr[nc]);
+					*dPtr=ScalarParam((sum0+sum1+2)>>2);
+					}
+				}
+			}
+		}
+	};
+
 template <class ScalarParam,class AccumParam>
 inline
 void
@@ -401,28 +538,52 @@ shrinkTypedInt(
 	const BaseImage& source,
 	BaseImage& dest)
 	{
-	/* Average all blocks of 2x2 pixels in the source image: */
-	unsigned int nc=source.getNumChannels();
-	const ScalarParam* sRow0Ptr=static_cast<const ScalarParam*>(source.getPixels());
-	const ptrdiff_t sStride=source.getSize(0)*nc;
-	const ScalarParam* sRow1Ptr=sRow0Ptr+sStride;
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	for(unsigned int y=0;y<source.getSize(1);y+=2,sRow0Ptr+=sStride*2,sRow1Ptr+=sStride*2)
+	/* Downsample bands of destination image rows in parallel: */
+	Threads::parallelFor(0,int(dest.getSize(1)),calcRowGrainSize(source.getSize(0)*2U),ShrinkTypedIntRows<ScalarParam,AccumParam>(source,dest));
+	}
+
+template <class ScalarParam>
+class ShrinkTypedFloatRows // Functor to downsample a range of destination image rows
+	{
+	/* Elements: */
+	private:
+	unsigned int width; // Source image width in pixels
+	unsigned int nc; // Number of channels
+	const ScalarParam* sPixels; // Source image's pixels
+	ScalarParam* dPixels; // Destination image's pixels
+	
+	/* Constructors and destructors: */
+	public:
+	ShrinkTypedFloatRows(const BaseImage& source,BaseImage& dest)
+		:width(source.getSize(0)),nc(source.getNumChannels()),
+		 sPixels(static_cast<const ScalarParam*>(source.getPixels())),
+		 dPixels(static_cast<ScalarParam*>(dest.modifyPixels()))
 		{
-		const ScalarParam* s0Ptr=sRow0Ptr;
-		const ScalarParam* s1Ptr=sRow1Ptr;
-		for(unsigned int x=0;x<source.getSize(0);x+=2,s0Ptr+=nc,s1Ptr+=nc)
+		}
+	
+	/* Methods: */
+	void operator()(int rowBegin,int rowEnd) const
+		{
+		/* Average all blocks of 2x2 pixels in the source image: */
+		const ptrdiff_t sStride=width*nc;
+		const ScalarParam* sRow0Ptr=sPixels+sStride*2*rowBegin;
+		const ScalarParam* sRow1Ptr=sRow0Ptr+sStride;
+		ScalarParam* dPtr=dPixels+(sStride/2)*rowBegin;
+		for(int y=rowBegin;y<rowEnd;++y,sRow0Ptr+=sStride*2,sRow1Ptr+=sStride*2)
 			{
-			for(unsigned int i=0;i<source.getNumChannels();++i,++s0Ptr,++s1Ptr,++dPtr)
+			const ScalarParam* s0Ptr=sRow0Ptr;
+			const ScalarParam* s1Ptr=sRow1Ptr;
+			for(unsigned int x=0;x<width;x+=2,s0Ptr+=nc,s1Ptr+=nc)
 				{
-				/* Average the current 2x2 pixel block: */
-				AccumParam sum0=AccumParam(s0Ptr[0])+AccumParam(s0Ptr[nc]);
-				AccumParam sum1=AccumParam(s1Ptr[0])+AccumParam(s1Ptr[nc]);
-				*dPtr=ScalarParam((sum0+sum1+2)>>2);
+				for(unsigned int i=0;i<nc;++i,++s0Ptr,++s1Ptr,++dPtr)
+					{
+					/* Average the current 2x2 pixel block: */
+					*dPtr=(s0Ptr[0]+s0Ptr[nc]+s1Ptr[0]+s1Ptr[nc])*ScalarParam(0.25);
+					}
 				}
 			}
 		}
-	}
+	};
 
 template <class ScalarParam>
 inline
@@ -431,25 +592,8 @@ shrinkTypedFloat(
 	const BaseImage& source,
 	BaseImage& dest)
 	{
-	/* Average all blocks of 2x2 pixels in the source image: */
-	unsigned int nc=source.getNumChannels();
-	const ScalarParam* sRow0Ptr=static_cast<const ScalarParam*>(source.getPixels());
-	const ptrdiff_t sStride=source.getSize(0)*nc;
-	const ScalarParam* sRow1Ptr=sRow0Ptr+sStride;
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	for(unsigned int y=0;y<source.getSize(1);y+=2,sRow0Ptr+=sStride*2,sRow1Ptr+=sStride*2)
-		{
-		const ScalarParam* s0Ptr=sRow0Ptr;
-		const ScalarParam* s1Ptr=sRow1Ptr;
-		for(unsigned int x=0;x<source.getSize(0);x+=2,s0Ptr+=nc,s1Ptr+=nc)
-			{
-			for(unsigned int i=0;i<source.getNumChannels();++i,++s0Ptr,++s1Ptr,++dPtr)
-				{
-				/* Average the current 2x2 pixel block: */
-				*dPtr=(s0Ptr[0]+s0Ptr[nc]+s1Ptr[0]+s1Ptr[nc])*ScalarParam(0.25);
-				}
-			}
-		}
+	/* Downsample bands of destination image rows in parallel: */
+	Threads::parallelFor(0,int(dest.getSize(1)),calcRowGrainSize(source.getSize(0)*2U),ShrinkTypedFloatRows<ScalarParam>(source,dest));
 	}
 
 /***************************************************************************
@@ -0,0 +1,413 @@
+/***********************************************************************
+ArrayKernels - Functions to evaluate elementary functions on arrays of
+double-precision values, using SSE2 instructions where available.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Templatized Math Library (Math).
+
+The Templatized Math Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Templatized Math Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Templatized Math Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Math/ArrayKernels.h>
+
+#include <math.h>
+
+#if defined(__SSE2__)
+#define MATH_ARRAYKERNELS_HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define MATH_ARRAYKERNELS_HAVE_SSE2 0
+#endif
+
+namespace Math {
+
+namespace ArrayKernels {
+
+namespace {
+
+/*********************
+Instruction set state:
+*********************/
+
+#if MATH_ARRAYKERNELS_HAVE_SSE2
+const InstructionSet bestInstructionSet=SSE2;
+#else
+const InstructionSet bestInstructionSet=SCALAR;
+#endif
+InstructionSet instructionSet=bestInstructionSet;
+
+#if MATH_ARRAYKERNELS_HAVE_SSE2
+
+/******************************************
+Constants for argument reduction and series:
+******************************************/
+
+const double twoOverPi=0.6366197723675814; // 2/pi
+const double piOver2Parts[3]={1.5707963267341256,6.077100506303966e-11,2.0222662487959506e-21}; // pi/2 split into two 33-bit parts and a remainder
+const double piOver4=0.7853981633974483;
+const double piOver2=1.5707963267948966;
+const double pi=3.141592653589793;
+const double tanPiOver8=0.41421356237309503;
+const double sqrt2=1.4142135623730951;
+const double invLn2=1.4426950408889634; // 1/ln(2)
+const double ln2Parts[2]={0.6931471803691238,1.9082149292705877e-10}; // ln(2) split into a 32-bit part and a remainder
+
+/* Taylor series coefficients on the reduced argument ranges, in order of increasing power: */
+const double sinCoeffs[8]={-1.0/6.0,1.0/120.0,-1.0/5040.0,1.0/362880.0,-1.0/39916800.0,1.0/6227020800.0,-1.0/1307674368000.0,1.0/355687428096000.0}; // sin(r)=r+r^3*P(r^2) on [-pi/4, pi/4]
+const double cosCoeffs[8]={1.0/24.0,-1.0/720.0,1.0/40320.0,-1.0/3628800.0,1.0/479001600.0,-1.0/87178291200.0,1.0/20922789888000.0,-1.0/6402373705728000.0}; // cos(r)=1-r^2/2+r^4*P(r^2) on [-pi/4, pi/4]
+const double atanCoeffs[11]={-1.0/3.0,1.0/5.0,-1.0/7.0,1.0/9.0,-1.0/11.0,1.0/13.0,-1.0/15.0,1.0/17.0,-1.0/19.0,1.0/21.0,-1.0/23.0}; // atan(v)=v+v^3*P(v^2) on [-tan(pi/16), tan(pi/16)]
+const double logCoeffs[10]={1.0/3.0,1.0/5.0,1.0/7.0,1.0/9.0,1.0/11.0,1.0/13.0,1.0/15.0,1.0/17.0,1.0/19.0,1.0/21.0}; // log((1+s)/(1-s))=2s+2s^3*P(s^2) on [-0.172, 0.172]
+const double expCoeffs[12]={1.0/2.0,1.0/6.0,1.0/24.0,1.0/120.0,1.0/720.0,1.0/5040.0,1.0/40320.0,1.0/362880.0,1.0/3628800.0,1.0/39916800.0,1.0/479001600.0,1.0/6227020800.0}; // exp(r)=1+r+r^2*P(r) on [-ln(2)/2, ln(2)/2]
+
+/*************
+SSE2 helpers:
+*************/
+
+inline __m128d abs(__m128d x)
+	{
+	return _mm_andnot_pd(_mm_set1_pd(-0.0),x);
+	}
+
+inline __m128d select(__m128d mask,__m128d ifTrue,__m128d ifFalse) // Selects from two vectors according to the given comparison mask
+	{
+	return _mm_or_pd(_mm_and_pd(mask,ifTrue),_mm_andnot_pd(mask,ifFalse));
+	}
+
+inline __m128d horner(__m128d x,const double* coeffs,int numCoeffs) // Evaluates a polynomial with coefficients in order of increasing power, as two interleaved Horner schemes for even and odd powers to shorten the dependency chain
+	{
+	__m128d x2=_mm_mul_pd(x,x);
+	int last=numCoeffs-1;
+	__m128d high=_mm_set1_pd(coeffs[last]);
+	__m128d low=_mm_set1_pd(coeffs[last-1]);
+	for(int i=last-2;i>=1;i-=2)
+		{
+		high=_mm_add_pd(_mm_mul_pd(high,x2),_mm_set1_pd(coeffs[i]));
+		low=_mm_add_pd(_mm_mul_pd(low,x2),_mm_set1_pd(coeffs[i-1]));
+		}
+	if((last&0x1)==0)
+		{
+		/* The first chain holds even powers and still lacks the constant coefficient: */
+		return _mm_add_pd(_mm_mul_pd(low,x),_mm_add_pd(_mm_mul_pd(high,x2),_mm_set1_pd(coeffs[0])));
+		}
+	else
+		{
+		/* The first chain holds odd powers: */
+		return _mm_add_pd(_mm_mul_pd(high,x),low);
+		}
+	}
+
+inline __m128i expand32To64(__m128i ints) // Copies the two 32-bit integers in the low half of a vector into both halves of two 64-bit lanes
+	{
+	return _mm_shuffle_epi32(ints,_MM_SHUFFLE(1,1,0,0));
+	}
+
+inline bool inRange(__m128d mask) // Returns true if both lanes of a comparison mask are set
+	{
+	return _mm_movemask_pd(mask)==0x3;
+	}
+
+/**************
+SSE2 kernels:
+**************/
+
+inline void sinCos(__m128d x,__m128d& s,__m128d& c) // Requires |x|<1.0e5
+	{
+	/* Reduce the angles to [-pi/4, pi/4] by subtracting the nearest multiple of pi/2 in three exact steps: */
+	__m128i q=_mm_cvtpd_epi32(_mm_mul_pd(x,_mm_set1_pd(twoOverPi)));
+	__m128d qd=_mm_cvtepi32_pd(q);
+	__m128d r=_mm_sub_pd(x,_mm_mul_pd(qd,_mm_set1_pd(piOver2Parts[0])));
+	r=_mm_sub_pd(r,_mm_mul_pd(qd,_mm_set1_pd(piOver2Parts[1])));
+	r=_mm_sub_pd(r,_mm_mul_pd(qd,_mm_set1_pd(piOver2Parts[2])));
+	
+	/* Evaluate the sine and cosine series on the reduced angles: */
+	__m128d r2=_mm_mul_pd(r,r);
+	__m128d rs=_mm_add_pd(r,_mm_mul_pd(_mm_mul_pd(r,r2),horner(r2,sinCoeffs,8)));
+	__m128d rc=_mm_add_pd(_mm_sub_pd(_mm_set1_pd(1.0),_mm_mul_pd(r2,_mm_set1_pd(0.5))),_mm_mul_pd(_mm_mul_pd(r2,r2),horner(r2,cosCoeffs,8)));
+	
+	/* Swap and negate the results according to the quadrant: */
+	__m128i q64=expand32To64(q);
+	__m128d swap=_mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(q64,_mm_set1_epi32(1)),_mm_set1_epi32(1)));
+	__m128d sinSign=_mm_castsi128_pd(_mm_slli_epi64(_mm_and_si128(q64,_mm_set1_epi32(2)),62));
+	__m128d cosSign=_mm_castsi128_pd(_mm_slli_epi64(_mm_and_si128(_mm_add_epi32(q64,_mm_set1_epi32(1)),_mm_set1_epi32(2)),62));
+	s=_mm_xor_pd(select(swap,rc,rs),sinSign);
+	c=_mm_xor_pd(select(swap,rs,rc),cosSign);
+	}
+
+inline __m128d atan2(__m128d y,__m128d x) // Requires finite x and y, not both zero
+	{
+	/* Reduce the angle to [0, pi/4] by taking the ratio of the smaller and the larger coordinate magnitude: */
+	__m128d ax=abs(x);
+	__m128d ay=abs(y);
+	__m128d t=_mm_div_pd(_mm_min_pd(ax,ay),_mm_max_pd(ax,ay));
+	
+	/* Reduce further to [-pi/8, pi/8] by subtracting pi/4 from angles larger than pi/8: */
+	__m128d one=_mm_set1_pd(1.0);
+	__m128d big=_mm_cmpgt_pd(t,_mm_set1_pd(tanPiOver8));
+	__m128d u=select(big,_mm_div_pd(_mm_sub_pd(t,one),_mm_add_pd(t,one)),t);
+	
+	/* Halve the angle to [-pi/16, pi/16] and evaluate the series: */
+	__m128d v=_mm_div_pd(u,_mm_add_pd(one,_mm_sqrt_pd(_mm_add_pd(one,_mm_mul_pd(u,u)))));
+	__m128d v2=_mm_mul_pd(v,v);
+	__m128d a=_mm_add_pd(v,_mm_mul_pd(_mm_mul_pd(v,v2),horner(v2,atanCoeffs,11)));
+	a=_mm_add_pd(a,a);
+	
+	/* Undo the reductions and move the angle into the correct quadrant: */
+	a=_mm_add_pd(a,_mm_and_pd(big,_mm_set1_pd(piOver4)));
+	a=select(_mm_cmpgt_pd(ay,ax),_mm_sub_pd(_mm_set1_pd(piOver2),a),a);
+	a=select(_mm_cmplt_pd(x,_mm_setzero_pd()),_mm_sub_pd(_mm_set1_pd(pi),a),a);
+	return _mm_or_pd(a,_mm_and_pd(y,_mm_set1_pd(-0.0)));
+	}
+
+inline __m128d log(__m128d x) // Requires normal positive finite x
+	{
+	/* Split the values into exponents and mantissas in [1, 2): */
+	__m128i bits=_mm_castpd_si128(x);
+	__m128i exponent=_mm_sub_epi32(_mm_shuffle_epi32(_mm_srli_epi64(bits,52),_MM_SHUFFLE(3,3,2,0)),_mm_set1_epi32(1023));
+	__m128d e=_mm_cvtepi32_pd(exponent);
+	__m128d m=_mm_castsi128_pd(_mm_or_si128(_mm_and_si128(bits,_mm_set_epi32(0x000fffff,0xffffffff,0x000fffff,0xffffffff)),_mm_castpd_si128(_mm_set1_pd(1.0))));
+	
+	/* Move the mantissas into [sqrt(1/2), sqrt(2)): */
+	__m128d big=_mm_cmpge_pd(m,_mm_set1_pd(sqrt2));
+	m=select(big,_mm_mul_pd(m,_mm_set1_pd(0.5)),m);
+	e=_mm_add_pd(e,_mm_and_pd(big,_mm_set1_pd(1.0)));
+	
+	/* Evaluate the series for log(m)=log((1+s)/(1-s)) with s=(m-1)/(m+1): */
+	__m128d one=_mm_set1_pd(1.0);
+	__m128d s=_mm_div_pd(_mm_sub_pd(m,one),_mm_add_pd(m,one));
+	__m128d s2=_mm_mul_pd(s,s);
+	__m128d twoS=_mm_add_pd(s,s);
+	__m128d logM=_mm_add_pd(twoS,_mm_mul_pd(_mm_mul_pd(twoS,s2),horner(s2,logCoeffs,10)));
+	
+	/* Add the exponents' contribution in two parts: */
+	return _mm_add_pd(_mm_mul_pd(e,_mm_set1_pd(ln2Parts[0])),_mm_add_pd(_mm_mul_pd(e,_mm_set1_pd(ln2Parts[1])),logM));
+	}
+
+inline __m128d exp(__m128d x) // Requires |x|<708
+	{
+	/* Reduce the arguments to [-ln(2)/2, ln(2)/2] by subtracting the nearest multiple of ln(2) in two exact steps: */
+	__m128i k=_mm_cvtpd_epi32(_mm_mul_pd(x,_mm_set1_pd(invLn2)));
+	__m128d kd=_mm_cvtepi32_pd(k);
+	__m128d r=_mm_sub_pd(_mm_sub_pd(x,_mm_mul_pd(kd,_mm_set1_pd(ln2Parts[0]))),_mm_mul_pd(kd,_mm_set1_pd(ln2Parts[1])));
+	
+	/* Evaluate the series on the reduced arguments: */
+	__m128d er=_mm_add_pd(_mm_add_pd(_mm_set1_pd(1.0),r),_mm_mul_pd(_mm_mul_pd(r,r),horner(r,expCoeffs,12)));
+	
+	/* Scale the results by 2^k, constructed directly from the multiples' bit patterns: */
+	__m128d scale=_mm_castsi128_pd(_mm_slli_epi64(_mm_add_epi32(expand32To64(k),_mm_set1_epi32(1023)),52));
+	return _mm_mul_pd(er,scale);
+	}
+
+#endif
+
+}
+
+/*********************************
+Kernel selection and entry points:
+*********************************/
+
+InstructionSet getInstructionSet(void)
+	{
+	return instructionSet;
+	}
+
+void setInstructionSet(InstructionSet newInstructionSet)
+	{
+	instructionSet=newInstructionSet<=bestInstructionSet?newInstructionSet:bestInstructionSet;
+	}
+
+void sqrt(const double* values,double* results,size_t numValues)
+	{
+	size_t i=0;
+	
+	#if MATH_ARRAYKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		for(;i+2<=numValues;i+=2)
+			_mm_storeu_pd(results+i,_mm_sqrt_pd(_mm_loadu_pd(values+i)));
+		}
+	#endif
+	
+	/* Process the remaining values: */
+	for(;i<numValues;++i)
+		results[i]=::sqrt(values[i]);
+	}
+
+void sinCos(const double* angles,double* sines,double* cosines,size_t numValues)
+	{
+	size_t i=0;
+	
+	#if MATH_ARRAYKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		__m128d limit=_mm_set1_pd(1.0e5);
+		for(;i+2<=numValues;i+=2)
+			{
+			__m128d x=_mm_loadu_pd(angles+i);
+			if(inRange(_mm_cmplt_pd(abs(x),limit)))
+				{
+				__m128d s,c;
+				sinCos(x,s,c);
+				_mm_storeu_pd(sines+i,s);
+				_mm_storeu_pd(cosines+i,c);
+				}
+			else
+				{
+				for(int j=0;j<2;++j)
+					{
+					double angle=angles[i+j];
+					sines[i+j]=::sin(angle);
+					cosines[i+j]=::cos(angle);
+					}
+				}
+			}
+		}
+	#endif
+	
+	/* Process the remaining values: */
+	for(;i<numValues;++i)
+		{
+		double angle=angles[i];
+		sines[i]=::sin(angle);
+		cosines[i]=::cos(angle);
+		}
+	}
+
+void atan2(const double* ys,const double* xs,double* angles,size_t numValues)
+	{
+	size_t i=0;
+	
+	#if MATH_ARRAYKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		__m128d inf=_mm_set1_pd(HUGE_VAL);
+		__m128d zero=_mm_setzero_pd();
+		for(;i+2<=numValues;i+=2)
+			{
+			__m128d y=_mm_loadu_pd(ys+i);
+			__m128d x=_mm_loadu_pd(xs+i);
+			__m128d ax=abs(x);
+			__m128d ay=abs(y);
+			if(inRange(_mm_and_pd(_mm_and_pd(_mm_cmplt_pd(ax,inf),_mm_cmplt_pd(ay,inf)),_mm_cmpgt_pd(_mm_max_pd(ax,ay),zero))))
+				_mm_storeu_pd(angles+i,atan2(y,x));
+			else
+				{
+				for(int j=0;j<2;++j)
+					angles[i+j]=::atan2(ys[i+j],xs[i+j]);
+				}
+			}
+		}
+	#endif
+	
+	/* Process the remaining values: */
+	for(;i<numValues;++i)
+		angles[i]=::atan2(ys[i],xs[i]);
+	}
+
+void log(const double* values,double* results,size_t numValues)
+	{
+	size_t i=0;
+	
+	#if MATH_ARRAYKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		__m128d minNormal=_mm_set1_pd(2.2250738585072014e-308);
+		__m128d inf=_mm_set1_pd(HUGE_VAL);
+		for(;i+2<=numValues;i+=2)
+			{
+			__m128d x=_mm_loadu_pd(values+i);
+			if(inRange(_mm_and_pd(_mm_cmpge_pd(x,minNormal),_mm_cmplt_pd(x,inf))))
+				_mm_storeu_pd(results+i,log(x));
+			else
+				{
+				for(int j=0;j<2;++j)
+					results[i+j]=::log(values[i+j]);
+				}
+			}
+		}
+	#endif
+	
+	/* Process the remaining values: */
+	for(;i<numValues;++i)
+		results[i]=::log(values[i]);
+	}
+
+void exp(const double* values,double* results,size_t numValues)
+	{
+	size_t i=0;
+	
+	#if MATH_ARRAYKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		__m128d limit=_mm_set1_pd(708.0);
+		for(;i+2<=numValues;i+=2)
+			{
+			__m128d x=_mm_loadu_pd(values+i);
+			if(inRange(_mm_cmplt_pd(abs(x),limit)))
+				_mm_storeu_pd(results+i,exp(x));
+			else
+				{
+				for(int j=0;j<2;++j)
+					results[i+j]=::exp(values[i+j]);
+				}
+			}
+		}
+	#endif
+	
+	/* Process the remaining values: */
+	for(;i<numValues;++i)
+		results[i]=::exp(values[i]);
+	}
+
+void pow(const double* bases,double exponent,double* results,size_t numValues)
+	{
+	size_t i=0;
+	
+	#if MATH_ARRAYKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		__m128d minNormal=_mm_set1_pd(2.2250738585072014e-308);
+		__m128d inf=_mm_set1_pd(HUGE_VAL);
+		__m128d limit=_mm_set1_pd(708.0);
+		__m128d e=_mm_set1_pd(exponent);
+		for(;i+2<=numValues;i+=2)
+			{
+			/* Calculate the powers as exp(exponent*log(base)) if the bases and the results are in range: */
+			__m128d x=_mm_loadu_pd(bases+i);
+			bool ok=inRange(_mm_and_pd(_mm_cmpge_pd(x,minNormal),_mm_cmplt_pd(x,inf)));
+			__m128d y=_mm_setzero_pd();
+			if(ok)
+				{
+				y=_mm_mul_pd(e,log(x));
+				ok=inRange(_mm_cmplt_pd(abs(y),limit));
+				}
+			if(ok)
+				_mm_storeu_pd(results+i,exp(y));
+			else
+				{
+				for(int j=0;j<2;++j)
+					results[i+j]=::pow(bases[i+j],exponent);
+				}
+			}
+		}
+	#endif
+	
+	/* Process the remaining values: */
+	for(;i<numValues;++i)
+		results[i]=::pow(bases[i],exponent);
+	}
+
+}
+
+}
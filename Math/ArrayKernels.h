@@ -0,0 +1,53 @@
+/***********************************************************************
+ArrayKernels - Functions to evaluate elementary functions on arrays of
+double-precision values, using SSE2 instructions where available.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Templatized Math Library (Math).
+
+The Templatized Math Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Templatized Math Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Templatized Math Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef MATH_ARRAYKERNELS_INCLUDED
+#define MATH_ARRAYKERNELS_INCLUDED
+
+#include <stddef.h>
+
+namespace Math {
+
+namespace ArrayKernels {
+
+/* All functions process arrays element by element; source and destination arrays may be identical. Vectorized results are within a few units in the last place of the C library's results; arguments outside a kernel's reduced range (huge angles, non-normal or non-finite values) are passed to the C library: */
+
+enum InstructionSet // Enumerated type for instruction sets used by the kernels
+	{
+	SCALAR=0,SSE2
+	};
+
+InstructionSet getInstructionSet(void); // Returns the instruction set selected for the host CPU
+void setInstructionSet(InstructionSet newInstructionSet); // Overrides the selected instruction set; instruction sets not supported by the build are reduced to the best supported one
+
+void sqrt(const double* values,double* results,size_t numValues); // Calculates square roots
+void sinCos(const double* angles,double* sines,double* cosines,size_t numValues); // Calculates sines and cosines of angles in radians
+void atan2(const double* ys,const double* xs,double* angles,size_t numValues); // Calculates the angles of (x, y) vectors in radians, like the C library's atan2(y, x)
+void log(const double* values,double* results,size_t numValues); // Calculates natural logarithms
+void exp(const double* values,double* results,size_t numValues); // Calculates natural exponentials
+void pow(const double* bases,double exponent,double* results,size_t numValues); // Raises an array of positive bases to a common exponent
+
+}
+
+}
+
+#endif
@@ -26,14 +26,179 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdio.h>
 #include <unistd.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include <vector>
+#include <Misc/SizedTypes.h>
 #include <Misc/File.h>
 #include <Misc/StandardValueCoders.h>
 
 namespace Misc {
 
+namespace {
+
+/**************************************************************
+Helper functions and classes for compiled configuration files:
+**************************************************************/
+
+/* Compiled configuration files are sequences of commands replaying the effect of a configuration file's text on a section hierarchy; all integers are stored in little-endian byte order to keep compiled code portable between cluster nodes. */
+
+enum Opcode // Enumerated type for compiled configuration file commands
+	{
+	SECTION=0, // Enters a subsection, creating it if necessary; followed by the subsection name
+	ENDSECTION, // Returns to the parent section
+	SETTAG, // Sets a tag's value; followed by the tag and the value
+	APPENDTAG, // Appends to a list-valued tag using the += operator; followed by the source line number, the tag, and the list items to append
+	REMOVETAG // Removes a tag; followed by the tag
+	};
+
+const char cacheMagic[8]={'M','C','F','G','C','0','0','1'}; // Magic string identifying compiled configuration file caches
+
+inline void putUInt32(std::vector<char>& code,UInt32 value)
+	{
+	for(int i=0;i<4;++i,value>>=8)
+		code.push_back(char(value&0xffU));
+	}
+
+inline void putUInt64(std::vector<char>& code,UInt64 value)
+	{
+	for(int i=0;i<8;++i,value>>=8)
+		code.push_back(char(value&0xffU));
+	}
+
+inline void putString(std::vector<char>& code,const char* begin,const char* end)
+	{
+	putUInt32(code,UInt32(end-begin));
+	code.insert(code.end(),begin,end);
+	}
+
+inline void putString(std::vector<char>& code,const std::string& string)
+	{
+	putString(code,string.data(),string.data()+string.size());
+	}
+
+class CodeReader // Class to read a buffer of compiled code
+	{
+	/* Elements: */
+	private:
+	const unsigned char* codePtr; // Pointer to next byte to read
+	const unsigned char* codeEnd; // Pointer to end of buffer
+	
+	/* Constructors and destructors: */
+	public:
+	CodeReader(const char* sCode,size_t sCodeSize)
+		:codePtr(reinterpret_cast<const unsigned char*>(sCode)),
+		 codeEnd(reinterpret_cast<const unsigned char*>(sCode)+sCodeSize)
+		{
+		}
+	
+	/* Methods: */
+	bool eof(void) const // Returns true if the entire buffer has been read
+		{
+		return codePtr==codeEnd;
+		}
+	size_t getRemaining(void) const // Returns the number of unread bytes
+		{
+		return codeEnd-codePtr;
+		}
+	const char* getPointer(void) const // Returns pointer to the next byte to read
+		{
+		return reinterpret_cast<const char*>(codePtr);
+		}
+	void check(size_t size) const // Throws an exception if fewer than the given number of bytes are left
+		{
+		if(size_t(codeEnd-codePtr)<size)
+			throw std::runtime_error("Misc::ConfigurationFile: Truncated compiled configuration file");
+		}
+	unsigned int getOpcode(void)
+		{
+		check(1);
+		return *(codePtr++);
+		}
+	UInt32 getUInt32(void)
+		{
+		check(4);
+		UInt32 result=0;
+		for(int i=3;i>=0;--i)
+			result=(result<<8)|UInt32(codePtr[i]);
+		codePtr+=4;
+		return result;
+		}
+	UInt64 getUInt64(void)
+		{
+		check(8);
+		UInt64 result=0;
+		for(int i=7;i>=0;--i)
+			result=(result<<8)|UInt64(codePtr[i]);
+		codePtr+=8;
+		return result;
+		}
+	std::string getString(void)
+		{
+		size_t length=getUInt32();
+		check(length);
+		std::string result(reinterpret_cast<const char*>(codePtr),length);
+		codePtr+=length;
+		return result;
+		}
+	void skipString(void)
+		{
+		size_t length=getUInt32();
+		check(length);
+		codePtr+=length;
+		}
+	};
+
+class CodeCompiler // Class to append configuration file commands to a buffer of compiled code
+	{
+	/* Elements: */
+	private:
+	std::vector<char>& code; // The code buffer
+	
+	/* Constructors and destructors: */
+	public:
+	CodeCompiler(std::vector<char>& sCode)
+		:code(sCode)
+		{
+		}
+	
+	/* Methods: */
+	void enterSection(const std::string& sectionName)
+		{
+		code.push_back(char(SECTION));
+		putString(code,sectionName);
+		}
+	void leaveSection(void)
+		{
+		code.push_back(char(ENDSECTION));
+		}
+	void setTag(const std::string& tag,const std::string& value)
+		{
+		code.push_back(char(SETTAG));
+		putString(code,tag);
+		putString(code,value);
+		}
+	void appendTag(int lineNumber,const std::string& tag,const std::string& items)
+		{
+		code.push_back(char(APPENDTAG));
+		putUInt32(code,UInt32(lineNumber));
+		putString(code,tag);
+		putString(code,items);
+		}
+	void removeTag(const std::string& tag)
+		{
+		code.push_back(char(REMOVETAG));
+		putString(code,tag);
+		}
+	};
+
+}
+
 /****************************************************************
 Methods of class ConfigurationFileBase::MalFormedConfigFileError:
 ****************************************************************/
@@ -69,46 +234,78 @@ ConfigurationFileBase::Section::Section(ConfigurationFileBase::Section* sParent,
 	:parent(sParent),name(sName),
 	 sibling(0),
 	 firstSubsection(0),lastSubsection(0),
+	 index(sParent!=0?sParent->index:new Index),
 	 edited(false)
 	{
 	}
 
 ConfigurationFileBase::Section::~Section(void)
 	{
-	/* Delete all subsections: */
-	while(firstSubsection!=0)
+	if(parent!=0)
 		{
-		Section* next=firstSubsection->sibling;
-		delete firstSubsection;
-		firstSubsection=next;
+		/* Remove all subsections and tag/value pairs from the shared name index: */
+		removeAll();
+		}
+	else
+		{
+		/* Delete all subsections: */
+		while(firstSubsection!=0)
+			{
+			Section* next=firstSubsection->sibling;
+			delete firstSubsection;
+			firstSubsection=next;
+			}
+		
+		/* Delete the name index: */
+		delete index;
 		}
 	}
 
-void ConfigurationFileBase::Section::clear(void)
+void ConfigurationFileBase::Section::removeAll(void)
 	{
 	/* Remove all subsections: */
 	while(firstSubsection!=0)
 		{
 		Section* succ=firstSubsection->sibling;
+		index->subsections.removeEntry(IndexKey(this,firstSubsection->name));
 		delete firstSubsection;
 		firstSubsection=succ;
 		}
 	lastSubsection=0;
 	
 	/* Remove all tag/value pairs: */
+	for(std::list<TagValue>::iterator tvIt=values.begin();tvIt!=values.end();++tvIt)
+		index->tags.removeEntry(IndexKey(this,tvIt->tag));
 	values.clear();
+	}
+
+void ConfigurationFileBase::Section::clear(void)
+	{
+	/* Remove all subsections and tag/value pairs: */
+	removeAll();
 	
 	/* Mark the section as edited: */
 	edited=true;
 	}
 
+ConfigurationFileBase::Section* ConfigurationFileBase::Section::findSubsection(const std::string& subsectionName) const
+	{
+	/* Look up the subsection in the subsection index: */
+	SubsectionIndex::Iterator ssIt=index->subsections.findEntry(IndexKey(this,subsectionName));
+	return !ssIt.isFinished()?ssIt->getDest():0;
+	}
+
+const ConfigurationFileBase::Section::TagValue* ConfigurationFileBase::Section::findTag(const std::string& tag) const
+	{
+	/* Look up the tag/value pair in the tag index: */
+	TagIndex::Iterator tIt=index->tags.findEntry(IndexKey(this,tag));
+	return !tIt.isFinished()?&*tIt->getDest():0;
+	}
+
 ConfigurationFileBase::Section* ConfigurationFileBase::Section::addSubsection(const std::string& subsectionName)
 	{
 	/* Check if the subsection already exists: */
-	Section* sPtr;
-	for(sPtr=firstSubsection;sPtr!=0;sPtr=sPtr->sibling)
-		if(sPtr->name==subsectionName)
-			break;
+	Section* sPtr=findSubsection(subsectionName);
 	
 	if(sPtr==0)
 		{
@@ -119,6 +316,7 @@ ConfigurationFileBase::Section* ConfigurationFileBase::Section::addSubsection(co
 		else
 			firstSubsection=newSubsection;
 		lastSubsection=newSubsection;
+		index->subsections.setEntry(SubsectionIndex::Entry(IndexKey(this,newSubsection->name),newSubsection));
 		
 		/* Mark the section as edited: */
 		edited=true;
@@ -132,13 +330,17 @@ ConfigurationFileBase::Section* ConfigurationFileBase::Section::addSubsection(co
 void ConfigurationFileBase::Section::removeSubsection(const std::string& subsectionName)
 	{
 	/* Find a subsection of the given name: */
-	Section* sPred=0;
-	Section* sPtr;
-	for(sPtr=firstSubsection;sPtr!=0&&sPtr->name!=subsectionName;sPred=sPtr,sPtr=sPtr->sibling)
-		;
+	Section* sPtr=findSubsection(subsectionName);
 	if(sPtr!=0)
 		{
+		/* Find the subsection's predecessor in the subsection list: */
+		Section* sPred=0;
+		if(sPtr!=firstSubsection)
+			for(sPred=firstSubsection;sPred->sibling!=sPtr;sPred=sPred->sibling)
+				;
+		
 		/* Remove the subsection: */
+		index->subsections.removeEntry(IndexKey(this,subsectionName));
 		if(sPred!=0)
 			sPred->sibling=sPtr->sibling;
 		else
@@ -154,21 +356,21 @@ void ConfigurationFileBase::Section::removeSubsection(const std::string& subsect
 
 void ConfigurationFileBase::Section::addTagValue(const std::string& newTag,const std::string& newValue)
 	{
-	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::iterator tvIt;
-	for(tvIt=values.begin();tvIt!=values.end()&&tvIt->tag!=newTag;++tvIt)
-		;
+	/* Find the tag name in the section's tag index: */
+	TagIndex::Iterator tIt=index->tags.findEntry(IndexKey(this,newTag));
 	
 	/* Set tag value: */
-	if(tvIt==values.end())
+	if(tIt.isFinished())
 		{
 		/* Add a new tag/value pair: */
 		values.push_back(TagValue(newTag,newValue));
+		std::list<TagValue>::iterator newTvIt=--values.end();
+		index->tags.setEntry(TagIndex::Entry(IndexKey(this,newTvIt->tag),newTvIt));
 		}
 	else
 		{
 		/* Set new value for existing tag/value pair: */
-		tvIt->value=newValue;
+		tIt->getDest()->value=newValue;
 		}
 	
 	/* Mark the section as edited: */
@@ -177,16 +379,15 @@ void ConfigurationFileBase::Section::addTagValue(const std::string& newTag,const
 
 void ConfigurationFileBase::Section::removeTag(const std::string& tag)
 	{
-	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::iterator tvIt;
-	for(tvIt=values.begin();tvIt!=values.end()&&tvIt->tag!=tag;++tvIt)
-		;
+	/* Find the tag name in the section's tag index: */
+	TagIndex::Iterator tIt=index->tags.findEntry(IndexKey(this,tag));
 	
 	/* Check if the tag was found: */
-	if(tvIt!=values.end())
+	if(!tIt.isFinished())
 		{
 		/* Remove tag/value pair: */
-		values.erase(tvIt);
+		values.erase(tIt->getDest());
+		index->tags.removeEntry(tIt);
 		}
 	
 	/* Mark the section as edited: */
@@ -266,6 +467,26 @@ void ConfigurationFileBase::Section::save(File& file,int sectionLevel)
 	edited=false;
 	}
 
+void ConfigurationFileBase::Section::compile(std::vector<char>& code) const
+	{
+	/* Compile all subsections: */
+	for(const Section* ssPtr=firstSubsection;ssPtr!=0;ssPtr=ssPtr->sibling)
+		{
+		code.push_back(char(SECTION));
+		putString(code,ssPtr->name);
+		ssPtr->compile(code);
+		code.push_back(char(ENDSECTION));
+		}
+	
+	/* Compile all tag/value pairs in order: */
+	for(std::list<TagValue>::const_iterator tvIt=values.begin();tvIt!=values.end();++tvIt)
+		{
+		code.push_back(char(SETTAG));
+		putString(code,tvIt->tag);
+		putString(code,tvIt->value);
+		}
+	}
+
 std::string ConfigurationFileBase::Section::getPath(void) const
 	{
 	if(parent==0)
@@ -326,9 +547,7 @@ const ConfigurationFileBase::Section* ConfigurationFileBase::Section::getSection
 			{
 			/* Find subsection name in current section: */
 			std::string subsectionName(pathSuffixPtr,nextSlashPtr-pathSuffixPtr);
-			Section* ssPtr;
-			for(ssPtr=sPtr->firstSubsection;ssPtr!=0&&ssPtr->name!=subsectionName;ssPtr=ssPtr->sibling)
-				;
+			Section* ssPtr=sPtr->findSubsection(subsectionName);
 			
 			/* Go down in the section hierarchy: */
 			if(ssPtr==0)
@@ -412,12 +631,8 @@ bool ConfigurationFileBase::Section::hasTag(const char* relativeTagPath) const
 	const char* tagName=0;
 	const Section* sPtr=getSection(relativeTagPath,&tagName);
 	
-	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::const_iterator tvIt;
-	for(tvIt=sPtr->values.begin();tvIt!=sPtr->values.end()&&tvIt->tag!=tagName;++tvIt)
-		;
-	
-	return tvIt!=sPtr->values.end();
+	/* Find the tag name in the section's tag index: */
+	return sPtr->findTag(tagName)!=0;
 	}
 
 const std::string* ConfigurationFileBase::Section::findTagValue(const char* relativeTagPath) const
@@ -426,13 +641,11 @@ const std::string* ConfigurationFileBase::Section::findTagValue(const char* rela
 	const char* tagName=0;
 	const Section* sPtr=getSection(relativeTagPath,&tagName);
 	
-	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::const_iterator tvIt;
-	for(tvIt=sPtr->values.begin();tvIt!=sPtr->values.end()&&tvIt->tag!=tagName;++tvIt)
-		;
+	/* Find the tag name in the section's tag index: */
+	const TagValue* tv=sPtr->findTag(tagName);
 	
 	/* Return tag value or null pointer: */
-	return tvIt!=sPtr->values.end()?&(tvIt->value):0;
+	return tv!=0?&(tv->value):0;
 	}
 
 const std::string& ConfigurationFileBase::Section::retrieveTagValue(const char* relativeTagPath) const
@@ -441,15 +654,13 @@ const std::string& ConfigurationFileBase::Section::retrieveTagValue(const char*
 	const char* tagName=0;
 	const Section* sPtr=getSection(relativeTagPath,&tagName);
 	
-	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::const_iterator tvIt;
-	for(tvIt=sPtr->values.begin();tvIt!=sPtr->values.end()&&tvIt->tag!=tagName;++tvIt)
-		;
+	/* Find the tag name in the section's tag index: */
+	const TagValue* tv=sPtr->findTag(tagName);
 	
 	/* Return tag value: */
-	if(tvIt==sPtr->values.end())
+	if(tv==0)
 		throw TagNotFoundError(tagName,sPtr->getPath());
-	return tvIt->value;
+	return tv->value;
 	}
 
 std::string ConfigurationFileBase::Section::retrieveTagValue(const char* relativeTagPath,const std::string& defaultValue) const
@@ -467,15 +678,13 @@ std::string ConfigurationFileBase::Section::retrieveTagValue(const char* relativ
 		return defaultValue;
 		}
 	
-	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::const_iterator tvIt;
-	for(tvIt=sPtr->values.begin();tvIt!=sPtr->values.end()&&tvIt->tag!=tagName;++tvIt)
-		;
-
+	/* Find the tag name in the section's tag index: */
+	const TagValue* tv=sPtr->findTag(tagName);
+	
 	/* Return tag value: */
-	if(tvIt==sPtr->values.end())
+	if(tv==0)
 		throw TagNotFoundError(tagName,sPtr->getPath());
-	return tvIt->value;
+	return tv->value;
 	}
 
 const std::string& ConfigurationFileBase::Section::retrieveTagValue(const char* relativeTagPath,const std::string& defaultValue)
@@ -484,24 +693,19 @@ const std::string& ConfigurationFileBase::Section::retrieveTagValue(const char*
 	const char* tagName=0;
 	Section* sPtr=getSection(relativeTagPath,&tagName);
 	
-	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::const_iterator tvIt;
-	for(tvIt=sPtr->values.begin();tvIt!=sPtr->values.end()&&tvIt->tag!=tagName;++tvIt)
-		;
+	/* Find the tag name in the section's tag index: */
+	const TagValue* tv=sPtr->findTag(tagName);
 	
 	/* Return tag value: */
-	if(tvIt==sPtr->values.end())
+	if(tv==0)
 		{
-		/* Add a new tag/value pair: */
-		sPtr->values.push_back(TagValue(tagName,defaultValue));
-		
-		/* Mark section as edited: */
-		sPtr->edited=true;
+		/* Add a new tag/value pair and mark the section as edited: */
+		sPtr->addTagValue(tagName,defaultValue);
 		
 		return defaultValue;
 		}
 	else
-		return tvIt->value;
+		return tv->value;
 	}
 
 void ConfigurationFileBase::Section::storeTagValue(const char* relativeTagPath,const std::string& newValue)
@@ -514,57 +718,86 @@ void ConfigurationFileBase::Section::storeTagValue(const char* relativeTagPath,c
 	sPtr->addTagValue(tagName,newValue);
 	}
 
-/**************************************
-Methods of class ConfigurationFileBase:
-**************************************/
-
-ConfigurationFileBase::ConfigurationFileBase(void)
-	:rootSection(new Section(0,std::string("")))
-	{
-	}
-
-ConfigurationFileBase::ConfigurationFileBase(const char* sFileName)
-	:rootSection(0)
-	{
-	/* Load the configuration file: */
-	load(sFileName);
-	}
-
-ConfigurationFileBase::~ConfigurationFileBase(void)
-	{
-	delete rootSection;
-	}
+/**********************************************************
+Definition of class ConfigurationFileBase::CommandExecutor:
+**********************************************************/
 
-void ConfigurationFileBase::load(const char* newFileName)
+class ConfigurationFileBase::CommandExecutor
 	{
-	/* Delete current configuration file contents: */
-	delete rootSection;
-	
-	/* Create root section: */
-	rootSection=new Section(0,std::string(""));
-	
-	/* Store the file name: */
-	fileName=newFileName;
+	/* Elements: */
+	private:
+	Section* sectionPtr; // The section to which commands are currently applied
+	const char* sourceName; // Name of the configuration file whose commands are applied, for error messages
 	
-	/* Merge contents of given configuration file: */
-	merge(newFileName);
+	/* Constructors and destructors: */
+	public:
+	CommandExecutor(Section* sRootSection,const char* sSourceName)
+		:sectionPtr(sRootSection),sourceName(sSourceName)
+		{
+		}
 	
-	/* Reset edit flag: */
-	rootSection->clearEditFlag();
-	}
+	/* Methods: */
+	void enterSection(const std::string& sectionName) // Enters a subsection, creating it if necessary
+		{
+		sectionPtr=sectionPtr->addSubsection(sectionName);
+		}
+	void leaveSection(void) // Returns to the parent section
+		{
+		if(sectionPtr->parent!=0)
+			sectionPtr=sectionPtr->parent;
+		}
+	void setTag(const std::string& tag,const std::string& value) // Sets a tag's value
+		{
+		sectionPtr->addTagValue(tag,value);
+		}
+	void appendTag(int lineNumber,const std::string& tag,const std::string& items) // Appends the given items to a list-valued tag
+		{
+		/* Get the current tag value, defaulting to an empty list if the tag does not exist yet: */
+		const Section::TagValue* tv=sectionPtr->findTag(tag);
+		std::string currentValue=tv!=0?tv->value:std::string("()");
+		
+		/* Check that the current tag value ends with a closing parenthesis: */
+		if(currentValue.empty()||*(currentValue.end()-1)!=')')
+			throw MalformedConfigFileError("+= operator used on non-list",lineNumber,sourceName);
+		
+		/* Concatenate the current and new tag values: */
+		currentValue.erase(currentValue.end()-1);
+		
+		/* Insert a list item separator if the current value is not the empty list: */
+		if(*(currentValue.end()-1)!='(')
+			currentValue.append(", ");
+		
+		currentValue.append(items);
+		
+		/* Store the concatenated tag values: */
+		sectionPtr->addTagValue(tag,currentValue);
+		}
+	void removeTag(const std::string& tag) // Removes a tag
+		{
+		sectionPtr->removeTag(tag);
+		}
+	};
 
-void ConfigurationFileBase::merge(const char* mergeFileName)
+namespace {
+
+/********************************************
+Helper function to parse configuration files:
+********************************************/
+
+template <class CommandSinkParam>
+void parseFile(const char* sourceFileName,CommandSinkParam& sink)
 	{
 	/* Try opening configuration file: */
-	File file(mergeFileName,"rt");
+	File file(sourceFileName,"rt");
 	
 	/* Read configuration file contents: */
-	Section* sectionPtr=rootSection;
+	int sectionLevel=0;
 	int lineNumber=0;
+	std::string line;
 	while(!file.eof())
 		{
-		/* Concatenate lines from configuration file: */
-		std::string line="";
+		/* Concatenate lines from configuration file, re-using the line buffer's storage: */
+		line.clear();
 		char lineBuffer[1024];
 		bool firstLine=true;
 		while(true)
@@ -586,7 +819,7 @@ void ConfigurationFileBase::merge(const char* mergeFileName)
 			
 			/* Check if line was read completely: */
 			if(lineEndPtr[-1]!='\n')
-				throw MalformedConfigFileError("Line too long",lineNumber,fileName);
+				throw ConfigurationFileBase::MalformedConfigFileError("Line too long",lineNumber,sourceFileName);
 			
 			if(lineEndPtr-2>=lineBuffer&&lineEndPtr[-2]=='\\')
 				{
@@ -655,16 +888,20 @@ void ConfigurationFileBase::merge(const char* mergeFileName)
 			
 			/* Add a new subsection to the current section and make it the current section: */
 			if(sectionName.empty())
-				throw MalformedConfigFileError("Missing section name after section command",lineNumber,fileName);
-			sectionPtr=sectionPtr->addSubsection(sectionName);
+				throw ConfigurationFileBase::MalformedConfigFileError("Missing section name after section command",lineNumber,sourceFileName);
+			sink.enterSection(sectionName);
+			++sectionLevel;
 			}
 		else if(strcasecmp(token.c_str(),"endsection")==0)
 			{
 			/* End the current section: */
-			if(sectionPtr->parent!=0)
-				sectionPtr=sectionPtr->parent;
+			if(sectionLevel>0)
+				{
+				sink.leaveSection();
+				--sectionLevel;
+				}
 			else
-				throw MalformedConfigFileError("Extra endsection command",lineNumber,fileName);
+				throw ConfigurationFileBase::MalformedConfigFileError("Extra endsection command",lineNumber,sourceFileName);
 			}
 		else if(linePtr!=lineEndPtr)
 			{
@@ -676,40 +913,335 @@ void ConfigurationFileBase::merge(const char* mergeFileName)
 					;
 				if(linePtr!=lineEndPtr)
 					{
-					/* Get the current tag value, defaulting to an empty list if the tag does not exist yet: */
-					std::string currentValue=sectionPtr->retrieveTagValue(token.c_str(),"()");
+					/* Check that the new tag value starts with an opening parenthesis; the current value is checked when the command is applied: */
+					if(*linePtr!='(')
+						throw ConfigurationFileBase::MalformedConfigFileError("+= operator used on non-list",lineNumber,sourceFileName);
 					
-					/* Check that the current tag ends with a closing parenthesis, and the new tag value starts with an opening parenthesis: */
-					if(*linePtr=='('&&*(currentValue.end()-1)==')')
-						{
-						/* Concatenate the current and new tag values: */
-						currentValue.erase(currentValue.end()-1);
-						
-						/* Insert a list item separator if the current value is not the empty list: */
-						if(*(currentValue.end()-1)!='(')
-							currentValue.append(", ");
-						
-						currentValue.append(std::string(linePtr+1,lineEndPtr));
-						
-						/* Store the concatenated tag values: */
-						sectionPtr->addTagValue(token,currentValue);
-						}
-					else
-						throw MalformedConfigFileError("+= operator used on non-list",lineNumber,fileName);
+					/* Append the new list items to the tag's current value: */
+					sink.appendTag(lineNumber,token,std::string(linePtr+1,lineEndPtr));
 					}
 				}
 			else
 				{
 				/* Add a tag/value pair to the current section: */
-				sectionPtr->addTagValue(token,std::string(linePtr,lineEndPtr));
+				sink.setTag(token,std::string(linePtr,lineEndPtr));
 				}
 			}
 		else
 			{
 			/* Remove the tag from the current section: */
-			sectionPtr->removeTag(token);
+			sink.removeTag(token);
+			}
+		}
+	}
+
+}
+
+/**************************************
+Methods of class ConfigurationFileBase:
+**************************************/
+
+ConfigurationFileBase::ConfigurationFileBase(void)
+	:rootSection(new Section(0,std::string("")))
+	{
+	}
+
+ConfigurationFileBase::ConfigurationFileBase(const char* sFileName)
+	:rootSection(0)
+	{
+	/* Load the configuration file: */
+	load(sFileName);
+	}
+
+ConfigurationFileBase::~ConfigurationFileBase(void)
+	{
+	delete rootSection;
+	}
+
+void ConfigurationFileBase::load(const char* newFileName)
+	{
+	/* Delete current configuration file contents: */
+	delete rootSection;
+	
+	/* Create root section: */
+	rootSection=new Section(0,std::string(""));
+	
+	/* Store the file name: */
+	fileName=newFileName;
+	
+	/* Merge contents of given configuration file: */
+	merge(newFileName);
+	
+	/* Reset edit flag: */
+	rootSection->clearEditFlag();
+	}
+
+void ConfigurationFileBase::compileFile(const char* sourceFileName,std::vector<char>& code)
+	{
+	/* Parse the configuration file into the given buffer: */
+	CodeCompiler compiler(code);
+	parseFile(sourceFileName,compiler);
+	}
+
+void ConfigurationFileBase::mergeText(const char* mergeFileName)
+	{
+	/* Parse the configuration file and apply its commands directly, starting at the root section: */
+	CommandExecutor executor(rootSection,mergeFileName);
+	parseFile(mergeFileName,executor);
+	}
+
+void ConfigurationFileBase::execute(const char* code,size_t codeSize,const char* sourceName)
+	{
+	/* Execute all commands in the given code buffer: */
+	CodeReader reader(code,codeSize);
+	CommandExecutor executor(rootSection,sourceName);
+	while(!reader.eof())
+		{
+		switch(reader.getOpcode())
+			{
+			case SECTION:
+				executor.enterSection(reader.getString());
+				break;
+			
+			case ENDSECTION:
+				executor.leaveSection();
+				break;
+			
+			case SETTAG:
+				{
+				std::string tag=reader.getString();
+				executor.setTag(tag,reader.getString());
+				break;
+				}
+			
+			case APPENDTAG:
+				{
+				int lineNumber=int(reader.getUInt32());
+				std::string tag=reader.getString();
+				executor.appendTag(lineNumber,tag,reader.getString());
+				break;
+				}
+			
+			case REMOVETAG:
+				executor.removeTag(reader.getString());
+				break;
+			
+			default:
+				throw std::runtime_error("Misc::ConfigurationFile: Invalid command in compiled configuration file");
+			}
+		}
+	}
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+std::string getCacheFileName(const std::string& cacheDirectory,const std::string& sourcePath)
+	{
+	/* Hash the source file's canonical path: */
+	UInt64 hash=0xcbf29ce484222325ULL;
+	for(std::string::const_iterator spIt=sourcePath.begin();spIt!=sourcePath.end();++spIt)
+		hash=(hash^UInt64((unsigned char)(*spIt)))*0x100000001b3ULL;
+	
+	/* Create a cache file name from the source file's base name and the hash: */
+	std::string::size_type slashPos=sourcePath.rfind('/');
+	std::string result=cacheDirectory;
+	result.push_back('/');
+	result.append(sourcePath,slashPos!=std::string::npos?slashPos+1:0,std::string::npos);
+	char hashString[24];
+	snprintf(hashString,sizeof(hashString),"-%016llx.cache",(unsigned long long)hash);
+	result.append(hashString);
+	
+	return result;
+	}
+
+bool getSourcePath(const char* sourceFileName,std::string& sourcePath,struct stat& sourceStat)
+	{
+	/* Get the source file's canonical path and status: */
+	char* realPath=realpath(sourceFileName,0);
+	if(realPath==0)
+		return false;
+	sourcePath=realPath;
+	free(realPath);
+	return stat(sourcePath.c_str(),&sourceStat)==0;
+	}
+
+void putCacheHeader(std::vector<char>& header,const std::string& sourcePath,const struct stat& sourceStat)
+	{
+	/* Write the magic string, the source file's path, size, and modification time: */
+	header.insert(header.end(),cacheMagic,cacheMagic+sizeof(cacheMagic));
+	putString(header,sourcePath);
+	putUInt64(header,UInt64(sourceStat.st_size));
+	putUInt64(header,UInt64(sourceStat.st_mtim.tv_sec));
+	putUInt32(header,UInt32(sourceStat.st_mtim.tv_nsec));
+	}
+
+bool isValidCode(const char* code,size_t codeSize)
+	{
+	/* Check that the buffer consists of complete commands and closes no more sections than it opens: */
+	CodeReader reader(code,codeSize);
+	unsigned int sectionLevel=0;
+	try
+		{
+		while(!reader.eof())
+			{
+			switch(reader.getOpcode())
+				{
+				case SECTION:
+					reader.skipString();
+					++sectionLevel;
+					break;
+				
+				case ENDSECTION:
+					if(sectionLevel==0)
+						return false;
+					--sectionLevel;
+					break;
+				
+				case SETTAG:
+					reader.skipString();
+					reader.skipString();
+					break;
+				
+				case APPENDTAG:
+					reader.getUInt32();
+					reader.skipString();
+					reader.skipString();
+					break;
+				
+				case REMOVETAG:
+					reader.skipString();
+					break;
+				
+				default:
+					return false;
+				}
+			}
+		}
+	catch(const std::runtime_error&)
+		{
+		/* The last command is truncated: */
+		return false;
+		}
+	
+	return true;
+	}
+
+}
+
+bool ConfigurationFileBase::mergeCached(const std::string& cacheFileName,const std::vector<char>& cacheHeader,const char* mergeFileName)
+	{
+	/* Map the entire cache file into memory: */
+	int cacheFd=open(cacheFileName.c_str(),O_RDONLY);
+	if(cacheFd<0)
+		return false;
+	struct stat cacheStat;
+	void* cache=MAP_FAILED;
+	if(fstat(cacheFd,&cacheStat)==0&&cacheStat.st_size>0)
+		cache=mmap(0,cacheStat.st_size,PROT_READ,MAP_PRIVATE,cacheFd,0);
+	close(cacheFd);
+	if(cache==MAP_FAILED)
+		return false;
+	
+	bool result=false;
+	try
+		{
+		/* Check that the cache file's header matches the current state of the source file: */
+		const char* cachePtr=static_cast<const char*>(cache);
+		size_t cacheSize=cacheStat.st_size;
+		if(cacheSize>=cacheHeader.size()+8&&memcmp(cachePtr,&cacheHeader[0],cacheHeader.size())==0)
+			{
+			/* Read the compiled code's size and check it against the cache file's size: */
+			CodeReader reader(cachePtr+cacheHeader.size(),cacheSize-cacheHeader.size());
+			UInt64 codeSize=reader.getUInt64();
+			
+			/* Check the entire compiled code before applying any of it, so that a corrupted cache file can not leave the section hierarchy partially modified: */
+			if(codeSize==reader.getRemaining()&&isValidCode(reader.getPointer(),codeSize))
+				{
+				/* Execute the compiled code: */
+				execute(reader.getPointer(),codeSize,mergeFileName);
+				result=true;
+				}
 			}
 		}
+	catch(...)
+		{
+		/* Release the cache file and re-throw the exception: */
+		munmap(cache,cacheStat.st_size);
+		throw;
+		}
+	
+	/* Release the cache file: */
+	munmap(cache,cacheStat.st_size);
+	
+	return result;
+	}
+
+void ConfigurationFileBase::writeCache(const std::string& cacheFileName,const std::vector<char>& cacheHeader,const std::vector<char>& code) const
+	{
+	/* Append the compiled code's size to the cache file header: */
+	std::vector<char> header=cacheHeader;
+	putUInt64(header,UInt64(code.size()));
+	
+	/* Create the cache directory if it does not exist yet: */
+	mkdir(cacheDirectory.c_str(),0755);
+	
+	/* Write the cache file under a temporary name and then rename it, to not disturb concurrent readers: */
+	std::string tempFileName=cacheFileName+"XXXXXX";
+	int tempFd=mkstemp(&tempFileName[0]);
+	if(tempFd<0)
+		return;
+	bool ok=write(tempFd,&header[0],header.size())==ssize_t(header.size());
+	if(ok&&!code.empty())
+		ok=write(tempFd,&code[0],code.size())==ssize_t(code.size());
+	ok=close(tempFd)==0&&ok;
+	if(!ok||rename(tempFileName.c_str(),cacheFileName.c_str())!=0)
+		unlink(tempFileName.c_str());
+	}
+
+void ConfigurationFileBase::setCacheDirectory(const char* newCacheDirectory)
+	{
+	cacheDirectory=newCacheDirectory!=0?newCacheDirectory:"";
+	}
+
+void ConfigurationFileBase::merge(const char* mergeFileName)
+	{
+	/* Apply the configuration file's commands directly while parsing it if caching is disabled: */
+	if(cacheDirectory.empty())
+		{
+		mergeText(mergeFileName);
+		return;
+		}
+	
+	/* Find the source file and take its state before reading it, so that a cache file never claims a newer state than that of the code it contains: */
+	std::string sourcePath;
+	struct stat sourceStat;
+	if(!getSourcePath(mergeFileName,sourcePath,sourceStat))
+		{
+		/* Let the parser report the error: */
+		mergeText(mergeFileName);
+		return;
+		}
+	std::string cacheFileName=getCacheFileName(cacheDirectory,sourcePath);
+	std::vector<char> cacheHeader;
+	putCacheHeader(cacheHeader,sourcePath,sourceStat);
+	
+	/* Merge the cached compiled form of the configuration file if there is a valid one: */
+	if(mergeCached(cacheFileName,cacheHeader,mergeFileName))
+		return;
+	
+	/* Compile the configuration file: */
+	std::vector<char> code;
+	compileFile(mergeFileName,code);
+	
+	/* Cache the compiled form of the configuration file: */
+	writeCache(cacheFileName,cacheHeader,code);
+	
+	/* Execute the compiled configuration file: */
+	if(!code.empty())
+		execute(&code[0],code.size(),mergeFileName);
 	}
 
 void ConfigurationFileBase::mergeCommandline(int& argc,char**& argv)
@@ -24,9 +24,12 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef MISC_CONFIGURATIONFILE_INCLUDED
 #define MISC_CONFIGURATIONFILE_INCLUDED
 
+#include <string.h>
 #include <list>
+#include <vector>
 #include <stdexcept>
 #include <string>
+#include <Misc/HashTable.h>
 #include <Misc/ValueCoder.h>
 
 /* Forward declarations: */
@@ -77,7 +80,7 @@ class ConfigurationFileBase
 			public:
 			std::string tag;
 			std::string value; // Value encoded as std::string
-
+			
 			/* Constructors and destructors: */
 			TagValue(const std::string& sTag,const std::string& sValue) // Creates a std::string value
 				:tag(sTag),value(sValue)
@@ -85,22 +88,69 @@ class ConfigurationFileBase
 				}
 			};
 		
+		struct IndexKey // Structure identifying a named subsection or tag of a section
+			{
+			/* Elements: */
+			public:
+			const Section* section; // The section containing the subsection or tag
+			const char* name; // Name of the subsection or tag; points to the subsection's or tag/value pair's own name for keys stored in an index
+			size_t nameLength; // Length of the name
+			
+			/* Constructors and destructors: */
+			IndexKey(const Section* sSection,const std::string& sName)
+				:section(sSection),name(sName.data()),nameLength(sName.size())
+				{
+				}
+			
+			/* Methods: */
+			friend bool operator!=(const IndexKey& key1,const IndexKey& key2)
+				{
+				return key1.section!=key2.section||key1.nameLength!=key2.nameLength||memcmp(key1.name,key2.name,key1.nameLength)!=0;
+				}
+			static size_t hash(const IndexKey& source,size_t tableSize) // Hash function for index keys
+				{
+				size_t result=size_t(source.section)>>4;
+				for(size_t i=0;i<source.nameLength;++i)
+					result=result*37+size_t((unsigned char)source.name[i]);
+				return result%tableSize;
+				}
+			};
+		
+		typedef HashTable<IndexKey,Section*,IndexKey> SubsectionIndex; // Hash table mapping subsection names to subsections
+		typedef HashTable<IndexKey,std::list<TagValue>::iterator,IndexKey> TagIndex; // Hash table mapping tag names to tag/value pairs
+		
+		struct Index // Structure for name indices shared by all sections of a configuration file
+			{
+			/* Elements: */
+			public:
+			SubsectionIndex subsections; // Index of all subsections
+			TagIndex tags; // Index of all tag/value pairs
+			
+			/* Constructors and destructors: */
+			Index(void)
+				:subsections(401),tags(1999)
+				{
+				}
+			};
+		
 		/* Elements: */
 		Section* parent; // Pointer to parent section (null if root section)
 		std::string name; // Section name
 		Section* sibling; // Pointer to next section under common parent
 		Section* firstSubsection; // Pointer to first subsection
 		Section* lastSubsection; // Pointer to last subsection
-		std::list<TagValue> values; // List of values in this section
+		std::list<TagValue> values; // List of values in this section, in order of definition
+		Index* index; // Pointer to the name index shared with all other sections of the same configuration file; owned by the root section
 		bool edited; // Flag if the section has been changed since the last save
 		
 		/* Constructors and destructors: */
 		Section(Section* sParent,const std::string& sName); // Creates an empty section
-		template <class PipeParam>
-		Section(Section* sParent,PipeParam& pipe); // Reads a section and its subsections from a pipe
 		~Section(void);
 		
 		/* Methods: */
+		Section* findSubsection(const std::string& subsectionName) const; // Returns the subsection of the given name, or null if subsection does not exist
+		const TagValue* findTag(const std::string& tag) const; // Returns the tag/value pair of the given tag, or null if tag does not exist
+		void removeAll(void); // Removes all subsections and tag/value pairs from the section and the name index
 		void clear(void); // Removes all subsections and tag/value pairs from the section
 		Section* addSubsection(const std::string& subsectionName); // Adds a subsection to a section
 		void removeSubsection(const std::string& subsectionName); // Removes the given subsection from the section; does nothing if subsection does not exist
@@ -109,8 +159,7 @@ class ConfigurationFileBase
 		bool isEdited(void) const; // Checks if this section (or any of its subsections) has been edited since the last save
 		void clearEditFlag(void); // Clears edit flag for this section and all of its subsections
 		void save(File& file,int sectionLevel); // Writes all subsections and tag/value pairs to a file
-		template <class PipeParam>
-		void writeToPipe(PipeParam& pipe) const; // Writes a section and its subsections to a pipe
+		void compile(std::vector<char>& code) const; // Appends compiled commands re-creating all subsections and tag/value pairs to the given buffer
 		
 		/* Section navigation methods: */
 		std::string getPath(void) const; // Returns absolute path to this section
@@ -339,10 +388,21 @@ class ConfigurationFileBase
 			}
 		};
 	
+	protected:
+	class CommandExecutor; // Class applying configuration file commands to a section hierarchy
+	
 	/* Elements: */
 	protected:
 	std::string fileName; // File name of configuration file
 	Section* rootSection; // Pointer to root section of configuration file
+	std::string cacheDirectory; // Directory in which to cache compiled configuration files; caching is disabled if empty
+	
+	/* Protected methods: */
+	static void compileFile(const char* sourceFileName,std::vector<char>& code); // Compiles the given configuration file into the given buffer
+	void mergeText(const char* mergeFileName); // Merges the given configuration file by applying its commands directly while parsing it
+	void execute(const char* code,size_t codeSize,const char* sourceName); // Executes the given compiled commands, starting at the root section
+	bool mergeCached(const std::string& cacheFileName,const std::vector<char>& cacheHeader,const char* mergeFileName); // Merges the compiled form of the given configuration file from the given cache file; returns false without applying any commands if the cache file does not start with the given header or does not contain valid code
+	void writeCache(const std::string& cacheFileName,const std::vector<char>& cacheHeader,const std::vector<char>& code) const; // Writes the given header and compiled code to the given cache file; silently ignores errors
 	
 	/* Constructors and destructors: */
 	public:
@@ -362,7 +422,8 @@ class ConfigurationFileBase
 		{
 		load(fileName.c_str());
 		}
-	void merge(const char* mergeFileName); // Merges in contents of given configuration file
+	void setCacheDirectory(const char* newCacheDirectory); // Enables caching of compiled configuration files in the given directory, or disables caching if null or empty
+	void merge(const char* mergeFileName); // Merges in contents of given configuration file, using a cached compiled form if one is available and up-to-date
 	void mergeCommandline(int& argc,char**& argv); // Merges and removes "-tag value" pairs given on command line
 	void saveAs(const char* newFileName); // Saves the current in-memory state of the configuration file to the given file name
 	void save(void) // Saves the current in-memory state of the configuration file
@@ -0,0 +1,508 @@
+/***********************************************************************
+FlatHashTable - Class for storing and finding values (open addressing
+version using Robin Hood hashing). Offers the same interface as
+HashTable, but stores all entries in a single array to avoid following
+pointers during lookups.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Miscellaneous Support Library (Misc).
+
+The Miscellaneous Support Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Miscellaneous Support Library is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Miscellaneous Support Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef MISC_FLATHASHTABLE_INCLUDED
+#define MISC_FLATHASHTABLE_INCLUDED
+
+#include <string.h>
+#include <new>
+#include <Misc/HashTable.h>
+#include <Misc/StandardHashFunction.h>
+
+namespace Misc {
+
+/***********************************************************************
+Usage prerequisites:
+- classes Source and Dest must be copy-constructible and assignable,
+  and should be cheap to exchange using std::swap
+- class HashFunction must provide static size_t rawHash(const Source&
+  source); the table scrambles raw hash values itself, so they do not
+  need to be well-distributed in their low-order bits
+- To look up entries by a key of a different type FindSource using
+  findCompatibleEntry or isCompatibleEntry, class HashFunction must
+  provide static size_t rawHash(const FindSource&) returning the same
+  value as for the equivalent Source, and Source!=FindSource must be
+  defined
+Differences to HashTable:
+- Inserting an entry invalidates all iterators and entry references
+- Removing an entry invalidates all iterators and entry references
+- Table sizes are always powers of two
+***********************************************************************/
+
+template <class Source,class Dest,class HashFunction =StandardHashFunction<Source> >
+class FlatHashTable
+	{
+	/* Embedded classes: */
+	public:
+	typedef HashTableEntry<Source,Dest> Entry; // Type for hash table entries
+	typedef typename HashTable<Source,Dest,HashFunction>::EntryNotFoundError EntryNotFoundError; // Class for exceptions when requested hash table entry does not exist
+	
+	private:
+	typedef unsigned int Distance; // Type for an entry's distance from its home slot plus one, or zero for empty slots; wide enough that any number of equal raw hash values fits
+	
+	static const unsigned int longProbeDistance=64; // Probe distance beyond which a table that is at least half full grows regardless of its usage ratio
+	static const size_t minTableSize=8; // Smallest allowed table size
+	
+	public:
+	class Iterator
+		{
+		friend class FlatHashTable;
+		
+		/* Elements: */
+		private:
+		FlatHashTable* table; // Pointer to table this iterator is pointing into
+		size_t slotIndex; // Index of current table slot
+		
+		/* Constructors and destructors: */
+		public:
+		Iterator(void) // Creates invalid iterator
+			:table(0),slotIndex(0)
+			{
+			}
+		private:
+		Iterator(FlatHashTable* sTable,size_t sSlotIndex) // Creates iterator to the first entry at or after the given slot
+			:table(sTable),slotIndex(sSlotIndex)
+			{
+			while(slotIndex<table->tableSize&&table->distances[slotIndex]==0)
+				++slotIndex;
+			}
+		
+		/* Methods: */
+		public:
+		bool isFinished(void) const
+			{
+			return slotIndex>=table->tableSize;
+			}
+		friend bool operator==(const Iterator& it1,const Iterator& it2)
+			{
+			return it1.slotIndex==it2.slotIndex;
+			}
+		friend bool operator!=(const Iterator& it1,const Iterator& it2)
+			{
+			return it1.slotIndex!=it2.slotIndex;
+			}
+		Entry& operator*(void) const
+			{
+			return table->entries[slotIndex];
+			}
+		Entry* operator->(void) const
+			{
+			return table->entries+slotIndex;
+			}
+		Iterator& operator++(void)
+			{
+			/* Go to the next used slot: */
+			do
+				{
+				++slotIndex;
+				}
+			while(slotIndex<table->tableSize&&table->distances[slotIndex]==0);
+			return *this;
+			}
+		};
+	
+	class ConstIterator
+		{
+		friend class FlatHashTable;
+		
+		/* Elements: */
+		private:
+		const FlatHashTable* table; // Pointer to table this iterator is pointing into
+		size_t slotIndex; // Index of current table slot
+		
+		/* Constructors and destructors: */
+		public:
+		ConstIterator(void) // Creates invalid iterator
+			:table(0),slotIndex(0)
+			{
+			}
+		private:
+		ConstIterator(const FlatHashTable* sTable,size_t sSlotIndex) // Creates iterator to the first entry at or after the given slot
+			:table(sTable),slotIndex(sSlotIndex)
+			{
+			while(slotIndex<table->tableSize&&table->distances[slotIndex]==0)
+				++slotIndex;
+			}
+		
+		/* Methods: */
+		public:
+		bool isFinished(void) const
+			{
+			return slotIndex>=table->tableSize;
+			}
+		friend bool operator==(const ConstIterator& it1,const ConstIterator& it2)
+			{
+			return it1.slotIndex==it2.slotIndex;
+			}
+		friend bool operator!=(const ConstIterator& it1,const ConstIterator& it2)
+			{
+			return it1.slotIndex!=it2.slotIndex;
+			}
+		const Entry& operator*(void) const
+			{
+			return table->entries[slotIndex];
+			}
+		const Entry* operator->(void) const
+			{
+			return table->entries+slotIndex;
+			}
+		ConstIterator& operator++(void)
+			{
+			/* Go to the next used slot: */
+			do
+				{
+				++slotIndex;
+				}
+			while(slotIndex<table->tableSize&&table->distances[slotIndex]==0);
+			return *this;
+			}
+		};
+	
+	friend class Iterator;
+	friend class ConstIterator;
+	
+	/* Elements: */
+	private:
+	size_t tableSize; // Current table size; always a power of two
+	size_t tableMask; // Bit mask to wrap slot indices around the end of the table
+	unsigned int hashShift; // Number of bits to shift scrambled hash values to get slot indices
+	float waterMark; // Maximum table usage ratio
+	float growRate; // Rate the table grows at
+	Distance* distances; // Array of probe distances of all table slots
+	Entry* entries; // Array of uninitialized storage for table entries; only slots with non-zero distance contain constructed entries
+	size_t usedEntries; // Number of entries currently used
+	size_t maxEntries; // Maximum number of entries at current table size
+	
+	/* Private methods: */
+	static size_t roundTableSize(size_t newTableSize) // Returns the smallest allowed table size not smaller than the given size
+		{
+		size_t result=minTableSize;
+		while(result<newTableSize)
+			result<<=1;
+		return result;
+		}
+	template <class FindSource>
+	size_t getHomeSlot(const FindSource& findSource) const // Returns the index of the preferred slot for the given source
+		{
+		/* Scramble the source's raw hash value by Fibonacci hashing and use its high-order bits: */
+		const size_t multiplier=sizeof(size_t)>4?size_t(0x9e3779b97f4a7c15ULL):size_t(0x9e3779b9U);
+		return (HashFunction::rawHash(findSource)*multiplier)>>hashShift;
+		}
+	void allocateTable(size_t newTableSize) // Allocates empty arrays for the given table size without deleting current entries
+		{
+		tableSize=newTableSize;
+		tableMask=tableSize-1;
+		hashShift=sizeof(size_t)*8;
+		for(size_t s=tableSize;s>1;s>>=1)
+			--hashShift;
+		distances=new Distance[tableSize];
+		memset(distances,0,tableSize*sizeof(Distance));
+		entries=static_cast<Entry*>(::operator new(tableSize*sizeof(Entry)));
+		maxEntries=(size_t)(tableSize*waterMark);
+		if(maxEntries>=tableSize)
+			maxEntries=tableSize-1;
+		}
+	void destroyEntries(void) // Destroys all used table entries
+		{
+		for(size_t i=0;i<tableSize;++i)
+			if(distances[i]!=0)
+				{
+				entries[i].~Entry();
+				distances[i]=0;
+				}
+		}
+	void growTable(size_t newTableSize) // Grows the table without deleting current entries
+		{
+		/* Remember the current table: */
+		size_t oldTableSize=tableSize;
+		Distance* oldDistances=distances;
+		Entry* oldEntries=entries;
+		
+		/* Allocate the new table: */
+		newTableSize=roundTableSize(newTableSize);
+		while(usedEntries>(size_t)(newTableSize*waterMark))
+			newTableSize<<=1;
+		allocateTable(newTableSize);
+		
+		/* Move all entries to the new table: */
+		for(size_t i=0;i<oldTableSize;++i)
+			if(oldDistances[i]!=0)
+				{
+				insertNewEntry(oldEntries[i],getHomeSlot(oldEntries[i].getSource()));
+				oldEntries[i].~Entry();
+				}
+		
+		/* Delete the old table: */
+		delete[] oldDistances;
+		::operator delete(oldEntries);
+		}
+	template <class FindSource>
+	size_t findSlot(const FindSource& findSource,size_t index) const // Returns the index of the slot containing the given source with the given home slot, or tableSize if the source is not in the table
+		{
+		/* Probe slots starting from the source's home slot until an entry closer to its own home slot is found: */
+		for(unsigned int distance=1;distances[index]>=distance;++distance,index=(index+1)&tableMask)
+			{
+			/* Only entries at the same distance from their home slots share the source's home slot: */
+			if(distances[index]==distance&&!(entries[index].getSource()!=findSource))
+				return index;
+			}
+		
+		return tableSize;
+		}
+	template <class FindSource>
+	size_t findSlot(const FindSource& findSource) const // Ditto, calculating the source's home slot
+		{
+		return findSlot(findSource,getHomeSlot(findSource));
+		}
+	size_t insertNewEntry(const Entry& newEntry,size_t homeIndex) // Inserts an entry with the given home slot whose source is not yet in the table; returns the index of the entry's slot
+		{
+		/* Find the first slot whose entry is closer to its home slot than the new entry would be: */
+		size_t insertIndex=homeIndex;
+		unsigned int distance=1;
+		while(distances[insertIndex]>=distance)
+			{
+			insertIndex=(insertIndex+1)&tableMask;
+			++distance;
+			}
+		
+		/* Find the first empty slot at or after the insertion slot, and the longest probe distance after shifting the entries in between: */
+		size_t emptyIndex=insertIndex;
+		unsigned int maxProbeDistance=distance;
+		while(distances[emptyIndex]!=0)
+			{
+			if(maxProbeDistance<distances[emptyIndex]+1)
+				maxProbeDistance=distances[emptyIndex]+1;
+			emptyIndex=(emptyIndex+1)&tableMask;
+			}
+		
+		/* Grow the table to shorten long probe sequences and try again, unless the table is mostly empty, in which case long probe sequences are caused by equal raw hash values that growing cannot separate: */
+		if(maxProbeDistance>longProbeDistance&&usedEntries*2>=maxEntries)
+			{
+			growTable(tableSize*2);
+			return insertNewEntry(newEntry,getHomeSlot(newEntry.getSource()));
+			}
+		
+		/* Store the new entry in the empty slot and swap it down to the insertion slot, shifting all entries in between up by one: */
+		new(entries+emptyIndex) Entry(newEntry);
+		for(size_t index=emptyIndex;index!=insertIndex;)
+			{
+			size_t predIndex=(index-1)&tableMask;
+			entries[index].swap(entries[predIndex]);
+			distances[index]=distances[predIndex]+1;
+			index=predIndex;
+			}
+		distances[insertIndex]=Distance(distance);
+		
+		return insertIndex;
+		}
+	void removeSlot(size_t index) // Removes the entry in the given slot
+		{
+		/* Swap the removed entry past all following entries that are not in their home slots, shifting those down by one: */
+		size_t succIndex=(index+1)&tableMask;
+		while(distances[succIndex]>1)
+			{
+			entries[index].swap(entries[succIndex]);
+			distances[index]=distances[succIndex]-1;
+			index=succIndex;
+			succIndex=(succIndex+1)&tableMask;
+			}
+		
+		/* Destroy the removed entry: */
+		entries[index].~Entry();
+		distances[index]=0;
+		--usedEntries;
+		}
+	size_t insertSlot(const Entry& newEntry,size_t homeIndex) // Inserts an entry with the given home slot whose source is not yet in the table, growing the table if necessary; returns the index of the entry's slot
+		{
+		/* Grow hash table if necessary: */
+		if(usedEntries>=maxEntries)
+			{
+			growTable((size_t)(tableSize*growRate)+1);
+			homeIndex=getHomeSlot(newEntry.getSource());
+			}
+		
+		size_t result=insertNewEntry(newEntry,homeIndex);
+		++usedEntries;
+		return result;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	FlatHashTable(size_t sTableSize,float sWaterMark =0.8f,float sGrowRate =2.0f) // Creates an empty table; table size is rounded up to the next power of two
+		:waterMark(sWaterMark),growRate(sGrowRate),
+		 usedEntries(0)
+		{
+		allocateTable(roundTableSize(sTableSize));
+		}
+	private:
+	FlatHashTable(const FlatHashTable& source); // Prohibit copy constructor
+	FlatHashTable& operator=(const FlatHashTable& source); // Prohibit assignment operator
+	public:
+	~FlatHashTable(void)
+		{
+		/* Destroy all used hash table entries: */
+		destroyEntries();
+		
+		/* Delete the table: */
+		delete[] distances;
+		::operator delete(entries);
+		}
+	
+	/* Methods: */
+	void setTableSize(size_t newTableSize) // Changes the table size; table will not shrink below the size required to hold its current entries
+		{
+		growTable(newTableSize);
+		}
+	void clear(void)
+		{
+		/* Destroy all used hash table entries: */
+		destroyEntries();
+		
+		usedEntries=0;
+		}
+	size_t getNumEntries(void) const // Returns the number of entries currently in the hash table
+		{
+		return usedEntries;
+		}
+	bool setEntry(const Entry& newEntry)
+		{
+		/* Find the entry's slot: */
+		size_t homeIndex=getHomeSlot(newEntry.getSource());
+		size_t index=findSlot(newEntry.getSource(),homeIndex);
+		
+		if(index<tableSize)
+			{
+			/* Set value of existing entry: */
+			entries[index]=newEntry;
+			}
+		else
+			{
+			/* Insert new entry: */
+			insertSlot(newEntry,homeIndex);
+			}
+		
+		return index<tableSize;
+		}
+	void removeEntry(const Source& findSource) // Removes entry
+		{
+		/* Find the entry's slot: */
+		size_t index=findSlot(findSource);
+		
+		if(index<tableSize)
+			removeSlot(index);
+		}
+	bool isEntry(const Source& findSource) const
+		{
+		return findSlot(findSource)<tableSize;
+		}
+	bool isEntry(const Entry& entry) const // Wrapper for isEntry function
+		{
+		return findSlot(entry.getSource())<tableSize;
+		}
+	template <class FindSource>
+	bool isCompatibleEntry(const FindSource& findSource) const // Ditto, with a source of a different type that can be compared to the table's source type
+		{
+		return findSlot(findSource)<tableSize;
+		}
+	const Entry& getEntry(const Source& findSource) const // Returns reference to entry; throws exception if entry is not found
+		{
+		/* Find the entry's slot: */
+		size_t index=findSlot(findSource);
+		
+		/* Throw an exception if the requested entry does not exist: */
+		if(index>=tableSize)
+			throw EntryNotFoundError(findSource);
+		
+		return entries[index];
+		}
+	Entry& getEntry(const Source& findSource) // Ditto
+		{
+		/* Find the entry's slot: */
+		size_t index=findSlot(findSource);
+		
+		/* Throw an exception if the requested entry does not exist: */
+		if(index>=tableSize)
+			throw EntryNotFoundError(findSource);
+		
+		return entries[index];
+		}
+	Entry& operator[](const Source& source) // Returns reference to entry; inserts new entry if source is not found
+		{
+		/* Find the entry's slot: */
+		size_t homeIndex=getHomeSlot(source);
+		size_t index=findSlot(source,homeIndex);
+		
+		if(index>=tableSize)
+			{
+			/* Insert new entry with default destination: */
+			index=insertSlot(Entry(source),homeIndex);
+			}
+		
+		return entries[index];
+		}
+	Iterator begin(void)
+		{
+		return Iterator(this,0); // Create iterator to first entry
+		}
+	ConstIterator begin(void) const
+		{
+		return ConstIterator(this,0); // Create iterator to first entry
+		}
+	Iterator end(void)
+		{
+		return Iterator(this,tableSize); // Create iterator past end of table
+		}
+	ConstIterator end(void) const
+		{
+		return ConstIterator(this,tableSize); // Create iterator past end of table
+		}
+	Iterator findEntry(const Source& findSource)
+		{
+		return Iterator(this,findSlot(findSource)); // Returns valid iterator or end iterator
+		}
+	ConstIterator findEntry(const Source& findSource) const
+		{
+		return ConstIterator(this,findSlot(findSource)); // Returns valid iterator or end iterator
+		}
+	template <class FindSource>
+	Iterator findCompatibleEntry(const FindSource& findSource) // Ditto, with a source of a different type that can be compared to the table's source type
+		{
+		return Iterator(this,findSlot(findSource));
+		}
+	template <class FindSource>
+	ConstIterator findCompatibleEntry(const FindSource& findSource) const // Ditto
+		{
+		return ConstIterator(this,findSlot(findSource));
+		}
+	void removeEntry(const Iterator& it) // Removes entry pointed to by iterator
+		{
+		if(it.table==this&&it.slotIndex<tableSize&&distances[it.slotIndex]!=0)
+			removeSlot(it.slotIndex);
+		}
+	};
+
+}
+
+#endif
@@ -25,6 +25,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <new>
 #include <stdexcept>
+#include <algorithm>
 #include <Misc/PoolAllocator.h>
 #include <Misc/StandardHashFunction.h>
 
@@ -67,6 +68,11 @@ class HashTableEntry
 		dest=newDest;
 		return *this;
 		}
+	void swap(HashTableEntry& other) // Exchanges the contents of this entry with the given entry
+		{
+		std::swap(source,other.source);
+		std::swap(dest,other.dest);
+		}
 	};
 
 template <class Source>
@@ -88,6 +94,10 @@ class HashTableEntry<Source,void> // Specialized hash table entry with no value
 		{
 		return source;
 		}
+	void swap(HashTableEntry& other) // Exchanges the contents of this entry with the given entry
+		{
+		std::swap(source,other.source);
+		}
 	};
 
 /***********************************************************************
@@ -39,14 +39,21 @@ class StandardHashFunction<std::string>
 	{
 	/* Static methods: */
 	public:
-	static size_t rawHash(std::string source)
+	static size_t rawHash(const std::string& source)
 		{
 		size_t result=0;
 		for(std::string::const_iterator sIt=source.begin();sIt!=source.end();++sIt)
 			result=result*37+size_t(*sIt);
 		return result;
 		}
-	static size_t hash(std::string source,size_t tableSize)
+	static size_t rawHash(const char* source) // Returns the same hash value as for an equivalent std::string, to look up strings without creating temporary std::string objects
+		{
+		size_t result=0;
+		for(const char* sPtr=source;*sPtr!='\0';++sPtr)
+			result=result*37+size_t(*sPtr);
+		return result;
+		}
+	static size_t hash(const std::string& source,size_t tableSize)
 		{
 		return rawHash(source)%tableSize;
 		}
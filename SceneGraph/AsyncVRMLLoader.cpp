@@ -0,0 +1,179 @@
+/***********************************************************************
+AsyncVRMLLoader - Class to load VRML files and their external resources
+in a background thread, and graft the loaded scene graphs into a live
+scene graph at frame boundaries.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/AsyncVRMLLoader.h>
+
+#include <stdexcept>
+#include <Cluster/MulticastPipe.h>
+#include <Cluster/OpenFile.h>
+#include <SceneGraph/VRMLFile.h>
+
+namespace SceneGraph {
+
+/********************************
+Methods of class AsyncVRMLLoader:
+********************************/
+
+void* AsyncVRMLLoader::loaderThreadMethod(void)
+	{
+	while(true)
+		{
+		/* Wait for the next request: */
+		Request* request;
+		{
+		Threads::MutexCond::Lock requestLock(requestCond);
+		while(!shutdown&&numLoadingRequests==requests.size())
+			requestCond.wait(requestLock);
+		
+		/* In a cluster, all nodes must open the same sequence of files, so pending requests are only abandoned on a single node: */
+		if(shutdown&&(pipe==0||numLoadingRequests==requests.size()))
+			break;
+		
+		request=requests[numLoadingRequests];
+		++numLoadingRequests;
+		}
+		
+		/* Load the VRML file and its external resources into a new root node: */
+		try
+			{
+			GroupNodePointer root=new GroupNode;
+			VRMLFile vrmlFile(request->url,Cluster::openFile(multiplexer,request->url.c_str()),nodeCreator,multiplexer);
+			vrmlFile.parse(root);
+			request->loadedRoot=root;
+			}
+		catch(const std::exception& err)
+			{
+			/* Mark the request as failed: */
+			request->failed=true;
+			request->errorMessage=err.what();
+			}
+		catch(...)
+			{
+			/* Mark the request as failed; the loader thread must not die with requests pending: */
+			request->failed=true;
+			request->errorMessage="Unknown exception";
+			}
+		
+		/* Mark the request as completed: */
+		{
+		Threads::MutexCond::Lock requestLock(requestCond);
+		++numCompletedRequests;
+		}
+		}
+	
+	return 0;
+	}
+
+AsyncVRMLLoader::AsyncVRMLLoader(NodeCreator& sNodeCreator,Cluster::Multiplexer* sMultiplexer)
+	:nodeCreator(sNodeCreator),multiplexer(sMultiplexer),
+	 pipe(multiplexer!=0?new Cluster::MulticastPipe(multiplexer):0),
+	 numLoadingRequests(0),numCompletedRequests(0),
+	 shutdown(false)
+	{
+	/* Start the loader thread; it receives the same thread ID on all cluster nodes, which keeps the file pipes it opens matched: */
+	loaderThread.start(this,&AsyncVRMLLoader::loaderThreadMethod);
+	}
+
+AsyncVRMLLoader::~AsyncVRMLLoader(void)
+	{
+	/* Shut down the loader thread: */
+	{
+	Threads::MutexCond::Lock requestLock(requestCond);
+	shutdown=true;
+	requestCond.signal();
+	}
+	loaderThread.join();
+	
+	/* Delete all pending requests: */
+	for(std::deque<Request*>::iterator rIt=requests.begin();rIt!=requests.end();++rIt)
+		delete *rIt;
+	delete pipe;
+	}
+
+GroupNodePointer AsyncVRMLLoader::load(const std::string& url,GraphNodePointer placeholderContent)
+	{
+	/* Create the placeholder node: */
+	GroupNodePointer placeholder=new GroupNode;
+	if(placeholderContent!=0)
+		{
+		placeholder->children.appendValue(placeholderContent);
+		placeholder->update();
+		}
+	
+	/* Queue a new request and wake up the loader thread: */
+	{
+	Threads::MutexCond::Lock requestLock(requestCond);
+	requests.push_back(new Request(url,placeholder));
+	requestCond.signal();
+	}
+	
+	return placeholder;
+	}
+
+bool AsyncVRMLLoader::update(void)
+	{
+	if(requests.empty())
+		return false;
+	
+	/* Get the number of completed requests: */
+	unsigned int numGraftableRequests;
+	{
+	Threads::MutexCond::Lock requestLock(requestCond);
+	numGraftableRequests=numCompletedRequests;
+	}
+	
+	/* Graft only requests that have been completed on all cluster nodes: */
+	if(pipe!=0)
+		numGraftableRequests=pipe->gather(numGraftableRequests,Cluster::GatherOperation::MIN);
+	
+	/* Graft all graftable requests in order of submission: */
+	for(unsigned int i=0;i<numGraftableRequests;++i)
+		{
+		/* Remove the request from the queue: */
+		Request* request;
+		{
+		Threads::MutexCond::Lock requestLock(requestCond);
+		request=requests.front();
+		requests.pop_front();
+		--numLoadingRequests;
+		--numCompletedRequests;
+		}
+		
+		if(!request->failed)
+			{
+			/* Replace the placeholder's contents with the loaded scene graph: */
+			request->placeholder->children.getValues().swap(request->loadedRoot->children.getValues());
+			request->placeholder->update();
+			}
+		
+		/* Call the load callbacks: */
+		LoadCallbackData cbData(request->placeholder,request->url,request->failed,request->errorMessage,requests.size());
+		loadCallbacks.call(&cbData);
+		
+		delete request;
+		}
+	
+	return numGraftableRequests>0;
+	}
+
+}
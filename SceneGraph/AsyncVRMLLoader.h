@@ -0,0 +1,128 @@
+/***********************************************************************
+AsyncVRMLLoader - Class to load VRML files and their external resources
+in a background thread, and graft the loaded scene graphs into a live
+scene graph at frame boundaries.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_ASYNCVRMLLOADER_INCLUDED
+#define SCENEGRAPH_ASYNCVRMLLOADER_INCLUDED
+
+#include <string>
+#include <deque>
+#include <Misc/CallbackData.h>
+#include <Misc/CallbackList.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+#include <SceneGraph/GraphNode.h>
+#include <SceneGraph/GroupNode.h>
+
+/* Forward declarations: */
+namespace Cluster {
+class Multiplexer;
+class MulticastPipe;
+}
+namespace SceneGraph {
+class NodeCreator;
+}
+
+namespace SceneGraph {
+
+class AsyncVRMLLoader
+	{
+	/* Embedded classes: */
+	public:
+	class LoadCallbackData:public Misc::CallbackData // Callback data sent when a VRML file has been grafted into the scene graph, or failed to load
+		{
+		/* Elements: */
+		public:
+		GroupNodePointer placeholder; // The placeholder node that received the loaded scene graph
+		const std::string& url; // URL of the loaded VRML file
+		bool failed; // Flag whether loading the VRML file failed; placeholder contents remain unchanged in that case
+		const std::string& errorMessage; // Error message if loading failed
+		unsigned int numPendingRequests; // Number of load requests still pending after this one
+		
+		/* Constructors and destructors: */
+		LoadCallbackData(GroupNodePointer sPlaceholder,const std::string& sUrl,bool sFailed,const std::string& sErrorMessage,unsigned int sNumPendingRequests)
+			:placeholder(sPlaceholder),url(sUrl),
+			 failed(sFailed),errorMessage(sErrorMessage),
+			 numPendingRequests(sNumPendingRequests)
+			{
+			}
+		};
+	
+	private:
+	struct Request // Structure describing a pending load request
+		{
+		/* Elements: */
+		public:
+		std::string url; // URL of the VRML file to load
+		GroupNodePointer placeholder; // Node in the live scene graph that will receive the loaded scene graph
+		GroupNodePointer loadedRoot; // Root of the scene graph loaded by the background thread
+		bool failed; // Flag whether loading failed
+		std::string errorMessage; // Error message if loading failed
+		
+		/* Constructors and destructors: */
+		Request(const std::string& sUrl,GroupNodePointer sPlaceholder)
+			:url(sUrl),placeholder(sPlaceholder),
+			 failed(false)
+			{
+			}
+		};
+	
+	/* Elements: */
+	NodeCreator& nodeCreator; // Node creator used to parse VRML files
+	Cluster::Multiplexer* multiplexer; // Pointer to a multicast pipe multiplexer when loading VRML files in a cluster environment
+	Cluster::MulticastPipe* pipe; // Pipe to agree on the number of completed requests between all cluster nodes, or null
+	Threads::MutexCond requestCond; // Condition variable to signal new requests to the loader thread; protects the request queue
+	std::deque<Request*> requests; // Queue of requests that have not been grafted yet, in order of submission
+	unsigned int numLoadingRequests; // Number of requests at the front of the queue that have been started by the loader thread
+	unsigned int numCompletedRequests; // Number of requests at the front of the queue that have been completed by the loader thread
+	bool shutdown; // Flag to shut down the loader thread
+	Threads::Thread loaderThread; // Background thread loading VRML files
+	Misc::CallbackList loadCallbacks; // List of callbacks called when a load request has been grafted into the scene graph
+	
+	/* Private methods: */
+	void* loaderThreadMethod(void); // Thread method loading VRML files in order of submission
+	
+	/* Constructors and destructors: */
+	public:
+	AsyncVRMLLoader(NodeCreator& sNodeCreator,Cluster::Multiplexer* sMultiplexer =0); // Creates a loader for the given node creator; must be created in the same order on all cluster nodes if a multiplexer is given
+	private:
+	AsyncVRMLLoader(const AsyncVRMLLoader& source); // Prohibit copy constructor
+	AsyncVRMLLoader& operator=(const AsyncVRMLLoader& source); // Prohibit assignment operator
+	public:
+	~AsyncVRMLLoader(void); // Cancels all pending requests and waits for the VRML file currently being loaded; in a cluster, finishes loading all pending requests to keep the nodes' file pipes matched
+	
+	/* Methods: */
+	GroupNodePointer load(const std::string& url,GraphNodePointer placeholderContent =GraphNodePointer()); // Requests loading the given VRML file; returns a placeholder group node to be inserted into the live scene graph, which shows the given optional content until the VRML file is grafted
+	unsigned int getNumPendingRequests(void) const // Returns the number of requests that have not been grafted yet
+		{
+		return requests.size();
+		}
+	Misc::CallbackList& getLoadCallbacks(void) // Returns the list of load callbacks
+		{
+		return loadCallbacks;
+		}
+	bool update(void); // Grafts all completed requests into their placeholders and calls load callbacks; must be called from the thread that created the loader, at the same frame boundary on all cluster nodes; returns true if any placeholders were changed
+	};
+
+}
+
+#endif
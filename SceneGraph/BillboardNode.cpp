@@ -91,6 +91,29 @@ void BillboardNode::update(void)
 		orthoZAxis.normalize();
 		rotationNormal=axisOfRotation.getValue()^orthoZAxis;
 		}
+	
+	/* Recalculate the cached bounding box from the current children: */
+	trackChildBoundingBoxes(children.getValues());
+	updateBoundingBox();
+	}
+
+Box BillboardNode::calcBoundingBox(void) const
+	{
+	/* Get the children's bounding box in the billboard's local coordinate system: */
+	Box localBox=GroupNode::calcBoundingBox();
+	if(localBox.isNull())
+		return localBox;
+	
+	/* Return a box enclosing the local box under all rotations around the origin: */
+	Scalar maxDist2(0);
+	for(int i=0;i<8;++i)
+		{
+		Scalar dist2=Geometry::sqrDist(localBox.getVertex(i),Point::origin);
+		if(maxDist2<dist2)
+			maxDist2=dist2;
+		}
+	Scalar maxDist=Math::sqrt(maxDist2);
+	return Box(Point(-maxDist,-maxDist,-maxDist),Point(maxDist,maxDist,maxDist));
 	}
 
 void BillboardNode::glRenderAction(GLRenderState& renderState) const
@@ -131,10 +154,9 @@ void BillboardNode::glRenderAction(GLRenderState& renderState) const
 		previousTransform=renderState.pushTransform(transform);
 		}
 	
-	/* Call the render actions of all children in order: */
-	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-		(*chIt)->glRenderAction(renderState);
-		
+	/* Call the render actions of all visible children in order: */
+	renderChildren(renderState);
+	
 	/* Pop the transformation off the matrix stack: */
 	renderState.popTransform(previousTransform);
 	}
@@ -173,6 +173,9 @@ void BoxNode::update(void)
 	
 	/* Invalidate the display list: */
 	DisplayList::update();
+	
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
 	}
 
 Box BoxNode::calcBoundingBox(void) const
@@ -178,6 +178,9 @@ void ConeNode::update(void)
 	{
 	/* Invalidate the display list: */
 	DisplayList::update();
+	
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
 	}
 
 Box ConeNode::calcBoundingBox(void) const
@@ -152,12 +152,15 @@ void CurveSetNode::update(void)
 	if(pointTransform.getValue()!=0)
 		{
 		/* Transform all curve vertices: */
-		for(std::vector<Point>::iterator vIt=vertices.begin();vIt!=vertices.end();++vIt)
-			*vIt=pointTransform.getValue()->transformPoint(*vIt);
+		if(!vertices.empty())
+			pointTransform.getValue()->transformPoints(&vertices[0],vertices.size());
 		}
 	
 	/* Bump up the indexed line set's version number: */
 	++version;
+	
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
 	}
 
 Box CurveSetNode::calcBoundingBox(void) const
@@ -172,6 +172,9 @@ void CylinderNode::update(void)
 	{
 	/* Invalidate the display list: */
 	DisplayList::update();
+	
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
 	}
 
 Box CylinderNode::calcBoundingBox(void) const
@@ -87,6 +87,9 @@ void Doom3MD5MeshNode::update(void)
 		delete mesh;
 		mesh=0;
 		}
+	
+	/* Recalculate the cached bounding box: */
+	updateBoundingBox();
 	}
 
 Box Doom3MD5MeshNode::calcBoundingBox(void) const
@@ -97,6 +97,9 @@ void Doom3ModelNode::update(void)
 		delete mesh;
 		mesh=0;
 		}
+	
+	/* Recalculate the cached bounding box: */
+	updateBoundingBox();
 	}
 
 Box Doom3ModelNode::calcBoundingBox(void) const
@@ -84,6 +84,21 @@ struct GeographicProjection // Structure for geographic map projections
 		/* Convert the point to Cartesian: */
 		return geoid.geodeticToCartesian(geodetic);
 		}
+	void toCartesian(Geometry::Point<double,3>* points,int numPoints) const // Transforms an array of points in geographic coordinates to Cartesian coordinates in-place
+		{
+		/* Assemble the source points' proper geodetic coordinates: */
+		int lngIndex=longitudeFirst?0:1;
+		for(int i=0;i<numPoints;++i)
+			{
+			double lng=points[i][lngIndex];
+			double lat=points[i][1-lngIndex];
+			points[i][0]=lng*longitudeFactor+primeMeridianOffset;
+			points[i][1]=lat*latitudeFactor;
+			}
+		
+		/* Convert the points to Cartesian: */
+		geoid.geodeticToCartesian(points,points,numPoints);
+		}
 	};
 
 class MapProjection // Base class for map projections
@@ -108,6 +123,11 @@ class MapProjection // Base class for map projections
 		/* Pass the point directly to the geodetic projection: */
 		return geoProjection.toCartesian(x,y,z);
 		}
+	virtual void toCartesian(Geometry::Point<double,3>* points,int numPoints) const // Transforms an array of points in projected coordinates to Cartesian coordinates in-place
+		{
+		/* Pass the points directly to the geodetic projection: */
+		geoProjection.toCartesian(points,numPoints);
+		}
 	};
 
 class AlbersProjection:public MapProjection // Class for Albers equal-area conic projection
@@ -132,6 +152,10 @@ class AlbersProjection:public MapProjection // Class for Albers equal-area conic
 		{
 		return projection.mapToCartesian(Geometry::AlbersEqualAreaProjection<double>::Point(x,y,z));
 		}
+	virtual void toCartesian(Geometry::Point<double,3>* points,int numPoints) const
+		{
+		projection.mapToCartesian(points,points,numPoints);
+		}
 	
 	/* New methods: */
 	void update(void) // Updates derived projection coefficients
@@ -697,17 +721,13 @@ void readPointArray(IO::File& shapeFile,int numPoints,bool readZ,bool readM,cons
 		shapeFile.skip<double>(numPoints);
 		}
 	
-	/* Store all points in the point set: */
+	/* Transform all points to Cartesian coordinates: */
 	if(projection!=0)
-		{
-		for(int i=0;i<numPoints;++i)
-			coord->point.appendValue(projection->toCartesian(ps[i][0],ps[i][1],ps[i][2]));
-		}
-	else
-		{
-		for(int i=0;i<numPoints;++i)
-			coord->point.appendValue(ps[i]);
-		}
+		projection->toCartesian(ps,numPoints);
+	
+	/* Store all points in the point set: */
+	for(int i=0;i<numPoints;++i)
+		coord->point.appendValue(ps[i]);
 	
 	delete[] ps;
 	}
@@ -1144,7 +1164,7 @@ void ESRIShapeFileNode::update(void)
 							/* Add indices for vertices in this polygon: */
 							for(int j=partStartIndices[i];j<partStartIndices[i+1];++j)
 								polylines->coordIndex.appendValue(j+polylinesIndexBase);
-
+							
 							/* Terminate the polyline: */
 							polylines->coordIndex.appendValue(-1);
 							break;
@@ -1171,7 +1191,7 @@ void ESRIShapeFileNode::update(void)
 				break;
 				}
 			}
-				
+		
 		if(haveLabels&&recordNumPoints>0)
 			{
 			/* Create a label for the record: */
@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <string.h>
 #include <Math/Constants.h>
+#include <Threads/ParallelFor.h>
 #include <GL/gl.h>
 #include <GL/GLColorTemplates.h>
 #include <GL/GLContextData.h>
@@ -37,6 +38,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/GLRenderState.h>
 
 #include <SceneGraph/Internal/LoadElevationGrid.h>
+#include <SceneGraph/Internal/TiledElevationGrid.h>
 
 namespace SceneGraph {
 
@@ -73,50 +75,142 @@ ElevationGridNode::DataItem::~DataItem(void)
 		glDeleteBuffersARB(1,&indexBufferObjectId);
 	}
 
-/**********************************
-Methods of class ElevationGridNode:
-**********************************/
+/****************************************************************
+Helper classes to calculate grid vertices and normals in parallel:
+****************************************************************/
 
-Point* ElevationGridNode::calcVertices(void) const
+namespace {
+
+inline int calcGridRowGrainSize(int xDim) // Returns the number of grid rows processed by a single parallel task
 	{
-	/* Allocate the result array: */
-	int xDim=xDimension.getValue();
-	int zDim=zDimension.getValue();
-	Point* vertices=new Point[zDim*xDim];
+	/* Process at least 16K grid vertices per task to amortize task overhead: */
+	int result=16384/(xDim>0?xDim:1);
+	return result>1?result:1;
+	}
+
+class VertexRowCalculator // Functor to calculate the vertex positions of a range of grid rows
+	{
+	/* Elements: */
+	private:
+	Point* vertices; // Vertex array
+	const Scalar* heights; // Height value array
+	int xDim; // Number of vertices per grid row
+	Point origin; // Position of the first grid vertex
+	Scalar xSp,zSp; // Grid vertex spacing
+	Scalar heightScale; // Scale factor for height values
+	bool heightIsY; // Flag whether height values are stored in the vertices' y or z components
 	
-	/* Calculate all vertex positions: */
-	Scalar xSp=xSpacing.getValue();
-	Scalar zSp=zSpacing.getValue();
-	Point* vPtr=vertices;
-	const Scalar* hPtr=&height.getValue(0);
-	if(heightIsY.getValue())
+	/* Constructors and destructors: */
+	public:
+	VertexRowCalculator(Point* sVertices,const Scalar* sHeights,int sXDim,const Point& sOrigin,Scalar sXSp,Scalar sZSp,Scalar sHeightScale,bool sHeightIsY)
+		:vertices(sVertices),heights(sHeights),xDim(sXDim),
+		 origin(sOrigin),xSp(sXSp),zSp(sZSp),heightScale(sHeightScale),
+		 heightIsY(sHeightIsY)
+		{
+		}
+	
+	/* Methods: */
+	void operator()(int zBegin,int zEnd) const
 		{
-		Point p;
-		p[2]=origin.getValue()[2];
-		for(int z=0;z<zDim;++z,p[2]+=zSp)
+		Point* vPtr=vertices+zBegin*xDim;
+		const Scalar* hPtr=heights+zBegin*xDim;
+		if(heightIsY)
 			{
-			p[0]=origin.getValue()[0];
-			for(int x=0;x<xDim;++x,++vPtr,++hPtr,p[0]+=xSp)
+			Point p;
+			p[2]=origin[2]+Scalar(zBegin)*zSp;
+			for(int z=zBegin;z<zEnd;++z,p[2]+=zSp)
 				{
-				p[1]=origin.getValue()[1]+*hPtr*heightScale.getValue();
-				*vPtr=p;
+				p[0]=origin[0];
+				for(int x=0;x<xDim;++x,++vPtr,++hPtr,p[0]+=xSp)
+					{
+					p[1]=origin[1]+*hPtr*heightScale;
+					*vPtr=p;
+					}
 				}
 			}
-		}
-	else
-		{
-		Point p;
-		p[1]=origin.getValue()[1];
-		for(int z=0;z<zDim;++z,p[1]+=zSp)
+		else
 			{
-			p[0]=origin.getValue()[0];
-			for(int x=0;x<xDim;++x,++vPtr,++hPtr,p[0]+=xSp)
+			Point p;
+			p[1]=origin[1]+Scalar(zBegin)*zSp;
+			for(int z=zBegin;z<zEnd;++z,p[1]+=zSp)
 				{
-				p[2]=origin.getValue()[2]+*hPtr*heightScale.getValue();
-				*vPtr=p;
+				p[0]=origin[0];
+				for(int x=0;x<xDim;++x,++vPtr,++hPtr,p[0]+=xSp)
+					{
+					p[2]=origin[2]+*hPtr*heightScale;
+					*vPtr=p;
+					}
 				}
 			}
 		}
+	};
+
+class QuadNormalRowCalculator // Functor to calculate the quad normal vectors of a range of grid cell rows
+	{
+	/* Elements: */
+	private:
+	Vector* normals; // Quad normal vector array
+	const Scalar* heights; // Height value array
+	int xDim; // Number of vertices per grid row
+	Scalar nx,ny,nz; // Normal vector scaling factors, including orientation
+	bool heightIsY; // Flag whether height values are stored in the vertices' y or z components
+	
+	/* Constructors and destructors: */
+	public:
+	QuadNormalRowCalculator(Vector* sNormals,const Scalar* sHeights,int sXDim,Scalar sNx,Scalar sNy,Scalar sNz,bool sHeightIsY)
+		:normals(sNormals),heights(sHeights),xDim(sXDim),
+		 nx(sNx),ny(sNy),nz(sNz),
+		 heightIsY(sHeightIsY)
+		{
+		}
+	
+	/* Methods: */
+	void operator()(int zBegin,int zEnd) const
+		{
+		Vector* nPtr=normals+zBegin*(xDim-1);
+		if(heightIsY)
+			{
+			for(int z=zBegin;z<zEnd;++z)
+				for(int x=0;x<xDim-1;++x,++nPtr)
+					{
+					/* Calculate the quad normal as the average of the normals of the quad's two triangles: */
+					const Scalar* h=heights+(z*xDim+x);
+					(*nPtr)[0]=(h[0]-h[1]+h[xDim]-h[xDim+1])*nx;
+					(*nPtr)[1]=ny*Scalar(2); // To average over sum of two triangle normals
+					(*nPtr)[2]=(h[0]+h[1]-h[xDim]-h[xDim+1])*nz;
+					}
+			}
+		else
+			{
+			for(int z=zBegin;z<zEnd;++z)
+				for(int x=0;x<xDim-1;++x,++nPtr)
+					{
+					/* Calculate the quad normal as the average of the normals of the quad's two triangles: */
+					const Scalar* h=heights+(z*xDim+x);
+					(*nPtr)[0]=(h[0]-h[1]+h[xDim]-h[xDim+1])*nx;
+					(*nPtr)[1]=(h[0]+h[1]-h[xDim]-h[xDim+1])*nz;
+					(*nPtr)[2]=ny*Scalar(2); // To average over sum of two triangle normals
+					}
+			}
+		}
+	};
+
+}
+
+/**********************************
+Methods of class ElevationGridNode:
+**********************************/
+
+Point* ElevationGridNode::calcVertices(void) const
+	{
+	/* Allocate the result array: */
+	int xDim=xDimension.getValue();
+	int zDim=zDimension.getValue();
+	Point* vertices=new Point[zDim*xDim];
+	
+	/* Calculate all vertex positions in bands of grid rows: */
+	VertexRowCalculator vrc(vertices,&height.getValue(0),xDim,origin.getValue(),xSpacing.getValue(),zSpacing.getValue(),heightScale.getValue(),heightIsY.getValue());
+	Threads::parallelFor(0,zDim,calcGridRowGrainSize(xDim),vrc);
 	
 	return vertices;
 	}
@@ -139,41 +233,18 @@ Vector* ElevationGridNode::calcQuadNormals(void) const
 		ny=-ny;
 		nz=-nz;
 		}
-	
-	if(heightIsY.getValue())
-		{
-		/* Calculate all quad normal vectors: */
-		Vector* nPtr=normals;
-		for(int z=0;z<zDim-1;++z)
-			for(int x=0;x<xDim-1;++x,++nPtr)
-				{
-				/* Calculate the quad normal as the average of the normals of the quad's two triangles: */
-				const Scalar* h=&(height.getValue(z*xDim+x));
-				(*nPtr)[0]=(h[0]-h[1]+h[xDim]-h[xDim+1])*nx;
-				(*nPtr)[1]=ny*Scalar(2); // To average over sum of two triangle normals
-				(*nPtr)[2]=(h[0]+h[1]-h[xDim]-h[xDim+1])*nz;
-				}
-		}
-	else
+	if(!heightIsY.getValue())
 		{
 		/* Flip normal vectors to account for y,z-swap: */
 		nx=-nx;
 		ny=-ny;
 		nz=-nz;
-		
-		/* Calculate all quad normal vectors: */
-		Vector* nPtr=normals;
-		for(int z=0;z<zDim-1;++z)
-			for(int x=0;x<xDim-1;++x,++nPtr)
-				{
-				/* Calculate the quad normal as the average of the normals of the quad's two triangles: */
-				const Scalar* h=&(height.getValue(z*xDim+x));
-				(*nPtr)[0]=(h[0]-h[1]+h[xDim]-h[xDim+1])*nx;
-				(*nPtr)[1]=(h[0]+h[1]-h[xDim]-h[xDim+1])*nz;
-				(*nPtr)[2]=ny*Scalar(2); // To average over sum of two triangle normals
-				}
 		}
 	
+	/* Calculate all quad normal vectors in bands of grid rows: */
+	QuadNormalRowCalculator qnrc(normals,&height.getValue(0),xDim,nx,ny,nz,heightIsY.getValue());
+	Threads::parallelFor(0,zDim-1,calcGridRowGrainSize(xDim),qnrc);
+	
 	return normals;
 	}
 
@@ -631,9 +702,7 @@ void ElevationGridNode::uploadQuadSet(void) const
 	if(pointTransform.getValue()!=0)
 		{
 		/* Transform all vertex positions: */
-		Point* vPtr=vertices;
-		for(int i=zDim*xDim;i>0;--i,++vPtr)
-			*vPtr=pointTransform.getValue()->transformPoint(*vPtr);
+		pointTransform.getValue()->transformPoints(vertices,size_t(zDim)*size_t(xDim));
 		}
 	
 	/* Initialize the vertex buffer object: */
@@ -1202,8 +1271,15 @@ ElevationGridNode::ElevationGridNode(void)
 	 heightIsY(true),
 	 removeInvalids(false),invalidHeight(0),
 	 ccw(true),solid(true),
-	 multiplexer(0),valid(false),indexed(false),version(0)
+	 maxPixelError(2),tileCacheSize(512),
+	 multiplexer(0),valid(false),indexed(false),version(0),
+	 tiledGrid(0)
+	{
+	}
+
+ElevationGridNode::~ElevationGridNode(void)
 	{
+	delete tiledGrid;
 	}
 
 const char* ElevationGridNode::getStaticClassName(void)
@@ -1271,12 +1347,54 @@ void ElevationGridNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 		vrmlFile.parseField(ccw);
 	else if(strcmp(fieldName,"solid")==0)
 		vrmlFile.parseField(solid);
+	else if(strcmp(fieldName,"tilePyramidUrl")==0)
+		{
+		vrmlFile.parseField(tilePyramidUrl);
+		
+		/* Fully qualify all URLs: */
+		for(size_t i=0;i<tilePyramidUrl.getNumValues();++i)
+			tilePyramidUrl.setValue(i,vrmlFile.getFullUrl(tilePyramidUrl.getValue(i)));
+		}
+	else if(strcmp(fieldName,"maxPixelError")==0)
+		vrmlFile.parseField(maxPixelError);
+	else if(strcmp(fieldName,"tileCacheSize")==0)
+		vrmlFile.parseField(tileCacheSize);
 	else
 		GeometryNode::parseField(fieldName,vrmlFile);
 	}
 
 void ElevationGridNode::update(void)
 	{
+	/* Check whether the elevation grid should be rendered from a terrain tile pyramid: */
+	delete tiledGrid;
+	tiledGrid=0;
+	if(tilePyramidUrl.getNumValues()>0)
+		{
+		/* Open the tile pyramid; the pyramid file is memory-mapped, and must therefore be accessible locally on all cluster nodes: */
+		tiledGrid=new TiledElevationGrid(*this,tilePyramidUrl.getValue(0).c_str());
+		const TerrainTilePyramid& pyramid=tiledGrid->getPyramid();
+		
+		/* Install the pyramid's grid layout: */
+		xDimension.setValue(pyramid.getGridSize(0));
+		xSpacing.setValue(Scalar(pyramid.getCellSize(0)));
+		zDimension.setValue(pyramid.getGridSize(1));
+		zSpacing.setValue(Scalar(pyramid.getCellSize(1)));
+		Point newOrigin=Point::origin;
+		for(int i=0;i<2;++i)
+			newOrigin[i]=Scalar(pyramid.getGridOrigin(i));
+		if(heightIsY.getValue())
+			std::swap(newOrigin[1],newOrigin[2]);
+		origin.setValue(newOrigin);
+		
+		/* The tile renderer uses its own representation: */
+		valid=true;
+		++version;
+		
+		/* Recalculate the bounding boxes of all shapes using this geometry: */
+		updateBoundingBox();
+		return;
+		}
+	
 	/* Check whether the height field should be loaded from a file: */
 	if(heightUrl.getNumValues()>0)
 		{
@@ -1309,10 +1427,17 @@ void ElevationGridNode::update(void)
 	
 	/* Bump up the elevation grid's version number: */
 	++version;
+	
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
 	}
 
 Box ElevationGridNode::calcBoundingBox(void) const
 	{
+	/* Delegate to the tile renderer if there is one: */
+	if(tiledGrid!=0)
+		return tiledGrid->calcBoundingBox();
+	
 	Box result=Box::empty;
 	
 	if(valid)
@@ -1444,6 +1569,13 @@ void ElevationGridNode::glRenderAction(GLRenderState& renderState) const
 	if(!valid)
 		return;
 	
+	/* Delegate to the tile renderer if there is one: */
+	if(tiledGrid!=0)
+		{
+		tiledGrid->glRenderAction(renderState);
+		return;
+		}
+	
 	/* Set up OpenGL state: */
 	if(solid.getValue())
 		renderState.enableCulling(GL_BACK);
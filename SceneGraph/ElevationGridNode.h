@@ -37,6 +37,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 namespace Cluster {
 class Multiplexer;
 }
+namespace SceneGraph {
+class TiledElevationGrid;
+}
 
 namespace SceneGraph {
 
@@ -92,6 +95,9 @@ class ElevationGridNode:public GeometryNode,public GLObject
 	SFFloat invalidHeight; // Value to indicate "invalid" elevations
 	SFBool ccw;
 	SFBool solid;
+	MFString tilePyramidUrl; // URL of a local terrain tile pyramid file to render the elevation grid with view-dependent level of detail
+	SFFloat maxPixelError; // Maximum projected geometric error of rendered terrain tiles in pixels
+	SFInt tileCacheSize; // Maximum number of terrain tiles kept in each OpenGL context
 	
 	/* Derived state: */
 	protected:
@@ -100,6 +106,7 @@ class ElevationGridNode:public GeometryNode,public GLObject
 	bool indexed; // Flag whether the elevation grid is represented as a set of indexed quad strips or a set of quads
 	bool haveInvalids; // Flag whether there are some invalid elevation samples that need to be removed
 	unsigned int version; // Version number of elevation grid
+	TiledElevationGrid* tiledGrid; // Level-of-detail renderer if the elevation grid is rendered from a terrain tile pyramid
 	
 	/* Private methods: */
 	Point* calcVertices(void) const; // Returns a new-allocated array of vertex positions, untransformed by the point transformation
@@ -113,6 +120,7 @@ class ElevationGridNode:public GeometryNode,public GLObject
 	/* Constructors and destructors: */
 	public:
 	ElevationGridNode(void); // Creates a default elevation grid
+	virtual ~ElevationGridNode(void);
 	
 	/* Methods from Node: */
 	static const char* getStaticClassName(void);
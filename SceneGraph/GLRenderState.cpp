@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <SceneGraph/GLRenderState.h>
 
+#include <Math/Constants.h>
 #include <GL/gl.h>
 #include <GL/GLTexEnvTemplates.h>
 #include <GL/GLTransformationWrappers.h>
@@ -36,14 +37,16 @@ GLRenderState::GLRenderState(GLContextData& sContextData,const GLRenderState::DO
 	:contextData(sContextData),
 	 baseViewerPos(sBaseViewerPos),baseUpVector(sBaseUpVector),
 	 currentTransform(initialTransform),
+	 frustumCulling(true),
 	 emissiveColor(0.0f,0.0f,0.0f)
 	{
+	/* Initialize the view frustum in initial model coordinates from the current OpenGL context: */
+	glLoadIdentity();
+	baseFrustum.setFromGL();
+	
 	/* Install the initial transformation: */
 	glLoadMatrix(currentTransform);
 	
-	/* Initialize the view frustum from the current OpenGL context: */
-	baseFrustum.setFromGL();
-	
 	/* Initialize OpenGL state tracking elements: */
 	cullingEnabled=glIsEnabled(GL_CULL_FACE);
 	GLint tempCulledFace;
@@ -117,19 +120,32 @@ bool GLRenderState::doesBoxIntersectFrustum(const Box& box) const
 		/* Get the frustum plane's normal vector: */
 		const Vector& normal=baseFrustum.getFrustumPlane(planeIndex).getNormal();
 		
-		/* Find the point on the bounding box which is closest to the frustum plane: */
+		/* Find the point on the bounding box which is furthest inside the frustum plane (frustum plane normals point inwards): */
 		Point p;
 		for(int i=0;i<3;++i)
 			p[i]=normal*axis[i]>Scalar(0)?box.max[i]:box.min[i];
 		
-		/* Check if the point is inside the view frustum: */
-		if(!baseFrustum.getFrustumPlane(planeIndex).contains(currentTransform.transform(p)))
+		/* Check if the point is outside the view frustum: */
+		if(normal*Point(currentTransform.transform(p))<baseFrustum.getFrustumPlane(planeIndex).getOffset())
 			return false;
 		}
 	
 	return true;
 	}
 
+Scalar GLRenderState::calcProjectedSize(const Point& point,Scalar size) const
+	{
+	/* Transform the point to initial model coordinates: */
+	Point basePoint(currentTransform.transform(point));
+	
+	/* Calculate the perspective foreshortening at the point's distance from the eye: */
+	Scalar denominator=Scalar(1)-baseFrustum.getEyeScreenDistance()*baseFrustum.getScreenPlane().calcDistance(basePoint);
+	if(denominator<=Scalar(0))
+		return Math::Constants<Scalar>::max;
+	
+	return (size*Scalar(currentTransform.getScaling())*baseFrustum.getPixelSize())/denominator;
+	}
+
 void GLRenderState::enableCulling(GLenum newCulledFace)
 	{
 	if(!cullingEnabled)
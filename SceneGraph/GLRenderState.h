@@ -42,6 +42,30 @@ class GLRenderState
 	typedef Geometry::OrthogonalTransformation<double,3> DOGTransform; // Double-precision orthogonal transformations as internal representations
 	typedef GLFrustum<Scalar> Frustum; // Class describing the rendering context's view frustum
 	
+	struct NodeCounters // Structure counting the nodes processed during a scene graph traversal
+		{
+		/* Elements: */
+		public:
+		unsigned int numVisitedNodes; // Number of nodes tested against the view frustum
+		unsigned int numCulledNodes; // Number of nodes, including their subtrees, skipped by frustum culling
+		unsigned int numDrawnNodes; // Number of rendered shape nodes
+		
+		/* Constructors and destructors: */
+		NodeCounters(void) // Creates zero counters
+			:numVisitedNodes(0),numCulledNodes(0),numDrawnNodes(0)
+			{
+			}
+		
+		/* Methods: */
+		NodeCounters& operator+=(const NodeCounters& other) // Adds the counts of another traversal
+			{
+			numVisitedNodes+=other.numVisitedNodes;
+			numCulledNodes+=other.numCulledNodes;
+			numDrawnNodes+=other.numDrawnNodes;
+			return *this;
+			}
+		};
+	
 	/* Elements: */
 	GLContextData& contextData; // Context data of the current OpenGL context
 	private:
@@ -49,6 +73,8 @@ class GLRenderState
 	Point baseViewerPos; // Viewer position in initial model coordinates
 	Vector baseUpVector; // Up vector in initial model coordinates
 	DOGTransform currentTransform; // Transformation from initial model coordinates to current model coordinates
+	bool frustumCulling; // Flag whether group nodes skip children whose bounding boxes do not intersect the view frustum
+	NodeCounters nodeCounters; // Numbers of nodes processed during the traversal using this render state
 	
 	/* Elements shadowing current OpenGL state: */
 	public:
@@ -76,6 +102,36 @@ class GLRenderState
 	DOGTransform pushTransform(const DOGTransform& deltaTransform); // Ditto, with a double-precision transformation
 	void popTransform(const DOGTransform& previousTransform); // Resets the matrix stack to the given transformation; must be result from previous pushTransform call
 	bool doesBoxIntersectFrustum(const Box& box) const; // Returns true if the given box in current model coordinates intersects the view frustum
+	Scalar calcProjectedSize(const Point& point,Scalar size) const; // Returns the approximate size in pixels of a feature of the given size at the given point in current model coordinates, or a very large size if the point is at or behind the eye
+	
+	/* Frustum culling methods: */
+	bool getFrustumCulling(void) const // Returns true if frustum culling is enabled
+		{
+		return frustumCulling;
+		}
+	void setFrustumCulling(bool newFrustumCulling) // Enables or disables frustum culling for subsequent traversals
+		{
+		frustumCulling=newFrustumCulling;
+		}
+	bool visitNode(const Box& nodeBox) // Counts a visited node and returns true if a node with the given bounding box in current model coordinates needs to be rendered
+		{
+		++nodeCounters.numVisitedNodes;
+		if(frustumCulling&&!doesBoxIntersectFrustum(nodeBox))
+			{
+			++nodeCounters.numCulledNodes;
+			return false;
+			}
+		else
+			return true;
+		}
+	void drawNode(void) // Counts a rendered shape node
+		{
+		++nodeCounters.numDrawnNodes;
+		}
+	const NodeCounters& getNodeCounters(void) const // Returns the numbers of nodes processed so far; render states are created per frame, so the counters start at zero with every frame
+		{
+		return nodeCounters;
+		}
 	
 	/* OpenGL state management methods: */
 	void enableCulling(GLenum newCulledFace); // Enables OpenGL face culling
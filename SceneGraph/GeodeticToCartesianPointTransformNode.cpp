@@ -205,6 +205,31 @@ PointTransformNode::TPoint GeodeticToCartesianPointTransformNode::transformPoint
 	return re->geodeticToCartesian(geodetic)+offset;
 	}
 
+void GeodeticToCartesianPointTransformNode::transformPoints(Point* points,size_t numPoints) const
+	{
+	/* Transform the points in blocks using a double-precision buffer: */
+	const size_t blockSize=256;
+	TPoint buffer[blockSize];
+	for(size_t blockStart=0;blockStart<numPoints;blockStart+=blockSize)
+		{
+		size_t blockEnd=blockStart+blockSize<numPoints?blockStart+blockSize:numPoints;
+		TPoint* bPtr=buffer;
+		
+		/* Convert the block's geodetic points to longitude and latitude in radians and elevation in meters: */
+		for(size_t i=blockStart;i<blockEnd;++i,++bPtr)
+			for(int j=0;j<3;++j)
+				(*bPtr)[j]=TScalar(points[i][componentIndices[j]])*componentScales[j]+componentOffsets[j];
+		
+		/* Transform the block to Cartesian coordinates: */
+		re->geodeticToCartesian(buffer,buffer,blockEnd-blockStart);
+		
+		/* Write the transformed points back: */
+		bPtr=buffer;
+		for(size_t i=blockStart;i<blockEnd;++i,++bPtr)
+			points[i]=*bPtr+offset;
+		}
+	}
+
 PointTransformNode::TPoint GeodeticToCartesianPointTransformNode::inverseTransformPoint(const PointTransformNode::TPoint& point) const
 	{
 	/* Transform the point from Cartesian to geodetic coordinates: */
@@ -71,6 +71,7 @@ class GeodeticToCartesianPointTransformNode:public PointTransformNode
 	
 	/* Methods from PointTransformNode: */
 	virtual TPoint transformPoint(const TPoint& point) const;
+	virtual void transformPoints(Point* points,size_t numPoints) const;
 	virtual TPoint inverseTransformPoint(const TPoint& point) const;
 	virtual TBox calcBoundingBox(const std::vector<Point>& points) const;
 	virtual TBox transformBox(const TBox& box) const;
@@ -118,6 +118,10 @@ void GeodeticToCartesianTransformNode::update(void)
 		ReferenceEllipsoidNode::Geoid::Frame frame=referenceEllipsoid.getValue()->getRE().geodeticToCartesianFrame(g);
 		transform=OGTransform(frame.getTranslation(),frame.getRotation(),referenceEllipsoid.getValue()->scale.getValue());
 		}
+	
+	/* Recalculate the cached bounding box from the current children: */
+	trackChildBoundingBoxes(children.getValues());
+	updateBoundingBox();
 	}
 
 Box GeodeticToCartesianTransformNode::calcBoundingBox(void) const
@@ -131,7 +135,7 @@ Box GeodeticToCartesianTransformNode::calcBoundingBox(void) const
 		Box result=Box::empty;
 		for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
 			{
-			Box childBox=(*chIt)->calcBoundingBox();
+			Box childBox=(*chIt)->getBoundingBox();
 			childBox.transform(transform);
 			result.addBox(childBox);
 			}
@@ -144,10 +148,9 @@ void GeodeticToCartesianTransformNode::glRenderAction(GLRenderState& renderState
 	/* Push the transformation onto the matrix stack: */
 	GLRenderState::DOGTransform previousTransform=renderState.pushTransform(transform);
 	
-	/* Call the render actions of all children in order: */
-	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-		(*chIt)->glRenderAction(renderState);
-		
+	/* Call the render actions of all visible children in order: */
+	renderChildren(renderState);
+	
 	/* Pop the transformation off the matrix stack: */
 	renderState.popTransform(previousTransform);
 	}
@@ -46,6 +46,8 @@ void GeometryNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void GeometryNode::update(void)
 	{
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
 	}
 
 }
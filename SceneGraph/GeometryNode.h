@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/Autopointer.h>
 #include <SceneGraph/FieldTypes.h>
 #include <SceneGraph/Node.h>
+#include <SceneGraph/GraphNode.h>
 #include <SceneGraph/PointTransformNode.h>
 
 /* Forward declarations: */
@@ -41,11 +42,20 @@ class GeometryNode:public Node
 	typedef SF<PointTransformNodePointer> SFPointTransformNode;
 	
 	/* Elements: */
+	private:
+	GraphNode::ParentList parents; // List of graph nodes whose cached bounding boxes include this node's bounding box
 	
 	/* Fields: */
 	public:
 	SFPointTransformNode pointTransform;
 	
+	/* Protected methods: */
+	protected:
+	void updateBoundingBox(void) // Recalculates the cached bounding boxes of all graph nodes depending on this node; called at the end of update() when the node's extent might have changed
+		{
+		parents.updateBoundingBoxes();
+		}
+	
 	/* Constructors and destructors: */
 	public:
 	GeometryNode(void); // Creates an empty geometry node
@@ -58,6 +68,14 @@ class GeometryNode:public Node
 	/* New methods: */
 	public:
 	virtual Box calcBoundingBox(void) const =0; // Returns the bounding box of the geometry defined by the node
+	void addParent(GraphNode* parent) // Makes the given graph node's cached bounding box dependent on this node's bounding box
+		{
+		parents.add(parent);
+		}
+	void removeParent(GraphNode* parent) // Removes a dependency added with addParent
+		{
+		parents.remove(parent);
+		}
 	virtual void glRenderAction(GLRenderState& renderState) const =0; // Renders the geometry defined by the node into the current OpenGL context
 	};
 
@@ -0,0 +1,112 @@
+/***********************************************************************
+GraphNode - Base class for nodes that can be parts of a scene graph.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/GraphNode.h>
+
+namespace SceneGraph {
+
+/**************************************
+Methods of class GraphNode::ParentList:
+**************************************/
+
+void GraphNode::ParentList::add(GraphNode* parent)
+	{
+	/* Check if the parent is already in the list: */
+	for(std::vector<GraphNode*>::iterator pIt=parents.begin();pIt!=parents.end();++pIt)
+		if(*pIt==parent)
+			return;
+	
+	parents.push_back(parent);
+	}
+
+void GraphNode::ParentList::remove(GraphNode* parent)
+	{
+	for(std::vector<GraphNode*>::iterator pIt=parents.begin();pIt!=parents.end();++pIt)
+		if(*pIt==parent)
+			{
+			/* Move the last parent into the removed parent's place: */
+			*pIt=parents.back();
+			parents.pop_back();
+			break;
+			}
+	}
+
+void GraphNode::ParentList::updateBoundingBoxes(void) const
+	{
+	for(std::vector<GraphNode*>::const_iterator pIt=parents.begin();pIt!=parents.end();++pIt)
+		(*pIt)->updateBoundingBox();
+	}
+
+void GraphNode::ParentList::detachChild(const GraphNode* child) const
+	{
+	for(std::vector<GraphNode*>::const_iterator pIt=parents.begin();pIt!=parents.end();++pIt)
+		{
+		/* Remove all occurrences of the child, as it might have been listed more than once: */
+		std::vector<GraphNode*>& children=(*pIt)->boundingBoxChildren;
+		for(std::vector<GraphNode*>::iterator bcIt=children.begin();bcIt!=children.end();)
+			if(*bcIt==child)
+				bcIt=children.erase(bcIt);
+			else
+				++bcIt;
+		}
+	}
+
+/**************************
+Methods of class GraphNode:
+**************************/
+
+void GraphNode::trackChildBoundingBoxes(const GraphNode::ChildList& children)
+	{
+	/* Detach from all former children, and attach to all current children: */
+	for(std::vector<GraphNode*>::iterator bcIt=boundingBoxChildren.begin();bcIt!=boundingBoxChildren.end();++bcIt)
+		(*bcIt)->removeParent(this);
+	boundingBoxChildren.clear();
+	for(ChildList::const_iterator chIt=children.begin();chIt!=children.end();++chIt)
+		if(*chIt!=0)
+			{
+			(*chIt)->addParent(this);
+			boundingBoxChildren.push_back(chIt->getPointer());
+			}
+	}
+
+void GraphNode::updateBoundingBox(void)
+	{
+	/*********************************************************************
+	Cached bounding boxes are only ever calculated here, from update() on
+	the main thread, so that rendering threads calling getBoundingBox()
+	never modify shared state. Updating a node's box recalculates the
+	boxes of all its ancestors in turn:
+	*********************************************************************/
+	
+	boundingBox=calcBoundingBox();
+	boundingBoxValid=true;
+	parents.updateBoundingBoxes();
+	}
+
+GraphNode::~GraphNode(void)
+	{
+	/* Detach from all children that are still alive, and from all parents: */
+	for(std::vector<GraphNode*>::iterator bcIt=boundingBoxChildren.begin();bcIt!=boundingBoxChildren.end();++bcIt)
+		(*bcIt)->removeParent(this);
+	parents.detachChild(this);
+	}
+
+}
@@ -22,7 +22,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SCENEGRAPH_GRAPHNODE_INCLUDED
 #define SCENEGRAPH_GRAPHNODE_INCLUDED
 
+#include <vector>
 #include <Misc/Autopointer.h>
+#include <Geometry/Box.h>
 #include <SceneGraph/Geometry.h>
 #include <SceneGraph/Node.h>
 
@@ -35,9 +37,61 @@ namespace SceneGraph {
 
 class GraphNode:public Node
 	{
-	/* New methods: */
+	/* Embedded classes: */
+	public:
+	class ParentList // Class for lists of graph nodes whose cached bounding boxes depend on another node's bounding box
+		{
+		/* Elements: */
+		private:
+		std::vector<GraphNode*> parents; // List of dependent graph nodes
+		
+		/* Methods: */
+		public:
+		void add(GraphNode* parent); // Adds a dependent graph node if it is not already in the list
+		void remove(GraphNode* parent); // Removes a dependent graph node
+		void updateBoundingBoxes(void) const; // Recalculates the cached bounding boxes of all dependent graph nodes
+		void detachChild(const GraphNode* child) const; // Removes the given destroyed child from the child lists of all dependent graph nodes
+		};
+	
+	typedef std::vector<Misc::Autopointer<GraphNode> > ChildList; // Type for lists of child nodes
+	
+	/* Elements: */
+	private:
+	bool boundingBoxValid; // Flag whether the cached bounding box has been calculated
+	Box boundingBox; // The node's cached bounding box
+	ParentList parents; // List of graph nodes whose cached bounding boxes include this node's bounding box
+	std::vector<GraphNode*> boundingBoxChildren; // List of child nodes whose bounding boxes are included in this node's cached bounding box; children remove themselves from the list when destroyed
+	
+	/* Protected methods: */
+	protected:
+	void trackChildBoundingBoxes(const ChildList& children); // Makes this node dependent on the bounding boxes of the given children, and independent of those of any former children; called from update() before updateBoundingBox()
+	void updateBoundingBox(void); // Recalculates the node's cached bounding box, and those of all nodes depending on it; called at the end of update() when the node's extent might have changed
+	
+	/* Constructors and destructors: */
 	public:
+	GraphNode(void) // Creates a graph node with an invalid bounding box
+		:boundingBoxValid(false)
+		{
+		}
+	virtual ~GraphNode(void);
+	
+	/* New methods: */
 	virtual Box calcBoundingBox(void) const =0; // Returns the bounding box of the node
+	Box getBoundingBox(void) const // Returns the node's cached bounding box, or calculates it if the node was never updated; does not modify the node and is therefore safe to call from concurrent rendering threads
+		{
+		if(boundingBoxValid)
+			return boundingBox;
+		else
+			return calcBoundingBox();
+		}
+	void addParent(GraphNode* parent) // Makes the given graph node's cached bounding box dependent on this node's bounding box
+		{
+		parents.add(parent);
+		}
+	void removeParent(GraphNode* parent) // Removes a dependency added with addParent
+		{
+		parents.remove(parent);
+		}
 	virtual void glRenderAction(GLRenderState& renderState) const =0; // Renders the node into the current OpenGL context
 	};
 
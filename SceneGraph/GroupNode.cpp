@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string.h>
 #include <SceneGraph/EventTypes.h>
 #include <SceneGraph/VRMLFile.h>
+#include <SceneGraph/GLRenderState.h>
 
 namespace SceneGraph {
 
@@ -31,6 +32,14 @@ namespace SceneGraph {
 Methods of class GroupNode:
 **************************/
 
+void GroupNode::renderChildren(GLRenderState& renderState) const
+	{
+	/* Call the render actions of all children whose bounding boxes intersect the view frustum in order: */
+	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
+		if(renderState.visitNode((*chIt)->getBoundingBox()))
+			(*chIt)->glRenderAction(renderState);
+	}
+
 GroupNode::GroupNode(void)
 	:bboxCenter(Point::origin),
 	 bboxSize(Size(-1,-1,-1)),
@@ -142,6 +151,10 @@ void GroupNode::update(void)
 			}
 		explicitBoundingBox=Box(pmin,pmax);
 		}
+	
+	/* Recalculate the cached bounding box from the current children: */
+	trackChildBoundingBoxes(children.getValues());
+	updateBoundingBox();
 	}
 
 Box GroupNode::calcBoundingBox(void) const
@@ -151,19 +164,18 @@ Box GroupNode::calcBoundingBox(void) const
 		return explicitBoundingBox;
 	else
 		{
-		/* Calculate the group's bounding box as the union of the children's boxes: */
+		/* Calculate the group's bounding box as the union of the children's cached boxes: */
 		Box result=Box::empty;
 		for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-			result.addBox((*chIt)->calcBoundingBox());
+			result.addBox((*chIt)->getBoundingBox());
 		return result;
 		}
 	}
 
 void GroupNode::glRenderAction(GLRenderState& renderState) const
 	{
-	/* Call the render actions of all children in order: */
-	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-		(*chIt)->glRenderAction(renderState);
+	/* Call the render actions of all visible children in order: */
+	renderChildren(renderState);
 	}
 
 }
@@ -54,6 +54,9 @@ class GroupNode:public GraphNode
 	bool haveExplicitBoundingBox; // Flag whether the node has an explicit bounding box
 	Box explicitBoundingBox; // The explicit bounding box, if it exists
 	
+	/* Protected methods: */
+	void renderChildren(GLRenderState& renderState) const; // Calls the render actions of all children that are not culled by the view frustum, in order
+	
 	/* Constructors and destructors: */
 	public:
 	GroupNode(void); // Creates an empty group node
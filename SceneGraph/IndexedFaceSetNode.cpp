@@ -176,6 +176,9 @@ void IndexedFaceSetNode::update(void)
 		GLObject::init();
 		inited=true;
 		}
+	
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
 	}
 
 Box IndexedFaceSetNode::calcBoundingBox(void) const
@@ -261,6 +261,9 @@ void IndexedLineSetNode::update(void)
 	
 	/* Bump up the indexed line set's version number: */
 	++version;
+	
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
 	}
 
 Box IndexedLineSetNode::calcBoundingBox(void) const
@@ -0,0 +1,85 @@
+/***********************************************************************
+PointOctreeFile - Class to access memory-mapped multi-resolution octrees
+of colored points for out-of-core point cloud rendering.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/Internal/PointOctreeFile.h>
+
+#include <string.h>
+#include <Misc/Endianness.h>
+#include <Misc/ThrowStdErr.h>
+
+namespace SceneGraph {
+
+/****************************************
+Static elements of class PointOctreeFile:
+****************************************/
+
+const char PointOctreeFile::magic[32]="Vrui Point Octree v1.0\n";
+
+/********************************
+Methods of class PointOctreeFile:
+********************************/
+
+PointOctreeFile::PointOctreeFile(const char* fileName)
+	:file(fileName),
+	 nodes(0),points(0)
+	{
+	/* Nodes and points are accessed directly in the memory map: */
+	#if __BYTE_ORDER!=__LITTLE_ENDIAN
+	Misc::throwStdErr("SceneGraph::PointOctreeFile: Point octrees are not supported on big-endian hosts");
+	#endif
+	file.setEndianness(Misc::LittleEndian);
+	
+	/* Read and check the file header: */
+	char fileMagic[32];
+	file.read(fileMagic,sizeof(fileMagic));
+	if(memcmp(fileMagic,magic,sizeof(magic))!=0)
+		Misc::throwStdErr("SceneGraph::PointOctreeFile: File %s is not a point octree",fileName);
+	maxNodePoints=file.read<Misc::UInt32>();
+	file.skip<Misc::UInt32>(1);
+	file.read<Misc::Float64>(offset,3);
+	file.read<Misc::Float64>(center,3);
+	radius=file.read<Misc::Float64>();
+	numNodes=file.read<Misc::UInt64>();
+	numPoints=file.read<Misc::UInt64>();
+	IO::SeekableFile::Offset nodeOffset=file.read<Misc::UInt64>();
+	IO::SeekableFile::Offset pointOffset=file.read<Misc::UInt64>();
+	if(numNodes==0||radius<=0.0)
+		Misc::throwStdErr("SceneGraph::PointOctreeFile: File %s has invalid octree layout",fileName);
+	
+	/* Check that the node and point arrays lie inside the file: */
+	IO::SeekableFile::Offset nodeArraySize=IO::SeekableFile::Offset(numNodes*sizeof(Node));
+	IO::SeekableFile::Offset pointArraySize=IO::SeekableFile::Offset(numPoints*sizeof(Point));
+	if(nodeOffset+nodeArraySize>pointOffset||pointOffset+pointArraySize>file.getSize())
+		Misc::throwStdErr("SceneGraph::PointOctreeFile: File %s is truncated",fileName);
+	
+	/* Access the node and point arrays in the memory map: */
+	const char* memBase=static_cast<const char*>(static_cast<const IO::MemMappedFile&>(file).getMemory());
+	nodes=reinterpret_cast<const Node*>(memBase+nodeOffset);
+	points=reinterpret_cast<const Point*>(memBase+pointOffset);
+	
+	/* Check the node array for consistency: */
+	for(size_t i=0;i<numNodes;++i)
+		if(nodes[i].firstPoint+nodes[i].numPoints>numPoints||nodes[i].numPoints>maxNodePoints||(nodes[i].firstChild!=0&&(nodes[i].firstChild<=i||nodes[i].firstChild+8>numNodes)))
+			Misc::throwStdErr("SceneGraph::PointOctreeFile: File %s has inconsistent node %u",fileName,(unsigned int)(i));
+	}
+
+}
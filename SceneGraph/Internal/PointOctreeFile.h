@@ -0,0 +1,128 @@
+/***********************************************************************
+PointOctreeFile - Class to access memory-mapped multi-resolution octrees
+of colored points for out-of-core point cloud rendering.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_INTERNAL_POINTOCTREEFILE_INCLUDED
+#define SCENEGRAPH_INTERNAL_POINTOCTREEFILE_INCLUDED
+
+#include <Misc/SizedTypes.h>
+#include <IO/MemMappedFile.h>
+
+/***********************************************************************
+File layout (all values little-endian):
+- char[32] magic string
+- UInt32 maxNodePoints, UInt32 reserved
+- Float64 offset[3], Float64 center[3], Float64 radius
+- UInt64 numNodes, UInt64 numPoints
+- UInt64 nodeOffset, UInt64 pointOffset
+- numNodes node records; the root is node 0, and the eight children of
+  an interior node are stored consecutively in octant order (x varies
+  fastest)
+- numPoints point records; each node's points are stored consecutively
+Point positions are relative to the offset; the root node is the cube
+around the center point with the given half side length. Interior nodes
+contain a subsample of their children's points, and are replaced by
+their children during rendering.
+***********************************************************************/
+
+namespace SceneGraph {
+
+class PointOctreeFile
+	{
+	/* Embedded classes: */
+	public:
+	static const char magic[32]; // Magic string identifying point octree files
+	
+	struct Node // Structure describing one octree node
+		{
+		/* Elements: */
+		public:
+		Misc::UInt64 firstPoint; // Index of the node's first point
+		Misc::UInt32 numPoints; // Number of points in the node
+		Misc::UInt32 firstChild; // Index of the node's first child, or 0 for leaf nodes
+		};
+	
+	struct Point // Structure for points; layout matches GLGeometry::Vertex<void,0,GLubyte,4,void,GLfloat,3>
+		{
+		/* Elements: */
+		public:
+		Misc::UInt8 color[4]; // RGBA point color
+		Misc::Float32 position[3]; // Point position relative to the octree's offset
+		};
+	
+	/* Elements: */
+	private:
+	IO::MemMappedFile file; // The memory-mapped octree file
+	unsigned int maxNodePoints; // Maximum number of points in any node
+	double offset[3]; // Offset added to all point positions
+	double center[3]; // Center of the root node relative to the offset
+	double radius; // Half side length of the root node
+	size_t numNodes; // Number of nodes in the octree
+	size_t numPoints; // Number of points in all nodes
+	const Node* nodes; // Node array in the memory-mapped file
+	const Point* points; // Point array in the memory-mapped file
+	
+	/* Constructors and destructors: */
+	public:
+	PointOctreeFile(const char* fileName); // Opens the point octree of the given name
+	private:
+	PointOctreeFile(const PointOctreeFile& source); // Prohibit copy constructor
+	PointOctreeFile& operator=(const PointOctreeFile& source); // Prohibit assignment operator
+	
+	/* Methods: */
+	public:
+	unsigned int getMaxNodePoints(void) const // Returns the maximum number of points in any node
+		{
+		return maxNodePoints;
+		}
+	const double* getOffset(void) const // Returns the offset added to all point positions
+		{
+		return offset;
+		}
+	const double* getCenter(void) const // Returns the center of the root node relative to the offset
+		{
+		return center;
+		}
+	double getRadius(void) const // Returns the half side length of the root node
+		{
+		return radius;
+		}
+	size_t getNumNodes(void) const // Returns the number of nodes
+		{
+		return numNodes;
+		}
+	size_t getNumPoints(void) const // Returns the number of points in all nodes
+		{
+		return numPoints;
+		}
+	const Node& getNode(unsigned int nodeIndex) const // Returns the given node
+		{
+		return nodes[nodeIndex];
+		}
+	const Point* getNodePoints(unsigned int nodeIndex) const // Returns the given node's points
+		{
+		return points+nodes[nodeIndex].firstPoint;
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,373 @@
+/***********************************************************************
+StreamedPointOctree - Class to render point clouds from memory-mapped
+multi-resolution octrees, using view-dependent level-of-detail selection
+under a point budget and background node loading.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#define GLGEOMETRY_NONSTANDARD_TEMPLATES
+
+#include <SceneGraph/Internal/StreamedPointOctree.h>
+
+#include <queue>
+#include <Misc/SizedTypes.h>
+#include <Math/Math.h>
+#include <GL/GLContextData.h>
+#include <GL/Extensions/GLARBVertexBufferObject.h>
+#include <GL/GLGeometryWrappers.h>
+#include <GL/GLGeometryVertex.h>
+#include <SceneGraph/GLRenderState.h>
+
+namespace SceneGraph {
+
+namespace {
+
+/****************************************************
+Type for vertices matching the octree's point layout:
+****************************************************/
+
+typedef GLGeometry::Vertex<void,0,GLubyte,4,void,GLfloat,3> Vertex;
+
+}
+
+/**********************************************
+Methods of class StreamedPointOctree::DataItem:
+**********************************************/
+
+StreamedPointOctree::DataItem::DataItem(unsigned int gpuCacheSize)
+	:gpuCache(1,gpuCacheSize)
+	{
+	/* Initialize the vertex buffer object extension: */
+	if(GLARBVertexBufferObject::isSupported())
+		GLARBVertexBufferObject::initExtension();
+	}
+
+/************************************
+Methods of class StreamedPointOctree:
+************************************/
+
+Box StreamedPointOctree::calcChildBox(const Box& parentBox,int childIndex)
+	{
+	Box result;
+	for(int i=0;i<3;++i)
+		{
+		Scalar mid=Math::mid(parentBox.min[i],parentBox.max[i]);
+		if(childIndex&(0x1<<i))
+			{
+			result.min[i]=mid;
+			result.max[i]=parentBox.max[i];
+			}
+		else
+			{
+			result.min[i]=parentBox.min[i];
+			result.max[i]=mid;
+			}
+		}
+	return result;
+	}
+
+Box StreamedPointOctree::calcRenderBox(const Box& box) const
+	{
+	if(pointTransform==0)
+		return box;
+	
+	/* Transform the box in absolute coordinates, and offset the result by the render offset: */
+	const double* offset=octree.getOffset();
+	PointTransformNode::TBox tBox;
+	for(int i=0;i<3;++i)
+		{
+		tBox.min[i]=offset[i]+double(box.min[i]);
+		tBox.max[i]=offset[i]+double(box.max[i]);
+		}
+	tBox=pointTransform->transformBox(tBox);
+	Box result;
+	for(int i=0;i<3;++i)
+		{
+		result.min[i]=Scalar(tBox.min[i]-renderOffset[i]);
+		result.max[i]=Scalar(tBox.max[i]-renderOffset[i]);
+		}
+	return result;
+	}
+
+Scalar StreamedPointOctree::calcPriority(unsigned int nodeIndex,const Box& renderBox,GLRenderState& renderState) const
+	{
+	/* Find the point on the node's bounding box closest to the viewer: */
+	Point viewerPos=renderState.getViewerPos();
+	Point closest;
+	for(int i=0;i<3;++i)
+		closest[i]=Math::clamp(viewerPos[i],renderBox.min[i],renderBox.max[i]);
+	
+	/* Estimate the average distance between the node's points, assuming they sample a surface: */
+	unsigned int numPoints=octree.getNode(nodeIndex).numPoints;
+	Scalar size=Math::max(renderBox.max[0]-renderBox.min[0],Math::max(renderBox.max[1]-renderBox.min[1],renderBox.max[2]-renderBox.min[2]));
+	Scalar spacing=size/Math::sqrt(Scalar(numPoints>0?numPoints:1));
+	
+	return renderState.calcProjectedSize(closest,spacing);
+	}
+
+StreamingCache::Item* StreamedPointOctree::loadItem(unsigned int itemIndex)
+	{
+	/* Copy the node's points out of the memory-mapped file, which pages them in on this thread: */
+	NodeData* data=new NodeData;
+	const PointOctreeFile::Point* pPtr=octree.getNodePoints(itemIndex);
+	data->points.assign(pPtr,pPtr+octree.getNode(itemIndex).numPoints);
+	
+	/* Transform the node's points in double precision and store them relative to the render offset: */
+	if(pointTransform!=0)
+		{
+		const double* offset=octree.getOffset();
+		for(std::vector<PointOctreeFile::Point>::iterator pIt=data->points.begin();pIt!=data->points.end();++pIt)
+			{
+			PointTransformNode::TPoint p;
+			for(int i=0;i<3;++i)
+				p[i]=offset[i]+double(pIt->position[i]);
+			p=pointTransform->transformPoint(p);
+			for(int i=0;i<3;++i)
+				pIt->position[i]=Misc::Float32(p[i]-renderOffset[i]);
+			}
+		}
+	
+	/* Update the statistics: */
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	++statistics.numLoadedNodes;
+	statistics.numLoadedBytes+=data->points.size()*sizeof(PointOctreeFile::Point);
+	
+	return data;
+	}
+
+void StreamedPointOctree::selectNodes(GLRenderState& renderState,StreamingCache::Selection& selection,std::vector<StreamedPointOctree::DrawNode>& drawNodes)
+	{
+	/* Start with the root node: */
+	Box rootRenderBox=calcRenderBox(rootBox);
+	if(!renderState.doesBoxIntersectFrustum(rootRenderBox))
+		return;
+	unsigned int numRootUploads=0;
+	if(!selection.isItemReady(0,numRootUploads)||!selection.reserveUploads(numRootUploads))
+		{
+		selection.requestItem(0);
+		return;
+		}
+	std::priority_queue<Candidate> candidates;
+	candidates.push(Candidate(0,rootBox,calcPriority(0,rootRenderBox,renderState)));
+	size_t numSelectedPoints=octree.getNode(0).numPoints;
+	
+	/* Refine the candidate with the coarsest projected point spacing until the point budget is exhausted: */
+	while(!candidates.empty())
+		{
+		Candidate c=candidates.top();
+		candidates.pop();
+		const PointOctreeFile::Node& node=octree.getNode(c.nodeIndex);
+		
+		bool refine=false;
+		Box childBoxes[8];
+		Box childRenderBoxes[8];
+		bool childVisible[8];
+		bool childReady[8];
+		if(node.firstChild!=0&&c.priority>pointSize)
+			{
+			/* Check whether the node's visible children fit into the point budget and are ready: */
+			size_t newNumSelectedPoints=numSelectedPoints-node.numPoints;
+			bool childrenReady=true;
+			unsigned int numUploads=0;
+			for(int i=0;i<8;++i)
+				{
+				unsigned int childIndex=node.firstChild+i;
+				childBoxes[i]=calcChildBox(c.box,i);
+				childVisible[i]=false;
+				if(octree.getNode(childIndex).numPoints>0)
+					{
+					childRenderBoxes[i]=calcRenderBox(childBoxes[i]);
+					childVisible[i]=renderState.doesBoxIntersectFrustum(childRenderBoxes[i]);
+					}
+				if(childVisible[i])
+					{
+					newNumSelectedPoints+=octree.getNode(childIndex).numPoints;
+					childReady[i]=selection.isItemReady(childIndex,numUploads);
+					if(!childReady[i])
+						childrenReady=false;
+					}
+				}
+			if(newNumSelectedPoints<=pointBudget)
+				{
+				if(childrenReady)
+					{
+					/* Keep rendering this node if uploading its children would exceed this frame's upload budget: */
+					refine=selection.reserveUploads(numUploads);
+					if(refine)
+						numSelectedPoints=newNumSelectedPoints;
+					}
+				else
+					{
+					/* Request the missing children: */
+					for(int i=0;i<8;++i)
+						if(childVisible[i]&&!childReady[i])
+							selection.requestItem(node.firstChild+i);
+					}
+				}
+			}
+		
+		if(refine)
+			{
+			/* Replace the node by its visible children: */
+			for(int i=0;i<8;++i)
+				if(childVisible[i])
+					candidates.push(Candidate(node.firstChild+i,childBoxes[i],calcPriority(node.firstChild+i,childRenderBoxes[i],renderState)));
+			}
+		else
+			{
+			/* Render this node, and pass its points along if they are not yet uploaded into the current context: */
+			drawNodes.push_back(DrawNode(c.nodeIndex,selection.getUploadItem(c.nodeIndex)));
+			}
+		}
+	}
+
+StreamedPointOctree::StreamedPointOctree(const char* octreeFileName,PointTransformNodePointer sPointTransform,Scalar sPointSize,size_t sPointBudget,unsigned int sGpuCacheSize,unsigned int sNumLoaderThreads)
+	:GLObject(false),
+	 octree(octreeFileName),
+	 pointTransform(sPointTransform),
+	 pointSize(sPointSize),pointBudget(sPointBudget),
+	 gpuCacheSize(sGpuCacheSize>16?sGpuCacheSize:16),
+	 maxUploadsPerFrame(32),
+	 cache(*this,octree.getNumNodes(),gpuCacheSize*2,sNumLoaderThreads)
+	{
+	/* Calculate the root node's bounding box: */
+	for(int i=0;i<3;++i)
+		{
+		rootBox.min[i]=Scalar(octree.getCenter()[i]-octree.getRadius());
+		rootBox.max[i]=Scalar(octree.getCenter()[i]+octree.getRadius());
+		}
+	
+	/* Calculate the render offset, which is the transformed center of the root node if there is a point transformation: */
+	if(pointTransform!=0)
+		{
+		PointTransformNode::TPoint center;
+		for(int i=0;i<3;++i)
+			center[i]=octree.getOffset()[i]+octree.getCenter()[i];
+		center=pointTransform->transformPoint(center);
+		for(int i=0;i<3;++i)
+			renderOffset[i]=center[i];
+		}
+	else
+		{
+		for(int i=0;i<3;++i)
+			renderOffset[i]=octree.getOffset()[i];
+		}
+	}
+
+StreamedPointOctree::~StreamedPointOctree(void)
+	{
+	}
+
+void StreamedPointOctree::initContext(GLContextData& contextData) const
+	{
+	/* Create a data item and store it in the context: */
+	DataItem* dataItem=new DataItem(gpuCacheSize);
+	contextData.addDataItem(this,dataItem);
+	}
+
+Box StreamedPointOctree::calcBoundingBox(void) const
+	{
+	/* Offset the root node's transformed bounding box: */
+	Box rootRenderBox=calcRenderBox(rootBox);
+	Box result;
+	for(int i=0;i<3;++i)
+		{
+		result.min[i]=Scalar(renderOffset[i]+double(rootRenderBox.min[i]));
+		result.max[i]=Scalar(renderOffset[i]+double(rootRenderBox.max[i]));
+		}
+	return result;
+	}
+
+StreamedPointOctree::Statistics StreamedPointOctree::getStatistics(void)
+	{
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	return statistics;
+	}
+
+void StreamedPointOctree::glRenderAction(GLRenderState& renderState)
+	{
+	/* Retrieve the context data item, or create it if the point cloud was created after the current context was initialized: */
+	DataItem* dataItem=renderState.contextData.retrieveDataItem<DataItem>(this);
+	if(dataItem==0)
+		{
+		dataItem=new DataItem(gpuCacheSize);
+		renderState.contextData.addDataItem(this,dataItem);
+		}
+	if(!GLARBVertexBufferObject::isSupported())
+		return;
+	dataItem->gpuCache.startFrame();
+	
+	/* Go to the octree's rendering coordinate system in double precision: */
+	GLRenderState::DOGTransform previousTransform=renderState.pushTransform(GLRenderState::DOGTransform::translate(GLRenderState::DOGTransform::Vector(renderOffset)));
+	
+	/* Select the nodes to render, limiting the number of nodes uploaded in this frame: */
+	std::vector<DrawNode> drawNodes;
+	{
+	StreamingCache::Selection selection(cache,dataItem->gpuCache,maxUploadsPerFrame);
+	selectNodes(renderState,selection,drawNodes);
+	}
+	
+	/* Set up OpenGL state: */
+	renderState.disableMaterials();
+	renderState.disableTextures();
+	glPointSize(pointSize);
+	GLVertexArrayParts::enable(Vertex::getPartsMask());
+	
+	/* Render all selected nodes: */
+	size_t numUploadedBytes=0;
+	size_t numRenderedPoints=0;
+	for(std::vector<DrawNode>::iterator dnIt=drawNodes.begin();dnIt!=drawNodes.end();++dnIt)
+		{
+		StreamingCache::GPUItem* gn=dataItem->gpuCache.findItem(dnIt->nodeIndex);
+		if(gn==0)
+			{
+			/* Upload the node's points: */
+			gn=&dataItem->gpuCache.addItem(dnIt->nodeIndex);
+			const std::vector<PointOctreeFile::Point>& points=static_cast<const NodeData&>(*dnIt->data).points;
+			glBindBufferARB(GL_ARRAY_BUFFER_ARB,gn->bufferIds[0]);
+			glBufferDataARB(GL_ARRAY_BUFFER_ARB,points.size()*sizeof(Vertex),points.empty()?0:&points[0],GL_STATIC_DRAW_ARB);
+			numUploadedBytes+=points.size()*sizeof(Vertex);
+			gn->numElements=GLsizei(points.size());
+			}
+		else
+			glBindBufferARB(GL_ARRAY_BUFFER_ARB,gn->bufferIds[0]);
+		
+		/* Render the node: */
+		glVertexPointer(static_cast<const Vertex*>(0));
+		glDrawArrays(GL_POINTS,0,gn->numElements);
+		numRenderedPoints+=gn->numElements;
+		}
+	
+	/* Reset the vertex arrays: */
+	GLVertexArrayParts::disable(Vertex::getPartsMask());
+	
+	/* Protect the vertex buffer object: */
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
+	
+	/* Return to the previous coordinate system: */
+	renderState.popTransform(previousTransform);
+	
+	/* Update the statistics: */
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	statistics.numUploadedBytes+=numUploadedBytes;
+	statistics.numRenderedNodes=drawNodes.size();
+	statistics.numRenderedPoints=numRenderedPoints;
+	}
+
+}
@@ -0,0 +1,166 @@
+/***********************************************************************
+StreamedPointOctree - Class to render point clouds from memory-mapped
+multi-resolution octrees, using view-dependent level-of-detail selection
+under a point budget and background node loading.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_INTERNAL_STREAMEDPOINTOCTREE_INCLUDED
+#define SCENEGRAPH_INTERNAL_STREAMEDPOINTOCTREE_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Threads/Mutex.h>
+#include <Geometry/Box.h>
+#include <GL/gl.h>
+#include <GL/GLObject.h>
+#include <SceneGraph/Geometry.h>
+#include <SceneGraph/PointTransformNode.h>
+#include <SceneGraph/Internal/PointOctreeFile.h>
+#include <SceneGraph/Internal/StreamingCache.h>
+
+/* Forward declarations: */
+namespace SceneGraph {
+class GLRenderState;
+}
+
+namespace SceneGraph {
+
+class StreamedPointOctree:public GLObject,private StreamingCache::Loader
+	{
+	/* Embedded classes: */
+	public:
+	struct Statistics // Structure to report streaming and rendering statistics
+		{
+		/* Elements: */
+		public:
+		size_t numLoadedNodes; // Total number of nodes loaded from the octree file
+		size_t numLoadedBytes; // Total number of bytes loaded from the octree file
+		size_t numUploadedBytes; // Total number of bytes uploaded into OpenGL contexts
+		unsigned int numRenderedNodes; // Number of nodes rendered in the most recent frame
+		size_t numRenderedPoints; // Number of points rendered in the most recent frame
+		
+		/* Constructors and destructors: */
+		Statistics(void)
+			:numLoadedNodes(0),numLoadedBytes(0),numUploadedBytes(0),
+			 numRenderedNodes(0),numRenderedPoints(0)
+			{
+			}
+		};
+	
+	private:
+	class NodeData:public StreamingCache::Item // Class for node points loaded by a loader thread
+		{
+		/* Elements: */
+		public:
+		std::vector<PointOctreeFile::Point> points; // The node's points
+		};
+	
+	struct DataItem:public GLObject::DataItem
+		{
+		/* Elements: */
+		public:
+		StreamingCache::GPUCache gpuCache; // Cache of nodes uploaded into this context; each node has a vertex buffer
+		
+		/* Constructors and destructors: */
+		DataItem(unsigned int gpuCacheSize);
+		};
+	
+	struct Candidate // Structure for nodes considered during level-of-detail selection
+		{
+		/* Elements: */
+		public:
+		unsigned int nodeIndex; // Index of the node
+		Box box; // Node's untransformed bounding box relative to the octree's offset
+		Scalar priority; // Projected point spacing of the node in pixels
+		
+		/* Constructors and destructors: */
+		Candidate(unsigned int sNodeIndex,const Box& sBox,Scalar sPriority)
+			:nodeIndex(sNodeIndex),box(sBox),priority(sPriority)
+			{
+			}
+		
+		/* Methods: */
+		friend bool operator<(const Candidate& c1,const Candidate& c2) // Orders candidates by increasing priority
+			{
+			return c1.priority<c2.priority;
+			}
+		};
+	
+	struct DrawNode // Structure for nodes selected for rendering
+		{
+		/* Elements: */
+		public:
+		unsigned int nodeIndex; // Index of the node
+		StreamingCache::ItemPointer data; // Node's points if they need to be uploaded into the current context
+		
+		/* Constructors and destructors: */
+		DrawNode(unsigned int sNodeIndex,StreamingCache::ItemPointer sData)
+			:nodeIndex(sNodeIndex),data(sData)
+			{
+			}
+		};
+	
+	/* Elements: */
+	PointOctreeFile octree; // The memory-mapped point octree
+	PointTransformNodePointer pointTransform; // Transformation applied to all points, or null
+	double renderOffset[3]; // Offset added to rendered point positions; differs from the octree's offset if there is a point transformation
+	Box rootBox; // Untransformed bounding box of the root node relative to the octree's offset
+	Scalar pointSize; // Rendered point size in pixels
+	size_t pointBudget; // Maximum number of points to render per frame
+	unsigned int gpuCacheSize; // Maximum number of nodes kept in each OpenGL context
+	unsigned int maxUploadsPerFrame; // Maximum number of nodes uploaded into an OpenGL context per rendering pass
+	Threads::Mutex statisticsMutex; // Mutex protecting the statistics
+	Statistics statistics; // Streaming and rendering statistics
+	StreamingCache cache; // Shared cache of node points loaded by background loader threads
+	
+	/* Private methods: */
+	static Box calcChildBox(const Box& parentBox,int childIndex); // Returns the bounding box of the given child of a node with the given bounding box
+	Box calcRenderBox(const Box& box) const; // Returns the given untransformed box relative to the octree's offset as a box relative to the render offset
+	Scalar calcPriority(unsigned int nodeIndex,const Box& renderBox,GLRenderState& renderState) const; // Returns the projected point spacing of the given node with the given bounding box relative to the render offset in pixels
+	void selectNodes(GLRenderState& renderState,StreamingCache::Selection& selection,std::vector<DrawNode>& drawNodes); // Selects nodes to render within the selection pass's upload budget
+	
+	/* Methods from StreamingCache::Loader: */
+	virtual StreamingCache::Item* loadItem(unsigned int itemIndex);
+	
+	/* Constructors and destructors: */
+	public:
+	StreamedPointOctree(const char* octreeFileName,PointTransformNodePointer sPointTransform,Scalar sPointSize,size_t sPointBudget,unsigned int sGpuCacheSize,unsigned int sNumLoaderThreads); // Opens the given point octree and applies the given optional point transformation to all points
+	private:
+	StreamedPointOctree(const StreamedPointOctree& source); // Prohibit copy constructor
+	StreamedPointOctree& operator=(const StreamedPointOctree& source); // Prohibit assignment operator
+	public:
+	virtual ~StreamedPointOctree(void);
+	
+	/* Methods from GLObject: */
+	virtual void initContext(GLContextData& contextData) const;
+	
+	/* New methods: */
+	const PointOctreeFile& getOctree(void) const // Returns the point octree
+		{
+		return octree;
+		}
+	Box calcBoundingBox(void) const; // Returns the bounding box of the entire point cloud in model coordinates
+	Statistics getStatistics(void); // Returns the current streaming and rendering statistics
+	void glRenderAction(GLRenderState& renderState); // Renders the point cloud into the current OpenGL context
+	};
+
+}
+
+#endif
@@ -0,0 +1,240 @@
+/***********************************************************************
+StreamingCache - Class to manage the items of an out-of-core data set,
+which are created by background loader threads into a shared cache and
+uploaded from there into per-context caches of buffer objects.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/Internal/StreamingCache.h>
+
+#include <GL/Extensions/GLARBVertexBufferObject.h>
+
+namespace SceneGraph {
+
+/*****************************************
+Methods of class StreamingCache::GPUCache:
+*****************************************/
+
+StreamingCache::GPUCache::GPUCache(int sNumBuffers,unsigned int sCacheSize)
+	:numBuffers(sNumBuffers),
+	 cacheSize(sCacheSize),
+	 gpuItems(101),
+	 frame(0)
+	{
+	}
+
+StreamingCache::GPUCache::~GPUCache(void)
+	{
+	/* Destroy all cached items' buffer objects: */
+	for(GPUItemMap::Iterator giIt=gpuItems.begin();!giIt.isFinished();++giIt)
+		glDeleteBuffersARB(numBuffers,giIt->getDest().bufferIds);
+	}
+
+StreamingCache::GPUItem* StreamingCache::GPUCache::findItem(unsigned int itemIndex)
+	{
+	GPUItemMap::Iterator giIt=gpuItems.findEntry(itemIndex);
+	if(giIt.isFinished())
+		return 0;
+	
+	/* Protect the uploaded item from eviction during the current frame: */
+	giIt->getDest().lastUsed=frame;
+	return &giIt->getDest();
+	}
+
+StreamingCache::GPUItem& StreamingCache::GPUCache::addItem(unsigned int itemIndex)
+	{
+	/* Find the least-recently used item not rendered in the current frame if the cache is full: */
+	GPUItem newItem;
+	GPUItemMap::Iterator lruIt=gpuItems.end();
+	if(gpuItems.getNumEntries()>=cacheSize)
+		{
+		for(GPUItemMap::Iterator giIt=gpuItems.begin();!giIt.isFinished();++giIt)
+			if(giIt->getDest().lastUsed!=frame&&(lruIt.isFinished()||giIt->getDest().lastUsed<lruIt->getDest().lastUsed))
+				lruIt=giIt;
+		}
+	
+	/* Evict the least-recently used item and reuse its buffer objects, or create new buffer objects: */
+	if(!lruIt.isFinished())
+		{
+		for(int i=0;i<numBuffers;++i)
+			newItem.bufferIds[i]=lruIt->getDest().bufferIds[i];
+		gpuItems.removeEntry(lruIt);
+		}
+	else
+		glGenBuffersARB(numBuffers,newItem.bufferIds);
+	newItem.numElements=0;
+	newItem.lastUsed=frame;
+	
+	/* Add the new item: */
+	gpuItems.setEntry(GPUItemMap::Entry(itemIndex,newItem));
+	return gpuItems.getEntry(itemIndex).getDest();
+	}
+
+/*******************************************
+Methods of class StreamingCache::Selection:
+*******************************************/
+
+StreamingCache::Selection::Selection(StreamingCache& sCache,StreamingCache::GPUCache& sGpuCache,unsigned int sUploadBudget)
+	:cache(sCache),cacheLock(cache.cacheCond),
+	 gpuCache(sGpuCache),
+	 numRequests(cache.requests.size()),
+	 uploadBudget(sUploadBudget)
+	{
+	++cache.selectionPass;
+	}
+
+StreamingCache::Selection::~Selection(void)
+	{
+	/* Wake up the loader threads if there are new requests: */
+	if(cache.requests.size()!=numRequests)
+		cache.cacheCond.broadcast();
+	}
+
+void StreamingCache::Selection::requestItem(unsigned int itemIndex)
+	{
+	ItemState& is=cache.itemStates[itemIndex];
+	if(!is.requested&&is.item==0)
+		{
+		/* Queue the request: */
+		is.requested=true;
+		cache.requests.push_back(itemIndex);
+		
+		/* Drop the oldest requests, which are most likely no longer needed: */
+		while(cache.requests.size()>size_t(cache.cacheSize/4+16))
+			{
+			cache.itemStates[cache.requests.front()].requested=false;
+			cache.requests.pop_front();
+			}
+		}
+	}
+
+bool StreamingCache::Selection::isItemReady(unsigned int itemIndex,unsigned int& numUploads)
+	{
+	/* Check if the item is already uploaded into the current context: */
+	if(gpuCache.findItem(itemIndex)!=0)
+		return true;
+	
+	/* Check if the item is in the shared cache: */
+	ItemState& is=cache.itemStates[itemIndex];
+	if(is.item!=0)
+		{
+		is.lastUsed=cache.selectionPass;
+		++numUploads;
+		return true;
+		}
+	
+	return false;
+	}
+
+bool StreamingCache::Selection::reserveUploads(unsigned int numUploads)
+	{
+	if(numUploads>uploadBudget)
+		return false;
+	
+	uploadBudget-=numUploads;
+	return true;
+	}
+
+StreamingCache::ItemPointer StreamingCache::Selection::getUploadItem(unsigned int itemIndex)
+	{
+	if(!gpuCache.isUploaded(itemIndex))
+		return cache.itemStates[itemIndex].item;
+	else
+		return 0;
+	}
+
+/*******************************
+Methods of class StreamingCache:
+*******************************/
+
+void* StreamingCache::loaderThreadMethod(void)
+	{
+	while(true)
+		{
+		/* Wait for the next request: */
+		unsigned int itemIndex;
+		{
+		Threads::MutexCond::Lock cacheLock(cacheCond);
+		while(!shutdown&&requests.empty())
+			cacheCond.wait(cacheLock);
+		if(shutdown)
+			break;
+		
+		/* Serve the most recent request first: */
+		itemIndex=requests.back();
+		requests.pop_back();
+		}
+		
+		/* Create the item without holding the cache lock: */
+		ItemPointer item=loader.loadItem(itemIndex);
+		
+		/* Add the item to the shared cache: */
+		Threads::MutexCond::Lock cacheLock(cacheCond);
+		ItemState& is=itemStates[itemIndex];
+		is.item=item;
+		is.lastUsed=selectionPass;
+		is.requested=false;
+		cachedItems.push_back(itemIndex);
+		
+		/* Evict least-recently used items that are not used by the current selection pass: */
+		while(cachedItems.size()>cacheSize)
+			{
+			std::vector<unsigned int>::iterator lruIt=cachedItems.begin();
+			for(std::vector<unsigned int>::iterator ciIt=cachedItems.begin();ciIt!=cachedItems.end();++ciIt)
+				if(itemStates[*ciIt].lastUsed<itemStates[*lruIt].lastUsed)
+					lruIt=ciIt;
+			if(itemStates[*lruIt].lastUsed==selectionPass)
+				break;
+			itemStates[*lruIt].item=0;
+			*lruIt=cachedItems.back();
+			cachedItems.pop_back();
+			}
+		}
+	
+	return 0;
+	}
+
+StreamingCache::StreamingCache(StreamingCache::Loader& sLoader,unsigned int sNumItems,unsigned int sCacheSize,unsigned int sNumLoaderThreads)
+	:loader(sLoader),
+	 cacheSize(sCacheSize),
+	 itemStates(sNumItems),
+	 selectionPass(0),
+	 shutdown(false),
+	 numLoaderThreads(sNumLoaderThreads>1?sNumLoaderThreads:1),
+	 loaderThreads(new Threads::Thread[numLoaderThreads])
+	{
+	/* Start the loader threads: */
+	for(unsigned int i=0;i<numLoaderThreads;++i)
+		loaderThreads[i].start(this,&StreamingCache::loaderThreadMethod);
+	}
+
+StreamingCache::~StreamingCache(void)
+	{
+	/* Shut down the loader threads: */
+	{
+	Threads::MutexCond::Lock cacheLock(cacheCond);
+	shutdown=true;
+	cacheCond.broadcast();
+	}
+	for(unsigned int i=0;i<numLoaderThreads;++i)
+		loaderThreads[i].join();
+	delete[] loaderThreads;
+	}
+
+}
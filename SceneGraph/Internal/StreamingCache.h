@@ -0,0 +1,172 @@
+/***********************************************************************
+StreamingCache - Class to manage the items of an out-of-core data set,
+which are created by background loader threads into a shared cache and
+uploaded from there into per-context caches of buffer objects.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_INTERNAL_STREAMINGCACHE_INCLUDED
+#define SCENEGRAPH_INTERNAL_STREAMINGCACHE_INCLUDED
+
+#include <stddef.h>
+#include <deque>
+#include <vector>
+#include <Misc/Autopointer.h>
+#include <Misc/HashTable.h>
+#include <Threads/RefCounted.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+#include <GL/gl.h>
+
+namespace SceneGraph {
+
+class StreamingCache
+	{
+	/* Embedded classes: */
+	public:
+	class Item:public Threads::RefCounted // Base class for items created by a loader thread
+		{
+		/* Constructors and destructors: */
+		public:
+		virtual ~Item(void)
+			{
+			}
+		};
+	
+	typedef Misc::Autopointer<Item> ItemPointer;
+	
+	class Loader // Interface for objects creating items
+		{
+		/* Constructors and destructors: */
+		public:
+		virtual ~Loader(void)
+			{
+			}
+		
+		/* Methods: */
+		virtual Item* loadItem(unsigned int itemIndex) =0; // Creates the item of the given index; called from a loader thread
+		};
+	
+	struct GPUItem // Structure describing an item uploaded into an OpenGL context
+		{
+		/* Elements: */
+		public:
+		GLuint bufferIds[2]; // IDs of the item's buffer objects
+		GLsizei numElements; // Number of elements to render from the item's buffer objects
+		unsigned int lastUsed; // Frame in which the item was last rendered
+		};
+	
+	class GPUCache // Class for the cache of items uploaded into one OpenGL context
+		{
+		/* Embedded classes: */
+		private:
+		typedef Misc::HashTable<unsigned int,GPUItem> GPUItemMap; // Hash table mapping item indices to uploaded items
+		
+		/* Elements: */
+		int numBuffers; // Number of buffer objects per item
+		unsigned int cacheSize; // Maximum number of items kept in the context
+		GPUItemMap gpuItems; // Map of uploaded items
+		unsigned int frame; // Number of rendering passes in the context
+		
+		/* Constructors and destructors: */
+		public:
+		GPUCache(int sNumBuffers,unsigned int sCacheSize); // Creates an empty cache of the given size for items with the given number of buffer objects
+		~GPUCache(void); // Destroys all cached items' buffer objects
+		
+		/* Methods: */
+		void startFrame(void) // Starts a new rendering pass
+			{
+			++frame;
+			}
+		bool isUploaded(unsigned int itemIndex) const // Returns true if the item of the given index is uploaded
+			{
+			return !gpuItems.findEntry(itemIndex).isFinished();
+			}
+		GPUItem* findItem(unsigned int itemIndex); // Returns the uploaded item of the given index and marks it as used in the current frame, or null if the item is not uploaded
+		GPUItem& addItem(unsigned int itemIndex); // Adds the item of the given index, reusing the buffer objects of the least-recently used item not rendered in the current frame if the cache is full; caller must upload the item's data and set its number of elements
+		};
+	
+	class Selection // Class to lock the shared cache during an item selection pass in an OpenGL context
+		{
+		/* Elements: */
+		private:
+		StreamingCache& cache; // The locked shared cache
+		Threads::MutexCond::Lock cacheLock; // Lock on the shared cache
+		GPUCache& gpuCache; // Cache of items uploaded into the current context
+		size_t numRequests; // Length of the request queue at the beginning of the selection pass
+		unsigned int uploadBudget; // Number of items that can still be uploaded into the current context during this selection pass
+		
+		/* Constructors and destructors: */
+		public:
+		Selection(StreamingCache& sCache,GPUCache& sGpuCache,unsigned int sUploadBudget); // Starts a selection pass allowing the given number of uploads into the given context
+		~Selection(void); // Finishes the selection pass and wakes up the loader threads if there are new requests
+		
+		/* Methods: */
+		void requestItem(unsigned int itemIndex); // Requests loading the given item
+		bool isItemReady(unsigned int itemIndex,unsigned int& numUploads); // Returns true if the given item can be rendered immediately and marks it as used; increments the upload counter if the item is not yet uploaded into the current context
+		bool reserveUploads(unsigned int numUploads); // Returns true and deducts the given number of uploads from the upload budget if they fit into it
+		ItemPointer getUploadItem(unsigned int itemIndex); // Returns the given ready item if it needs to be uploaded into the current context, or null otherwise
+		};
+	
+	friend class Selection;
+	
+	private:
+	struct ItemState // Structure describing the shared state of an item
+		{
+		/* Elements: */
+		public:
+		ItemPointer item; // The item if it is in the shared cache
+		unsigned int lastUsed; // Selection pass in which the item was last used
+		bool requested; // Flag whether the item is in the request queue
+		
+		/* Constructors and destructors: */
+		ItemState(void)
+			:lastUsed(0),requested(false)
+			{
+			}
+		};
+	
+	/* Elements: */
+	Loader& loader; // Object creating items
+	unsigned int cacheSize; // Maximum number of items kept in the shared cache
+	Threads::MutexCond cacheCond; // Condition variable to signal new requests to the loader threads; protects the shared item state
+	std::vector<ItemState> itemStates; // Shared state of all items
+	std::deque<unsigned int> requests; // Queue of items to be loaded; most recent requests are served first
+	std::vector<unsigned int> cachedItems; // List of items in the shared cache
+	unsigned int selectionPass; // Number of item selection passes
+	bool shutdown; // Flag to shut down the loader threads
+	unsigned int numLoaderThreads; // Number of background loader threads
+	Threads::Thread* loaderThreads; // Array of background threads creating items
+	
+	/* Private methods: */
+	void* loaderThreadMethod(void); // Thread method creating requested items
+	
+	/* Constructors and destructors: */
+	public:
+	StreamingCache(Loader& sLoader,unsigned int sNumItems,unsigned int sCacheSize,unsigned int sNumLoaderThreads); // Creates a shared cache of the given size for the given number of items and starts the given number of loader threads; the loader must outlive the cache
+	private:
+	StreamingCache(const StreamingCache& source); // Prohibit copy constructor
+	StreamingCache& operator=(const StreamingCache& source); // Prohibit assignment operator
+	public:
+	~StreamingCache(void); // Shuts down the loader threads and destroys the shared cache
+	};
+
+}
+
+#endif
@@ -0,0 +1,168 @@
+/***********************************************************************
+TerrainTilePyramid - Class to access memory-mapped multi-resolution
+pyramids of square height field tiles for out-of-core terrain
+rendering.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/Internal/TerrainTilePyramid.h>
+
+#include <string.h>
+#include <Misc/Endianness.h>
+#include <Misc/ThrowStdErr.h>
+
+namespace SceneGraph {
+
+/*******************************************
+Static elements of class TerrainTilePyramid:
+*******************************************/
+
+const char TerrainTilePyramid::magic[32]="Vrui Terrain Tile Pyramid v1.0\n";
+
+/***********************************
+Methods of class TerrainTilePyramid:
+***********************************/
+
+TerrainTilePyramid::TerrainTilePyramid(const char* fileName)
+	:file(fileName),
+	 tiles(0),tileData(0)
+	{
+	/* Tiles are accessed directly in the memory map: */
+	#if __BYTE_ORDER!=__LITTLE_ENDIAN
+	Misc::throwStdErr("SceneGraph::TerrainTilePyramid: Tile pyramids are not supported on big-endian hosts");
+	#endif
+	file.setEndianness(Misc::LittleEndian);
+	
+	/* Read and check the file header: */
+	char fileMagic[32];
+	file.read(fileMagic,sizeof(fileMagic));
+	if(memcmp(fileMagic,magic,sizeof(magic))!=0)
+		Misc::throwStdErr("SceneGraph::TerrainTilePyramid: File %s is not a terrain tile pyramid",fileName);
+	tileSize=file.read<Misc::UInt32>();
+	unsigned int numLevels=file.read<Misc::UInt32>();
+	for(int i=0;i<2;++i)
+		gridSize[i]=file.read<Misc::UInt32>();
+	for(int i=0;i<2;++i)
+		gridOrigin[i]=file.read<Misc::Float64>();
+	for(int i=0;i<2;++i)
+		cellSize[i]=file.read<Misc::Float64>();
+	haveInvalids=file.read<Misc::UInt32>()!=0;
+	invalidHeight=file.read<Misc::Float32>();
+	IO::SeekableFile::Offset tileDirectoryOffset=file.read<Misc::UInt64>();
+	IO::SeekableFile::Offset tileDataOffset=file.read<Misc::UInt64>();
+	if(tileSize<3||gridSize[0]<2||gridSize[1]<2)
+		Misc::throwStdErr("SceneGraph::TerrainTilePyramid: File %s has invalid grid layout",fileName);
+	
+	/* Read the level table and check it against the grid layout: */
+	levels.reserve(numLevels);
+	for(unsigned int level=0;level<numLevels;++level)
+		{
+		Level l;
+		for(int i=0;i<2;++i)
+			l.numTiles[i]=file.read<Misc::UInt32>();
+		l.firstTile=file.read<Misc::UInt32>();
+		l.step=file.read<Misc::UInt32>();
+		levels.push_back(l);
+		}
+	std::vector<Level> expectedLevels=calcLevels(gridSize,tileSize);
+	bool layoutOk=levels.size()==expectedLevels.size();
+	for(unsigned int level=0;layoutOk&&level<numLevels;++level)
+		layoutOk=memcmp(&levels[level],&expectedLevels[level],sizeof(Level))==0;
+	if(!layoutOk)
+		Misc::throwStdErr("SceneGraph::TerrainTilePyramid: File %s has inconsistent level layout",fileName);
+	
+	/* Check that the tile directory and data lie inside the file: */
+	size_t numTiles=getNumTiles();
+	IO::SeekableFile::Offset tileDirectorySize=IO::SeekableFile::Offset(numTiles*sizeof(Tile));
+	IO::SeekableFile::Offset tileDataSize=IO::SeekableFile::Offset(numTiles*size_t(tileSize)*size_t(tileSize)*sizeof(Misc::Float32));
+	if(tileDirectoryOffset+tileDirectorySize>tileDataOffset||tileDataOffset+tileDataSize>file.getSize())
+		Misc::throwStdErr("SceneGraph::TerrainTilePyramid: File %s is truncated",fileName);
+	
+	/* Access the tile directory and data in the memory map: */
+	const char* memBase=static_cast<const char*>(static_cast<const IO::MemMappedFile&>(file).getMemory());
+	tiles=reinterpret_cast<const Tile*>(memBase+tileDirectoryOffset);
+	tileData=reinterpret_cast<const Misc::Float32*>(memBase+tileDataOffset);
+	}
+
+std::vector<TerrainTilePyramid::Level> TerrainTilePyramid::calcLevels(const unsigned int sGridSize[2],unsigned int sTileSize)
+	{
+	/* Find the number of levels such that the coarsest level fits into a single tile: */
+	unsigned int numLevels=1;
+	unsigned int coarsestStep=1;
+	while((sGridSize[0]-2)/coarsestStep+1>sTileSize-1||(sGridSize[1]-2)/coarsestStep+1>sTileSize-1)
+		{
+		++numLevels;
+		coarsestStep*=2;
+		}
+	
+	/* Create the levels from coarsest to finest: */
+	std::vector<Level> result;
+	result.reserve(numLevels);
+	unsigned int firstTile=0;
+	for(unsigned int step=coarsestStep;step>0;step/=2)
+		{
+		Level l;
+		for(int i=0;i<2;++i)
+			{
+			/* Calculate the number of cells at this level, including a partial cell at the grid edge: */
+			unsigned int numCells=(sGridSize[i]-2)/step+1;
+			l.numTiles[i]=(numCells-1)/(sTileSize-1)+1;
+			}
+		l.firstTile=firstTile;
+		l.step=step;
+		result.push_back(l);
+		firstTile+=l.numTiles[0]*l.numTiles[1];
+		}
+	
+	return result;
+	}
+
+void TerrainTilePyramid::getTileLocation(unsigned int tileIndex,unsigned int& level,unsigned int tileCoords[2]) const
+	{
+	/* Find the tile's level: */
+	level=0;
+	while(level+1<levels.size()&&levels[level+1].firstTile<=tileIndex)
+		++level;
+	
+	/* Calculate the tile's coordinates inside its level: */
+	unsigned int levelIndex=tileIndex-levels[level].firstTile;
+	tileCoords[0]=levelIndex%levels[level].numTiles[0];
+	tileCoords[1]=levelIndex/levels[level].numTiles[0];
+	}
+
+unsigned int TerrainTilePyramid::getChildren(unsigned int tileIndex,unsigned int children[4]) const
+	{
+	/* Check if the tile is at the finest level: */
+	unsigned int level;
+	unsigned int tileCoords[2];
+	getTileLocation(tileIndex,level,tileCoords);
+	if(level+1>=levels.size())
+		return 0;
+	
+	/* Collect the existing children in the next level: */
+	const Level& childLevel=levels[level+1];
+	unsigned int numChildren=0;
+	for(unsigned int cz=tileCoords[1]*2;cz<tileCoords[1]*2+2&&cz<childLevel.numTiles[1];++cz)
+		for(unsigned int cx=tileCoords[0]*2;cx<tileCoords[0]*2+2&&cx<childLevel.numTiles[0];++cx)
+			children[numChildren++]=childLevel.firstTile+cz*childLevel.numTiles[0]+cx;
+	
+	return numChildren;
+	}
+
+}
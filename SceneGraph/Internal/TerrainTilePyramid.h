@@ -0,0 +1,148 @@
+/***********************************************************************
+TerrainTilePyramid - Class to access memory-mapped multi-resolution
+pyramids of square height field tiles for out-of-core terrain
+rendering.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_INTERNAL_TERRAINTILEPYRAMID_INCLUDED
+#define SCENEGRAPH_INTERNAL_TERRAINTILEPYRAMID_INCLUDED
+
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <IO/MemMappedFile.h>
+
+/***********************************************************************
+File layout (all values little-endian):
+- char[32] magic string
+- UInt32 tileSize, UInt32 numLevels, UInt32 gridSize[2]
+- Float64 gridOrigin[2], Float64 cellSize[2]
+- UInt32 haveInvalids, Float32 invalidHeight
+- UInt64 tileDirectoryOffset, UInt64 tileDataOffset
+- numLevels level records, from coarsest to finest level
+- One tile record for each tile, in order of levels and then rows
+- tileSize^2 Float32 heights for each tile, in the same order
+***********************************************************************/
+
+namespace SceneGraph {
+
+class TerrainTilePyramid
+	{
+	/* Embedded classes: */
+	public:
+	static const char magic[32]; // Magic string identifying tile pyramid files
+	
+	struct Level // Structure describing one level of the pyramid
+		{
+		/* Elements: */
+		public:
+		Misc::UInt32 numTiles[2]; // Number of tiles in x and z
+		Misc::UInt32 firstTile; // Index of the level's first tile
+		Misc::UInt32 step; // Distance between adjacent tile samples in full-resolution grid samples
+		};
+	
+	struct Tile // Structure describing one tile of the pyramid
+		{
+		/* Elements: */
+		public:
+		Misc::Float32 minHeight,maxHeight; // Range of valid heights in the tile
+		Misc::Float32 error; // Maximum height difference between the tile and the full-resolution grid over the tile's area
+		Misc::UInt16 size[2]; // Number of samples in x and z that lie inside the grid
+		};
+	
+	/* Elements: */
+	private:
+	IO::MemMappedFile file; // The memory-mapped pyramid file
+	unsigned int tileSize; // Number of samples along each tile edge, 2^n+1
+	unsigned int gridSize[2]; // Number of samples of the full-resolution grid in x and z
+	double gridOrigin[2]; // Map coordinates of the full-resolution grid's first sample
+	double cellSize[2]; // Distance between adjacent full-resolution samples in x and z
+	bool haveInvalids; // Flag whether the grid contains invalid samples
+	float invalidHeight; // Height value of invalid samples
+	std::vector<Level> levels; // Array of pyramid levels, from coarsest to finest
+	const Tile* tiles; // Tile directory in the memory-mapped file
+	const Misc::Float32* tileData; // Tile heights in the memory-mapped file
+	
+	/* Constructors and destructors: */
+	public:
+	TerrainTilePyramid(const char* fileName); // Opens the tile pyramid of the given name
+	private:
+	TerrainTilePyramid(const TerrainTilePyramid& source); // Prohibit copy constructor
+	TerrainTilePyramid& operator=(const TerrainTilePyramid& source); // Prohibit assignment operator
+	
+	/* Methods: */
+	public:
+	static std::vector<Level> calcLevels(const unsigned int sGridSize[2],unsigned int sTileSize); // Returns the pyramid levels for a grid of the given size and the given tile size
+	unsigned int getTileSize(void) const // Returns the number of samples along each tile edge
+		{
+		return tileSize;
+		}
+	unsigned int getGridSize(int dimension) const // Returns the number of full-resolution samples in the given dimension
+		{
+		return gridSize[dimension];
+		}
+	double getGridOrigin(int dimension) const // Returns the map coordinate of the full-resolution grid's first sample in the given dimension
+		{
+		return gridOrigin[dimension];
+		}
+	double getCellSize(int dimension) const // Returns the full-resolution sample distance in the given dimension
+		{
+		return cellSize[dimension];
+		}
+	bool getHaveInvalids(void) const // Returns true if the grid contains invalid samples
+		{
+		return haveInvalids;
+		}
+	float getInvalidHeight(void) const // Returns the height value of invalid samples
+		{
+		return invalidHeight;
+		}
+	unsigned int getNumLevels(void) const // Returns the number of pyramid levels
+		{
+		return levels.size();
+		}
+	const Level& getLevel(unsigned int level) const // Returns the given pyramid level
+		{
+		return levels[level];
+		}
+	unsigned int getNumTiles(void) const // Returns the total number of tiles in the pyramid
+		{
+		const Level& l=levels.back();
+		return l.firstTile+l.numTiles[0]*l.numTiles[1];
+		}
+	const Tile& getTile(unsigned int tileIndex) const // Returns the directory entry of the given tile
+		{
+		return tiles[tileIndex];
+		}
+	const Misc::Float32* getTileHeights(unsigned int tileIndex) const // Returns the heights of the given tile
+		{
+		return tileData+size_t(tileIndex)*size_t(tileSize)*size_t(tileSize);
+		}
+	void getTileLocation(unsigned int tileIndex,unsigned int& level,unsigned int tileCoords[2]) const; // Returns the level and tile coordinates of the given tile
+	unsigned int getSampleIndex(unsigned int level,unsigned int tileCoord,unsigned int sample,int dimension) const // Returns the full-resolution sample index of the given tile sample in the given dimension
+		{
+		unsigned int result=(tileCoord*(tileSize-1)+sample)*levels[level].step;
+		return result<gridSize[dimension]-1?result:gridSize[dimension]-1;
+		}
+	unsigned int getChildren(unsigned int tileIndex,unsigned int children[4]) const; // Writes the indices of the given tile's children into the given array and returns their number
+	};
+
+}
+
+#endif
@@ -0,0 +1,431 @@
+/***********************************************************************
+TiledElevationGrid - Class to render elevation grids from memory-mapped
+multi-resolution tile pyramids, using view-dependent level-of-detail
+selection and background tile loading.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#define GLGEOMETRY_NONSTANDARD_TEMPLATES
+
+#include <SceneGraph/Internal/TiledElevationGrid.h>
+
+#include <utility>
+#include <Math/Math.h>
+#include <GL/GLContextData.h>
+#include <GL/Extensions/GLARBVertexBufferObject.h>
+#include <GL/GLGeometryWrappers.h>
+#include <SceneGraph/ElevationGridNode.h>
+#include <SceneGraph/GLRenderState.h>
+
+namespace SceneGraph {
+
+/*********************************************
+Methods of class TiledElevationGrid::DataItem:
+*********************************************/
+
+TiledElevationGrid::DataItem::DataItem(unsigned int gpuCacheSize)
+	:gpuCache(2,gpuCacheSize)
+	{
+	/* Initialize the vertex buffer object extension: */
+	if(GLARBVertexBufferObject::isSupported())
+		GLARBVertexBufferObject::initExtension();
+	}
+
+/***********************************
+Methods of class TiledElevationGrid:
+***********************************/
+
+Box TiledElevationGrid::calcTileBox(unsigned int tileIndex) const
+	{
+	/* Get the tile's location and extent in full-resolution grid samples: */
+	unsigned int level;
+	unsigned int tileCoords[2];
+	pyramid.getTileLocation(tileIndex,level,tileCoords);
+	const TerrainTilePyramid::Tile& tile=pyramid.getTile(tileIndex);
+	unsigned int min[2],max[2];
+	for(int i=0;i<2;++i)
+		{
+		min[i]=pyramid.getSampleIndex(level,tileCoords[i],0,i);
+		max[i]=pyramid.getSampleIndex(level,tileCoords[i],tile.size[i]-1,i);
+		}
+	
+	/* Calculate the tile's bounding box in grid coordinates: */
+	int hComp=2;
+	int zComp=1;
+	if(node.heightIsY.getValue())
+		std::swap(hComp,zComp);
+	const Point& origin=node.origin.getValue();
+	Point p0,p1;
+	p0[0]=origin[0]+Scalar(min[0])*node.xSpacing.getValue();
+	p1[0]=origin[0]+Scalar(max[0])*node.xSpacing.getValue();
+	p0[zComp]=origin[zComp]+Scalar(min[1])*node.zSpacing.getValue();
+	p1[zComp]=origin[zComp]+Scalar(max[1])*node.zSpacing.getValue();
+	p0[hComp]=origin[hComp]+Scalar(tile.minHeight)*node.heightScale.getValue();
+	p1[hComp]=origin[hComp]+Scalar(tile.maxHeight)*node.heightScale.getValue();
+	Box result=Box::empty;
+	result.addPoint(p0);
+	result.addPoint(p1);
+	
+	/* Transform the box if there is a point transformation: */
+	if(node.pointTransform.getValue()!=0)
+		result=Box(node.pointTransform.getValue()->transformBox(PointTransformNode::TBox(result)));
+	
+	return result;
+	}
+
+void TiledElevationGrid::buildTileMesh(unsigned int tileIndex,TiledElevationGrid::TileMesh& mesh) const
+	{
+	/* Get the tile's layout: */
+	unsigned int level;
+	unsigned int tileCoords[2];
+	pyramid.getTileLocation(tileIndex,level,tileCoords);
+	const TerrainTilePyramid::Tile& tile=pyramid.getTile(tileIndex);
+	unsigned int tileSize=pyramid.getTileSize();
+	unsigned int nx=tile.size[0];
+	unsigned int nz=tile.size[1];
+	const Misc::Float32* heights=pyramid.getTileHeights(tileIndex);
+	bool haveInvalids=pyramid.getHaveInvalids();
+	Misc::Float32 invalidHeight=pyramid.getInvalidHeight();
+	
+	/* Retrieve the rendering parameters: */
+	int hComp=2;
+	int zComp=1;
+	if(node.heightIsY.getValue())
+		std::swap(hComp,zComp);
+	const Point& origin=node.origin.getValue();
+	Scalar xSp=node.xSpacing.getValue();
+	Scalar zSp=node.zSpacing.getValue();
+	Scalar hScale=node.heightScale.getValue();
+	const ColorMapNode* colorMap=node.colorMap.getValue().getPointer();
+	const ImageProjectionNode* imageProjection=node.imageProjection.getValue().getPointer();
+	const PointTransformNode* pointTransform=node.pointTransform.getValue().getPointer();
+	
+	/* Calculate the full-resolution sample indices of the tile's samples: */
+	std::vector<unsigned int> sampleIndices[2];
+	for(int i=0;i<2;++i)
+		for(unsigned int s=0;s<tile.size[i];++s)
+			sampleIndices[i].push_back(pyramid.getSampleIndex(level,tileCoords[i],s,i));
+	Scalar texCoordScale[2];
+	for(int i=0;i<2;++i)
+		texCoordScale[i]=Scalar(1)/Scalar(pyramid.getGridSize(i)-1);
+	
+	/* Calculate the untransformed positions, normals, texture coordinates, and colors of all tile vertices: */
+	size_t numGridVertices=size_t(nx)*size_t(nz);
+	std::vector<Point> points(numGridVertices);
+	std::vector<Vector> normals(numGridVertices);
+	std::vector<Vertex> gridVertices(numGridVertices);
+	for(unsigned int z=0;z<nz;++z)
+		{
+		const Misc::Float32* hRow=heights+z*tileSize;
+		for(unsigned int x=0;x<nx;++x)
+			{
+			size_t vInd=size_t(z)*size_t(nx)+x;
+			
+			/* Calculate the vertex position: */
+			Point& p=points[vInd];
+			p[0]=origin[0]+Scalar(sampleIndices[0][x])*xSp;
+			p[zComp]=origin[zComp]+Scalar(sampleIndices[1][z])*zSp;
+			p[hComp]=origin[hComp]+Scalar(hRow[x])*hScale;
+			
+			/* Calculate the height gradient from the valid neighboring samples: */
+			unsigned int x0=x>0&&!(haveInvalids&&hRow[x-1]==invalidHeight)?x-1:x;
+			unsigned int x1=x<nx-1&&!(haveInvalids&&hRow[x+1]==invalidHeight)?x+1:x;
+			unsigned int z0=z>0&&!(haveInvalids&&hRow[x-tileSize]==invalidHeight)?z-1:z;
+			unsigned int z1=z<nz-1&&!(haveInvalids&&hRow[x+tileSize]==invalidHeight)?z+1:z;
+			Scalar gx=Scalar(0);
+			if(x0!=x1)
+				gx=(Scalar(hRow[x1])-Scalar(hRow[x0]))*hScale/(Scalar(sampleIndices[0][x1]-sampleIndices[0][x0])*xSp);
+			Scalar gz=Scalar(0);
+			if(z0!=z1)
+				gz=(Scalar(heights[z1*tileSize+x])-Scalar(heights[z0*tileSize+x]))*hScale/(Scalar(sampleIndices[1][z1]-sampleIndices[1][z0])*zSp);
+			
+			/* Calculate the vertex normal with the same orientation conventions as the untiled elevation grid: */
+			Vector& n=normals[vInd];
+			if(node.heightIsY.getValue())
+				n=Vector(-gx,Scalar(1),-gz);
+			else
+				n=Vector(gx,gz,Scalar(-1));
+			if(!node.ccw.getValue())
+				n=-n;
+			
+			/* Calculate the vertex texture coordinate: */
+			Vertex& v=gridVertices[vInd];
+			if(imageProjection!=0)
+				v.texCoord=imageProjection->calcTexCoord(p);
+			else
+				v.texCoord=Vertex::TexCoord(Scalar(sampleIndices[0][x])*texCoordScale[0],Scalar(sampleIndices[1][z])*texCoordScale[1]);
+			
+			/* Calculate the vertex color: */
+			if(colorMap!=0)
+				v.color=Vertex::Color(colorMap->mapColor(p[hComp]));
+			else
+				v.color=Vertex::Color(255,255,255);
+			}
+		}
+	
+	/* Calculate the depth of the tile's skirts, which hide cracks between adjacent tiles of different levels: */
+	Scalar skirtDepth=Scalar(tile.error)*Math::abs(hScale)+Scalar(pyramid.getLevel(level).step)*Math::min(Math::abs(xSp),Math::abs(zSp))*Scalar(0.01);
+	
+	/* Collect the tile's edge vertices in order around the tile: */
+	std::vector<unsigned int> edge;
+	for(unsigned int x=0;x<nx-1;++x)
+		edge.push_back(x);
+	for(unsigned int z=0;z<nz-1;++z)
+		edge.push_back(z*nx+nx-1);
+	for(unsigned int x=nx-1;x>0;--x)
+		edge.push_back((nz-1)*nx+x);
+	for(unsigned int z=nz-1;z>0;--z)
+		edge.push_back(z*nx);
+	
+	/* Store the final grid and skirt vertices: */
+	mesh.vertices.reserve(numGridVertices+edge.size());
+	for(size_t i=0;i<numGridVertices+edge.size();++i)
+		{
+		size_t vInd=i<numGridVertices?i:edge[i-numGridVertices];
+		Vertex v=gridVertices[vInd];
+		Point p=points[vInd];
+		if(i>=numGridVertices)
+			p[hComp]-=skirtDepth;
+		if(pointTransform!=0)
+			{
+			v.normal=Vertex::Normal(pointTransform->transformNormal(p,normals[vInd]));
+			v.position=Vertex::Position(pointTransform->transformPoint(p));
+			}
+		else
+			{
+			Vector n=normals[vInd];
+			n.normalize();
+			v.normal=Vertex::Normal(n);
+			v.position=Vertex::Position(p);
+			}
+		mesh.vertices.push_back(v);
+		}
+	
+	/* Triangulate all grid cells whose corners are valid, or which have exactly one invalid corner: */
+	bool ccw=node.ccw.getValue();
+	for(unsigned int z=0;z<nz-1;++z)
+		for(unsigned int x=0;x<nx-1;++x)
+			{
+			/* Collect the cell's valid corners in quad order: */
+			GLuint corners[4];
+			unsigned int cornerIndices[4]={z*nx+x,z*nx+x+1,(z+1)*nx+x+1,(z+1)*nx+x};
+			const Misc::Float32* cornerHeights[4]={heights+(z*tileSize+x),heights+(z*tileSize+x+1),heights+((z+1)*tileSize+x+1),heights+((z+1)*tileSize+x)};
+			int numCorners=0;
+			for(int i=0;i<4;++i)
+				if(!(haveInvalids&&*cornerHeights[i]==invalidHeight))
+					corners[numCorners++]=cornerIndices[i];
+			if(numCorners<3)
+				continue;
+			if(ccw)
+				{
+				/* Reverse the corner order: */
+				std::swap(corners[0],corners[numCorners-1]);
+				if(numCorners==4)
+					std::swap(corners[1],corners[2]);
+				}
+			
+			/* Store the cell's triangles: */
+			mesh.indices.push_back(corners[0]);
+			mesh.indices.push_back(corners[1]);
+			mesh.indices.push_back(corners[2]);
+			if(numCorners==4)
+				{
+				mesh.indices.push_back(corners[0]);
+				mesh.indices.push_back(corners[2]);
+				mesh.indices.push_back(corners[3]);
+				}
+			}
+	
+	/* Store double-sided skirt quads between all edges with valid end points: */
+	for(size_t i=0;i<edge.size();++i)
+		{
+		size_t j=(i+1)%edge.size();
+		unsigned int e0=edge[i];
+		unsigned int e1=edge[j];
+		if(haveInvalids&&(heights[(e0/nx)*tileSize+e0%nx]==invalidHeight||heights[(e1/nx)*tileSize+e1%nx]==invalidHeight))
+			continue;
+		GLuint s0=GLuint(numGridVertices+i);
+		GLuint s1=GLuint(numGridVertices+j);
+		GLuint quad[2][6]={{e0,e1,s1,e0,s1,s0},{e0,s1,e1,e0,s0,s1}};
+		for(int side=0;side<2;++side)
+			for(int k=0;k<6;++k)
+				mesh.indices.push_back(quad[side][k]);
+		}
+	}
+
+StreamingCache::Item* TiledElevationGrid::loadItem(unsigned int itemIndex)
+	{
+	/* Create the tile's mesh from the memory-mapped pyramid: */
+	TileMesh* mesh=new TileMesh;
+	buildTileMesh(itemIndex,*mesh);
+	return mesh;
+	}
+
+void TiledElevationGrid::selectTiles(unsigned int tileIndex,const Box& tileBox,GLRenderState& renderState,StreamingCache::Selection& selection,std::vector<TiledElevationGrid::DrawTile>& drawTiles)
+	{
+	/* Check if the tile's projected geometric error is too large: */
+	unsigned int children[4];
+	unsigned int numChildren=pyramid.getChildren(tileIndex,children);
+	bool refine=false;
+	Box childBoxes[4];
+	bool childVisible[4];
+	if(numChildren>0)
+		{
+		/* Find the point on the tile's bounding box closest to the viewer: */
+		Point viewerPos=renderState.getViewerPos();
+		Point closest;
+		for(int i=0;i<3;++i)
+			closest[i]=Math::clamp(viewerPos[i],tileBox.min[i],tileBox.max[i]);
+		
+		/* Project the tile's geometric error: */
+		Scalar error=Scalar(pyramid.getTile(tileIndex).error)*Math::abs(node.heightScale.getValue());
+		if(renderState.calcProjectedSize(closest,error)>maxPixelError)
+			{
+			/* Refine the tile if all its visible children can be rendered immediately, and request missing children otherwise: */
+			refine=true;
+			unsigned int numUploads=0;
+			for(unsigned int i=0;i<numChildren;++i)
+				{
+				childBoxes[i]=calcTileBox(children[i]);
+				childVisible[i]=renderState.doesBoxIntersectFrustum(childBoxes[i]);
+				if(childVisible[i]&&!selection.isItemReady(children[i],numUploads))
+					{
+					selection.requestItem(children[i]);
+					refine=false;
+					}
+				}
+			
+			/* Keep rendering this tile if uploading its children would exceed this frame's upload budget: */
+			if(refine)
+				refine=selection.reserveUploads(numUploads);
+			}
+		}
+	
+	if(refine)
+		{
+		/* Select the visible children: */
+		for(unsigned int i=0;i<numChildren;++i)
+			if(childVisible[i])
+				selectTiles(children[i],childBoxes[i],renderState,selection,drawTiles);
+		}
+	else
+		{
+		/* Render this tile, and pass its mesh along if it is not yet uploaded into the current context: */
+		drawTiles.push_back(DrawTile(tileIndex,selection.getUploadItem(tileIndex)));
+		}
+	}
+
+TiledElevationGrid::TiledElevationGrid(const ElevationGridNode& sNode,const char* pyramidFileName)
+	:GLObject(false),
+	 node(sNode),
+	 pyramid(pyramidFileName),
+	 maxPixelError(node.maxPixelError.getValue()),
+	 gpuCacheSize(node.tileCacheSize.getValue()>16?node.tileCacheSize.getValue():16),
+	 maxUploadsPerFrame(8),
+	 cache(*this,pyramid.getNumTiles(),gpuCacheSize*2,1)
+	{
+	}
+
+TiledElevationGrid::~TiledElevationGrid(void)
+	{
+	}
+
+void TiledElevationGrid::initContext(GLContextData& contextData) const
+	{
+	/* Create a data item and store it in the context: */
+	DataItem* dataItem=new DataItem(gpuCacheSize);
+	contextData.addDataItem(this,dataItem);
+	}
+
+void TiledElevationGrid::glRenderAction(GLRenderState& renderState)
+	{
+	/* Retrieve the context data item, or create it if the elevation grid was created after the current context was initialized: */
+	DataItem* dataItem=renderState.contextData.retrieveDataItem<DataItem>(this);
+	if(dataItem==0)
+		{
+		dataItem=new DataItem(gpuCacheSize);
+		renderState.contextData.addDataItem(this,dataItem);
+		}
+	if(!GLARBVertexBufferObject::isSupported())
+		return;
+	dataItem->gpuCache.startFrame();
+	
+	/* Select the tiles to render, limiting the number of tiles uploaded in this frame; tiles whose children are not yet uploaded stand in for them: */
+	std::vector<DrawTile> drawTiles;
+	{
+	StreamingCache::Selection selection(cache,dataItem->gpuCache,maxUploadsPerFrame);
+	Box rootBox=calcTileBox(0);
+	if(renderState.doesBoxIntersectFrustum(rootBox))
+		{
+		unsigned int numUploads=0;
+		if(selection.isItemReady(0,numUploads)&&selection.reserveUploads(numUploads))
+			selectTiles(0,rootBox,renderState,selection,drawTiles);
+		else
+			selection.requestItem(0);
+		}
+	}
+	
+	/* Set up OpenGL state: */
+	if(node.solid.getValue())
+		renderState.enableCulling(GL_BACK);
+	else
+		renderState.disableCulling();
+	int vertexArrayParts=Vertex::getPartsMask();
+	if(node.colorMap.getValue()==0)
+		{
+		/* Disable the color vertex array: */
+		vertexArrayParts&=~GLVertexArrayParts::Color;
+		}
+	GLVertexArrayParts::enable(vertexArrayParts);
+	
+	/* Render all selected tiles: */
+	for(std::vector<DrawTile>::iterator dtIt=drawTiles.begin();dtIt!=drawTiles.end();++dtIt)
+		{
+		StreamingCache::GPUItem* gt=dataItem->gpuCache.findItem(dtIt->tileIndex);
+		if(gt==0)
+			{
+			/* Upload the tile's mesh: */
+			gt=&dataItem->gpuCache.addItem(dtIt->tileIndex);
+			const TileMesh& mesh=static_cast<const TileMesh&>(*dtIt->mesh);
+			glBindBufferARB(GL_ARRAY_BUFFER_ARB,gt->bufferIds[0]);
+			glBufferDataARB(GL_ARRAY_BUFFER_ARB,mesh.vertices.size()*sizeof(Vertex),mesh.vertices.empty()?0:&mesh.vertices[0],GL_STATIC_DRAW_ARB);
+			glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,gt->bufferIds[1]);
+			glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,mesh.indices.size()*sizeof(GLuint),mesh.indices.empty()?0:&mesh.indices[0],GL_STATIC_DRAW_ARB);
+			gt->numElements=GLsizei(mesh.indices.size());
+			}
+		else
+			{
+			glBindBufferARB(GL_ARRAY_BUFFER_ARB,gt->bufferIds[0]);
+			glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,gt->bufferIds[1]);
+			}
+		
+		/* Render the tile: */
+		glVertexPointer(static_cast<const Vertex*>(0));
+		glDrawElements(GL_TRIANGLES,gt->numElements,GL_UNSIGNED_INT,0);
+		}
+	
+	/* Reset the vertex arrays: */
+	GLVertexArrayParts::disable(vertexArrayParts);
+	
+	/* Protect the buffers: */
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
+	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
+	}
+
+}
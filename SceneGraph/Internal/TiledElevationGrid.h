@@ -0,0 +1,124 @@
+/***********************************************************************
+TiledElevationGrid - Class to render elevation grids from memory-mapped
+multi-resolution tile pyramids, using view-dependent level-of-detail
+selection and background tile loading.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_INTERNAL_TILEDELEVATIONGRID_INCLUDED
+#define SCENEGRAPH_INTERNAL_TILEDELEVATIONGRID_INCLUDED
+
+#include <vector>
+#include <GL/gl.h>
+#include <GL/GLObject.h>
+#include <GL/GLGeometryVertex.h>
+#include <Geometry/Box.h>
+#include <SceneGraph/Geometry.h>
+#include <SceneGraph/Internal/TerrainTilePyramid.h>
+#include <SceneGraph/Internal/StreamingCache.h>
+
+/* Forward declarations: */
+namespace SceneGraph {
+class ElevationGridNode;
+class GLRenderState;
+}
+
+namespace SceneGraph {
+
+class TiledElevationGrid:public GLObject,private StreamingCache::Loader
+	{
+	/* Embedded classes: */
+	private:
+	typedef GLGeometry::Vertex<Scalar,2,GLubyte,4,Scalar,Scalar,3> Vertex; // Type for tile vertices
+	
+	class TileMesh:public StreamingCache::Item // Class for renderable tile meshes created by the loader thread
+		{
+		/* Elements: */
+		public:
+		std::vector<Vertex> vertices; // Tile vertices, including skirt vertices
+		std::vector<GLuint> indices; // Vertex indices of tile triangles
+		};
+	
+	struct DataItem:public GLObject::DataItem
+		{
+		/* Elements: */
+		public:
+		StreamingCache::GPUCache gpuCache; // Cache of tiles uploaded into this context; each tile has a vertex and an index buffer
+		
+		/* Constructors and destructors: */
+		DataItem(unsigned int gpuCacheSize);
+		};
+	
+	struct DrawTile // Structure for tiles selected for rendering
+		{
+		/* Elements: */
+		public:
+		unsigned int tileIndex; // Index of the tile
+		StreamingCache::ItemPointer mesh; // Tile's mesh if it needs to be uploaded into the current context
+		
+		/* Constructors and destructors: */
+		DrawTile(unsigned int sTileIndex,StreamingCache::ItemPointer sMesh)
+			:tileIndex(sTileIndex),mesh(sMesh)
+			{
+			}
+		};
+	
+	/* Elements: */
+	const ElevationGridNode& node; // Elevation grid node defining the rendering parameters
+	TerrainTilePyramid pyramid; // The memory-mapped tile pyramid
+	Scalar maxPixelError; // Maximum projected geometric error of rendered tiles in pixels
+	unsigned int gpuCacheSize; // Maximum number of tiles kept in each OpenGL context
+	unsigned int maxUploadsPerFrame; // Maximum number of tiles uploaded into an OpenGL context per rendering pass
+	StreamingCache cache; // Shared cache of tile meshes created by a background loader thread
+	
+	/* Private methods: */
+	Box calcTileBox(unsigned int tileIndex) const; // Returns the bounding box of the given tile in model coordinates
+	void buildTileMesh(unsigned int tileIndex,TileMesh& mesh) const; // Creates a renderable mesh for the given tile
+	void selectTiles(unsigned int tileIndex,const Box& tileBox,GLRenderState& renderState,StreamingCache::Selection& selection,std::vector<DrawTile>& drawTiles); // Recursively selects tiles to render within the selection pass's upload budget
+	
+	/* Methods from StreamingCache::Loader: */
+	virtual StreamingCache::Item* loadItem(unsigned int itemIndex);
+	
+	/* Constructors and destructors: */
+	public:
+	TiledElevationGrid(const ElevationGridNode& sNode,const char* pyramidFileName); // Opens the given tile pyramid to render the given elevation grid node
+	private:
+	TiledElevationGrid(const TiledElevationGrid& source); // Prohibit copy constructor
+	TiledElevationGrid& operator=(const TiledElevationGrid& source); // Prohibit assignment operator
+	public:
+	virtual ~TiledElevationGrid(void);
+	
+	/* Methods from GLObject: */
+	virtual void initContext(GLContextData& contextData) const;
+	
+	/* New methods: */
+	const TerrainTilePyramid& getPyramid(void) const // Returns the tile pyramid
+		{
+		return pyramid;
+		}
+	Box calcBoundingBox(void) const // Returns the bounding box of the entire elevation grid in model coordinates
+		{
+		return calcTileBox(0);
+		}
+	void glRenderAction(GLRenderState& renderState); // Renders the elevation grid into the current OpenGL context
+	};
+
+}
+
+#endif
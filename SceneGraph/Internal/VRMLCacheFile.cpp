@@ -0,0 +1,252 @@
+/***********************************************************************
+VRMLCacheFile - Classes to record the token stream of a parsed VRML file
+into a binary cache file, and to replay it from a memory-mapped cache
+file.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/Internal/VRMLCacheFile.h>
+
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <Misc/ThrowStdErr.h>
+#include <IO/StandardFile.h>
+#include <SceneGraph/Geometry.h>
+
+namespace SceneGraph {
+
+/**************************************
+Static elements of class VRMLCacheFile:
+**************************************/
+
+const char VRMLCacheFile::magic[32]="Vrui VRML Cache File v1.0\n";
+
+/********************************
+Methods of class VRMLCacheWriter:
+********************************/
+
+void VRMLCacheWriter::write(const void* data,size_t dataSize)
+	{
+	if(ok)
+		{
+		try
+			{
+			file->writeRaw(data,dataSize);
+			}
+		catch(std::runtime_error)
+			{
+			/* Stop recording; the VRML file itself is still parsed correctly: */
+			ok=false;
+			}
+		}
+	}
+
+VRMLCacheWriter::VRMLCacheWriter(const char* sCacheFileName,Misc::UInt64 sourceSize,Misc::SInt64 sourceModTime)
+	:cacheFileName(sCacheFileName),tempFileName(cacheFileName),
+	 ok(true)
+	{
+	/* Open a temporary file next to the cache file: */
+	char pid[32];
+	snprintf(pid,sizeof(pid),".%d.tmp",int(getpid()));
+	tempFileName.append(pid);
+	file=new IO::StandardFile(tempFileName.c_str(),IO::File::WriteOnly);
+	
+	/* Write the file header: */
+	write(magic,sizeof(magic));
+	Misc::UInt32 header[2];
+	header[0]=byteOrderMarker;
+	header[1]=sizeof(Scalar);
+	write(header,sizeof(header));
+	write(&sourceSize,sizeof(Misc::UInt64));
+	write(&sourceModTime,sizeof(Misc::SInt64));
+	}
+
+VRMLCacheWriter::~VRMLCacheWriter(void)
+	{
+	if(file!=0)
+		{
+		/* Close and remove the incomplete temporary file: */
+		try
+			{
+			file=0;
+			}
+		catch(std::runtime_error)
+			{
+			}
+		unlink(tempFileName.c_str());
+		}
+	}
+
+void VRMLCacheWriter::writeToken(int peekChar,const char* token,size_t tokenSize)
+	{
+	Misc::UInt8 header[2];
+	header[0]=Token;
+	header[1]=Misc::UInt8(peekChar);
+	write(header,sizeof(header));
+	Misc::UInt32 length(tokenSize);
+	write(&length,sizeof(Misc::UInt32));
+	write(token,tokenSize+1);
+	}
+
+void VRMLCacheWriter::writeNumber(double value)
+	{
+	Misc::UInt8 type=Number;
+	write(&type,sizeof(Misc::UInt8));
+	Misc::Float64 number(value);
+	write(&number,sizeof(Misc::Float64));
+	}
+
+void VRMLCacheWriter::writeInteger(int value)
+	{
+	Misc::UInt8 type=Integer;
+	write(&type,sizeof(Misc::UInt8));
+	Misc::SInt32 integer(value);
+	write(&integer,sizeof(Misc::SInt32));
+	}
+
+void VRMLCacheWriter::writeArray(const void* elements,size_t elementSize,size_t numElements)
+	{
+	Misc::UInt8 type=Array;
+	write(&type,sizeof(Misc::UInt8));
+	Misc::UInt32 size(elementSize);
+	write(&size,sizeof(Misc::UInt32));
+	Misc::UInt64 num(numElements);
+	write(&num,sizeof(Misc::UInt64));
+	write(elements,elementSize*numElements);
+	}
+
+void VRMLCacheWriter::finish(void)
+	{
+	/* Write the end marker: */
+	Misc::UInt8 type=End;
+	write(&type,sizeof(Misc::UInt8));
+	
+	/* Flush and close the temporary file: */
+	try
+		{
+		file->flush();
+		file=0;
+		}
+	catch(std::runtime_error)
+		{
+		ok=false;
+		}
+	
+	/* Replace the cache file with the temporary file if it is complete, or remove it otherwise: */
+	if(!ok||rename(tempFileName.c_str(),cacheFileName.c_str())!=0)
+		unlink(tempFileName.c_str());
+	}
+
+/********************************
+Methods of class VRMLCacheReader:
+********************************/
+
+VRMLCacheReader::VRMLCacheReader(const char* cacheFileName)
+	:file(cacheFileName),
+	 recordPtr(0),recordEnd(0)
+	{
+	/* Access the file's contents through the memory map: */
+	const Misc::UInt8* memBase=static_cast<const Misc::UInt8*>(static_cast<const IO::MemMappedFile&>(file).getMemory());
+	size_t memSize=size_t(file.getSize());
+	
+	/* Check the file header: */
+	size_t headerSize=sizeof(magic)+2*sizeof(Misc::UInt32)+sizeof(Misc::UInt64)+sizeof(Misc::SInt64);
+	if(memSize<headerSize||memcmp(memBase,magic,sizeof(magic))!=0)
+		Misc::throwStdErr("SceneGraph::VRMLCacheReader: File %s is not a VRML cache file",cacheFileName);
+	const Misc::UInt8* hPtr=memBase+sizeof(magic);
+	Misc::UInt32 header[2];
+	memcpy(header,hPtr,sizeof(header));
+	hPtr+=sizeof(header);
+	if(header[0]!=byteOrderMarker||header[1]!=sizeof(Scalar))
+		Misc::throwStdErr("SceneGraph::VRMLCacheReader: VRML cache file %s was written by an incompatible host",cacheFileName);
+	memcpy(&sourceSize,hPtr,sizeof(Misc::UInt64));
+	hPtr+=sizeof(Misc::UInt64);
+	memcpy(&sourceModTime,hPtr,sizeof(Misc::SInt64));
+	hPtr+=sizeof(Misc::SInt64);
+	
+	/* Check that the recorded token stream is complete: */
+	if(memSize==headerSize||memBase[memSize-1]!=End)
+		Misc::throwStdErr("SceneGraph::VRMLCacheReader: VRML cache file %s is truncated",cacheFileName);
+	recordPtr=hPtr;
+	recordEnd=memBase+memSize;
+	}
+
+const char* VRMLCacheReader::readToken(size_t& tokenSize)
+	{
+	/* Check the record type and header: */
+	const size_t headerSize=2+sizeof(Misc::UInt32);
+	if(size_t(recordEnd-recordPtr)<headerSize||*recordPtr!=Token)
+		return 0;
+	Misc::UInt32 length;
+	memcpy(&length,recordPtr+2,sizeof(Misc::UInt32));
+	if(size_t(recordEnd-recordPtr)-headerSize<=size_t(length))
+		return 0;
+	
+	/* Return the token in-place: */
+	const char* result=reinterpret_cast<const char*>(recordPtr+headerSize);
+	tokenSize=length;
+	recordPtr+=headerSize+length+1;
+	return result;
+	}
+
+bool VRMLCacheReader::readNumber(double& value)
+	{
+	if(size_t(recordEnd-recordPtr)<1+sizeof(Misc::Float64)||*recordPtr!=Number)
+		return false;
+	Misc::Float64 number;
+	memcpy(&number,recordPtr+1,sizeof(Misc::Float64));
+	value=number;
+	recordPtr+=1+sizeof(Misc::Float64);
+	return true;
+	}
+
+bool VRMLCacheReader::readInteger(int& value)
+	{
+	if(size_t(recordEnd-recordPtr)<1+sizeof(Misc::SInt32)||*recordPtr!=Integer)
+		return false;
+	Misc::SInt32 integer;
+	memcpy(&integer,recordPtr+1,sizeof(Misc::SInt32));
+	value=integer;
+	recordPtr+=1+sizeof(Misc::SInt32);
+	return true;
+	}
+
+const void* VRMLCacheReader::readArray(size_t elementSize,size_t& numElements)
+	{
+	/* Check the record type and header: */
+	const size_t headerSize=1+sizeof(Misc::UInt32)+sizeof(Misc::UInt64);
+	if(size_t(recordEnd-recordPtr)<headerSize||*recordPtr!=Array)
+		return 0;
+	Misc::UInt32 size;
+	memcpy(&size,recordPtr+1,sizeof(Misc::UInt32));
+	Misc::UInt64 num;
+	memcpy(&num,recordPtr+1+sizeof(Misc::UInt32),sizeof(Misc::UInt64));
+	if(size!=elementSize||num>Misc::UInt64(recordEnd-recordPtr-headerSize)/elementSize)
+		return 0;
+	
+	/* Return the element array in-place: */
+	const void* result=recordPtr+headerSize;
+	numElements=size_t(num);
+	recordPtr+=headerSize+numElements*elementSize;
+	return result;
+	}
+
+}
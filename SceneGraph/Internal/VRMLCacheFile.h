@@ -0,0 +1,136 @@
+/***********************************************************************
+VRMLCacheFile - Classes to record the token stream of a parsed VRML file
+into a binary cache file, and to replay it from a memory-mapped cache
+file.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_INTERNAL_VRMLCACHEFILE_INCLUDED
+#define SCENEGRAPH_INTERNAL_VRMLCACHEFILE_INCLUDED
+
+#include <string>
+#include <Misc/SizedTypes.h>
+#include <IO/File.h>
+#include <IO/MemMappedFile.h>
+
+/***********************************************************************
+File layout (all values in host byte order):
+- char[32] magic string
+- UInt32 byte order marker, UInt32 size of SceneGraph::Scalar
+- UInt64 size of the source VRML file, SInt64 modification time of the
+  source VRML file
+- sequence of records, each starting with a UInt8 record type:
+  - Token: UInt8 first character as seen by VRMLFile::peekc(), UInt32
+    token length, token characters, NUL terminator
+  - Number: Float64 value
+  - Integer: SInt32 value
+  - Array: UInt32 element size, UInt64 number of elements, raw element
+    data of a multi-valued field
+  - End: marks the end of the recorded token stream
+***********************************************************************/
+
+namespace SceneGraph {
+
+class VRMLCacheFile
+	{
+	/* Embedded classes: */
+	public:
+	enum RecordType // Enumerated type for record types
+		{
+		End=0,Token,Number,Integer,Array
+		};
+	
+	static const char magic[32]; // Magic string identifying VRML cache files
+	static const Misc::UInt32 byteOrderMarker=0x12345678U; // Marker to detect cache files written on hosts of different byte order
+	};
+
+class VRMLCacheWriter:public VRMLCacheFile // Class to record the token stream of a VRML file while it is being parsed
+	{
+	/* Elements: */
+	private:
+	std::string cacheFileName; // Name of the cache file
+	std::string tempFileName; // Name of the temporary file receiving the cache file's contents until recording is finished
+	IO::FilePtr file; // The temporary file
+	bool ok; // Flag whether all data was written successfully so far
+	
+	/* Private methods: */
+	void write(const void* data,size_t dataSize); // Writes raw data to the temporary file; turns off recording on errors
+	
+	/* Constructors and destructors: */
+	public:
+	VRMLCacheWriter(const char* sCacheFileName,Misc::UInt64 sourceSize,Misc::SInt64 sourceModTime); // Starts recording into a cache file of the given name for a source file of the given size and modification time
+	private:
+	VRMLCacheWriter(const VRMLCacheWriter& source); // Prohibit copy constructor
+	VRMLCacheWriter& operator=(const VRMLCacheWriter& source); // Prohibit assignment operator
+	public:
+	~VRMLCacheWriter(void); // Removes the temporary file if recording did not finish
+	
+	/* Methods: */
+	void writeToken(int peekChar,const char* token,size_t tokenSize); // Records a token
+	void writeNumber(double value); // Records a floating-point number
+	void writeInteger(int value); // Records an integer
+	void writeArray(const void* elements,size_t elementSize,size_t numElements); // Records the raw element array of a multi-valued field
+	void finish(void); // Finishes recording and atomically replaces any previous cache file
+	};
+
+class VRMLCacheReader:public VRMLCacheFile // Class to replay the token stream of a VRML file from a memory-mapped cache file
+	{
+	/* Elements: */
+	private:
+	IO::MemMappedFile file; // The memory-mapped cache file
+	Misc::UInt64 sourceSize; // Size of the source file from which the cache file was recorded
+	Misc::SInt64 sourceModTime; // Modification time of the source file from which the cache file was recorded
+	const Misc::UInt8* recordPtr; // Pointer to the next record to be replayed
+	const Misc::UInt8* recordEnd; // Pointer to the end of the memory-mapped cache file
+	
+	/* Constructors and destructors: */
+	public:
+	VRMLCacheReader(const char* cacheFileName); // Opens the cache file of the given name; throws exception if the file is not a valid cache file for this host
+	private:
+	VRMLCacheReader(const VRMLCacheReader& source); // Prohibit copy constructor
+	VRMLCacheReader& operator=(const VRMLCacheReader& source); // Prohibit assignment operator
+	
+	/* Methods: */
+	public:
+	bool isCurrent(Misc::UInt64 currentSourceSize,Misc::SInt64 currentSourceModTime) const // Returns true if the cache file was recorded from the current version of the source file
+		{
+		return sourceSize==currentSourceSize&&sourceModTime==currentSourceModTime;
+		}
+	bool eof(void) const // Returns true if the entire token stream has been replayed
+		{
+		return recordPtr==recordEnd||*recordPtr==End;
+		}
+	int peekc(void) const // Returns the first character of the next record as it would have been seen by the VRML parser
+		{
+		if(recordPtr==recordEnd||*recordPtr==End)
+			return -1;
+		else if(*recordPtr==Token&&recordEnd-recordPtr>=2)
+			return int(recordPtr[1]);
+		else
+			return '0';
+		}
+	const char* readToken(size_t& tokenSize); // Returns the next token and its length; returns null if the next record is not a token
+	bool readNumber(double& value); // Reads the next floating-point number; returns false if the next record is not a number
+	bool readInteger(int& value); // Reads the next integer; returns false if the next record is not an integer
+	const void* readArray(size_t elementSize,size_t& numElements); // Returns a pointer to the next element array of the given element size and its number of elements; returns null if the next record is not a matching array
+	};
+
+}
+
+#endif
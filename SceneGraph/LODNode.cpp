@@ -90,12 +90,19 @@ void LODNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 		GraphNode::parseField(fieldName,vrmlFile);
 	}
 
+void LODNode::update(void)
+	{
+	/* Recalculate the cached bounding box from the current children: */
+	trackChildBoundingBoxes(level.getValues());
+	updateBoundingBox();
+	}
+
 Box LODNode::calcBoundingBox(void) const
 	{
-	/* Calculate the group's bounding box as the union of the children's boxes: */
+	/* Calculate the group's bounding box as the union of the children's cached boxes: */
 	Box result=Box::empty;
 	for(MFGraphNode::ValueList::const_iterator lIt=level.getValues().begin();lIt!=level.getValues().end();++lIt)
-		result.addBox((*lIt)->calcBoundingBox());
+		result.addBox((*lIt)->getBoundingBox());
 	return result;
 	}
 
@@ -55,6 +55,7 @@ class LODNode:public GraphNode
 	virtual EventOut* getEventOut(const char* fieldName) const;
 	virtual EventIn* getEventIn(const char* fieldName);
 	virtual void parseField(const char* fieldName,VRMLFile& vrmlFile);
+	virtual void update(void);
 	
 	/* Methods from GraphNode: */
 	virtual Box calcBoundingBox(void) const;
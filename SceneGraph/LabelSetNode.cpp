@@ -28,41 +28,19 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Geometry/Vector.h>
 #include <Geometry/Rotation.h>
 #include <GL/gl.h>
-#include <GL/GLTexCoordTemplates.h>
-#include <GL/GLVertexTemplates.h>
-#include <GL/GLContextData.h>
-#include <GL/GLGeometryWrappers.h>
-#include <GL/GLTransformationWrappers.h>
+#include <GL/GLVertexArrayParts.h>
+#include <GL/GLString.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
 
 namespace SceneGraph {
 
-/***************************************
-Methods of class LabelSetNode::DataItem:
-***************************************/
-
-LabelSetNode::DataItem::DataItem(int sNumTextures)
-	:numTextures(sNumTextures),
-	 textureObjectIds(new GLuint[numTextures])
-	{
-	glGenTextures(numTextures,textureObjectIds);
-	}
-
-LabelSetNode::DataItem::~DataItem(void)
-	{
-	glDeleteTextures(numTextures,textureObjectIds);
-	delete[] textureObjectIds;
-	}
-
 /*****************************
 Methods of class LabelSetNode:
 *****************************/
 
 LabelSetNode::LabelSetNode(void)
-	:GLObject(false),
-	 maxExtent(Scalar(0)),
-	 inited(false)
+	:maxExtent(Scalar(0))
 	{
 	}
 
@@ -113,20 +91,22 @@ void LabelSetNode::update(void)
 	FontStyleNode* fs=fontStyle.getValue().getPointer();
 	
 	/* Lay out the strings: */
+	stringBox.clear();
+	glyphVertices.clear();
+	firstGlyphVertices.clear();
 	if(fs->horizontal.getValue())
 		{
 		/* Compute native text boxes for all strings: */
 		Scalar maxWidth=Scalar(0);
 		for(size_t i=0;i<string.getNumValues();++i)
 			{
-			/* Get the string's box and texture coordinate box: */
+			/* Get the string's box: */
 			GLFont::Box sBox=fs->font->calcStringBox(string.getValue(i).c_str());
 			
 			/* Adjust the width to the given value, if there is one: */
 			if(i<length.getNumValues()&&length.getValue(i)>Scalar(0))
 				sBox.size[0]=float(length.getValue(i));
 			stringBox.push_back(sBox);
-			stringTexBox.push_back(fs->font->calcStringTexCoords(string.getValue(i).c_str()));
 			
 			/* Update the maximum string width: */
 			if(maxWidth<Scalar(sBox.size[0]))
@@ -175,14 +155,28 @@ void LabelSetNode::update(void)
 					break;
 				}
 			}
+		
+		/* Create glyph quads for all strings: */
+		static const int quadCorners[4]={0,1,3,2};
+		for(size_t i=0;i<string.getNumValues();++i)
+			{
+			firstGlyphVertices.push_back(glyphVertices.size());
+			std::vector<GLFont::GlyphQuad> quads;
+			fs->font->calcGlyphQuads(GLString(string.getValue(i).c_str(),*fs->font),stringBox[i],quads);
+			for(std::vector<GLFont::GlyphQuad>::iterator qIt=quads.begin();qIt!=quads.end();++qIt)
+				for(int j=0;j<4;++j)
+					{
+					Vertex v;
+					v.texCoord=qIt->texBox.getCorner(quadCorners[j]);
+					v.position=qIt->box.getCorner(quadCorners[j]);
+					glyphVertices.push_back(v);
+					}
+			}
+		firstGlyphVertices.push_back(glyphVertices.size());
 		}
 	
-	/* Register the object with all OpenGL contexts if not done already: */
-	if(!inited)
-		{
-		GLObject::init();
-		inited=true;
-		}
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
 	}
 
 Box LabelSetNode::calcBoundingBox(void) const
@@ -208,11 +202,8 @@ Box LabelSetNode::calcBoundingBox(void) const
 
 void LabelSetNode::glRenderAction(GLRenderState& renderState) const
 	{
-	if(coord.getValue()!=0&&string.getNumValues()>0)
+	if(coord.getValue()!=0&&!glyphVertices.empty())
 		{
-		/* Retrieve the data item from the context: */
-		DataItem* dataItem=renderState.contextData.retrieveDataItem<DataItem>(this);
-		
 		/* Set up OpenGL state: */
 		renderState.disableCulling();
 		renderState.enableTexture2D();
@@ -222,10 +213,14 @@ void LabelSetNode::glRenderAction(GLRenderState& renderState) const
 		glEnable(GL_ALPHA_TEST);
 		glAlphaFunc(GL_GEQUAL,0.5f);
 		
-		/* Draw the label strings as texture-mapped quads billboarded at their point positions: */
+		/* Billboard all labels' glyph quads at their point positions into a single vertex array: */
 		const std::vector<Point>& points=coord.getValue()->point.getValues();
-		size_t numPoints=points.size();
-		for(size_t i=0;i<string.getNumValues()&&i<numPoints;++i)
+		size_t numLabels=firstGlyphVertices.size()-1;
+		if(numLabels>points.size())
+			numLabels=points.size();
+		std::vector<Vertex> vertices;
+		vertices.reserve(firstGlyphVertices[numLabels]);
+		for(size_t i=0;i<numLabels;++i)
 			{
 			/* Calculate the label position: */
 			Point labelPos=points[i];
@@ -243,52 +238,37 @@ void LabelSetNode::glRenderAction(GLRenderState& renderState) const
 				transform*=Rotation::rotateZ(angle);
 				}
 			
-			glPushMatrix();
-			glTranslate(labelPos-Point::origin);
-			glRotate(transform);
+			/* Transform the label's glyph quads: */
+			for(std::vector<Vertex>::const_iterator vIt=glyphVertices.begin()+firstGlyphVertices[i];vIt!=glyphVertices.begin()+firstGlyphVertices[i+1];++vIt)
+				{
+				Vertex v;
+				v.texCoord=vIt->texCoord;
+				Point p=labelPos+transform.transform(Vector(vIt->position[0],vIt->position[1],vIt->position[2]));
+				for(int j=0;j<3;++j)
+					v.position[j]=GLfloat(p[j]);
+				vertices.push_back(v);
+				}
+			}
+		
+		if(!vertices.empty())
+			{
+			/* Bind the font's glyph atlas: */
+			fontStyle.getValue()->font->bindGlyphAtlas(renderState.contextData);
 			
-			/* Draw the label: */
-			glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectIds[i]);
-			glBegin(GL_QUADS);
+			/* Draw the glyphs of all labels as texture-mapped quads: */
+			GLVertexArrayParts::enable(Vertex::getPartsMask());
 			glNormal3f(0.0f,0.0f,1.0f);
-			glTexCoord(stringTexBox[i].getCorner(0));
-			glVertex(stringBox[i].getCorner(0));
-			glTexCoord(stringTexBox[i].getCorner(1));
-			glVertex(stringBox[i].getCorner(1));
-			glTexCoord(stringTexBox[i].getCorner(3));
-			glVertex(stringBox[i].getCorner(3));
-			glTexCoord(stringTexBox[i].getCorner(2));
-			glVertex(stringBox[i].getCorner(2));
-			glEnd();
+			glVertexPointer(&vertices[0]);
+			glDrawArrays(GL_QUADS,0,GLsizei(vertices.size()));
+			GLVertexArrayParts::disable(Vertex::getPartsMask());
 			
-			glPopMatrix();
+			/* Protect the texture object: */
+			glBindTexture(GL_TEXTURE_2D,0);
 			}
 		
-		/* Protect the texture objects: */
-		glBindTexture(GL_TEXTURE_2D,0);
-		
 		/* Reset OpenGL state: */
 		glPopAttrib();
 		}
 	}
 
-void LabelSetNode::initContext(GLContextData& contextData) const
-	{
-	/* Create a data item and store it in the context: */
-	DataItem* dataItem=new DataItem(string.getNumValues());
-	contextData.addDataItem(this,dataItem);
-	
-	/* Upload texture images for all strings: */
-	GLFont::Color background(0.0f,0.0f,0.0f,0.0f);
-	GLFont::Color foreground(1.0f,1.0f,1.0f,1.0f);
-	for(size_t i=0;i<string.getNumValues();++i)
-		{
-		glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectIds[i]);
-		fontStyle.getValue()->font->uploadStringTexture(string.getValue(i).c_str(),background,foreground);
-		}
-	
-	/* Protect the texture objects: */
-	glBindTexture(GL_TEXTURE_2D,0);
-	}
-
 }
@@ -26,8 +26,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <vector>
 #include <Geometry/Box.h>
 #include <GL/gl.h>
+#include <GL/GLVertex.h>
 #include <GL/GLFont.h>
-#include <GL/GLObject.h>
 #include <SceneGraph/FieldTypes.h>
 #include <SceneGraph/GeometryNode.h>
 #include <SceneGraph/CoordinateNode.h>
@@ -35,7 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 namespace SceneGraph {
 
-class LabelSetNode:public GeometryNode,public GLObject
+class LabelSetNode:public GeometryNode
 	{
 	/* Embedded classes: */
 	public:
@@ -43,17 +43,7 @@ class LabelSetNode:public GeometryNode,public GLObject
 	typedef SF<FontStyleNodePointer> SFFontStyleNode;
 	
 	protected:
-	struct DataItem:public GLObject::DataItem
-		{
-		/* Elements: */
-		public:
-		GLsizei numTextures; // Number of texture objects representing the label strings
-		GLuint* textureObjectIds; // Array of IDs of texture objects representing the label strings
-		
-		/* Constructors and destructors: */
-		DataItem(int sNumTextures);
-		virtual ~DataItem(void);
-		};
+	typedef GLVertex<GLfloat,2,void,0,void,GLfloat,3> Vertex; // Type for vertices rendering glyphs from the font's glyph atlas
 	
 	/* Elements: */
 	
@@ -67,9 +57,9 @@ class LabelSetNode:public GeometryNode,public GLObject
 	
 	/* Derived elements: */
 	protected:
-	bool inited; // Flag whether GLObject::init() has already been called
-	std::vector<GLFont::Box> stringBox; // Array of model-space positions and sizes of the quads used to render the strings
-	std::vector<GLFont::TBox> stringTexBox; // Array of texture-space boxes to map the strings to the quads
+	std::vector<GLFont::Box> stringBox; // Array of label-space positions and sizes of the quads used to render the strings
+	std::vector<Vertex> glyphVertices; // Vertex array of glyph quads rendering all strings from the font's glyph atlas in label space
+	std::vector<size_t> firstGlyphVertices; // Index of each string's first glyph vertex, plus the total number of glyph vertices
 	
 	/* Constructors and destructors: */
 	public:
@@ -84,9 +74,6 @@ class LabelSetNode:public GeometryNode,public GLObject
 	/* Methods from GeometryNode: */
 	virtual Box calcBoundingBox(void) const;
 	virtual void glRenderAction(GLRenderState& renderState) const;
-	
-	/* Methods from GLObject: */
-	virtual void initContext(GLContextData& contextData) const;
 	};
 
 }
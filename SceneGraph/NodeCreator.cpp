@@ -46,6 +46,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/CoordinateNode.h>
 #include <SceneGraph/ColorMapNode.h>
 #include <SceneGraph/PointSetNode.h>
+#include <SceneGraph/PointCloudNode.h>
 #include <SceneGraph/IndexedLineSetNode.h>
 #include <SceneGraph/CurveSetNode.h>
 #include <SceneGraph/ElevationGridNode.h>
@@ -96,6 +97,7 @@ NodeCreator::NodeCreator(void)
 	registerNodeType(new GenericNodeFactory<CoordinateNode>());
 	registerNodeType(new GenericNodeFactory<ColorMapNode>());
 	registerNodeType(new GenericNodeFactory<PointSetNode>());
+	registerNodeType(new GenericNodeFactory<PointCloudNode>());
 	registerNodeType(new GenericNodeFactory<IndexedLineSetNode>());
 	registerNodeType(new GenericNodeFactory<CurveSetNode>());
 	registerNodeType(new GenericNodeFactory<ElevationGridNode>());
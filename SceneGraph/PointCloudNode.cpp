@@ -0,0 +1,117 @@
+/***********************************************************************
+PointCloudNode - Class for large point clouds streamed from out-of-core
+multi-resolution octree files as renderable geometry.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/PointCloudNode.h>
+
+#include <string.h>
+#include <Math/Math.h>
+#include <Geometry/Box.h>
+#include <SceneGraph/VRMLFile.h>
+#include <SceneGraph/GLRenderState.h>
+
+namespace SceneGraph {
+
+/*******************************
+Methods of class PointCloudNode:
+*******************************/
+
+PointCloudNode::PointCloudNode(void)
+	:pointSize(Scalar(1)),
+	 pointBudget(1000000),
+	 nodeCacheSize(1024),
+	 numLoaderThreads(2),
+	 octree(0)
+	{
+	}
+
+PointCloudNode::~PointCloudNode(void)
+	{
+	delete octree;
+	}
+
+const char* PointCloudNode::getStaticClassName(void)
+	{
+	return "PointCloud";
+	}
+
+const char* PointCloudNode::getClassName(void) const
+	{
+	return "PointCloud";
+	}
+
+void PointCloudNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
+	{
+	if(strcmp(fieldName,"url")==0)
+		{
+		vrmlFile.parseField(url);
+		
+		/* Fully qualify all URLs: */
+		for(size_t i=0;i<url.getNumValues();++i)
+			url.setValue(i,vrmlFile.getFullUrl(url.getValue(i)));
+		}
+	else if(strcmp(fieldName,"pointSize")==0)
+		vrmlFile.parseField(pointSize);
+	else if(strcmp(fieldName,"pointBudget")==0)
+		vrmlFile.parseField(pointBudget);
+	else if(strcmp(fieldName,"nodeCacheSize")==0)
+		vrmlFile.parseField(nodeCacheSize);
+	else if(strcmp(fieldName,"numLoaderThreads")==0)
+		vrmlFile.parseField(numLoaderThreads);
+	else
+		GeometryNode::parseField(fieldName,vrmlFile);
+	}
+
+void PointCloudNode::update(void)
+	{
+	/* Open the point octree; point transformations are applied in double precision as nodes are loaded. The octree file is memory-mapped, and must therefore be accessible locally on all cluster nodes: */
+	delete octree;
+	octree=0;
+	if(url.getNumValues()>0)
+		octree=new StreamedPointOctree(url.getValue(0).c_str(),pointTransform.getValue(),pointSize.getValue(),size_t(Math::max(pointBudget.getValue(),0)),(unsigned int)(Math::max(nodeCacheSize.getValue(),0)),(unsigned int)(Math::max(numLoaderThreads.getValue(),1)));
+	
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
+	}
+
+Box PointCloudNode::calcBoundingBox(void) const
+	{
+	if(octree!=0)
+		return octree->calcBoundingBox();
+	else
+		return Box::empty;
+	}
+
+void PointCloudNode::glRenderAction(GLRenderState& renderState) const
+	{
+	if(octree!=0)
+		octree->glRenderAction(renderState);
+	}
+
+PointCloudNode::Statistics PointCloudNode::getStatistics(void) const
+	{
+	if(octree!=0)
+		return octree->getStatistics();
+	else
+		return Statistics();
+	}
+
+}
@@ -0,0 +1,76 @@
+/***********************************************************************
+PointCloudNode - Class for large point clouds streamed from out-of-core
+multi-resolution octree files as renderable geometry.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_POINTCLOUDNODE_INCLUDED
+#define SCENEGRAPH_POINTCLOUDNODE_INCLUDED
+
+#include <Misc/Autopointer.h>
+#include <SceneGraph/FieldTypes.h>
+#include <SceneGraph/GeometryNode.h>
+#include <SceneGraph/Internal/StreamedPointOctree.h>
+
+namespace SceneGraph {
+
+class PointCloudNode:public GeometryNode
+	{
+	/* Embedded classes: */
+	public:
+	typedef StreamedPointOctree::Statistics Statistics; // Type for streaming and rendering statistics
+	
+	/* Elements: */
+	
+	/* Fields: */
+	public:
+	MFString url; // URL of a local point octree file created by MakePointOctree
+	SFFloat pointSize; // Rendered point size in pixels; octree nodes are refined until their projected point spacing drops below the point size
+	SFInt pointBudget; // Maximum number of points to render per frame
+	SFInt nodeCacheSize; // Maximum number of octree nodes kept in each OpenGL context
+	SFInt numLoaderThreads; // Number of background threads loading octree nodes
+	
+	/* Derived state: */
+	protected:
+	StreamedPointOctree* octree; // Streaming renderer for the point octree
+	
+	/* Constructors and destructors: */
+	public:
+	PointCloudNode(void); // Creates a default point cloud (no octree, point size 1.0)
+	virtual ~PointCloudNode(void);
+	
+	/* Methods from Node: */
+	static const char* getStaticClassName(void);
+	virtual const char* getClassName(void) const;
+	virtual void parseField(const char* fieldName,VRMLFile& vrmlFile);
+	virtual void update(void);
+	
+	/* Methods from GeometryNode: */
+	virtual Box calcBoundingBox(void) const;
+	virtual void glRenderAction(GLRenderState& renderState) const;
+	
+	/* New methods: */
+	Statistics getStatistics(void) const; // Returns the point cloud's streaming and rendering statistics
+	};
+
+typedef Misc::Autopointer<PointCloudNode> PointCloudNodePointer;
+
+}
+
+#endif
@@ -105,6 +105,9 @@ void PointSetNode::update(void)
 	{
 	/* Bump up the point set's version number: */
 	++version;
+	
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
 	}
 
 Box PointSetNode::calcBoundingBox(void) const
@@ -24,8 +24,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SCENEGRAPH_POINTTRANSFORMNODE_INCLUDED
 #define SCENEGRAPH_POINTTRANSFORMNODE_INCLUDED
 
+#include <stddef.h>
 #include <vector>
 #include <Misc/Autopointer.h>
+#include <Geometry/Point.h>
 #include <SceneGraph/Geometry.h>
 #include <SceneGraph/FieldTypes.h>
 #include <SceneGraph/Node.h>
@@ -48,6 +50,12 @@ class PointTransformNode:public Node
 	/* New methods: */
 	public:
 	virtual TPoint transformPoint(const TPoint& point) const =0; // Transforms a point
+	virtual void transformPoints(Point* points,size_t numPoints) const // Transforms an array of single-precision points in-place
+		{
+		/* Transform all points individually: */
+		for(size_t i=0;i<numPoints;++i)
+			points[i]=transformPoint(points[i]);
+		}
 	virtual TPoint inverseTransformPoint(const TPoint& point) const =0; // Transforms a point with the inverse transformation
 	virtual TBox calcBoundingBox(const std::vector<Point>& points) const =0; // Calculates transformed bounding box of a single-precision point list
 	virtual TBox transformBox(const TBox& box) const =0; // Transforms a bounding box
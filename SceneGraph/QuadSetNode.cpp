@@ -274,6 +274,9 @@ void QuadSetNode::update(void)
 		GLObject::init();
 		inited=true;
 		}
+	
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
 	}
 
 Box QuadSetNode::calcBoundingBox(void) const
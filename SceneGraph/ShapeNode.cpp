@@ -36,6 +36,13 @@ ShapeNode::ShapeNode(void)
 	{
 	}
 
+ShapeNode::~ShapeNode(void)
+	{
+	/* Detach from the geometry node: */
+	if(boundingBoxGeometry!=0)
+		boundingBoxGeometry->removeParent(this);
+	}
+
 const char* ShapeNode::getStaticClassName(void)
 	{
 	return "Shape";
@@ -62,12 +69,27 @@ void ShapeNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void ShapeNode::update(void)
 	{
+	/* Make this node's cached bounding box dependent on the current geometry node's bounding box: */
+	if(boundingBoxGeometry!=geometry.getValue())
+		{
+		if(boundingBoxGeometry!=0)
+			boundingBoxGeometry->removeParent(this);
+		boundingBoxGeometry=geometry.getValue();
+		if(boundingBoxGeometry!=0)
+			boundingBoxGeometry->addParent(this);
+		}
+	
+	/* Recalculate the cached bounding box: */
+	updateBoundingBox();
 	}
 
 Box ShapeNode::calcBoundingBox(void) const
 	{
 	/* Return the geometry node's bounding box: */
-	return geometry.getValue()->calcBoundingBox();
+	if(geometry.getValue()!=0)
+		return geometry.getValue()->calcBoundingBox();
+	else
+		return Box::empty;
 	}
 
 void ShapeNode::glRenderAction(GLRenderState& renderState) const
@@ -85,7 +107,10 @@ void ShapeNode::glRenderAction(GLRenderState& renderState) const
 	
 	/* Render the geometry node: */
 	if(geometry.getValue()!=0)
+		{
 		geometry.getValue()->glRenderAction(renderState);
+		renderState.drawNode();
+		}
 	
 	/* Reset the attribute node's OpenGL state: */
 	if(appearance.getValue()!=0)
@@ -38,6 +38,8 @@ class ShapeNode:public GraphNode
 	typedef SF<GeometryNodePointer> SFGeometryNode;
 	
 	/* Elements: */
+	private:
+	GeometryNodePointer boundingBoxGeometry; // Geometry node whose bounding box is included in this node's cached bounding box
 	
 	/* Fields: */
 	public:
@@ -47,6 +49,7 @@ class ShapeNode:public GraphNode
 	/* Constructors and destructors: */
 	public:
 	ShapeNode(void); // Creates a shape node with default appearance and no geometry
+	virtual ~ShapeNode(void);
 	
 	/* Methods from Node: */
 	static const char* getStaticClassName(void);
@@ -337,6 +337,9 @@ void SphereNode::update(void)
 	{
 	/* Invalidate the display list: */
 	DisplayList::update();
+	
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
 	}
 
 Box SphereNode::calcBoundingBox(void) const
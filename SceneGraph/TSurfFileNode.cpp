@@ -108,7 +108,11 @@ void TSurfFileNode::update(void)
 	
 	/* Do nothing if there is no export file name: */
 	if(url.getNumValues()==0)
+		{
+		/* Recalculate the bounding boxes of all shapes using this geometry: */
+		updateBoundingBox();
 		return;
+		}
 	
 	/* Read the TSurf file: */
 	IO::ValueSource tSurf(Cluster::openFile(multiplexer,url.getValue(0).c_str()));
@@ -165,6 +169,9 @@ void TSurfFileNode::update(void)
 	
 	/* Bump up the mesh version number: */
 	++version;
+	
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
 	}
 
 Box TSurfFileNode::calcBoundingBox(void) const
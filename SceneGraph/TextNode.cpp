@@ -23,39 +23,19 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <string.h>
 #include <GL/gl.h>
-#include <GL/GLTexCoordTemplates.h>
-#include <GL/GLVertexTemplates.h>
-#include <GL/GLContextData.h>
+#include <GL/GLVertexArrayParts.h>
+#include <GL/GLString.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
 
 namespace SceneGraph {
 
-/***********************************
-Methods of class TextNode::DataItem:
-***********************************/
-
-TextNode::DataItem::DataItem(int sNumTextures)
-	:numTextures(sNumTextures),
-	 textureObjectIds(new GLuint[numTextures])
-	{
-	glGenTextures(numTextures,textureObjectIds);
-	}
-
-TextNode::DataItem::~DataItem(void)
-	{
-	glDeleteTextures(numTextures,textureObjectIds);
-	delete[] textureObjectIds;
-	}
-
 /*************************
 Methods of class TextNode:
 *************************/
 
 TextNode::TextNode(void)
-	:GLObject(false),
-	 maxExtent(Scalar(0)),
-	 inited(false)
+	:maxExtent(Scalar(0))
 	{
 	}
 
@@ -102,6 +82,8 @@ void TextNode::update(void)
 	FontStyleNode* fs=fontStyle.getValue().getPointer();
 	
 	/* Lay out the strings: */
+	stringBox.clear();
+	glyphVertices.clear();
 	Point bbOrigin;
 	Size bbSize;
 	if(fs->horizontal.getValue())
@@ -110,14 +92,13 @@ void TextNode::update(void)
 		Scalar maxWidth=Scalar(0);
 		for(size_t i=0;i<string.getNumValues();++i)
 			{
-			/* Get the string's box and texture coordinate box: */
+			/* Get the string's box: */
 			GLFont::Box sBox=fs->font->calcStringBox(string.getValue(i).c_str());
 			
 			/* Adjust the width to the given value, if there is one: */
 			if(i<length.getNumValues()&&length.getValue(i)>Scalar(0))
 				sBox.size[0]=float(length.getValue(i));
 			stringBox.push_back(sBox);
-			stringTexBox.push_back(fs->font->calcStringTexCoords(string.getValue(i).c_str()));
 			
 			/* Update the maximum string width: */
 			if(maxWidth<Scalar(sBox.size[0]))
@@ -197,6 +178,20 @@ void TextNode::update(void)
 			}
 		for(size_t i=0;i<string.getNumValues();++i)
 			stringBox[i].origin[1]=float(base+Scalar(i)*sp);
+		
+		/* Create glyph quads for all strings: */
+		std::vector<GLFont::GlyphQuad> quads;
+		for(size_t i=0;i<string.getNumValues();++i)
+			fs->font->calcGlyphQuads(GLString(string.getValue(i).c_str(),*fs->font),stringBox[i],quads);
+		static const int quadCorners[4]={0,1,3,2};
+		for(std::vector<GLFont::GlyphQuad>::iterator qIt=quads.begin();qIt!=quads.end();++qIt)
+			for(int i=0;i<4;++i)
+				{
+				Vertex v;
+				v.texCoord=qIt->texBox.getCorner(quadCorners[i]);
+				v.position=qIt->box.getCorner(quadCorners[i]);
+				glyphVertices.push_back(v);
+				}
 		}
 	
 	/* Store the bounding box: */
@@ -204,12 +199,8 @@ void TextNode::update(void)
 	bbSize[2]=Scalar(0);
 	boundingBox=Box(bbOrigin,bbSize);
 	
-	/* Register the object with all OpenGL contexts if not done already: */
-	if(!inited)
-		{
-		GLObject::init();
-		inited=true;
-		}
+	/* Recalculate the bounding boxes of all shapes using this geometry: */
+	updateBoundingBox();
 	}
 
 Box TextNode::calcBoundingBox(void) const
@@ -219,11 +210,8 @@ Box TextNode::calcBoundingBox(void) const
 
 void TextNode::glRenderAction(GLRenderState& renderState) const
 	{
-	if(string.getNumValues()>0)
+	if(!glyphVertices.empty())
 		{
-		/* Retrieve the data item from the context: */
-		DataItem* dataItem=renderState.contextData.retrieveDataItem<DataItem>(this);
-		
 		/* Set up OpenGL state: */
 		renderState.disableCulling();
 		renderState.enableTexture2D();
@@ -233,24 +221,17 @@ void TextNode::glRenderAction(GLRenderState& renderState) const
 		glEnable(GL_ALPHA_TEST);
 		glAlphaFunc(GL_GEQUAL,0.5f);
 		
-		/* Draw the strings as texture-mapped quads: */
-		for(size_t i=0;i<string.getNumValues();++i)
-			{
-			glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectIds[i]);
-			glBegin(GL_QUADS);
-			glNormal3f(0.0f,0.0f,1.0f);
-			glTexCoord(stringTexBox[i].getCorner(0));
-			glVertex(stringBox[i].getCorner(0));
-			glTexCoord(stringTexBox[i].getCorner(1));
-			glVertex(stringBox[i].getCorner(1));
-			glTexCoord(stringTexBox[i].getCorner(3));
-			glVertex(stringBox[i].getCorner(3));
-			glTexCoord(stringTexBox[i].getCorner(2));
-			glVertex(stringBox[i].getCorner(2));
-			glEnd();
-			}
+		/* Bind the font's glyph atlas: */
+		fontStyle.getValue()->font->bindGlyphAtlas(renderState.contextData);
+		
+		/* Draw the glyphs of all strings as texture-mapped quads: */
+		GLVertexArrayParts::enable(Vertex::getPartsMask());
+		glNormal3f(0.0f,0.0f,1.0f);
+		glVertexPointer(&glyphVertices[0]);
+		glDrawArrays(GL_QUADS,0,GLsizei(glyphVertices.size()));
+		GLVertexArrayParts::disable(Vertex::getPartsMask());
 		
-		/* Protect the texture objects: */
+		/* Protect the texture object: */
 		glBindTexture(GL_TEXTURE_2D,0);
 		
 		/* Reset OpenGL state: */
@@ -258,23 +239,4 @@ void TextNode::glRenderAction(GLRenderState& renderState) const
 		}
 	}
 
-void TextNode::initContext(GLContextData& contextData) const
-	{
-	/* Create a data item and store it in the context: */
-	DataItem* dataItem=new DataItem(string.getNumValues());
-	contextData.addDataItem(this,dataItem);
-	
-	/* Upload texture images for all strings: */
-	GLFont::Color background(0.0f,0.0f,0.0f,0.0f);
-	GLFont::Color foreground(1.0f,1.0f,1.0f,1.0f);
-	for(size_t i=0;i<string.getNumValues();++i)
-		{
-		glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectIds[i]);
-		fontStyle.getValue()->font->uploadStringTexture(string.getValue(i).c_str(),background,foreground);
-		}
-	
-	/* Protect the texture objects: */
-	glBindTexture(GL_TEXTURE_2D,0);
-	}
-
 }
@@ -25,32 +25,22 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <vector>
 #include <Geometry/Box.h>
 #include <GL/gl.h>
+#include <GL/GLVertex.h>
 #include <GL/GLFont.h>
-#include <GL/GLObject.h>
 #include <SceneGraph/FieldTypes.h>
 #include <SceneGraph/GeometryNode.h>
 #include <SceneGraph/FontStyleNode.h>
 
 namespace SceneGraph {
 
-class TextNode:public GeometryNode,public GLObject
+class TextNode:public GeometryNode
 	{
 	/* Embedded classes: */
 	public:
 	typedef SF<FontStyleNodePointer> SFFontStyleNode;
 	
 	protected:
-	struct DataItem:public GLObject::DataItem
-		{
-		/* Elements: */
-		public:
-		GLsizei numTextures; // Number of texture objects representing the strings
-		GLuint* textureObjectIds; // Array of IDs of texture objects representing the strings
-		
-		/* Constructors and destructors: */
-		DataItem(int sNumTextures);
-		virtual ~DataItem(void);
-		};
+	typedef GLVertex<GLfloat,2,void,0,void,GLfloat,3> Vertex; // Type for vertices rendering glyphs from the font's glyph atlas
 	
 	/* Elements: */
 	
@@ -63,9 +53,8 @@ class TextNode:public GeometryNode,public GLObject
 	
 	/* Derived elements: */
 	protected:
-	bool inited; // Flag whether GLObject::init() has already been called
 	std::vector<GLFont::Box> stringBox; // Array of model-space positions and sizes of the quads used to render the strings
-	std::vector<GLFont::TBox> stringTexBox; // Array of texture-space boxes to map the strings to the quads
+	std::vector<Vertex> glyphVertices; // Vertex array of glyph quads rendering all strings from the font's glyph atlas
 	Box boundingBox; // Bounding box around all strings
 	
 	/* Constructors and destructors: */
@@ -81,9 +70,6 @@ class TextNode:public GeometryNode,public GLObject
 	/* Methods from GeometryNode: */
 	virtual Box calcBoundingBox(void) const;
 	virtual void glRenderAction(GLRenderState& renderState) const;
-	
-	/* Methods from GLObject: */
-	virtual void initContext(GLContextData& contextData) const;
 	};
 
 typedef Misc::Autopointer<TextNode> TextNodePointer;
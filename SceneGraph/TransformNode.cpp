@@ -132,6 +132,10 @@ void TransformNode::update(void)
 		transform*=OGTransform::rotate(rotation.getValue());
 		}
 	transform.renormalize();
+	
+	/* Recalculate the cached bounding box from the current children: */
+	trackChildBoundingBoxes(children.getValues());
+	updateBoundingBox();
 	}
 
 Box TransformNode::calcBoundingBox(void) const
@@ -145,7 +149,7 @@ Box TransformNode::calcBoundingBox(void) const
 		Box result=Box::empty;
 		for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
 			{
-			Box childBox=(*chIt)->calcBoundingBox();
+			Box childBox=(*chIt)->getBoundingBox();
 			childBox.transform(transform);
 			result.addBox(childBox);
 			}
@@ -158,10 +162,9 @@ void TransformNode::glRenderAction(GLRenderState& renderState) const
 	/* Push the transformation onto the matrix stack: */
 	GLRenderState::DOGTransform previousTransform=renderState.pushTransform(transform);
 	
-	/* Call the render actions of all children in order: */
-	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-		(*chIt)->glRenderAction(renderState);
-		
+	/* Call the render actions of all visible children in order: */
+	renderChildren(renderState);
+	
 	/* Pop the transformation off the matrix stack: */
 	renderState.popTransform(previousTransform);
 	}
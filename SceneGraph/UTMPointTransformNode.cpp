@@ -113,6 +113,34 @@ PointTransformNode::TPoint UTMPointTransformNode::transformPoint(const PointTran
 	return TPoint(geodetic[0],geodetic[1],point[2]);
 	}
 
+void UTMPointTransformNode::transformPoints(Point* points,size_t numPoints) const
+	{
+	typedef Geometry::UTMProjection<double>::PPoint PPoint;
+	
+	/* Calculate the angle conversion factor: */
+	TScalar angleScale=degrees.getValue()?TScalar(180)/Math::Constants<TScalar>::pi:TScalar(1);
+	
+	/* Transform the points in blocks using a double-precision buffer: */
+	const size_t blockSize=256;
+	PPoint buffer[blockSize];
+	for(size_t blockStart=0;blockStart<numPoints;blockStart+=blockSize)
+		{
+		size_t blockEnd=blockStart+blockSize<numPoints?blockStart+blockSize:numPoints;
+		PPoint* bPtr=buffer;
+		for(size_t i=blockStart;i<blockEnd;++i,++bPtr)
+			*bPtr=PPoint(points[i][0],points[i][1]);
+		
+		/* Transform the block using the UTM projection object: */
+		projection.mapToGeodetic(buffer,buffer,blockEnd-blockStart);
+		
+		/* Write the transformed points back: */
+		bPtr=buffer;
+		for(size_t i=blockStart;i<blockEnd;++i,++bPtr)
+			for(int j=0;j<2;++j)
+				points[i][j]=Scalar((*bPtr)[j]*angleScale);
+		}
+	}
+
 PointTransformNode::TPoint UTMPointTransformNode::inverseTransformPoint(const PointTransformNode::TPoint& point) const
 	{
 	/* Transform the point using the UTM projection object: */
@@ -22,7 +22,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <SceneGraph/VRMLFile.h>
 
-#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include <Misc/StringPrintf.h>
 #include <Misc/ThrowStdErr.h>
 #include <Geometry/ComponentArray.h>
@@ -32,6 +34,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/EventTypes.h>
 #include <SceneGraph/NodeCreator.h>
 #include <SceneGraph/GraphNode.h>
+#include <SceneGraph/Internal/VRMLCacheFile.h>
 
 namespace SceneGraph {
 
@@ -127,18 +130,7 @@ ScalarParam
 parseFloatingPoint(
 	VRMLFile& vrmlFile)
 	{
-	/* Read the next token: */
-	const char* token=vrmlFile.readNextToken();
-	
-	/* Convert it to floating-point: */
-	char* endPtr=0;
-	ScalarParam result=ScalarParam(strtod(token,&endPtr));
-	
-	/* Ensure that the entire token was converted: */
-	if(endPtr!=token+vrmlFile.getTokenSize())
-		throw VRMLFile::ParseError(vrmlFile,Misc::stringPrintf("%s is not a valid floating-point value",token));
-	
-	return result;
+	return ScalarParam(vrmlFile.parseNumber());
 	}
 
 template <class ComponentArrayParam>
@@ -150,18 +142,7 @@ parseComponentArray(
 	{
 	/* Parse the components of the given component array: */
 	for(int i=0;i<ComponentArrayParam::dimension;++i)
-		{
-		/* Read the next token: */
-		const char* token=vrmlFile.readNextToken();
-		
-		/* Convert it to floating-point: */
-		char* endPtr=0;
-		value[i]=typename ComponentArrayParam::Scalar(strtod(token,&endPtr));
-		
-		/* Ensure that the entire token was converted: */
-		if(endPtr!=token+vrmlFile.getTokenSize())
-			throw VRMLFile::ParseError(vrmlFile,Misc::stringPrintf("%s is not a valid floating-point value",token));
-		}
+		value[i]=typename ComponentArrayParam::Scalar(vrmlFile.parseNumber());
 	}
 
 /***********************************************************
@@ -212,18 +193,7 @@ class ValueParser<int>
 	public:
 	static int parseValue(VRMLFile& vrmlFile)
 		{
-		/* Read the next token: */
-		const char* token=vrmlFile.readNextToken();
-		
-		/* Convert it to integer: */
-		char* endPtr=0;
-		int result=int(strtol(token,&endPtr,10));
-		
-		/* Ensure that the entire token was converted: */
-		if(endPtr!=token+vrmlFile.getTokenSize())
-			throw VRMLFile::ParseError(vrmlFile,Misc::stringPrintf("%s is not a valid integer value",token));
-		
-		return result;
+		return vrmlFile.parseInteger();
 		}
 	};
 
@@ -417,6 +387,83 @@ class ValueParser<NodePointer>
 		}
 	};
 
+/************************************************************
+Helper function to parse value lists from token sources, and
+templatized helper class to parse value lists of plain data types
+in bulk:
+************************************************************/
+
+template <class ValueParam>
+void
+parseValueList(
+	std::vector<ValueParam>& values,
+	VRMLFile& vrmlFile)
+	{
+	/* Clear the value list: */
+	values.clear();
+	
+	/* Check for opening bracket: */
+	if(vrmlFile.peekc()=='[')
+		{
+		/* Skip the opening bracket: */
+		vrmlFile.readNextToken();
+		
+		/* Read a list of values: */
+		while(!vrmlFile.eof()&&vrmlFile.peekc()!=']')
+			{
+			/* Read a single value: */
+			values.push_back(ValueParser<ValueParam>::parseValue(vrmlFile));
+			}
+		
+		/* Skip the closing bracket: */
+		if(vrmlFile.eof())
+			throw VRMLFile::ParseError(vrmlFile,"Missing closing bracket in multi-valued field");
+		vrmlFile.readNextToken();
+		}
+	else
+		{
+		/* Read a single value: */
+		values.push_back(ValueParser<ValueParam>::parseValue(vrmlFile));
+		}
+	}
+
+template <class ValueParam>
+class ValueListParser // Class to parse value lists of plain data types, which can be cached as raw arrays
+	{
+	/* Methods: */
+	public:
+	static void parseValues(std::vector<ValueParam>& values,VRMLFile& vrmlFile)
+		{
+		vrmlFile.parseValueArray(values);
+		}
+	};
+
+template <class ValueParam>
+class GenericValueListParser // Class to parse value lists of types that can not be cached as raw arrays
+	{
+	/* Methods: */
+	public:
+	static void parseValues(std::vector<ValueParam>& values,VRMLFile& vrmlFile)
+		{
+		parseValueList(values,vrmlFile);
+		}
+	};
+
+template <>
+class ValueListParser<bool>:public GenericValueListParser<bool>
+	{
+	};
+
+template <>
+class ValueListParser<std::string>:public GenericValueListParser<std::string>
+	{
+	};
+
+template <>
+class ValueListParser<NodePointer>:public GenericValueListParser<NodePointer>
+	{
+	};
+
 /***********************************************************
 Templatized helper class to parse fields from token sources:
 ***********************************************************/
@@ -453,32 +500,8 @@ class FieldParser<MF<ValueParam> >
 	public:
 	static void parseField(MF<ValueParam>& field,VRMLFile& vrmlFile)
 		{
-		/* Clear the field: */
-		field.clearValues();
-		
-		/* Check for opening bracket: */
-		if(vrmlFile.peekc()=='[')
-			{
-			/* Skip the opening bracket: */
-			vrmlFile.readNextToken();
-			
-			/* Read a list of values: */
-			while(!vrmlFile.eof()&&vrmlFile.peekc()!=']')
-				{
-				/* Read a single value: */
-				field.appendValue(ValueParser<ValueParam>::parseValue(vrmlFile));
-				}
-			
-			/* Skip the closing bracket: */
-			if(vrmlFile.eof())
-				throw VRMLFile::ParseError(vrmlFile,"Missing closing bracket in multi-valued field");
-			vrmlFile.readNextToken();
-			}
-		else
-			{
-			/* Read a single value: */
-			field.appendValue(ValueParser<ValueParam>::parseValue(vrmlFile));
-			}
+		/* Parse the field's value list: */
+		ValueListParser<ValueParam>::parseValues(field.getValues(),vrmlFile);
 		}
 	};
 
@@ -497,13 +520,48 @@ VRMLFile::ParseError::ParseError(const VRMLFile& vrmlFile,std::string error)
 Methods of class VRMLFile:
 *************************/
 
+bool VRMLFile::replayEof(void) const
+	{
+	return cacheReader->eof();
+	}
+
+int VRMLFile::replayPeekc(void) const
+	{
+	return cacheReader->peekc();
+	}
+
+const char* VRMLFile::replayNextToken(void)
+	{
+	cachedToken=cacheReader->readToken(cachedTokenSize);
+	if(cachedToken==0)
+		{
+		cachedToken="";
+		cachedTokenSize=0;
+		throw ParseError(*this,"Corrupted VRML cache file");
+		}
+	
+	return cachedToken;
+	}
+
+const char* VRMLFile::recordNextToken(void)
+	{
+	/* Read the next token and record it together with the character that preceded it: */
+	int peekChar=IO::TokenSource::peekc();
+	const char* token=IO::TokenSource::readNextToken();
+	cacheWriter->writeToken(peekChar,token,IO::TokenSource::getTokenSize());
+	
+	return token;
+	}
+
 VRMLFile::VRMLFile(std::string sSourceUrl,IO::FilePtr sSource,NodeCreator& sNodeCreator,Cluster::Multiplexer* sMultiplexer)
 	:IO::TokenSource(sSource),
 	 sourceUrl(sSourceUrl),
 	 nodeCreator(sNodeCreator),
 	 multiplexer(sMultiplexer),
 	 nodeMap(101),
-	 currentLine(1)
+	 currentLine(1),
+	 useCache(false),cacheWriter(0),cacheReader(0),
+	 cachedToken(""),cachedTokenSize(0)
 	{
 	/* Initialize the token source: */
 	setWhitespace(',',true); // Comma is treated as whitespace
@@ -531,8 +589,55 @@ VRMLFile::VRMLFile(std::string sSourceUrl,IO::FilePtr sSource,NodeCreator& sNode
 			urlPrefix=suIt+1;
 	}
 
+VRMLFile::~VRMLFile(void)
+	{
+	delete cacheWriter;
+	delete cacheReader;
+	}
+
+void VRMLFile::setUseCache(bool newUseCache)
+	{
+	useCache=newUseCache;
+	}
+
 void VRMLFile::parse(GroupNodePointer root)
 	{
+	/* Only cache VRML files that were read from the local file system: */
+	struct stat sourceStat;
+	if(useCache&&multiplexer==0&&stat(sourceUrl.c_str(),&sourceStat)==0&&S_ISREG(sourceStat.st_mode))
+		{
+		std::string cacheFileName=sourceUrl;
+		cacheFileName.append(".cache");
+		
+		/* Replay the VRML file from an existing cache file if it is up-to-date: */
+		try
+			{
+			cacheReader=new VRMLCacheReader(cacheFileName.c_str());
+			if(!cacheReader->isCurrent(Misc::UInt64(sourceStat.st_size),Misc::SInt64(sourceStat.st_mtime)))
+				{
+				delete cacheReader;
+				cacheReader=0;
+				}
+			}
+		catch(std::runtime_error)
+			{
+			/* Ignore missing or invalid cache files: */
+			}
+		
+		if(cacheReader==0)
+			{
+			/* Record a new cache file while parsing the VRML file: */
+			try
+				{
+				cacheWriter=new VRMLCacheWriter(cacheFileName.c_str(),Misc::UInt64(sourceStat.st_size),Misc::SInt64(sourceStat.st_mtime));
+				}
+			catch(std::runtime_error)
+				{
+				/* Parse without caching if the cache file can not be created: */
+				}
+			}
+		}
+	
 	/* Read nodes until end of file: */
 	while(!eof())
 		{
@@ -541,6 +646,101 @@ void VRMLFile::parse(GroupNodePointer root)
 		if(node.getValue()!=0)
 			root->children.appendValue(node.getValue());
 		}
+	
+	if(cacheWriter!=0)
+		{
+		/* Finish recording the cache file: */
+		cacheWriter->finish();
+		delete cacheWriter;
+		cacheWriter=0;
+		}
+	if(cacheReader!=0)
+		{
+		delete cacheReader;
+		cacheReader=0;
+		}
+	}
+
+double VRMLFile::parseNumber(void)
+	{
+	double result;
+	if(cacheReader!=0)
+		{
+		/* Replay the next number: */
+		if(!cacheReader->readNumber(result))
+			throw ParseError(*this,"Corrupted VRML cache file");
+		}
+	else
+		{
+		/* Scan the next number directly from the character source: */
+		skipExtendedWhitespace();
+		if(!IO::TokenSource::readNumber(result))
+			throw ParseError(*this,Misc::stringPrintf("%s is not a valid floating-point value",IO::TokenSource::getToken()));
+		if(cacheWriter!=0)
+			cacheWriter->writeNumber(result);
+		}
+	
+	return result;
+	}
+
+int VRMLFile::parseInteger(void)
+	{
+	int result;
+	if(cacheReader!=0)
+		{
+		/* Replay the next integer: */
+		if(!cacheReader->readInteger(result))
+			throw ParseError(*this,"Corrupted VRML cache file");
+		}
+	else
+		{
+		/* Scan the next integer directly from the character source: */
+		skipExtendedWhitespace();
+		if(!IO::TokenSource::readInteger(result))
+			throw ParseError(*this,Misc::stringPrintf("%s is not a valid integer value",IO::TokenSource::getToken()));
+		if(cacheWriter!=0)
+			cacheWriter->writeInteger(result);
+		}
+	
+	return result;
+	}
+
+template <class ValueParam>
+void
+VRMLFile::parseValueArray(
+	std::vector<ValueParam>& values)
+	{
+	if(cacheReader!=0)
+		{
+		/* Copy the values directly out of the memory-mapped cache file: */
+		size_t numValues;
+		const void* cachedValues=cacheReader->readArray(sizeof(ValueParam),numValues);
+		if(cachedValues==0)
+			throw ParseError(*this,"Corrupted VRML cache file");
+		values.resize(numValues);
+		if(numValues>0)
+			memcpy(&values[0],cachedValues,numValues*sizeof(ValueParam));
+		}
+	else
+		{
+		/* Parse the values without recording them individually: */
+		VRMLCacheWriter* writer=cacheWriter;
+		cacheWriter=0;
+		try
+			{
+			parseValueList(values,*this);
+			}
+		catch(...)
+			{
+			cacheWriter=writer;
+			throw;
+			}
+		cacheWriter=writer;
+		
+		/* Record the values as a raw array: */
+		if(cacheWriter!=0)
+			cacheWriter->writeArray(values.empty()?0:&values[0],sizeof(ValueParam),values.size());
+		}
 	}
 
 template <class ValueParam>
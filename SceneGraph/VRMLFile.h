@@ -23,7 +23,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SCENEGRAPH_VRMLFILE_INCLUDED
 #define SCENEGRAPH_VRMLFILE_INCLUDED
 
+#include <string.h>
 #include <string>
+#include <vector>
 #include <stdexcept>
 #include <Misc/StringHashFunctions.h>
 #include <Misc/HashTable.h>
@@ -39,6 +41,8 @@ class Multiplexer;
 }
 namespace SceneGraph {
 class NodeCreator;
+class VRMLCacheWriter;
+class VRMLCacheReader;
 }
 
 namespace SceneGraph {
@@ -67,6 +71,11 @@ class VRMLFile:public IO::TokenSource
 	Cluster::Multiplexer* multiplexer; // Pointer to a multicast pipe multiplexer when parsing VRML files in a cluster environment
 	NodeMap nodeMap; // Map of named nodes
 	size_t currentLine; // Number of currently processed line
+	bool useCache; // Flag whether to replay the VRML file from a binary cache file, or record one while parsing
+	VRMLCacheWriter* cacheWriter; // Binary cache file into which the VRML file's token stream is recorded while parsing
+	VRMLCacheReader* cacheReader; // Binary cache file from which the VRML file's token stream is replayed
+	const char* cachedToken; // Most recently replayed token
+	size_t cachedTokenSize; // Length of most recently replayed token
 	
 	/* Private methods: */
 	void skipExtendedWhitespace(void) // Skips over "extended" whitespace, i.e., line comments and newlines
@@ -96,32 +105,66 @@ class VRMLFile:public IO::TokenSource
 				break;
 			}
 		}
+	bool replayEof(void) const; // Returns true if the entire cached token stream has been replayed
+	int replayPeekc(void) const; // Returns the first character of the next cached token
+	const char* replayNextToken(void); // Replays the next cached token
+	const char* recordNextToken(void); // Reads the next token and records it in the cache file
 	
 	/* Constructors and destructors: */
 	public:
 	VRMLFile(std::string sSourceUrl,IO::FilePtr sSource,NodeCreator& sNodeCreator,Cluster::Multiplexer* sMultiplexer =0); // Creates a VRML parser for the given character source and node creator
+	~VRMLFile(void);
 	
 	/* Overloaded methods from IO::TokenSource: */
 	bool eof(void)
 		{
+		if(cacheReader!=0)
+			return replayEof();
 		skipExtendedWhitespace();
 		return IO::TokenSource::eof();
 		}
 	int peekc(void)
 		{
+		if(cacheReader!=0)
+			return replayPeekc();
 		skipExtendedWhitespace();
 		return IO::TokenSource::peekc();
 		}
 	const char* readNextToken(void) // Reads the next token while skiping line comments
 		{
+		if(cacheReader!=0)
+			return replayNextToken();
 		skipExtendedWhitespace();
+		if(cacheWriter!=0)
+			return recordNextToken();
 		return IO::TokenSource::readNextToken();
 		}
+	size_t getTokenSize(void) const
+		{
+		return cacheReader!=0?cachedTokenSize:IO::TokenSource::getTokenSize();
+		}
+	const char* getToken(void)
+		{
+		return cacheReader!=0?cachedToken:IO::TokenSource::getToken();
+		}
+	bool isToken(const char* token) const
+		{
+		return cacheReader!=0?strcmp(cachedToken,token)==0:IO::TokenSource::isToken(token);
+		}
 	
-	/* Main method: */
+	/* Main methods: */
+	void setUseCache(bool newUseCache); // Enables or disables replaying the VRML file from a binary cache file next to the source file, which is re-created if it is missing or out of date
+	bool getUseCache(void) const // Returns true if the VRML file is parsed through a binary cache file
+		{
+		return useCache;
+		}
 	void parse(GroupNodePointer root); // Adds top-level nodes from the VRML file to the given group node
 	
 	/* Methods called during parsing: */
+	double parseNumber(void); // Parses a floating-point number from the VRML file
+	int parseInteger(void); // Parses an integer from the VRML file
+	template <class ValueParam>
+	void parseValueArray(std::vector<ValueParam>& values); // Parses the values of a multi-valued field of a plain data type from the VRML file in bulk
 	template <class ValueParam>
 	ValueParam parseValue(void); // Parses a value of the given type from the VRML file
 	template <class FieldParam>
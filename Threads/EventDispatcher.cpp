@@ -27,6 +27,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string.h>
 #include <errno.h>
 #include <unistd.h>
+#if THREADS_CONFIG_HAVE_EPOLL
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#endif
 #include <stdexcept>
 #include <Misc/ThrowStdErr.h>
 
@@ -131,6 +137,40 @@ bool writePipeMessage(const PipeMessage& pm,int pipeFd)
 	return true;
 	}
 
+#if THREADS_CONFIG_HAVE_EPOLL
+
+/* Markers to identify the dispatcher's internal file descriptors in epoll events: */
+char pipeMarker,interruptMarker,timerMarker;
+
+inline uint32_t getEpollEvents(int typeMask) // Converts an input/output event type mask to a set of epoll events
+	{
+	uint32_t result=0x0U;
+	if(typeMask&EventDispatcher::Read)
+		result|=EPOLLIN;
+	if(typeMask&EventDispatcher::Write)
+		result|=EPOLLOUT;
+	if(typeMask&EventDispatcher::Exception)
+		result|=EPOLLPRI;
+	if(typeMask&EventDispatcher::EdgeTriggered)
+		result|=EPOLLET;
+	return result;
+	}
+
+inline int getEventTypes(uint32_t epollEvents) // Converts a set of received epoll events to an input/output event type mask
+	{
+	/* Report errors and hang-ups as readable and writable, like select() does: */
+	int result=0x0;
+	if(epollEvents&(EPOLLIN|EPOLLHUP|EPOLLERR))
+		result|=EventDispatcher::Read;
+	if(epollEvents&(EPOLLOUT|EPOLLERR))
+		result|=EventDispatcher::Write;
+	if(epollEvents&EPOLLPRI)
+		result|=EventDispatcher::Exception;
+	return result;
+	}
+
+#endif
+
 }
 
 /**************************************
@@ -162,6 +202,355 @@ EventDispatcher::Time EventDispatcher::Time::now(void)
 Methods of class EventDispatcher:
 ********************************/
 
+#if THREADS_CONFIG_HAVE_EPOLL
+
+void EventDispatcher::watchIOEventListener(EventDispatcher::IOEventListener* listener)
+	{
+	/* Register the listener's file descriptor with the epoll instance: */
+	struct epoll_event event;
+	memset(&event,0,sizeof(struct epoll_event));
+	event.events=getEpollEvents(listener->typeMask);
+	event.data.ptr=listener;
+	listener->watchedFd=listener->fd;
+	int result=epoll_ctl(epollFd,EPOLL_CTL_ADD,listener->watchedFd,&event);
+	if(result<0&&errno==EEXIST)
+		{
+		/* Another listener already watches the same file descriptor; watch a duplicate instead: */
+		listener->watchedFd=dup(listener->fd);
+		if(listener->watchedFd>=0&&epoll_ctl(epollFd,EPOLL_CTL_ADD,listener->watchedFd,&event)<0)
+			{
+			close(listener->watchedFd);
+			listener->watchedFd=-1;
+			}
+		}
+	else if(result<0)
+		{
+		/* The file descriptor can not be watched: */
+		bool notPollable=errno==EPERM;
+		listener->watchedFd=-1;
+		
+		/* Regular files do not support polling, but select() would always report them as ready: */
+		if(notPollable)
+			pollIOEventListeners.push_back(listener);
+		}
+	
+	ioEventListeners.push_back(listener);
+	}
+
+void EventDispatcher::unwatchIOEventListener(EventDispatcher::IOEventListener* listener)
+	{
+	/* Remove the listener from the lists: */
+	for(std::vector<IOEventListener*>::iterator elIt=ioEventListeners.begin();elIt!=ioEventListeners.end();++elIt)
+		if(*elIt==listener)
+			{
+			*elIt=ioEventListeners.back();
+			ioEventListeners.pop_back();
+			break;
+			}
+	for(std::vector<IOEventListener*>::iterator elIt=pollIOEventListeners.begin();elIt!=pollIOEventListeners.end();++elIt)
+		if(*elIt==listener)
+			{
+			*elIt=pollIOEventListeners.back();
+			pollIOEventListeners.pop_back();
+			break;
+			}
+	
+	if(listener->watchedFd>=0)
+		{
+		/* Unregister the file descriptor; this fails harmlessly if the descriptor was already closed: */
+		epoll_ctl(epollFd,EPOLL_CTL_DEL,listener->watchedFd,0);
+		if(listener->watchedFd!=listener->fd)
+			close(listener->watchedFd);
+		}
+	
+	/* Mark the listener as removed and delete it once all pending events have been handled: */
+	listener->watchedFd=-1;
+	listener->typeMask=0x0;
+	removedIOEventListeners.push_back(listener);
+	}
+
+bool EventDispatcher::dispatchIOEvent(EventDispatcher::IOEventListener* listener,int eventTypeMask)
+	{
+	/* Check all event types for which the listener has registered interest: */
+	bool removeListener=false;
+	eventTypeMask&=listener->typeMask;
+	if(eventTypeMask&Read)
+		removeListener=listener->callback(listener->key,Read,listener->callbackUserData);
+	if(!removeListener&&(eventTypeMask&Write))
+		removeListener=listener->callback(listener->key,Write,listener->callbackUserData);
+	if(!removeListener&&(eventTypeMask&Exception))
+		removeListener=listener->callback(listener->key,Exception,listener->callbackUserData);
+	
+	return removeListener;
+	}
+
+EventDispatcher::EventDispatcher(void)
+	:nextKey(0),
+	 epollFd(-1),interruptFd(-1),timerFd(-1),timerArmed(false)
+	{
+	/* Create the self-pipe: */
+	if(pipe(pipeFds)!=0||pipeFds[0]<0||pipeFds[1]<0)
+		throw std::runtime_error("Misc::EventDispatcher: Cannot open event pipe");
+	
+	/* Create the epoll instance and the interrupt and timer descriptors: */
+	epollFd=epoll_create1(EPOLL_CLOEXEC);
+	interruptFd=eventfd(0,EFD_NONBLOCK|EFD_CLOEXEC);
+	timerFd=timerfd_create(CLOCK_REALTIME,TFD_NONBLOCK|TFD_CLOEXEC);
+	if(epollFd<0||interruptFd<0||timerFd<0)
+		{
+		close(pipeFds[0]);
+		close(pipeFds[1]);
+		if(epollFd>=0)
+			close(epollFd);
+		if(interruptFd>=0)
+			close(interruptFd);
+		if(timerFd>=0)
+			close(timerFd);
+		throw std::runtime_error("Misc::EventDispatcher: Cannot create epoll instance");
+		}
+	
+	/* Watch the read end of the self-pipe and the interrupt and timer descriptors: */
+	struct epoll_event event;
+	memset(&event,0,sizeof(struct epoll_event));
+	event.events=EPOLLIN;
+	event.data.ptr=&pipeMarker;
+	epoll_ctl(epollFd,EPOLL_CTL_ADD,pipeFds[0],&event);
+	event.data.ptr=&interruptMarker;
+	epoll_ctl(epollFd,EPOLL_CTL_ADD,interruptFd,&event);
+	event.data.ptr=&timerMarker;
+	epoll_ctl(epollFd,EPOLL_CTL_ADD,timerFd,&event);
+	}
+
+EventDispatcher::~EventDispatcher(void)
+	{
+	/* Close the self-pipe and the epoll instance: */
+	close(pipeFds[0]);
+	close(pipeFds[1]);
+	close(epollFd);
+	close(interruptFd);
+	close(timerFd);
+	
+	/* Delete all input/output event listeners: */
+	for(std::vector<IOEventListener*>::iterator elIt=ioEventListeners.begin();elIt!=ioEventListeners.end();++elIt)
+		{
+		if((*elIt)->watchedFd>=0&&(*elIt)->watchedFd!=(*elIt)->fd)
+			close((*elIt)->watchedFd);
+		delete *elIt;
+		}
+	for(std::vector<IOEventListener*>::iterator elIt=removedIOEventListeners.begin();elIt!=removedIOEventListeners.end();++elIt)
+		delete *elIt;
+	
+	/* Delete all timer event listeners: */
+	for(TimerEventListenerHeap::Iterator telIt=timerEventListeners.begin();telIt!=timerEventListeners.end();++telIt)
+		delete *telIt;
+	}
+
+bool EventDispatcher::dispatchNextEvent(void)
+	{
+	/* Process the heap of timer event listeners: */
+	bool haveTimerEvent=false;
+	while(!timerEventListeners.isEmpty())
+		{
+		/* Calculate the interval to the next timer event and dispatch elapsed events on-the-fly: */
+		TimerEventListener* tel=timerEventListeners.getSmallest();
+		Time interval=tel->time;
+		interval-=Time::now();
+		
+		/* Check if the event has already elapsed: */
+		if(interval.tv_sec<0)
+			{
+			/* Call the event callback: */
+			if(tel->callback(tel->key,tel->callbackUserData))
+				{
+				/* Remove the event listener from the heap: */
+				delete tel;
+				timerEventListeners.removeSmallest();
+				}
+			else
+				{
+				/* Move the event time to the next iteration: */
+				tel->time+=tel->interval;
+				timerEventListeners.reinsertSmallest();
+				}
+			}
+		else
+			{
+			/* Arm the timer descriptor for the next timer event unless it already is: */
+			if(!timerArmed||armedTime!=tel->time)
+				{
+				struct itimerspec timerSpec;
+				memset(&timerSpec,0,sizeof(struct itimerspec));
+				timerSpec.it_value.tv_sec=tel->time.tv_sec;
+				timerSpec.it_value.tv_nsec=tel->time.tv_usec*1000L;
+				timerfd_settime(timerFd,TFD_TIMER_ABSTIME,&timerSpec,0);
+				timerArmed=true;
+				armedTime=tel->time;
+				}
+			haveTimerEvent=true;
+			
+			/* Done dispatching timer events: */
+			break;
+			}
+		}
+	if(!haveTimerEvent&&timerArmed)
+		{
+		/* Disarm the timer descriptor: */
+		struct itimerspec timerSpec;
+		memset(&timerSpec,0,sizeof(struct itimerspec));
+		timerfd_settime(timerFd,0,&timerSpec,0);
+		timerArmed=false;
+		}
+	
+	/* Wait for the next event on any watched file descriptor; don't block if there are always-ready listeners: */
+	struct epoll_event events[64];
+	int numEvents=epoll_wait(epollFd,events,64,pollIOEventListeners.empty()?-1:0);
+	if(numEvents<0&&errno!=EINTR)
+		{
+		int error=errno;
+		Misc::throwStdErr("Misc::EventDispatcher::dispatchNextEvent: Error %d (%s) during epoll_wait",error,strerror(error));
+		}
+	
+	/* Handle all received events: */
+	bool stopped=false;
+	for(int eventIndex=0;eventIndex<numEvents;++eventIndex)
+		{
+		void* eventPtr=events[eventIndex].data.ptr;
+		if(eventPtr==&interruptMarker)
+			{
+			/* Reset the interrupt descriptor; interrupts have no other effect: */
+			uint64_t counter;
+			if(read(interruptFd,&counter,sizeof(uint64_t))<0)
+				;
+			}
+		else if(eventPtr==&timerMarker)
+			{
+			/* Reset the timer descriptor; elapsed timer events will be dispatched on the next call: */
+			uint64_t numExpirations;
+			if(read(timerFd,&numExpirations,sizeof(uint64_t))>0)
+				timerArmed=false;
+			}
+		else if(eventPtr==&pipeMarker)
+			{
+			/* Read the pipe message: */
+			PipeMessage pm;
+			if(!readPipeMessage(pipeFds[0],pm))
+				{
+				int error=errno;
+				Misc::throwStdErr("Misc::EventDispatcher::dispatchNextEvent: Fatal error %d (%s) while reading command",error,strerror(error));
+				}
+			switch(pm.messageType)
+				{
+				case PipeMessage::STOP: // Stop dispatching events
+					stopped=true;
+					break;
+				
+				case PipeMessage::ADD_IO_LISTENER: // Add input/output event listener
+					watchIOEventListener(new IOEventListener(pm.addIOListener.key,pm.addIOListener.fd,pm.addIOListener.typeMask,pm.addIOListener.callback,pm.addIOListener.callbackUserData));
+					break;
+				
+				case PipeMessage::REMOVE_IO_LISTENER: // Remove input/output event listener
+					{
+					/* Find the input/output event listener with the given key: */
+					std::vector<IOEventListener*>::iterator elIt;
+					for(elIt=ioEventListeners.begin();elIt!=ioEventListeners.end()&&(*elIt)->key!=pm.removeIOListener;++elIt)
+						;
+					if(elIt!=ioEventListeners.end())
+						unwatchIOEventListener(*elIt);
+					break;
+					}
+				
+				case PipeMessage::ADD_TIMER_LISTENER: // Add timer event listener
+					/* Add the new timer event listener to the heap: */
+					timerEventListeners.insert(new TimerEventListener(pm.addTimerListener.key,pm.addTimerListener.time,pm.addTimerListener.interval,pm.addTimerListener.callback,pm.addTimerListener.callbackUserData));
+					
+					break;
+				
+				case PipeMessage::REMOVE_TIMER_LISTENER: // Remove timer event listener
+					{
+					/* Find the timer event listener with the given key: */
+					TimerEventListenerHeap::Iterator elIt;
+					for(elIt=timerEventListeners.begin();elIt!=timerEventListeners.end()&&(*elIt)->key!=pm.removeTimerListener;++elIt)
+						;
+					if(elIt!=timerEventListeners.end())
+						{
+						/* Remove the timer event listener from the heap: */
+						delete *elIt;
+						timerEventListeners.remove(elIt);
+						}
+					
+					break;
+					}
+				
+				case PipeMessage::ADD_PROCESS_LISTENER:
+					/* Add the new process listener to the list: */
+					processListeners.push_back(ProcessListener(pm.addProcessListener.key,pm.addProcessListener.callback,pm.addProcessListener.callbackUserData));
+					
+					break;
+				
+				case PipeMessage::REMOVE_PROCESS_LISTENER:
+					{
+					/* Find the process listener with the given key: */
+					std::vector<ProcessListener>::iterator plIt;
+					for(plIt=processListeners.begin();plIt!=processListeners.end()&&plIt->key!=pm.removeProcessListener;++plIt)
+						;
+					if(plIt!=processListeners.end())
+						{
+						/* Remove the process listener from the list: */
+						*plIt=*(processListeners.end()-1);
+						processListeners.pop_back();
+						}
+					
+					break;
+					}
+				
+				default:
+					/* Do nothing: */
+					;
+				}
+			}
+		else
+			{
+			/* Skip listeners that were removed while handling earlier events: */
+			IOEventListener* listener=static_cast<IOEventListener*>(eventPtr);
+			if(listener->watchedFd>=0&&dispatchIOEvent(listener,getEventTypes(events[eventIndex].events)))
+				unwatchIOEventListener(listener);
+			}
+		}
+	
+	/* Handle all listeners whose file descriptors are always ready: */
+	for(size_t i=0;i<pollIOEventListeners.size();++i)
+		if(dispatchIOEvent(pollIOEventListeners[i],Read|Write))
+			{
+			unwatchIOEventListener(pollIOEventListeners[i]);
+			--i;
+			}
+	
+	/* Delete all listeners that were removed during this dispatch: */
+	for(std::vector<IOEventListener*>::iterator elIt=removedIOEventListeners.begin();elIt!=removedIOEventListeners.end();++elIt)
+		delete *elIt;
+	removedIOEventListeners.clear();
+	
+	if(stopped)
+		return false;
+	
+	/* Call all process listeners: */
+	for(std::vector<ProcessListener>::iterator plIt=processListeners.begin();plIt!=processListeners.end();++plIt)
+		{
+		/* Call the listener and check if it wants to be removed: */
+		if(plIt->callback(plIt->key,plIt->callbackUserData))
+			{
+			/* Remove the event listener from the list: */
+			*plIt=processListeners.back();
+			processListeners.pop_back();
+			--plIt;
+			}
+		}
+	
+	return true;
+	}
+
+#else
+
 EventDispatcher::EventDispatcher(void)
 	:nextKey(0),
 	 numReadFds(0),numWriteFds(0),numExceptionFds(0),
@@ -497,6 +886,8 @@ bool EventDispatcher::dispatchNextEvent(void)
 	return true;
 	}
 
+#endif
+
 void EventDispatcher::dispatchEvents(void)
 	{
 	/* Dispatch events until the stop() method is called: */
@@ -506,6 +897,15 @@ void EventDispatcher::dispatchEvents(void)
 
 void EventDispatcher::interrupt(void)
 	{
+	#if THREADS_CONFIG_HAVE_EPOLL
+	/* Signal the interrupt descriptor; multiple pending interrupts collapse into one: */
+	uint64_t one=1U;
+	if(write(interruptFd,&one,sizeof(uint64_t))<0&&errno!=EAGAIN)
+		{
+		int error=errno;
+		Misc::throwStdErr("EventDispatcher::interrupt: Fatal error %d (%s) while writing command",error,strerror(error));
+		}
+	#else
 	/* Lock the self-pipe: */
 	Threads::Spinlock::Lock pipeLock(pipeMutex);
 	
@@ -518,6 +918,7 @@ void EventDispatcher::interrupt(void)
 		int error=errno;
 		Misc::throwStdErr("EventDispatcher::interrupt: Fatal error %d (%s) while writing command",error,strerror(error));
 		}
+	#endif
 	}
 
 void EventDispatcher::stop(void)
@@ -30,6 +30,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #endif
 #include <vector>
 #include <Misc/PriorityHeap.h>
+#include <Threads/Config.h>
 #include <Threads/Spinlock.h>
 
 namespace Threads {
@@ -42,7 +43,8 @@ class EventDispatcher
 	
 	enum IOEventType // Enumerated type for input/output event types
 		{
-		Read=0x01,Write=0x02,Exception=0x04
+		Read=0x01,Write=0x02,Exception=0x04,
+		EdgeTriggered=0x08 // Flag to request notification only when a file descriptor becomes ready; callbacks must then read or write until the descriptor would block. Ignored if the dispatcher does not support it
 		};
 	
 	class Time:public timeval // Class to specify time points or time intervals for timer events; microseconds are assumed in [0, 1000000) even if interval is negative
@@ -122,10 +124,16 @@ class EventDispatcher
 		int typeMask; // Mask of event types (read, write, exception) in which the listener is interested
 		IOEventCallback callback; // Function called when an event occurs
 		void* callbackUserData; // Opaque pointer to be passed to callback function
+		#if THREADS_CONFIG_HAVE_EPOLL
+		int watchedFd; // File descriptor registered with the epoll instance; a duplicate of fd if another listener already watches fd, or -1 if the listener has been removed
+		#endif
 		
 		/* Constructors and destructors: */
 		IOEventListener(ListenerKey sKey,int sFd,int sTypeMask,IOEventCallback sCallback,void* sCallbackUserData)
 			:key(sKey),fd(sFd),typeMask(sTypeMask),callback(sCallback),callbackUserData(sCallbackUserData)
+			#if THREADS_CONFIG_HAVE_EPOLL
+			 ,watchedFd(-1)
+			#endif
 			{
 			}
 		};
@@ -179,13 +187,33 @@ class EventDispatcher
 	Spinlock pipeMutex; // Mutex protecting the self-pipe used to change the dispatcher's internal state
 	int pipeFds[2]; // A uni-directional unnamed pipe to trigger events internal to the dispatcher
 	ListenerKey nextKey; // Next key to be assigned to an event listener
+	#if THREADS_CONFIG_HAVE_EPOLL
+	int epollFd; // File descriptor of the epoll instance watching the self-pipe, the interrupt and timer descriptors, and all listeners' file descriptors
+	int interruptFd; // Event file descriptor used to interrupt the dispatcher without going through the self-pipe
+	int timerFd; // Timer file descriptor armed to the time of the next timer event
+	bool timerArmed; // Flag whether the timer file descriptor is currently armed
+	Time armedTime; // Time point to which the timer file descriptor is currently armed
+	std::vector<IOEventListener*> ioEventListeners; // List of currently registered input/output event listeners
+	std::vector<IOEventListener*> pollIOEventListeners; // List of input/output event listeners whose file descriptors can not be watched by epoll and are always considered ready
+	std::vector<IOEventListener*> removedIOEventListeners; // List of input/output event listeners removed during the current dispatch, to be deleted once all events are handled
+	#else
 	std::vector<IOEventListener> ioEventListeners; // List of currently registered input/output event listeners
+	#endif
 	TimerEventListenerHeap timerEventListeners; // Heap of currently registered timer event listeners, sorted by next event time
 	std::vector<ProcessListener> processListeners; // List of currently registered process event listeners
+	#if !THREADS_CONFIG_HAVE_EPOLL
 	fd_set readFds,writeFds,exceptionFds; // Three sets of file descriptors waiting for reads, writes, and exceptions, respectively
 	int numReadFds,numWriteFds,numExceptionFds; // Number of file descriptors in the three descriptor sets
 	int maxFd; // Largest file descriptor set in any of the three descriptor sets
 	bool hadBadFd; // Flag if the last invocation of dispatchNextEvent() tripped on a bad file descriptor
+	#endif
+	
+	/* Private methods: */
+	#if THREADS_CONFIG_HAVE_EPOLL
+	void watchIOEventListener(IOEventListener* listener); // Registers the given new input/output event listener with the epoll instance
+	void unwatchIOEventListener(IOEventListener* listener); // Unregisters the given input/output event listener and schedules it for deletion
+	static bool dispatchIOEvent(IOEventListener* listener,int eventTypeMask); // Calls the given listener's callback for all given event types in which it is interested; returns true if the listener wants to be removed
+	#endif
 	
 	/* Constructors and destructors: */
 	public:
@@ -0,0 +1,113 @@
+/***********************************************************************
+ParallelFor - Helper function to execute a loop over a range of indices
+in parallel, by recursively splitting the range into chunks executed by
+a task pool.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_PARALLELFOR_INCLUDED
+#define THREADS_PARALLELFOR_INCLUDED
+
+#include <Threads/TaskPool.h>
+
+namespace Threads {
+
+template <class BodyParam>
+class ParallelForTask:public TaskPool::Task // Task executing a loop body over a sub-range of indices
+	{
+	/* Elements: */
+	private:
+	TaskPool::TaskGroup& group; // Task group to which split-off sub-ranges are submitted
+	int begin,end; // Index range to process
+	int grainSize; // Maximum size of index ranges that are not split further
+	const BodyParam& body; // Loop body; must be callable as body(begin,end) from multiple threads concurrently
+	
+	/* Constructors and destructors: */
+	public:
+	ParallelForTask(TaskPool::TaskGroup& sGroup,int sBegin,int sEnd,int sGrainSize,const BodyParam& sBody)
+		:group(sGroup),begin(sBegin),end(sEnd),grainSize(sGrainSize),body(sBody)
+		{
+		}
+	
+	/* Methods from TaskPool::Task: */
+	virtual void execute(void)
+		{
+		/* Split off the upper halves of the range until it is small enough, so that idle threads steal large chunks first: */
+		while(end-begin>grainSize)
+			{
+			int mid=begin+(end-begin)/2;
+			group.run(new ParallelForTask(group,mid,end,grainSize,body));
+			end=mid;
+			}
+		
+		/* Process the remaining range: */
+		body(begin,end);
+		}
+	};
+
+template <class BodyParam>
+inline
+void
+parallelFor(
+	TaskPool& pool,
+	int begin,
+	int end,
+	int grainSize,
+	const BodyParam& body) // Calls body(b,e) on disjoint sub-ranges [b,e) covering [begin,end) of at most grainSize indices from multiple threads; throws std::runtime_error if any call threw an exception
+	{
+	if(grainSize<1)
+		grainSize=1;
+	
+	/* Run the loop in the calling thread if it is too small to split, or if the pool has no worker threads: */
+	if(end-begin<=grainSize||pool.getNumWorkers()==0)
+		{
+		if(begin<end)
+			body(begin,end);
+		return;
+		}
+	
+	/* Submit the entire range as a single task and help executing it: */
+	TaskPool::TaskGroup group(pool);
+	group.run(new ParallelForTask<BodyParam>(group,begin,end,grainSize,body));
+	group.wait();
+	}
+
+template <class BodyParam>
+inline
+void
+parallelFor(
+	int begin,
+	int end,
+	int grainSize,
+	const BodyParam& body) // Ditto, using the global task pool
+	{
+	/* Don't create the global task pool for loops that will not be split anyway: */
+	if(end-begin<=grainSize)
+		{
+		if(begin<end)
+			body(begin,end);
+		return;
+		}
+	
+	parallelFor(TaskPool::getGlobalPool(),begin,end,grainSize,body);
+	}
+
+}
+
+#endif
@@ -0,0 +1,315 @@
+/***********************************************************************
+TaskPool - Class for pools of worker threads executing groups of
+independent tasks, using per-worker task deques and work stealing to
+balance load.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Threads/TaskPool.h>
+
+#include <unistd.h>
+#include <stdexcept>
+
+namespace Threads {
+
+/*******************************************
+Methods of class TaskPool::TaskGroup:
+*******************************************/
+
+void TaskPool::TaskGroup::taskFinished(void)
+	{
+	/* Wake up all waiting threads if this was the last pending task: */
+	MutexCond::Lock finishedLock(finishedCond);
+	if(--numPendingTasks==0)
+		finishedCond.broadcast();
+	}
+
+void TaskPool::TaskGroup::taskFailed(const char* message)
+	{
+	/* Remember the first error message: */
+	MutexCond::Lock finishedLock(finishedCond);
+	if(!failed)
+		{
+		failed=true;
+		errorMessage=message;
+		}
+	}
+
+void TaskPool::TaskGroup::waitForTasks(void)
+	{
+	TaskPool::Worker* worker=pool.getCurrentWorker();
+	while(true)
+		{
+		/* Check if all tasks finished; checking under the lock ensures that the last task is done with the group: */
+		{
+		MutexCond::Lock finishedLock(finishedCond);
+		if(numPendingTasks==0)
+			break;
+		}
+		
+		/* Execute a queued task from any group, or sleep until the group's remaining tasks finish: */
+		Task* task=pool.fetchTask(worker);
+		if(task!=0)
+			pool.runTask(task);
+		else
+			{
+			MutexCond::Lock finishedLock(finishedCond);
+			if(numPendingTasks!=0)
+				finishedCond.wait(finishedLock);
+			}
+		}
+	}
+
+TaskPool::TaskGroup::TaskGroup(TaskPool& sPool)
+	:pool(sPool),
+	 numPendingTasks(0),failed(false)
+	{
+	}
+
+TaskPool::TaskGroup::~TaskGroup(void)
+	{
+	/* Wait for all pending tasks, which still reference the group: */
+	waitForTasks();
+	}
+
+void TaskPool::TaskGroup::run(TaskPool::Task* task)
+	{
+	/* Add the task to the group: */
+	task->group=this;
+	{
+	MutexCond::Lock finishedLock(finishedCond);
+	++numPendingTasks;
+	}
+	
+	/* Queue the task: */
+	pool.submit(task);
+	}
+
+void TaskPool::TaskGroup::wait(void)
+	{
+	/* Wait for all pending tasks: */
+	waitForTasks();
+	
+	/* Report and reset any task errors: */
+	if(failed)
+		{
+		std::string message=errorMessage;
+		failed=false;
+		errorMessage.clear();
+		throw std::runtime_error(message);
+		}
+	}
+
+/*********************************
+Static elements of class TaskPool:
+*********************************/
+
+Mutex TaskPool::globalPoolMutex;
+unsigned int TaskPool::globalPoolNumWorkers=~0U;
+TaskPool* TaskPool::globalPool=0;
+
+/*************************
+Methods of class TaskPool:
+*************************/
+
+void TaskPool::submit(TaskPool::Task* task)
+	{
+	/* Push the task onto the calling worker's deque, or onto the submission queue if the caller is not a worker: */
+	Worker* worker=getCurrentWorker();
+	if(worker!=0)
+		{
+		Spinlock::Lock dequeLock(worker->dequeMutex);
+		worker->deque.push_back(task);
+		}
+	else
+		{
+		Spinlock::Lock submitLock(submitMutex);
+		submitQueue.push_back(task);
+		}
+	numQueuedTasks.preAdd(1);
+	
+	/* Wake up an idle worker thread: */
+	MutexCond::Lock idleLock(idleCond);
+	idleCond.signal();
+	}
+
+TaskPool::Task* TaskPool::fetchTask(TaskPool::Worker* worker)
+	{
+	Task* result=0;
+	
+	/* Pop the most recently submitted task from the worker's own deque: */
+	unsigned int firstVictim=0;
+	if(worker!=0)
+		{
+		Spinlock::Lock dequeLock(worker->dequeMutex);
+		if(!worker->deque.empty())
+			{
+			result=worker->deque.back();
+			worker->deque.pop_back();
+			}
+		firstVictim=(worker-workers)+1;
+		}
+	
+	/* Steal the oldest task from another worker's deque, starting with the next worker: */
+	for(unsigned int i=0;result==0&&i<numWorkers;++i)
+		{
+		Worker* victim=&workers[(firstVictim+i)%numWorkers];
+		if(victim!=worker)
+			{
+			Spinlock::Lock dequeLock(victim->dequeMutex);
+			if(!victim->deque.empty())
+				{
+				result=victim->deque.front();
+				victim->deque.pop_front();
+				}
+			}
+		}
+	
+	/* Take the oldest task from the submission queue: */
+	if(result==0)
+		{
+		Spinlock::Lock submitLock(submitMutex);
+		if(!submitQueue.empty())
+			{
+			result=submitQueue.front();
+			submitQueue.pop_front();
+			}
+		}
+	
+	if(result!=0)
+		numQueuedTasks.preSub(1);
+	
+	return result;
+	}
+
+void TaskPool::runTask(TaskPool::Task* task)
+	{
+	/* Execute the task and catch any exceptions: */
+	TaskGroup* group=task->group;
+	try
+		{
+		task->execute();
+		}
+	catch(const std::exception& err)
+		{
+		group->taskFailed(err.what());
+		}
+	catch(...)
+		{
+		group->taskFailed("Threads::TaskPool: Task threw unknown exception");
+		}
+	
+	/* Delete the task and notify its group: */
+	delete task;
+	group->taskFinished();
+	}
+
+void* TaskPool::workerThreadMethod(TaskPool::Worker* worker)
+	{
+	/* Install the worker structure in local storage: */
+	pthread_setspecific(workerKey,worker);
+	
+	while(true)
+		{
+		/* Execute the next available task: */
+		Task* task=fetchTask(worker);
+		if(task!=0)
+			{
+			runTask(task);
+			continue;
+			}
+		
+		/* Sleep until new tasks are submitted or the pool is shut down: */
+		MutexCond::Lock idleLock(idleCond);
+		if(shutdown)
+			break;
+		if(numQueuedTasks.get()==0)
+			idleCond.wait(idleLock);
+		}
+	
+	return 0;
+	}
+
+TaskPool::TaskPool(unsigned int sNumWorkers)
+	:numWorkers(sNumWorkers),workers(0),
+	 numQueuedTasks(0),
+	 shutdown(false)
+	{
+	/* Create the worker structure storage key: */
+	pthread_key_create(&workerKey,0);
+	
+	/* Start the worker threads: */
+	if(numWorkers>0)
+		{
+		workers=new Worker[numWorkers];
+		for(unsigned int i=0;i<numWorkers;++i)
+			workers[i].thread.start(this,&TaskPool::workerThreadMethod,&workers[i]);
+		}
+	}
+
+TaskPool::~TaskPool(void)
+	{
+	/* Shut down all worker threads: */
+	{
+	MutexCond::Lock idleLock(idleCond);
+	shutdown=true;
+	idleCond.broadcast();
+	}
+	
+	/* Wait for all worker threads to terminate: */
+	for(unsigned int i=0;i<numWorkers;++i)
+		workers[i].thread.join();
+	delete[] workers;
+	
+	/* Destroy the worker structure storage key: */
+	pthread_key_delete(workerKey);
+	}
+
+unsigned int TaskPool::getNumProcessors(void)
+	{
+	long numProcessors=sysconf(_SC_NPROCESSORS_ONLN);
+	return numProcessors>1?(unsigned int)(numProcessors):1U;
+	}
+
+void TaskPool::setGlobalPoolSize(unsigned int newNumWorkers)
+	{
+	Mutex::Lock globalPoolLock(globalPoolMutex);
+	globalPoolNumWorkers=newNumWorkers;
+	}
+
+TaskPool& TaskPool::getGlobalPool(void)
+	{
+	Mutex::Lock globalPoolLock(globalPoolMutex);
+	if(globalPool==0)
+		{
+		/* Leave one processor for the thread waiting on task groups, which helps executing tasks: */
+		if(globalPoolNumWorkers==~0U)
+			globalPoolNumWorkers=getNumProcessors()-1;
+		globalPool=new TaskPool(globalPoolNumWorkers);
+		}
+	return *globalPool;
+	}
+
+void TaskPool::destroyGlobalPool(void)
+	{
+	delete globalPool;
+	globalPool=0;
+	}
+
+}
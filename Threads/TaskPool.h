@@ -0,0 +1,163 @@
+/***********************************************************************
+TaskPool - Class for pools of worker threads executing groups of
+independent tasks, using per-worker task deques and work stealing to
+balance load.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_TASKPOOL_INCLUDED
+#define THREADS_TASKPOOL_INCLUDED
+
+#include <pthread.h>
+#include <string>
+#include <deque>
+#include <Threads/Atomic.h>
+#include <Threads/Spinlock.h>
+#include <Threads/Mutex.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+
+namespace Threads {
+
+class TaskPool
+	{
+	/* Embedded classes: */
+	public:
+	class TaskGroup;
+	
+	class Task // Abstract base class for tasks executed by a task pool
+		{
+		friend class TaskPool;
+		friend class TaskGroup;
+		
+		/* Elements: */
+		private:
+		TaskGroup* group; // Task group to which this task belongs
+		
+		/* Constructors and destructors: */
+		public:
+		Task(void)
+			:group(0)
+			{
+			}
+		virtual ~Task(void)
+			{
+			}
+		
+		/* Methods: */
+		virtual void execute(void) =0; // Executes the task; can submit further tasks to its own or other task groups
+		};
+	
+	class TaskGroup // Class to submit a set of tasks to a task pool and to wait for their completion
+		{
+		friend class TaskPool;
+		
+		/* Elements: */
+		private:
+		TaskPool& pool; // Task pool executing this group's tasks
+		MutexCond finishedCond; // Condition variable signalled when the last pending task finishes; also protects the group's state
+		unsigned int numPendingTasks; // Number of submitted tasks that did not finish yet
+		bool failed; // Flag whether any of the group's tasks threw an exception
+		std::string errorMessage; // Message of the first exception thrown by any of the group's tasks
+		
+		/* Private methods: */
+		void taskFinished(void); // Notifies the group that one of its tasks finished
+		void taskFailed(const char* message); // Notifies the group that one of its tasks threw an exception with the given message
+		void waitForTasks(void); // Helps executing tasks until all of the group's tasks finished
+		
+		/* Constructors and destructors: */
+		public:
+		TaskGroup(TaskPool& sPool); // Creates an empty task group for the given task pool
+		private:
+		TaskGroup(const TaskGroup& source); // Prohibit copy constructor
+		TaskGroup& operator=(const TaskGroup& source); // Prohibit assignment operator
+		public:
+		~TaskGroup(void); // Waits for all of the group's tasks to finish and destroys the group; ignores task exceptions
+		
+		/* Methods: */
+		TaskPool& getPool(void) // Returns the task pool executing this group's tasks
+			{
+			return pool;
+			}
+		void run(Task* task); // Submits the given new-allocated task for execution; task group inherits task object
+		void wait(void); // Helps executing tasks until all of the group's tasks finished; throws std::runtime_error if any task threw an exception
+		};
+	
+	friend class TaskGroup;
+	
+	private:
+	struct Worker // Structure representing a worker thread
+		{
+		/* Elements: */
+		public:
+		Spinlock dequeMutex; // Mutex protecting the worker's task deque
+		std::deque<Task*> deque; // Deque of tasks submitted by the worker; the worker pops from the back, other threads steal from the front
+		Thread thread; // The worker thread
+		};
+	
+	/* Elements: */
+	static Mutex globalPoolMutex; // Mutex protecting the global task pool
+	static unsigned int globalPoolNumWorkers; // Number of worker threads with which to create the global task pool
+	static TaskPool* globalPool; // Pointer to the global task pool, created on first use
+	pthread_key_t workerKey; // Storage key to access the calling thread's worker structure
+	unsigned int numWorkers; // Number of worker threads
+	Worker* workers; // Array of worker structures
+	Spinlock submitMutex; // Mutex protecting the submission queue
+	std::deque<Task*> submitQueue; // Queue of tasks submitted by threads that are not workers of this pool
+	Atomic<unsigned int> numQueuedTasks; // Number of tasks in all deques and the submission queue
+	MutexCond idleCond; // Condition variable on which idle worker threads wait for new tasks
+	bool shutdown; // Flag to shut down all worker threads
+	
+	/* Private methods: */
+	Worker* getCurrentWorker(void) const // Returns the worker structure of the calling thread, or null if the calling thread is not a worker of this pool
+		{
+		return static_cast<Worker*>(pthread_getspecific(workerKey));
+		}
+	void submit(Task* task); // Queues the given task for execution
+	Task* fetchTask(Worker* worker); // Returns a queued task, preferring the given worker's own tasks and stealing from other workers otherwise, or null if no tasks are queued
+	void runTask(Task* task); // Executes the given task, notifies its task group, and deletes it
+	void* workerThreadMethod(Worker* worker); // Thread method for worker threads
+	
+	/* Constructors and destructors: */
+	public:
+	TaskPool(unsigned int sNumWorkers); // Creates a task pool with the given number of worker threads
+	private:
+	TaskPool(const TaskPool& source); // Prohibit copy constructor
+	TaskPool& operator=(const TaskPool& source); // Prohibit assignment operator
+	public:
+	~TaskPool(void); // Shuts down all worker threads; all task groups must have finished before
+	
+	/* Methods: */
+	static unsigned int getNumProcessors(void); // Returns the number of online processors in the host
+	static void setGlobalPoolSize(unsigned int newNumWorkers); // Sets the number of worker threads of the global task pool; has no effect once the global pool was created
+	static TaskPool& getGlobalPool(void); // Returns the global task pool, creating it on first use with one worker thread fewer than online processors unless configured otherwise
+	__attribute__ ((destructor)) static void destroyGlobalPool(void); // Shuts down the global task pool at program exit
+	unsigned int getNumWorkers(void) const // Returns the number of worker threads
+		{
+		return numWorkers;
+		}
+	unsigned int getConcurrency(void) const // Returns the number of threads executing tasks while a thread waits on a task group
+		{
+		return numWorkers+1;
+		}
+	};
+
+}
+
+#endif
@@ -38,6 +38,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <VRDeviceDaemon/VRFactory.h>
 #include <VRDeviceDaemon/VRDevice.h>
 #include <VRDeviceDaemon/VRCalibrator.h>
+#include <VRDeviceDaemon/VRTrackerFilter.h>
 #include <VRDeviceDaemon/Config.h>
 
 /********************************
@@ -115,6 +116,25 @@ VRDeviceManager::VRDeviceManager(Misc::ConfigurationFile& configFile)
 				valuatorNames[valuatorIndex]=*dtnIt;
 			}
 		
+		/* Create the device's tracker filters: */
+		trackerFilters.resize(trackerNames.size(),0);
+		int numDeviceTrackers=int(trackerNames.size())-trackerIndexBases[currentDeviceIndex];
+		std::string defaultFilterName=configFile.retrieveString("./trackerFilterName","");
+		for(int i=0;i<numDeviceTrackers;++i)
+			{
+			/* Read the name of the tracker's filter section: */
+			char filterTagName[40];
+			snprintf(filterTagName,sizeof(filterTagName),"./trackerFilterName%d",i);
+			std::string filterName=configFile.retrieveString(filterTagName,defaultFilterName);
+			if(!filterName.empty())
+				{
+				/* Create a filter from the filter section: */
+				configFile.setCurrentSection(filterName.c_str());
+				trackerFilters[trackerIndexBases[currentDeviceIndex]+i]=VRTrackerFilter::create(configFile);
+				configFile.setCurrentSection("..");
+				}
+			}
+		
 		/* Return to parent section: */
 		configFile.setCurrentSection("..");
 		}
@@ -123,6 +143,9 @@ VRDeviceManager::VRDeviceManager(Misc::ConfigurationFile& configFile)
 	fflush(stdout);
 	#endif
 	
+	/* Leave trackers added after device construction unfiltered: */
+	trackerFilters.resize(trackerNames.size(),0);
+	
 	/* Set server state's layout: */
 	state.setLayout(trackerNames.size(),buttonNames.size(),valuatorNames.size());
 	
@@ -164,6 +187,10 @@ VRDeviceManager::~VRDeviceManager(void)
 		VRDevice::destroy(devices[i]);
 	delete[] devices;
 	
+	/* Delete tracker filters: */
+	for(std::vector<VRTrackerFilter*>::iterator tfIt=trackerFilters.begin();tfIt!=trackerFilters.end();++tfIt)
+		delete *tfIt;
+	
 	/* Delete base index arrays: */
 	delete[] trackerIndexBases;
 	delete[] buttonIndexBases;
@@ -296,6 +323,10 @@ void VRDeviceManager::disableTracker(int trackerIndex)
 	/* Update the device state: */
 	state.setTrackerValid(trackerIndex,false);
 	
+	/* Restart the tracker's filter when tracking resumes: */
+	if(trackerFilters[trackerIndex]!=0)
+		trackerFilters[trackerIndex]->reset();
+	
 	/* Check if update notifications are requested: */
 	if(trackerUpdateNotificationEnabled)
 		{
@@ -325,6 +356,11 @@ void VRDeviceManager::setTrackerState(int trackerIndex,const Vrui::VRDeviceState
 	
 	/* Update the device state: */
 	state.setTrackerState(trackerIndex,newTrackerState);
+	if(trackerFilters[trackerIndex]!=0)
+		{
+		/* Filter the new tracker state in place: */
+		trackerFilters[trackerIndex]->filter(state.getTrackerStates()[trackerIndex],newTimeStamp);
+		}
 	state.setTrackerTimeStamp(trackerIndex,newTimeStamp);
 	state.setTrackerValid(trackerIndex,true);
 	
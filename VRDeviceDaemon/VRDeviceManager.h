@@ -44,6 +44,7 @@ class HMDConfiguration;
 }
 class VRDevice;
 class VRCalibrator;
+class VRTrackerFilter;
 
 class VRDeviceManager
 	{
@@ -97,6 +98,7 @@ class VRDeviceManager
 	std::vector<std::string> trackerNames; // List of tracker names
 	std::vector<std::string> buttonNames; // List of button names
 	std::vector<std::string> valuatorNames; // List of valuator names
+	std::vector<VRTrackerFilter*> trackerFilters; // List of filters applied to tracker states, indexed by logical tracker index; null for unfiltered trackers
 	Threads::Mutex stateMutex; // Mutex serializing access to all state elements
 	Vrui::VRDeviceState state; // Current state of all managed devices
 	std::vector<Vrui::VRDeviceDescriptor*> virtualDevices; // List of virtual devices combining selected trackers, buttons, and valuators
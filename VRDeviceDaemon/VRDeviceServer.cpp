@@ -23,13 +23,22 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <VRDeviceDaemon/VRDeviceServer.h>
 
+#include <string.h>
+#include <errno.h>
 #include <stdio.h>
+#include <sys/types.h>
+#include <sys/socket.h>
 #include <stdexcept>
+#include <Misc/SizedTypes.h>
 #include <Misc/PrintInteger.h>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/StringMarshaller.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
+#include <IO/FixedMemoryFile.h>
 #include <Vrui/Internal/VRDeviceDescriptor.h>
 #include <Vrui/Internal/HMDConfiguration.h>
+#include <Vrui/Internal/VRDeviceSharedState.h>
 
 #include <VRDeviceDaemon/VRDeviceManager.h>
 
@@ -56,7 +65,9 @@ VRDeviceServer::ClientState::ClientState(VRDeviceServer* sServer,Comm::Listening
 	:server(sServer),
 	 pipe(listenSocket),
 	 state(START),protocolVersion(Vrui::VRDevicePipe::protocolVersionNumber),clientExpectsTimeStamps(true),
-	 active(false),streaming(false)
+	 active(false),streaming(false),sharedStreaming(false),
+	 packet(0),packetSize(0),packetSent(0),packetOutdated(false),
+	 writeListening(false),numDroppedPackets(0)
 	{
 	#ifdef VERBOSE
 	/* Assemble the client name: */
@@ -67,6 +78,11 @@ VRDeviceServer::ClientState::ClientState(VRDeviceServer* sServer,Comm::Listening
 	#endif
 	}
 
+VRDeviceServer::ClientState::~ClientState(void)
+	{
+	delete packet;
+	}
+
 /*******************************
 Methods of class VRDeviceServer:
 *******************************/
@@ -97,6 +113,12 @@ bool VRDeviceServer::newConnectionCallback(Threads::EventDispatcher::ListenerKey
 	
 	thisPtr->clientStates.push_back(newClient);
 	
+	if(thisPtr->sendBufferSize>0)
+		{
+		/* Limit the amount of data the operating system buffers for the client: */
+		setsockopt(newClient->pipe.getFd(),SOL_SOCKET,SO_SNDBUF,&thisPtr->sendBufferSize,sizeof(int));
+		}
+	
 	#if VRDEVICEDAEMON_DEBUG_PROTOCOL
 	printf("Adding listener for client's socket\n");
 	#endif
@@ -118,10 +140,25 @@ void VRDeviceServer::disconnectClient(VRDeviceServer::ClientState* client,bool r
 		/* Stop listening on the client's pipe: */
 		dispatcher.removeIOEventListener(client->listenerKey);
 		}
+	if(client->writeListening)
+		{
+		/* Stop waiting to send the rest of a pending state packet: */
+		dispatcher.removeIOEventListener(client->writeListenerKey);
+		}
+	
+	#ifdef VERBOSE
+	if(client->numDroppedPackets>0)
+		{
+		printf("VRDeviceServer: Dropped %u state packets for slow client %s\n",client->numDroppedPackets,client->clientName.c_str());
+		fflush(stdout);
+		}
+	#endif
 	
 	/* Check if the client is still streaming or active: */
 	if(client->streaming)
 		--numStreamingClients;
+	if(client->sharedStreaming)
+		--numSharedStreamingClients;
 	if(client->active)
 		{
 		--numActiveClients;
@@ -252,6 +289,16 @@ bool VRDeviceServer::clientMessageCallback(Threads::EventDispatcher::ListenerKey
 							client->pipe.write<Misc::UInt32>(thisPtr->deviceManager->getNumHapticFeatures());
 							}
 						
+						/* Check if the client knows about shared memory device states: */
+						if(client->protocolVersion>=7U)
+							{
+							/* Advertise the shared memory segment only to clients running on the same host: */
+							std::string sharedStateName;
+							if(thisPtr->sharedState!=0&&client->pipe.getAddress()==client->pipe.getPeerAddress())
+								sharedStateName=thisPtr->sharedState->getName();
+							Misc::writeCppString(sharedStateName,client->pipe);
+							}
+						
 						/* Finish the reply message: */
 						client->pipe.flush();
 						
@@ -278,6 +325,13 @@ bool VRDeviceServer::clientMessageCallback(Threads::EventDispatcher::ListenerKey
 						client->active=true;
 						client->state=ACTIVE;
 						}
+					else if(message==Vrui::VRDevicePipe::CLOCKSYNC_REQUEST)
+						{
+						/* Send the current time stamp so the client can estimate the offset between its and the server's clocks: */
+						client->pipe.writeMessage(Vrui::VRDevicePipe::CLOCKSYNC_REPLY);
+						client->pipe.write<Vrui::VRDeviceState::TimeStamp>(VRDeviceManager::getTimeStamp());
+						client->pipe.flush();
+						}
 					else if(message==Vrui::VRDevicePipe::DISCONNECT_REQUEST)
 						{
 						/* Cleanly disconnect this client: */
@@ -293,7 +347,7 @@ bool VRDeviceServer::clientMessageCallback(Threads::EventDispatcher::ListenerKey
 					break;
 				
 				case ACTIVE:
-					if(message==Vrui::VRDevicePipe::PACKET_REQUEST||message==Vrui::VRDevicePipe::STARTSTREAM_REQUEST)
+					if(message==Vrui::VRDevicePipe::PACKET_REQUEST||message==Vrui::VRDevicePipe::STARTSTREAM_REQUEST||message==Vrui::VRDevicePipe::STARTSHAREDSTREAM_REQUEST)
 						{
 						#if VRDEVICEDAEMON_DEBUG_PROTOCOL
 						printf("Sending packet reply..."); fflush(stdout);
@@ -322,11 +376,18 @@ bool VRDeviceServer::clientMessageCallback(Threads::EventDispatcher::ListenerKey
 						printf(" done\n");
 						#endif
 						
-						if(message==Vrui::VRDevicePipe::STARTSTREAM_REQUEST)
+						if(message!=Vrui::VRDevicePipe::PACKET_REQUEST)
 							{
 							/* Increase the number of streaming clients: */
 							++thisPtr->numStreamingClients;
 							
+							/* Check if the client will read subsequent states from shared memory; otherwise, fall back to sending packets: */
+							if(message==Vrui::VRDevicePipe::STARTSHAREDSTREAM_REQUEST&&thisPtr->sharedState!=0)
+								{
+								++thisPtr->numSharedStreamingClients;
+								client->sharedStreaming=true;
+								}
+							
 							/* Go to streaming state: */
 							client->streaming=true;
 							client->state=STREAMING;
@@ -384,15 +445,22 @@ bool VRDeviceServer::clientMessageCallback(Threads::EventDispatcher::ListenerKey
 						}
 					else if(message==Vrui::VRDevicePipe::STOPSTREAM_REQUEST)
 						{
+						/* Complete a pending state packet, but don't send any newer states: */
+						thisPtr->finishPacket(client);
+						client->packetOutdated=false;
+						
 						/* Send stopstream reply message: */
 						client->pipe.writeMessage(Vrui::VRDevicePipe::STOPSTREAM_REPLY);
 						client->pipe.flush();
 						
 						/* Decrease the number of streaming clients: */
 						--thisPtr->numStreamingClients;
+						if(client->sharedStreaming)
+							--thisPtr->numSharedStreamingClients;
 						
 						/* Go to active state: */
 						client->streaming=false;
+						client->sharedStreaming=false;
 						client->state=ACTIVE;
 						}
 					else if(message!=Vrui::VRDevicePipe::PACKET_REQUEST)
@@ -414,10 +482,60 @@ bool VRDeviceServer::clientMessageCallback(Threads::EventDispatcher::ListenerKey
 	return result;
 	}
 
+bool VRDeviceServer::clientWriteCallback(Threads::EventDispatcher::ListenerKey eventKey,int eventType,void* userData)
+	{
+	VRDeviceServer* thisPtr=static_cast<VRDeviceServer*>(userData);
+	
+	/* Find the client waiting for this event; it might have been disconnected in the meantime: */
+	ClientStateList::iterator csIt;
+	for(csIt=thisPtr->clientStates.begin();csIt!=thisPtr->clientStates.end()&&!((*csIt)->writeListening&&(*csIt)->writeListenerKey==eventKey);++csIt)
+		;
+	if(csIt==thisPtr->clientStates.end())
+		return true;
+	ClientState* client=*csIt;
+	
+	try
+		{
+		/* Send more of the pending state packet: */
+		bool complete=thisPtr->sendPacket(client);
+		if(complete&&client->packetOutdated)
+			{
+			/* Send the device state that was held back while the previous packet was pending: */
+			thisPtr->deviceManager->lockState();
+			thisPtr->packServerState(client);
+			thisPtr->deviceManager->unlockState();
+			complete=thisPtr->sendPacket(client);
+			}
+		
+		/* Stop listening once the client's socket has accepted the entire packet: */
+		if(complete)
+			client->writeListening=false;
+		return complete;
+		}
+	catch(const std::runtime_error& err)
+		{
+		#ifdef VERBOSE
+		printf("VRDeviceServer: Shutting down connection to client %s due to exception \"%s\"\n",client->clientName.c_str(),err.what());
+		fflush(stdout);
+		#endif
+		
+		/* Shut down the connection; the client's message callback will disconnect the client: */
+		client->writeListening=false;
+		client->packetSent=client->packetSize;
+		client->packetOutdated=false;
+		::shutdown(client->pipe.getFd(),SHUT_RDWR);
+		return true;
+		}
+	}
+
 void VRDeviceServer::trackerUpdateNotificationCallback(VRDeviceManager* manager,void* userData)
 	{
 	VRDeviceServer* thisPtr=static_cast<VRDeviceServer*>(userData);
 	
+	/* Publish the new (locked) state to shared memory directly from the device thread and wake up waiting clients: */
+	if(thisPtr->sharedState!=0)
+		thisPtr->sharedState->write(manager->getState(),thisPtr->numSharedStreamingClients>0);
+	
 	/* Update the version number of the device manager's tracking state and wake up the run loop: */
 	++thisPtr->managerTrackerStateVersion;
 	thisPtr->dispatcher.interrupt();
@@ -457,22 +575,94 @@ void VRDeviceServer::disconnectClientOnError(VRDeviceServer::ClientStateList::it
 	clientStates.pop_back();
 	}
 
+void VRDeviceServer::packServerState(VRDeviceServer::ClientState* client)
+	{
+	const Vrui::VRDeviceState& state=deviceManager->getState();
+	if(client->packet==0)
+		{
+		/* Create a packet buffer large enough for a packet reply message with the full server state: */
+		size_t maxPacketSize=sizeof(Vrui::VRDevicePipe::MessageIdType);
+		maxPacketSize+=size_t(state.getNumTrackers())*(sizeof(Vrui::VRDeviceState::TrackerState)+sizeof(Vrui::VRDeviceState::TimeStamp)+sizeof(Misc::UInt8));
+		maxPacketSize+=size_t(state.getNumButtons())*sizeof(Misc::UInt8);
+		maxPacketSize+=size_t(state.getNumValuators())*sizeof(Vrui::VRDeviceState::ValuatorState);
+		client->packet=new IO::FixedMemoryFile(maxPacketSize);
+		client->packet->setSwapOnWrite(client->pipe.mustSwapOnWrite());
+		}
+	
+	/* Write a packet reply message and the server state into the buffer: */
+	client->packet->clear();
+	client->packet->write<Vrui::VRDevicePipe::MessageIdType>(Vrui::VRDevicePipe::PACKET_REPLY);
+	state.write(*client->packet,client->clientExpectsTimeStamps,client->clientExpectsValidFlags);
+	client->packetSize=client->packet->getWriteSize();
+	client->packetSent=0;
+	client->packetOutdated=false;
+	}
+
+bool VRDeviceServer::sendPacket(VRDeviceServer::ClientState* client)
+	{
+	const Misc::UInt8* packetPtr=static_cast<const Misc::UInt8*>(client->packet->getMemory());
+	while(client->packetSent<client->packetSize)
+		{
+		/* Send as much data as the socket's send buffer accepts right now: */
+		ssize_t sendResult=send(client->pipe.getFd(),packetPtr+client->packetSent,client->packetSize-client->packetSent,MSG_DONTWAIT|MSG_NOSIGNAL);
+		if(sendResult>=0)
+			client->packetSent+=size_t(sendResult);
+		else if(errno==EAGAIN||errno==EWOULDBLOCK)
+			return false;
+		else if(errno!=EINTR)
+			{
+			int error=errno;
+			Misc::throwStdErr("VRDeviceServer: Error %d (%s) while sending state packet",error,strerror(error));
+			}
+		}
+	
+	return true;
+	}
+
+void VRDeviceServer::finishPacket(VRDeviceServer::ClientState* client)
+	{
+	if(client->packetSent<client->packetSize)
+		{
+		/* Write the rest of the packet ahead of the next message: */
+		const Misc::UInt8* packetPtr=static_cast<const Misc::UInt8*>(client->packet->getMemory());
+		client->pipe.writeRaw(packetPtr+client->packetSent,client->packetSize-client->packetSent);
+		client->packetSent=client->packetSize;
+		}
+	}
+
 bool VRDeviceServer::writeServerState(VRDeviceServer::ClientStateList::iterator csIt)
 	{
-	/* Bail out if the client is not streaming: */
+	/* Bail out if the client is not streaming or reads states from shared memory: */
 	ClientState* client=*csIt;
-	if(!client->streaming)
+	if(!client->streaming||client->sharedStreaming)
 		return true;
 	
 	/* Send state to client: */
 	try
 		{
-		/* Send packet reply message: */
-		client->pipe.writeMessage(Vrui::VRDevicePipe::PACKET_REPLY);
+		if(client->packetSent<client->packetSize)
+			{
+			if(client->packetSent>0)
+				{
+				/* Don't interrupt the partially sent packet; send the then-current state once it is complete: */
+				if(client->packetOutdated)
+					++client->numDroppedPackets;
+				client->packetOutdated=true;
+				return true;
+				}
+			
+			/* Replace the stale packet, none of which has been sent yet: */
+			++client->numDroppedPackets;
+			}
 		
-		/* Send server state: */
-		deviceManager->getState().write(client->pipe,client->clientExpectsTimeStamps,client->clientExpectsValidFlags);
-		client->pipe.flush();
+		/* Send as much of the current state as possible without blocking: */
+		packServerState(client);
+		if(!sendPacket(client)&&!client->writeListening)
+			{
+			/* Send the rest of the packet once the client's socket can accept more data: */
+			client->writeListenerKey=dispatcher.addIOEventListener(client->pipe.getFd(),Threads::EventDispatcher::Write,clientWriteCallback,this);
+			client->writeListening=true;
+			}
 		}
 	catch(std::runtime_error err)
 		{
@@ -494,6 +684,9 @@ bool VRDeviceServer::writeBatteryState(VRDeviceServer::ClientStateList::iterator
 	/* Send battery state to client: */
 	try
 		{
+		/* Complete a pending state packet: */
+		finishPacket(client);
+		
 		/* Send battery state update message: */
 		client->pipe.writeMessage(Vrui::VRDevicePipe::BATTERYSTATE_UPDATE);
 		
@@ -523,6 +716,9 @@ bool VRDeviceServer::writeHmdConfiguration(VRDeviceServer::ClientStateList::iter
 	
 	try
 		{
+		/* Complete a pending state packet: */
+		finishPacket(client);
+		
 		/* Send HMD configuration to client: */
 		hmdConfigurationVersions.hmdConfiguration->write(hmdConfigurationVersions.eyePosVersion,hmdConfigurationVersions.eyeVersion,hmdConfigurationVersions.distortionMeshVersion,client->pipe);
 		client->pipe.flush();
@@ -540,7 +736,8 @@ bool VRDeviceServer::writeHmdConfiguration(VRDeviceServer::ClientStateList::iter
 VRDeviceServer::VRDeviceServer(VRDeviceManager* sDeviceManager,const Misc::ConfigurationFile& configFile)
 	:deviceManager(sDeviceManager),
 	 listenSocket(configFile.retrieveValue<int>("./serverPort",-1),5),
-	 numActiveClients(0),numStreamingClients(0),
+	 sendBufferSize(configFile.retrieveValue<int>("./sendBufferSize",0)),
+	 numActiveClients(0),numStreamingClients(0),numSharedStreamingClients(0),sharedState(0),
 	 managerTrackerStateVersion(0U),streamingTrackerStateVersion(0U),
 	 managerBatteryStateVersion(0U),streamingBatteryStateVersion(0U),batteryStateVersions(0),
 	 managerHmdConfigurationVersion(0U),streamingHmdConfigurationVersion(0U),
@@ -556,6 +753,29 @@ VRDeviceServer::VRDeviceServer(VRDeviceManager* sDeviceManager,const Misc::Confi
 	hmdConfigurationVersions=new HMDConfigurationVersions[numHmdConfigurations];
 	for(unsigned int i=0;i<deviceManager->getNumHmdConfigurations();++i)
 		hmdConfigurationVersions[i].hmdConfiguration=&deviceManager->getHmdConfiguration(i);
+	
+	/* Create a shared memory segment to publish device states to clients on the same host: */
+	if(configFile.retrieveValue<bool>("./useSharedMemory",true)&&Vrui::VRDeviceSharedState::isSupported())
+		{
+		/* Create a default segment name from the server's port number: */
+		std::string sharedStateName="VRDeviceServer-";
+		char portId[10];
+		sharedStateName.append(Misc::print(listenSocket.getPortId(),portId+sizeof(portId)-1));
+		sharedStateName=configFile.retrieveString("./sharedMemoryName",sharedStateName);
+		
+		deviceManager->lockState();
+		try
+			{
+			sharedState=new Vrui::VRDeviceSharedState(sharedStateName.c_str(),deviceManager->getState());
+			}
+		catch(const std::runtime_error& err)
+			{
+			/* Fall back to sending all states via TCP: */
+			fprintf(stderr,"VRDeviceServer: Disabling shared memory due to exception %s\n",err.what());
+			fflush(stderr);
+			}
+		deviceManager->unlockState();
+		}
 	}
 
 VRDeviceServer::~VRDeviceServer(void)
@@ -571,6 +791,7 @@ VRDeviceServer::~VRDeviceServer(void)
 	/* Clean up: */
 	delete[] batteryStateVersions;
 	delete[] hmdConfigurationVersions;
+	delete sharedState;
 	}
 
 void VRDeviceServer::run(void)
@@ -589,12 +810,12 @@ void VRDeviceServer::run(void)
 	while(dispatcher.dispatchNextEvent())
 		{
 		/* Check if a streaming update needs to be sent: */
-		if(numStreamingClients>0&&streamingTrackerStateVersion!=managerTrackerStateVersion)
+		if(numStreamingClients>numSharedStreamingClients&&streamingTrackerStateVersion!=managerTrackerStateVersion)
 			{
 			/* Lock the current server state: */
 			deviceManager->lockState();
 			
-			/* Send a state update to all clients in streaming mode: */
+			/* Send a state update to all clients in streaming mode; slow clients will not hold up the others: */
 			for(ClientStateList::iterator csIt=clientStates.begin();csIt!=clientStates.end();++csIt)
 				if(!writeServerState(csIt))
 					--csIt;
@@ -31,9 +31,13 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 namespace Misc {
 class ConfigurationFile;
 }
+namespace IO {
+class FixedMemoryFile;
+}
 namespace Vrui {
 class BatteryState;
 class HMDConfiguration;
+class VRDeviceSharedState;
 }
 class VRDeviceManager;
 
@@ -57,9 +61,18 @@ class VRDeviceServer
 		bool clientExpectsValidFlags; // Flag whether the connected client expects to receive tracker valid flags
 		bool active; // Flag whether the client is currently active
 		bool streaming; // Flag whether client is currently in streaming mode
+		bool sharedStreaming; // Flag whether a streaming client reads device states from the server's shared memory segment instead of receiving packets
+		IO::FixedMemoryFile* packet; // Buffer holding the most recent state packet for a streaming client while it is sent without blocking
+		size_t packetSize; // Size of the state packet in the buffer
+		size_t packetSent; // Number of bytes of the state packet that have already been sent to the client
+		bool packetOutdated; // Flag whether the device state changed while the state packet was partially sent
+		bool writeListening; // Flag whether the server waits for the client's socket to accept more data
+		Threads::EventDispatcher::ListenerKey writeListenerKey; // Key with which this client is listening for output events while a state packet is pending
+		unsigned int numDroppedPackets; // Number of device states that were superseded by newer ones before they could be sent to the client
 		
 		/* Constructors and destructors: */
 		ClientState(VRDeviceServer* sServer,Comm::ListeningTCPSocket& listenSocket); // Accepts next incoming connection on given listening socket and establishes VR device connection
+		~ClientState(void);
 		};
 	
 	typedef std::vector<ClientState*> ClientStateList; // Data type for lists of states of connected clients
@@ -98,9 +111,12 @@ class VRDeviceServer
 	VRDeviceManager* deviceManager; // Pointer to device manager running in server
 	Threads::EventDispatcher dispatcher; // Event dispatcher to handle communication with multiple clients in parallel
 	Comm::ListeningTCPSocket listenSocket; // Main socket the server listens on for incoming connections
+	int sendBufferSize; // Size of the socket send buffer for connected clients in bytes, to limit the number of outdated states queued for slow clients; 0 to use the operating system's default
 	ClientStateList clientStates; // List of currently connected clients
 	int numActiveClients; // Number of clients that are currently active
 	int numStreamingClients; // Number of clients that are currently streaming
+	int numSharedStreamingClients; // Number of streaming clients that read device states from the shared memory segment
+	Vrui::VRDeviceSharedState* sharedState; // Shared memory segment publishing device states to clients on the same host, or null if disabled
 	unsigned int managerTrackerStateVersion; // Version number of tracker states in device manager
 	unsigned int streamingTrackerStateVersion; // Version number of tracker states most recently sent to streaming clients
 	unsigned int managerBatteryStateVersion; // Version number of device battery states in device manager
@@ -115,11 +131,15 @@ class VRDeviceServer
 	static bool newConnectionCallback(Threads::EventDispatcher::ListenerKey eventKey,int eventType,void* userData); // Callback called when a connection attempt is made at the listening socket
 	void disconnectClient(ClientState* client,bool removeListener,bool removeFromList); // Disconnects the given client due to a communication error; removes listener and/or dead client from list if respective flags are true
 	static bool clientMessageCallback(Threads::EventDispatcher::ListenerKey eventKey,int eventType,void* userData); // Callback called when a message from a client arrives
+	static bool clientWriteCallback(Threads::EventDispatcher::ListenerKey eventKey,int eventType,void* userData); // Callback called when a client's socket can accept more data of a pending state packet
 	static void trackerUpdateNotificationCallback(VRDeviceManager* manager,void* userData); // Callback called when tracking device states are updated
 	static void batteryStateUpdatedCallback(VRDeviceManager* manager,unsigned int deviceIndex,const Vrui::BatteryState& batteryState,void* userData); // Callback called when a virtual device's battery state has been updated
 	static void hmdConfigurationUpdatedCallback(VRDeviceManager* manager,const Vrui::HMDConfiguration* hmdConfiguration,void* userData); // Callback called when the given HMD configuration has been updated
 	void disconnectClientOnError(ClientStateList::iterator csIt,const std::runtime_error& err); // Forcefully disconnects a client after a communication error
-	bool writeServerState(ClientStateList::iterator csIt); // Writes the device manager's current (locked) state to the given client; returns false on error
+	void packServerState(ClientState* client); // Writes the device manager's current (locked) state into the given client's packet buffer
+	bool sendPacket(ClientState* client); // Sends as much of the given client's pending state packet as the client's socket accepts without blocking; returns true if the packet was sent completely
+	void finishPacket(ClientState* client); // Sends the rest of the given client's pending state packet, blocking if necessary, before another message is written to the client's pipe
+	bool writeServerState(ClientStateList::iterator csIt); // Sends the device manager's current (locked) state to the given client without blocking; returns false on error
 	bool writeBatteryState(ClientStateList::iterator csIt,unsigned int deviceIndex); // Writes the device manager's given battery state to the given client; returns false on error
 	bool writeHmdConfiguration(ClientStateList::iterator csIt,HMDConfigurationVersions& hmdConfigurationVersions); // Writes the given HMD configuration to the given client; returns false on error
 	
@@ -0,0 +1,251 @@
+/***********************************************************************
+SimulatedDevice - Class for devices reporting synthetic tracker motion
+at configurable rates, to measure the performance of the VR device
+daemon under load.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <VRDeviceDaemon/VRDevices/SimulatedDevice.h>
+
+#include <string.h>
+#include <stdio.h>
+#include <string>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/StandardValueCoders.h>
+#include <Misc/ConfigurationFile.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Math/Random.h>
+#include <Geometry/GeometryValueCoders.h>
+
+#include <VRDeviceDaemon/VRDeviceManager.h>
+
+/********************************
+Methods of class SimulatedDevice:
+********************************/
+
+void SimulatedDevice::updateTracker(int trackerIndex,double time,Vrui::VRDeviceState::TimeStamp timeStamp)
+	{
+	SimulatedTracker& st=trackers[trackerIndex];
+	
+	/* Calculate the tracker's offset from its center position, its linear velocity, and its rotation around the vertical axis: */
+	double omega=2.0*Math::Constants<double>::pi*st.frequency;
+	double a=omega*time+st.phase;
+	Vector offset=Vector::zero;
+	Vector linearVelocity=Vector::zero;
+	double angle=0.0;
+	double angularSpeed=0.0;
+	switch(st.motion)
+		{
+		case STATIC:
+			break;
+		
+		case CIRCLE:
+			offset=Vector(Math::cos(a),Math::sin(a),0.0)*st.radius;
+			linearVelocity=Vector(-Math::sin(a),Math::cos(a),0.0)*(st.radius*omega);
+			angle=a;
+			angularSpeed=omega;
+			break;
+		
+		case LISSAJOUS:
+			offset=Vector(Math::sin(a),Math::sin(2.0*a),Math::sin(3.0*a))*st.radius;
+			linearVelocity=Vector(Math::cos(a),2.0*Math::cos(2.0*a),3.0*Math::cos(3.0*a))*(st.radius*omega);
+			angle=a;
+			angularSpeed=omega;
+			break;
+		
+		case RANDOMWALK:
+			{
+			/* Advance a mean-reverting random walk whose stationary standard deviation is the motion radius: */
+			double dt=double(st.updateInterval);
+			double scale=st.radius*Math::sqrt(2.0*omega*dt);
+			Vector step(Math::randNormal(0.0,1.0)*scale,Math::randNormal(0.0,1.0)*scale,Math::randNormal(0.0,1.0)*scale);
+			step-=st.offset*(omega*dt);
+			st.offset+=step;
+			offset=st.offset;
+			linearVelocity=step/dt;
+			break;
+			}
+		}
+	
+	/* Send the tracker state to the device manager: */
+	Vrui::VRDeviceState::TrackerState ts;
+	typedef Vrui::VRDeviceState::TrackerState::PositionOrientation PO;
+	ts.positionOrientation=PO(PO::Vector(st.center+offset-Point::origin),PO::Rotation::rotateZ(PO::Scalar(angle)));
+	ts.linearVelocity=Vrui::VRDeviceState::TrackerState::LinearVelocity(linearVelocity);
+	ts.angularVelocity=Vrui::VRDeviceState::TrackerState::AngularVelocity(0.0f,0.0f,float(angularSpeed));
+	setTrackerState(trackerIndex,ts,timeStamp);
+	}
+
+void SimulatedDevice::deviceThreadMethod(void)
+	{
+	/* Schedule the first update of all trackers: */
+	Realtime::TimePointMonotonic startTime;
+	for(int i=0;i<numSimulatedTrackers;++i)
+		trackers[i].nextUpdateTime=startTime;
+	
+	while(true)
+		{
+		/* Wait for the next scheduled tracker update: */
+		Realtime::TimePointMonotonic wakeupTime=trackers[0].nextUpdateTime;
+		for(int i=1;i<numSimulatedTrackers;++i)
+			if(trackers[i].nextUpdateTime<wakeupTime)
+				wakeupTime=trackers[i].nextUpdateTime;
+		Realtime::TimePointMonotonic::sleep(wakeupTime);
+		
+		/* Sample the current time once for all trackers updated together: */
+		Realtime::TimePointMonotonic now;
+		Vrui::VRDeviceState::TimeStamp timeStamp=deviceManager->getTimeStamp();
+		double time=double(now)-double(startTime);
+		
+		/* Advance the sequence number before any tracker states are sent: */
+		++sequenceNumber;
+		if(sequenceValuatorIndex>=0)
+			setValuatorState(sequenceValuatorIndex,Vrui::VRDeviceState::ValuatorState(sequenceNumber&0xffffffU));
+		
+		/* Update all trackers that are due: */
+		for(int i=0;i<numSimulatedTrackers;++i)
+			if(trackers[i].nextUpdateTime<=now)
+				{
+				updateTracker(i,time,timeStamp);
+				
+				/* Schedule the tracker's next update, skipping updates that were missed entirely: */
+				trackers[i].nextUpdateTime+=trackers[i].updateInterval;
+				if(trackers[i].nextUpdateTime<=now)
+					{
+					trackers[i].nextUpdateTime=now;
+					trackers[i].nextUpdateTime+=trackers[i].updateInterval;
+					}
+				}
+		
+		/* Send the new device state to clients: */
+		updateState();
+		}
+	}
+
+SimulatedDevice::SimulatedDevice(VRDevice::Factory* sFactory,VRDeviceManager* sDeviceManager,Misc::ConfigurationFile& configFile)
+	:VRDevice(sFactory,sDeviceManager,configFile),
+	 numSimulatedTrackers(configFile.retrieveValue<int>("./numTrackers",1)),trackers(0),
+	 sequenceValuatorIndex(-1),sequenceNumber(0)
+	{
+	if(numSimulatedTrackers<1)
+		Misc::throwStdErr("SimulatedDevice: Device needs at least one tracker");
+	
+	/* Read device layout: */
+	int numButtons=configFile.retrieveValue<int>("./numButtons",0);
+	int numValuators=configFile.retrieveValue<int>("./numValuators",0);
+	if(configFile.retrieveValue<bool>("./sendSequenceNumbers",false))
+		{
+		/* Add a valuator carrying the device's update sequence number: */
+		sequenceValuatorIndex=numValuators;
+		++numValuators;
+		}
+	setNumTrackers(numSimulatedTrackers,configFile);
+	setNumButtons(numButtons,configFile);
+	setNumValuators(numValuators,configFile);
+	
+	/* Read the default tracker update rate and motion parameters: */
+	double trackerRate=configFile.retrieveValue<double>("./trackerRate",1000.0);
+	std::string motion=configFile.retrieveString("./motion","Circle");
+	Point motionCenter=configFile.retrieveValue<Point>("./motionCenter",Point::origin);
+	double motionRadius=configFile.retrieveValue<double>("./motionRadius",6.0);
+	double motionFrequency=configFile.retrieveValue<double>("./motionFrequency",0.5);
+	
+	/* Read per-tracker update rates and motion parameters: */
+	trackers=new SimulatedTracker[numSimulatedTrackers];
+	try
+		{
+		for(int i=0;i<numSimulatedTrackers;++i)
+			{
+			SimulatedTracker& st=trackers[i];
+			char tagName[40];
+			
+			snprintf(tagName,sizeof(tagName),"./trackerRate%d",i);
+			double rate=configFile.retrieveValue<double>(tagName,trackerRate);
+			if(rate<=0.0)
+				Misc::throwStdErr("SimulatedDevice: Invalid update rate %f for tracker %d",rate,i);
+			st.updateInterval=Realtime::TimeVector(1.0/rate);
+			
+			snprintf(tagName,sizeof(tagName),"./motion%d",i);
+			std::string trackerMotion=configFile.retrieveString(tagName,motion);
+			if(strcasecmp(trackerMotion.c_str(),"Static")==0)
+				st.motion=STATIC;
+			else if(strcasecmp(trackerMotion.c_str(),"Circle")==0)
+				st.motion=CIRCLE;
+			else if(strcasecmp(trackerMotion.c_str(),"Lissajous")==0)
+				st.motion=LISSAJOUS;
+			else if(strcasecmp(trackerMotion.c_str(),"RandomWalk")==0)
+				st.motion=RANDOMWALK;
+			else
+				Misc::throwStdErr("SimulatedDevice: Unknown motion pattern %s for tracker %d",trackerMotion.c_str(),i);
+			
+			snprintf(tagName,sizeof(tagName),"./motionCenter%d",i);
+			st.center=configFile.retrieveValue<Point>(tagName,motionCenter);
+			snprintf(tagName,sizeof(tagName),"./motionRadius%d",i);
+			st.radius=configFile.retrieveValue<double>(tagName,motionRadius);
+			snprintf(tagName,sizeof(tagName),"./motionFrequency%d",i);
+			st.frequency=configFile.retrieveValue<double>(tagName,motionFrequency);
+			
+			/* Spread the trackers' periodic motions evenly: */
+			st.phase=2.0*Math::Constants<double>::pi*double(i)/double(numSimulatedTrackers);
+			st.offset=Vector::zero;
+			}
+		}
+	catch(...)
+		{
+		delete[] trackers;
+		throw;
+		}
+	}
+
+SimulatedDevice::~SimulatedDevice(void)
+	{
+	if(isActive())
+		stop();
+	delete[] trackers;
+	}
+
+void SimulatedDevice::start(void)
+	{
+	/* Start device update thread: */
+	sequenceNumber=0;
+	startDeviceThread();
+	}
+
+void SimulatedDevice::stop(void)
+	{
+	/* Stop device update thread: */
+	stopDeviceThread();
+	}
+
+/*************************************
+Object creation/destruction functions:
+*************************************/
+
+extern "C" VRDevice* createObjectSimulatedDevice(VRFactory<VRDevice>* factory,VRFactoryManager<VRDevice>* factoryManager,Misc::ConfigurationFile& configFile)
+	{
+	VRDeviceManager* deviceManager=static_cast<VRDeviceManager::DeviceFactoryManager*>(factoryManager)->getDeviceManager();
+	return new SimulatedDevice(factory,deviceManager,configFile);
+	}
+
+extern "C" void destroyObjectSimulatedDevice(VRDevice* device,VRFactory<VRDevice>* factory,VRFactoryManager<VRDevice>* factoryManager)
+	{
+	delete device;
+	}
@@ -0,0 +1,85 @@
+/***********************************************************************
+SimulatedDevice - Class for devices reporting synthetic tracker motion
+at configurable rates, to measure the performance of the VR device
+daemon under load.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef SIMULATEDDEVICE_INCLUDED
+#define SIMULATEDDEVICE_INCLUDED
+
+#include <Realtime/Time.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+
+#include <VRDeviceDaemon/VRDevice.h>
+
+class SimulatedDevice:public VRDevice
+	{
+	/* Embedded classes: */
+	private:
+	typedef Geometry::Point<double,3> Point;
+	typedef Geometry::Vector<double,3> Vector;
+	
+	enum MotionPattern // Enumerated type for synthetic tracker motion patterns
+		{
+		STATIC, // Tracker rests at its center position
+		CIRCLE, // Tracker moves along a horizontal circle while turning around the vertical axis
+		LISSAJOUS, // Tracker moves along a three-dimensional Lissajous curve while turning around the vertical axis
+		RANDOMWALK // Tracker drifts randomly around its center position
+		};
+	
+	struct SimulatedTracker // Structure describing a simulated tracker
+		{
+		/* Elements: */
+		public:
+		MotionPattern motion; // Tracker's motion pattern
+		Point center; // Center position of the tracker's motion
+		double radius; // Size of the tracker's motion
+		double frequency; // Frequency of the tracker's periodic motion in Hz
+		double phase; // Phase offset of the tracker's periodic motion in radians
+		Realtime::TimeVector updateInterval; // Time between updates of the tracker
+		Realtime::TimePointMonotonic nextUpdateTime; // Time of the tracker's next update
+		Vector offset; // Current offset from the center position for random walk motion
+		};
+	
+	/* Elements: */
+	int numSimulatedTrackers; // Number of simulated trackers
+	SimulatedTracker* trackers; // Array of simulated trackers
+	int sequenceValuatorIndex; // Index of the valuator carrying the device's update sequence number, or -1
+	unsigned int sequenceNumber; // Number of device updates sent since the device was started
+	
+	/* Private methods: */
+	void updateTracker(int trackerIndex,double time,Vrui::VRDeviceState::TimeStamp timeStamp); // Calculates and sends the given tracker's state at the given time in seconds since the device was started
+	
+	/* Protected methods: */
+	virtual void deviceThreadMethod(void);
+	
+	/* Constructors and destructors: */
+	public:
+	SimulatedDevice(VRDevice::Factory* sFactory,VRDeviceManager* sDeviceManager,Misc::ConfigurationFile& configFile);
+	virtual ~SimulatedDevice(void);
+	
+	/* Methods: */
+	virtual void start(void);
+	virtual void stop(void);
+	};
+
+#endif
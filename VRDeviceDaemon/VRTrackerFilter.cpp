@@ -0,0 +1,323 @@
+/***********************************************************************
+VRTrackerFilter - Base class for filters that smooth calibrated tracker
+states and estimate tracker velocities at device rate, and concrete
+One-Euro, alpha-beta, and Kalman filters.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <VRDeviceDaemon/VRTrackerFilter.h>
+
+#include <string>
+#include <Misc/SizedTypes.h>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/StandardValueCoders.h>
+#include <Misc/ConfigurationFile.h>
+#include <Math/Math.h>
+
+/********************************
+Methods of class VRTrackerFilter:
+********************************/
+
+VRTrackerFilter::Vector VRTrackerFilter::log(const VRTrackerFilter::Rotation& rotation)
+	{
+	/* Calculate the rotation angle from the quaternion's vector and scalar parts for precision at small angles: */
+	const double* q=rotation.getQuaternion();
+	double s=Math::sqrt(q[0]*q[0]+q[1]*q[1]+q[2]*q[2]);
+	if(s==0.0)
+		return Vector::zero;
+	
+	/* Flip the quaternion into the hemisphere of the shortest rotation: */
+	double factor=2.0*Math::atan2(s,Math::abs(q[3]))/s;
+	if(q[3]<0.0)
+		factor=-factor;
+	
+	return Vector(q[0]*factor,q[1]*factor,q[2]*factor);
+	}
+
+void VRTrackerFilter::predictAndCorrect(const TrackerState& sample,double dt,const double positionGain[3],const double orientationGain[3])
+	{
+	/* Extrapolate the filter state to the sample's time: */
+	double halfDt2=0.5*dt*dt;
+	Point predictedPosition=position+linearVelocity*dt+linearAcceleration*halfDt2;
+	Vector predictedLinearVelocity=linearVelocity+linearAcceleration*dt;
+	Rotation predictedOrientation=Rotation::rotateScaledAxis(angularVelocity*dt+angularAcceleration*halfDt2)*orientation;
+	Vector predictedAngularVelocity=angularVelocity+angularAcceleration*dt;
+	
+	/* Correct the linear state with the position residual: */
+	Vector pr=Point(sample.positionOrientation.getOrigin())-predictedPosition;
+	position=predictedPosition+pr*positionGain[0];
+	linearVelocity=predictedLinearVelocity+pr*positionGain[1];
+	linearAcceleration+=pr*positionGain[2];
+	
+	/* Correct the angular state with the orientation residual: */
+	Vector orr=residual(Rotation(sample.positionOrientation.getRotation()),predictedOrientation);
+	orientation=Rotation::rotateScaledAxis(orr*orientationGain[0])*predictedOrientation;
+	orientation.renormalize();
+	angularVelocity=predictedAngularVelocity+orr*orientationGain[1];
+	angularAcceleration+=orr*orientationGain[2];
+	}
+
+void VRTrackerFilter::start(const TrackerState& sample)
+	{
+	/* Start from the sample and the velocities reported by the device driver: */
+	position=Point(sample.positionOrientation.getOrigin());
+	linearVelocity=Vector(sample.linearVelocity);
+	linearAcceleration=Vector::zero;
+	orientation=Rotation(sample.positionOrientation.getRotation());
+	angularVelocity=Vector(sample.angularVelocity);
+	angularAcceleration=Vector::zero;
+	}
+
+VRTrackerFilter::VRTrackerFilter(Misc::ConfigurationFile& configFile)
+	:maxTimeStep(configFile.retrieveValue<double>("./maxTimeStep",0.1)),
+	 valid(false),lastTimeStamp(0),
+	 position(Point::origin),linearVelocity(Vector::zero),linearAcceleration(Vector::zero),
+	 orientation(Rotation::identity),angularVelocity(Vector::zero),angularAcceleration(Vector::zero)
+	{
+	}
+
+VRTrackerFilter::~VRTrackerFilter(void)
+	{
+	}
+
+VRTrackerFilter* VRTrackerFilter::create(Misc::ConfigurationFile& configFile)
+	{
+	/* Create a filter of the requested type: */
+	std::string filterType=configFile.retrieveString("./type");
+	if(filterType=="OneEuroFilter")
+		return new OneEuroTrackerFilter(configFile);
+	else if(filterType=="AlphaBetaFilter")
+		return new AlphaBetaTrackerFilter(configFile);
+	else if(filterType=="KalmanFilter")
+		return new KalmanTrackerFilter(configFile);
+	else
+		Misc::throwStdErr("VRTrackerFilter::create: Unknown filter type %s",filterType.c_str());
+	
+	/* Never reached; just to make compiler happy: */
+	return 0;
+	}
+
+void VRTrackerFilter::filter(TrackerState& state,TimeStamp timeStamp)
+	{
+	/* Calculate the time step since the previous sample, taking time stamp wrap-around into account: */
+	double dt=0.0;
+	if(valid)
+		dt=double(TimeStamp(Misc::UInt32(timeStamp)-Misc::UInt32(lastTimeStamp)))*1.0e-6;
+	
+	if(!valid||dt<0.0||dt>maxTimeStep)
+		{
+		/* Restart the filter after a reset, tracking gap, or out-of-order sample: */
+		start(state);
+		valid=true;
+		lastTimeStamp=timeStamp;
+		}
+	else if(dt>0.0)
+		{
+		/* Update the filter with the new sample: */
+		update(state,dt);
+		lastTimeStamp=timeStamp;
+		}
+	
+	/* Replace the sample with the current filter state (repeats the previous filter state for duplicate time stamps): */
+	state.positionOrientation=TrackerState::PositionOrientation(position-Point::origin,orientation);
+	state.linearVelocity=TrackerState::LinearVelocity(linearVelocity);
+	state.angularVelocity=TrackerState::AngularVelocity(angularVelocity);
+	}
+
+/*************************************
+Methods of class OneEuroTrackerFilter:
+*************************************/
+
+void OneEuroTrackerFilter::start(const TrackerState& sample)
+	{
+	VRTrackerFilter::start(sample);
+	lastSamplePosition=position;
+	lastSampleOrientation=orientation;
+	}
+
+void OneEuroTrackerFilter::update(const TrackerState& sample,double dt)
+	{
+	double derivativeAlpha=smoothingFactor(derivativeCutoff,dt);
+	
+	/* Smooth the linear velocity between raw samples, and then the position with a cutoff frequency adapted to the smoothed linear speed: */
+	Point samplePosition(sample.positionOrientation.getOrigin());
+	linearVelocity+=((samplePosition-lastSamplePosition)/dt-linearVelocity)*derivativeAlpha;
+	position+=(samplePosition-position)*smoothingFactor(positionMinCutoff+positionBeta*linearVelocity.mag(),dt);
+	lastSamplePosition=samplePosition;
+	
+	/* Smooth the angular velocity between raw samples, and then the orientation with a cutoff frequency adapted to the smoothed angular speed: */
+	Rotation sampleOrientation(sample.positionOrientation.getRotation());
+	angularVelocity+=(residual(sampleOrientation,lastSampleOrientation)/dt-angularVelocity)*derivativeAlpha;
+	orientation.leftMultiply(Rotation::rotateScaledAxis(residual(sampleOrientation,orientation)*smoothingFactor(orientationMinCutoff+orientationBeta*angularVelocity.mag(),dt)));
+	orientation.renormalize();
+	lastSampleOrientation=sampleOrientation;
+	}
+
+OneEuroTrackerFilter::OneEuroTrackerFilter(Misc::ConfigurationFile& configFile)
+	:VRTrackerFilter(configFile),
+	 positionMinCutoff(configFile.retrieveValue<double>("./positionMinCutoff",1.0)),
+	 positionBeta(configFile.retrieveValue<double>("./positionBeta",1.0)),
+	 orientationMinCutoff(configFile.retrieveValue<double>("./orientationMinCutoff",1.0)),
+	 orientationBeta(configFile.retrieveValue<double>("./orientationBeta",5.0)),
+	 derivativeCutoff(configFile.retrieveValue<double>("./derivativeCutoff",5.0)),
+	 lastSamplePosition(Point::origin),lastSampleOrientation(Rotation::identity)
+	{
+	}
+
+/***************************************
+Methods of class AlphaBetaTrackerFilter:
+***************************************/
+
+void AlphaBetaTrackerFilter::update(const TrackerState& sample,double dt)
+	{
+	/* Correct the constant-velocity prediction with the fixed gains: */
+	double positionGain[3]={positionAlpha,positionBeta/dt,0.0};
+	double orientationGain[3]={orientationAlpha,orientationBeta/dt,0.0};
+	predictAndCorrect(sample,dt,positionGain,orientationGain);
+	}
+
+AlphaBetaTrackerFilter::AlphaBetaTrackerFilter(Misc::ConfigurationFile& configFile)
+	:VRTrackerFilter(configFile),
+	 positionAlpha(configFile.retrieveValue<double>("./positionAlpha",0.5)),
+	 positionBeta(configFile.retrieveValue<double>("./positionBeta",0.1)),
+	 orientationAlpha(configFile.retrieveValue<double>("./orientationAlpha",0.5)),
+	 orientationBeta(configFile.retrieveValue<double>("./orientationBeta",0.1))
+	{
+	/* Check the gains for stability: */
+	if(positionAlpha<=0.0||positionAlpha>1.0||positionBeta<0.0||positionBeta>=4.0-2.0*positionAlpha)
+		Misc::throwStdErr("AlphaBetaTrackerFilter: Unstable position gains %f, %f",positionAlpha,positionBeta);
+	if(orientationAlpha<=0.0||orientationAlpha>1.0||orientationBeta<0.0||orientationBeta>=4.0-2.0*orientationAlpha)
+		Misc::throwStdErr("AlphaBetaTrackerFilter: Unstable orientation gains %f, %f",orientationAlpha,orientationBeta);
+	}
+
+/*********************************************
+Methods of class KalmanTrackerFilter::Channel:
+*********************************************/
+
+void KalmanTrackerFilter::Channel::start(int order)
+	{
+	/* Start with the measurement uncertainty for the value, and large uncertainties for all derivatives: */
+	for(int i=0;i<3;++i)
+		for(int j=0;j<3;++j)
+			p[i][j]=0.0;
+	p[0][0]=measurementNoise;
+	for(int i=1;i<order;++i)
+		p[i][i]=1.0e4;
+	}
+
+void KalmanTrackerFilter::Channel::step(int order,double dt,double gain[3])
+	{
+	/* Calculate the state transition matrix and the process noise of a white noise model on the highest tracked derivative: */
+	double f[3][3]={{1.0,dt,0.5*dt*dt},{0.0,1.0,dt},{0.0,0.0,1.0}};
+	double q[3][3];
+	double dt2=dt*dt;
+	double dt3=dt2*dt;
+	if(order==2)
+		{
+		q[0][0]=dt3/3.0;
+		q[0][1]=q[1][0]=dt2/2.0;
+		q[1][1]=dt;
+		}
+	else
+		{
+		double dt4=dt3*dt;
+		q[0][0]=dt4*dt/20.0;
+		q[0][1]=q[1][0]=dt4/8.0;
+		q[0][2]=q[2][0]=dt3/6.0;
+		q[1][1]=dt3/3.0;
+		q[1][2]=q[2][1]=dt2/2.0;
+		q[2][2]=dt;
+		}
+	
+	/* Propagate the covariance matrix: */
+	double fp[3][3];
+	for(int i=0;i<order;++i)
+		for(int j=0;j<order;++j)
+			{
+			fp[i][j]=0.0;
+			for(int k=0;k<order;++k)
+				fp[i][j]+=f[i][k]*p[k][j];
+			}
+	for(int i=0;i<order;++i)
+		for(int j=0;j<order;++j)
+			{
+			p[i][j]=q[i][j]*processNoise;
+			for(int k=0;k<order;++k)
+				p[i][j]+=fp[i][k]*f[j][k];
+			}
+	
+	/* Calculate the Kalman gain for a measurement of the value: */
+	double s=p[0][0]+measurementNoise;
+	for(int i=0;i<order;++i)
+		gain[i]=p[i][0]/s;
+	for(int i=order;i<3;++i)
+		gain[i]=0.0;
+	
+	/* Update the covariance matrix for the measurement: */
+	double p0[3];
+	for(int j=0;j<order;++j)
+		p0[j]=p[0][j];
+	for(int i=0;i<order;++i)
+		for(int j=0;j<order;++j)
+			p[i][j]-=gain[i]*p0[j];
+	}
+
+/************************************
+Methods of class KalmanTrackerFilter:
+************************************/
+
+void KalmanTrackerFilter::start(const TrackerState& sample)
+	{
+	/* Restart the filter state and covariances: */
+	VRTrackerFilter::start(sample);
+	positionChannel.start(order);
+	orientationChannel.start(order);
+	}
+
+void KalmanTrackerFilter::update(const TrackerState& sample,double dt)
+	{
+	/* Advance the covariances and correct the prediction with the resulting Kalman gains: */
+	double positionGain[3],orientationGain[3];
+	positionChannel.step(order,dt,positionGain);
+	orientationChannel.step(order,dt,orientationGain);
+	predictAndCorrect(sample,dt,positionGain,orientationGain);
+	}
+
+KalmanTrackerFilter::KalmanTrackerFilter(Misc::ConfigurationFile& configFile)
+	:VRTrackerFilter(configFile),
+	 order(2)
+	{
+	/* Read the motion model: */
+	std::string model=configFile.retrieveString("./model","ConstantVelocity");
+	if(model=="ConstantVelocity")
+		order=2;
+	else if(model=="ConstantAcceleration")
+		order=3;
+	else
+		Misc::throwStdErr("KalmanTrackerFilter: Unknown motion model %s",model.c_str());
+	
+	/* Read the noise parameters: */
+	positionChannel.processNoise=configFile.retrieveValue<double>("./positionProcessNoise",1000.0);
+	positionChannel.measurementNoise=configFile.retrieveValue<double>("./positionMeasurementNoise",1.0e-4);
+	orientationChannel.processNoise=configFile.retrieveValue<double>("./orientationProcessNoise",100.0);
+	orientationChannel.measurementNoise=configFile.retrieveValue<double>("./orientationMeasurementNoise",1.0e-5);
+	positionChannel.start(order);
+	orientationChannel.start(order);
+	}
@@ -0,0 +1,164 @@
+/***********************************************************************
+VRTrackerFilter - Base class for filters that smooth calibrated tracker
+states and estimate tracker velocities at device rate, and concrete
+One-Euro, alpha-beta, and Kalman filters.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef VRTRACKERFILTER_INCLUDED
+#define VRTRACKERFILTER_INCLUDED
+
+#include <Math/Constants.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <Geometry/Rotation.h>
+#include <Vrui/Internal/VRDeviceState.h>
+
+/* Forward declarations: */
+namespace Misc {
+class ConfigurationFile;
+}
+
+class VRTrackerFilter // Base class for filters smoothing tracker states and estimating tracker velocities
+	{
+	/* Embedded classes: */
+	public:
+	typedef Vrui::VRDeviceState::TrackerState TrackerState;
+	typedef Vrui::VRDeviceState::TimeStamp TimeStamp;
+	typedef Geometry::Point<double,3> Point; // Type for filtered positions
+	typedef Geometry::Vector<double,3> Vector; // Type for filtered velocities and accelerations
+	typedef Geometry::Rotation<double,3> Rotation; // Type for filtered orientations
+	
+	/* Elements: */
+	private:
+	double maxTimeStep; // Maximum time between consecutive samples in seconds before the filter restarts
+	bool valid; // Flag whether the filter has been started with a sample
+	TimeStamp lastTimeStamp; // Time stamp of the most recent sample
+	protected:
+	Point position; // Filtered tracker position
+	Vector linearVelocity; // Estimated linear velocity
+	Vector linearAcceleration; // Estimated linear acceleration; zero for filters that do not track acceleration
+	Rotation orientation; // Filtered tracker orientation
+	Vector angularVelocity; // Estimated angular velocity in physical space
+	Vector angularAcceleration; // Estimated angular acceleration in physical space; zero for filters that do not track acceleration
+	
+	/* Protected methods: */
+	static Vector log(const Rotation& rotation); // Returns the scaled axis of the shortest rotation equivalent to the given rotation
+	static Vector residual(const Rotation& measured,const Rotation& predicted) // Returns the rotation from the predicted to the measured orientation as a scaled axis in physical space
+		{
+		return log(measured*Geometry::invert(predicted));
+		}
+	void predictAndCorrect(const TrackerState& sample,double dt,const double positionGain[3],const double orientationGain[3]); // Advances the filter state by the given time step and corrects it towards the given sample using the given gains for position/velocity/acceleration
+	virtual void start(const TrackerState& sample); // Restarts the filter from the given sample
+	virtual void update(const TrackerState& sample,double dt) =0; // Updates the filter state with the given sample taken the given positive time step after the previous one
+	
+	/* Constructors and destructors: */
+	public:
+	VRTrackerFilter(Misc::ConfigurationFile& configFile); // Initializes filter by reading current section of configuration file
+	virtual ~VRTrackerFilter(void);
+	static VRTrackerFilter* create(Misc::ConfigurationFile& configFile); // Creates a filter of the type given in current section of configuration file; throws exception for unknown filter types
+	
+	/* Methods: */
+	void reset(void) // Restarts the filter with the next sample, e.g., after the tracker lost tracking
+		{
+		valid=false;
+		}
+	void filter(TrackerState& state,TimeStamp timeStamp); // Replaces the given raw tracker state with a filtered state and estimated velocities
+	};
+
+class OneEuroTrackerFilter:public VRTrackerFilter // Speed-adaptive low-pass filter after Casiez, Roussel, and Vogel, "1 Euro Filter," CHI 2012
+	{
+	/* Elements: */
+	private:
+	double positionMinCutoff; // Minimum cutoff frequency for positions in Hz
+	double positionBeta; // Increase of position cutoff frequency with linear speed in Hz/(unit/s)
+	double orientationMinCutoff; // Minimum cutoff frequency for orientations in Hz
+	double orientationBeta; // Increase of orientation cutoff frequency with angular speed in Hz/(radians/s)
+	double derivativeCutoff; // Cutoff frequency for velocity estimates in Hz
+	Point lastSamplePosition; // Position of the previous raw sample
+	Rotation lastSampleOrientation; // Orientation of the previous raw sample
+	
+	/* Private methods: */
+	static double smoothingFactor(double cutoff,double dt) // Returns the exponential smoothing factor for the given cutoff frequency and time step
+		{
+		return 1.0/(1.0+1.0/(2.0*Math::Constants<double>::pi*cutoff*dt));
+		}
+	
+	/* Protected methods from VRTrackerFilter: */
+	protected:
+	virtual void start(const TrackerState& sample);
+	virtual void update(const TrackerState& sample,double dt);
+	
+	/* Constructors and destructors: */
+	public:
+	OneEuroTrackerFilter(Misc::ConfigurationFile& configFile);
+	};
+
+class AlphaBetaTrackerFilter:public VRTrackerFilter // Constant-velocity predictor/corrector with fixed gains
+	{
+	/* Elements: */
+	private:
+	double positionAlpha; // Position correction gain
+	double positionBeta; // Linear velocity correction gain
+	double orientationAlpha; // Orientation correction gain
+	double orientationBeta; // Angular velocity correction gain
+	
+	/* Protected methods from VRTrackerFilter: */
+	protected:
+	virtual void update(const TrackerState& sample,double dt);
+	
+	/* Constructors and destructors: */
+	public:
+	AlphaBetaTrackerFilter(Misc::ConfigurationFile& configFile);
+	};
+
+class KalmanTrackerFilter:public VRTrackerFilter // Kalman filter with constant-velocity or constant-acceleration motion model
+	{
+	/* Embedded classes: */
+	private:
+	struct Channel // Structure holding the state covariance shared by the three axes of position or orientation
+		{
+		/* Elements: */
+		public:
+		double processNoise; // Spectral density of the white noise driving the highest tracked derivative
+		double measurementNoise; // Variance of measurement noise
+		double p[3][3]; // State covariance matrix
+		
+		/* Methods: */
+		void start(int order); // Resets the covariance matrix for a filter of the given order
+		void step(int order,double dt,double gain[3]); // Advances the covariance matrix by the given time step and calculates the Kalman gain for the next measurement
+		};
+	
+	/* Elements: */
+	int order; // Number of tracked derivatives: 2 for constant velocity, 3 for constant acceleration
+	Channel positionChannel; // Covariance of positions
+	Channel orientationChannel; // Covariance of orientations
+	
+	/* Protected methods from VRTrackerFilter: */
+	protected:
+	virtual void start(const TrackerState& sample);
+	virtual void update(const TrackerState& sample,double dt);
+	
+	/* Constructors and destructors: */
+	public:
+	KalmanTrackerFilter(Misc::ConfigurationFile& configFile);
+	};
+
+#endif
@@ -0,0 +1,960 @@
+/***********************************************************************
+ColorspaceKernels - Functions to convert rows of pixels between the raw
+formats handled by image extractors and greyscale, RGB, or Y'CbCr, using
+SSE2 or AVX2 instructions where available. All kernels return results
+bit-identical to the scalar conversion functions in Colorspaces.h.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Basic Video Library (Video).
+
+The Basic Video Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Basic Video Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Basic Video Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Video/ColorspaceKernels.h>
+
+#include <Video/Colorspaces.h>
+
+#if defined(__SSE2__)
+#define VIDEO_COLORSPACEKERNELS_HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define VIDEO_COLORSPACEKERNELS_HAVE_SSE2 0
+#endif
+
+#if VIDEO_COLORSPACEKERNELS_HAVE_SSE2&&defined(__GNUC__)&&(defined(__x86_64__)||defined(__i386__))
+#define VIDEO_COLORSPACEKERNELS_HAVE_AVX2 1
+#include <immintrin.h>
+#define VIDEO_COLORSPACEKERNELS_AVX2 __attribute__((target("avx2")))
+#else
+#define VIDEO_COLORSPACEKERNELS_HAVE_AVX2 0
+#endif
+
+namespace Video {
+
+namespace ColorspaceKernels {
+
+namespace {
+
+/**************************************
+Scalar reference conversion functions:
+**************************************/
+
+inline unsigned char ypToY(unsigned char yp)
+	{
+	if(yp<=16)
+		return 0;
+	else if(yp>=236)
+		return 255;
+	else
+		return (unsigned char)(((int(yp)-16)*256)/220);
+	}
+
+inline unsigned char rgbToGrey(unsigned char r,unsigned char g,unsigned char b)
+	{
+	return (unsigned char)(((unsigned int)r*306U+(unsigned int)g*601U+(unsigned int)b*117U+512U)>>10);
+	}
+
+inline unsigned char avg(unsigned char v1,unsigned char v2)
+	{
+	return (unsigned char)(((unsigned int)(v1)+(unsigned int)(v2)+1U)/2U);
+	}
+
+inline unsigned char avg(unsigned char v1,unsigned char v2,unsigned char v3,unsigned char v4)
+	{
+	return (unsigned char)(((unsigned int)(v1)+(unsigned int)(v2)+(unsigned int)(v3)+(unsigned int)(v4)+2U)/4U);
+	}
+
+inline void debayerPixel(const unsigned char* raw,ptrdiff_t stride,bool green,bool rowIsRed,unsigned char rgb[3])
+	{
+	/* Interpolate the pixel's row color, green, and other color: */
+	unsigned char rowColor,g,otherColor;
+	if(green)
+		{
+		rowColor=avg(raw[-1],raw[1]);
+		g=raw[0];
+		otherColor=avg(raw[-stride],raw[stride]);
+		}
+	else
+		{
+		rowColor=raw[0];
+		g=avg(raw[-stride],raw[-1],raw[1],raw[stride]);
+		otherColor=avg(raw[-stride-1],raw[-stride+1],raw[stride-1],raw[stride+1]);
+		}
+	
+	/* Assign the interpolated colors: */
+	rgb[0]=rowIsRed?rowColor:otherColor;
+	rgb[1]=g;
+	rgb[2]=rowIsRed?otherColor:rowColor;
+	}
+
+/*******************************************
+Instruction set selection for the host CPU:
+*******************************************/
+
+InstructionSet getBestInstructionSet(void)
+	{
+	#if VIDEO_COLORSPACEKERNELS_HAVE_AVX2
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2"))
+		return AVX2;
+	#endif
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_SSE2
+	return SSE2;
+	#else
+	return SCALAR;
+	#endif
+	}
+
+const InstructionSet bestInstructionSet=getBestInstructionSet();
+InstructionSet instructionSet=bestInstructionSet;
+
+#if VIDEO_COLORSPACEKERNELS_HAVE_SSE2
+
+/************************
+SSE2 conversion helpers:
+************************/
+
+inline __m128i pair(short first,short second) // Returns a vector of pairs of 16-bit values for _mm_madd_epi16
+	{
+	return _mm_set1_epi32(int((unsigned int)(unsigned short)(first)|((unsigned int)(unsigned short)(second)<<16)));
+	}
+
+inline __m128i round16(__m128i fixed16) // Converts 32-bit fixed-point values with 16 fractional bits to integers, rounding to nearest
+	{
+	return _mm_srai_epi32(_mm_add_epi32(fixed16,_mm_set1_epi32(32768)),16);
+	}
+
+inline void convertYpCbCrToRGB16(__m128i yp,__m128i cb,__m128i cr,__m128i& r,__m128i& g,__m128i& b) // Converts eight 16-bit Y'CbCr pixels to saturated 16-bit RGB
+	{
+	/* Convert Y'CbCr to YUV: */
+	yp=_mm_sub_epi16(yp,_mm_set1_epi16(16));
+	cb=_mm_sub_epi16(cb,_mm_set1_epi16(128));
+	cr=_mm_sub_epi16(cr,_mm_set1_epi16(128));
+	
+	/* Split the conversion factors into multiples of 2^16 and 16-bit remainders to use exact 16x16->32-bit multiplications: */
+	const __m128i zero=_mm_setzero_si128();
+	__m128i rHigh=_mm_add_epi16(yp,_mm_add_epi16(cr,cr));
+	__m128i gHigh=_mm_sub_epi16(yp,cr);
+	__m128i bHigh=_mm_add_epi16(yp,_mm_add_epi16(cb,cb));
+	__m128i rgb[3][2];
+	for(int half=0;half<2;++half)
+		{
+		__m128i ypcr=half==0?_mm_unpacklo_epi16(yp,cr):_mm_unpackhi_epi16(yp,cr);
+		__m128i cbcr=half==0?_mm_unpacklo_epi16(cb,cr):_mm_unpackhi_epi16(cb,cr);
+		__m128i ypcb=half==0?_mm_unpacklo_epi16(yp,cb):_mm_unpackhi_epi16(yp,cb);
+		
+		/* R=y*76309+v*104597: */
+		__m128i rh=half==0?_mm_unpacklo_epi16(zero,rHigh):_mm_unpackhi_epi16(zero,rHigh);
+		rgb[0][half]=round16(_mm_add_epi32(rh,_mm_madd_epi16(ypcr,pair(10773,-26475))));
+		
+		/* G=y*76309-u*25675-v*53279: */
+		__m128i gh=half==0?_mm_unpacklo_epi16(zero,gHigh):_mm_unpackhi_epi16(zero,gHigh);
+		rgb[1][half]=round16(_mm_add_epi32(_mm_add_epi32(gh,_mm_madd_epi16(ypcr,pair(10773,0))),_mm_madd_epi16(cbcr,pair(-25675,12257))));
+		
+		/* B=y*76309+u*132202: */
+		__m128i bh=half==0?_mm_unpacklo_epi16(zero,bHigh):_mm_unpackhi_epi16(zero,bHigh);
+		rgb[2][half]=round16(_mm_add_epi32(bh,_mm_madd_epi16(ypcb,pair(10773,1130))));
+		}
+	r=_mm_packs_epi32(rgb[0][0],rgb[0][1]);
+	g=_mm_packs_epi32(rgb[1][0],rgb[1][1]);
+	b=_mm_packs_epi32(rgb[2][0],rgb[2][1]);
+	}
+
+inline void convertYpCbCrToRGB(__m128i yp,__m128i cb,__m128i cr,__m128i& r,__m128i& g,__m128i& b) // Converts sixteen 8-bit Y'CbCr pixels to 8-bit RGB
+	{
+	const __m128i zero=_mm_setzero_si128();
+	__m128i rgb16[3][2];
+	convertYpCbCrToRGB16(_mm_unpacklo_epi8(yp,zero),_mm_unpacklo_epi8(cb,zero),_mm_unpacklo_epi8(cr,zero),rgb16[0][0],rgb16[1][0],rgb16[2][0]);
+	convertYpCbCrToRGB16(_mm_unpackhi_epi8(yp,zero),_mm_unpackhi_epi8(cb,zero),_mm_unpackhi_epi8(cr,zero),rgb16[0][1],rgb16[1][1],rgb16[2][1]);
+	r=_mm_packus_epi16(rgb16[0][0],rgb16[0][1]);
+	g=_mm_packus_epi16(rgb16[1][0],rgb16[1][1]);
+	b=_mm_packus_epi16(rgb16[2][0],rgb16[2][1]);
+	}
+
+inline __m128i packPixels(__m128i pixels) // Packs four 32-bit pixels into 12 bytes at the beginning of the result
+	{
+	/* Pack pairs of pixels into six bytes inside each 64-bit half: */
+	pixels=_mm_or_si128(_mm_and_si128(pixels,_mm_set_epi32(0,0x00ffffff,0,0x00ffffff)),_mm_and_si128(_mm_srli_epi64(pixels,8),_mm_set_epi32(0x0000ffff,0xff000000,0x0000ffff,0xff000000)));
+	
+	/* Join the two halves: */
+	return _mm_or_si128(_mm_move_epi64(pixels),_mm_slli_si128(_mm_srli_si128(pixels,8),6));
+	}
+
+inline __m128i unpackPixels(__m128i packed) // Unpacks four 24-bit pixels from the first 12 bytes of the given vector into four 32-bit pixels with undefined high bytes
+	{
+	/* Split the four pixels into two pairs of pixels in each 64-bit half: */
+	__m128i pixels=_mm_unpacklo_epi64(packed,_mm_srli_si128(packed,6));
+	
+	/* Unpack each pair: */
+	return _mm_or_si128(_mm_and_si128(pixels,_mm_set_epi32(0,0x00ffffff,0,0x00ffffff)),_mm_and_si128(_mm_slli_epi64(pixels,8),_mm_set_epi32(0x00ffffff,0,0x00ffffff,0)));
+	}
+
+inline void storeRGB(__m128i c0,__m128i c1,__m128i c2,unsigned char* dst) // Interleaves sixteen pixels' worth of three 8-bit channels into 48 bytes
+	{
+	/* Interleave the channels into 32-bit pixels: */
+	const __m128i zero=_mm_setzero_si128();
+	__m128i c01Lo=_mm_unpacklo_epi8(c0,c1);
+	__m128i c01Hi=_mm_unpackhi_epi8(c0,c1);
+	__m128i c2Lo=_mm_unpacklo_epi8(c2,zero);
+	__m128i c2Hi=_mm_unpackhi_epi8(c2,zero);
+	__m128i p0=packPixels(_mm_unpacklo_epi16(c01Lo,c2Lo));
+	__m128i p1=packPixels(_mm_unpackhi_epi16(c01Lo,c2Lo));
+	__m128i p2=packPixels(_mm_unpacklo_epi16(c01Hi,c2Hi));
+	__m128i p3=packPixels(_mm_unpackhi_epi16(c01Hi,c2Hi));
+	
+	/* Join the four groups of 12 bytes: */
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(dst),_mm_or_si128(p0,_mm_slli_si128(p1,12)));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(dst+16),_mm_or_si128(_mm_srli_si128(p1,4),_mm_slli_si128(p2,8)));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(dst+32),_mm_or_si128(_mm_srli_si128(p2,8),_mm_slli_si128(p3,4)));
+	}
+
+inline void loadRGB(const unsigned char* src,__m128i pixels[4]) // Loads sixteen 24-bit pixels into four vectors of 32-bit pixels
+	{
+	__m128i in0=_mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+	__m128i in1=_mm_loadu_si128(reinterpret_cast<const __m128i*>(src+16));
+	__m128i in2=_mm_loadu_si128(reinterpret_cast<const __m128i*>(src+32));
+	pixels[0]=unpackPixels(in0);
+	pixels[1]=unpackPixels(_mm_or_si128(_mm_srli_si128(in0,12),_mm_slli_si128(in1,4)));
+	pixels[2]=unpackPixels(_mm_or_si128(_mm_srli_si128(in1,8),_mm_slli_si128(in2,8)));
+	pixels[3]=unpackPixels(_mm_srli_si128(in2,4));
+	}
+
+inline void splitRGB(__m128i pixels,__m128i& rg,__m128i& gb) // Splits four 32-bit pixels into pairs of 16-bit red and green and green and blue values
+	{
+	rg=_mm_or_si128(_mm_and_si128(pixels,_mm_set1_epi32(0x000000ff)),_mm_and_si128(_mm_slli_epi32(pixels,8),_mm_set1_epi32(0x00ff0000)));
+	gb=_mm_or_si128(_mm_and_si128(_mm_srli_epi32(pixels,8),_mm_set1_epi32(0x000000ff)),_mm_and_si128(pixels,_mm_set1_epi32(0x00ff0000)));
+	}
+
+inline void convertRGBToYpCbCr32(__m128i rg,__m128i gb,__m128i& yp,__m128i& cb,__m128i& cr) // Converts four pixels from pairs of 16-bit RGB values to unclamped 32-bit Y'CbCr
+	{
+	yp=round16(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(rg,pair(16829,16520)),_mm_madd_epi16(gb,pair(16519,6416))),_mm_set1_epi32(1048576)));
+	cb=round16(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(rg,pair(-9714,-19071)),_mm_madd_epi16(gb,pair(0,28784))),_mm_set1_epi32(8388608)));
+	cr=round16(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(rg,pair(28784,-24103)),_mm_madd_epi16(gb,pair(0,-4681))),_mm_set1_epi32(8388608)));
+	}
+
+inline __m128i convertRGBToGrey32(__m128i rg,__m128i gb) // Converts four pixels from pairs of 16-bit RGB values to 32-bit greyscale
+	{
+	return _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(rg,pair(306,601)),_mm_madd_epi16(gb,pair(0,117))),_mm_set1_epi32(512)),10);
+	}
+
+inline __m128i convertRGBToGrey(__m128i r,__m128i g,__m128i b) // Converts sixteen 8-bit RGB pixels to 8-bit greyscale
+	{
+	const __m128i zero=_mm_setzero_si128();
+	__m128i grey16[2];
+	for(int half=0;half<2;++half)
+		{
+		__m128i r16=half==0?_mm_unpacklo_epi8(r,zero):_mm_unpackhi_epi8(r,zero);
+		__m128i g16=half==0?_mm_unpacklo_epi8(g,zero):_mm_unpackhi_epi8(g,zero);
+		__m128i b16=half==0?_mm_unpacklo_epi8(b,zero):_mm_unpackhi_epi8(b,zero);
+		__m128i lo=convertRGBToGrey32(_mm_unpacklo_epi16(r16,g16),_mm_unpacklo_epi16(g16,b16));
+		__m128i hi=convertRGBToGrey32(_mm_unpackhi_epi16(r16,g16),_mm_unpackhi_epi16(g16,b16));
+		grey16[half]=_mm_packs_epi32(lo,hi);
+		}
+	return _mm_packus_epi16(grey16[0],grey16[1]);
+	}
+
+inline __m128i convertYpToY16(__m128i yp) // Converts eight 16-bit Y' values to saturated 16-bit Y values
+	{
+	/* Calculate ((yp-16)*256)/220 using a fixed-point reciprocal, exact for all 8-bit Y' values: */
+	__m128i y=_mm_slli_epi16(_mm_subs_epu16(yp,_mm_set1_epi16(16)),8);
+	return _mm_srli_epi16(_mm_mulhi_epu16(y,_mm_set1_epi16(9533)),5);
+	}
+
+inline void load422(const unsigned char* src,unsigned int ypOffset,__m128i c16[2],__m128i yp16[2]) // Loads sixteen packed 4:2:2 pixels and splits them into 16-bit Y' and alternating Cb and Cr values
+	{
+	const __m128i mask=_mm_set1_epi16(0x00ff);
+	for(int i=0;i<2;++i)
+		{
+		__m128i packed=_mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i*16));
+		if(ypOffset==0)
+			{
+			yp16[i]=_mm_and_si128(packed,mask);
+			c16[i]=_mm_srli_epi16(packed,8);
+			}
+		else
+			{
+			yp16[i]=_mm_srli_epi16(packed,8);
+			c16[i]=_mm_and_si128(packed,mask);
+			}
+		}
+	}
+
+inline void load422(const unsigned char* src,unsigned int ypOffset,__m128i& yp,__m128i& cb,__m128i& cr) // Loads sixteen packed 4:2:2 pixels and unpacks them to 8-bit 4:4:4 Y'CbCr
+	{
+	__m128i c16[2],yp16[2],cb16[2],cr16[2];
+	load422(src,ypOffset,c16,yp16);
+	for(int i=0;i<2;++i)
+		{
+		/* Duplicate each pixel pair's chroma values: */
+		__m128i cbLow=_mm_and_si128(c16[i],_mm_set1_epi32(0x0000ffff));
+		cb16[i]=_mm_or_si128(cbLow,_mm_slli_epi32(cbLow,16));
+		__m128i crHigh=_mm_and_si128(c16[i],_mm_set1_epi32(0xffff0000));
+		cr16[i]=_mm_or_si128(crHigh,_mm_srli_epi32(crHigh,16));
+		}
+	yp=_mm_packus_epi16(yp16[0],yp16[1]);
+	cb=_mm_packus_epi16(cb16[0],cb16[1]);
+	cr=_mm_packus_epi16(cr16[0],cr16[1]);
+	}
+
+inline __m128i avg4(__m128i v1,__m128i v2,__m128i v3,__m128i v4) // Averages four vectors of sixteen 8-bit values, rounding to nearest
+	{
+	const __m128i zero=_mm_setzero_si128();
+	const __m128i two=_mm_set1_epi16(2);
+	__m128i lo=_mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(v1,zero),_mm_unpacklo_epi8(v2,zero)),_mm_add_epi16(_mm_unpacklo_epi8(v3,zero),_mm_unpacklo_epi8(v4,zero)));
+	__m128i hi=_mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(v1,zero),_mm_unpackhi_epi8(v2,zero)),_mm_add_epi16(_mm_unpackhi_epi8(v3,zero),_mm_unpackhi_epi8(v4,zero)));
+	return _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(lo,two),2),_mm_srli_epi16(_mm_add_epi16(hi,two),2));
+	}
+
+inline void debayer(const unsigned char* raw,ptrdiff_t stride,bool firstIsGreen,bool rowIsRed,__m128i& r,__m128i& g,__m128i& b) // Interpolates sixteen pixels of a Bayer-filtered row to 8-bit RGB
+	{
+	/* Load the pixels' neighborhoods: */
+	#define LOAD(offset) _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw+(offset)))
+	__m128i c=LOAD(0);
+	__m128i w=LOAD(-1);
+	__m128i e=LOAD(1);
+	__m128i n=LOAD(-stride);
+	__m128i s=LOAD(stride);
+	__m128i horizontal=_mm_avg_epu8(w,e);
+	__m128i vertical=_mm_avg_epu8(n,s);
+	__m128i cross=avg4(n,w,e,s);
+	__m128i diagonal=avg4(LOAD(-stride-1),LOAD(-stride+1),LOAD(stride-1),LOAD(stride+1));
+	#undef LOAD
+	
+	/* Select interpolated or raw values for green and non-green pixels: */
+	__m128i colorMask=_mm_set1_epi16(firstIsGreen?short(0xff00):short(0x00ff));
+	__m128i rowColor=_mm_or_si128(_mm_and_si128(colorMask,c),_mm_andnot_si128(colorMask,horizontal));
+	g=_mm_or_si128(_mm_and_si128(colorMask,cross),_mm_andnot_si128(colorMask,c));
+	__m128i otherColor=_mm_or_si128(_mm_and_si128(colorMask,diagonal),_mm_andnot_si128(colorMask,vertical));
+	r=rowIsRed?rowColor:otherColor;
+	b=rowIsRed?otherColor:rowColor;
+	}
+
+#endif
+
+#if VIDEO_COLORSPACEKERNELS_HAVE_AVX2
+
+/************************
+AVX2 conversion helpers:
+************************/
+
+VIDEO_COLORSPACEKERNELS_AVX2 inline __m256i pair256(short first,short second) // Returns a vector of pairs of 16-bit values for _mm256_madd_epi16
+	{
+	return _mm256_set1_epi32(int((unsigned int)(unsigned short)(first)|((unsigned int)(unsigned short)(second)<<16)));
+	}
+
+VIDEO_COLORSPACEKERNELS_AVX2 inline __m256i round16(__m256i fixed16)
+	{
+	return _mm256_srai_epi32(_mm256_add_epi32(fixed16,_mm256_set1_epi32(32768)),16);
+	}
+
+VIDEO_COLORSPACEKERNELS_AVX2 inline void convertYpCbCrToRGB16(__m256i yp,__m256i cb,__m256i cr,__m256i& r,__m256i& g,__m256i& b) // Converts sixteen 16-bit Y'CbCr pixels to saturated 16-bit RGB; pixel order is only preserved inside each 128-bit lane
+	{
+	yp=_mm256_sub_epi16(yp,_mm256_set1_epi16(16));
+	cb=_mm256_sub_epi16(cb,_mm256_set1_epi16(128));
+	cr=_mm256_sub_epi16(cr,_mm256_set1_epi16(128));
+	
+	const __m256i zero=_mm256_setzero_si256();
+	__m256i rHigh=_mm256_add_epi16(yp,_mm256_add_epi16(cr,cr));
+	__m256i gHigh=_mm256_sub_epi16(yp,cr);
+	__m256i bHigh=_mm256_add_epi16(yp,_mm256_add_epi16(cb,cb));
+	__m256i rgb[3][2];
+	for(int half=0;half<2;++half)
+		{
+		__m256i ypcr=half==0?_mm256_unpacklo_epi16(yp,cr):_mm256_unpackhi_epi16(yp,cr);
+		__m256i cbcr=half==0?_mm256_unpacklo_epi16(cb,cr):_mm256_unpackhi_epi16(cb,cr);
+		__m256i ypcb=half==0?_mm256_unpacklo_epi16(yp,cb):_mm256_unpackhi_epi16(yp,cb);
+		__m256i rh=half==0?_mm256_unpacklo_epi16(zero,rHigh):_mm256_unpackhi_epi16(zero,rHigh);
+		rgb[0][half]=round16(_mm256_add_epi32(rh,_mm256_madd_epi16(ypcr,pair256(10773,-26475))));
+		__m256i gh=half==0?_mm256_unpacklo_epi16(zero,gHigh):_mm256_unpackhi_epi16(zero,gHigh);
+		rgb[1][half]=round16(_mm256_add_epi32(_mm256_add_epi32(gh,_mm256_madd_epi16(ypcr,pair256(10773,0))),_mm256_madd_epi16(cbcr,pair256(-25675,12257))));
+		__m256i bh=half==0?_mm256_unpacklo_epi16(zero,bHigh):_mm256_unpackhi_epi16(zero,bHigh);
+		rgb[2][half]=round16(_mm256_add_epi32(bh,_mm256_madd_epi16(ypcb,pair256(10773,1130))));
+		}
+	r=_mm256_packs_epi32(rgb[0][0],rgb[0][1]);
+	g=_mm256_packs_epi32(rgb[1][0],rgb[1][1]);
+	b=_mm256_packs_epi32(rgb[2][0],rgb[2][1]);
+	}
+
+VIDEO_COLORSPACEKERNELS_AVX2 inline void convertYpCbCrToRGB(__m256i yp,__m256i cb,__m256i cr,__m256i& r,__m256i& g,__m256i& b) // Converts thirty-two 8-bit Y'CbCr pixels to 8-bit RGB
+	{
+	/* Unpacking and packing inside 128-bit lanes preserves the overall pixel order: */
+	const __m256i zero=_mm256_setzero_si256();
+	__m256i rgb16[3][2];
+	convertYpCbCrToRGB16(_mm256_unpacklo_epi8(yp,zero),_mm256_unpacklo_epi8(cb,zero),_mm256_unpacklo_epi8(cr,zero),rgb16[0][0],rgb16[1][0],rgb16[2][0]);
+	convertYpCbCrToRGB16(_mm256_unpackhi_epi8(yp,zero),_mm256_unpackhi_epi8(cb,zero),_mm256_unpackhi_epi8(cr,zero),rgb16[0][1],rgb16[1][1],rgb16[2][1]);
+	r=_mm256_packus_epi16(rgb16[0][0],rgb16[0][1]);
+	g=_mm256_packus_epi16(rgb16[1][0],rgb16[1][1]);
+	b=_mm256_packus_epi16(rgb16[2][0],rgb16[2][1]);
+	}
+
+VIDEO_COLORSPACEKERNELS_AVX2 inline void storeRGB(__m256i c0,__m256i c1,__m256i c2,unsigned char* dst) // Interleaves thirty-two pixels' worth of three 8-bit channels into 96 bytes
+	{
+	storeRGB(_mm256_castsi256_si128(c0),_mm256_castsi256_si128(c1),_mm256_castsi256_si128(c2),dst);
+	storeRGB(_mm256_extracti128_si256(c0,1),_mm256_extracti128_si256(c1,1),_mm256_extracti128_si256(c2,1),dst+48);
+	}
+
+VIDEO_COLORSPACEKERNELS_AVX2 inline __m256i convertRGBToGrey32(__m256i rg,__m256i gb)
+	{
+	return _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(rg,pair256(306,601)),_mm256_madd_epi16(gb,pair256(0,117))),_mm256_set1_epi32(512)),10);
+	}
+
+VIDEO_COLORSPACEKERNELS_AVX2 inline __m256i convertRGBToGrey(__m256i r,__m256i g,__m256i b) // Converts thirty-two 8-bit RGB pixels to 8-bit greyscale
+	{
+	const __m256i zero=_mm256_setzero_si256();
+	__m256i grey16[2];
+	for(int half=0;half<2;++half)
+		{
+		__m256i r16=half==0?_mm256_unpacklo_epi8(r,zero):_mm256_unpackhi_epi8(r,zero);
+		__m256i g16=half==0?_mm256_unpacklo_epi8(g,zero):_mm256_unpackhi_epi8(g,zero);
+		__m256i b16=half==0?_mm256_unpacklo_epi8(b,zero):_mm256_unpackhi_epi8(b,zero);
+		__m256i lo=convertRGBToGrey32(_mm256_unpacklo_epi16(r16,g16),_mm256_unpacklo_epi16(g16,b16));
+		__m256i hi=convertRGBToGrey32(_mm256_unpackhi_epi16(r16,g16),_mm256_unpackhi_epi16(g16,b16));
+		grey16[half]=_mm256_packs_epi32(lo,hi);
+		}
+	return _mm256_packus_epi16(grey16[0],grey16[1]);
+	}
+
+VIDEO_COLORSPACEKERNELS_AVX2 inline void load422(const unsigned char* src,unsigned int ypOffset,__m256i& yp,__m256i& cb,__m256i& cr) // Loads thirty-two packed 4:2:2 pixels and unpacks them to 8-bit 4:4:4 Y'CbCr
+	{
+	const __m256i mask=_mm256_set1_epi16(0x00ff);
+	__m256i yp16[2],cb16[2],cr16[2];
+	for(int i=0;i<2;++i)
+		{
+		__m256i packed=_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src+i*32));
+		__m256i c16;
+		if(ypOffset==0)
+			{
+			yp16[i]=_mm256_and_si256(packed,mask);
+			c16=_mm256_srli_epi16(packed,8);
+			}
+		else
+			{
+			yp16[i]=_mm256_srli_epi16(packed,8);
+			c16=_mm256_and_si256(packed,mask);
+			}
+		__m256i cbLow=_mm256_and_si256(c16,_mm256_set1_epi32(0x0000ffff));
+		cb16[i]=_mm256_or_si256(cbLow,_mm256_slli_epi32(cbLow,16));
+		__m256i crHigh=_mm256_and_si256(c16,_mm256_set1_epi32(0xffff0000));
+		cr16[i]=_mm256_or_si256(crHigh,_mm256_srli_epi32(crHigh,16));
+		}
+	
+	/* Pack the 16-bit values and restore pixel order across 128-bit lanes: */
+	yp=_mm256_permute4x64_epi64(_mm256_packus_epi16(yp16[0],yp16[1]),0xd8);
+	cb=_mm256_permute4x64_epi64(_mm256_packus_epi16(cb16[0],cb16[1]),0xd8);
+	cr=_mm256_permute4x64_epi64(_mm256_packus_epi16(cr16[0],cr16[1]),0xd8);
+	}
+
+VIDEO_COLORSPACEKERNELS_AVX2 inline __m256i avg4(__m256i v1,__m256i v2,__m256i v3,__m256i v4)
+	{
+	const __m256i zero=_mm256_setzero_si256();
+	const __m256i two=_mm256_set1_epi16(2);
+	__m256i lo=_mm256_add_epi16(_mm256_add_epi16(_mm256_unpacklo_epi8(v1,zero),_mm256_unpacklo_epi8(v2,zero)),_mm256_add_epi16(_mm256_unpacklo_epi8(v3,zero),_mm256_unpacklo_epi8(v4,zero)));
+	__m256i hi=_mm256_add_epi16(_mm256_add_epi16(_mm256_unpackhi_epi8(v1,zero),_mm256_unpackhi_epi8(v2,zero)),_mm256_add_epi16(_mm256_unpackhi_epi8(v3,zero),_mm256_unpackhi_epi8(v4,zero)));
+	return _mm256_packus_epi16(_mm256_srli_epi16(_mm256_add_epi16(lo,two),2),_mm256_srli_epi16(_mm256_add_epi16(hi,two),2));
+	}
+
+VIDEO_COLORSPACEKERNELS_AVX2 inline void debayer(const unsigned char* raw,ptrdiff_t stride,bool firstIsGreen,bool rowIsRed,__m256i& r,__m256i& g,__m256i& b) // Interpolates thirty-two pixels of a Bayer-filtered row to 8-bit RGB
+	{
+	#define LOAD(offset) _mm256_loadu_si256(reinterpret_cast<const __m256i*>(raw+(offset)))
+	__m256i c=LOAD(0);
+	__m256i w=LOAD(-1);
+	__m256i e=LOAD(1);
+	__m256i n=LOAD(-stride);
+	__m256i s=LOAD(stride);
+	__m256i horizontal=_mm256_avg_epu8(w,e);
+	__m256i vertical=_mm256_avg_epu8(n,s);
+	__m256i cross=avg4(n,w,e,s);
+	__m256i diagonal=avg4(LOAD(-stride-1),LOAD(-stride+1),LOAD(stride-1),LOAD(stride+1));
+	#undef LOAD
+	
+	__m256i colorMask=_mm256_set1_epi16(firstIsGreen?short(0xff00):short(0x00ff));
+	__m256i rowColor=_mm256_blendv_epi8(horizontal,c,colorMask);
+	g=_mm256_blendv_epi8(c,cross,colorMask);
+	__m256i otherColor=_mm256_blendv_epi8(vertical,diagonal,colorMask);
+	r=rowIsRed?rowColor:otherColor;
+	b=rowIsRed?otherColor:rowColor;
+	}
+
+/*********************************
+AVX2 implementations of kernels:
+*********************************/
+
+VIDEO_COLORSPACEKERNELS_AVX2 unsigned int convertYpCbCr422ToRGBAVX2(const unsigned char* src,unsigned int ypOffset,unsigned char* rgb,unsigned int width)
+	{
+	unsigned int x;
+	for(x=0;x+32<=width;x+=32,src+=64,rgb+=96)
+		{
+		__m256i yp,cb,cr,r,g,b;
+		load422(src,ypOffset,yp,cb,cr);
+		convertYpCbCrToRGB(yp,cb,cr,r,g,b);
+		storeRGB(r,g,b,rgb);
+		}
+	return x;
+	}
+
+VIDEO_COLORSPACEKERNELS_AVX2 unsigned int convertYpCbCr420ToRGBAVX2(const unsigned char* yp,const unsigned char* cb,const unsigned char* cr,unsigned char* rgb,unsigned int width)
+	{
+	unsigned int x;
+	for(x=0;x+32<=width;x+=32,yp+=32,cb+=16,cr+=16,rgb+=96)
+		{
+		/* Load thirty-two Y' values and duplicate sixteen Cb and Cr values each: */
+		__m256i yp8=_mm256_loadu_si256(reinterpret_cast<const __m256i*>(yp));
+		__m128i cb8=_mm_loadu_si128(reinterpret_cast<const __m128i*>(cb));
+		__m256i cbDup=_mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi8(cb8,cb8)),_mm_unpackhi_epi8(cb8,cb8),1);
+		__m128i cr8=_mm_loadu_si128(reinterpret_cast<const __m128i*>(cr));
+		__m256i crDup=_mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi8(cr8,cr8)),_mm_unpackhi_epi8(cr8,cr8),1);
+		
+		__m256i r,g,b;
+		convertYpCbCrToRGB(yp8,cbDup,crDup,r,g,b);
+		storeRGB(r,g,b,rgb);
+		}
+	return x;
+	}
+
+VIDEO_COLORSPACEKERNELS_AVX2 unsigned int debayerToRGBAVX2(const unsigned char* raw,ptrdiff_t stride,bool firstIsGreen,bool rowIsRed,unsigned char* rgb,unsigned int numPixels)
+	{
+	unsigned int x;
+	for(x=0;x+32<=numPixels;x+=32,raw+=32,rgb+=96)
+		{
+		__m256i r,g,b;
+		debayer(raw,stride,firstIsGreen,rowIsRed,r,g,b);
+		storeRGB(r,g,b,rgb);
+		}
+	return x;
+	}
+
+VIDEO_COLORSPACEKERNELS_AVX2 unsigned int debayerToGreyAVX2(const unsigned char* raw,ptrdiff_t stride,bool firstIsGreen,bool rowIsRed,unsigned char* grey,unsigned int numPixels)
+	{
+	unsigned int x;
+	for(x=0;x+32<=numPixels;x+=32,raw+=32,grey+=32)
+		{
+		__m256i r,g,b;
+		debayer(raw,stride,firstIsGreen,rowIsRed,r,g,b);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(grey),convertRGBToGrey(r,g,b));
+		}
+	return x;
+	}
+
+#endif
+
+}
+
+/*********************************
+Kernel selection and entry points:
+*********************************/
+
+InstructionSet getInstructionSet(void)
+	{
+	return instructionSet;
+	}
+
+void setInstructionSet(InstructionSet newInstructionSet)
+	{
+	instructionSet=newInstructionSet<=bestInstructionSet?newInstructionSet:bestInstructionSet;
+	}
+
+void convertYpToY(const unsigned char* yp,unsigned char* y,unsigned int width)
+	{
+	unsigned int x=0;
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		const __m128i zero=_mm_setzero_si128();
+		for(;x+16<=width;x+=16,yp+=16,y+=16)
+			{
+			__m128i yp8=_mm_loadu_si128(reinterpret_cast<const __m128i*>(yp));
+			__m128i lo=convertYpToY16(_mm_unpacklo_epi8(yp8,zero));
+			__m128i hi=convertYpToY16(_mm_unpackhi_epi8(yp8,zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(y),_mm_packus_epi16(lo,hi));
+			}
+		}
+	#endif
+	
+	/* Convert the remaining pixels: */
+	for(;x<width;++x,++yp,++y)
+		*y=ypToY(*yp);
+	}
+
+void convertYpCbCr422ToY(const unsigned char* src,unsigned int ypOffset,unsigned char* y,unsigned int width)
+	{
+	unsigned int x=0;
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		for(;x+16<=width;x+=16,src+=32,y+=16)
+			{
+			__m128i c16[2],yp16[2];
+			load422(src,ypOffset,c16,yp16);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(y),_mm_packus_epi16(convertYpToY16(yp16[0]),convertYpToY16(yp16[1])));
+			}
+		}
+	#endif
+	
+	/* Convert the remaining pixels: */
+	for(src+=ypOffset;x<width;++x,src+=2,++y)
+		*y=ypToY(*src);
+	}
+
+void convertYpCbCr422ToRGB(const unsigned char* src,unsigned int ypOffset,unsigned char* rgb,unsigned int width)
+	{
+	unsigned int x=0;
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_AVX2
+	if(instructionSet>=AVX2)
+		{
+		x=convertYpCbCr422ToRGBAVX2(src,ypOffset,rgb,width);
+		src+=x*2;
+		rgb+=x*3;
+		}
+	#endif
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		for(;x+16<=width;x+=16,src+=32,rgb+=48)
+			{
+			__m128i yp,cb,cr,r,g,b;
+			load422(src,ypOffset,yp,cb,cr);
+			convertYpCbCrToRGB(yp,cb,cr,r,g,b);
+			storeRGB(r,g,b,rgb);
+			}
+		}
+	#endif
+	
+	/* Convert the remaining pairs of pixels: */
+	for(;x<width;x+=2,src+=4,rgb+=2*3)
+		{
+		unsigned char ypcbcr[3];
+		ypcbcr[0]=src[ypOffset];
+		ypcbcr[1]=src[1-ypOffset];
+		ypcbcr[2]=src[3-ypOffset];
+		Video::ypcbcrToRgb(ypcbcr,rgb);
+		ypcbcr[0]=src[2+ypOffset];
+		Video::ypcbcrToRgb(ypcbcr,rgb+3);
+		}
+	}
+
+void convertYpCbCr422ToYpCbCr(const unsigned char* src,unsigned int ypOffset,unsigned char* ypcbcr,unsigned int width)
+	{
+	unsigned int x=0;
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		for(;x+16<=width;x+=16,src+=32,ypcbcr+=48)
+			{
+			__m128i yp,cb,cr;
+			load422(src,ypOffset,yp,cb,cr);
+			storeRGB(yp,cb,cr,ypcbcr);
+			}
+		}
+	#endif
+	
+	/* Unpack the remaining pairs of pixels: */
+	for(;x<width;x+=2,src+=4,ypcbcr+=2*3)
+		{
+		ypcbcr[0]=src[ypOffset];
+		ypcbcr[1]=src[1-ypOffset];
+		ypcbcr[2]=src[3-ypOffset];
+		ypcbcr[3+0]=src[2+ypOffset];
+		ypcbcr[3+1]=src[1-ypOffset];
+		ypcbcr[3+2]=src[3-ypOffset];
+		}
+	}
+
+void splitYpCbCr422(const unsigned char* src,unsigned int ypOffset,unsigned int chromaIndex,unsigned char* yp,unsigned char* chroma,unsigned int width)
+	{
+	unsigned int x=0;
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		for(;x+16<=width;x+=16,src+=32,yp+=16,chroma+=8)
+			{
+			__m128i c16[2],yp16[2];
+			load422(src,ypOffset,c16,yp16);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(yp),_mm_packus_epi16(yp16[0],yp16[1]));
+			
+			/* Extract the requested chroma value of each pixel pair: */
+			for(int i=0;i<2;++i)
+				c16[i]=chromaIndex==0?_mm_and_si128(c16[i],_mm_set1_epi32(0x0000ffff)):_mm_srli_epi32(c16[i],16);
+			__m128i c8=_mm_packs_epi32(c16[0],c16[1]);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(chroma),_mm_packus_epi16(c8,c8));
+			}
+		}
+	#endif
+	
+	/* Split the remaining pairs of pixels: */
+	unsigned int chromaOffset=chromaIndex==0?1-ypOffset:3-ypOffset;
+	for(;x<width;x+=2,src+=4,yp+=2,++chroma)
+		{
+		yp[0]=src[ypOffset];
+		yp[1]=src[2+ypOffset];
+		*chroma=src[chromaOffset];
+		}
+	}
+
+void convertYpCbCr420ToRGB(const unsigned char* yp,const unsigned char* cb,const unsigned char* cr,unsigned char* rgb,unsigned int width)
+	{
+	unsigned int x=0;
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_AVX2
+	if(instructionSet>=AVX2)
+		{
+		x=convertYpCbCr420ToRGBAVX2(yp,cb,cr,rgb,width);
+		yp+=x;
+		cb+=x/2;
+		cr+=x/2;
+		rgb+=x*3;
+		}
+	#endif
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		for(;x+16<=width;x+=16,yp+=16,cb+=8,cr+=8,rgb+=48)
+			{
+			__m128i yp8=_mm_loadu_si128(reinterpret_cast<const __m128i*>(yp));
+			__m128i cb8=_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cb));
+			__m128i cr8=_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cr));
+			__m128i r,g,b;
+			convertYpCbCrToRGB(yp8,_mm_unpacklo_epi8(cb8,cb8),_mm_unpacklo_epi8(cr8,cr8),r,g,b);
+			storeRGB(r,g,b,rgb);
+			}
+		}
+	#endif
+	
+	/* Convert the remaining pairs of pixels: */
+	for(;x<width;x+=2,yp+=2,++cb,++cr,rgb+=2*3)
+		{
+		unsigned char ypcbcr[3];
+		ypcbcr[0]=yp[0];
+		ypcbcr[1]=*cb;
+		ypcbcr[2]=*cr;
+		Video::ypcbcrToRgb(ypcbcr,rgb);
+		ypcbcr[0]=yp[1];
+		Video::ypcbcrToRgb(ypcbcr,rgb+3);
+		}
+	}
+
+void convertRGBToGrey(const unsigned char* rgb,unsigned char* grey,unsigned int width)
+	{
+	unsigned int x=0;
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		for(;x+16<=width;x+=16,rgb+=48,grey+=16)
+			{
+			__m128i pixels[4],grey32[4];
+			loadRGB(rgb,pixels);
+			for(int i=0;i<4;++i)
+				{
+				__m128i rg,gb;
+				splitRGB(pixels[i],rg,gb);
+				grey32[i]=convertRGBToGrey32(rg,gb);
+				}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(grey),_mm_packus_epi16(_mm_packs_epi32(grey32[0],grey32[1]),_mm_packs_epi32(grey32[2],grey32[3])));
+			}
+		}
+	#endif
+	
+	/* Convert the remaining pixels: */
+	for(;x<width;++x,rgb+=3,++grey)
+		*grey=rgbToGrey(rgb[0],rgb[1],rgb[2]);
+	}
+
+void convertRGBToYpCbCr(const unsigned char* rgb,unsigned char* ypcbcr,unsigned int width)
+	{
+	unsigned int x=0;
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		/* All source pixels of a block are loaded before any result pixels are stored, to allow in-place conversion: */
+		for(;x+16<=width;x+=16,rgb+=48,ypcbcr+=48)
+			{
+			__m128i pixels[4],yp32[4],cb32[4],cr32[4];
+			loadRGB(rgb,pixels);
+			for(int i=0;i<4;++i)
+				{
+				__m128i rg,gb;
+				splitRGB(pixels[i],rg,gb);
+				convertRGBToYpCbCr32(rg,gb,yp32[i],cb32[i],cr32[i]);
+				}
+			__m128i yp=_mm_packus_epi16(_mm_packs_epi32(yp32[0],yp32[1]),_mm_packs_epi32(yp32[2],yp32[3]));
+			__m128i cb=_mm_packus_epi16(_mm_packs_epi32(cb32[0],cb32[1]),_mm_packs_epi32(cb32[2],cb32[3]));
+			__m128i cr=_mm_packus_epi16(_mm_packs_epi32(cr32[0],cr32[1]),_mm_packs_epi32(cr32[2],cr32[3]));
+			storeRGB(yp,cb,cr,ypcbcr);
+			}
+		}
+	#endif
+	
+	/* Convert the remaining pixels: */
+	for(;x<width;++x,rgb+=3,ypcbcr+=3)
+		{
+		/* Copy the RGB pixel as RGB->Y'CbCr conversion does not work in-place: */
+		unsigned char pixel[3];
+		for(int i=0;i<3;++i)
+			pixel[i]=rgb[i];
+		Video::rgbToYpcbcr(pixel,ypcbcr);
+		}
+	}
+
+void convertRGBToYpCbCr420(const unsigned char* rgb0,const unsigned char* rgb1,unsigned char* yp0,unsigned char* yp1,unsigned char* cb,unsigned char* cr,unsigned int width)
+	{
+	unsigned int x=0;
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		const __m128i zero=_mm_setzero_si128();
+		const __m128i max=_mm_set1_epi16(255);
+		const __m128i one=_mm_set1_epi16(1);
+		const __m128i two=_mm_set1_epi32(2);
+		for(;x+16<=width;x+=16,rgb0+=48,rgb1+=48,yp0+=16,yp1+=16,cb+=8,cr+=8)
+			{
+			/* Convert both rows to Y'CbCr and sum up the clamped chroma values of vertically adjacent pixels: */
+			__m128i cbSum[2],crSum[2];
+			for(int row=0;row<2;++row)
+				{
+				__m128i pixels[4],yp32[4],cb32[4],cr32[4];
+				loadRGB(row==0?rgb0:rgb1,pixels);
+				for(int i=0;i<4;++i)
+					{
+					__m128i rg,gb;
+					splitRGB(pixels[i],rg,gb);
+					convertRGBToYpCbCr32(rg,gb,yp32[i],cb32[i],cr32[i]);
+					}
+				__m128i yp=_mm_packus_epi16(_mm_packs_epi32(yp32[0],yp32[1]),_mm_packs_epi32(yp32[2],yp32[3]));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(row==0?yp0:yp1),yp);
+				for(int half=0;half<2;++half)
+					{
+					__m128i cb16=_mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(cb32[half*2],cb32[half*2+1]),zero),max);
+					__m128i cr16=_mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(cr32[half*2],cr32[half*2+1]),zero),max);
+					cbSum[half]=row==0?cb16:_mm_add_epi16(cbSum[half],cb16);
+					crSum[half]=row==0?cr16:_mm_add_epi16(crSum[half],cr16);
+					}
+				}
+			
+			/* Add horizontally adjacent sums and average: */
+			__m128i cb32[2],cr32[2];
+			for(int half=0;half<2;++half)
+				{
+				cb32[half]=_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cbSum[half],one),two),2);
+				cr32[half]=_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(crSum[half],one),two),2);
+				}
+			__m128i cb16=_mm_packs_epi32(cb32[0],cb32[1]);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(cb),_mm_packus_epi16(cb16,cb16));
+			__m128i cr16=_mm_packs_epi32(cr32[0],cr32[1]);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(cr),_mm_packus_epi16(cr16,cr16));
+			}
+		}
+	#endif
+	
+	/* Convert the remaining 2x2 pixel blocks: */
+	for(;x<width;x+=2,rgb0+=2*3,rgb1+=2*3,yp0+=2,yp1+=2,++cb,++cr)
+		{
+		unsigned char ypcbcr[4][3];
+		Video::rgbToYpcbcr(rgb0,ypcbcr[0]);
+		Video::rgbToYpcbcr(rgb0+3,ypcbcr[1]);
+		Video::rgbToYpcbcr(rgb1,ypcbcr[2]);
+		Video::rgbToYpcbcr(rgb1+3,ypcbcr[3]);
+		yp0[0]=ypcbcr[0][0];
+		yp0[1]=ypcbcr[1][0];
+		yp1[0]=ypcbcr[2][0];
+		yp1[1]=ypcbcr[3][0];
+		*cb=(unsigned char)((int(ypcbcr[0][1])+int(ypcbcr[1][1])+int(ypcbcr[2][1])+int(ypcbcr[3][1])+2)>>2);
+		*cr=(unsigned char)((int(ypcbcr[0][2])+int(ypcbcr[1][2])+int(ypcbcr[2][2])+int(ypcbcr[3][2])+2)>>2);
+		}
+	}
+
+void debayerToRGB(const unsigned char* raw,ptrdiff_t stride,bool firstIsGreen,bool rowIsRed,unsigned char* rgb,unsigned int numPairs)
+	{
+	unsigned int numPixels=numPairs*2;
+	unsigned int x=0;
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_AVX2
+	if(instructionSet>=AVX2)
+		{
+		x=debayerToRGBAVX2(raw,stride,firstIsGreen,rowIsRed,rgb,numPixels);
+		raw+=x;
+		rgb+=x*3;
+		}
+	#endif
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		for(;x+16<=numPixels;x+=16,raw+=16,rgb+=48)
+			{
+			__m128i r,g,b;
+			debayer(raw,stride,firstIsGreen,rowIsRed,r,g,b);
+			storeRGB(r,g,b,rgb);
+			}
+		}
+	#endif
+	
+	/* Interpolate the remaining pairs of pixels: */
+	for(;x<numPixels;x+=2,raw+=2,rgb+=2*3)
+		{
+		debayerPixel(raw,stride,firstIsGreen,rowIsRed,rgb);
+		debayerPixel(raw+1,stride,!firstIsGreen,rowIsRed,rgb+3);
+		}
+	}
+
+void debayerToGrey(const unsigned char* raw,ptrdiff_t stride,bool firstIsGreen,bool rowIsRed,unsigned char* grey,unsigned int numPairs)
+	{
+	unsigned int numPixels=numPairs*2;
+	unsigned int x=0;
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_AVX2
+	if(instructionSet>=AVX2)
+		{
+		x=debayerToGreyAVX2(raw,stride,firstIsGreen,rowIsRed,grey,numPixels);
+		raw+=x;
+		grey+=x;
+		}
+	#endif
+	
+	#if VIDEO_COLORSPACEKERNELS_HAVE_SSE2
+	if(instructionSet>=SSE2)
+		{
+		for(;x+16<=numPixels;x+=16,raw+=16,grey+=16)
+			{
+			__m128i r,g,b;
+			debayer(raw,stride,firstIsGreen,rowIsRed,r,g,b);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(grey),convertRGBToGrey(r,g,b));
+			}
+		}
+	#endif
+	
+	/* Interpolate the remaining pairs of pixels: */
+	for(;x<numPixels;x+=2,raw+=2,grey+=2)
+		{
+		unsigned char rgb[2][3];
+		debayerPixel(raw,stride,firstIsGreen,rowIsRed,rgb[0]);
+		debayerPixel(raw+1,stride,!firstIsGreen,rowIsRed,rgb[1]);
+		grey[0]=rgbToGrey(rgb[0][0],rgb[0][1],rgb[0][2]);
+		grey[1]=rgbToGrey(rgb[1][0],rgb[1][1],rgb[1][2]);
+		}
+	}
+
+}
+
+}
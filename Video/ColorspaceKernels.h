@@ -0,0 +1,58 @@
+/***********************************************************************
+ColorspaceKernels - Functions to convert rows of pixels between the raw
+formats handled by image extractors and greyscale, RGB, or Y'CbCr, using
+SSE2 or AVX2 instructions where available. All kernels return results
+bit-identical to the scalar conversion functions in Colorspaces.h.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Basic Video Library (Video).
+
+The Basic Video Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Basic Video Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Basic Video Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef VIDEO_COLORSPACEKERNELS_INCLUDED
+#define VIDEO_COLORSPACEKERNELS_INCLUDED
+
+#include <stddef.h>
+
+namespace Video {
+
+namespace ColorspaceKernels {
+
+enum InstructionSet // Enumerated type for instruction sets used by the kernels
+	{
+	SCALAR=0,SSE2,AVX2
+	};
+
+InstructionSet getInstructionSet(void); // Returns the instruction set selected for the host CPU
+void setInstructionSet(InstructionSet newInstructionSet); // Overrides the selected instruction set; instruction sets not supported by the host CPU or the build are reduced to the best supported one
+
+void convertYpToY(const unsigned char* yp,unsigned char* y,unsigned int width); // Converts a row of Y' values to Y
+void convertYpCbCr422ToY(const unsigned char* src,unsigned int ypOffset,unsigned char* y,unsigned int width); // Converts a row of packed 4:2:2 Y'CbCr pixels to Y; Y' offset is 0 for YUYV and 1 for UYVY
+void convertYpCbCr422ToRGB(const unsigned char* src,unsigned int ypOffset,unsigned char* rgb,unsigned int width); // Converts a row of packed 4:2:2 Y'CbCr pixels to RGB; Y' offset is 0 for YUYV and 1 for UYVY; width must be even
+void convertYpCbCr422ToYpCbCr(const unsigned char* src,unsigned int ypOffset,unsigned char* ypcbcr,unsigned int width); // Unpacks a row of packed 4:2:2 Y'CbCr pixels to 4:4:4 Y'CbCr
+void splitYpCbCr422(const unsigned char* src,unsigned int ypOffset,unsigned int chromaIndex,unsigned char* yp,unsigned char* chroma,unsigned int width); // Splits a row of packed 4:2:2 Y'CbCr pixels into a Y' row and a Cb (chroma index 0) or Cr (chroma index 1) row of half width
+void convertYpCbCr420ToRGB(const unsigned char* yp,const unsigned char* cb,const unsigned char* cr,unsigned char* rgb,unsigned int width); // Converts a row of Y' pixels and half-width rows of Cb and Cr pixels to RGB; width must be even
+void convertRGBToGrey(const unsigned char* rgb,unsigned char* grey,unsigned int width); // Converts a row of RGB pixels to greyscale
+void convertRGBToYpCbCr(const unsigned char* rgb,unsigned char* ypcbcr,unsigned int width); // Converts a row of RGB pixels to Y'CbCr; source and destination may be identical
+void convertRGBToYpCbCr420(const unsigned char* rgb0,const unsigned char* rgb1,unsigned char* yp0,unsigned char* yp1,unsigned char* cb,unsigned char* cr,unsigned int width); // Converts two rows of RGB pixels to two rows of Y' and one half-width row each of Cb and Cr, averaging chroma over 2x2 blocks; width must be even
+void debayerToRGB(const unsigned char* raw,ptrdiff_t stride,bool firstIsGreen,bool rowIsRed,unsigned char* rgb,unsigned int numPairs); // Interpolates the given number of pixel pairs in an interior row of a Bayer-filtered image to RGB; raw points to the first pixel of the first pair, which must not be in the first or last column or row; flags indicate whether the first pixel of each pair is green and whether the row's non-green pixels are red
+void debayerToGrey(const unsigned char* raw,ptrdiff_t stride,bool firstIsGreen,bool rowIsRed,unsigned char* grey,unsigned int numPairs); // Ditto, converting interpolated RGB to greyscale
+
+}
+
+}
+
+#endif
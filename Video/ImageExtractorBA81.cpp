@@ -24,7 +24,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <Misc/SizedTypes.h>
 #include <Video/FrameBuffer.h>
-#include <Video/Colorspaces.h>
+#include <Video/ColorspaceKernels.h>
 
 namespace Video {
 
@@ -64,6 +64,7 @@ void ImageExtractorBA81::extractGreyFromBGGR(const FrameBuffer* frame,void* imag
 	{
 	/* Convert the Bayer-filtered image to greyscale via RGB: */
 	int stride=size[0];
+	unsigned int numCentralPairs=(size[0]-1)/2;
 	const unsigned char* rRowPtr=frame->start;
 	unsigned char* cRowPtr=reinterpret_cast<unsigned char*>(image);
 	cRowPtr+=(size[1]-1)*stride;
@@ -107,16 +108,9 @@ void ImageExtractorBA81::extractGreyFromBGGR(const FrameBuffer* frame,void* imag
 		++rPtr;
 		
 		/* Convert the odd row's central pixels: */
-		for(unsigned x=1;x<size[0]-1;x+=2)
-			{
-			/* Convert the odd (R) pixel: */
-			*(cPtr++)=rgbToGrey(rPtr[0],avg(rPtr[-stride],rPtr[-1],rPtr[1],rPtr[stride]),avg(rPtr[-stride-1],rPtr[-stride+1],rPtr[stride-1],rPtr[stride+1]));
-			++rPtr;
-			
-			/* Convert the even (G) pixel: */
-			*(cPtr++)=rgbToGrey(avg(rPtr[-1],rPtr[1]),rPtr[0],avg(rPtr[-stride],rPtr[stride]));
-			++rPtr;
-			}
+		ColorspaceKernels::debayerToGrey(rPtr,stride,false,true,cPtr,numCentralPairs);
+		rPtr+=numCentralPairs*2;
+		cPtr+=numCentralPairs*2;
 		
 		/* Convert the odd row's last (R) pixel: */
 		*(cPtr++)=rgbToGrey(rPtr[0],avg(rPtr[-stride],rPtr[-1],rPtr[stride]),avg(rPtr[-stride-1],rPtr[stride-1]));
@@ -134,16 +128,9 @@ void ImageExtractorBA81::extractGreyFromBGGR(const FrameBuffer* frame,void* imag
 		++rPtr;
 		
 		/* Convert the even row's central pixels: */
-		for(unsigned x=1;x<size[0]-1;x+=2)
-			{
-			/* Convert the odd (G) pixel: */
-			*(cPtr++)=rgbToGrey(avg(rPtr[-stride],rPtr[stride]),rPtr[0],avg(rPtr[-1],rPtr[1]));
-			++rPtr;
-			
-			/* Convert the even (B) pixel: */
-			*(cPtr++)=rgbToGrey(avg(rPtr[-stride-1],rPtr[-stride+1],rPtr[stride-1],rPtr[stride+1]),avg(rPtr[-stride],rPtr[-1],rPtr[1],rPtr[stride]),rPtr[0]);
-			++rPtr;
-			}
+		ColorspaceKernels::debayerToGrey(rPtr,stride,true,false,cPtr,numCentralPairs);
+		rPtr+=numCentralPairs*2;
+		cPtr+=numCentralPairs*2;
 		
 		/* Convert the even row's last (G) pixel: */
 		*(cPtr++)=rgbToGrey(avg(rPtr[-stride],rPtr[stride]),rPtr[0],rPtr[-1]);
@@ -181,6 +168,7 @@ void ImageExtractorBA81::extractGreyFromRGGB(const FrameBuffer* frame,void* imag
 	{
 	/* Convert the Bayer-filtered image to greyscale via RGB: */
 	int stride=size[0];
+	unsigned int numCentralPairs=(size[0]-1)/2;
 	const unsigned char* rRowPtr=frame->start;
 	unsigned char* cRowPtr=reinterpret_cast<unsigned char*>(image);
 	cRowPtr+=(size[1]-1)*stride;
@@ -224,16 +212,9 @@ void ImageExtractorBA81::extractGreyFromRGGB(const FrameBuffer* frame,void* imag
 		++rPtr;
 		
 		/* Convert the odd row's central pixels: */
-		for(unsigned x=1;x<size[0]-1;x+=2)
-			{
-			/* Convert the odd (B) pixel: */
-			*(cPtr++)=rgbToGrey(avg(rPtr[-stride-1],rPtr[-stride+1],rPtr[stride-1],rPtr[stride+1]),avg(rPtr[-stride],rPtr[-1],rPtr[1],rPtr[stride]),rPtr[0]);
-			++rPtr;
-			
-			/* Convert the even (G) pixel: */
-			*(cPtr++)=rgbToGrey(avg(rPtr[-stride],rPtr[stride]),rPtr[0],avg(rPtr[-1],rPtr[1]));
-			++rPtr;
-			}
+		ColorspaceKernels::debayerToGrey(rPtr,stride,false,false,cPtr,numCentralPairs);
+		rPtr+=numCentralPairs*2;
+		cPtr+=numCentralPairs*2;
 		
 		/* Convert the odd row's last (B) pixel: */
 		*(cPtr++)=rgbToGrey(avg(rPtr[-stride-1],rPtr[stride-1]),avg(rPtr[-stride],rPtr[-1],rPtr[stride]),rPtr[0]);
@@ -251,16 +232,9 @@ void ImageExtractorBA81::extractGreyFromRGGB(const FrameBuffer* frame,void* imag
 		++rPtr;
 		
 		/* Convert the even row's central pixels: */
-		for(unsigned x=1;x<size[0]-1;x+=2)
-			{
-			/* Convert the odd (G) pixel: */
-			*(cPtr++)=rgbToGrey(avg(rPtr[-1],rPtr[1]),rPtr[0],avg(rPtr[-stride],rPtr[stride]));
-			++rPtr;
-			
-			/* Convert the even (R) pixel: */
-			*(cPtr++)=rgbToGrey(rPtr[0],avg(rPtr[-stride],rPtr[-1],rPtr[1],rPtr[stride]),avg(rPtr[-stride-1],rPtr[-stride+1],rPtr[stride-1],rPtr[stride+1]));
-			++rPtr;
-			}
+		ColorspaceKernels::debayerToGrey(rPtr,stride,true,true,cPtr,numCentralPairs);
+		rPtr+=numCentralPairs*2;
+		cPtr+=numCentralPairs*2;
 		
 		/* Convert the even row's last (G) pixel: */
 		*(cPtr++)=rgbToGrey(rPtr[-1],rPtr[0],avg(rPtr[-stride],rPtr[stride]));
@@ -298,6 +272,7 @@ void ImageExtractorBA81::extractRGBFromBGGR(const FrameBuffer* frame,void* image
 	{
 	/* Convert the Bayer-filtered image to RGB: */
 	int stride=size[0];
+	unsigned int numCentralPairs=(size[0]-1)/2;
 	const unsigned char* rRowPtr=frame->start;
 	unsigned char* cRowPtr=reinterpret_cast<unsigned char*>(image);
 	cRowPtr+=(size[1]-1)*stride*3;
@@ -351,20 +326,9 @@ void ImageExtractorBA81::extractRGBFromBGGR(const FrameBuffer* frame,void* image
 		++rPtr;
 		
 		/* Convert the odd row's central pixels: */
-		for(unsigned x=1;x<size[0]-1;x+=2)
-			{
-			/* Convert the odd (R) pixel: */
-			*(cPtr++)=rPtr[0];
-			*(cPtr++)=avg(rPtr[-stride],rPtr[-1],rPtr[1],rPtr[stride]);
-			*(cPtr++)=avg(rPtr[-stride-1],rPtr[-stride+1],rPtr[stride-1],rPtr[stride+1]);
-			++rPtr;
-			
-			/* Convert the even (G) pixel: */
-			*(cPtr++)=avg(rPtr[-1],rPtr[1]);
-			*(cPtr++)=rPtr[0];
-			*(cPtr++)=avg(rPtr[-stride],rPtr[stride]);
-			++rPtr;
-			}
+		ColorspaceKernels::debayerToRGB(rPtr,stride,false,true,cPtr,numCentralPairs);
+		rPtr+=numCentralPairs*2;
+		cPtr+=numCentralPairs*2*3;
 		
 		/* Convert the odd row's last (R) pixel: */
 		*(cPtr++)=rPtr[0];
@@ -386,20 +350,9 @@ void ImageExtractorBA81::extractRGBFromBGGR(const FrameBuffer* frame,void* image
 		++rPtr;
 		
 		/* Convert the even row's central pixels: */
-		for(unsigned x=1;x<size[0]-1;x+=2)
-			{
-			/* Convert the odd (G) pixel: */
-			*(cPtr++)=avg(rPtr[-stride],rPtr[stride]);
-			*(cPtr++)=rPtr[0];
-			*(cPtr++)=avg(rPtr[-1],rPtr[1]);
-			++rPtr;
-			
-			/* Convert the even (B) pixel: */
-			*(cPtr++)=avg(rPtr[-stride-1],rPtr[-stride+1],rPtr[stride-1],rPtr[stride+1]);
-			*(cPtr++)=avg(rPtr[-stride],rPtr[-1],rPtr[1],rPtr[stride]);
-			*(cPtr++)=rPtr[0];
-			++rPtr;
-			}
+		ColorspaceKernels::debayerToRGB(rPtr,stride,true,false,cPtr,numCentralPairs);
+		rPtr+=numCentralPairs*2;
+		cPtr+=numCentralPairs*2*3;
 		
 		/* Convert the even row's last (G) pixel: */
 		*(cPtr++)=avg(rPtr[-stride],rPtr[stride]);
@@ -447,6 +400,7 @@ void ImageExtractorBA81::extractRGBFromRGGB(const FrameBuffer* frame,void* image
 	{
 	/* Convert the Bayer-filtered image to RGB: */
 	int stride=size[0];
+	unsigned int numCentralPairs=(size[0]-1)/2;
 	const unsigned char* rRowPtr=frame->start;
 	unsigned char* cRowPtr=reinterpret_cast<unsigned char*>(image);
 	cRowPtr+=(size[1]-1)*stride*3;
@@ -500,20 +454,9 @@ void ImageExtractorBA81::extractRGBFromRGGB(const FrameBuffer* frame,void* image
 		++rPtr;
 		
 		/* Convert the odd row's central pixels: */
-		for(unsigned x=1;x<size[0]-1;x+=2)
-			{
-			/* Convert the odd (B) pixel: */
-			*(cPtr++)=avg(rPtr[-stride-1],rPtr[-stride+1],rPtr[stride-1],rPtr[stride+1]);
-			*(cPtr++)=avg(rPtr[-stride],rPtr[-1],rPtr[1],rPtr[stride]);
-			*(cPtr++)=rPtr[0];
-			++rPtr;
-			
-			/* Convert the even (G) pixel: */
-			*(cPtr++)=avg(rPtr[-stride],rPtr[stride]);
-			*(cPtr++)=rPtr[0];
-			*(cPtr++)=avg(rPtr[-1],rPtr[1]);
-			++rPtr;
-			}
+		ColorspaceKernels::debayerToRGB(rPtr,stride,false,false,cPtr,numCentralPairs);
+		rPtr+=numCentralPairs*2;
+		cPtr+=numCentralPairs*2*3;
 		
 		/* Convert the odd row's last (B) pixel: */
 		*(cPtr++)=avg(rPtr[-stride-1],rPtr[stride-1]);
@@ -535,20 +478,9 @@ void ImageExtractorBA81::extractRGBFromRGGB(const FrameBuffer* frame,void* image
 		++rPtr;
 		
 		/* Convert the even row's central pixels: */
-		for(unsigned x=1;x<size[0]-1;x+=2)
-			{
-			/* Convert the odd (G) pixel: */
-			*(cPtr++)=avg(rPtr[-1],rPtr[1]);
-			*(cPtr++)=rPtr[0];
-			*(cPtr++)=avg(rPtr[-stride],rPtr[stride]);
-			++rPtr;
-			
-			/* Convert the even (R) pixel: */
-			*(cPtr++)=rPtr[0];
-			*(cPtr++)=avg(rPtr[-stride],rPtr[-1],rPtr[1],rPtr[stride]);
-			*(cPtr++)=avg(rPtr[-stride-1],rPtr[-stride+1],rPtr[stride-1],rPtr[stride+1]);
-			++rPtr;
-			}
+		ColorspaceKernels::debayerToRGB(rPtr,stride,true,true,cPtr,numCentralPairs);
+		rPtr+=numCentralPairs*2;
+		cPtr+=numCentralPairs*2*3;
 		
 		/* Convert the even row's last (G) pixel: */
 		*(cPtr++)=rPtr[-1];
@@ -650,16 +582,8 @@ void ImageExtractorBA81::extractYpCbCr(const FrameBuffer* frame,void* image)
 			;
 		}
 	
-	/* Convert the extracted RGB image to YpCbCr: */
-	unsigned char* cPtr=static_cast<unsigned char*>(image);
-	for(unsigned int i=size[1]*size[0];i>0;--i,cPtr+=3)
-		{
-		/* Copy RGB pixel as RGB->Y'CbCr conversion does not work in-place: */
-		unsigned char rgb[3];
-		for(int i=0;i<3;++i)
-			rgb[i]=cPtr[i];
-		Video::rgbToYpcbcr(rgb,cPtr);
-		}
+	/* Convert the extracted RGB image to YpCbCr in-place: */
+	ColorspaceKernels::convertRGBToYpCbCr(static_cast<unsigned char*>(image),static_cast<unsigned char*>(image),size[1]*size[0]);
 	}
 
 void ImageExtractorBA81::extractYpCbCr420(const FrameBuffer* frame,void* yp,unsigned int ypStride,void* cb,unsigned int cbStride,void* cr,unsigned int crStride)
@@ -687,33 +611,8 @@ void ImageExtractorBA81::extractYpCbCr420(const FrameBuffer* frame,void* yp,unsi
 	unsigned char* crRowPtr=static_cast<unsigned char*>(cr);
 	for(unsigned int y=0;y<size[1];y+=2)
 		{
-		const unsigned char* fPtr=fRowPtr;
-		unsigned char* ypPtr=ypRowPtr;
-		unsigned char* cbPtr=cbRowPtr;
-		unsigned char* crPtr=crRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2)
-			{
-			/* Convert the 2x2 pixel block to Y'CbCr: */
-			unsigned char ypcbcr[4][3];
-			Video::rgbToYpcbcr(fPtr,ypcbcr[0]);
-			Video::rgbToYpcbcr(fPtr+3,ypcbcr[1]);
-			Video::rgbToYpcbcr(fPtr-size[0]*3,ypcbcr[2]);
-			Video::rgbToYpcbcr(fPtr-size[0]*3+3,ypcbcr[3]);
-			
-			/* Subsample and store the Y'CbCr components: */
-			ypPtr[0]=ypcbcr[0][0];
-			ypPtr[1]=ypcbcr[1][0];
-			ypPtr[ypStride]=ypcbcr[2][0];
-			ypPtr[ypStride+1]=ypcbcr[3][0];
-			*cbPtr=(unsigned char)((int(ypcbcr[0][1])+int(ypcbcr[1][1])+int(ypcbcr[2][1])+int(ypcbcr[3][1])+2)>>2);
-			*crPtr=(unsigned char)((int(ypcbcr[0][2])+int(ypcbcr[1][2])+int(ypcbcr[2][2])+int(ypcbcr[3][2])+2)>>2);
-			
-			/* Go to the next pixel: */
-			fPtr+=3*2;
-			ypPtr+=2;
-			++cbPtr;
-			++crPtr;
-			}
+		/* Convert the pair of pixel rows to Y'CbCr: */
+		ColorspaceKernels::convertRGBToYpCbCr420(fRowPtr,fRowPtr-size[0]*3,ypRowPtr,ypRowPtr+ypStride,cbRowPtr,crRowPtr,size[0]);
 		
 		/* Go to the next pixel row: */
 		fRowPtr-=size[0]*3*2;
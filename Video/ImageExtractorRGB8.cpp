@@ -24,7 +24,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <string.h>
 #include <Video/FrameBuffer.h>
-#include <Video/Colorspaces.h>
+#include <Video/ColorspaceKernels.h>
 
 namespace Video {
 
@@ -46,15 +46,7 @@ void ImageExtractorRGB8::extractGrey(const FrameBuffer* frame,void* image)
 	unsigned char* gRowPtr=static_cast<unsigned char*>(image);
 	gRowPtr+=(size[1]-1)*size[0];
 	for(unsigned int y=0;y<size[1];++y,rRowPtr+=size[0]*3,gRowPtr-=size[0])
-		{
-		const unsigned char* rPtr=rRowPtr;
-		unsigned char* gPtr=gRowPtr;
-		for(unsigned int x=0;x<size[0];++x,++gPtr,rPtr+=3)
-			{
-			/* Convert RGB to grey: */
-			*gPtr=(unsigned char)(((unsigned int)rPtr[0]*306U+(unsigned int)rPtr[1]*601U+(unsigned int)rPtr[2]*117U+512U)>>10);
-			}
-		}
+		ColorspaceKernels::convertRGBToGrey(rRowPtr,gRowPtr,size[0]);
 	}
 
 void ImageExtractorRGB8::extractRGB(const FrameBuffer* frame,void* image)
@@ -70,15 +62,7 @@ void ImageExtractorRGB8::extractYpCbCr(const FrameBuffer* frame,void* image)
 	unsigned char* cRowPtr=static_cast<unsigned char*>(image);
 	cRowPtr+=(size[1]-1)*size[0]*3;
 	for(unsigned int y=0;y<size[1];++y,rRowPtr+=size[0]*3,cRowPtr-=size[0]*3)
-		{
-		const unsigned char* rPtr=rRowPtr;
-		unsigned char* cPtr=cRowPtr;
-		for(unsigned int x=0;x<size[0];++x,cPtr+=3,rPtr+=3)
-			{
-			/* Convert the pixel: */
-			Video::rgbToYpcbcr(rPtr,cPtr);
-			}
-		}
+		ColorspaceKernels::convertRGBToYpCbCr(rRowPtr,cRowPtr,size[0]);
 	}
 
 void ImageExtractorRGB8::extractYpCbCr420(const FrameBuffer* frame,void* yp,unsigned int ypStride,void* cb,unsigned int cbStride,void* cr,unsigned int crStride)
@@ -90,33 +74,8 @@ void ImageExtractorRGB8::extractYpCbCr420(const FrameBuffer* frame,void* yp,unsi
 	unsigned char* crRowPtr=static_cast<unsigned char*>(cr);
 	for(unsigned int y=0;y<size[1];y+=2)
 		{
-		const unsigned char* fPtr=fRowPtr;
-		unsigned char* ypPtr=ypRowPtr;
-		unsigned char* cbPtr=cbRowPtr;
-		unsigned char* crPtr=crRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2)
-			{
-			/* Convert the 2x2 pixel block to Y'CbCr: */
-			unsigned char ypcbcr[4][3];
-			Video::rgbToYpcbcr(fPtr,ypcbcr[0]);
-			Video::rgbToYpcbcr(fPtr+3,ypcbcr[1]);
-			Video::rgbToYpcbcr(fPtr-size[0]*3,ypcbcr[2]);
-			Video::rgbToYpcbcr(fPtr-size[0]*3+3,ypcbcr[3]);
-			
-			/* Subsample and store the Y'CbCr components: */
-			ypPtr[0]=ypcbcr[0][0];
-			ypPtr[1]=ypcbcr[1][0];
-			ypPtr[ypStride]=ypcbcr[2][0];
-			ypPtr[ypStride+1]=ypcbcr[3][0];
-			*cbPtr=(unsigned char)((int(ypcbcr[0][1])+int(ypcbcr[1][1])+int(ypcbcr[2][1])+int(ypcbcr[3][1])+2)>>2);
-			*crPtr=(unsigned char)((int(ypcbcr[0][2])+int(ypcbcr[1][2])+int(ypcbcr[2][2])+int(ypcbcr[3][2])+2)>>2);
-			
-			/* Go to the next pixel: */
-			fPtr+=3*2;
-			ypPtr+=2;
-			++cbPtr;
-			++crPtr;
-			}
+		/* Convert the pair of pixel rows to Y'CbCr: */
+		ColorspaceKernels::convertRGBToYpCbCr420(fRowPtr,fRowPtr-size[0]*3,ypRowPtr,ypRowPtr+ypStride,cbRowPtr,crRowPtr,size[0]);
 		
 		/* Go to the next pixel row: */
 		fRowPtr-=size[0]*3*2;
@@ -23,7 +23,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Video/ImageExtractorUYVY.h>
 
 #include <Video/FrameBuffer.h>
-#include <Video/Colorspaces.h>
+#include <Video/ColorspaceKernels.h>
 
 namespace Video {
 
@@ -41,24 +41,11 @@ ImageExtractorUYVY::ImageExtractorUYVY(const unsigned int sSize[2])
 void ImageExtractorUYVY::extractGrey(const FrameBuffer* frame,void* image)
 	{
 	/* Convert the frame's Y' channel to Y: */
-	const unsigned char* rRowPtr=frame->start+1;
+	const unsigned char* rRowPtr=frame->start;
 	unsigned char* gRowPtr=static_cast<unsigned char*>(image);
 	gRowPtr+=(size[1]-1)*size[0];
 	for(unsigned int y=0;y<size[1];++y,rRowPtr+=size[0]*2,gRowPtr-=size[0])
-		{
-		const unsigned char* rPtr=rRowPtr;
-		unsigned char* gPtr=gRowPtr;
-		for(unsigned int x=0;x<size[0];++x,++gPtr,rPtr+=2)
-			{
-			/* Convert from Y' to Y: */
-			if(*rPtr<=16)
-				*gPtr=0;
-			else if(*rPtr>=236)
-				*gPtr=255;
-			else
-				*gPtr=(unsigned char)(((int(rPtr[0])-16)*256)/220);
-			}
-		}
+		ColorspaceKernels::convertYpCbCr422ToY(rRowPtr,1,gRowPtr,size[0]);
 	}
 
 void ImageExtractorUYVY::extractRGB(const FrameBuffer* frame,void* image)
@@ -68,23 +55,7 @@ void ImageExtractorUYVY::extractRGB(const FrameBuffer* frame,void* image)
 	unsigned char* cRowPtr=static_cast<unsigned char*>(image);
 	cRowPtr+=(size[1]-1)*size[0]*3;
 	for(unsigned int y=0;y<size[1];++y,rRowPtr+=size[0]*2,cRowPtr-=size[0]*3)
-		{
-		const unsigned char* rPtr=rRowPtr;
-		unsigned char* cPtr=cRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2,cPtr+=2*3,rPtr+=4)
-			{
-			/* Convert first pixel: */
-			unsigned char ypcbcr[3];
-			ypcbcr[0]=rPtr[1];
-			ypcbcr[1]=rPtr[0];
-			ypcbcr[2]=rPtr[2];
-			Video::ypcbcrToRgb(ypcbcr,cPtr);
-			
-			/* Convert second pixel: */
-			ypcbcr[0]=rPtr[3];
-			Video::ypcbcrToRgb(ypcbcr,cPtr+3);
-			}
-		}
+		ColorspaceKernels::convertYpCbCr422ToRGB(rRowPtr,1,cRowPtr,size[0]);
 	}
 
 void ImageExtractorUYVY::extractYpCbCr(const FrameBuffer* frame,void* image)
@@ -94,22 +65,7 @@ void ImageExtractorUYVY::extractYpCbCr(const FrameBuffer* frame,void* image)
 	unsigned char* cRowPtr=static_cast<unsigned char*>(image);
 	cRowPtr+=(size[1]-1)*size[0]*3;
 	for(unsigned int y=0;y<size[1];++y,rRowPtr+=size[0]*2,cRowPtr-=size[0]*3)
-		{
-		const unsigned char* rPtr=rRowPtr;
-		unsigned char* cPtr=cRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2,cPtr+=2*3,rPtr+=4)
-			{
-			/* Unpack first pixel: */
-			cPtr[0]=rPtr[1];
-			cPtr[1]=rPtr[0];
-			cPtr[2]=rPtr[2];
-			
-			/* Unpack second pixel: */
-			cPtr[3+0]=rPtr[3];
-			cPtr[3+1]=rPtr[0];
-			cPtr[3+2]=rPtr[2];
-			}
-		}
+		ColorspaceKernels::convertYpCbCr422ToYpCbCr(rRowPtr,1,cRowPtr,size[0]);
 	}
 
 void ImageExtractorUYVY::extractYpCbCr420(const FrameBuffer* frame,void* yp,unsigned int ypStride,void* cb,unsigned int cbStride,void* cr,unsigned int crStride)
@@ -122,34 +78,14 @@ void ImageExtractorUYVY::extractYpCbCr420(const FrameBuffer* frame,void* yp,unsi
 	for(unsigned int y=0;y<size[1];y+=2)
 		{
 		/* Process an even row by keeping its Cb values: */
-		unsigned char* ypPtr=ypRowPtr;
-		unsigned char* cbPtr=cbRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2)
-			{
-			/* Get Cb and Y' from even pixel: */
-			*(cbPtr++)=*(framePtr++);
-			*(ypPtr++)=*(framePtr++);
-			
-			/* Get Y' from odd pixel: */
-			++framePtr;
-			*(ypPtr++)=*(framePtr++);
-			}
+		ColorspaceKernels::splitYpCbCr422(framePtr,1,0,ypRowPtr,cbRowPtr,size[0]);
+		framePtr+=size[0]*2;
 		ypRowPtr+=ypStride;
 		cbRowPtr+=cbStride;
 		
 		/* Process an odd row by keeping its Cr values: */
-		ypPtr=ypRowPtr;
-		unsigned char* crPtr=crRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2)
-			{
-			/* Get Y' from even pixel: */
-			++framePtr;
-			*(ypPtr++)=*(framePtr++);
-			
-			/* Get Cr and Y' from odd pixel: */
-			*(crPtr++)=*(framePtr++);
-			*(ypPtr++)=*(framePtr++);
-			}
+		ColorspaceKernels::splitYpCbCr422(framePtr,1,1,ypRowPtr,crRowPtr,size[0]);
+		framePtr+=size[0]*2;
 		ypRowPtr+=ypStride;
 		crRowPtr+=crStride;
 		}
@@ -23,7 +23,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Video/ImageExtractorYUYV.h>
 
 #include <Video/FrameBuffer.h>
-#include <Video/Colorspaces.h>
+#include <Video/ColorspaceKernels.h>
 
 namespace Video {
 
@@ -45,20 +45,7 @@ void ImageExtractorYUYV::extractGrey(const FrameBuffer* frame,void* image)
 	unsigned char* gRowPtr=static_cast<unsigned char*>(image);
 	gRowPtr+=(size[1]-1)*size[0];
 	for(unsigned int y=0;y<size[1];++y,rRowPtr+=size[0]*2,gRowPtr-=size[0])
-		{
-		const unsigned char* rPtr=rRowPtr;
-		unsigned char* gPtr=gRowPtr;
-		for(unsigned int x=0;x<size[0];++x,++gPtr,rPtr+=2)
-			{
-			/* Convert from Y' to Y: */
-			if(*rPtr<=16)
-				*gPtr=0;
-			else if(*rPtr>=236)
-				*gPtr=255;
-			else
-				*gPtr=(unsigned char)(((int(rPtr[0])-16)*256)/220);
-			}
-		}
+		ColorspaceKernels::convertYpCbCr422ToY(rRowPtr,0,gRowPtr,size[0]);
 	}
 
 void ImageExtractorYUYV::extractRGB(const FrameBuffer* frame,void* image)
@@ -68,23 +55,7 @@ void ImageExtractorYUYV::extractRGB(const FrameBuffer* frame,void* image)
 	unsigned char* cRowPtr=static_cast<unsigned char*>(image);
 	cRowPtr+=(size[1]-1)*size[0]*3;
 	for(unsigned int y=0;y<size[1];++y,rRowPtr+=size[0]*2,cRowPtr-=size[0]*3)
-		{
-		const unsigned char* rPtr=rRowPtr;
-		unsigned char* cPtr=cRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2,cPtr+=2*3,rPtr+=4)
-			{
-			/* Convert first pixel: */
-			unsigned char ypcbcr[3];
-			ypcbcr[0]=rPtr[0];
-			ypcbcr[1]=rPtr[1];
-			ypcbcr[2]=rPtr[3];
-			Video::ypcbcrToRgb(ypcbcr,cPtr);
-			
-			/* Convert second pixel: */
-			ypcbcr[0]=rPtr[2];
-			Video::ypcbcrToRgb(ypcbcr,cPtr+3);
-			}
-		}
+		ColorspaceKernels::convertYpCbCr422ToRGB(rRowPtr,0,cRowPtr,size[0]);
 	}
 
 void ImageExtractorYUYV::extractYpCbCr(const FrameBuffer* frame,void* image)
@@ -94,22 +65,7 @@ void ImageExtractorYUYV::extractYpCbCr(const FrameBuffer* frame,void* image)
 	unsigned char* cRowPtr=static_cast<unsigned char*>(image);
 	cRowPtr+=(size[1]-1)*size[0]*3;
 	for(unsigned int y=0;y<size[1];++y,rRowPtr+=size[0]*2,cRowPtr-=size[0]*3)
-		{
-		const unsigned char* rPtr=rRowPtr;
-		unsigned char* cPtr=cRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2,cPtr+=2*3,rPtr+=4)
-			{
-			/* Unpack first pixel: */
-			cPtr[0]=rPtr[0];
-			cPtr[1]=rPtr[1];
-			cPtr[2]=rPtr[3];
-			
-			/* Unpack second pixel: */
-			cPtr[3+0]=rPtr[2];
-			cPtr[3+1]=rPtr[1];
-			cPtr[3+2]=rPtr[3];
-			}
-		}
+		ColorspaceKernels::convertYpCbCr422ToYpCbCr(rRowPtr,0,cRowPtr,size[0]);
 	}
 
 void ImageExtractorYUYV::extractYpCbCr420(const FrameBuffer* frame,void* yp,unsigned int ypStride,void* cb,unsigned int cbStride,void* cr,unsigned int crStride)
@@ -122,34 +78,14 @@ void ImageExtractorYUYV::extractYpCbCr420(const FrameBuffer* frame,void* yp,unsi
 	for(unsigned int y=0;y<size[1];y+=2)
 		{
 		/* Process an even row by keeping its Cb values: */
-		unsigned char* ypPtr=ypRowPtr;
-		unsigned char* cbPtr=cbRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2)
-			{
-			/* Get Yp and Cb from even pixel: */
-			*(ypPtr++)=*(framePtr++);
-			*(cbPtr++)=*(framePtr++);
-			
-			/* Get Yp from odd pixel: */
-			*(ypPtr++)=*(framePtr++);
-			++framePtr;
-			}
+		ColorspaceKernels::splitYpCbCr422(framePtr,0,0,ypRowPtr,cbRowPtr,size[0]);
+		framePtr+=size[0]*2;
 		ypRowPtr+=ypStride;
 		cbRowPtr+=cbStride;
 		
 		/* Process an odd row by keeping its Cr values: */
-		ypPtr=ypRowPtr;
-		unsigned char* crPtr=crRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2)
-			{
-			/* Get Yp from even pixel: */
-			*(ypPtr++)=*(framePtr++);
-			++framePtr;
-			
-			/* Get Yp and Cr from odd pixel: */
-			*(ypPtr++)=*(framePtr++);
-			*(crPtr++)=*(framePtr++);
-			}
+		ColorspaceKernels::splitYpCbCr422(framePtr,0,1,ypRowPtr,crRowPtr,size[0]);
+		framePtr+=size[0]*2;
 		ypRowPtr+=ypStride;
 		crRowPtr+=crStride;
 		}
@@ -24,7 +24,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <string.h>
 #include <Video/FrameBuffer.h>
-#include <Video/Colorspaces.h>
+#include <Video/ColorspaceKernels.h>
 
 namespace Video {
 
@@ -54,60 +54,21 @@ void ImageExtractorYV12::extractGrey(const FrameBuffer* frame,void* image)
 	unsigned char* gRowPtr=static_cast<unsigned char*>(image);
 	gRowPtr+=(size[1]-1)*size[0];
 	for(unsigned int y=0;y<size[1];++y,rRowPtr+=planes[0].stride,gRowPtr-=size[0])
-		{
-		const unsigned char* rPtr=rRowPtr;
-		unsigned char* gPtr=gRowPtr;
-		for(unsigned int x=0;x<size[0];++x,++rPtr,++gPtr)
-			{
-			/* Convert from Y' to Y: */
-			if(*rPtr<=16)
-				*gPtr=0;
-			else if(*rPtr>=236)
-				*gPtr=255;
-			else
-				*gPtr=(unsigned char)(((int(rPtr[0])-16)*256)/220);
-			}
-		}
+		ColorspaceKernels::convertYpToY(rRowPtr,gRowPtr,size[0]);
 	}
 
 void ImageExtractorYV12::extractRGB(const FrameBuffer* frame,void* image)
 	{
-	/* Convert the frame from Y'CbCr 4:2:0 to RGB by processing blocks of 2x2 pixels: */
+	/* Convert the frame from Y'CbCr 4:2:0 to RGB by processing pairs of pixel rows sharing the same chroma rows: */
 	unsigned char* resultRowPtr=static_cast<unsigned char*>(image)+(size[1]-1)*size[0]*3;
 	const unsigned char* ypRowPtr=frame->start+planes[0].offset;
 	const unsigned char* cbRowPtr=frame->start+planes[1].offset;
 	const unsigned char* crRowPtr=frame->start+planes[2].offset;
 	for(unsigned int y=0;y<size[1];y+=2)
 		{
-		unsigned char* resultPtr=resultRowPtr;
-		const unsigned char* ypPtr=ypRowPtr;
-		const unsigned char* cbPtr=cbRowPtr;
-		const unsigned char* crPtr=crRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2)
-			{
-			/* Convert the four pixels in the 2x2 block from Y'CbCr to RGB: */
-			unsigned char ypcbcr[3];
-			ypcbcr[0]=ypPtr[0];
-			ypcbcr[1]=*cbPtr;
-			ypcbcr[2]=*crPtr;
-			Video::ypcbcrToRgb(ypcbcr,resultPtr);
-			
-			ypcbcr[0]=ypPtr[1];
-			Video::ypcbcrToRgb(ypcbcr,resultPtr+3);
-			
-			ypcbcr[0]=ypPtr[planes[0].stride];
-			Video::ypcbcrToRgb(ypcbcr,resultPtr-size[0]*3);
-			
-			ypcbcr[0]=ypPtr[planes[0].stride+1];
-			Video::ypcbcrToRgb(ypcbcr,resultPtr-size[0]*3+3);
-			
-			/* Go to the next pixel: */
-			resultPtr+=2*3;
-			ypPtr+=2;
-			++cbPtr;
-			++crPtr;
-			}
-
+		ColorspaceKernels::convertYpCbCr420ToRGB(ypRowPtr,cbRowPtr,crRowPtr,resultRowPtr,size[0]);
+		ColorspaceKernels::convertYpCbCr420ToRGB(ypRowPtr+planes[0].stride,cbRowPtr,crRowPtr,resultRowPtr-size[0]*3,size[0]);
+		
 		/* Go to the next row: */
 		resultRowPtr-=2*size[0]*3;
 		ypRowPtr+=2*planes[0].stride;
@@ -116,6 +77,37 @@ void ImageExtractorYV12::extractRGB(const FrameBuffer* frame,void* image)
 		}
 	}
 
+void ImageExtractorYV12::extractYpCbCr(const FrameBuffer* frame,void* image)
+	{
+	/* Upsample the frame from 4:2:0 downsampling to full format: */
+	unsigned char* resultRowPtr=static_cast<unsigned char*>(image)+(size[1]-1)*size[0]*3;
+	const unsigned char* ypRowPtr=frame->start+planes[0].offset;
+	const unsigned char* cbRowPtr=frame->start+planes[1].offset;
+	const unsigned char* crRowPtr=frame->start+planes[2].offset;
+	for(unsigned int y=0;y<size[1];++y)
+		{
+		/* Each pair of pixels in a row shares the same chroma values: */
+		unsigned char* rPtr=resultRowPtr;
+		for(unsigned int x=0;x<size[0];x+=2,rPtr+=6)
+			{
+			rPtr[0]=ypRowPtr[x];
+			rPtr[1]=cbRowPtr[x>>1];
+			rPtr[2]=crRowPtr[x>>1];
+			rPtr[3]=ypRowPtr[x+1];
+			rPtr[4]=cbRowPtr[x>>1];
+			rPtr[5]=crRowPtr[x>>1];
+			}
+		
+		/* Go to the next row; chroma rows advance every other row: */
+		resultRowPtr-=size[0]*3;
+		ypRowPtr+=planes[0].stride;
+		if(y&0x1U)
+			{
+			cbRowPtr+=planes[1].stride;
+			crRowPtr+=planes[2].stride;
+			}
+		}
+	}
 
 void ImageExtractorYV12::extractYpCbCr420(const FrameBuffer* frame,void* yp,unsigned int ypStride,void* cb,unsigned int cbStride,void* cr,unsigned int crStride)
 	{
@@ -129,13 +121,13 @@ void ImageExtractorYV12::extractYpCbCr420(const FrameBuffer* frame,void* yp,unsi
 		ypRowPtr+=ypStride;
 		}
 	
-	/* Copy the Cb and Cr planes directly: */
+	/* Copy the half-height Cb and Cr planes directly: */
 	for(int cbcr=0;cbcr<2;++cbcr)
 		{
 		const unsigned char* cbcrSrcRowPtr=frame->start+planes[cbcr+1].offset;
 		unsigned char* cbcrRowPtr=static_cast<unsigned char*>(cbcr==1?cr:cb);
 		unsigned int cbcrStride=cbcr==1?crStride:cbStride;
-		for(unsigned int y=0;y<size[1];++y)
+		for(unsigned int y=0;y<size[1]/2;++y)
 			{
 			memcpy(cbcrRowPtr,cbcrSrcRowPtr,size[0]/2);
 			cbcrSrcRowPtr+=planes[cbcr+1].stride;
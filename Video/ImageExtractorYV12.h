@@ -53,6 +53,7 @@ class ImageExtractorYV12:public ImageExtractor
 	public:
 	virtual void extractGrey(const FrameBuffer* frame,void* image);
 	virtual void extractRGB(const FrameBuffer* frame,void* image);
+	virtual void extractYpCbCr(const FrameBuffer* frame,void* image);
 	virtual void extractYpCbCr420(const FrameBuffer* frame,void* yp,unsigned int ypStride,void* cb,unsigned int cbStride,void* cr,unsigned int crStride);
 	};
 
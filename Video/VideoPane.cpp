@@ -27,6 +27,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLTexCoordTemplates.h>
 #include <GL/GLVertexTemplates.h>
 #include <GLMotif/Container.h>
+#include <GLMotif/WidgetManager.h>
 
 namespace GLMotif {
 
@@ -73,6 +74,9 @@ void VideoPane::resize(const Box& newExterior)
 
 void VideoPane::draw(GLContextData& contextData) const
 	{
+	/* Video frames arrive without notice; prevent caching the widget's visual representation: */
+	getManager()->disableRenderCache(contextData);
+	
 	/* Draw the parent class widget: */
 	Widget::draw(contextData);
 	
@@ -238,6 +238,10 @@ class InputDevice // Class for input devices
 	/* Device state manipulation methods: */
 	void setDeviceRay(const Vector& newDeviceRayDirection,Scalar newDeviceRayStart); // Sets input device's ray direction and starting parameter in device coordinates
 	void setTransformation(const TrackerState& newTransformation);
+	void latchTransformation(const TrackerState& newTransformation) // Replaces the device's transformation immediately before rendering without calling tracking callbacks
+		{
+		transformation=newTransformation;
+		}
 	void setLinearVelocity(const Vector& newLinearVelocity)
 		{
 		linearVelocity=newLinearVelocity;
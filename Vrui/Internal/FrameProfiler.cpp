@@ -0,0 +1,355 @@
+/***********************************************************************
+FrameProfiler - Class to record the time spent in each phase of Vrui's
+main loop into a ring buffer of per-frame records, with optional GPU
+timing of each window's rendering, and to export the recorded frames in
+Chrome's trace event format.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Vrui/Internal/FrameProfiler.h>
+
+#include <stdio.h>
+#include <Misc/StandardValueCoders.h>
+#include <Misc/ConfigurationFile.h>
+#include <Misc/FileNameExtensions.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <GL/Extensions/GLARBTimerQuery.h>
+
+namespace Vrui {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const char* phaseNames[FrameProfiler::NUM_PHASES]=
+	{
+	"Events","Input Devices","Dispatch","Input Graph","Tools","Frame","Sound","Draw","Finish","Barrier","Swap"
+	};
+
+void writeEvent(IO::File& file,const char* name,int pid,int tid,Misc::SInt64 start,Misc::SInt64 duration,bool& first)
+	{
+	/* Write a complete event with microsecond time stamps: */
+	char event[256];
+	int eventLen=snprintf(event,sizeof(event),"%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",first?"":",",name,pid,tid,double(start)*1.0e-3,double(duration)*1.0e-3);
+	file.writeRaw(event,eventLen);
+	first=false;
+	}
+
+void writeCounters(IO::File& file,const char* name,int pid,Misc::SInt64 time,const float* values,int numValues,bool& first)
+	{
+	/* Write a counter event with one series per value, converted to milliseconds: */
+	char event[256];
+	int eventLen=snprintf(event,sizeof(event),"%s\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":%d,\"ts\":%.3f,\"args\":{",first?"":",",name,pid,double(time)*1.0e-3);
+	file.writeRaw(event,eventLen);
+	for(int i=0;i<numValues;++i)
+		{
+		eventLen=snprintf(event,sizeof(event),"%s\"Node %d\":%.3f",i>0?",":"",i,double(values[i])*1.0e3);
+		file.writeRaw(event,eventLen);
+		}
+	file.writeRaw("}}",2);
+	first=false;
+	}
+
+void writeThreadName(IO::File& file,const char* name,int pid,int tid,bool& first)
+	{
+	/* Write a metadata event naming a trace thread: */
+	char event[256];
+	int eventLen=snprintf(event,sizeof(event),"%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",first?"":",",pid,tid,name);
+	file.writeRaw(event,eventLen);
+	first=false;
+	}
+
+}
+
+/******************************
+Methods of class FrameProfiler:
+******************************/
+
+void FrameProfiler::collectGpuTimes(FrameProfiler::GpuTimer& gpuTimer,int windowIndex,bool wait)
+	{
+	while(gpuTimer.numQueries>0)
+		{
+		/* Check if the oldest query pair has completed: */
+		GLuint* queryIds=gpuTimer.queryIds[gpuTimer.firstQuery];
+		if(!wait)
+			{
+			GLint available=0;
+			glGetQueryObjectiv(queryIds[1],GL_QUERY_RESULT_AVAILABLE,&available);
+			if(!available)
+				break;
+			}
+		
+		/* Retrieve the query pair's time stamps: */
+		GLuint64 start,end;
+		glGetQueryObjectui64v(queryIds[0],GL_QUERY_RESULT,&start);
+		glGetQueryObjectui64v(queryIds[1],GL_QUERY_RESULT,&end);
+		
+		/* Store the GPU time if the query's frame is still in the ring buffer: */
+		unsigned int frameIndex=gpuTimer.queryFrames[gpuTimer.firstQuery];
+		if(nextFrameIndex-frameIndex<=numFrames)
+			getWindowRecord(frameIndex,windowIndex).gpuTime=Timestamp(end-start);
+		
+		/* Retire the query pair: */
+		if(++gpuTimer.firstQuery==numGpuQueries)
+			gpuTimer.firstQuery=0;
+		--gpuTimer.numQueries;
+		}
+	}
+
+FrameProfiler::FrameProfiler(const Misc::ConfigurationFileSection& configFileSection,int sNodeIndex,int sNumNodes)
+	:nodeIndex(sNodeIndex),numNodes(sNumNodes),
+	 numFrames(configFileSection.retrieveValue<unsigned int>("./numFrames",1000U)),
+	 frames(0),nextFrameIndex(0),currentFrame(0),
+	 numWindows(0),windowRecords(0),nodeRenderTimes(0),
+	 gpuTiming(configFileSection.retrieveValue<bool>("./gpuTiming",true)),
+	 gpuTimers(0),
+	 traceFileName(configFileSection.retrieveString("./traceFileName","VruiFrameTrace.json"))
+	{
+	/* Allocate the frame record ring buffer: */
+	if(numFrames<2)
+		numFrames=2;
+	frames=new FrameRecord[numFrames];
+	
+	/* Allocate the node render time ring buffer: */
+	nodeRenderTimes=new float[numFrames*numNodes];
+	
+	/* Insert the node index into the trace file name when running in a cluster: */
+	if(numNodes>1)
+		{
+		const char* extension=Misc::getExtension(traceFileName.c_str());
+		std::string::size_type extPos=extension-traceFileName.c_str();
+		char nodeSuffix[16];
+		snprintf(nodeSuffix,sizeof(nodeSuffix),"-%d",nodeIndex);
+		traceFileName.insert(extPos,nodeSuffix);
+		}
+	}
+
+FrameProfiler::~FrameProfiler(void)
+	{
+	delete[] frames;
+	delete[] windowRecords;
+	delete[] nodeRenderTimes;
+	delete[] gpuTimers;
+	}
+
+void FrameProfiler::setNumWindows(int newNumWindows)
+	{
+	/* Re-allocate the window record ring buffer: */
+	delete[] windowRecords;
+	delete[] gpuTimers;
+	numWindows=newNumWindows;
+	windowRecords=new WindowRecord[numFrames*numWindows];
+	for(unsigned int i=0;i<numFrames*numWindows;++i)
+		{
+		windowRecords[i].drawStart=windowRecords[i].drawEnd=Timestamp(-1);
+		windowRecords[i].gpuTime=Timestamp(-1);
+		}
+	
+	/* Create uninitialized GPU timers: */
+	gpuTimers=new GpuTimer[numWindows];
+	for(int i=0;i<numWindows;++i)
+		{
+		gpuTimers[i].initialized=false;
+		gpuTimers[i].supported=false;
+		gpuTimers[i].firstQuery=0;
+		gpuTimers[i].numQueries=0;
+		gpuTimers[i].active=false;
+		}
+	}
+
+void FrameProfiler::startFrame(void)
+	{
+	Timestamp frameStart=now();
+	
+	/* Finish the previous frame: */
+	if(currentFrame!=0)
+		currentFrame->frameEnd=frameStart;
+	
+	/* Initialize the next frame's record: */
+	currentFrame=&frames[nextFrameIndex%numFrames];
+	currentFrame->frameIndex=nextFrameIndex;
+	currentFrame->frameStart=frameStart;
+	currentFrame->frameEnd=Timestamp(-1);
+	for(int i=0;i<NUM_PHASES;++i)
+		currentFrame->phaseStarts[i]=currentFrame->phaseEnds[i]=Timestamp(-1);
+	nodeRenderTimes[(nextFrameIndex%numFrames)*numNodes]=-1.0f;
+	for(int i=0;i<numWindows;++i)
+		{
+		WindowRecord& wr=getWindowRecord(nextFrameIndex,i);
+		wr.drawStart=wr.drawEnd=Timestamp(-1);
+		wr.gpuTime=Timestamp(-1);
+		}
+	++nextFrameIndex;
+	}
+
+void FrameProfiler::startWindow(int windowIndex)
+	{
+	if(currentFrame==0||windowIndex<0||windowIndex>=numWindows)
+		return;
+	
+	/* Mark the start of the window's draw call: */
+	getWindowRecord(currentFrame->frameIndex,windowIndex).drawStart=now();
+	
+	if(gpuTiming)
+		{
+		GpuTimer& gpuTimer=gpuTimers[windowIndex];
+		if(!gpuTimer.initialized)
+			{
+			/* Initialize timer queries in the window's OpenGL context: */
+			gpuTimer.initialized=true;
+			gpuTimer.supported=GLARBTimerQuery::isSupported();
+			if(gpuTimer.supported)
+				{
+				GLARBTimerQuery::initExtension();
+				glGenQueries(numGpuQueries*2,gpuTimer.queryIds[0]);
+				}
+			}
+		
+		if(gpuTimer.supported)
+			{
+			/* Collect results from previous frames without blocking: */
+			collectGpuTimes(gpuTimer,windowIndex,false);
+			
+			/* Start a new query pair unless too many are still in flight: */
+			gpuTimer.active=gpuTimer.numQueries<numGpuQueries;
+			if(gpuTimer.active)
+				{
+				unsigned int query=(gpuTimer.firstQuery+gpuTimer.numQueries)%numGpuQueries;
+				glQueryCounter(gpuTimer.queryIds[query][0],GL_TIMESTAMP);
+				}
+			}
+		}
+	}
+
+void FrameProfiler::finishWindow(int windowIndex)
+	{
+	if(currentFrame==0||windowIndex<0||windowIndex>=numWindows)
+		return;
+	
+	if(gpuTiming&&gpuTimers[windowIndex].active)
+		{
+		/* Finish the current query pair: */
+		GpuTimer& gpuTimer=gpuTimers[windowIndex];
+		unsigned int query=(gpuTimer.firstQuery+gpuTimer.numQueries)%numGpuQueries;
+		glQueryCounter(gpuTimer.queryIds[query][1],GL_TIMESTAMP);
+		gpuTimer.queryFrames[query]=currentFrame->frameIndex;
+		++gpuTimer.numQueries;
+		gpuTimer.active=false;
+		}
+	
+	/* Mark the end of the window's draw call: */
+	getWindowRecord(currentFrame->frameIndex,windowIndex).drawEnd=now();
+	}
+
+void FrameProfiler::releaseWindow(int windowIndex)
+	{
+	if(windowIndex<0||windowIndex>=numWindows)
+		return;
+	
+	GpuTimer& gpuTimer=gpuTimers[windowIndex];
+	if(gpuTimer.initialized&&gpuTimer.supported)
+		{
+		/* Retrieve all outstanding results and delete the timer queries: */
+		collectGpuTimes(gpuTimer,windowIndex,true);
+		glDeleteQueries(numGpuQueries*2,gpuTimer.queryIds[0]);
+		}
+	gpuTimer.initialized=false;
+	}
+
+double FrameProfiler::getPhaseTime(FrameProfiler::Phase phase) const
+	{
+	/* Check if the phase was already completed during the current frame: */
+	if(currentFrame==0)
+		return 0.0;
+	const FrameRecord* frame=currentFrame;
+	if(frame->phaseStarts[phase]<0||frame->phaseEnds[phase]<frame->phaseStarts[phase])
+		{
+		/* Fall back to the most recent completed frame: */
+		if(nextFrameIndex<2)
+			return 0.0;
+		frame=&frames[(nextFrameIndex-2)%numFrames];
+		if(frame->phaseStarts[phase]<0||frame->phaseEnds[phase]<frame->phaseStarts[phase])
+			return 0.0;
+		}
+	
+	return double(frame->phaseEnds[phase]-frame->phaseStarts[phase])*1.0e-9;
+	}
+
+void FrameProfiler::writeTrace(const char* fileName) const
+	{
+	IO::FilePtr file=IO::openFile(fileName,IO::File::WriteOnly);
+	
+	/* Write the trace header and name the trace's threads: */
+	static const char header[]="{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	file->writeRaw(header,sizeof(header)-1);
+	bool first=true;
+	int pid=nodeIndex;
+	writeThreadName(*file,"Main Loop",pid,0,first);
+	for(int i=0;i<numWindows;++i)
+		{
+		char name[64];
+		snprintf(name,sizeof(name),"Window %d",i);
+		writeThreadName(*file,name,pid,1+i*2,first);
+		snprintf(name,sizeof(name),"Window %d GPU",i);
+		writeThreadName(*file,name,pid,2+i*2,first);
+		}
+	
+	/* Write all completed frames in the ring buffer from oldest to newest: */
+	unsigned int firstFrameIndex=nextFrameIndex>numFrames?nextFrameIndex-numFrames:0;
+	for(unsigned int frameIndex=firstFrameIndex;frameIndex<nextFrameIndex;++frameIndex)
+		{
+		const FrameRecord& frame=frames[frameIndex%numFrames];
+		if(frame.frameEnd<0)
+			continue;
+		
+		/* Write the frame itself and all phases entered during the frame: */
+		char name[64];
+		snprintf(name,sizeof(name),"Frame %u",frame.frameIndex);
+		writeEvent(*file,name,pid,0,frame.frameStart,frame.frameEnd-frame.frameStart,first);
+		for(int phase=0;phase<NUM_PHASES;++phase)
+			if(frame.phaseStarts[phase]>=0&&frame.phaseEnds[phase]>=frame.phaseStarts[phase])
+				writeEvent(*file,phaseNames[phase],pid,0,frame.phaseStarts[phase],frame.phaseEnds[phase]-frame.phaseStarts[phase],first);
+		
+		/* Write the render times of all cluster nodes exchanged during the frame's barrier: */
+		const float* renderTimes=nodeRenderTimes+(frameIndex%numFrames)*numNodes;
+		if(renderTimes[0]>=0.0f&&frame.phaseStarts[BARRIER]>=0)
+			writeCounters(*file,"Node Render Times",pid,frame.phaseStarts[BARRIER],renderTimes,numNodes,first);
+		
+		/* Write all windows drawn during the frame; GPU times are aligned with their CPU draw calls: */
+		for(int i=0;i<numWindows;++i)
+			{
+			const WindowRecord& wr=windowRecords[(frameIndex%numFrames)*numWindows+i];
+			if(wr.drawStart<0||wr.drawEnd<wr.drawStart)
+				continue;
+			writeEvent(*file,"Draw",pid,1+i*2,wr.drawStart,wr.drawEnd-wr.drawStart,first);
+			if(wr.gpuTime>=0)
+				writeEvent(*file,"Render",pid,2+i*2,wr.drawStart,wr.gpuTime,first);
+			}
+		}
+	
+	/* Close the trace: */
+	static const char footer[]="\n]}\n";
+	file->writeRaw(footer,sizeof(footer)-1);
+	}
+
+}
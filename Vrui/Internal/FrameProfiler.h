@@ -0,0 +1,189 @@
+/***********************************************************************
+FrameProfiler - Class to record the time spent in each phase of Vrui's
+main loop into a ring buffer of per-frame records, with optional GPU
+timing of each window's rendering, and to export the recorded frames in
+Chrome's trace event format.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef VRUI_INTERNAL_FRAMEPROFILER_INCLUDED
+#define VRUI_INTERNAL_FRAMEPROFILER_INCLUDED
+
+#include <string>
+#include <Misc/SizedTypes.h>
+#include <Realtime/Time.h>
+#include <GL/gl.h>
+
+/* Forward declarations: */
+namespace Misc {
+class ConfigurationFileSection;
+}
+
+namespace Vrui {
+
+class FrameProfiler
+	{
+	/* Embedded classes: */
+	public:
+	enum Phase // Enumerated type for main loop phases
+		{
+		EVENTS=0, // Waiting for and handling window and device events
+		INPUTDEVICES, // Updating physical input devices, or receiving them from the master node
+		DISPATCH, // Sending input device states and text events to slave nodes
+		INPUTGRAPH, // Updating the input graph
+		TOOLS, // Updating the tool manager
+		FRAME, // Calling vislet, extra, and application frame functions
+		SOUND, // Updating all sound contexts
+		DRAW, // Drawing all windows
+		FINISH, // Waiting for OpenGL to finish rendering
+		BARRIER, // Waiting for all cluster nodes to finish rendering
+		SWAP, // Swapping all windows' buffers
+		NUM_PHASES
+		};
+	
+	class Scope // Helper class to time a main loop phase for the lifetime of a scope; does nothing if profiler pointer is null
+		{
+		/* Elements: */
+		private:
+		FrameProfiler* profiler; // Pointer to the frame profiler, or null if profiling is disabled
+		Phase phase; // The timed phase
+		
+		/* Constructors and destructors: */
+		public:
+		Scope(FrameProfiler* sProfiler,Phase sPhase)
+			:profiler(sProfiler),phase(sPhase)
+			{
+			if(profiler!=0)
+				profiler->startPhase(phase);
+			}
+		~Scope(void)
+			{
+			if(profiler!=0)
+				profiler->endPhase(phase);
+			}
+		};
+	
+	private:
+	typedef Misc::SInt64 Timestamp; // Type for time stamps in nanoseconds since the profiler's creation
+	
+	struct FrameRecord // Structure holding the time stamps of a single frame
+		{
+		/* Elements: */
+		public:
+		unsigned int frameIndex; // Index of the frame since the profiler's creation
+		Timestamp frameStart,frameEnd; // Start and end time of the frame; end is -1 while the frame is in progress
+		Timestamp phaseStarts[NUM_PHASES]; // Start times of all phases; -1 if phase was not entered during the frame
+		Timestamp phaseEnds[NUM_PHASES]; // End times of all phases
+		};
+	
+	struct WindowRecord // Structure holding the time stamps of rendering a single window during a single frame
+		{
+		/* Elements: */
+		public:
+		Timestamp drawStart,drawEnd; // CPU start and end time of the window's draw call; start is -1 if window was not drawn during the frame
+		Timestamp gpuTime; // Time the GPU spent rendering the window, or -1 if not (yet) available
+		};
+	
+	static const unsigned int numGpuQueries=4; // Number of frames for which GPU timer queries can be in flight per window
+	
+	struct GpuTimer // Structure holding GPU timer query state for a single window
+		{
+		/* Elements: */
+		public:
+		bool initialized; // Flag whether the timer was initialized in the window's OpenGL context
+		bool supported; // Flag whether the window's OpenGL context supports timer queries
+		GLuint queryIds[numGpuQueries][2]; // Pairs of timestamp queries bracketing a window's rendering
+		unsigned int queryFrames[numGpuQueries]; // Frame indices of the queries
+		unsigned int firstQuery; // Index of the oldest query pair in flight
+		unsigned int numQueries; // Number of query pairs in flight
+		bool active; // Flag whether a query pair was started for the current frame
+		};
+	
+	/* Elements: */
+	Realtime::TimePointMonotonic timeBase; // Time point at which the profiler was created
+	int nodeIndex; // Index of this cluster node, used to tag exported traces
+	int numNodes; // Number of nodes in the cluster
+	unsigned int numFrames; // Size of the frame record ring buffer
+	FrameRecord* frames; // Ring buffer of frame records
+	unsigned int nextFrameIndex; // Index of the next frame to be started
+	FrameRecord* currentFrame; // Pointer to the record of the current frame, or null before the first frame
+	int numWindows; // Number of windows for which rendering is timed
+	WindowRecord* windowRecords; // Ring buffer of window records, numWindows records per frame
+	float* nodeRenderTimes; // Ring buffer of all cluster nodes' render times in seconds, numNodes entries per frame; first entry is negative if times were not exchanged during the frame
+	bool gpuTiming; // Flag whether to time windows' rendering on the GPU
+	GpuTimer* gpuTimers; // Array of GPU timers for all windows
+	std::string traceFileName; // Name of the trace file written when the main loop finishes
+	
+	/* Private methods: */
+	Timestamp now(void) const // Returns the current time stamp
+		{
+		Realtime::TimePointMonotonic time;
+		return Timestamp(time.tv_sec-timeBase.tv_sec)*Timestamp(1000000000)+Timestamp(time.tv_nsec-timeBase.tv_nsec);
+		}
+	WindowRecord& getWindowRecord(unsigned int frameIndex,int windowIndex) // Returns the record of the given window in the given frame
+		{
+		return windowRecords[(frameIndex%numFrames)*numWindows+windowIndex];
+		}
+	void collectGpuTimes(GpuTimer& gpuTimer,int windowIndex,bool wait); // Retrieves results of completed GPU timer queries; blocks until all queries are complete if flag is true
+	
+	/* Constructors and destructors: */
+	public:
+	FrameProfiler(const Misc::ConfigurationFileSection& configFileSection,int sNodeIndex,int sNumNodes); // Creates a frame profiler from the given configuration file section for the given node of a cluster of the given size
+	private:
+	FrameProfiler(const FrameProfiler& source); // Prohibit copy constructor
+	FrameProfiler& operator=(const FrameProfiler& source); // Prohibit assignment operator
+	public:
+	~FrameProfiler(void);
+	
+	/* Methods: */
+	void setNumWindows(int newNumWindows); // Sets the number of windows whose rendering will be timed; must be called before any windows are drawn
+	void startFrame(void); // Starts a new frame
+	void startPhase(Phase phase) // Marks the start of the given phase in the current frame
+		{
+		if(currentFrame!=0)
+			currentFrame->phaseStarts[phase]=now();
+		}
+	void endPhase(Phase phase) // Marks the end of the given phase in the current frame
+		{
+		if(currentFrame!=0)
+			currentFrame->phaseEnds[phase]=now();
+		}
+	void startWindow(int windowIndex); // Marks the start of drawing the given window in the current frame; must be called with the window's OpenGL context current
+	void finishWindow(int windowIndex); // Marks the end of drawing the given window in the current frame; must be called with the window's OpenGL context current
+	void releaseWindow(int windowIndex); // Releases GPU resources held for the given window; must be called with the window's OpenGL context current
+	double getPhaseTime(Phase phase) const; // Returns the time spent in the most recently completed instance of the given phase in seconds, from the current frame if possible
+	int getNumNodes(void) const // Returns the number of nodes in the cluster
+		{
+		return numNodes;
+		}
+	float* getNodeRenderTimes(void) // Returns the array of numNodes render times of all cluster nodes for the current frame, to be filled in during the frame's cluster barrier
+		{
+		return nodeRenderTimes+(currentFrame->frameIndex%numFrames)*numNodes;
+		}
+	void writeTrace(const char* fileName) const; // Writes all recorded frames to a file in Chrome's trace event format
+	void writeTrace(void) const // Ditto, to the trace file configured at creation
+		{
+		writeTrace(traceFileName.c_str());
+		}
+	};
+
+}
+
+#endif
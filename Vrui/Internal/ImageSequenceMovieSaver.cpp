@@ -31,6 +31,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/ThrowStdErr.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
+#include <Realtime/Time.h>
 #include <Images/WriteImageFile.h>
 
 namespace Vrui {
@@ -45,31 +46,44 @@ void ImageSequenceMovieSaver::frameWritingThreadMethod(void)
 	unsigned int frameIndex=0;
 	while(!done)
 		{
-		/* Add the most recent frame to the captured frame queue: */
+		/* Add the most recent frame to the captured frame queue unless the queue is full: */
 		{
 		Threads::MutexCond::Lock captureLock(captureCond);
-		frames.lockNewValue();
-		capturedFrames.push_back(frames.getLockedValue());
-		captureCond.signal();
+		if(maxQueuedFrames==0||capturedFrames.size()<maxQueuedFrames)
+			{
+			frames.lockNewValue();
+			CapturedFrame cf;
+			cf.frameIndex=frameIndex;
+			cf.frame=frames.getLockedValue();
+			capturedFrames.push_back(cf);
+			++frameIndex;
+			captureCond.signal();
+			}
+		else
+			{
+			/* Drop the frame: */
+			Threads::Mutex::Lock statisticsLock(statisticsMutex);
+			++statistics.numDroppedFrames;
+			}
+		
+		/* Update the capture statistics: */
+		Threads::Mutex::Lock statisticsLock(statisticsMutex);
+		statistics.numQueuedFrames=capturedFrames.size();
 		}
 		
 		/* Wait for the next frame: */
 		int numSkippedFrames=waitForNextFrame();
 		if(numSkippedFrames>0)
-			{
-			std::cerr<<"ImageSequenceMovieSaver: Skipped frames "<<frameIndex<<" to "<<frameIndex+numSkippedFrames-1<<std::endl;
-			frameIndex+=numSkippedFrames;
-			}
+			std::cerr<<"ImageSequenceMovieSaver: Skipped "<<numSkippedFrames<<" frames after frame "<<frameIndex<<std::endl;
 		}
 	}
 
 void* ImageSequenceMovieSaver::frameSavingThreadMethod(void)
 	{
-	unsigned int frameIndex=0;
 	while(true)
 		{
 		/* Wait for the next frame: */
-		FrameBuffer frame;
+		CapturedFrame frame;
 		{
 		Threads::MutexCond::Lock captureLock(captureCond);
 		while(!done&&capturedFrames.empty())
@@ -78,6 +92,10 @@ void* ImageSequenceMovieSaver::frameSavingThreadMethod(void)
 			break;
 		frame=capturedFrames.front();
 		capturedFrames.pop_front();
+		{
+		Threads::Mutex::Lock statisticsLock(statisticsMutex);
+		statistics.numQueuedFrames=capturedFrames.size();
+		}
 		
 		/* Print a progress report if movie saver is already shut down: */
 		if(done)
@@ -90,12 +108,12 @@ void* ImageSequenceMovieSaver::frameSavingThreadMethod(void)
 			}
 		}
 		
-		/* Write the next frame image file: */
+		/* Write the frame's image file; other threads might write later frames concurrently: */
 		char frameName[1024];
-		snprintf(frameName,sizeof(frameName),frameNameTemplate.c_str(),frameIndex);
-		++frameIndex;
-		
-		Images::writeImageFile(frame.getFrameSize()[0],frame.getFrameSize()[1],frame.getBuffer(),frameName);
+		snprintf(frameName,sizeof(frameName),frameNameTemplate.c_str(),frame.frameIndex);
+		Realtime::TimePointMonotonic encodeStart;
+		Images::writeImageFile(frame.frame.getFrameSize()[0],frame.frame.getFrameSize()[1],frame.frame.getBuffer(),frameName);
+		frameWritten(double(encodeStart.setAndDiff()));
 		}
 	
 	return 0;
@@ -104,24 +122,36 @@ void* ImageSequenceMovieSaver::frameSavingThreadMethod(void)
 ImageSequenceMovieSaver::ImageSequenceMovieSaver(const Misc::ConfigurationFileSection& configFileSection)
 	:MovieSaver(configFileSection),
 	 frameNameTemplate(configFileSection.retrieveString("./movieFrameNameTemplate")),
+	 maxQueuedFrames(configFileSection.retrieveValue<unsigned int>("./movieMaxQueuedFrames",0)),
+	 numFrameSavingThreads(configFileSection.retrieveValue<unsigned int>("./movieNumEncoderThreads",2)),
+	 frameSavingThreads(0),
 	 done(false)
 	{
 	/* Check if the frame name template has the correct format: */
 	if(!Misc::isValidUintTemplate(frameNameTemplate,1024))
 		Misc::throwStdErr("MovieSaver::MovieSaver: movie frame name template \"%s\" does not have exactly one %%u conversion",frameNameTemplate.c_str());
 	
-	/* Start the image writing thread: */
-	frameSavingThread.start(this,&ImageSequenceMovieSaver::frameSavingThreadMethod);
+	/* Start the image writing threads: */
+	if(numFrameSavingThreads<1)
+		numFrameSavingThreads=1;
+	frameSavingThreads=new Threads::Thread[numFrameSavingThreads];
+	for(unsigned int i=0;i<numFrameSavingThreads;++i)
+		frameSavingThreads[i].start(this,&ImageSequenceMovieSaver::frameSavingThreadMethod);
 	}
 
 ImageSequenceMovieSaver::~ImageSequenceMovieSaver(void)
 	{
 	/* Signal the frame capturing and saving threads to shut down: */
+	{
+	Threads::MutexCond::Lock captureLock(captureCond);
 	done=true;
-	captureCond.signal();
+	captureCond.broadcast();
+	}
 	
-	/* Wait until the frame saving thread has saved all frames and terminates: */
-	frameSavingThread.join();
+	/* Wait until the frame saving threads have saved all frames and terminate: */
+	for(unsigned int i=0;i<numFrameSavingThreads;++i)
+		frameSavingThreads[i].join();
+	delete[] frameSavingThreads;
 	}
 
 }
@@ -34,12 +34,23 @@ namespace Vrui {
 
 class ImageSequenceMovieSaver:public MovieSaver
 	{
-	/* Elements: */
+	/* Embedded classes: */
 	private:
+	struct CapturedFrame // Structure for frames selected for writing
+		{
+		/* Elements: */
+		public:
+		unsigned int frameIndex; // Index of the frame in the image sequence
+		FrameBuffer frame; // The frame's image data
+		};
+	
+	/* Elements: */
 	std::string frameNameTemplate; // Template for creating image file names; must contain exactly one %d placeholder
 	Threads::MutexCond captureCond; // Condition variable to signal that a new frame has been captured and added to the queue
-	std::deque<FrameBuffer> capturedFrames; // Queue of frame buffers selected for writing
-	Threads::Thread frameSavingThread; // Thread to write captured frames to disk; in separate thread to avoid latency issues
+	std::deque<CapturedFrame> capturedFrames; // Queue of frame buffers selected for writing
+	unsigned int maxQueuedFrames; // Maximum number of frames waiting to be written before new frames are dropped; zero for unlimited
+	unsigned int numFrameSavingThreads; // Number of threads writing captured frames
+	Threads::Thread* frameSavingThreads; // Threads to write captured frames to disk in parallel and possibly out of order; in separate threads to avoid latency issues
 	volatile bool done; // Flag whether all frames have been captured
 	
 	/* Protected methods from MovieSaver: */
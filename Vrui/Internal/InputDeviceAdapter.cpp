@@ -187,6 +187,12 @@ TrackerState InputDeviceAdapter::peekTrackerState(int deviceIndex)
 	throw std::runtime_error("InputDeviceAdapter::peekTrackerState: requested device does not have tracker states");
 	}
 
+bool InputDeviceAdapter::peekTrackerSampleTime(int deviceIndex,Realtime::TimePointMonotonic& sampleTime)
+	{
+	/* Default implementation does not know when tracker states were sampled: */
+	return false;
+	}
+
 void InputDeviceAdapter::glRenderAction(GLContextData& contextData) const
 	{
 	}
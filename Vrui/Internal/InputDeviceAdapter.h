@@ -25,6 +25,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #define VRUI_INTERNAL_INPUTDEVICEADAPTER_INCLUDED
 
 #include <string>
+#include <Realtime/Time.h>
 #include <Vrui/Geometry.h>
 
 /* Forward declarations: */
@@ -77,6 +78,7 @@ class InputDeviceAdapter
 	virtual int getFeatureIndex(InputDevice* device,const char* featureName) const; // Returns the index of a feature of the given name on the given input device, or -1 if feature does not exist
 	virtual void updateInputDevices(void) =0; // Updates state of all Vrui input devices owned by this adapter
 	virtual TrackerState peekTrackerState(int deviceIndex); // Returns the most up-to-date tracker state of the input device of the given index
+	virtual bool peekTrackerSampleTime(int deviceIndex,Realtime::TimePointMonotonic& sampleTime); // Stores the time at which the most up-to-date tracker state of the input device of the given index was sampled; returns false if the sample time is unknown
 	virtual void glRenderAction(GLContextData& contextData) const; // Hook to allow an input device adapter to render something
 	};
 
@@ -562,6 +562,24 @@ TrackerState InputDeviceAdapterDeviceDaemon::peekTrackerState(int deviceIndex)
 		}
 	}
 
+bool InputDeviceAdapterDeviceDaemon::peekTrackerSampleTime(int deviceIndex,Realtime::TimePointMonotonic& sampleTime)
+	{
+	if(trackerIndexMapping[deviceIndex]<0)
+		return false;
+	
+	/* Get the time stamp of the device's current tracker state: */
+	deviceClient.lockState();
+	VRDeviceState::TimeStamp sampleTs=deviceClient.getState().getTrackerTimeStamp(trackerIndexMapping[deviceIndex]);
+	deviceClient.unlockState();
+	
+	/* Convert the time stamp to a time point by its age, as time stamps are truncated microsecond counts of the local monotonic clock; the device client converts remote servers' time stamps, or replaces them with arrival times if the server's clock offset is unknown: */
+	sampleTime.set();
+	VRDeviceState::TimeStamp nowTs=VRDeviceState::TimeStamp(sampleTime.tv_sec*1000000+(sampleTime.tv_nsec+500)/1000);
+	sampleTime-=Realtime::TimeVector(double(nowTs-sampleTs)*1.0e-6);
+	
+	return true;
+	}
+
 int InputDeviceAdapterDeviceDaemon::findTrackerIndex(const InputDevice* device) const
 	{
 	/* Search through the list of input devices: */
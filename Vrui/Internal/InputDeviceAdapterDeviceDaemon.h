@@ -76,6 +76,7 @@ class InputDeviceAdapterDeviceDaemon:public InputDeviceAdapterIndexMap
 	virtual int getFeatureIndex(InputDevice* device,const char* featureName) const;
 	virtual void updateInputDevices(void);
 	virtual TrackerState peekTrackerState(int deviceIndex);
+	virtual bool peekTrackerSampleTime(int deviceIndex,Realtime::TimePointMonotonic& sampleTime);
 	
 	/* New methods: */
 	VRDeviceClient& getDeviceClient(void) // Returns a reference to the VR device client
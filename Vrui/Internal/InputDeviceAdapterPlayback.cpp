@@ -51,22 +51,220 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/VRWindow.h>
 #include <Vrui/Internal/Vrui.h>
 #include <Vrui/Internal/Config.h>
+#include <Vrui/Internal/InputDeviceDataChunkReader.h>
 #ifdef VRUI_INPUTDEVICEADAPTERPLAYBACK_USE_KINECT
 #include <Vrui/Internal/KinectPlayback.h>
 #endif
 
 namespace Vrui {
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+double getWallClockTime(void)
+	{
+	Misc::Time rt=Misc::Time::now();
+	return double(rt.tv_sec)+double(rt.tv_nsec)/1000000000.0;
+	}
+
+}
+
 /*******************************************
 Methods of class InputDeviceAdapterPlayback:
 *******************************************/
 
+bool InputDeviceAdapterPlayback::readNextTimeStamp(void)
+	{
+	try
+		{
+		if(chunkReader!=0)
+			{
+			/* Read the next frame from the current or the next chunk: */
+			frameFile=chunkReader->startNextFrame();
+			if(frameFile==0)
+				return false;
+			}
+		
+		nextTimeStamp=frameFile->read<double>();
+		return true;
+		}
+	catch(IO::File::ReadError)
+		{
+		return false;
+		}
+	}
+
+void InputDeviceAdapterPlayback::readFrame(TextEventDispatcher& textEventDispatcher)
+	{
+	/* Update all input devices: */
+	for(int device=0;device<numInputDevices;++device)
+		{
+		/* Update tracker state: */
+		if(inputDevices[device]->getTrackType()!=InputDevice::TRACK_NONE)
+			{
+			/* Data file version 3 and later contain per-time step device ray data: */
+			if(fileVersion>=3)
+				{
+				/* Read device ray data: */
+				Vector deviceRayDir;
+				frameFile->read(deviceRayDir.getComponents(),3);
+				Scalar deviceRayStart=frameFile->read<Scalar>();
+				inputDevices[device]->setDeviceRay(deviceRayDir,deviceRayStart);
+				}
+			
+			/* Read 6-DOF tracker state: */
+			TrackerState::Vector translation;
+			frameFile->read(translation.getComponents(),3);
+			Scalar quat[4];
+			frameFile->read(quat,4);
+			if(applyPreTransform)
+				{
+				/* Apply the pre-transformation and set the device state: */
+				OGTransform t=preTransform;
+				t*=OGTransform(translation,OGTransform::Rotation(quat),Scalar(1));
+				inputDevices[device]->setTransformation(TrackerState(t.getTranslation(),t.getRotation()));
+				}
+			else
+				{
+				/* Set the device state: */
+				inputDevices[device]->setTransformation(TrackerState(translation,TrackerState::Rotation(quat)));
+				}
+			
+			/* Data file version 3 and later contain linear and angular velocities: */
+			if(fileVersion>=3)
+				{
+				/* Read velocity data: */
+				Vector linearVelocity,angularVelocity;
+				frameFile->read(linearVelocity.getComponents(),3);
+				frameFile->read(angularVelocity.getComponents(),3);
+				inputDevices[device]->setLinearVelocity(linearVelocity);
+				inputDevices[device]->setAngularVelocity(angularVelocity);
+				}
+			}
+		
+		/* Update button states: */
+		if(fileVersion>=3)
+			{
+			/* Extract button data from 8-bit bit masks: */
+			unsigned char buttonBits=0x00U;
+			int numBits=0;
+			for(int i=0;i<inputDevices[device]->getNumButtons();++i)
+				{
+				if(numBits==0)
+					{
+					buttonBits=frameFile->read<unsigned char>();
+					numBits=8;
+					}
+				inputDevices[device]->setButtonState(i,(buttonBits&0x80U)!=0x00U);
+				buttonBits<<=1;
+				--numBits;
+				}
+			}
+		else
+			{
+			/* Read button data as sequence of 32-bit integers (oh my!): */
+			for(int i=0;i<inputDevices[device]->getNumButtons();++i)
+				{
+				int buttonState=frameFile->read<int>();
+				inputDevices[device]->setButtonState(i,buttonState);
+				}
+			}
+		
+		/* Update valuator states: */
+		for(int i=0;i<inputDevices[device]->getNumValuators();++i)
+			{
+			double valuatorState=frameFile->read<double>();
+			inputDevices[device]->setValuator(i,valuatorState);
+			}
+		}
+	
+	/* Data file version 4 and later contain text event data: */
+	if(fileVersion>=4)
+		{
+		/* Read and enqueue all text and text control events: */
+		textEventDispatcher.readEventQueues(*frameFile);
+		}
+	}
+
+void InputDeviceAdapterPlayback::setDone(void)
+	{
+	done=true;
+	nextTimeStamp=Math::Constants<double>::max;
+	
+	if(quitWhenDone)
+		{
+		/* Request exiting the program: */
+		shutdown();
+		}
+	}
+
+void InputDeviceAdapterPlayback::performSeek(void)
+	{
+	seekRequested=false;
+	
+	if(chunkReader!=0)
+		{
+		/* Find the last chunk starting at or before the seek time stamp: */
+		if(chunkReader->getNumChunks()==0)
+			return;
+		size_t chunkIndex=chunkReader->findChunk(seekTimeStamp);
+		
+		/* Restart from the beginning of the chunk unless the seek time stamp is ahead in the current chunk: */
+		if(done||chunkIndex+1!=chunkReader->getNextChunkIndex()||nextTimeStamp>seekTimeStamp)
+			{
+			chunkReader->loadChunk(chunkIndex);
+			done=false;
+			if(!readNextTimeStamp())
+				{
+				setDone();
+				return;
+				}
+			}
+		}
+	else if(done||nextTimeStamp>seekTimeStamp)
+		{
+		/* Rewind to the first frame: */
+		inputDeviceDataFile->setReadPosAbs(firstFrameOffset);
+		done=false;
+		if(!readNextTimeStamp())
+			{
+			setDone();
+			return;
+			}
+		}
+	
+	/* Skip frames preceding the seek time stamp, discarding their text events: */
+	TextEventDispatcher skippedEvents(false);
+	while(nextTimeStamp<seekTimeStamp)
+		{
+		timeStamp=nextTimeStamp;
+		readFrame(skippedEvents);
+		if(!readNextTimeStamp())
+			{
+			setDone();
+			return;
+			}
+		}
+	
+	/* Re-synchronize playback: */
+	timeStampBase=nextTimeStamp;
+	realTimeBase=getWallClockTime();
+	if(saveMovie)
+		nextMovieFrameTime=nextTimeStamp+movieFrameTimeInterval*0.5;
+	}
+
 InputDeviceAdapterPlayback::InputDeviceAdapterPlayback(InputDeviceManager* sInputDeviceManager,const Misc::ConfigurationFileSection& configFileSection)
 	:InputDeviceAdapter(sInputDeviceManager),
 	 inputDeviceDataFile(IO::openSeekableFile(configFileSection.retrieveString("./inputDeviceDataFileName").c_str())),
+	 chunkReader(0),frameFile(0),
 	 applyPreTransform(false),
+	 deviceFeatureBaseIndices(0),
 	 mouseCursorFaker(0),
 	 synchronizePlayback(configFileSection.retrieveValue<bool>("./synchronizePlayback",false)),
+	 playbackSpeed(1.0),
 	 quitWhenDone(configFileSection.retrieveValue<bool>("./quitWhenDone",false)),
 	 soundPlayer(0),
 	 #ifdef VRUI_INPUTDEVICEADAPTERPLAYBACK_USE_KINECT
@@ -75,14 +273,14 @@ InputDeviceAdapterPlayback::InputDeviceAdapterPlayback(InputDeviceManager* sInpu
 	 saveMovie(configFileSection.retrieveValue<bool>("./saveMovie",false)),
 	 movieWindowIndex(0),movieWindow(0),movieFrameTimeInterval(1.0/30.0),
 	 movieFrameStart(0),movieFrameOffset(0),
-	 firstFrameCountdown(2),timeStamp(0.0),timeStampOffset(0.0),
+	 firstFrameCountdown(2),timeStamp(0.0),timeStampBase(0.0),realTimeBase(0.0),
 	 nextTimeStamp(0.0),
 	 nextMovieFrameTime(0.0),nextMovieFrameCounter(0),
-	 done(false)
+	 done(false),seekRequested(false),seekTimeStamp(0.0)
 	{
 	/* Read file header: */
 	inputDeviceDataFile->setEndianness(Misc::LittleEndian);
-	static const char* fileHeader="Vrui Input Device Data File v4.0\n";
+	static const char* fileHeader="Vrui Input Device Data File v5.0\n";
 	char header[34];
 	inputDeviceDataFile->read<char>(header,34);
 	header[33]='\0';
@@ -110,6 +308,11 @@ InputDeviceAdapterPlayback::InputDeviceAdapterPlayback(InputDeviceManager* sInpu
 		/* File version with text and text control events: */
 		fileVersion=4;
 		}
+	else if(strcmp(header+29,"5.0\n")==0)
+		{
+		/* File version with indexed and optionally compressed chunks of frames: */
+		fileVersion=5;
+		}
 	else
 		{
 		header[32]='\0';
@@ -205,25 +408,30 @@ InputDeviceAdapterPlayback::InputDeviceAdapterPlayback(InputDeviceManager* sInpu
 		mouseCursorFaker->setCursorHotspot(configFileSection.retrieveValue<Vector>("./mouseCursorHotspot",mouseCursorFaker->getCursorHotspot()));
 		}
 	
+	/* Prepare to read frames: */
+	firstFrameOffset=inputDeviceDataFile->getReadPos();
+	if(fileVersion>=5)
+		chunkReader=new InputDeviceDataChunkReader(inputDeviceDataFile,firstFrameOffset);
+	else
+		frameFile=inputDeviceDataFile.getPointer();
+	
 	/* Read time stamp of first data frame: */
-	try
+	if(readNextTimeStamp())
 		{
-		nextTimeStamp=inputDeviceDataFile->read<double>();
-		
 		/* Request an update for the next frame: */
+		timeStamp=nextTimeStamp;
 		requestUpdate();
 		}
-	catch(IO::File::ReadError)
-		{
-		done=true;
-		nextTimeStamp=Math::Constants<double>::max;
-		
-		if(quitWhenDone)
-			{
-			/* Request exiting the program: */
-			shutdown();
-			}
-		}
+	else
+		setDone();
+	
+	/* Set the playback speed for synchronized playback: */
+	setPlaybackSpeed(configFileSection.retrieveValue<double>("./playbackSpeed",playbackSpeed));
+	
+	/* Check if the user wants to skip the beginning of the recording: */
+	double startTime=configFileSection.retrieveValue<double>("./startTime",0.0);
+	if(startTime>0.0)
+		fastForward(startTime);
 	
 	/* Check if the user wants to play back a commentary sound track: */
 	std::string soundFileName=configFileSection.retrieveString("./soundFileName","");
@@ -284,6 +492,7 @@ InputDeviceAdapterPlayback::~InputDeviceAdapterPlayback(void)
 	delete kinectPlayer;
 	#endif
 	delete[] deviceFeatureBaseIndices;
+	delete chunkReader;
 	}
 
 std::string InputDeviceAdapterPlayback::getFeatureName(const InputDeviceFeature& feature) const
@@ -330,6 +539,10 @@ int InputDeviceAdapterPlayback::getFeatureIndex(InputDevice* device,const char*
 
 void InputDeviceAdapterPlayback::updateInputDevices(void)
 	{
+	/* Handle a pending seek request: */
+	if(seekRequested)
+		performSeek();
+	
 	/* Do nothing if at end of file: */
 	if(done)
 		return;
@@ -344,10 +557,9 @@ void InputDeviceAdapterPlayback::updateInputDevices(void)
 			{
 			if(synchronizePlayback)
 				{
-				/* Calculate the offset between the saved timestamps and the system's wall clock time: */
-				Misc::Time rt=Misc::Time::now();
-				double realTime=double(rt.tv_sec)+double(rt.tv_nsec)/1000000000.0;
-				timeStampOffset=nextTimeStamp-realTime;
+				/* Associate the first saved time stamp with the system's wall clock time: */
+				timeStampBase=nextTimeStamp;
+				realTimeBase=getWallClockTime();
 				}
 			
 			/* Start the sound player, if there is one: */
@@ -370,10 +582,8 @@ void InputDeviceAdapterPlayback::updateInputDevices(void)
 	
 	if(synchronizePlayback)
 		{
-		/* Check if there is positive drift between the system's offset wall clock time and the next time stamp: */
-		Misc::Time rt=Misc::Time::now();
-		double realTime=double(rt.tv_sec)+double(rt.tv_nsec)/1000000000.0;
-		double delta=nextTimeStamp-(realTime+timeStampOffset);
+		/* Check if there is positive drift between the system's wall clock time and the next time stamp scaled by the playback speed: */
+		double delta=(nextTimeStamp-timeStampBase)/playbackSpeed-(getWallClockTime()-realTimeBase);
 		if(delta>0.0)
 			{
 			/* Block to correct the drift: */
@@ -381,115 +591,18 @@ void InputDeviceAdapterPlayback::updateInputDevices(void)
 			}
 		}
 	
-	/* Update all input devices: */
-	for(int device=0;device<numInputDevices;++device)
-		{
-		/* Update tracker state: */
-		if(inputDevices[device]->getTrackType()!=InputDevice::TRACK_NONE)
-			{
-			/* Data file version 3 and later contain per-time step device ray data: */
-			if(fileVersion>=3)
-				{
-				/* Read device ray data: */
-				Vector deviceRayDir;
-				inputDeviceDataFile->read(deviceRayDir.getComponents(),3);
-				Scalar deviceRayStart=inputDeviceDataFile->read<Scalar>();
-				inputDevices[device]->setDeviceRay(deviceRayDir,deviceRayStart);
-				}
-			
-			/* Read 6-DOF tracker state: */
-			TrackerState::Vector translation;
-			inputDeviceDataFile->read(translation.getComponents(),3);
-			Scalar quat[4];
-			inputDeviceDataFile->read(quat,4);
-			if(applyPreTransform)
-				{
-				/* Apply the pre-transformation and set the device state: */
-				OGTransform t=preTransform;
-				t*=OGTransform(translation,OGTransform::Rotation(quat),Scalar(1));
-				inputDevices[device]->setTransformation(TrackerState(t.getTranslation(),t.getRotation()));
-				}
-			else
-				{
-				/* Set the device state: */
-				inputDevices[device]->setTransformation(TrackerState(translation,TrackerState::Rotation(quat)));
-				}
-			
-			/* Data file version 3 and later contain linear and angular velocities: */
-			if(fileVersion>=3)
-				{
-				/* Read velocity data: */
-				Vector linearVelocity,angularVelocity;
-				inputDeviceDataFile->read(linearVelocity.getComponents(),3);
-				inputDeviceDataFile->read(angularVelocity.getComponents(),3);
-				inputDevices[device]->setLinearVelocity(linearVelocity);
-				inputDevices[device]->setAngularVelocity(angularVelocity);
-				}
-			}
-		
-		/* Update button states: */
-		if(fileVersion>=3)
-			{
-			/* Extract button data from 8-bit bit masks: */
-			unsigned char buttonBits=0x00U;
-			int numBits=0;
-			for(int i=0;i<inputDevices[device]->getNumButtons();++i)
-				{
-				if(numBits==0)
-					{
-					buttonBits=inputDeviceDataFile->read<unsigned char>();
-					numBits=8;
-					}
-				inputDevices[device]->setButtonState(i,(buttonBits&0x80U)!=0x00U);
-				buttonBits<<=1;
-				--numBits;
-				}
-			}
-		else
-			{
-			/* Read button data as sequence of 32-bit integers (oh my!): */
-			for(int i=0;i<inputDevices[device]->getNumButtons();++i)
-				{
-				int buttonState=inputDeviceDataFile->read<int>();
-				inputDevices[device]->setButtonState(i,buttonState);
-				}
-			}
-		
-		/* Update valuator states: */
-		for(int i=0;i<inputDevices[device]->getNumValuators();++i)
-			{
-			double valuatorState=inputDeviceDataFile->read<double>();
-			inputDevices[device]->setValuator(i,valuatorState);
-			}
-		}
-	
-	/* Data file version 4 and later contain text event data: */
-	if(fileVersion>=4)
-		{
-		/* Read and enqueue all text and text control events: */
-		inputDeviceManager->getTextEventDispatcher()->readEventQueues(*inputDeviceDataFile);
-		}
+	/* Read the current frame: */
+	readFrame(*inputDeviceManager->getTextEventDispatcher());
 	
 	/* Read time stamp of next data frame: */
-	try
+	if(readNextTimeStamp())
 		{
-		nextTimeStamp=inputDeviceDataFile->read<double>();
-		
 		/* Request a synchronized update for the next frame: */
 		synchronize(nextTimeStamp,false);
 		requestUpdate();
 		}
-	catch(IO::File::ReadError)
-		{
-		done=true;
-		nextTimeStamp=Math::Constants<double>::max;
-		
-		if(quitWhenDone)
-			{
-			/* Request exiting the program: */
-			shutdown();
-			}
-		}
+	else
+		setDone();
 	
 	#ifdef VRUI_INPUTDEVICEADAPTERPLAYBACK_USE_KINECT
 	if(kinectPlayer!=0)
@@ -551,6 +664,25 @@ void InputDeviceAdapterPlayback::updateInputDevices(void)
 		}
 	}
 
+void InputDeviceAdapterPlayback::seek(double newTimeStamp)
+	{
+	/* Remember the seek request until the next frame: */
+	seekRequested=true;
+	seekTimeStamp=newTimeStamp;
+	requestUpdate();
+	}
+
+void InputDeviceAdapterPlayback::setPlaybackSpeed(double newPlaybackSpeed)
+	{
+	if(newPlaybackSpeed<=0.0)
+		Misc::throwStdErr("Vrui::InputDeviceAdapterPlayback::setPlaybackSpeed: Invalid playback speed %f",newPlaybackSpeed);
+	
+	/* Re-synchronize playback at the current frame: */
+	playbackSpeed=newPlaybackSpeed;
+	timeStampBase=timeStamp;
+	realTimeBase=getWallClockTime();
+	}
+
 #ifdef VRUI_INPUTDEVICEADAPTERPLAYBACK_USE_KINECT
 
 void InputDeviceAdapterPlayback::glRenderAction(GLContextData& contextData) const
@@ -42,7 +42,9 @@ namespace Sound {
 class SoundPlayer;
 }
 namespace Vrui {
+class InputDeviceDataChunkReader;
 class MouseCursorFaker;
+class TextEventDispatcher;
 class VRWindow;
 #ifdef VRUI_INPUTDEVICEADAPTERPLAYBACK_USE_KINECT
 class KinectPlayback;
@@ -57,12 +59,16 @@ class InputDeviceAdapterPlayback:public InputDeviceAdapter
 	private:
 	IO::SeekableFilePtr inputDeviceDataFile; // File containing the input device data
 	unsigned int fileVersion; // Version of the input device data file
+	IO::SeekableFile::Offset firstFrameOffset; // File position of the first frame (file version 4.0 and earlier) or the first chunk (file version 5.0 and later)
+	InputDeviceDataChunkReader* chunkReader; // Reader for the chunks of a file of version 5.0 or later
+	IO::File* frameFile; // Pointer to the file from which frames are read; either the input device data file or the current chunk
 	bool applyPreTransform; // Flag whether to transform input device data read from the file
 	OGTransform preTransform; // Upright transformation to apply to input device data read from the file
 	int* deviceFeatureBaseIndices; // Array of base indices in feature name array for each input device
 	std::vector<std::string> deviceFeatureNames; // Array of input device feature names
 	MouseCursorFaker* mouseCursorFaker; // Pointer to object used to render a fake mouse cursor
 	bool synchronizePlayback; // Flag whether to force the Vrui mainloop to run at the speed of the recording; by default, mainloop runs as fast as it can
+	double playbackSpeed; // Speed factor applied to the recording's time line during synchronized playback
 	bool quitWhenDone; // Flag whether to quit the Vrui application when all saved data has been played back
 	Sound::SoundPlayer* soundPlayer; // Pointer to a sound player object used to play back synchronized commentary tracks
 	#ifdef VRUI_INPUTDEVICEADAPTERPLAYBACK_USE_KINECT
@@ -77,11 +83,20 @@ class InputDeviceAdapterPlayback:public InputDeviceAdapter
 	int movieFrameOffset; // Index to assign to the first saved movie frame (after initial frames have been skipped)
 	unsigned int firstFrameCountdown; // Counter to indicate the first frame of the Vrui application
 	double timeStamp; // Current time stamp of input device data
-	double timeStampOffset; // Offset from system's wall clock time to input data's time stamp sequence
+	double timeStampBase; // Input data time stamp corresponding to the wall clock time base during synchronized playback
+	double realTimeBase; // Wall clock time base during synchronized playback
 	double nextTimeStamp; // Time stamp of next frame of input device data
 	double nextMovieFrameTime; // Time at which to save the next movie frame
 	int nextMovieFrameCounter; // Frame index for the next movie frame
 	bool done; // Flag if input file is at end
+	bool seekRequested; // Flag whether a seek was requested for the next frame
+	double seekTimeStamp; // Time stamp to which to seek on the next frame
+	
+	/* Private methods: */
+	bool readNextTimeStamp(void); // Reads the time stamp of the next frame; returns false if the end of the file has been reached
+	void readFrame(TextEventDispatcher& textEventDispatcher); // Reads the device states of the current frame and sends text events to the given dispatcher
+	void setDone(void); // Marks the end of the input device data file
+	void performSeek(void); // Positions the file such that the next frame read is the first frame at or after the requested seek time stamp
 	
 	/* Constructors and destructors: */
 	public:
@@ -109,6 +124,16 @@ class InputDeviceAdapterPlayback:public InputDeviceAdapter
 		{
 		return nextTimeStamp;
 		}
+	void seek(double newTimeStamp); // Continues playback from the first data frame at or after the given time stamp on the next Vrui frame; does not re-synchronize sound tracks, 3D video, or movie frames
+	void fastForward(double interval) // Skips the given amount of recorded time
+		{
+		seek((seekRequested?seekTimeStamp:timeStamp)+interval);
+		}
+	double getPlaybackSpeed(void) const // Returns the speed factor for synchronized playback
+		{
+		return playbackSpeed;
+		}
+	void setPlaybackSpeed(double newPlaybackSpeed); // Sets the speed factor for synchronized playback
 	};
 
 }
@@ -0,0 +1,165 @@
+/***********************************************************************
+InputDeviceDataChunkReader - Class to read the frames of an input device
+data file in the chunked and indexed format introduced with file version
+5.0.
+Copyright (c) 2018 Oliver Kreylos
+
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Vrui/Internal/InputDeviceDataChunkReader.h>
+
+#include <string.h>
+#include <Misc/SizedTypes.h>
+#include <Misc/Endianness.h>
+#include <Misc/MessageLogger.h>
+#include <IO/FixedMemoryFile.h>
+#include <IO/GzipFilter.h>
+
+namespace Vrui {
+
+/*******************************************
+Methods of class InputDeviceDataChunkReader:
+*******************************************/
+
+void InputDeviceDataChunkReader::readIndex(IO::SeekableFile::Offset firstChunkOffset)
+	{
+	typedef InputDeviceDataChunkWriter CW;
+	
+	/* Check if the file ends with a valid index trailer: */
+	IO::SeekableFile::Offset fileSize=file->getSize();
+	if(fileSize>=firstChunkOffset+IO::SeekableFile::Offset(CW::trailerSize))
+		{
+		file->setReadPosAbs(fileSize-IO::SeekableFile::Offset(CW::trailerSize));
+		Misc::UInt64 indexOffset=file->read<Misc::UInt64>();
+		Misc::UInt32 numChunks=file->read<Misc::UInt32>();
+		char tag[sizeof(CW::trailerTag)];
+		file->read<char>(tag,sizeof(tag));
+		if(memcmp(tag,CW::trailerTag,sizeof(tag))==0&&indexOffset>=Misc::UInt64(firstChunkOffset)&&indexOffset+Misc::UInt64(numChunks)*CW::indexEntrySize+CW::trailerSize==Misc::UInt64(fileSize))
+			{
+			/* Read the chunk index: */
+			file->setReadPosAbs(indexOffset);
+			index.reserve(numChunks);
+			for(Misc::UInt32 i=0;i<numChunks;++i)
+				{
+				IndexEntry ie;
+				ie.firstTimeStamp=file->read<double>();
+				ie.offset=file->read<Misc::UInt64>();
+				ie.numFrames=file->read<Misc::UInt32>();
+				index.push_back(ie);
+				}
+			
+			return;
+			}
+		}
+	
+	/* The file was not closed properly; re-create the index by scanning all complete chunks: */
+	Misc::formattedConsoleWarning("Vrui::InputDeviceDataChunkReader: Input device data file has no chunk index; re-creating index");
+	IO::SeekableFile::Offset chunkOffset=firstChunkOffset;
+	while(chunkOffset+IO::SeekableFile::Offset(CW::chunkHeaderSize)<=fileSize)
+		{
+		/* Read the next chunk header and check that the chunk is complete: */
+		file->setReadPosAbs(chunkOffset);
+		ChunkHeader header;
+		header.read(*file);
+		IO::SeekableFile::Offset nextChunkOffset=chunkOffset+IO::SeekableFile::Offset(CW::chunkHeaderSize+header.dataSize);
+		if(header.numFrames==0||nextChunkOffset>fileSize)
+			break;
+		
+		/* Enter the chunk into the index: */
+		IndexEntry ie;
+		ie.firstTimeStamp=header.firstTimeStamp;
+		ie.offset=chunkOffset;
+		ie.numFrames=header.numFrames;
+		index.push_back(ie);
+		
+		chunkOffset=nextChunkOffset;
+		}
+	}
+
+InputDeviceDataChunkReader::InputDeviceDataChunkReader(IO::SeekableFilePtr sFile,IO::SeekableFile::Offset firstChunkOffset)
+	:file(sFile),
+	 nextChunkIndex(0),numChunkFramesLeft(0)
+	{
+	/* Read or re-create the chunk index: */
+	readIndex(firstChunkOffset);
+	}
+
+InputDeviceDataChunkReader::~InputDeviceDataChunkReader(void)
+	{
+	}
+
+size_t InputDeviceDataChunkReader::findChunk(double timeStamp) const
+	{
+	/* Find the last chunk starting at or before the time stamp via binary search: */
+	size_t l=0;
+	size_t r=index.size();
+	while(r-l>1)
+		{
+		size_t m=(l+r)>>1;
+		if(index[m].firstTimeStamp<=timeStamp)
+			l=m;
+		else
+			r=m;
+		}
+	
+	return l;
+	}
+
+void InputDeviceDataChunkReader::loadChunk(size_t chunkIndex)
+	{
+	/* Read the chunk's header: */
+	file->setReadPosAbs(index[chunkIndex].offset);
+	ChunkHeader header;
+	header.read(*file);
+	
+	/* Read the chunk's data into a memory file: */
+	IO::FixedMemoryFile* chunk=new IO::FixedMemoryFile(header.rawDataSize);
+	chunkFile=chunk;
+	chunk->setEndianness(Misc::LittleEndian);
+	if(header.flags&InputDeviceDataChunkWriter::compressedFlag)
+		{
+		/* Decompress the chunk's data directly from the input device data file: */
+		IO::FilePtr gzipFilter=new IO::GzipFilter(file);
+		gzipFilter->readRaw(chunk->getMemory(),header.rawDataSize);
+		}
+	else
+		file->readRaw(chunk->getMemory(),header.rawDataSize);
+	chunk->setReadDataSize(header.rawDataSize);
+	
+	/* Read frames from the new chunk: */
+	numChunkFramesLeft=header.numFrames;
+	nextChunkIndex=chunkIndex+1;
+	}
+
+IO::File* InputDeviceDataChunkReader::startNextFrame(void)
+	{
+	/* Move to the next chunk if the current chunk is exhausted: */
+	while(numChunkFramesLeft==0)
+		{
+		if(nextChunkIndex>=index.size())
+			return 0;
+		loadChunk(nextChunkIndex);
+		}
+	--numChunkFramesLeft;
+	
+	return chunkFile.getPointer();
+	}
+
+}
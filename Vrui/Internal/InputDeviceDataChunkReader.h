@@ -0,0 +1,82 @@
+/***********************************************************************
+InputDeviceDataChunkReader - Class to read the frames of an input device
+data file in the chunked and indexed format introduced with file version
+5.0.
+Copyright (c) 2018 Oliver Kreylos
+
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef VRUI_INTERNAL_INPUTDEVICEDATACHUNKREADER_INCLUDED
+#define VRUI_INTERNAL_INPUTDEVICEDATACHUNKREADER_INCLUDED
+
+#include <vector>
+#include <IO/SeekableFile.h>
+#include <Vrui/Internal/InputDeviceDataChunkWriter.h>
+
+namespace Vrui {
+
+class InputDeviceDataChunkReader
+	{
+	/* Embedded classes: */
+	public:
+	typedef InputDeviceDataChunkWriter::ChunkHeader ChunkHeader;
+	typedef InputDeviceDataChunkWriter::IndexEntry IndexEntry;
+	
+	/* Elements: */
+	private:
+	IO::SeekableFilePtr file; // File from which chunks are read
+	std::vector<IndexEntry> index; // Index of all chunks in the file
+	size_t nextChunkIndex; // Index of the next chunk to be read
+	unsigned int numChunkFramesLeft; // Number of frames remaining in the current chunk
+	IO::SeekableFilePtr chunkFile; // Memory file holding the uncompressed data of the current chunk
+	
+	/* Private methods: */
+	void readIndex(IO::SeekableFile::Offset firstChunkOffset); // Reads the chunk index, or re-creates it if the file was not closed properly
+	
+	/* Constructors and destructors: */
+	public:
+	InputDeviceDataChunkReader(IO::SeekableFilePtr sFile,IO::SeekableFile::Offset firstChunkOffset); // Reads chunks from the given file, whose first chunk starts at the given file position
+	private:
+	InputDeviceDataChunkReader(const InputDeviceDataChunkReader& source); // Prohibit copy constructor
+	InputDeviceDataChunkReader& operator=(const InputDeviceDataChunkReader& source); // Prohibit assignment operator
+	public:
+	~InputDeviceDataChunkReader(void);
+	
+	/* Methods: */
+	size_t getNumChunks(void) const // Returns the number of chunks in the file
+		{
+		return index.size();
+		}
+	const IndexEntry& getIndexEntry(size_t chunkIndex) const // Returns the index entry of the given chunk
+		{
+		return index[chunkIndex];
+		}
+	size_t getNextChunkIndex(void) const // Returns the index of the chunk following the current chunk
+		{
+		return nextChunkIndex;
+		}
+	size_t findChunk(double timeStamp) const; // Returns the index of the last chunk starting at or before the given time stamp, or the first chunk if there is none
+	void loadChunk(size_t chunkIndex); // Reads and decompresses the chunk of the given index; the next frame will be the chunk's first frame
+	IO::File* startNextFrame(void); // Returns a file from which to read the next frame, starting with its time stamp, or null if all frames have been read
+	};
+
+}
+
+#endif
@@ -0,0 +1,165 @@
+/***********************************************************************
+InputDeviceDataChunkWriter - Class to write the frames of an input
+device data file in the chunked and indexed format introduced with file
+version 5.0.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Vrui/Internal/InputDeviceDataChunkWriter.h>
+
+#include <Misc/Endianness.h>
+#include <IO/GzipFilter.h>
+
+namespace Vrui {
+
+/***************************************************
+Static elements of class InputDeviceDataChunkWriter:
+***************************************************/
+
+const char InputDeviceDataChunkWriter::trailerTag[8]={'V','r','u','i','I','D','X','\n'};
+
+/********************************************************
+Methods of class InputDeviceDataChunkWriter::ChunkHeader:
+********************************************************/
+
+void InputDeviceDataChunkWriter::ChunkHeader::read(IO::File& file)
+	{
+	numFrames=file.read<Misc::UInt32>();
+	flags=file.read<Misc::UInt32>();
+	dataSize=file.read<Misc::UInt64>();
+	rawDataSize=file.read<Misc::UInt64>();
+	firstTimeStamp=file.read<double>();
+	}
+
+void InputDeviceDataChunkWriter::ChunkHeader::write(IO::File& file) const
+	{
+	file.write<Misc::UInt32>(numFrames);
+	file.write<Misc::UInt32>(flags);
+	file.write<Misc::UInt64>(dataSize);
+	file.write<Misc::UInt64>(rawDataSize);
+	file.write<double>(firstTimeStamp);
+	}
+
+/*******************************************
+Methods of class InputDeviceDataChunkWriter:
+*******************************************/
+
+void InputDeviceDataChunkWriter::writeChunk(void)
+	{
+	/* Enter the chunk into the index: */
+	IndexEntry ie;
+	ie.firstTimeStamp=currentChunk.firstTimeStamp;
+	ie.offset=file->getWritePos();
+	ie.numFrames=currentChunk.numFrames;
+	index.push_back(ie);
+	
+	currentChunk.rawDataSize=chunkBuffer.getDataSize();
+	if(compress)
+		{
+		/* Compress the chunk's data into a second memory buffer: */
+		IO::VariableMemoryFile* compressedBuffer=new IO::VariableMemoryFile;
+		IO::FilePtr compressedBufferPtr(compressedBuffer);
+		{
+		IO::FilePtr gzipFilter=new IO::GzipFilter(compressedBufferPtr);
+		chunkBuffer.writeToSink(*gzipFilter);
+		}
+		
+		/* Write the chunk header and the compressed data: */
+		currentChunk.flags=compressedFlag;
+		currentChunk.dataSize=compressedBuffer->getDataSize();
+		currentChunk.write(*file);
+		compressedBuffer->writeToSink(*file);
+		}
+	else
+		{
+		/* Write the chunk header and the raw data: */
+		currentChunk.flags=0x0U;
+		currentChunk.dataSize=currentChunk.rawDataSize;
+		currentChunk.write(*file);
+		chunkBuffer.writeToSink(*file);
+		}
+	
+	/* Start a new chunk: */
+	chunkBuffer.clear();
+	currentChunk.numFrames=0;
+	}
+
+InputDeviceDataChunkWriter::InputDeviceDataChunkWriter(IO::SeekableFilePtr sFile,double sChunkDuration,unsigned int sMaxChunkFrames,bool sCompress)
+	:file(sFile),
+	 chunkDuration(sChunkDuration),maxChunkFrames(sMaxChunkFrames),compress(sCompress),
+	 finished(false)
+	{
+	/* Frame data is always stored in little-endian byte order: */
+	chunkBuffer.setEndianness(Misc::LittleEndian);
+	
+	/* Start the first chunk: */
+	currentChunk.numFrames=0;
+	currentChunk.flags=0x0U;
+	currentChunk.dataSize=0;
+	currentChunk.rawDataSize=0;
+	currentChunk.firstTimeStamp=0.0;
+	}
+
+InputDeviceDataChunkWriter::~InputDeviceDataChunkWriter(void)
+	{
+	}
+
+IO::File& InputDeviceDataChunkWriter::startFrame(double timeStamp)
+	{
+	/* Write the current chunk if it is full: */
+	if(currentChunk.numFrames>=maxChunkFrames||(currentChunk.numFrames>0&&timeStamp-currentChunk.firstTimeStamp>=chunkDuration))
+		writeChunk();
+	
+	/* Add the new frame to the current chunk: */
+	if(currentChunk.numFrames==0)
+		currentChunk.firstTimeStamp=timeStamp;
+	++currentChunk.numFrames;
+	chunkBuffer.write<double>(timeStamp);
+	
+	return chunkBuffer;
+	}
+
+void InputDeviceDataChunkWriter::finish(void)
+	{
+	if(finished)
+		return;
+	finished=true;
+	
+	/* Write the last chunk: */
+	if(currentChunk.numFrames>0)
+		writeChunk();
+	
+	/* Write the chunk index: */
+	Misc::UInt64 indexOffset=file->getWritePos();
+	for(std::vector<IndexEntry>::iterator iIt=index.begin();iIt!=index.end();++iIt)
+		{
+		file->write<double>(iIt->firstTimeStamp);
+		file->write<Misc::UInt64>(iIt->offset);
+		file->write<Misc::UInt32>(iIt->numFrames);
+		}
+	
+	/* Write the index trailer: */
+	file->write<Misc::UInt64>(indexOffset);
+	file->write<Misc::UInt32>(Misc::UInt32(index.size()));
+	file->write<char>(trailerTag,sizeof(trailerTag));
+	file->flush();
+	}
+
+}
@@ -0,0 +1,112 @@
+/***********************************************************************
+InputDeviceDataChunkWriter - Class to write the frames of an input
+device data file in the chunked and indexed format introduced with file
+version 5.0.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+/***********************************************************************
+Layout of version 5.0 input device data files: The file header (random
+seed, device layouts, feature names) is identical to version 4.0. It is
+followed by a sequence of chunks, each consisting of a chunk header and
+the chunk's frame data. Frame records inside a chunk have the same
+layout as in version 4.0 files and store the full state of all input
+devices, meaning that the first frame of each chunk acts as a key frame
+from which playback can resume. Chunk data can optionally be compressed
+with gzip. When a file is closed, an index of all chunks is appended,
+followed by a fixed-size trailer pointing to the index. Readers can
+re-create a missing index by scanning the chunk headers.
+***********************************************************************/
+
+#ifndef VRUI_INTERNAL_INPUTDEVICEDATACHUNKWRITER_INCLUDED
+#define VRUI_INTERNAL_INPUTDEVICEDATACHUNKWRITER_INCLUDED
+
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <IO/SeekableFile.h>
+#include <IO/VariableMemoryFile.h>
+
+namespace Vrui {
+
+class InputDeviceDataChunkWriter
+	{
+	/* Embedded classes: */
+	public:
+	static const Misc::UInt32 compressedFlag=0x1U; // Chunk flag indicating gzip-compressed chunk data
+	static const size_t chunkHeaderSize=32; // Size of a chunk header in bytes
+	static const size_t indexEntrySize=20; // Size of an index entry in bytes
+	static const size_t trailerSize=20; // Size of the index trailer at the end of a file in bytes
+	static const char trailerTag[8]; // Tag identifying the index trailer
+	
+	struct ChunkHeader // Structure describing a chunk of frames
+		{
+		/* Elements: */
+		public:
+		Misc::UInt32 numFrames; // Number of frames in the chunk
+		Misc::UInt32 flags; // Chunk flags
+		Misc::UInt64 dataSize; // Size of the chunk's data as stored in the file
+		Misc::UInt64 rawDataSize; // Size of the chunk's data after decompression
+		double firstTimeStamp; // Time stamp of the chunk's first frame
+		
+		/* Methods: */
+		void read(IO::File& file); // Reads a chunk header from the given file
+		void write(IO::File& file) const; // Writes a chunk header to the given file
+		};
+	
+	struct IndexEntry // Structure for chunk index entries
+		{
+		/* Elements: */
+		public:
+		double firstTimeStamp; // Time stamp of the chunk's first frame
+		Misc::UInt64 offset; // Absolute file position of the chunk's header
+		Misc::UInt32 numFrames; // Number of frames in the chunk
+		};
+	
+	/* Elements: */
+	private:
+	IO::SeekableFilePtr file; // File to which chunks are written
+	double chunkDuration; // Maximum time span covered by a single chunk in seconds
+	unsigned int maxChunkFrames; // Maximum number of frames in a single chunk
+	bool compress; // Flag whether to compress chunk data
+	IO::VariableMemoryFile chunkBuffer; // Buffer accumulating the frames of the current chunk
+	ChunkHeader currentChunk; // Header of the current chunk
+	std::vector<IndexEntry> index; // Index of all chunks written so far
+	bool finished; // Flag whether the chunk index has been written
+	
+	/* Private methods: */
+	void writeChunk(void); // Writes the current chunk to the file and starts a new one
+	
+	/* Constructors and destructors: */
+	public:
+	InputDeviceDataChunkWriter(IO::SeekableFilePtr sFile,double sChunkDuration,unsigned int sMaxChunkFrames,bool sCompress); // Writes chunks to the given file, which must already contain a version 5.0 file header
+	private:
+	InputDeviceDataChunkWriter(const InputDeviceDataChunkWriter& source); // Prohibit copy constructor
+	InputDeviceDataChunkWriter& operator=(const InputDeviceDataChunkWriter& source); // Prohibit assignment operator
+	public:
+	~InputDeviceDataChunkWriter(void); // Destroys the writer; finish() must be called before to write the last chunk and the chunk index
+	
+	/* Methods: */
+	IO::File& startFrame(double timeStamp); // Starts a new frame with the given time stamp; returns a file to which the frame's device states and text events must be written
+	void finish(void); // Writes the current chunk and the chunk index; no more frames may be written afterwards
+	};
+
+}
+
+#endif
@@ -24,12 +24,14 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/Internal/InputDeviceDataSaver.h>
 
 #include <iostream>
+#include <Misc/ThrowStdErr.h>
 #include <Misc/StringMarshaller.h>
 #include <Misc/CreateNumberedFileName.h>
 #include <Misc/MessageLogger.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
 #include <IO/File.h>
+#include <IO/SeekableFile.h>
 #include <IO/OpenFile.h>
 #include <Geometry/Point.h>
 #include <Geometry/Vector.h>
@@ -43,6 +45,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/InputDeviceFeature.h>
 #include <Vrui/InputDeviceManager.h>
 #include <Vrui/TextEventDispatcher.h>
+#include <Vrui/Internal/InputDeviceDataChunkWriter.h>
 #ifdef VRUI_INPUTDEVICEDATASAVER_USE_KINECT
 #include <Vrui/Internal/KinectRecorder.h>
 #endif
@@ -54,7 +57,7 @@ Methods of class InputDeviceDataSaver:
 *************************************/
 
 InputDeviceDataSaver::InputDeviceDataSaver(const Misc::ConfigurationFileSection& configFileSection,InputDeviceManager& inputDeviceManager,TextEventDispatcher* sTextEventDispatcher,unsigned int randomSeed)
-	:inputDeviceDataFile(IO::openFile(Misc::createNumberedFileName(configFileSection.retrieveString("./inputDeviceDataFileName"),4).c_str(),IO::File::WriteOnly)),
+	:chunkWriter(0),
 	 numInputDevices(inputDeviceManager.getNumInputDevices()),
 	 inputDevices(new InputDevice*[numInputDevices]),
 	 textEventDispatcher(sTextEventDispatcher),
@@ -64,10 +67,27 @@ InputDeviceDataSaver::InputDeviceDataSaver(const Misc::ConfigurationFileSection&
 	 #endif
 	 firstFrameCountdown(2)
 	{
+	/* Check which file version to write: */
+	int fileVersion=configFileSection.retrieveValue<int>("./fileVersion",5);
+	if(fileVersion!=4&&fileVersion!=5)
+		Misc::throwStdErr("Vrui::InputDeviceDataSaver: Unsupported input device data file version %d",fileVersion);
+	
+	/* Open the input device data file: */
+	std::string inputDeviceDataFileName=Misc::createNumberedFileName(configFileSection.retrieveString("./inputDeviceDataFileName"),4);
+	IO::SeekableFilePtr seekableFile;
+	if(fileVersion>=5)
+		{
+		/* Chunked files need to know their write position to create a chunk index: */
+		seekableFile=IO::openSeekableFile(inputDeviceDataFileName.c_str(),IO::File::WriteOnly);
+		inputDeviceDataFile=seekableFile;
+		}
+	else
+		inputDeviceDataFile=IO::openFile(inputDeviceDataFileName.c_str(),IO::File::WriteOnly);
+	
 	/* Write a file identification header: */
 	inputDeviceDataFile->setEndianness(Misc::LittleEndian);
-	static const char* fileHeader="Vrui Input Device Data File v4.0\n";
-	inputDeviceDataFile->write<char>(fileHeader,34);
+	static const char* fileHeaders[2]={"Vrui Input Device Data File v4.0\n","Vrui Input Device Data File v5.0\n"};
+	inputDeviceDataFile->write<char>(fileHeaders[fileVersion-4],34);
 	
 	/* Save the random number seed: */
 	inputDeviceDataFile->write<unsigned int>(randomSeed);
@@ -95,6 +115,15 @@ InputDeviceDataSaver::InputDeviceDataSaver(const Misc::ConfigurationFileSection&
 			}
 		}
 	
+	if(fileVersion>=5)
+		{
+		/* Create a chunk writer: */
+		double chunkDuration=configFileSection.retrieveValue<double>("./chunkDuration",1.0);
+		unsigned int maxChunkFrames=configFileSection.retrieveValue<unsigned int>("./maxChunkFrames",1024U);
+		bool compressChunks=configFileSection.retrieveValue<bool>("./compressChunks",true);
+		chunkWriter=new InputDeviceDataChunkWriter(seekableFile,chunkDuration,maxChunkFrames,compressChunks);
+		}
+	
 	/* Check if the user wants to record a commentary track: */
 	std::string soundFileName=configFileSection.retrieveString("./soundFileName","");
 	if(!soundFileName.empty())
@@ -135,6 +164,20 @@ InputDeviceDataSaver::~InputDeviceDataSaver(void)
 	/* Log the total recording time as a convenience: */
 	Misc::formattedLogNote("Vrui::InputDeviceDataSaver: Total recording time: %fs",getApplicationTime());
 	
+	if(chunkWriter!=0)
+		{
+		/* Write the last chunk and the chunk index: */
+		try
+			{
+			chunkWriter->finish();
+			}
+		catch(std::runtime_error err)
+			{
+			Misc::formattedConsoleError("Vrui::InputDeviceDataSaver: Unable to finish input device data file due to exception %s",err.what());
+			}
+		delete chunkWriter;
+		}
+	
 	/* Shut down recording: */
 	delete[] inputDevices;
 	delete soundRecorder;
@@ -160,8 +203,15 @@ void InputDeviceDataSaver::saveCurrentState(double currentTimeStamp)
 			}
 		}
 	
-	/* Write current time stamp: */
-	inputDeviceDataFile->write(currentTimeStamp);
+	/* Write current time stamp, either directly to the file or into the current chunk: */
+	IO::File* frameFile;
+	if(chunkWriter!=0)
+		frameFile=&chunkWriter->startFrame(currentTimeStamp);
+	else
+		{
+		frameFile=inputDeviceDataFile.getPointer();
+		frameFile->write(currentTimeStamp);
+		}
 	
 	/* Write state of all input devices: */
 	for(int i=0;i<numInputDevices;++i)
@@ -169,13 +219,13 @@ void InputDeviceDataSaver::saveCurrentState(double currentTimeStamp)
 		/* Write input device's tracker state: */
 		if(inputDevices[i]->getTrackType()!=InputDevice::TRACK_NONE)
 			{
-			inputDeviceDataFile->write(inputDevices[i]->getDeviceRayDirection().getComponents(),3);
-			inputDeviceDataFile->write(inputDevices[i]->getDeviceRayStart());
+			frameFile->write(inputDevices[i]->getDeviceRayDirection().getComponents(),3);
+			frameFile->write(inputDevices[i]->getDeviceRayStart());
 			const TrackerState& t=inputDevices[i]->getTransformation();
-			inputDeviceDataFile->write(t.getTranslation().getComponents(),3);
-			inputDeviceDataFile->write(t.getRotation().getQuaternion(),4);
-			inputDeviceDataFile->write(inputDevices[i]->getLinearVelocity().getComponents(),3);
-			inputDeviceDataFile->write(inputDevices[i]->getAngularVelocity().getComponents(),3);
+			frameFile->write(t.getTranslation().getComponents(),3);
+			frameFile->write(t.getRotation().getQuaternion(),4);
+			frameFile->write(inputDevices[i]->getLinearVelocity().getComponents(),3);
+			frameFile->write(inputDevices[i]->getAngularVelocity().getComponents(),3);
 			}
 		
 		/* Write input device's button states: */
@@ -188,7 +238,7 @@ void InputDeviceDataSaver::saveCurrentState(double currentTimeStamp)
 				buttonBits|=0x01U;
 			if(++numBits==8)
 				{
-				inputDeviceDataFile->write(buttonBits);
+				frameFile->write(buttonBits);
 				buttonBits=0x00U;
 				numBits=0;
 				}
@@ -196,19 +246,19 @@ void InputDeviceDataSaver::saveCurrentState(double currentTimeStamp)
 		if(numBits!=0)
 			{
 			buttonBits<<=8-numBits;
-			inputDeviceDataFile->write(buttonBits);
+			frameFile->write(buttonBits);
 			}
 		
 		/* Write input device's valuator states: */
 		for(int j=0;j<inputDevices[i]->getNumValuators();++j)
 			{
 			double valuatorState=inputDevices[i]->getValuator(j);
-			inputDeviceDataFile->write(valuatorState);
+			frameFile->write(valuatorState);
 			}
 		}
 	
 	/* Write all enqueued text and text control events: */
-	textEventDispatcher->writeEventQueues(*inputDeviceDataFile);
+	textEventDispatcher->writeEventQueues(*frameFile);
 	}
 
 }
@@ -38,6 +38,7 @@ namespace Vrui {
 class InputDevice;
 class InputDeviceManager;
 class TextEventDispatcher;
+class InputDeviceDataChunkWriter;
 #ifdef VRUI_INPUTDEVICEDATASAVER_USE_KINECT
 class KinectRecorder;
 #endif
@@ -50,6 +51,7 @@ class InputDeviceDataSaver
 	/* Elements: */
 	private:
 	IO::FilePtr inputDeviceDataFile; // File input device data is saved to
+	InputDeviceDataChunkWriter* chunkWriter; // Pointer to a writer grouping frames into indexed chunks when writing file version 5.0 or later; null when writing file version 4.0
 	int numInputDevices; // Number of saved (physical) input devices
 	InputDevice** inputDevices; // Array of pointers to saved input devices
 	TextEventDispatcher* textEventDispatcher; // Pointer to the dispatcher for GLMotif text and text control events
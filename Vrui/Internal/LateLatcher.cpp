@@ -0,0 +1,264 @@
+/***********************************************************************
+LateLatcher - Class to re-sample the states of tracked input devices
+immediately before rendering, and to estimate the resulting
+motion-to-photon latency of the main viewer's head tracker.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Vrui/Internal/LateLatcher.h>
+
+#include <stdexcept>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/MessageLogger.h>
+#include <Misc/StandardValueCoders.h>
+#include <Misc/ConfigurationFile.h>
+#include <Cluster/MulticastPipe.h>
+#include <Geometry/GeometryMarshallers.h>
+#include <Vrui/InputDevice.h>
+#include <Vrui/InputDeviceManager.h>
+#include <Vrui/Viewer.h>
+#include <Vrui/Internal/InputDeviceAdapter.h>
+
+namespace Vrui {
+
+/****************************
+Methods of class LateLatcher:
+****************************/
+
+void LateLatcher::updateLatchedDevices(void)
+	{
+	/* Check if the set of input devices or any viewer's head device changed: */
+	bool changed=latchedNumInputDevices!=inputDeviceManager->getNumInputDevices();
+	for(int i=0;i<numViewers&&!changed;++i)
+		changed=latchedHeadDevices[i]!=viewers[i].getHeadDevice();
+	if(!changed)
+		return;
+	
+	/* Remember the current set of input devices and head devices: */
+	latchedNumInputDevices=inputDeviceManager->getNumInputDevices();
+	for(int i=0;i<numViewers;++i)
+		latchedHeadDevices[i]=viewers[i].getHeadDevice();
+	
+	/* Find all tracked input devices that should be re-sampled: */
+	latchedDevices.clear();
+	for(int deviceIndex=0;deviceIndex<latchedNumInputDevices;++deviceIndex)
+		{
+		InputDevice* device=inputDeviceManager->getInputDevice(deviceIndex);
+		if(device->getTrackType()==InputDevice::TRACK_NONE)
+			continue;
+		
+		/* Check if the device is a viewer's head device: */
+		bool latch=latchAllDevices;
+		for(int i=0;i<numViewers&&!latch;++i)
+			latch=latchedHeadDevices[i]==device;
+		if(!latch)
+			continue;
+		
+		/* Only physical devices whose adapters can be peeked can be re-sampled: */
+		LatchedDevice ld;
+		ld.managerIndex=deviceIndex;
+		ld.device=device;
+		ld.adapter=inputDeviceManager->findInputDeviceAdapter(device);
+		if(ld.adapter==0)
+			continue;
+		ld.adapterIndex=ld.adapter->findInputDevice(device);
+		try
+			{
+			ld.adapter->peekTrackerState(ld.adapterIndex);
+			}
+		catch(const std::runtime_error&)
+			{
+			continue;
+			}
+		latchedDevices.push_back(ld);
+		}
+	}
+
+void LateLatcher::recordMainHeadSample(void)
+	{
+	/* Bail out if the main viewer is not head-tracked: */
+	const InputDevice* headDevice=viewers[0].getHeadDevice();
+	if(headDevice==0)
+		return;
+	
+	/* Ask the head device's adapter when its current state was sampled: */
+	InputDeviceAdapter* adapter=inputDeviceManager->findInputDeviceAdapter(headDevice);
+	Realtime::TimePointMonotonic sampleTime;
+	if(adapter!=0&&adapter->peekTrackerSampleTime(adapter->findInputDevice(headDevice),sampleTime))
+		{
+		sampleTimeSum+=double(sampleTime);
+		++numSampleTimes;
+		}
+	}
+
+void LateLatcher::latch(void)
+	{
+	if(master)
+		{
+		/* Re-sample all latched devices: */
+		updateLatchedDevices();
+		if(pipe!=0)
+			pipe->write<int>(int(latchedDevices.size()));
+		for(std::vector<LatchedDevice>::iterator ldIt=latchedDevices.begin();ldIt!=latchedDevices.end();++ldIt)
+			{
+			TrackerState ts=ldIt->adapter->peekTrackerState(ldIt->adapterIndex);
+			ldIt->device->latchTransformation(ts);
+			if(pipe!=0)
+				{
+				/* Send the re-sampled state to the slaves: */
+				pipe->write<int>(ldIt->managerIndex);
+				Misc::Marshaller<TrackerState>::write(ts,*pipe);
+				}
+			}
+		if(pipe!=0)
+			pipe->flush();
+		
+		/* Record the sample time of the main viewer's head tracker: */
+		recordMainHeadSample();
+		}
+	else
+		{
+		/* Update the list of input devices if new ones were created: */
+		if(int(slaveDevices.size())!=inputDeviceManager->getNumInputDevices())
+			{
+			slaveDevices.clear();
+			for(int i=0;i<inputDeviceManager->getNumInputDevices();++i)
+				slaveDevices.push_back(inputDeviceManager->getInputDevice(i));
+			}
+		
+		/* Receive re-sampled device states from the master: */
+		int numDevices=pipe->read<int>();
+		for(int i=0;i<numDevices;++i)
+			{
+			int managerIndex=pipe->read<int>();
+			TrackerState ts=Misc::Marshaller<TrackerState>::read(*pipe);
+			if(managerIndex<int(slaveDevices.size()))
+				slaveDevices[managerIndex]->latchTransformation(ts);
+			}
+		}
+	
+	/* Update the viewers' head light sources: */
+	for(int i=0;i<numViewers;++i)
+		viewers[i].update();
+	}
+
+LateLatcher::LateLatcher(const Misc::ConfigurationFileSection& configFileSection,InputDeviceManager* sInputDeviceManager,int sNumViewers,Viewer* sViewers,Cluster::MulticastPipe* sPipe,bool sMaster,const Realtime::TimeVector& defaultDisplayDelay)
+	:inputDeviceManager(sInputDeviceManager),
+	 numViewers(sNumViewers),viewers(sViewers),
+	 pipe(sPipe),master(sMaster),
+	 mode(FRAME),
+	 latchAllDevices(configFileSection.retrieveValue<bool>("./latchAllDevices",false)),
+	 displayDelay(defaultDisplayDelay),
+	 latchedNumInputDevices(-1),latchedHeadDevices(numViewers,0),
+	 sampleTimeSum(0.0),numSampleTimes(0),
+	 statisticsInterval(configFileSection.retrieveValue<double>("./statisticsInterval",1.0)),
+	 printStatistics(configFileSection.retrieveValue<bool>("./printStatistics",false)),
+	 latencySum(0.0),latencyMin(0.0),latencyMax(0.0),numLatencies(0),
+	 averageLatency(0.0)
+	{
+	/* Read the re-sampling mode: */
+	std::string modeName=configFileSection.retrieveString("./mode","Frame");
+	if(modeName=="None")
+		mode=NONE;
+	else if(modeName=="Frame")
+		mode=FRAME;
+	else if(modeName=="Window")
+		mode=WINDOW;
+	else
+		Misc::throwStdErr("Vrui::LateLatcher: Unknown re-sampling mode \"%s\"",modeName.c_str());
+	
+	/* Per-window re-sampling would render different device states on different cluster nodes: */
+	if(mode==WINDOW&&pipe!=0)
+		{
+		if(master)
+			Misc::consoleWarning("Vrui::LateLatcher: Re-sampling input devices once per frame to keep cluster nodes consistent");
+		mode=FRAME;
+		}
+	
+	/* Read the display delay in ms: */
+	displayDelay=Realtime::TimeVector(configFileSection.retrieveValue<double>("./displayDelay",double(displayDelay)*1000.0)/1000.0);
+	}
+
+const char* LateLatcher::getModeName(LateLatcher::Mode mode)
+	{
+	static const char* modeNames[3]={"None","Frame","Window"};
+	return modeNames[mode];
+	}
+
+void LateLatcher::disableWindowMode(void)
+	{
+	if(mode==WINDOW)
+		{
+		Misc::consoleWarning("Vrui::LateLatcher: Re-sampling input devices once per frame because windows are drawn by multiple threads");
+		mode=FRAME;
+		}
+	}
+
+void LateLatcher::frameUpdated(void)
+	{
+	/* Start a new frame's latency measurement: */
+	sampleTimeSum=0.0;
+	numSampleTimes=0;
+	
+	/* Record the main viewer's head tracker sample time if devices are not re-sampled: */
+	if(mode==NONE&&master)
+		recordMainHeadSample();
+	}
+
+void LateLatcher::frameSwapped(void)
+	{
+	if(numSampleTimes==0)
+		return;
+	
+	/* Estimate the time at which the new frame appears on the display: */
+	Realtime::TimePointMonotonic displayTime;
+	displayTime+=displayDelay;
+	
+	/* Calculate the average latency between the head tracker samples used during the frame and the display time: */
+	double latency=double(displayTime)-sampleTimeSum/double(numSampleTimes);
+	if(numLatencies==0)
+		{
+		statisticsStart=displayTime;
+		latencyMin=latencyMax=latency;
+		}
+	latencySum+=latency;
+	if(latencyMin>latency)
+		latencyMin=latency;
+	if(latencyMax<latency)
+		latencyMax=latency;
+	++numLatencies;
+	
+	/* Check if the current statistics interval is over: */
+	if(double(displayTime-statisticsStart)>=statisticsInterval)
+		{
+		averageLatency=latencySum/double(numLatencies);
+		if(printStatistics)
+			Misc::formattedConsoleNote("Vrui::LateLatcher: Motion-to-photon latency in %s mode: %.2f ms average, %.2f ms min, %.2f ms max over %u frames",getModeName(mode),averageLatency*1000.0,latencyMin*1000.0,latencyMax*1000.0,numLatencies);
+		
+		/* Start a new interval: */
+		latencySum=0.0;
+		numLatencies=0;
+		}
+	
+	sampleTimeSum=0.0;
+	numSampleTimes=0;
+	}
+
+}
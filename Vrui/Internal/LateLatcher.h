@@ -0,0 +1,135 @@
+/***********************************************************************
+LateLatcher - Class to re-sample the states of tracked input devices
+immediately before rendering, and to estimate the resulting
+motion-to-photon latency of the main viewer's head tracker.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef VRUI_INTERNAL_LATELATCHER_INCLUDED
+#define VRUI_INTERNAL_LATELATCHER_INCLUDED
+
+#include <vector>
+#include <Realtime/Time.h>
+
+/* Forward declarations: */
+namespace Misc {
+class ConfigurationFileSection;
+}
+namespace Cluster {
+class MulticastPipe;
+}
+namespace Vrui {
+class InputDevice;
+class InputDeviceAdapter;
+class InputDeviceManager;
+class Viewer;
+}
+
+namespace Vrui {
+
+class LateLatcher
+	{
+	/* Embedded classes: */
+	public:
+	enum Mode // Enumerated type for points in time at which input devices are re-sampled
+		{
+		NONE, // Devices are only sampled at the start of each frame; latency is still measured
+		FRAME, // Devices are re-sampled once per frame, immediately before any windows are drawn
+		WINDOW // Devices are re-sampled immediately before each window is drawn
+		};
+	
+	private:
+	struct LatchedDevice // Structure describing an input device whose state is re-sampled
+		{
+		/* Elements: */
+		public:
+		int managerIndex; // Index of the input device in the input device manager, to identify it across a cluster
+		InputDevice* device; // Pointer to the input device
+		InputDeviceAdapter* adapter; // Pointer to the input device adapter owning the device
+		int adapterIndex; // Index of the input device in its adapter
+		};
+	
+	/* Elements: */
+	InputDeviceManager* inputDeviceManager; // Pointer to the input device manager
+	int numViewers; // Number of viewers whose head devices are re-sampled
+	Viewer* viewers; // Array of viewers; the first one is the main viewer
+	Cluster::MulticastPipe* pipe; // Pipe to distribute re-sampled device states across a cluster, or null
+	bool master; // Flag whether this is the master node, which samples input devices
+	Mode mode; // Configured re-sampling mode
+	bool latchAllDevices; // Flag whether to re-sample all tracked input devices, or only viewers' head devices
+	Realtime::TimeVector displayDelay; // Delay from the end of a buffer swap to the display showing the new image
+	
+	/* Latched device state: */
+	int latchedNumInputDevices; // Number of input devices in the input device manager when the latched device list was created
+	std::vector<const InputDevice*> latchedHeadDevices; // Viewers' head devices when the latched device list was created
+	std::vector<LatchedDevice> latchedDevices; // List of input devices that are re-sampled on the master node
+	std::vector<InputDevice*> slaveDevices; // Input devices of the input device manager, indexed by manager index, on slave nodes
+	
+	/* Latency measurement state: */
+	double sampleTimeSum; // Sum of the main viewer's head tracker sample times used for rendering in the current frame
+	unsigned int numSampleTimes; // Number of sample times in the current frame
+	double statisticsInterval; // Interval at which latency statistics are reset, in seconds
+	bool printStatistics; // Flag whether to print latency statistics at the end of each interval
+	Realtime::TimePointMonotonic statisticsStart; // Start of the current statistics interval
+	double latencySum,latencyMin,latencyMax; // Accumulated motion-to-photon latencies in the current statistics interval
+	unsigned int numLatencies; // Number of frames in the current statistics interval
+	double averageLatency; // Average motion-to-photon latency over the most recent completed statistics interval, or 0.0
+	
+	/* Private methods: */
+	void updateLatchedDevices(void); // Updates the list of re-sampled input devices if the set of input devices or viewers' head devices changed
+	void recordMainHeadSample(void); // Records the sample time of the main viewer's head tracker's current state
+	void latch(void); // Re-samples all latched input devices and distributes their states across the cluster
+	
+	/* Constructors and destructors: */
+	public:
+	LateLatcher(const Misc::ConfigurationFileSection& configFileSection,InputDeviceManager* sInputDeviceManager,int sNumViewers,Viewer* sViewers,Cluster::MulticastPipe* sPipe,bool sMaster,const Realtime::TimeVector& defaultDisplayDelay); // Creates a late latcher from the given configuration file section
+	private:
+	LateLatcher(const LateLatcher& source); // Prohibit copy constructor
+	LateLatcher& operator=(const LateLatcher& source); // Prohibit assignment operator
+	
+	/* Methods: */
+	public:
+	Mode getMode(void) const // Returns the effective re-sampling mode
+		{
+		return mode;
+		}
+	static const char* getModeName(Mode mode); // Returns a human-readable name for the given re-sampling mode
+	void disableWindowMode(void); // Falls back from per-window to per-frame re-sampling if windows are not drawn sequentially by the main thread
+	void frameUpdated(void); // Notifies the late latcher that all input devices were updated at the start of a new frame
+	void latchFrame(void) // Re-samples input devices immediately before any windows are drawn; must be called on all cluster nodes
+		{
+		if(mode==FRAME)
+			latch();
+		}
+	void latchWindow(void) // Re-samples input devices immediately before a window is drawn
+		{
+		if(mode==WINDOW)
+			latch();
+		}
+	void frameSwapped(void); // Notifies the late latcher that all windows' buffers were swapped
+	double getAverageLatency(void) const // Returns the average motion-to-photon latency over the most recent statistics interval in seconds, or 0.0 if not measured
+		{
+		return averageLatency;
+		}
+	};
+
+}
+
+#endif
@@ -25,12 +25,16 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Video/Config.h>
 
+#include <string.h>
+#include <new>
 #include <iostream>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
 #include <Misc/CreateNumberedFileName.h>
 #include <Sound/SoundDataFormat.h>
 #include <Sound/SoundRecorder.h>
+#include <GL/Extensions/GLARBVertexBufferObject.h>
+#include <GL/Extensions/GLARBPixelBufferObject.h>
 #include <Vrui/Internal/ImageSequenceMovieSaver.h>
 #if VIDEO_CONFIG_HAVE_THEORA
 #include <Vrui/Internal/TheoraMovieSaver.h>
@@ -42,6 +46,24 @@ namespace Vrui {
 Methods of class MovieSaver::FrameBuffer:
 ****************************************/
 
+void MovieSaver::FrameBuffer::allocate(void)
+	{
+	/* Allocate the image data and its header: */
+	unsigned char* allocBuffer=new unsigned char[sizeof(BufferHeader)+size_t(frameSize[1])*size_t(frameSize[0])*3];
+	new(allocBuffer) BufferHeader;
+	buffer=allocBuffer+sizeof(BufferHeader);
+	}
+
+void MovieSaver::FrameBuffer::unref(void)
+	{
+	if(buffer!=0&&getHeader()->refCount.preSub(1)==0)
+		{
+		/* Delete the image data and its header: */
+		getHeader()->~BufferHeader();
+		delete[] (buffer-sizeof(BufferHeader));
+		}
+	}
+
 MovieSaver::FrameBuffer::FrameBuffer(void)
 	:buffer(0)
 	{
@@ -91,9 +113,7 @@ void MovieSaver::FrameBuffer::setFrameSize(int newWidth,int newHeight)
 		/* Update the frame size and allocate new image data: */
 		frameSize[0]=newWidth;
 		frameSize[1]=newHeight;
-		unsigned int* allocBuffer=new unsigned int[(frameSize[1]*frameSize[0]*3+sizeof(unsigned int)-1)/sizeof(unsigned int)];
-		allocBuffer[0]=1;
-		buffer=reinterpret_cast<unsigned char*>(allocBuffer+1);
+		allocate();
 		}
 	}
 
@@ -102,15 +122,13 @@ void MovieSaver::FrameBuffer::prepareWrite(void)
 	if(buffer!=0)
 		{
 		/* Check if the buffer is shared: */
-		if(reinterpret_cast<unsigned int*>(buffer)[-1]!=1)
+		if(getHeader()->refCount.get()!=1)
 			{
 			/* Release the current image data: */
 			unref();
 			
 			/* Allocate new image data: */
-			unsigned int* allocBuffer=new unsigned int[(frameSize[1]*frameSize[0]*3+sizeof(unsigned int)-1)/sizeof(unsigned int)];
-			allocBuffer[0]=1;
-			buffer=reinterpret_cast<unsigned char*>(allocBuffer+1);
+			allocate();
 			}
 		}
 	}
@@ -126,6 +144,57 @@ void* MovieSaver::frameWritingThreadWrapper(void)
 	return 0;
 	}
 
+void MovieSaver::initializeReadback(void)
+	{
+	readbackInitialized=true;
+	
+	/* Check if asynchronous readback is requested and supported: */
+	if(numReadbackBuffers>0&&GLARBVertexBufferObject::isSupported()&&GLARBPixelBufferObject::isSupported())
+		{
+		/* Initialize the required extensions: */
+		GLARBVertexBufferObject::initExtension();
+		GLARBPixelBufferObject::initExtension();
+		
+		/* Create the ring of pixel buffers: */
+		readbackBufferIds=new GLuint[numReadbackBuffers];
+		glGenBuffersARB(numReadbackBuffers,readbackBufferIds);
+		readbackBufferSizes=new size_t[numReadbackBuffers];
+		readbackFrameSizes=new int[numReadbackBuffers][2];
+		for(unsigned int i=0;i<numReadbackBuffers;++i)
+			readbackBufferSizes[i]=0;
+		firstReadback=0;
+		numPendingReadbacks=0;
+		}
+	}
+
+void MovieSaver::retrieveFrame(void)
+	{
+	/* Get a fresh frame buffer: */
+	FrameBuffer& frameBuffer=startNewFrame();
+	
+	/* Update the frame buffer's size and prepare it for writing: */
+	const int* size=readbackFrameSizes[firstReadback];
+	frameBuffer.setFrameSize(size[0],size[1]);
+	frameBuffer.prepareWrite();
+	
+	/* Copy the oldest pending readback into the frame buffer; the readback completed while the following frames were rendered: */
+	glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB,readbackBufferIds[firstReadback]);
+	const void* pixels=glMapBufferARB(GL_PIXEL_PACK_BUFFER_ARB,GL_READ_ONLY_ARB);
+	if(pixels!=0)
+		{
+		memcpy(frameBuffer.getBuffer(),pixels,size_t(size[1])*size_t(size[0])*3);
+		glUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB);
+		}
+	glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB,0);
+	
+	/* Remove the readback from the ring: */
+	firstReadback=(firstReadback+1)%numReadbackBuffers;
+	--numPendingReadbacks;
+	
+	/* Post the new frame: */
+	postNewFrame();
+	}
+
 int MovieSaver::waitForNextFrame(void)
 	{
 	/* Check for skipped frames: */
@@ -142,14 +211,45 @@ int MovieSaver::waitForNextFrame(void)
 	Misc::sleep(nextFrameTime-t);
 	nextFrameTime+=frameInterval;
 	
+	if(numSkippedFrames>0)
+		{
+		/* Update the capture statistics: */
+		Threads::Mutex::Lock statisticsLock(statisticsMutex);
+		statistics.numSkippedFrames+=numSkippedFrames;
+		}
+	
 	return numSkippedFrames;
 	}
 
+void MovieSaver::frameWritten(double encodeTime)
+	{
+	/* Update the capture statistics: */
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	++statistics.numWrittenFrames;
+	statistics.averageEncodeTime+=(encodeTime-statistics.averageEncodeTime)/double(statistics.numWrittenFrames);
+	if(statistics.maxEncodeTime<encodeTime)
+		statistics.maxEncodeTime=encodeTime;
+	}
+
 MovieSaver::MovieSaver(const Misc::ConfigurationFileSection& configFileSection)
-	:frameRate(30.0),
+	:numReadbackBuffers(configFileSection.retrieveValue<unsigned int>("./movieNumReadbackBuffers",3)),
+	 readbackInitialized(false),
+	 readbackBufferIds(0),readbackBufferSizes(0),readbackFrameSizes(0),
+	 firstReadback(0),numPendingReadbacks(0),
+	 frameRate(30.0),
 	 soundRecorder(0),
 	 firstFrame(true)
 	{
+	/* Initialize the capture statistics: */
+	statistics.numCapturedFrames=0;
+	statistics.numPendingReadbacks=0;
+	statistics.numQueuedFrames=0;
+	statistics.numSkippedFrames=0;
+	statistics.numDroppedFrames=0;
+	statistics.numWrittenFrames=0;
+	statistics.averageEncodeTime=0.0;
+	statistics.maxEncodeTime=0.0;
+	
 	/* Read the movie frame rate and calculate the frame interval time: */
 	frameRate=configFileSection.retrieveValue<double>("./movieFrameRate",frameRate);
 	frameInterval=Misc::Time(1.0/frameRate);
@@ -191,6 +291,11 @@ MovieSaver::~MovieSaver(void)
 	
 	/* Delete the sound recorder: */
 	delete soundRecorder;
+	
+	/* Delete the readback state; pixel buffers must have been released via releaseGL(): */
+	delete[] readbackBufferIds;
+	delete[] readbackBufferSizes;
+	delete[] readbackFrameSizes;
 	}
 
 MovieSaver* MovieSaver::createMovieSaver(const Misc::ConfigurationFileSection& configFileSection)
@@ -222,6 +327,11 @@ void MovieSaver::postNewFrame(void)
 	/* Post the new frame into the triple buffer: */
 	frames.postNewValue();
 	
+	{
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	++statistics.numCapturedFrames;
+	}
+	
 	if(firstFrame)
 		{
 		if(soundRecorder!=0)
@@ -238,4 +348,83 @@ void MovieSaver::postNewFrame(void)
 		}
 	}
 
+void MovieSaver::captureFrame(int width,int height)
+	{
+	/* Initialize frame readback on the first frame: */
+	if(!readbackInitialized)
+		initializeReadback();
+	
+	/* Read tightly-packed RGB pixels: */
+	glPixelStorei(GL_PACK_ALIGNMENT,1);
+	glPixelStorei(GL_PACK_SKIP_PIXELS,0);
+	glPixelStorei(GL_PACK_ROW_LENGTH,0);
+	glPixelStorei(GL_PACK_SKIP_ROWS,0);
+	
+	if(readbackBufferIds!=0)
+		{
+		/* Start an asynchronous readback into the next free pixel buffer: */
+		unsigned int slot=(firstReadback+numPendingReadbacks)%numReadbackBuffers;
+		glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB,readbackBufferIds[slot]);
+		size_t frameDataSize=size_t(height)*size_t(width)*3;
+		if(readbackBufferSizes[slot]!=frameDataSize)
+			{
+			/* Resize the pixel buffer: */
+			glBufferDataARB(GL_PIXEL_PACK_BUFFER_ARB,frameDataSize,0,GL_STREAM_READ_ARB);
+			readbackBufferSizes[slot]=frameDataSize;
+			}
+		readbackFrameSizes[slot][0]=width;
+		readbackFrameSizes[slot][1]=height;
+		glReadPixels(0,0,width,height,GL_RGB,GL_UNSIGNED_BYTE,0);
+		glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB,0);
+		++numPendingReadbacks;
+		
+		/* Retrieve the oldest readback once all pixel buffers are in flight: */
+		if(numPendingReadbacks==numReadbackBuffers)
+			retrieveFrame();
+		}
+	else
+		{
+		/* Get a fresh frame buffer: */
+		FrameBuffer& frameBuffer=startNewFrame();
+		
+		/* Update the frame buffer's size and prepare it for writing: */
+		frameBuffer.setFrameSize(width,height);
+		frameBuffer.prepareWrite();
+		
+		/* Read the window contents into the frame buffer: */
+		glReadPixels(0,0,width,height,GL_RGB,GL_UNSIGNED_BYTE,frameBuffer.getBuffer());
+		
+		/* Post the new frame: */
+		postNewFrame();
+		}
+	}
+
+void MovieSaver::releaseGL(void)
+	{
+	if(readbackBufferIds!=0)
+		{
+		/* Retrieve all pending frames: */
+		while(numPendingReadbacks>0)
+			retrieveFrame();
+		
+		/* Release the pixel buffers: */
+		glDeleteBuffersARB(numReadbackBuffers,readbackBufferIds);
+		delete[] readbackBufferIds;
+		readbackBufferIds=0;
+		delete[] readbackBufferSizes;
+		readbackBufferSizes=0;
+		delete[] readbackFrameSizes;
+		readbackFrameSizes=0;
+		}
+	readbackInitialized=false;
+	}
+
+MovieSaver::Statistics MovieSaver::getStatistics(void) const
+	{
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	Statistics result=statistics;
+	result.numPendingReadbacks=numPendingReadbacks;
+	return result;
+	}
+
 }
@@ -24,9 +24,13 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_INTERNAL_MOVIESAVER_INCLUDED
 #define VRUI_INTERNAL_MOVIESAVER_INCLUDED
 
+#include <stddef.h>
 #include <Misc/Time.h>
+#include <Threads/Atomic.h>
+#include <Threads/Mutex.h>
 #include <Threads/Thread.h>
 #include <Threads/TripleBuffer.h>
+#include <GL/gl.h>
 
 /* Forward declarations: */
 namespace Misc {
@@ -44,22 +48,37 @@ class MovieSaver
 	public:
 	class FrameBuffer // Class to hold a movie frame
 		{
-		/* Elements: */
+		/* Embedded classes: */
 		private:
+		struct BufferHeader // Header preceding a frame's image data
+			{
+			/* Elements: */
+			public:
+			Threads::Atomic<unsigned int> refCount; // Number of frame buffers sharing the image data; atomic because frames are shared between capturing and encoding threads
+			
+			/* Constructors and destructors: */
+			BufferHeader(void)
+				:refCount(1)
+				{
+				}
+			};
+		
+		/* Elements: */
 		int frameSize[2]; // The frame's width and height
 		unsigned char* buffer; // Pointer to the frame's image data
 		
 		/* Private methods: */
-		void ref(void) // Adds a reference to a frame's image data
+		BufferHeader* getHeader(void) // Returns the header of the frame's image data
 			{
-			if(buffer!=0)
-				++reinterpret_cast<unsigned int*>(buffer)[-1];
+			return reinterpret_cast<BufferHeader*>(buffer-sizeof(BufferHeader));
 			}
-		void unref(void) // Removes a reference from a frame's image data and deletes the image data if reference count reaches zero
+		void allocate(void); // Allocates new unshared image data for the current frame size
+		void ref(void) // Adds a reference to a frame's image data
 			{
-			if(buffer!=0&&--reinterpret_cast<unsigned int*>(buffer)[-1]==0)
-				delete[] (reinterpret_cast<unsigned int*>(buffer)-1);
+			if(buffer!=0)
+				getHeader()->refCount.preAdd(1);
 			}
+		void unref(void); // Removes a reference from a frame's image data and deletes the image data if reference count reaches zero
 		
 		/* Constructors and destructors: */
 		public:
@@ -85,7 +104,30 @@ class MovieSaver
 			}
 		};
 	
+	struct Statistics // Structure reporting the progress of movie capture
+		{
+		/* Elements: */
+		public:
+		unsigned int numCapturedFrames; // Number of frames read back from the window
+		unsigned int numPendingReadbacks; // Number of asynchronous frame readbacks that have not been retrieved yet
+		unsigned int numQueuedFrames; // Number of movie frames waiting to be encoded
+		unsigned int numSkippedFrames; // Number of movie frames skipped because the frame writing thread fell behind
+		unsigned int numDroppedFrames; // Number of movie frames dropped because the encoding queue was full
+		unsigned int numWrittenFrames; // Number of movie frames encoded and written
+		double averageEncodeTime; // Average time to encode and write a movie frame in seconds
+		double maxEncodeTime; // Maximum time to encode and write a movie frame in seconds
+		};
+	
 	/* Elements: */
+	private:
+	unsigned int numReadbackBuffers; // Number of pixel buffers for asynchronous frame readback; zero to read frames synchronously
+	bool readbackInitialized; // Flag whether frame readback has been initialized in the window's OpenGL context
+	GLuint* readbackBufferIds; // Ring of pixel buffers receiving asynchronous frame readbacks, or null if frames are read synchronously
+	size_t* readbackBufferSizes; // Allocated sizes of the pixel buffers
+	int (*readbackFrameSizes)[2]; // Sizes of the frames read into the pixel buffers
+	unsigned int firstReadback; // Index of the pixel buffer holding the oldest pending readback
+	unsigned int numPendingReadbacks; // Number of pending readbacks
+	
 	protected:
 	double frameRate; // Number of frames to write per second
 	Misc::Time frameInterval; // Time between adjacent frames; == 1.0/frame rate
@@ -94,13 +136,19 @@ class MovieSaver
 	Sound::SoundRecorder* soundRecorder; // Pointer to a sound recorder if sound recording was started
 	Misc::Time nextFrameTime; // Time point at which the next frame needs to be written
 	bool firstFrame; // Flag to indicate the first saved frame
+	mutable Threads::Mutex statisticsMutex; // Mutex serializing access to the capture statistics
+	Statistics statistics; // Current capture statistics
 	
 	/* Private methods: */
+	private:
 	void* frameWritingThreadWrapper(void);
+	void initializeReadback(void); // Creates pixel buffers for asynchronous frame readback if supported by the current OpenGL context
+	void retrieveFrame(void); // Copies the oldest pending readback into a new movie frame and posts it
 	
 	/* Protected methods: */
 	protected:
 	int waitForNextFrame(void); // Suspends the caller until the next frame is due to be written; skips frames if caller lags; returns number of skipped frames
+	void frameWritten(double encodeTime); // Updates capture statistics after a movie frame has been encoded and written in the given time in seconds
 	virtual void frameWritingThreadMethod(void) =0; // Runs in background and writes movie frames at fixed intervals
 	
 	/* Constructors and destructors: */
@@ -115,6 +163,9 @@ class MovieSaver
 		return frames.startNewValue();
 		}
 	void postNewFrame(void); // Signals that the new frame has been received
+	void captureFrame(int width,int height); // Reads a frame of the given size from the current OpenGL context's read buffer; retrieves the frame asynchronously if supported
+	void releaseGL(void); // Retrieves all pending frames and releases pixel buffers; must be called with the window's OpenGL context current
+	Statistics getStatistics(void) const; // Returns the current capture statistics
 	};
 
 }
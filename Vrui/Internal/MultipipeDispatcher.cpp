@@ -23,9 +23,12 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Vrui/Internal/MultipipeDispatcher.h>
 
+#include <string.h>
 #include <Misc/ThrowStdErr.h>
 #include <Misc/StringMarshaller.h>
+#include <Math/Math.h>
 #include <Cluster/MulticastPipe.h>
+#include <Geometry/GeometryMarshallers.h>
 #include <GL/GLMarshallers.h>
 #include <Vrui/InputDevice.h>
 #include <Vrui/InputDeviceFeature.h>
@@ -35,23 +38,112 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 namespace Vrui {
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+template <class ValueParam>
+inline bool isBitwiseEqual(const ValueParam& value1,const ValueParam& value2) // Returns true if the two values have identical representations; distinguishes -0.0 from 0.0 and matches NaNs
+	{
+	return memcmp(&value1,&value2,sizeof(ValueParam))==0;
+	}
+
+inline Vector roundToFloat(const Vector& v) // Rounds the given vector to single precision
+	{
+	return Vector(Scalar(Misc::Float32(v[0])),Scalar(Misc::Float32(v[1])),Scalar(Misc::Float32(v[2])));
+	}
+
+}
+
 /************************************
 Methods of class MultipipeDispatcher:
 ************************************/
 
-MultipipeDispatcher::MultipipeDispatcher(InputDeviceManager* sInputDeviceManager,Cluster::MulticastPipe* sPipe)
+MultipipeDispatcher::QuantizedTransformation MultipipeDispatcher::quantize(const TrackerState& transformation,Scalar positionQuantum)
+	{
+	QuantizedTransformation result;
+	
+	/* Quantize the translation vector, clamping it to the representable range: */
+	const Vector& t=transformation.getTranslation();
+	for(int i=0;i<3;++i)
+		{
+		Scalar ti=Math::floor(t[i]/positionQuantum+Scalar(0.5));
+		if(ti<Scalar(-2147483647))
+			ti=Scalar(-2147483647);
+		if(ti>Scalar(2147483647))
+			ti=Scalar(2147483647);
+		result.translation[i]=Misc::SInt32(ti);
+		}
+	
+	/* Find the largest-magnitude component of the rotation quaternion: */
+	const Scalar* q=transformation.getRotation().getQuaternion();
+	int largest=0;
+	for(int i=1;i<4;++i)
+		if(Math::abs(q[largest])<Math::abs(q[i]))
+			largest=i;
+	result.largestComponent=Misc::UInt8(largest);
+	
+	/* Quantize the remaining components, which are bounded by 1/sqrt(2), after flipping the quaternion so that the omitted component is non-negative: */
+	Scalar scale=Scalar(32767)*Math::sqrt(Scalar(2));
+	if(q[largest]<Scalar(0))
+		scale=-scale;
+	for(int i=0,j=0;i<4;++i)
+		if(i!=largest)
+			{
+			Scalar qi=Math::floor(q[i]*scale+Scalar(0.5));
+			if(qi<Scalar(-32767))
+				qi=Scalar(-32767);
+			if(qi>Scalar(32767))
+				qi=Scalar(32767);
+			result.rotation[j++]=Misc::SInt16(qi);
+			}
+	
+	return result;
+	}
+
+TrackerState MultipipeDispatcher::dequantize(const MultipipeDispatcher::QuantizedTransformation& quantized,Scalar positionQuantum)
+	{
+	/* Decode the translation vector: */
+	Vector t;
+	for(int i=0;i<3;++i)
+		t[i]=Scalar(quantized.translation[i])*positionQuantum;
+	
+	/* Decode the three smallest quaternion components, and reconstruct the largest from the unit length constraint: */
+	Scalar q[4];
+	Scalar scale=Scalar(1)/(Scalar(32767)*Math::sqrt(Scalar(2)));
+	Scalar sqrSum=Scalar(0);
+	for(int i=0,j=0;i<4;++i)
+		if(i!=int(quantized.largestComponent))
+			{
+			q[i]=Scalar(quantized.rotation[j++])*scale;
+			sqrSum+=q[i]*q[i];
+			}
+	q[quantized.largestComponent]=sqrSum<Scalar(1)?Math::sqrt(Scalar(1)-sqrSum):Scalar(0);
+	
+	return TrackerState(t,TrackerState::Rotation::fromQuaternion(q));
+	}
+
+MultipipeDispatcher::MultipipeDispatcher(InputDeviceManager* sInputDeviceManager,Cluster::MulticastPipe* sPipe,Scalar sPositionQuantum)
 	:InputDeviceAdapter(sInputDeviceManager),
 	 pipe(sPipe),
 	 totalNumButtons(0),
 	 totalNumValuators(0),
+	 positionQuantum(sPositionQuantum),
+	 sendFullState(true),
 	 trackingStates(0),
 	 buttonStates(0),
-	 valuatorStates(0)
+	 valuatorStates(0),
+	 changedValuatorIndices(0)
 	{
 	if(pipe->isMaster())
 		{
 		/* Distribute the input device configuration from the input device manager to all slave nodes: */
 		
+		/* Send the tracker state quantization resolution: */
+		pipe->write<Scalar>(positionQuantum);
+		
 		/* Send number of input devices: */
 		numInputDevices=inputDeviceManager->getNumInputDevices();
 		pipe->write<int>(numInputDevices);
@@ -101,6 +193,9 @@ MultipipeDispatcher::MultipipeDispatcher(InputDeviceManager* sInputDeviceManager
 		
 		/* Receive the input device configuration from the master node: */
 		
+		/* Read the tracker state quantization resolution: */
+		positionQuantum=pipe->read<Scalar>();
+		
 		/* Read number of input devices: */
 		numInputDevices=pipe->read<int>();
 		inputDevices=new InputDevice*[numInputDevices];
@@ -150,7 +245,13 @@ MultipipeDispatcher::MultipipeDispatcher(InputDeviceManager* sInputDeviceManager
 	/* Create the input device state marshalling structures: */
 	trackingStates=new InputDeviceTrackingState[numInputDevices];
 	buttonStates=new bool[totalNumButtons];
+	for(int i=0;i<totalNumButtons;++i)
+		buttonStates[i]=false;
 	valuatorStates=new double[totalNumValuators];
+	for(int i=0;i<totalNumValuators;++i)
+		valuatorStates[i]=0.0;
+	if(pipe->isMaster())
+		changedValuatorIndices=new Misc::UInt16[totalNumValuators];
 	}
 
 MultipipeDispatcher::~MultipipeDispatcher(void)
@@ -165,6 +266,7 @@ MultipipeDispatcher::~MultipipeDispatcher(void)
 	delete[] trackingStates;
 	delete[] buttonStates;
 	delete[] valuatorStates;
+	delete[] changedValuatorIndices;
 	}
 
 std::string MultipipeDispatcher::getFeatureName(const InputDeviceFeature& feature) const
@@ -240,47 +342,225 @@ void MultipipeDispatcher::updateInputDevices(void)
 	{
 	if(pipe->isMaster())
 		{
-		/* Gather the current state of all input devices: */
+		/* Send the changes to all input devices' states since the previous update to the slave nodes: */
 		bool* bsPtr=buttonStates;
 		double* vsPtr=valuatorStates;
 		for(int i=0;i<numInputDevices;++i)
 			{
-			trackingStates[i].deviceRayDirection=inputDevices[i]->getDeviceRayDirection();
-			trackingStates[i].deviceRayStart=inputDevices[i]->getDeviceRayStart();
-			trackingStates[i].transformation=inputDevices[i]->getTransformation();
-			trackingStates[i].linearVelocity=inputDevices[i]->getLinearVelocity();
-			trackingStates[i].angularVelocity=inputDevices[i]->getAngularVelocity();
-			for(int j=0;j<inputDevices[i]->getNumButtons();++j,++bsPtr)
-				*bsPtr=inputDevices[i]->getButtonState(j);
-			for(int j=0;j<inputDevices[i]->getNumValuators();++j,++vsPtr)
-				*vsPtr=inputDevices[i]->getValuator(j);
+			InputDevice* device=inputDevices[i];
+			InputDeviceTrackingState& ts=trackingStates[i];
+			Misc::UInt8 changeFlags=0x00U;
+			
+			/* Check the device ray for changes: */
+			Vector rayDirection=device->getDeviceRayDirection();
+			Scalar rayStart=device->getDeviceRayStart();
+			if(sendFullState||!isBitwiseEqual(rayDirection,ts.deviceRayDirection)||!isBitwiseEqual(rayStart,ts.deviceRayStart))
+				{
+				ts.deviceRayDirection=rayDirection;
+				ts.deviceRayStart=rayStart;
+				changeFlags|=RAY_CHANGED;
+				}
+			
+			/* Check the device transformation and velocities for changes at the precision at which they will be sent: */
+			QuantizedTransformation quantized;
+			TrackerState transformation=device->getTransformation();
+			Vector linearVelocity=device->getLinearVelocity();
+			Vector angularVelocity=device->getAngularVelocity();
+			if(positionQuantum>Scalar(0))
+				{
+				quantized=quantize(transformation,positionQuantum);
+				transformation=dequantize(quantized,positionQuantum);
+				linearVelocity=roundToFloat(linearVelocity);
+				angularVelocity=roundToFloat(angularVelocity);
+				
+				/* Apply the reduced-precision state to the master's device as well, so that all nodes see identical device states: */
+				device->setTransformation(transformation);
+				device->setLinearVelocity(linearVelocity);
+				device->setAngularVelocity(angularVelocity);
+				}
+			if(sendFullState||!isBitwiseEqual(transformation,ts.transformation))
+				{
+				ts.transformation=transformation;
+				changeFlags|=TRANSFORMATION_CHANGED;
+				}
+			if(sendFullState||!isBitwiseEqual(linearVelocity,ts.linearVelocity)||!isBitwiseEqual(angularVelocity,ts.angularVelocity))
+				{
+				ts.linearVelocity=linearVelocity;
+				ts.angularVelocity=angularVelocity;
+				changeFlags|=VELOCITIES_CHANGED;
+				}
+			
+			/* Check the device's buttons for changes: */
+			int numButtons=device->getNumButtons();
+			for(int j=0;j<numButtons;++j)
+				{
+				bool buttonState=device->getButtonState(j);
+				if(sendFullState||buttonState!=bsPtr[j])
+					{
+					bsPtr[j]=buttonState;
+					changeFlags|=BUTTONS_CHANGED;
+					}
+				}
+			
+			/* Collect the device's changed valuators: */
+			int numValuators=device->getNumValuators();
+			int numChangedValuators=0;
+			for(int j=0;j<numValuators;++j)
+				{
+				double valuatorState=device->getValuator(j);
+				if(sendFullState||!isBitwiseEqual(valuatorState,vsPtr[j]))
+					{
+					vsPtr[j]=valuatorState;
+					changedValuatorIndices[numChangedValuators++]=Misc::UInt16(j);
+					}
+				}
+			if(numChangedValuators>0)
+				changeFlags|=VALUATORS_CHANGED;
+			
+			/* Send the changed parts of the device's state: */
+			pipe->write<Misc::UInt8>(changeFlags);
+			if(changeFlags&RAY_CHANGED)
+				{
+				Misc::Marshaller<Vector>::write(ts.deviceRayDirection,*pipe);
+				pipe->write<Scalar>(ts.deviceRayStart);
+				}
+			if(changeFlags&TRANSFORMATION_CHANGED)
+				{
+				if(positionQuantum>Scalar(0))
+					{
+					pipe->write<Misc::SInt32>(quantized.translation,3);
+					pipe->write<Misc::SInt16>(quantized.rotation,3);
+					pipe->write<Misc::UInt8>(quantized.largestComponent);
+					}
+				else
+					Misc::Marshaller<TrackerState>::write(ts.transformation,*pipe);
+				}
+			if(changeFlags&VELOCITIES_CHANGED)
+				{
+				if(positionQuantum>Scalar(0))
+					{
+					for(int j=0;j<3;++j)
+						pipe->write<Misc::Float32>(Misc::Float32(ts.linearVelocity[j]));
+					for(int j=0;j<3;++j)
+						pipe->write<Misc::Float32>(Misc::Float32(ts.angularVelocity[j]));
+					}
+				else
+					{
+					Misc::Marshaller<Vector>::write(ts.linearVelocity,*pipe);
+					Misc::Marshaller<Vector>::write(ts.angularVelocity,*pipe);
+					}
+				}
+			if(changeFlags&BUTTONS_CHANGED)
+				{
+				/* Send all button states as a bit mask: */
+				for(int j=0;j<numButtons;j+=8)
+					{
+					Misc::UInt8 buttonBits=0x00U;
+					for(int k=0;k<8&&j+k<numButtons;++k)
+						if(bsPtr[j+k])
+							buttonBits|=Misc::UInt8(0x01U<<k);
+					pipe->write<Misc::UInt8>(buttonBits);
+					}
+				}
+			if(changeFlags&VALUATORS_CHANGED)
+				{
+				/* Send the indices and new values of all changed valuators: */
+				pipe->write<Misc::UInt16>(Misc::UInt16(numChangedValuators));
+				for(int j=0;j<numChangedValuators;++j)
+					{
+					pipe->write<Misc::UInt16>(changedValuatorIndices[j]);
+					pipe->write<double>(vsPtr[changedValuatorIndices[j]]);
+					}
+				}
+			
+			/* Go to the next device: */
+			bsPtr+=numButtons;
+			vsPtr+=numValuators;
 			}
 		
-		/* Send the input device states to the slave nodes: */
-		pipe->write<InputDeviceTrackingState>(trackingStates,numInputDevices);
-		pipe->write<bool>(buttonStates,totalNumButtons);
-		pipe->write<double>(valuatorStates,totalNumValuators);
+		sendFullState=false;
 		}
 	else
 		{
-		/* Receive the input device states from the master node: */
-		pipe->read<InputDeviceTrackingState>(trackingStates,numInputDevices);
-		pipe->read<bool>(buttonStates,totalNumButtons);
-		pipe->read<double>(valuatorStates,totalNumValuators);
-		
-		/* Set the state of all input devices: */
+		/* Receive the changes to all input devices' states from the master node, and set the state of all input devices: */
 		bool* bsPtr=buttonStates;
 		double* vsPtr=valuatorStates;
 		for(int i=0;i<numInputDevices;++i)
 			{
-			inputDevices[i]->setDeviceRay(trackingStates[i].deviceRayDirection,trackingStates[i].deviceRayStart);
-			inputDevices[i]->setTransformation(trackingStates[i].transformation);
-			inputDevices[i]->setLinearVelocity(trackingStates[i].linearVelocity);
-			inputDevices[i]->setAngularVelocity(trackingStates[i].angularVelocity);
-			for(int j=0;j<inputDevices[i]->getNumButtons();++j,++bsPtr)
-				inputDevices[i]->setButtonState(j,*bsPtr);
-			for(int j=0;j<inputDevices[i]->getNumValuators();++j,++vsPtr)
-				inputDevices[i]->setValuator(j,*vsPtr);
+			InputDevice* device=inputDevices[i];
+			InputDeviceTrackingState& ts=trackingStates[i];
+			int numButtons=device->getNumButtons();
+			int numValuators=device->getNumValuators();
+			
+			/* Receive the changed parts of the device's state: */
+			Misc::UInt8 changeFlags=pipe->read<Misc::UInt8>();
+			if(changeFlags&RAY_CHANGED)
+				{
+				ts.deviceRayDirection=Misc::Marshaller<Vector>::read(*pipe);
+				ts.deviceRayStart=pipe->read<Scalar>();
+				}
+			if(changeFlags&TRANSFORMATION_CHANGED)
+				{
+				if(positionQuantum>Scalar(0))
+					{
+					QuantizedTransformation quantized;
+					pipe->read<Misc::SInt32>(quantized.translation,3);
+					pipe->read<Misc::SInt16>(quantized.rotation,3);
+					quantized.largestComponent=pipe->read<Misc::UInt8>();
+					ts.transformation=dequantize(quantized,positionQuantum);
+					}
+				else
+					ts.transformation=Misc::Marshaller<TrackerState>::read(*pipe);
+				}
+			if(changeFlags&VELOCITIES_CHANGED)
+				{
+				if(positionQuantum>Scalar(0))
+					{
+					for(int j=0;j<3;++j)
+						ts.linearVelocity[j]=Scalar(pipe->read<Misc::Float32>());
+					for(int j=0;j<3;++j)
+						ts.angularVelocity[j]=Scalar(pipe->read<Misc::Float32>());
+					}
+				else
+					{
+					ts.linearVelocity=Misc::Marshaller<Vector>::read(*pipe);
+					ts.angularVelocity=Misc::Marshaller<Vector>::read(*pipe);
+					}
+				}
+			if(changeFlags&BUTTONS_CHANGED)
+				{
+				/* Unpack the button state bit mask: */
+				for(int j=0;j<numButtons;j+=8)
+					{
+					Misc::UInt8 buttonBits=pipe->read<Misc::UInt8>();
+					for(int k=0;k<8&&j+k<numButtons;++k)
+						bsPtr[j+k]=(buttonBits&(0x01U<<k))!=0x00U;
+					}
+				}
+			if(changeFlags&VALUATORS_CHANGED)
+				{
+				/* Update all changed valuators: */
+				unsigned int numChangedValuators=pipe->read<Misc::UInt16>();
+				for(unsigned int j=0;j<numChangedValuators;++j)
+					{
+					unsigned int valuatorIndex=pipe->read<Misc::UInt16>();
+					vsPtr[valuatorIndex]=pipe->read<double>();
+					}
+				}
+			
+			/* Set the device's complete state: */
+			device->setDeviceRay(ts.deviceRayDirection,ts.deviceRayStart);
+			device->setTransformation(ts.transformation);
+			device->setLinearVelocity(ts.linearVelocity);
+			device->setAngularVelocity(ts.angularVelocity);
+			for(int j=0;j<numButtons;++j)
+				device->setButtonState(j,bsPtr[j]);
+			for(int j=0;j<numValuators;++j)
+				device->setValuator(j,vsPtr[j]);
+			
+			/* Go to the next device: */
+			bsPtr+=numButtons;
+			vsPtr+=numValuators;
 			}
 		}
 	}
@@ -26,6 +26,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <string>
 #include <vector>
+#include <Misc/SizedTypes.h>
 #include <Geometry/Vector.h>
 #include <Geometry/OrthonormalTransformation.h>
 #include <Vrui/Geometry.h>
@@ -56,24 +57,49 @@ class MultipipeDispatcher:public InputDeviceAdapter
 		Vector angularVelocity;
 		};
 	
+	enum StateChangeFlags // Enumerated type for flags identifying the changed parts of an input device's state in a state update
+		{
+		RAY_CHANGED=0x01,
+		TRANSFORMATION_CHANGED=0x02,
+		VELOCITIES_CHANGED=0x04,
+		BUTTONS_CHANGED=0x08,
+		VALUATORS_CHANGED=0x10
+		};
+	
+	struct QuantizedTransformation // Structure for tracker states encoded with reduced precision
+		{
+		/* Elements: */
+		public:
+		Misc::SInt32 translation[3]; // Translation vector in multiples of the position quantum
+		Misc::SInt16 rotation[3]; // Three smallest components of the rotation quaternion in units of 1/(32767*sqrt(2))
+		Misc::UInt8 largestComponent; // Index of the omitted, largest, non-negative component of the rotation quaternion
+		};
+	
 	/* Elements: */
 	private:
 	Cluster::MulticastPipe* pipe; // Multicast pipe connecting the master node to all slave nodes
 	int totalNumButtons; // Total number of buttons on all dispatched input devices
 	int totalNumValuators; // Total number of valuators on all dispatched input devices
+	Scalar positionQuantum; // Resolution of quantized tracker positions in physical coordinate units; quantization is disabled if zero
+	bool sendFullState; // Flag whether the next update must contain the complete state of all input devices
 	
 	/* Slave state: */
 	std::vector<std::string> buttonNames; // Array of button names for all dispatched input devices
 	std::vector<std::string> valuatorNames; // Array of button names for all dispatched input devices
 	
-	/* Transient state to marshall input device states over a multicast pipe: */
+	/* Input device states as of the most recent update, against which state changes are encoded: */
 	InputDeviceTrackingState* trackingStates; // Array of input device tracking states
 	bool* buttonStates; // Array of input device button states
 	double* valuatorStates; // Array of input device valuator states
+	Misc::UInt16* changedValuatorIndices; // Array of indices of valuators that changed during the current update
+	
+	/* Private methods: */
+	static QuantizedTransformation quantize(const TrackerState& transformation,Scalar positionQuantum); // Encodes the given tracker state with reduced precision
+	static TrackerState dequantize(const QuantizedTransformation& quantized,Scalar positionQuantum); // Decodes the given reduced-precision tracker state
 	
 	/* Constructors and destructors: */
 	public:
-	MultipipeDispatcher(InputDeviceManager* sInputDeviceManager,Cluster::MulticastPipe* sPipe);
+	MultipipeDispatcher(InputDeviceManager* sInputDeviceManager,Cluster::MulticastPipe* sPipe,Scalar sPositionQuantum); // Creates dispatcher on the given pipe; position quantum is only used on the master node, and forwarded to the slave nodes
 	virtual ~MultipipeDispatcher(void);
 	
 	/* Methods from InputDeviceAdapter: */
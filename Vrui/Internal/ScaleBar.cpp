@@ -226,6 +226,9 @@ void ScaleBar::calcSize(const NavTransform& newNavigationTransformation)
 	scaleLabel->setString(scaleLabelText);
 	GLLabel::Box::Vector scaleLabelSize=scaleLabel->getLabelSize();
 	scaleLabel->setOrigin(GLLabel::Box::Vector(-scaleLabelSize[0]*0.5f,-scaleLabelSize[1]*1.5f,0.0f));
+	
+	/* Invalidate the visual representation, as the labels are not widgets and do not notify the widget manager: */
+	update();
 	}
 
 void ScaleBar::navigationChangedCallback(NavigationTransformationChangedCallbackData* cbData)
@@ -27,6 +27,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/ThrowStdErr.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
+#include <Realtime/Time.h>
 #include <IO/File.h>
 #include <IO/OpenFile.h>
 #include <Video/FrameBuffer.h>
@@ -53,6 +54,10 @@ void TheoraMovieSaver::frameWritingThreadMethod(void)
 		frames.lockNewValue();
 		capturedFrames.push_back(frames.getLockedValue());
 		captureCond.signal();
+		
+		/* Update the capture statistics: */
+		Threads::Mutex::Lock statisticsLock(statisticsMutex);
+		statistics.numQueuedFrames=capturedFrames.size();
 		}
 		
 		/* Wait for the next frame: */
@@ -153,6 +158,10 @@ void* TheoraMovieSaver::frameSavingThreadMethod(void)
 			break;
 		frame=capturedFrames.front();
 		capturedFrames.pop_front();
+		{
+		Threads::Mutex::Lock statisticsLock(statisticsMutex);
+		statistics.numQueuedFrames=capturedFrames.size();
+		}
 		
 		/* Print a progress report if movie saver is already shut down: */
 		if(done)
@@ -174,6 +183,7 @@ void* TheoraMovieSaver::frameSavingThreadMethod(void)
 			}
 		
 		/* Convert the new raw RGB frame to Y'CbCr 4:2:0: */
+		Realtime::TimePointMonotonic encodeStart;
 		Video::FrameBuffer tempFrame;
 		tempFrame.start=frame.getBuffer();
 		imageExtractor->extractYpCbCr420(&tempFrame,theoraFrame.planes[0].data,theoraFrame.planes[0].stride,theoraFrame.planes[1].data,theoraFrame.planes[1].stride,theoraFrame.planes[2].data,theoraFrame.planes[2].stride);
@@ -193,6 +203,7 @@ void* TheoraMovieSaver::frameSavingThreadMethod(void)
 			while(oggStream.pageOut(page))
 				page.write(*movieFile);
 			}
+		frameWritten(double(encodeStart.setAndDiff()));
 		}
 	
 	return 0;
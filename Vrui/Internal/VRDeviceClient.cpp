@@ -25,11 +25,13 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Misc/SizedTypes.h>
 #include <Misc/Time.h>
+#include <Misc/StringMarshaller.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
 #include <Realtime/Time.h>
 #include <Vrui/Internal/VRDeviceDescriptor.h>
 #include <Vrui/Internal/HMDConfiguration.h>
+#include <Vrui/Internal/VRDeviceSharedState.h>
 
 namespace Vrui {
 
@@ -47,13 +49,19 @@ void adjustTrackerStateTimeStamps(VRDeviceState& state,VRDeviceState::TimeStamp
 		*tsPtr+=timeStampDelta;
 	}
 
-void setTrackerStateTimeStamps(VRDeviceState& state) // Sets tracker state time stamps to current monotonic time
+VRDeviceState::TimeStamp getTimeStamp(void) // Returns a time stamp for the current monotonic time
 	{
 	/* Get the current monotonic time: */
 	Realtime::TimePointMonotonic now;
 	
 	/* Get the lower-order bits of the microsecond time: */
-	VRDeviceState::TimeStamp ts=VRDeviceState::TimeStamp(now.tv_sec*1000000+(now.tv_nsec+500)/1000);
+	return VRDeviceState::TimeStamp(now.tv_sec*1000000+(now.tv_nsec+500)/1000);
+	}
+
+void setTrackerStateTimeStamps(VRDeviceState& state) // Sets tracker state time stamps to current monotonic time
+	{
+	/* Get the current time stamp: */
+	VRDeviceState::TimeStamp ts=getTimeStamp();
 	
 	/* Set all tracker state time stamps to the current time: */
 	VRDeviceState::TimeStamp* tsPtr=state.getTrackerTimeStamps();
@@ -83,7 +91,7 @@ void* VRDeviceClient::streamReceiveThreadMethod(void)
 				{
 				Threads::Mutex::Lock stateLock(stateMutex);
 				state.read(pipe,serverHasTimeStamps,serverHasValidFlags);
-				if(!serverHasTimeStamps)
+				if(!serverHasTimeStamps||!serverClockSynced)
 					{
 					/* Set all tracker time stamps to the current local time: */
 					setTrackerStateTimeStamps(state);
@@ -174,6 +182,34 @@ void* VRDeviceClient::streamReceiveThreadMethod(void)
 	return 0;
 	}
 
+void* VRDeviceClient::sharedStateReceiveThreadMethod(void)
+	{
+	/* Start from the state the server published most recently: */
+	Misc::UInt32 lastSequence=sharedState->getSequence()&~0x1U;
+	
+	while(sharedStreaming&&!connectionDead)
+		{
+		/* Wait for the server to publish a new state; time out periodically to check for shutdown: */
+		if(!sharedState->waitForUpdate(lastSequence,100U))
+			continue;
+		
+		/* Copy the new state directly into the shadow state; time stamps share the server's clock source: */
+		{
+		Threads::Mutex::Lock stateLock(stateMutex);
+		lastSequence=sharedState->read(state);
+		}
+		
+		/* Signal packet reception: */
+		packetSignalCond.broadcast();
+		
+		/* Invoke packet notification callback: */
+		if(packetNotificationCallback!=0)
+			(*packetNotificationCallback)(this);
+		}
+	
+	return 0;
+	}
+
 void VRDeviceClient::initClient(void)
 	{
 	/* Determine whether client and server are running on the same host: */
@@ -217,9 +253,6 @@ void VRDeviceClient::initClient(void)
 	/* Check if the server will send tracker state time stamps: */
 	serverHasTimeStamps=serverProtocolVersionNumber>=3U;
 	
-	/* Initialize the clock offset: */
-	timeStampDelta=0;
-	
 	/* Create an array to cache virtual input devices' battery states: */
 	if(!virtualDevices.empty())
 		batteryStates=new BatteryState[virtualDevices.size()];
@@ -273,6 +306,63 @@ void VRDeviceClient::initClient(void)
 		numPowerFeatures=pipe.read<Misc::UInt32>();
 		numHapticFeatures=pipe.read<Misc::UInt32>();
 		}
+	
+	/* Check if the server offers its device state via shared memory: */
+	if(serverProtocolVersionNumber>=7U)
+		{
+		/* Read the name of the server's shared memory segment; server only sends it to clients on the same host: */
+		std::string sharedStateName=Misc::readCppString(pipe);
+		if(local&&!sharedStateName.empty())
+			{
+			try
+				{
+				/* Map the shared memory segment and check its layout: */
+				sharedState=new VRDeviceSharedState(sharedStateName.c_str());
+				if(!sharedState->hasLayout(state))
+					{
+					delete sharedState;
+					sharedState=0;
+					}
+				}
+			catch(const std::runtime_error&)
+				{
+				/* Fall back to receiving states via TCP: */
+				sharedState=0;
+				}
+			}
+		}
+	
+	/* Relate the server's time stamps to the local clock source: */
+	serverClockSynced=local;
+	timeStampDelta=0;
+	if(serverHasTimeStamps&&!local&&serverProtocolVersionNumber>=8U)
+		{
+		/* Estimate the clock offset from several time stamp exchanges, trusting the one with the shortest round trip most: */
+		VRDeviceState::TimeStamp minRoundTrip=0;
+		for(int i=0;i<8;++i)
+			{
+			/* Request the server's current time stamp: */
+			VRDeviceState::TimeStamp requestTs=getTimeStamp();
+			pipe.writeMessage(VRDevicePipe::CLOCKSYNC_REQUEST);
+			pipe.flush();
+			
+			/* Wait for server's reply: */
+			if(!pipe.waitForData(Misc::Time(10,0)))
+				throw ProtocolError("VRDeviceClient: Timeout while waiting for CLOCKSYNC_REPLY",this);
+			if(pipe.readMessage()!=VRDevicePipe::CLOCKSYNC_REPLY)
+				throw ProtocolError("VRDeviceClient: Mismatching message while waiting for CLOCKSYNC_REPLY",this);
+			VRDeviceState::TimeStamp serverTs=pipe.read<VRDeviceState::TimeStamp>();
+			VRDeviceState::TimeStamp roundTrip=getTimeStamp()-requestTs;
+			
+			/* Assume the server took its time stamp halfway through the round trip: */
+			if(i==0||minRoundTrip>roundTrip)
+				{
+				minRoundTrip=roundTrip;
+				timeStampDelta=requestTs+roundTrip/2-serverTs;
+				}
+			}
+		serverClockSynced=true;
+		}
 	}
 
 VRDeviceClient::VRDeviceClient(const char* deviceServerName,int deviceServerPort)
@@ -280,9 +370,10 @@ VRDeviceClient::VRDeviceClient(const char* deviceServerName,int deviceServerPort
 	 serverProtocolVersionNumber(0),serverHasTimeStamps(false),
 	 batteryStates(0),batteryStateUpdatedCallback(0),
 	 numHmdConfigurations(0),hmdConfigurations(0),hmdConfigurationUpdatedCallbacks(0),
-	 numPowerFeatures(0),numHapticFeatures(0),
-	 active(false),streaming(false),connectionDead(false),
-	 packetNotificationCallback(0),errorCallback(0)
+	 numPowerFeatures(0),numHapticFeatures(0),sharedState(0),
+	 active(false),streaming(false),connectionDead(false),sharedStreaming(false),
+	 packetNotificationCallback(0),errorCallback(0),
+	 serverClockSynced(false),timeStampDelta(0)
 	{
 	initClient();
 	}
@@ -292,9 +383,10 @@ VRDeviceClient::VRDeviceClient(const Misc::ConfigurationFileSection& configFileS
 	 serverProtocolVersionNumber(0),serverHasTimeStamps(false),
 	 batteryStates(0),batteryStateUpdatedCallback(0),
 	 numHmdConfigurations(0),hmdConfigurations(0),hmdConfigurationUpdatedCallbacks(0),
-	 numPowerFeatures(0),numHapticFeatures(0),
-	 active(false),streaming(false),connectionDead(false),
-	 packetNotificationCallback(0),errorCallback(0)
+	 numPowerFeatures(0),numHapticFeatures(0),sharedState(0),
+	 active(false),streaming(false),connectionDead(false),sharedStreaming(false),
+	 packetNotificationCallback(0),errorCallback(0),
+	 serverClockSynced(false),timeStampDelta(0)
 	{
 	initClient();
 	}
@@ -328,6 +420,9 @@ VRDeviceClient::~VRDeviceClient(void)
 	/* Delete battery states and HMD configurations: */
 	delete[] batteryStates;
 	delete[] hmdConfigurations;
+	
+	/* Unmap the server's shared memory segment: */
+	delete sharedState;
 	}
 
 const HMDConfiguration& VRDeviceClient::getHmdConfiguration(unsigned int index) const
@@ -395,7 +490,7 @@ void VRDeviceClient::getPacket(void)
 				{
 				Threads::Mutex::Lock stateLock(stateMutex);
 				state.read(pipe,serverHasTimeStamps,serverHasValidFlags);
-				if(!serverHasTimeStamps)
+				if(!serverHasTimeStamps||!serverClockSynced)
 					{
 					/* Set all tracker time stamps to the current local time: */
 					setTrackerStateTimeStamps(state);
@@ -489,11 +584,18 @@ void VRDeviceClient::startStream(VRDeviceClient::Callback* newPacketNotification
 		/* Send start streaming message and wait for first state packet to arrive: */
 		{
 		Threads::MutexCond::Lock packetSignalLock(packetSignalCond);
-		pipe.writeMessage(VRDevicePipe::STARTSTREAM_REQUEST);
+		pipe.writeMessage(sharedState!=0?VRDevicePipe::STARTSHAREDSTREAM_REQUEST:VRDevicePipe::STARTSTREAM_REQUEST);
 		pipe.flush();
 		packetSignalCond.wait(packetSignalLock);
 		streaming=true;
 		}
+		
+		if(sharedState!=0)
+			{
+			/* Start receiving subsequent states from the server's shared memory segment: */
+			sharedStreaming=true;
+			sharedStateReceiveThread.start(this,&VRDeviceClient::sharedStateReceiveThreadMethod);
+			}
 		}
 	else
 		{
@@ -508,6 +610,14 @@ void VRDeviceClient::stopStream(void)
 	if(streaming)
 		{
 		streaming=false;
+		
+		if(sharedStreaming)
+			{
+			/* Stop receiving states from shared memory: */
+			sharedStreaming=false;
+			sharedStateReceiveThread.join();
+			}
+		
 		if(!connectionDead)
 			{
 			/* Send stop streaming message: */
@@ -42,6 +42,7 @@ class ConfigurationFileSection;
 namespace Vrui {
 class VRDeviceDescriptor;
 class HMDConfiguration;
+class VRDeviceSharedState;
 }
 
 namespace Vrui {
@@ -88,17 +89,22 @@ class VRDeviceClient
 	HMDConfigurationUpdatedCallback** hmdConfigurationUpdatedCallbacks; // Callbacks called when an HMD configuration has been updated
 	unsigned int numPowerFeatures; // Number of power features maintained by the server
 	unsigned int numHapticFeatures; // Number of haptic features maintained by the server
+	VRDeviceSharedState* sharedState; // Server's shared memory segment if the server runs on the same host and offers one, or null
 	bool active; // Flag if client is active
 	bool streaming; // Flag if client is in streaming mode
 	volatile bool connectionDead; // Flag whether the connection to the server was interrupted while in streaming mode
 	Threads::Thread streamReceiveThread; // Packet receiving thread in stream mode
+	volatile bool sharedStreaming; // Flag whether the shared state receiving thread is reading device states from shared memory
+	Threads::Thread sharedStateReceiveThread; // Thread reading device states from the server's shared memory segment in stream mode
 	Threads::MutexCond packetSignalCond; // Condition variable to signal packet reception in streaming mode
 	Callback* packetNotificationCallback; // Function called when a new state packet arrives from the server in streaming mode (called from background thread)
 	ErrorCallback* errorCallback; // Function called when a protocol error occurs in streaming mode (called from background thread)
+	bool serverClockSynced; // Flag whether the server's time stamps can be converted to the client's local clock source, because the server runs on the same host or the clock offset was estimated
 	VRDeviceState::TimeStamp timeStampDelta; // Offset between server's time stamps and the client's local clock source
 	
 	/* Private methods: */
 	void* streamReceiveThreadMethod(void); // Stream packet receiving thread method
+	void* sharedStateReceiveThreadMethod(void); // Shared memory state receiving thread method
 	void initClient(void); // Initializes communication between device server and client
 	
 	/* Constructors and destructors: */
@@ -112,6 +118,10 @@ class VRDeviceClient
 		{
 		return local;
 		}
+	bool isShared(void) const // Returns true if the client receives device states from the server via shared memory; this saves the TCP round trip and packet decoding, but each new state is still copied from the shared segment into the client's own state while holding the state lock, as getState() returns that copy
+		{
+		return sharedState!=0;
+		}
 	int getNumVirtualDevices(void) const // Returns the number of managed virtual input devices
 		{
 		return int(virtualDevices.size());
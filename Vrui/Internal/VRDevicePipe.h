@@ -51,7 +51,10 @@ class VRDevicePipe:public Comm::TCPPipe
 		BATTERYSTATE_UPDATE, // Battery status of a virtual input device has changed
 		HMDCONFIG_UPDATE=16, // Server has an updated HMD configuration; lowest three bits of message ID define which components are updated
 		POWEROFF_REQUEST=24, // Requests to power off a virtual input device
-		HAPTICTICK_REQUEST // Requests a haptic tick on a virtual input device
+		HAPTICTICK_REQUEST, // Requests a haptic tick on a virtual input device
+		STARTSHAREDSTREAM_REQUEST, // Requests entering stream mode where device states are read from the server's shared memory segment instead of sent as packets
+		CLOCKSYNC_REQUEST, // Requests the server's current time stamp to estimate the offset between the server's and the client's clocks
+		CLOCKSYNC_REPLY // Sends the server's current time stamp
 		};
 	
 	/* Constructors and destructors: */
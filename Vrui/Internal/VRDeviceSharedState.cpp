@@ -0,0 +1,280 @@
+/***********************************************************************
+VRDeviceSharedState - Class to publish a VR device server's current
+device state to clients running on the same host via a shared memory
+segment protected by a sequence lock.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Vrui/Internal/VRDeviceSharedState.h>
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#ifdef __linux__
+#include <limits.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+#include <Misc/ThrowStdErr.h>
+
+namespace Vrui {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const Misc::UInt32 sharedStateMagic=0x56525353U; // Magic number identifying shared device state segments ("VRSS")
+
+inline size_t alignOffset(size_t offset,size_t alignment) // Rounds the given offset up to the next multiple of the given alignment
+	{
+	return ((offset+alignment-1)/alignment)*alignment;
+	}
+
+inline void memoryBarrier(void) // Issues a full memory barrier
+	{
+	__sync_synchronize();
+	}
+
+}
+
+/************************************
+Methods of class VRDeviceSharedState:
+************************************/
+
+void VRDeviceSharedState::calcLayout(int numTrackers,int numButtons,int numValuators)
+	{
+	/* Lay out the state arrays behind the header, each aligned for its element type: */
+	size_t offset=alignOffset(sizeof(Header),64);
+	trackerStatesOffset=offset;
+	offset+=size_t(numTrackers)*sizeof(VRDeviceState::TrackerState);
+	trackerTimeStampsOffset=offset=alignOffset(offset,sizeof(VRDeviceState::TimeStamp));
+	offset+=size_t(numTrackers)*sizeof(VRDeviceState::TimeStamp);
+	trackerValidsOffset=offset;
+	offset+=size_t(numTrackers)*sizeof(VRDeviceState::ValidFlag);
+	buttonStatesOffset=offset;
+	offset+=size_t(numButtons)*sizeof(VRDeviceState::ButtonState);
+	valuatorStatesOffset=offset=alignOffset(offset,sizeof(VRDeviceState::ValuatorState));
+	offset+=size_t(numValuators)*sizeof(VRDeviceState::ValuatorState);
+	size=offset;
+	}
+
+bool VRDeviceSharedState::isSupported(void)
+	{
+	#ifdef __linux__
+	return true;
+	#else
+	return false;
+	#endif
+	}
+
+VRDeviceSharedState::VRDeviceSharedState(const char* sName,const VRDeviceState& layout)
+	:name(sName),owner(true),size(0),memory(0),header(0)
+	{
+	#ifdef __linux__
+	/* Create the OS-level name of the shared memory segment: */
+	std::string osName="/";
+	osName.append(sName);
+	
+	/* Calculate the segment layout: */
+	calcLayout(layout.getNumTrackers(),layout.getNumButtons(),layout.getNumValuators());
+	
+	/* Create the shared memory segment, replacing a stale segment left behind by a crashed server; only the server's group may read it, and clients outside that group fall back to TCP: */
+	shm_unlink(osName.c_str());
+	int fd=shm_open(osName.c_str(),O_RDWR|O_CREAT|O_EXCL,S_IRUSR|S_IWUSR|S_IRGRP);
+	if(fd<0)
+		Misc::throwStdErr("VRDeviceSharedState::VRDeviceSharedState: Unable to create shared memory segment %s",sName);
+	
+	/* Size and map the shared memory segment: */
+	if(ftruncate(fd,off_t(size))<0)
+		{
+		close(fd);
+		shm_unlink(osName.c_str());
+		Misc::throwStdErr("VRDeviceSharedState::VRDeviceSharedState: Unable to resize shared memory segment %s",sName);
+		}
+	void* address=mmap(0,size,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+	close(fd);
+	if(address==MAP_FAILED)
+		{
+		shm_unlink(osName.c_str());
+		Misc::throwStdErr("VRDeviceSharedState::VRDeviceSharedState: Unable to map shared memory segment %s",sName);
+		}
+	memory=static_cast<Misc::UInt8*>(address);
+	header=reinterpret_cast<Header*>(memory);
+	
+	/* Initialize the header; the segment is zero-filled by ftruncate: */
+	header->numTrackers=Misc::UInt32(layout.getNumTrackers());
+	header->numButtons=Misc::UInt32(layout.getNumButtons());
+	header->numValuators=Misc::UInt32(layout.getNumValuators());
+	header->sequence=0U;
+	memoryBarrier();
+	header->magic=sharedStateMagic;
+	
+	/* Publish the initial state: */
+	write(layout,false);
+	#else
+	Misc::throwStdErr("VRDeviceSharedState::VRDeviceSharedState: Shared device states not supported on this operating system");
+	#endif
+	}
+
+VRDeviceSharedState::VRDeviceSharedState(const char* sName)
+	:name(sName),owner(false),size(0),memory(0),header(0)
+	{
+	#ifdef __linux__
+	/* Create the OS-level name of the shared memory segment: */
+	std::string osName="/";
+	osName.append(sName);
+	
+	/* Open the shared memory segment: */
+	int fd=shm_open(osName.c_str(),O_RDONLY,0);
+	if(fd<0)
+		Misc::throwStdErr("VRDeviceSharedState::VRDeviceSharedState: Unable to access shared memory segment %s",sName);
+	
+	/* Query the shared memory segment's size: */
+	struct stat sharedMemoryStats;
+	if(fstat(fd,&sharedMemoryStats)<0||size_t(sharedMemoryStats.st_size)<sizeof(Header))
+		{
+		close(fd);
+		Misc::throwStdErr("VRDeviceSharedState::VRDeviceSharedState: Invalid shared memory segment %s",sName);
+		}
+	size_t segmentSize=size_t(sharedMemoryStats.st_size);
+	
+	/* Map the shared memory segment read-only: */
+	void* address=mmap(0,segmentSize,PROT_READ,MAP_SHARED,fd,0);
+	close(fd);
+	if(address==MAP_FAILED)
+		Misc::throwStdErr("VRDeviceSharedState::VRDeviceSharedState: Unable to map shared memory segment %s",sName);
+	memory=static_cast<Misc::UInt8*>(address);
+	header=reinterpret_cast<Header*>(memory);
+	
+	/* Check the segment's header and size against its advertised layout: */
+	calcLayout(int(header->numTrackers),int(header->numButtons),int(header->numValuators));
+	if(header->magic!=sharedStateMagic||size!=segmentSize)
+		{
+		munmap(memory,segmentSize);
+		Misc::throwStdErr("VRDeviceSharedState::VRDeviceSharedState: Shared memory segment %s does not contain a device state",sName);
+		}
+	#else
+	Misc::throwStdErr("VRDeviceSharedState::VRDeviceSharedState: Shared device states not supported on this operating system");
+	#endif
+	}
+
+VRDeviceSharedState::~VRDeviceSharedState(void)
+	{
+	/* Unmap the shared memory segment: */
+	if(memory!=0)
+		munmap(memory,size);
+	
+	/* Destroy the shared memory segment if owned; clients keep their mappings until they unmap: */
+	if(owner)
+		{
+		std::string osName="/";
+		osName.append(name);
+		shm_unlink(osName.c_str());
+		}
+	}
+
+bool VRDeviceSharedState::hasLayout(const VRDeviceState& state) const
+	{
+	return int(header->numTrackers)==state.getNumTrackers()&&int(header->numButtons)==state.getNumButtons()&&int(header->numValuators)==state.getNumValuators();
+	}
+
+void VRDeviceSharedState::write(const VRDeviceState& state,bool wakeReaders)
+	{
+	/* Mark the state as being written: */
+	Misc::UInt32 sequence=header->sequence;
+	header->sequence=sequence+1U;
+	memoryBarrier();
+	
+	/* Copy the state arrays: */
+	memcpy(memory+trackerStatesOffset,state.getTrackerStates(),header->numTrackers*sizeof(VRDeviceState::TrackerState));
+	memcpy(memory+trackerTimeStampsOffset,state.getTrackerTimeStamps(),header->numTrackers*sizeof(VRDeviceState::TimeStamp));
+	memcpy(memory+trackerValidsOffset,state.getTrackerValids(),header->numTrackers*sizeof(VRDeviceState::ValidFlag));
+	memcpy(memory+buttonStatesOffset,state.getButtonStates(),header->numButtons*sizeof(VRDeviceState::ButtonState));
+	memcpy(memory+valuatorStatesOffset,state.getValuatorStates(),header->numValuators*sizeof(VRDeviceState::ValuatorState));
+	
+	/* Mark the state as consistent again: */
+	memoryBarrier();
+	header->sequence=sequence+2U;
+	
+	#ifdef __linux__
+	if(wakeReaders)
+		{
+		/* Wake up all readers waiting on the sequence counter: */
+		syscall(SYS_futex,&header->sequence,FUTEX_WAKE,INT_MAX,0,0,0);
+		}
+	#endif
+	}
+
+Misc::UInt32 VRDeviceSharedState::read(VRDeviceState& state) const
+	{
+	while(true)
+		{
+		/* Wait until no update is in progress: */
+		Misc::UInt32 sequence=header->sequence;
+		if(sequence&0x1U)
+			{
+			sched_yield();
+			continue;
+			}
+		memoryBarrier();
+		
+		/* Copy the state arrays: */
+		memcpy(state.getTrackerStates(),memory+trackerStatesOffset,header->numTrackers*sizeof(VRDeviceState::TrackerState));
+		memcpy(state.getTrackerTimeStamps(),memory+trackerTimeStampsOffset,header->numTrackers*sizeof(VRDeviceState::TimeStamp));
+		memcpy(state.getTrackerValids(),memory+trackerValidsOffset,header->numTrackers*sizeof(VRDeviceState::ValidFlag));
+		memcpy(state.getButtonStates(),memory+buttonStatesOffset,header->numButtons*sizeof(VRDeviceState::ButtonState));
+		memcpy(state.getValuatorStates(),memory+valuatorStatesOffset,header->numValuators*sizeof(VRDeviceState::ValuatorState));
+		
+		/* Accept the snapshot if the server did not touch the state while it was being copied: */
+		memoryBarrier();
+		if(header->sequence==sequence)
+			return sequence;
+		}
+	}
+
+bool VRDeviceSharedState::waitForUpdate(Misc::UInt32 lastSequence,unsigned int timeout) const
+	{
+	#ifdef __linux__
+	/* Block on the sequence counter until it changes or the timeout expires: */
+	Misc::UInt32 sequence=header->sequence;
+	if(sequence==lastSequence)
+		{
+		struct timespec waitTime;
+		waitTime.tv_sec=timeout/1000U;
+		waitTime.tv_nsec=long(timeout%1000U)*1000000L;
+		syscall(SYS_futex,&header->sequence,FUTEX_WAIT,lastSequence,&waitTime,0,0);
+		sequence=header->sequence;
+		}
+	
+	/* Report an update even if it is still in progress; read() will wait for it to finish: */
+	return sequence!=lastSequence;
+	#else
+	return false;
+	#endif
+	}
+
+}
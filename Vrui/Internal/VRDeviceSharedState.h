@@ -0,0 +1,87 @@
+/***********************************************************************
+VRDeviceSharedState - Class to publish a VR device server's current
+device state to clients running on the same host via a shared memory
+segment protected by a sequence lock.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef VRUI_INTERNAL_VRDEVICESHAREDSTATE_INCLUDED
+#define VRUI_INTERNAL_VRDEVICESHAREDSTATE_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <Misc/SizedTypes.h>
+#include <Vrui/Internal/VRDeviceState.h>
+
+namespace Vrui {
+
+class VRDeviceSharedState
+	{
+	/* Embedded classes: */
+	private:
+	struct Header // Structure at the beginning of the shared memory segment
+		{
+		/* Elements: */
+		public:
+		Misc::UInt32 magic; // Magic number to identify shared device state segments
+		Misc::UInt32 numTrackers,numButtons,numValuators; // Layout of the shared device state
+		volatile Misc::UInt32 sequence; // Sequence lock counter; odd while the server is writing; doubles as futex word
+		};
+	
+	/* Elements: */
+	std::string name; // Name of the shared memory segment
+	bool owner; // Flag whether this object created the shared memory segment and is its only writer
+	size_t size; // Size of the mapped shared memory segment
+	Misc::UInt8* memory; // Base pointer to the mapped shared memory segment
+	Header* header; // Pointer to the segment header
+	size_t trackerStatesOffset,trackerTimeStampsOffset,trackerValidsOffset,buttonStatesOffset,valuatorStatesOffset; // Offsets of the state arrays in the shared memory segment
+	
+	/* Private methods: */
+	void calcLayout(int numTrackers,int numButtons,int numValuators); // Calculates array offsets and segment size for the given layout
+	
+	/* Constructors and destructors: */
+	public:
+	static bool isSupported(void); // Returns true if shared device states are supported on the host operating system
+	VRDeviceSharedState(const char* sName,const VRDeviceState& layout); // Creates a new shared memory segment of the given name for the given device state layout (server side)
+	VRDeviceSharedState(const char* sName); // Maps an existing shared memory segment of the given name for reading (client side)
+	private:
+	VRDeviceSharedState(const VRDeviceSharedState& source); // Prohibit copy constructor
+	VRDeviceSharedState& operator=(const VRDeviceSharedState& source); // Prohibit assignment operator
+	public:
+	~VRDeviceSharedState(void); // Unmaps the shared memory segment, and destroys it if owned
+	
+	/* Methods: */
+	const std::string& getName(void) const // Returns the name of the shared memory segment
+		{
+		return name;
+		}
+	bool hasLayout(const VRDeviceState& state) const; // Returns true if the shared device state has the same layout as the given device state
+	Misc::UInt32 getSequence(void) const // Returns the current sequence number; odd while an update is in progress
+		{
+		return header->sequence;
+		}
+	void write(const VRDeviceState& state,bool wakeReaders); // Publishes the given device state; wakes up all readers blocked in waitForUpdate if flag is true
+	Misc::UInt32 read(VRDeviceState& state) const; // Copies a consistent snapshot of the shared device state into the given device state of the same layout; returns the snapshot's sequence number
+	bool waitForUpdate(Misc::UInt32 lastSequence,unsigned int timeout) const; // Blocks until the shared device state was updated since the given sequence number, or the given timeout in milliseconds expires; returns true if an update is available
+	};
+
+}
+
+#endif
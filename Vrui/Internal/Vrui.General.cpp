@@ -49,6 +49,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/ConfigurationFile.h>
 #include <Misc/Time.h>
 #include <Misc/TimerEventScheduler.h>
+#include <Threads/TaskPool.h>
 #include <IO/File.h>
 #include <IO/Directory.h>
 #include <IO/OpenFile.h>
@@ -111,6 +112,8 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/Internal/ToolKillZone.h>
 #include <Vrui/VisletManager.h>
 #include <Vrui/Internal/InputDeviceDataSaver.h>
+#include <Vrui/Internal/FrameProfiler.h>
+#include <Vrui/Internal/LateLatcher.h>
 #include <Vrui/Internal/ScaleBar.h>
 #include <Vrui/OpenFile.h>
 
@@ -523,9 +526,11 @@ VruiState::VruiState(Cluster::Multiplexer* sMultiplexer,Cluster::MulticastPipe*
 	 synchFrameTime(0.0),synchWait(false),
 	 numRecentFrameTimes(0),recentFrameTimes(0),nextFrameTimeIndex(0),sortedFrameTimes(0),
 	 animationFrameInterval(1.0/125.0),
+	 frameProfiler(0),exchangeRenderTimes(false),nodeRenderTimes(0),
 	 activeNavigationTool(0),
 	 updateContinuously(false),
-	 predictVsync(false),vsyncInterval(0,0),numVsyncs(0),nextVsync(0,0),postVsyncDisplayDelay(0.0)
+	 predictVsync(false),vsyncInterval(0,0),numVsyncs(0),nextVsync(0,0),postVsyncDisplayDelay(0.0),
+	 lateLatcher(0)
 	{
 	#if SAVESHAREDVRUISTATE
 	vruiSharedStateFile=IO::openFile("/tmp/VruiSharedState.dat",IO::File::WriteOnly);
@@ -542,6 +547,9 @@ VruiState::~VruiState(void)
 	/* Delete time management: */
 	delete[] recentFrameTimes;
 	delete[] sortedFrameTimes;
+	delete frameProfiler;
+	delete[] nodeRenderTimes;
+	delete lateLatcher;
 	
 	/* Deregister the popup callback: */
 	widgetManager->getWidgetPopCallbacks().remove(this,&VruiState::widgetPopCallback);
@@ -617,6 +625,11 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 	if(configFileSection.retrieveValue<bool>("./inhibitScreenSaver",false))
 		inhibitScreenSaver();
 	
+	/* Set the number of worker threads used for parallel computations, defaulting to one fewer than the number of processors: */
+	int numWorkerThreads=configFileSection.retrieveValue<int>("./numWorkerThreads",-1);
+	if(numWorkerThreads>=0)
+		Threads::TaskPool::setGlobalPoolSize((unsigned int)(numWorkerThreads));
+	
 	if(multiplexer!=0)
 		{
 		/* Set the multiplexer's timeout values: */
@@ -624,6 +637,9 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 		multiplexer->setPingTimeout(configFileSection.retrieveValue<double>("./multipipePingTimeout",10.0),configFileSection.retrieveValue<int>("./multipipePingRetries",3));
 		multiplexer->setReceiveWaitTimeout(configFileSection.retrieveValue<double>("./multipipeReceiveWaitTimeout",0.01));
 		multiplexer->setBarrierWaitTimeout(configFileSection.retrieveValue<double>("./multipipeBarrierWaitTimeout",0.01));
+		
+		/* Set the number of packets the multiplexer sends or receives per system call: */
+		multiplexer->setBatchSize(configFileSection.retrieveValue<unsigned int>("./multipipeBatchSize",16));
 		}
 	
 	/* Create a Vrui-specific message logger: */
@@ -685,6 +701,7 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 	widgetManager->setStyleSheet(&uiStyleSheet);
 	widgetManager->setTimerEventScheduler(timerEventScheduler);
 	widgetManager->setDrawOverlayWidgets(configFileSection.retrieveValue<bool>("./drawOverlayWidgets",widgetManager->getDrawOverlayWidgets()));
+	widgetManager->setCacheWidgetRendering(configFileSection.retrieveValue<bool>("./cacheWidgetRendering",widgetManager->getCacheWidgetRendering()));
 	widgetManager->getWidgetPopCallbacks().add(this,&VruiState::widgetPopCallback);
 	
 	/* Create a UI manager: */
@@ -741,7 +758,7 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 	/* If in cluster mode, create a dispatcher to send input device states to the slaves: */
 	if(multiplexer!=0)
 		{
-		multipipeDispatcher=new MultipipeDispatcher(inputDeviceManager,pipe);
+		multipipeDispatcher=new MultipipeDispatcher(inputDeviceManager,pipe,configFileSection.retrieveValue<Scalar>("./multipipeTrackerQuantum",Scalar(0)));
 		if(!master)
 			{
 			/* On slaves, multipipe dispatcher is owned by input device manager: */
@@ -962,6 +979,30 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 	/* Initialize the suggested animation frame interval: */
 	animationFrameInterval=configFileSection.retrieveValue<double>("./animationFrameInterval",animationFrameInterval);
 	
+	/* Check if the main loop should be profiled: */
+	std::string frameProfilerSectionName=configFileSection.retrieveString("./frameProfiler","");
+	if(!frameProfilerSectionName.empty())
+		{
+		/* Create a frame profiler: */
+		Misc::ConfigurationFileSection frameProfilerSection=configFileSection.getSection(frameProfilerSectionName.c_str());
+		if(multiplexer!=0)
+			frameProfiler=new FrameProfiler(frameProfilerSection,multiplexer->getNodeIndex(),multiplexer->getNumNodes());
+		else
+			frameProfiler=new FrameProfiler(frameProfilerSection,0,1);
+		}
+	
+	/* Let the master node decide whether render times are exchanged, as profiling can be configured differently on each node: */
+	exchangeRenderTimes=frameProfiler!=0;
+	if(multiplexer!=0)
+		{
+		pipe->broadcast<bool>(exchangeRenderTimes);
+		pipe->flush();
+		
+		/* Create a buffer to receive render times if this node takes part in the exchange without profiling: */
+		if(exchangeRenderTimes&&frameProfiler==0)
+			nodeRenderTimes=new float[multiplexer->getNumNodes()];
+		}
+	
 	/* Initialize latency mitigation: */
 	predictVsync=configFileSection.retrieveValue<bool>("./predictVsync",predictVsync);
 	if(predictVsync)
@@ -976,6 +1017,15 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 		nextVsync.set();
 		nextVsync+=Realtime::TimeVector(100000,0);
 		}
+	
+	/* Check if tracked input devices should be re-sampled immediately before rendering: */
+	std::string lateLatchSectionName=configFileSection.retrieveString("./lateLatch","");
+	if(!lateLatchSectionName.empty())
+		{
+		/* Create a late latcher: */
+		Misc::ConfigurationFileSection lateLatchSection=configFileSection.getSection(lateLatchSectionName.c_str());
+		lateLatcher=new LateLatcher(lateLatchSection,inputDeviceManager,numViewers,viewers,multiplexer!=0?pipe:0,master,postVsyncDisplayDelay);
+		}
 	}
 
 void VruiState::createSystemMenu(void)
@@ -1168,7 +1218,10 @@ void VruiState::update(void)
 			}
 		
 		/* Update all physical input devices: */
+		{
+		FrameProfiler::Scope profilerScope(frameProfiler,FrameProfiler::INPUTDEVICES);
 		inputDeviceManager->updateInputDevices();
+		}
 		
 		#if EVILHACK_LOCK_INPUTDEVICE_POS
 		if(lockedDevice!=0)
@@ -1177,6 +1230,8 @@ void VruiState::update(void)
 		
 		if(multiplexer!=0)
 			{
+			FrameProfiler::Scope profilerScope(frameProfiler,FrameProfiler::DISPATCH);
+			
 			/* Write input device states and text events to all slaves: */
 			multipipeDispatcher->updateInputDevices();
 			textEventDispatcher->writeEventQueues(*pipe);
@@ -1198,10 +1253,15 @@ void VruiState::update(void)
 	else
 		{
 		/* Receive input device states and text events from the master: */
+		FrameProfiler::Scope profilerScope(frameProfiler,FrameProfiler::INPUTDEVICES);
 		inputDeviceManager->updateInputDevices();
 		textEventDispatcher->readEventQueues(*pipe);
 		}
 	
+	/* Start measuring the motion-to-photon latency of the new frame: */
+	if(lateLatcher!=0)
+		lateLatcher->frameUpdated();
+	
 	if(multiplexer!=0)
 		{
 		/* Broadcast the current navigation transformation and/or display center/size: */
@@ -1282,10 +1342,16 @@ void VruiState::update(void)
 	textEventDispatcher->dispatchEvents(*widgetManager);
 	
 	/* Update the input graph: */
+	{
+	FrameProfiler::Scope profilerScope(frameProfiler,FrameProfiler::INPUTGRAPH);
 	inputGraphManager->update();
+	}
 	
 	/* Update the tool manager: */
+	{
+	FrameProfiler::Scope profilerScope(frameProfiler,FrameProfiler::TOOLS);
 	toolManager->update();
+	}
 	
 	/* Check if a new input graph needs to be loaded: */
 	if(loadInputGraph)
@@ -1333,6 +1399,9 @@ void VruiState::update(void)
 	for(int i=0;i<numListeners;++i)
 		listeners[i].update();
 	
+	/* Start timing the frame functions: */
+	FrameProfiler::Scope profilerScope(frameProfiler,FrameProfiler::FRAME);
+	
 	/* Call frame functions of all loaded vislets: */
 	if(visletManager!=0)
 		visletManager->frame();
@@ -1568,6 +1637,19 @@ void VruiState::finishMainLoop(void)
 	
 	/* Deregister the popup callback: */
 	widgetManager->getWidgetPopCallbacks().remove(this,&VruiState::widgetPopCallback);
+	
+	if(frameProfiler!=0)
+		{
+		/* Write all recorded frames to the trace file: */
+		try
+			{
+			frameProfiler->writeTrace();
+			}
+		catch(std::runtime_error err)
+			{
+			Misc::formattedConsoleError("Vrui::finishMainLoop: Could not write frame profiler trace due to exception %s",err.what());
+			}
+		}
 	}
 
 void VruiState::dialogsMenuCallback(GLMotif::Button::SelectCallbackData* cbData,GLMotif::PopupWindow* const& dialog)
@@ -2841,6 +2923,11 @@ double getCurrentFrameTime(void)
 	return vruiState->currentFrameTime;
 	}
 
+double getMotionToPhotonLatency(void)
+	{
+	return vruiState->lateLatcher!=0?vruiState->lateLatcher->getAverageLatency():0.0;
+	}
+
 double getNextAnimationTime(void)
 	{
 	return vruiState->lastFrame+vruiState->animationFrameInterval;
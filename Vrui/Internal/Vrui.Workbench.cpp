@@ -79,6 +79,8 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Vrui/Internal/Vrui.h>
 #include <Vrui/Internal/Config.h>
+#include <Vrui/Internal/FrameProfiler.h>
+#include <Vrui/Internal/LateLatcher.h>
 
 #define VRUI_INSTRUMENT_MAINLOOP 0
 #if VRUI_INSTRUMENT_MAINLOOP
@@ -349,7 +351,14 @@ void vruiOpenConfigurationFile(const char* userConfigDir,const char* appPath)
 		/* Open the system-wide configuration file: */
 		if(vruiVerbose&&vruiMaster)
 			std::cout<<"Vrui: Reading system-wide configuration file "<<systemConfigFileName<<std::endl;
-		vruiConfigFile=new Misc::ConfigurationFile(systemConfigFileName.c_str());
+		vruiConfigFile=new Misc::ConfigurationFile;
+		
+		/* Cache compiled configuration files if requested: */
+		const char* configCacheDir=getenv("VRUI_CONFIGCACHEDIR");
+		if(configCacheDir!=0&&configCacheDir[0]!='\0')
+			vruiConfigFile->setCacheDirectory(configCacheDir);
+		
+		vruiConfigFile->load(systemConfigFileName.c_str());
 		}
 	catch(std::runtime_error error)
 		{
@@ -959,10 +968,12 @@ void init(int& argc,char**& argv,char**&)
 				std::string multicastGroup=vruiConfigFile->retrieveString("./multipipeMulticastGroup");
 				int multicastPort=vruiConfigFile->retrieveValue<int>("./multipipeMulticastPort");
 				unsigned int multicastSendBufferSize=vruiConfigFile->retrieveValue<unsigned int>("./multipipeSendBufferSize",16);
+				unsigned int multicastMTUSize=vruiConfigFile->retrieveValue<unsigned int>("./multipipeMTUSize",CLUSTER_CONFIG_MTU_SIZE);
 				
 				/* Create the multicast multiplexer: */
 				vruiMultiplexer=new Cluster::Multiplexer(vruiNumSlaves,0,master.c_str(),masterPort,multicastGroup.c_str(),multicastPort);
 				vruiMultiplexer->setSendBufferSize(multicastSendBufferSize);
+				vruiMultiplexer->setMTUSize(multicastMTUSize);
 				
 				/* Determine the fully-qualified name of this process's executable: */
 				char exeName[PATH_MAX];
@@ -1551,6 +1562,16 @@ void startDisplay(void)
 		/* Tell the window its own index in the cluster-wide list: */
 		vruiWindows[i]->setWindowIndex(vruiFirstLocalWindowIndex+i);
 		}
+	
+	/* Tell the frame profiler how many windows to time: */
+	if(vruiState->frameProfiler!=0)
+		vruiState->frameProfiler->setNumWindows(vruiTotalNumWindows);
+	
+	#if GLSUPPORT_CONFIG_USE_TLS
+	/* Windows drawn by separate rendering threads can not be re-sampled individually: */
+	if(vruiState->lateLatcher!=0&&vruiNumWindowGroups>1)
+		vruiState->lateLatcher->disableWindowMode();
+	#endif
 	}
 
 void startSound(void)
@@ -1747,13 +1768,50 @@ bool vruiHandleAllEvents(bool allowBlocking,bool checkStdin)
 	return handledEvents;
 	}
 
+void vruiSynchronizeNodes(void)
+	{
+	FrameProfiler* profiler=vruiState->frameProfiler;
+	FrameProfiler::Scope profilerScope(profiler,FrameProfiler::BARRIER);
+	if(vruiState->exchangeRenderTimes)
+		{
+		/* Exchange this node's render time with all other nodes; this implies a barrier: */
+		if(profiler!=0)
+			{
+			float renderTime=float(profiler->getPhaseTime(FrameProfiler::DRAW)+profiler->getPhaseTime(FrameProfiler::FINISH));
+			vruiState->pipe->allGather(renderTime,profiler->getNodeRenderTimes());
+			}
+		else
+			vruiState->pipe->allGather(0.0f,vruiState->nodeRenderTimes);
+		}
+	else
+		vruiState->pipe->barrier();
+	}
+
+void vruiFinishAndSynchronize(void)
+	{
+	/* Wait until OpenGL has finished rendering: */
+	{
+	FrameProfiler::Scope profilerScope(vruiState->frameProfiler,FrameProfiler::FINISH);
+	glFinish();
+	}
+	
+	/* Wait until all other nodes have finished rendering: */
+	vruiSynchronizeNodes();
+	}
+
 void vruiInnerLoopMultiWindow(void)
 	{
 	bool keepRunning=true;
 	bool firstFrame=true;
 	while(keepRunning)
 		{
+		/* Start a new profiled frame: */
+		if(vruiState->frameProfiler!=0)
+			vruiState->frameProfiler->startFrame();
+		
 		/* Handle all events, blocking if there are none unless in continuous mode: */
+		{
+		FrameProfiler::Scope profilerScope(vruiState->frameProfiler,FrameProfiler::EVENTS);
 		if(firstFrame||vruiState->updateContinuously)
 			{
 			/* Check for and handle events without blocking: */
@@ -1765,6 +1823,7 @@ void vruiInnerLoopMultiWindow(void)
 			while(!vruiHandleAllEvents(true,vruiNumWindows==0&&vruiState->master))
 				;
 			}
+		}
 		
 		/* Check for asynchronous shutdown: */
 		keepRunning=keepRunning&&!vruiAsynchronousShutdown;
@@ -1789,13 +1848,20 @@ void vruiInnerLoopMultiWindow(void)
 		
 		#if ALSUPPORT_CONFIG_HAVE_OPENAL
 		/* Update all sound contexts: */
+		{
+		FrameProfiler::Scope profilerScope(vruiState->frameProfiler,FrameProfiler::SOUND);
 		for(int i=0;i<vruiNumSoundContexts;++i)
 			vruiSoundContexts[i]->draw();
+		}
 		#endif
 		
 		/* Reset the GL thing manager: */
 		GLContextData::resetThingManager();
 		
+		/* Re-sample tracked input devices immediately before rendering: */
+		if(vruiState->lateLatcher!=0)
+			vruiState->lateLatcher->latchFrame();
+		
 		if(vruiNumWindowGroups>1)
 			{
 			#if GLSUPPORT_CONFIG_USE_TLS
@@ -1804,37 +1870,47 @@ void vruiInnerLoopMultiWindow(void)
 			vruiRenderingBarrier.synchronize();
 			
 			/* Wait until all threads are done rendering: */
+			{
+			FrameProfiler::Scope profilerScope(vruiState->frameProfiler,FrameProfiler::DRAW);
 			vruiRenderingBarrier.synchronize();
+			}
 			
 			if(vruiState->multiplexer!=0)
 				{
 				/* Synchronize with other nodes: */
-				vruiState->pipe->barrier();
+				vruiSynchronizeNodes();
 				
 				/* Notify the render threads to swap buffers: */
 				vruiRenderingBarrier.synchronize();
 				}
 			
 			/* Wait until all threads are done swapping buffers: */
+			{
+			FrameProfiler::Scope profilerScope(vruiState->frameProfiler,FrameProfiler::SWAP);
 			vruiRenderingBarrier.synchronize();
+			}
 			
 			#else
 			
 			/* Render to all window groups in turn: */
+			{
+			FrameProfiler::Scope profilerScope(vruiState->frameProfiler,FrameProfiler::DRAW);
 			for(int i=0;i<vruiNumWindowGroups;++i)
 				{
 				for(std::vector<VruiWindowGroup::Window>::iterator wgIt=vruiWindowGroups[i].windows.begin();wgIt!=vruiWindowGroups[i].windows.end();++wgIt)
 					wgIt->window->draw();
 				}
+			}
 			
 			if(vruiState->multiplexer!=0)
 				{
 				/* Synchronize with other nodes: */
-				glFinish();
-				vruiState->pipe->barrier();
+				vruiFinishAndSynchronize();
 				}
 			
 			/* Swap all buffers at once: */
+			{
+			FrameProfiler::Scope profilerScope(vruiState->frameProfiler,FrameProfiler::SWAP);
 			for(int i=0;i<vruiNumWindowGroups;++i)
 				{
 				for(std::vector<VruiWindowGroup::Window>::iterator wgIt=vruiWindowGroups[i].windows.begin();wgIt!=vruiWindowGroups[i].windows.end();++wgIt)
@@ -1843,35 +1919,45 @@ void vruiInnerLoopMultiWindow(void)
 					wgIt->window->swapBuffers();
 					}
 				}
+			}
 			
 			#endif
 			}
 		else if(vruiNumWindows>0)
 			{
 			/* Update rendering: */
+			{
+			FrameProfiler::Scope profilerScope(vruiState->frameProfiler,FrameProfiler::DRAW);
 			for(int i=0;i<vruiNumWindows;++i)
 				vruiWindows[i]->draw();
+			}
 			
 			if(vruiState->multiplexer!=0)
 				{
 				/* Synchronize with other nodes: */
-				glFinish();
-				vruiState->pipe->barrier();
+				vruiFinishAndSynchronize();
 				}
 			
 			/* Swap all buffers at once: */
+			{
+			FrameProfiler::Scope profilerScope(vruiState->frameProfiler,FrameProfiler::SWAP);
 			for(int i=0;i<vruiNumWindows;++i)
 				{
 				vruiWindows[i]->makeCurrent();
 				vruiWindows[i]->swapBuffers();
 				}
 			}
+			}
 		else if(vruiState->multiplexer!=0)
 			{
 			/* Synchronize with other nodes: */
-			vruiState->pipe->barrier();
+			vruiSynchronizeNodes();
 			}
 		
+		/* Finish measuring the frame's motion-to-photon latency: */
+		if(vruiState->lateLatcher!=0)
+			vruiState->lateLatcher->frameSwapped();
+		
 		/* Print current frame rate on head node's console for window-less Vrui processes: */
 		if(vruiNumWindows==0&&vruiState->master)
 			{
@@ -1899,6 +1985,10 @@ void vruiInnerLoopSingleWindow(void)
 	bool firstFrame=true;
 	while(true)
 		{
+		/* Start a new profiled frame: */
+		if(vruiState->frameProfiler!=0)
+			vruiState->frameProfiler->startFrame();
+		
 		#if VRUI_INSTRUMENT_MAINLOOP
 		{
 		Realtime::TimePointMonotonic now;
@@ -1907,6 +1997,8 @@ void vruiInnerLoopSingleWindow(void)
 		#endif
 		
 		/* Handle all events, blocking if there are none unless in continuous mode: */
+		{
+		FrameProfiler::Scope profilerScope(vruiState->frameProfiler,FrameProfiler::EVENTS);
 		if(firstFrame||vruiState->updateContinuously)
 			{
 			/* Check for and handle events without blocking: */
@@ -1918,6 +2010,7 @@ void vruiInnerLoopSingleWindow(void)
 			while(!vruiHandleAllEvents(true,false))
 				;
 			}
+		}
 		
 		/* Check for asynchronous shutdown: */
 		keepRunning=keepRunning&&!vruiAsynchronousShutdown;
@@ -1942,8 +2035,11 @@ void vruiInnerLoopSingleWindow(void)
 		
 		#if ALSUPPORT_CONFIG_HAVE_OPENAL
 		/* Update all sound contexts: */
+		{
+		FrameProfiler::Scope profilerScope(vruiState->frameProfiler,FrameProfiler::SOUND);
 		for(int i=0;i<vruiNumSoundContexts;++i)
 			vruiSoundContexts[i]->draw();
+		}
 		#endif
 		
 		#if VRUI_INSTRUMENT_MAINLOOP
@@ -1956,14 +2052,20 @@ void vruiInnerLoopSingleWindow(void)
 		/* Reset the GL thing manager: */
 		GLContextData::resetThingManager();
 		
+		/* Re-sample tracked input devices immediately before rendering: */
+		if(vruiState->lateLatcher!=0)
+			vruiState->lateLatcher->latchFrame();
+		
 		/* Update rendering: */
+		{
+		FrameProfiler::Scope profilerScope(vruiState->frameProfiler,FrameProfiler::DRAW);
 		vruiWindows[0]->draw();
+		}
 		
 		if(vruiState->multiplexer!=0)
 			{
 			/* Synchronize with other nodes: */
-			glFinish();
-			vruiState->pipe->barrier();
+			vruiFinishAndSynchronize();
 			}
 		
 		#if VRUI_INSTRUMENT_MAINLOOP
@@ -1974,7 +2076,14 @@ void vruiInnerLoopSingleWindow(void)
 		#endif
 		
 		/* Swap buffer: */
+		{
+		FrameProfiler::Scope profilerScope(vruiState->frameProfiler,FrameProfiler::SWAP);
 		vruiWindows[0]->swapBuffers();
+		}
+		
+		/* Finish measuring the frame's motion-to-photon latency: */
+		if(vruiState->lateLatcher!=0)
+			vruiState->lateLatcher->frameSwapped();
 		
 		#if VRUI_INSTRUMENT_MAINLOOP
 		{
@@ -68,6 +68,8 @@ class CascadeButton;
 namespace Vrui {
 class InputDeviceDataSaver;
 class MultipipeDispatcher;
+class FrameProfiler;
+class LateLatcher;
 class ScaleBar;
 class VisletManager;
 class GUIInteractor;
@@ -270,6 +272,9 @@ struct VruiState
 	double animationFrameInterval; // Suggested frame interval to be used for animations
 	Threads::Mutex frameCallbacksMutex; // Mutex protecting the list of extra frame callbacks
 	std::vector<FrameCallbackSlot> frameCallbacks; // List of extra frame callbacks
+	FrameProfiler* frameProfiler; // Profiler recording the time spent in each main loop phase, or null if profiling is disabled
+	bool exchangeRenderTimes; // Flag whether cluster nodes exchange their render times during the frame barrier; decided by the master node to keep all nodes' synchronization protocols identical
+	float* nodeRenderTimes; // Array receiving all nodes' render times on cluster nodes that take part in the exchange without profiling themselves
 	
 	/* Transient dragging/moving/scaling state: */
 	const Tool* activeNavigationTool;
@@ -284,6 +289,7 @@ struct VruiState
 	unsigned int numVsyncs; // Number of vsyncs that have already elapsed
 	Realtime::TimePointMonotonic nextVsync; // Time at which the next vsync is predicted to occur
 	Realtime::TimeVector postVsyncDisplayDelay; // Delay from vsync to the synched display showing the new image
+	LateLatcher* lateLatcher; // Object re-sampling tracked input devices immediately before rendering, or null if disabled
 	
 	/* Private methods: */
 	GLMotif::PopupMenu* buildDialogsMenu(void); // Builds the dialogs submenu
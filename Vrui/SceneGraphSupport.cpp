@@ -57,7 +57,7 @@ SceneGraph::GLRenderState* createRenderState(const NavTransform& transform,bool
 	return new SceneGraph::GLRenderState(contextData,initial,mvp.transform(getMainViewer()->getHeadPosition()),mvp.transform(getUpDirection()));
 	}
 
-void renderSceneGraph(const SceneGraph::GraphNode* root,bool navigational,GLContextData& contextData)
+SceneGraph::GLRenderState::NodeCounters renderSceneGraph(const SceneGraph::GraphNode* root,bool navigational,GLContextData& contextData)
 	{
 	/* Save the current modelview matrix: */
 	glPushMatrix();
@@ -76,9 +76,11 @@ void renderSceneGraph(const SceneGraph::GraphNode* root,bool navigational,GLCont
 	
 	/* Restore the original modelview matrix: */
 	glPopMatrix();
+	
+	return renderState.getNodeCounters();
 	}
 
-void renderSceneGraph(const SceneGraph::GraphNode* root,const NavTransform& transform,bool navigational,GLContextData& contextData)
+SceneGraph::GLRenderState::NodeCounters renderSceneGraph(const SceneGraph::GraphNode* root,const NavTransform& transform,bool navigational,GLContextData& contextData)
 	{
 	/* Save the current modelview matrix: */
 	glPushMatrix();
@@ -99,6 +101,8 @@ void renderSceneGraph(const SceneGraph::GraphNode* root,const NavTransform& tran
 	
 	/* Restore the original modelview matrix: */
 	glPopMatrix();
+	
+	return renderState.getNodeCounters();
 	}
 
 }
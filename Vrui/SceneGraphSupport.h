@@ -24,12 +24,12 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_SCENEGRAPHSUPPORT_INCLUDED
 #define VRUI_SCENEGRAPHSUPPORT_INCLUDED
 
+#include <SceneGraph/GLRenderState.h>
 #include <Vrui/Geometry.h>
 
 /* Forward declarations: */
 class GLContextData;
 namespace SceneGraph {
-class GLRenderState;
 class GraphNode;
 }
 
@@ -40,10 +40,10 @@ namespace Vrui {
 SceneGraph::GLRenderState* createRenderState(bool navigational,GLContextData& contextData); // Creates a scene graph render state starting in physical or navigational coordinates
 SceneGraph::GLRenderState* createRenderState(const NavTransform& transform,bool navigational,GLContextData& contextData); // Creates a scene graph render state starting with the given transformation relative to physical or navigational coordinates
 
-/* These functions render the given scene graph: */
+/* These functions render the given scene graph and return the numbers of visited, frustum-culled, and drawn nodes during this call: */
 
-void renderSceneGraph(const SceneGraph::GraphNode* root,bool navigational,GLContextData& contextData); // Renders the given scene graph in physical or navigational coordinates
-void renderSceneGraph(const SceneGraph::GraphNode* root,const NavTransform& transform,bool navigational,GLContextData& contextData); // Renders the given scene graph with the given transformation relative to physical or navigational coordinates
+SceneGraph::GLRenderState::NodeCounters renderSceneGraph(const SceneGraph::GraphNode* root,bool navigational,GLContextData& contextData); // Renders the given scene graph in physical or navigational coordinates
+SceneGraph::GLRenderState::NodeCounters renderSceneGraph(const SceneGraph::GraphNode* root,const NavTransform& transform,bool navigational,GLContextData& contextData); // Renders the given scene graph with the given transformation relative to physical or navigational coordinates
 
 }
 
@@ -0,0 +1,181 @@
+/***********************************************************************
+ClusterLatencyBenchmark - Program to measure the latency of barrier,
+gather, and all-gather rounds on a cluster pipe between a master and a
+slave multiplexer over the loopback interface.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdexcept>
+#include <Misc/Timer.h>
+#include <Cluster/Multiplexer.h>
+#include <Cluster/MulticastPipe.h>
+
+/****************
+Helper functions:
+****************/
+
+enum Operation // Enumerated type for timed cluster pipe operations
+	{
+	BARRIER,GATHER,VECTORGATHER,ALLGATHER,ALLGATHERBLOCK,NUM_OPERATIONS
+	};
+
+const char* operationNames[NUM_OPERATIONS]=
+	{
+	"barrier","gather(unsigned int)","gather(100 doubles)","allGather(float)","allGather(512 bytes)"
+	};
+
+void runOperation(Cluster::MulticastPipe& pipe,int operation,int numRounds)
+	{
+	double values[100];
+	float times[2];
+	char block[512];
+	char blocks[2*512];
+	for(int i=0;i<100;++i)
+		values[i]=double(i);
+	memset(block,pipe.getNodeIndex(),sizeof(block));
+	
+	for(int round=0;round<numRounds;++round)
+		{
+		switch(operation)
+			{
+			case BARRIER:
+				pipe.barrier();
+				break;
+			
+			case GATHER:
+				pipe.gather((unsigned int)(round),Cluster::GatherOperation::MAX);
+				break;
+			
+			case VECTORGATHER:
+				pipe.gather(values,100,Cluster::GatherOperation::MAX);
+				break;
+			
+			case ALLGATHER:
+				pipe.allGather(float(round),times);
+				break;
+			
+			case ALLGATHERBLOCK:
+				pipe.allGather(block,sizeof(block),blocks);
+				break;
+			}
+		}
+	}
+
+int runSlave(int masterPort,int slavePort,int numRounds)
+	{
+	try
+		{
+		/* Connect to the master over the loopback interface: */
+		Cluster::Multiplexer multiplexer(1,1,"localhost",masterPort,"127.0.0.1",slavePort);
+		multiplexer.waitForConnection();
+		Cluster::MulticastPipe pipe(&multiplexer);
+		
+		/* Take part in all rounds, including the warm-up rounds: */
+		for(int operation=0;operation<NUM_OPERATIONS;++operation)
+			{
+			runOperation(pipe,operation,numRounds/10+1);
+			runOperation(pipe,operation,numRounds);
+			}
+		}
+	catch(const std::runtime_error& err)
+		{
+		fprintf(stderr,"Slave: Caught exception %s\n",err.what());
+		return 1;
+		}
+	
+	return 0;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int masterPort=26100;
+	int numRounds=10000;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-port")==0&&i+1<argc)
+			masterPort=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-rounds")==0&&i+1<argc)
+			numRounds=atoi(argv[++i]);
+		else
+			{
+			fprintf(stderr,"Usage: %s [-port <first UDP port number>] [-rounds <number of rounds per operation>]\n",argv[0]);
+			return 1;
+			}
+		}
+	if(masterPort<=0||numRounds<1)
+		{
+		fprintf(stderr,"%s: Invalid benchmark parameters\n",argv[0]);
+		return 1;
+		}
+	int slavePort=masterPort+1;
+	
+	/* Start the slave in a separate process: */
+	pid_t childPid=fork();
+	if(childPid==0)
+		_exit(runSlave(masterPort,slavePort,numRounds));
+	else if(childPid<0)
+		{
+		fprintf(stderr,"%s: Unable to start slave process\n",argv[0]);
+		return 1;
+		}
+	
+	int result=0;
+	try
+		{
+		/* Create the master multiplexer and wait for the slave to connect: */
+		Cluster::Multiplexer multiplexer(1,0,"localhost",masterPort,"127.0.0.1",slavePort);
+		multiplexer.waitForConnection();
+		Cluster::MulticastPipe pipe(&multiplexer);
+		
+		printf("Round latencies with one slave over loopback, %d rounds:\n",numRounds);
+		printf("Operation                 Latency\n");
+		fflush(stdout);
+		
+		for(int operation=0;operation<NUM_OPERATIONS;++operation)
+			{
+			/* Warm up, then time the operation: */
+			runOperation(pipe,operation,numRounds/10+1);
+			Misc::Timer t;
+			runOperation(pipe,operation,numRounds);
+			t.elapse();
+			printf("%-22s  %7.2f us\n",operationNames[operation],t.getTime()*1.0e6/double(numRounds));
+			fflush(stdout);
+			}
+		}
+	catch(const std::runtime_error& err)
+		{
+		fprintf(stderr,"Master: Caught exception %s\n",err.what());
+		result=1;
+		}
+	
+	int status=0;
+	waitpid(childPid,&status,0);
+	if(!WIFEXITED(status)||WEXITSTATUS(status)!=0)
+		result=1;
+	
+	return result;
+	}
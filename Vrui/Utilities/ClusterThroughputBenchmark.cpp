@@ -0,0 +1,189 @@
+/***********************************************************************
+ClusterThroughputBenchmark - Program to measure the throughput of a
+multicast pipe between a master and a slave multiplexer over the
+loopback interface for different MTU and batch sizes.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdexcept>
+#include <Misc/Timer.h>
+#include <Cluster/Packet.h>
+#include <Cluster/Multiplexer.h>
+#include <Cluster/MulticastPipe.h>
+
+/****************
+Helper functions:
+****************/
+
+unsigned int updateChecksum(unsigned int checksum,const unsigned char* data,size_t dataSize)
+	{
+	/* Accumulate a simple order-dependent checksum to detect lost or reordered data: */
+	for(size_t i=0;i<dataSize;++i)
+		checksum=(checksum<<5)+(checksum>>27)+data[i];
+	return checksum;
+	}
+
+int runSlave(int masterPort,int slavePort,unsigned int batchSize,size_t dataSize)
+	{
+	try
+		{
+		/* Connect to the master over the loopback interface: */
+		Cluster::Multiplexer multiplexer(1,1,"localhost",masterPort,"127.0.0.1",slavePort);
+		multiplexer.setBatchSize(batchSize);
+		multiplexer.waitForConnection();
+		Cluster::MulticastPipe pipe(&multiplexer);
+		
+		/* Receive the data stream and accumulate its checksum: */
+		unsigned char buffer[65536];
+		unsigned int checksum=0;
+		for(size_t received=0;received<dataSize;)
+			{
+			size_t chunkSize=dataSize-received;
+			if(chunkSize>sizeof(buffer))
+				chunkSize=sizeof(buffer);
+			pipe.readRaw(buffer,chunkSize);
+			checksum=updateChecksum(checksum,buffer,chunkSize);
+			received+=chunkSize;
+			}
+		
+		/* Signal the end of the transfer and send the checksum to the master: */
+		pipe.barrier();
+		pipe.gather(checksum,Cluster::GatherOperation::MIN);
+		pipe.gather(checksum,Cluster::GatherOperation::MAX);
+		}
+	catch(const std::runtime_error& err)
+		{
+		fprintf(stderr,"Slave: Caught exception %s\n",err.what());
+		return 1;
+		}
+	
+	return 0;
+	}
+
+bool runBenchmark(int masterPort,int slavePort,size_t mtuSize,unsigned int batchSize,size_t dataSize,double& throughput,size_t& packetBlockSize)
+	{
+	/* Start the slave in a separate process: */
+	pid_t childPid=fork();
+	if(childPid==0)
+		_exit(runSlave(masterPort,slavePort,batchSize,dataSize));
+	else if(childPid<0)
+		return false;
+	
+	bool result=false;
+	try
+		{
+		/* Create the master multiplexer and wait for the slave to connect: */
+		Cluster::Multiplexer multiplexer(1,0,"localhost",masterPort,"127.0.0.1",slavePort);
+		multiplexer.setMTUSize(mtuSize);
+		multiplexer.setBatchSize(batchSize);
+		multiplexer.waitForConnection();
+		Cluster::MulticastPipe pipe(&multiplexer);
+		
+		/* Report the size of the memory block backing each packet: */
+		packetBlockSize=offsetof(Cluster::Packet,packet)+multiplexer.getMaxPacketSize();
+		
+		/* Create a block of pseudo-random test data: */
+		unsigned char buffer[65536];
+		for(size_t i=0;i<sizeof(buffer);++i)
+			buffer[i]=(unsigned char)(rand());
+		
+		/* Send the data stream and wait until the slave received all of it: */
+		unsigned int checksum=0;
+		Misc::Timer t;
+		for(size_t sent=0;sent<dataSize;)
+			{
+			size_t chunkSize=dataSize-sent;
+			if(chunkSize>sizeof(buffer))
+				chunkSize=sizeof(buffer);
+			pipe.writeRaw(buffer,chunkSize);
+			checksum=updateChecksum(checksum,buffer,chunkSize);
+			sent+=chunkSize;
+			}
+		pipe.barrier();
+		t.elapse();
+		throughput=double(dataSize)/(1024.0*1024.0)/t.getTime();
+		
+		/* Compare the slave's checksum against the master's: */
+		unsigned int minChecksum=pipe.gather(checksum,Cluster::GatherOperation::MIN);
+		unsigned int maxChecksum=pipe.gather(checksum,Cluster::GatherOperation::MAX);
+		result=minChecksum==checksum&&maxChecksum==checksum;
+		}
+	catch(const std::runtime_error& err)
+		{
+		fprintf(stderr,"Master: Caught exception %s\n",err.what());
+		}
+	
+	int status=0;
+	waitpid(childPid,&status,0);
+	return result&&WIFEXITED(status)&&WEXITSTATUS(status)==0;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int portBase=26000;
+	size_t dataSize=size_t(200)*1024*1024;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-port")==0&&i+1<argc)
+			portBase=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-size")==0&&i+1<argc)
+			dataSize=size_t(atoi(argv[++i]))*1024*1024;
+		else
+			{
+			fprintf(stderr,"Usage: %s [-port <first UDP port number>] [-size <data size in MB>]\n",argv[0]);
+			return 1;
+			}
+		}
+	if(portBase<=0||dataSize==0)
+		{
+		fprintf(stderr,"%s: Invalid benchmark parameters\n",argv[0]);
+		return 1;
+		}
+	
+	printf("Multicast pipe throughput for %u MB over loopback:\n",(unsigned int)(dataSize/(1024*1024)));
+	printf(" MTU  Batch  Packet block   Throughput\n");
+	fflush(stdout);
+	
+	/* Run the benchmark for all combinations of MTU and batch sizes, using fresh port numbers for each run: */
+	static const size_t mtuSizes[]={1500,4000,9000};
+	static const unsigned int batchSizes[]={1,16};
+	int port=portBase;
+	for(int mtuIndex=0;mtuIndex<3;++mtuIndex)
+		for(int batchIndex=0;batchIndex<2;++batchIndex,port+=2)
+			{
+			double throughput=0.0;
+			size_t packetBlockSize=0;
+			if(runBenchmark(port,port+1,mtuSizes[mtuIndex],batchSizes[batchIndex],dataSize,throughput,packetBlockSize))
+				printf("%4u  %5u  %10u B  %7.1f MB/s\n",(unsigned int)mtuSizes[mtuIndex],batchSizes[batchIndex],(unsigned int)packetBlockSize,throughput);
+			else
+				printf("%4u  %5u  transfer failed\n",(unsigned int)mtuSizes[mtuIndex],batchSizes[batchIndex]);
+			fflush(stdout);
+			}
+	
+	return 0;
+	}
@@ -0,0 +1,206 @@
+/***********************************************************************
+ConfigurationFileBenchmark - Program to measure the time to load a
+configuration file from text and from the cache of compiled
+configuration files, and the time to look up tag values by path.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <ctype.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <string>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Misc/File.h>
+#include <Misc/ConfigurationFile.h>
+#include <Math/Math.h>
+
+/****************
+Helper functions:
+****************/
+
+std::string saveToString(Misc::ConfigurationFile& configFile,const char* tempFileName)
+	{
+	/* Save the configuration file and read the saved file back into a string: */
+	configFile.saveAs(tempFileName);
+	std::string result;
+	Misc::File file(tempFileName,"rt");
+	char lineBuffer[4096];
+	while(file.gets(lineBuffer,sizeof(lineBuffer))!=0)
+		result.append(lineBuffer);
+	
+	return result;
+	}
+
+void collectTagPaths(const std::string& savedFile,std::vector<std::string>& tagPaths)
+	{
+	/* Parse the normalized layout written by ConfigurationFile::saveAs: */
+	std::vector<std::string> sectionPath;
+	std::string::size_type lineStart=0;
+	while(lineStart<savedFile.size())
+		{
+		std::string::size_type lineEnd=savedFile.find('\n',lineStart);
+		if(lineEnd==std::string::npos)
+			lineEnd=savedFile.size();
+		
+		/* Skip indentation and find the first token: */
+		std::string::size_type tokenStart=lineStart;
+		while(tokenStart<lineEnd&&isspace(savedFile[tokenStart]))
+			++tokenStart;
+		std::string::size_type tokenEnd=tokenStart;
+		while(tokenEnd<lineEnd&&!isspace(savedFile[tokenEnd]))
+			++tokenEnd;
+		std::string token(savedFile,tokenStart,tokenEnd-tokenStart);
+		
+		if(token=="section")
+			sectionPath.push_back(std::string(savedFile,tokenEnd+1,lineEnd-tokenEnd-1));
+		else if(token=="endsection")
+			sectionPath.pop_back();
+		else if(!token.empty())
+			{
+			/* Assemble the tag's absolute path: */
+			std::string tagPath;
+			for(std::vector<std::string>::iterator spIt=sectionPath.begin();spIt!=sectionPath.end();++spIt)
+				{
+				tagPath.push_back('/');
+				tagPath.append(*spIt);
+				}
+			tagPath.push_back('/');
+			tagPath.append(token);
+			tagPaths.push_back(tagPath);
+			}
+		
+		lineStart=lineEnd+1;
+		}
+	}
+
+void clearCacheDirectory(const char* cacheDirectory)
+	{
+	/* Remove all files from the cache directory, and the directory itself: */
+	DIR* dir=opendir(cacheDirectory);
+	if(dir!=0)
+		{
+		struct dirent* entry;
+		while((entry=readdir(dir))!=0)
+			if(strcmp(entry->d_name,".")!=0&&strcmp(entry->d_name,"..")!=0)
+				unlink((std::string(cacheDirectory)+"/"+entry->d_name).c_str());
+		closedir(dir);
+		}
+	rmdir(cacheDirectory);
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	const char* fileName="Share/Vrui.cfg";
+	const char* cacheDirectory="ConfigurationFileBenchmark.cache";
+	int numRepeats=20;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-file")==0&&i+1<argc)
+			fileName=argv[++i];
+		else if(strcasecmp(argv[i],"-cacheDir")==0&&i+1<argc)
+			cacheDirectory=argv[++i];
+		else if(strcasecmp(argv[i],"-repeats")==0&&i+1<argc)
+			numRepeats=atoi(argv[++i]);
+		else
+			{
+			fprintf(stderr,"Usage: %s [-file <configuration file name>] [-cacheDir <temporary cache directory>] [-repeats <number of repeats>]\n",argv[0]);
+			return 1;
+			}
+		}
+	if(numRepeats<1)
+		{
+		fprintf(stderr,"%s: Invalid benchmark parameters\n",argv[0]);
+		return 1;
+		}
+	std::string tempFileName=std::string(cacheDirectory)+".cfg";
+	clearCacheDirectory(cacheDirectory);
+	
+	Misc::Timer t;
+	
+	/* Load the configuration file from text: */
+	double textLoad=1.0e30;
+	for(int repeat=0;repeat<numRepeats;++repeat)
+		{
+		t.elapse();
+		Misc::ConfigurationFile configFile(fileName);
+		t.elapse();
+		textLoad=Math::min(textLoad,t.getTime()*1.0e3);
+		}
+	Misc::ConfigurationFile textConfigFile(fileName);
+	std::string textContents=saveToString(textConfigFile,tempFileName.c_str());
+	
+	/* Load the configuration file with an empty cache, which compiles the file and writes the cache: */
+	t.elapse();
+	{
+	Misc::ConfigurationFile configFile;
+	configFile.setCacheDirectory(cacheDirectory);
+	configFile.load(fileName);
+	}
+	t.elapse();
+	double cacheMiss=t.getTime()*1.0e3;
+	
+	/* Load the configuration file from the cache: */
+	double cacheHit=1.0e30;
+	for(int repeat=0;repeat<numRepeats;++repeat)
+		{
+		t.elapse();
+		Misc::ConfigurationFile configFile;
+		configFile.setCacheDirectory(cacheDirectory);
+		configFile.load(fileName);
+		t.elapse();
+		cacheHit=Math::min(cacheHit,t.getTime()*1.0e3);
+		}
+	Misc::ConfigurationFile cachedConfigFile;
+	cachedConfigFile.setCacheDirectory(cacheDirectory);
+	cachedConfigFile.load(fileName);
+	std::string cachedContents=saveToString(cachedConfigFile,tempFileName.c_str());
+	bool valid=cachedContents==textContents;
+	
+	/* Look up every tag in the configuration file by its absolute path: */
+	std::vector<std::string> tagPaths;
+	collectTagPaths(textContents,tagPaths);
+	double lookup=1.0e30;
+	for(int repeat=0;repeat<numRepeats;++repeat)
+		{
+		t.elapse();
+		for(std::vector<std::string>::iterator tpIt=tagPaths.begin();tpIt!=tagPaths.end();++tpIt)
+			if(!textConfigFile.hasTag(tpIt->c_str()))
+				valid=false;
+		t.elapse();
+		lookup=Math::min(lookup,t.getTime()*1.0e6/double(tagPaths.size()));
+		}
+	
+	unlink(tempFileName.c_str());
+	clearCacheDirectory(cacheDirectory);
+	
+	printf("Loading %s (%u tags), best of %d:\n",fileName,(unsigned int)tagPaths.size(),numRepeats);
+	printf("Text load      %10.3f ms\n",textLoad);
+	printf("Cache miss     %10.3f ms\n",cacheMiss);
+	printf("Cache hit      %10.3f ms\n",cacheHit);
+	printf("Tag lookup     %10.3f us\n",lookup);
+	printf("Valid          %10s\n",valid?"yes":"NO");
+	
+	return valid?0:1;
+	}
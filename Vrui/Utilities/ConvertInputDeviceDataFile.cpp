@@ -0,0 +1,310 @@
+/***********************************************************************
+ConvertInputDeviceDataFile - Program to convert input device data files
+of versions 1.0 to 4.0 to the chunked and indexed version 5.0 format
+supporting seeking during playback.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <Misc/SizedTypes.h>
+#include <Misc/VarInt.h>
+#include <Misc/StringMarshaller.h>
+#include <IO/File.h>
+#include <IO/SeekableFile.h>
+#include <IO/OpenFile.h>
+#include <Geometry/Vector.h>
+#include <Vrui/Geometry.h>
+#include <Vrui/InputDevice.h>
+#include <Vrui/InputDeviceFeature.h>
+#include <Vrui/Internal/InputDeviceAdapter.h>
+#include <Vrui/Internal/InputDeviceDataChunkWriter.h>
+
+void copyTextEvents(IO::File& source,IO::File& dest) // Copies the text and text control event queues of a single frame
+	{
+	/* Copy all text events: */
+	Misc::UInt32 numTextEvents=Misc::readVarInt(source);
+	Misc::writeVarInt(numTextEvents,dest);
+	for(Misc::UInt32 i=0;i<numTextEvents;++i)
+		{
+		Misc::writeVarInt(Misc::readVarInt(source),dest);
+		Misc::UInt32 textLength=Misc::readVarInt(source);
+		Misc::writeVarInt(textLength,dest);
+		if(textLength>0)
+			{
+			std::vector<char> text(textLength);
+			source.read(&text[0],textLength);
+			dest.write(&text[0],textLength);
+			}
+		}
+	
+	/* Copy all text control events: */
+	Misc::UInt32 numTextControlEvents=Misc::readVarInt(source);
+	Misc::writeVarInt(numTextControlEvents,dest);
+	for(Misc::UInt32 i=0;i<numTextControlEvents;++i)
+		{
+		Misc::writeVarInt(Misc::readVarInt(source),dest);
+		dest.write(source.read<Misc::UInt8>());
+		dest.write(source.read<Misc::UInt8>());
+		}
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	const char* inputFileName=0;
+	const char* outputFileName=0;
+	double chunkDuration=1.0;
+	unsigned int maxChunkFrames=1024U;
+	bool compressChunks=true;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"chunkDuration")==0&&i+1<argc)
+				{
+				++i;
+				chunkDuration=atof(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"maxChunkFrames")==0&&i+1<argc)
+				{
+				++i;
+				maxChunkFrames=(unsigned int)(atoi(argv[i]));
+				}
+			else if(strcasecmp(argv[i]+1,"noCompress")==0)
+				compressChunks=false;
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else if(inputFileName==0)
+			inputFileName=argv[i];
+		else if(outputFileName==0)
+			outputFileName=argv[i];
+		else
+			std::cerr<<"Ignoring extra argument "<<argv[i]<<std::endl;
+		}
+	if(inputFileName==0||outputFileName==0)
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" <input file name> <output file name> [-chunkDuration <seconds>] [-maxChunkFrames <number of frames>] [-noCompress]"<<std::endl;
+		return 1;
+		}
+	
+	/* Open the input file: */
+	IO::SeekableFilePtr inputFile(IO::openSeekableFile(inputFileName));
+	inputFile->setEndianness(Misc::LittleEndian);
+	
+	/* Read the file header: */
+	static const char* fileHeader="Vrui Input Device Data File v5.0\n";
+	char header[34];
+	inputFile->read<char>(header,34);
+	header[33]='\0';
+	
+	int fileVersion;
+	if(strncmp(header,fileHeader,29)!=0)
+		{
+		/* Pre-versioning file version: */
+		fileVersion=1;
+		
+		/* Old file format doesn't have the header text: */
+		inputFile->setReadPosAbs(0);
+		}
+	else if(strcmp(header+29,"2.0\n")==0)
+		fileVersion=2;
+	else if(strcmp(header+29,"3.0\n")==0)
+		fileVersion=3;
+	else if(strcmp(header+29,"4.0\n")==0)
+		fileVersion=4;
+	else
+		{
+		header[32]='\0';
+		std::cerr<<"Cannot convert input device data file version "<<header+29<<std::endl;
+		return 1;
+		}
+	
+	/* Open the output file and write the file header: */
+	IO::SeekableFilePtr outputFile(IO::openSeekableFile(outputFileName,IO::File::WriteOnly));
+	outputFile->setEndianness(Misc::LittleEndian);
+	outputFile->write<char>(fileHeader,34);
+	
+	/* Copy the random seed value: */
+	outputFile->write<unsigned int>(inputFile->read<unsigned int>());
+	
+	/* Read and write the device layouts and feature names: */
+	int numInputDevices=inputFile->read<int>();
+	outputFile->write<int>(numInputDevices);
+	std::vector<Vrui::InputDevice*> inputDevices;
+	for(int i=0;i<numInputDevices;++i)
+		{
+		/* Read device's name and layout from file: */
+		std::string name;
+		if(fileVersion>=2)
+			name=Misc::readCppString(*inputFile);
+		else
+			{
+			/* Read a fixed-size string: */
+			char nameBuffer[40];
+			inputFile->read(nameBuffer,sizeof(nameBuffer));
+			name=nameBuffer;
+			}
+		int trackType=inputFile->read<int>();
+		int numButtons=inputFile->read<int>();
+		int numValuators=inputFile->read<int>();
+		
+		/* Create a new input device: */
+		Vrui::InputDevice* newDevice=new Vrui::InputDevice;
+		newDevice->set(name.c_str(),trackType,numButtons,numValuators);
+		if(fileVersion<3)
+			{
+			/* Read the device ray direction: */
+			Vrui::Vector deviceRayDir;
+			inputFile->read(deviceRayDir.getComponents(),3);
+			newDevice->setDeviceRay(deviceRayDir,Vrui::Scalar(0));
+			}
+		inputDevices.push_back(newDevice);
+		
+		/* Write the device's name and layout: */
+		Misc::writeCString(name.c_str(),*outputFile);
+		outputFile->write<int>(trackType);
+		outputFile->write<int>(numButtons);
+		outputFile->write<int>(numValuators);
+		
+		/* Copy or create the device's feature names: */
+		for(int j=0;j<newDevice->getNumFeatures();++j)
+			{
+			if(fileVersion>=2)
+				Misc::writeCppString(Misc::readCppString(*inputFile),*outputFile);
+			else
+				Misc::writeCppString(Vrui::InputDeviceAdapter::getDefaultFeatureName(Vrui::InputDeviceFeature(newDevice,j)),*outputFile);
+			}
+		}
+	
+	/* Convert all data frames: */
+	Vrui::InputDeviceDataChunkWriter chunkWriter(outputFile,chunkDuration,maxChunkFrames,compressChunks);
+	size_t numFrames=0;
+	while(true)
+		{
+		/* Read the next time stamp: */
+		double timeStamp;
+		try
+			{
+			timeStamp=inputFile->read<double>();
+			}
+		catch(IO::File::ReadError)
+			{
+			/* At end of file */
+			break;
+			}
+		IO::File& frame=chunkWriter.startFrame(timeStamp);
+		
+		for(std::vector<Vrui::InputDevice*>::iterator idIt=inputDevices.begin();idIt!=inputDevices.end();++idIt)
+			{
+			Vrui::InputDevice* device=*idIt;
+			
+			/* Convert the device's tracker state: */
+			if(device->getTrackType()!=Vrui::InputDevice::TRACK_NONE)
+				{
+				Vrui::Vector deviceRayDir=device->getDeviceRayDirection();
+				Vrui::Scalar deviceRayStart=device->getDeviceRayStart();
+				if(fileVersion>=3)
+					{
+					inputFile->read(deviceRayDir.getComponents(),3);
+					deviceRayStart=inputFile->read<Vrui::Scalar>();
+					}
+				Vrui::TrackerState::Vector translation;
+				inputFile->read(translation.getComponents(),3);
+				Vrui::Scalar quat[4];
+				inputFile->read(quat,4);
+				Vrui::Vector linearVelocity=Vrui::Vector::zero;
+				Vrui::Vector angularVelocity=Vrui::Vector::zero;
+				if(fileVersion>=3)
+					{
+					inputFile->read(linearVelocity.getComponents(),3);
+					inputFile->read(angularVelocity.getComponents(),3);
+					}
+				
+				frame.write(deviceRayDir.getComponents(),3);
+				frame.write(deviceRayStart);
+				frame.write(translation.getComponents(),3);
+				frame.write(quat,4);
+				frame.write(linearVelocity.getComponents(),3);
+				frame.write(angularVelocity.getComponents(),3);
+				}
+			
+			/* Convert the device's button states: */
+			if(fileVersion>=3)
+				{
+				/* Copy the 8-bit bit masks: */
+				for(int i=0;i<device->getNumButtons();i+=8)
+					frame.write(inputFile->read<unsigned char>());
+				}
+			else
+				{
+				/* Pack the 32-bit integers into 8-bit bit masks: */
+				unsigned char buttonBits=0x00U;
+				int numBits=0;
+				for(int i=0;i<device->getNumButtons();++i)
+					{
+					buttonBits<<=1;
+					if(inputFile->read<int>()!=0)
+						buttonBits|=0x01U;
+					if(++numBits==8)
+						{
+						frame.write(buttonBits);
+						buttonBits=0x00U;
+						numBits=0;
+						}
+					}
+				if(numBits!=0)
+					{
+					buttonBits<<=8-numBits;
+					frame.write(buttonBits);
+					}
+				}
+			
+			/* Copy the device's valuator states: */
+			for(int i=0;i<device->getNumValuators();++i)
+				frame.write(inputFile->read<double>());
+			}
+		
+		/* Copy or create the frame's text and text control events: */
+		if(fileVersion>=4)
+			copyTextEvents(*inputFile,frame);
+		else
+			{
+			Misc::writeVarInt(Misc::UInt32(0),frame);
+			Misc::writeVarInt(Misc::UInt32(0),frame);
+			}
+		
+		++numFrames;
+		}
+	
+	/* Write the last chunk and the chunk index: */
+	chunkWriter.finish();
+	std::cout<<"Converted "<<numFrames<<" frames from version "<<fileVersion<<".0 to version 5.0"<<std::endl;
+	
+	/* Clean up: */
+	for(std::vector<Vrui::InputDevice*>::iterator idIt=inputDevices.begin();idIt!=inputDevices.end();++idIt)
+		delete *idIt;
+	
+	return 0;
+	}
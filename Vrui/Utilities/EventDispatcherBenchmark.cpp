@@ -0,0 +1,240 @@
+/***********************************************************************
+EventDispatcherBenchmark - Program to measure the event dispatch latency
+of Threads::EventDispatcher with increasing numbers of idle listeners,
+compared to a dispatch loop based on select().
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/select.h>
+#include <sys/resource.h>
+#include <sys/eventfd.h>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Threads/Config.h>
+#include <Threads/EventDispatcher.h>
+
+/**************
+Helper classes:
+**************/
+
+class SelectDispatcher // Class for dispatch loops that rebuild descriptor sets and call select() on every iteration
+	{
+	/* Embedded classes: */
+	private:
+	struct Listener // Structure representing a read event listener
+		{
+		/* Elements: */
+		public:
+		int fd; // File descriptor to watch
+		Threads::EventDispatcher::IOEventCallback callback; // Function called when the descriptor becomes readable
+		void* callbackUserData; // Opaque pointer passed to the callback function
+		};
+	
+	/* Elements: */
+	std::vector<Listener> listeners; // List of registered listeners
+	
+	/* Methods: */
+	public:
+	void addListener(int fd,Threads::EventDispatcher::IOEventCallback callback,void* callbackUserData) // Adds a read event listener
+		{
+		Listener l;
+		l.fd=fd;
+		l.callback=callback;
+		l.callbackUserData=callbackUserData;
+		listeners.push_back(l);
+		}
+	void dispatchNextEvent(void) // Waits for the next event and dispatches it
+		{
+		/* Rebuild the descriptor set: */
+		fd_set readFds;
+		FD_ZERO(&readFds);
+		int maxFd=-1;
+		for(std::vector<Listener>::iterator lIt=listeners.begin();lIt!=listeners.end();++lIt)
+			{
+			FD_SET(lIt->fd,&readFds);
+			if(maxFd<lIt->fd)
+				maxFd=lIt->fd;
+			}
+		
+		/* Wait for events and call the callbacks of all ready listeners: */
+		if(select(maxFd+1,&readFds,0,0,0)>0)
+			for(std::vector<Listener>::iterator lIt=listeners.begin();lIt!=listeners.end();++lIt)
+				if(FD_ISSET(lIt->fd,&readFds))
+					lIt->callback(0,Threads::EventDispatcher::Read,lIt->callbackUserData);
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+size_t numEvents=0; // Number of events handled by callbacks
+
+bool readCallback(Threads::EventDispatcher::ListenerKey eventKey,int eventType,void* userData)
+	{
+	/* Consume the event: */
+	eventfd_t value;
+	if(eventfd_read(*static_cast<int*>(userData),&value)==0)
+		++numEvents;
+	return false;
+	}
+
+template <class DispatcherParam>
+double timeDispatch(DispatcherParam& dispatcher,const std::vector<int>& fds,const std::vector<size_t>& eventSequence,int numRepeats)
+	{
+	/* Signal random listeners one at a time, and report the fastest of all repeats: */
+	double result=1.0e30;
+	size_t numDispatches=eventSequence.size();
+	Misc::Timer t;
+	for(int repeat=0;repeat<numRepeats;++repeat)
+		{
+		t.elapse();
+		for(size_t i=0;i<numDispatches;++i)
+			{
+			eventfd_write(fds[eventSequence[i]],1);
+			dispatcher.dispatchNextEvent();
+			}
+		t.elapse();
+		result=Math::min(result,t.getTime()*1.0e6/double(numDispatches));
+		}
+	
+	return result;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	size_t numDispatches=100000;
+	int numRepeats=5;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-dispatches")==0&&i+1<argc)
+			numDispatches=size_t(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-repeats")==0&&i+1<argc)
+			numRepeats=atoi(argv[++i]);
+		else
+			{
+			fprintf(stderr,"Usage: %s [-dispatches <number of dispatches>] [-repeats <number of repeats>]\n",argv[0]);
+			return 1;
+			}
+		}
+	if(numDispatches<1||numRepeats<1)
+		{
+		fprintf(stderr,"%s: Invalid benchmark parameters\n",argv[0]);
+		return 1;
+		}
+	
+	/* Raise the open file limit to accommodate the largest number of listeners: */
+	struct rlimit fileLimit;
+	if(getrlimit(RLIMIT_NOFILE,&fileLimit)==0&&fileLimit.rlim_cur<fileLimit.rlim_max)
+		{
+		fileLimit.rlim_cur=fileLimit.rlim_max;
+		setrlimit(RLIMIT_NOFILE,&fileLimit);
+		}
+	
+	printf("EventDispatcher backend: %s\n",THREADS_CONFIG_HAVE_EPOLL?"epoll":"select");
+	printf("Times per dispatched event in us:\n");
+	printf("Listeners  EventDispatcher     select\n");
+	fflush(stdout);
+	
+	srand(1);
+	size_t expectedNumEvents=0;
+	static const size_t listenerCounts[]={10,100,1000};
+	for(int test=0;test<3;++test)
+		{
+		size_t numListeners=listenerCounts[test];
+		
+		/* Create one event file descriptor per listener: */
+		std::vector<int> fds;
+		for(size_t i=0;i<numListeners;++i)
+			{
+			int fd=eventfd(0,EFD_NONBLOCK);
+			if(fd<0)
+				break;
+			fds.push_back(fd);
+			}
+		if(fds.size()<numListeners)
+			{
+			fprintf(stderr,"%s: Unable to create %u event file descriptors\n",argv[0],(unsigned int)(numListeners));
+			for(std::vector<int>::iterator fIt=fds.begin();fIt!=fds.end();++fIt)
+				close(*fIt);
+			return 1;
+			}
+		
+		/* Create a random event sequence: */
+		std::vector<size_t> eventSequence(numDispatches);
+		for(size_t i=0;i<numDispatches;++i)
+			eventSequence[i]=size_t(rand())%numListeners;
+		
+		/* Time the event dispatcher: */
+		double dispatcherTime;
+		{
+		Threads::EventDispatcher dispatcher;
+		for(size_t i=0;i<numListeners;++i)
+			dispatcher.addIOEventListener(fds[i],Threads::EventDispatcher::Read,readCallback,&fds[i]);
+		
+		/* Let the dispatcher process its pending listener registrations, which are handled in order, until the last listener receives an event: */
+		size_t numPreviousEvents=numEvents;
+		eventfd_write(fds.back(),1);
+		while(numEvents==numPreviousEvents)
+			dispatcher.dispatchNextEvent();
+		expectedNumEvents+=1;
+		
+		dispatcherTime=timeDispatch(dispatcher,fds,eventSequence,numRepeats);
+		expectedNumEvents+=numDispatches*size_t(numRepeats);
+		}
+		
+		/* Time the select() loop if all descriptors fit into a descriptor set: */
+		bool fitsFdSet=true;
+		for(std::vector<int>::iterator fIt=fds.begin();fIt!=fds.end();++fIt)
+			fitsFdSet=fitsFdSet&&*fIt<FD_SETSIZE;
+		if(fitsFdSet)
+			{
+			SelectDispatcher selectDispatcher;
+			for(size_t i=0;i<numListeners;++i)
+				selectDispatcher.addListener(fds[i],readCallback,&fds[i]);
+			double selectTime=timeDispatch(selectDispatcher,fds,eventSequence,numRepeats);
+			expectedNumEvents+=numDispatches*size_t(numRepeats);
+			printf("%9u  %15.3f  %9.3f\n",(unsigned int)(numListeners),dispatcherTime,selectTime);
+			}
+		else
+			printf("%9u  %15.3f  %9s\n",(unsigned int)(numListeners),dispatcherTime,"n/a");
+		fflush(stdout);
+		
+		for(std::vector<int>::iterator fIt=fds.begin();fIt!=fds.end();++fIt)
+			close(*fIt);
+		}
+	
+	/* Check that every event was handled exactly once: */
+	if(numEvents!=expectedNumEvents)
+		{
+		printf("Error: %u of %u events were handled\n",(unsigned int)(numEvents),(unsigned int)(expectedNumEvents));
+		return 1;
+		}
+	
+	return 0;
+	}
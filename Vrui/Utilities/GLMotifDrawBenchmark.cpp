@@ -0,0 +1,234 @@
+/***********************************************************************
+GLMotifDrawBenchmark - Vrui application to measure the frame time of
+rendering large GLMotif widget trees with and without the widget
+manager's render cache.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
+#include <Math/Math.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <GLMotif/StyleSheet.h>
+#include <GLMotif/WidgetManager.h>
+#include <GLMotif/PopupWindow.h>
+#include <GLMotif/RowColumn.h>
+#include <GLMotif/Label.h>
+#include <GLMotif/Button.h>
+#include <GLMotif/ToggleButton.h>
+#include <GLMotif/TextFieldSlider.h>
+#include <GLMotif/ListBox.h>
+#include <Vrui/Vrui.h>
+#include <Vrui/Application.h>
+
+class GLMotifDrawBenchmark:public Vrui::Application
+	{
+	/* Elements: */
+	private:
+	std::vector<GLMotif::PopupWindow*> dialogs; // List of benchmarked dialog windows
+	std::vector<GLMotif::TextFieldSlider*> sliders; // List of sliders changed every frame in animation mode
+	bool animate; // Flag whether to change slider values every frame to measure cache invalidation costs
+	int numWarmupFrames; // Number of frames to render before each measurement phase
+	int numFrames; // Number of measured frames per measurement phase
+	int phase; // Index of the current measurement phase; 0: uncached, 1: cached
+	int frameIndex; // Index of the current frame in the current phase, including warm-up frames
+	std::vector<double> frameTimes; // Measured frame times of the current phase in seconds
+	
+	/* Private methods: */
+	GLMotif::PopupWindow* createDialog(int dialogIndex,int numRows); // Creates a dialog window with the given number of widget rows
+	void printResults(const char* phaseName); // Prints the results of the current measurement phase
+	
+	/* Constructors and destructors: */
+	public:
+	GLMotifDrawBenchmark(int& argc,char**& argv);
+	virtual ~GLMotifDrawBenchmark(void);
+	
+	/* Methods from Vrui::Application: */
+	virtual void frame(void);
+	virtual void display(GLContextData& contextData) const;
+	};
+
+/*************************************
+Methods of class GLMotifDrawBenchmark:
+*************************************/
+
+GLMotif::PopupWindow* GLMotifDrawBenchmark::createDialog(int dialogIndex,int numRows)
+	{
+	const GLMotif::StyleSheet& ss=*Vrui::getWidgetManager()->getStyleSheet();
+	
+	char name[64];
+	snprintf(name,sizeof(name),"Dialog%d",dialogIndex);
+	GLMotif::PopupWindow* dialog=new GLMotif::PopupWindow(name,Vrui::getWidgetManager(),name);
+	
+	GLMotif::RowColumn* rows=new GLMotif::RowColumn("Rows",dialog,false);
+	rows->setNumMinorWidgets(4);
+	
+	for(int row=0;row<numRows;++row)
+		{
+		snprintf(name,sizeof(name),"Label%d",row);
+		new GLMotif::Label(name,rows,name);
+		
+		snprintf(name,sizeof(name),"Button%d",row);
+		new GLMotif::Button(name,rows,name);
+		
+		snprintf(name,sizeof(name),"Toggle%d",row);
+		GLMotif::ToggleButton* toggle=new GLMotif::ToggleButton(name,rows,name);
+		toggle->setToggle(row%2==0);
+		
+		snprintf(name,sizeof(name),"Slider%d",row);
+		GLMotif::TextFieldSlider* slider=new GLMotif::TextFieldSlider(name,rows,6,ss.fontHeight*10.0f);
+		slider->getTextField()->setFloatFormat(GLMotif::TextField::FIXED);
+		slider->getTextField()->setFieldWidth(6);
+		slider->getTextField()->setPrecision(2);
+		slider->setValueRange(0.0,100.0,0.01);
+		slider->setValue(double(row*10%100));
+		sliders.push_back(slider);
+		}
+	
+	/* Add a list box after the widget rows: */
+	GLMotif::ListBox* listBox=new GLMotif::ListBox("ListBox",rows,GLMotif::ListBox::ATMOST_ONE,20,8);
+	for(int i=0;i<32;++i)
+		{
+		snprintf(name,sizeof(name),"List item %d of dialog %d",i,dialogIndex);
+		listBox->addItem(name);
+		}
+	
+	rows->manageChild();
+	
+	return dialog;
+	}
+
+void GLMotifDrawBenchmark::printResults(const char* phaseName)
+	{
+	/* Calculate frame time statistics: */
+	std::vector<double> sorted=frameTimes;
+	std::sort(sorted.begin(),sorted.end());
+	double sum=0.0;
+	for(std::vector<double>::iterator ftIt=sorted.begin();ftIt!=sorted.end();++ftIt)
+		sum+=*ftIt;
+	size_t n=sorted.size();
+	
+	printf("%s: %u frames\n",phaseName,(unsigned int)(n));
+	printf("Frame time (ms): mean %.3f, median %.3f, 95th percentile %.3f, max %.3f\n",sum*1000.0/double(n),sorted[n/2]*1000.0,sorted[(n*95)/100]*1000.0,sorted[n-1]*1000.0);
+	fflush(stdout);
+	}
+
+GLMotifDrawBenchmark::GLMotifDrawBenchmark(int& argc,char**& argv)
+	:Vrui::Application(argc,argv),
+	 animate(false),
+	 numWarmupFrames(30),numFrames(500),
+	 phase(0),frameIndex(0)
+	{
+	/* Parse the command line: */
+	int numDialogs=16;
+	int numRows=8;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-dialogs")==0&&i+1<argc)
+			numDialogs=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-rows")==0&&i+1<argc)
+			numRows=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-frames")==0&&i+1<argc)
+			numFrames=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-warmup")==0&&i+1<argc)
+			numWarmupFrames=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-animate")==0)
+			animate=true;
+		}
+	if(numDialogs<1||numRows<1||numFrames<1||numWarmupFrames<0)
+		throw std::runtime_error("Usage: GLMotifDrawBenchmark [-dialogs <number of dialogs>] [-rows <number of rows per dialog>] [-frames <number of frames>] [-warmup <number of frames>] [-animate]");
+	
+	/* Create the dialogs: */
+	for(int i=0;i<numDialogs;++i)
+		dialogs.push_back(createDialog(i,numRows));
+	
+	/* Pop up the dialogs in a grid in front of the viewer: */
+	int numColumns=int(Math::ceil(Math::sqrt(double(numDialogs))));
+	Vrui::Vector x=Vrui::getForwardDirection()^Vrui::getUpDirection();
+	x.normalize();
+	Vrui::Vector y=Vrui::getUpDirection();
+	Vrui::Scalar spacing=Vrui::getDisplaySize()/Vrui::Scalar(numColumns);
+	for(int i=0;i<numDialogs;++i)
+		{
+		Vrui::Scalar dx=(Vrui::Scalar(i%numColumns)-Vrui::Scalar(numColumns-1)*Vrui::Scalar(0.5))*spacing;
+		Vrui::Scalar dy=(Vrui::Scalar(numColumns-1)*Vrui::Scalar(0.5)-Vrui::Scalar(i/numColumns))*spacing;
+		Vrui::popupPrimaryWidget(dialogs[i],Vrui::getDisplayCenter()+x*dx+y*dy,false);
+		}
+	
+	/* Start with the render cache disabled: */
+	Vrui::getWidgetManager()->setCacheWidgetRendering(false);
+	frameTimes.reserve(numFrames);
+	}
+
+GLMotifDrawBenchmark::~GLMotifDrawBenchmark(void)
+	{
+	for(std::vector<GLMotif::PopupWindow*>::iterator dIt=dialogs.begin();dIt!=dialogs.end();++dIt)
+		delete *dIt;
+	}
+
+void GLMotifDrawBenchmark::frame(void)
+	{
+	if(frameIndex>numWarmupFrames)
+		{
+		/* Record the previous frame: */
+		frameTimes.push_back(Vrui::getFrameTime());
+		if(int(frameTimes.size())==numFrames)
+			{
+			printResults(phase==0?"Render cache disabled":"Render cache enabled");
+			frameTimes.clear();
+			frameIndex=0;
+			if(++phase==2)
+				{
+				Vrui::shutdown();
+				return;
+				}
+			
+			/* Enable the render cache for the next phase: */
+			Vrui::getWidgetManager()->setCacheWidgetRendering(true);
+			}
+		}
+	++frameIndex;
+	
+	if(animate)
+		{
+		/* Change one slider per dialog to invalidate every dialog's cached visual representation: */
+		size_t slidersPerDialog=sliders.size()/dialogs.size();
+		for(size_t i=0;i<dialogs.size();++i)
+			{
+			GLMotif::TextFieldSlider* slider=sliders[i*slidersPerDialog+size_t(frameIndex)%slidersPerDialog];
+			slider->setValue(slider->getValue()<99.0?slider->getValue()+1.0:0.0);
+			}
+		}
+	
+	/* Render continuously: */
+	Vrui::scheduleUpdate(Vrui::getApplicationTime());
+	}
+
+void GLMotifDrawBenchmark::display(GLContextData& contextData) const
+	{
+	/* The widget manager renders all benchmarked widgets */
+	}
+
+VRUI_APPLICATION_RUN(GLMotifDrawBenchmark)
@@ -0,0 +1,317 @@
+/***********************************************************************
+GeoTransformBenchmark - Program to compare the throughput of per-point
+and batched geodetic and map projection transformations.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Math/ArrayKernels.h>
+#include <Geometry/Point.h>
+#include <Geometry/Geoid.h>
+#include <Geometry/TransverseMercatorProjection.h>
+#include <Geometry/UTMProjection.h>
+#include <Geometry/LambertConformalProjection.h>
+#include <Geometry/AlbersEqualAreaProjection.h>
+
+typedef Geometry::Geoid<double> Geoid;
+typedef Geoid::Point Point;
+typedef Geometry::UTMProjection<double>::PPoint PPoint;
+
+/**************
+Helper classes:
+**************/
+
+class GeodeticToCartesian // Converts points from geodetic to Cartesian coordinates
+	{
+	/* Embedded classes: */
+	public:
+	typedef Point Value; // Type of converted values
+	
+	/* Elements: */
+	private:
+	const Geoid& geoid;
+	
+	/* Constructors and destructors: */
+	public:
+	GeodeticToCartesian(const Geoid& sGeoid)
+		:geoid(sGeoid)
+		{
+		}
+	
+	/* Methods: */
+	Value convert(const Value& source) const
+		{
+		return geoid.geodeticToCartesian(source);
+		}
+	void convert(const Value* sources,Value* dests,size_t numValues) const
+		{
+		geoid.geodeticToCartesian(sources,dests,numValues);
+		}
+	double deviation(const Value& v0,const Value& v1) const // Returns the distance between two results in meters
+		{
+		return Geometry::dist(v0,v1);
+		}
+	};
+
+class CartesianToGeodetic // Converts points from Cartesian to geodetic coordinates
+	{
+	/* Embedded classes: */
+	public:
+	typedef Point Value; // Type of converted values
+	
+	/* Elements: */
+	private:
+	const Geoid& geoid;
+	
+	/* Constructors and destructors: */
+	public:
+	CartesianToGeodetic(const Geoid& sGeoid)
+		:geoid(sGeoid)
+		{
+		}
+	
+	/* Methods: */
+	Value convert(const Value& source) const
+		{
+		return geoid.cartesianToGeodetic(source);
+		}
+	void convert(const Value* sources,Value* dests,size_t numValues) const
+		{
+		geoid.cartesianToGeodetic(sources,dests,numValues);
+		}
+	double deviation(const Value& v0,const Value& v1) const // Returns the distance between two results in meters
+		{
+		double angleScale=geoid.getRadius();
+		return Math::max(Math::max(Math::abs(v0[0]-v1[0])*angleScale,Math::abs(v0[1]-v1[1])*angleScale),Math::abs(v0[2]-v1[2]));
+		}
+	};
+
+template <class ProjectionParam>
+class GeodeticToMap // Projects points from geodetic to map coordinates
+	{
+	/* Embedded classes: */
+	public:
+	typedef PPoint Value; // Type of converted values
+	
+	/* Elements: */
+	private:
+	const ProjectionParam& projection;
+	
+	/* Constructors and destructors: */
+	public:
+	GeodeticToMap(const ProjectionParam& sProjection)
+		:projection(sProjection)
+		{
+		}
+	
+	/* Methods: */
+	Value convert(const Value& source) const
+		{
+		return projection.geodeticToMap(source);
+		}
+	void convert(const Value* sources,Value* dests,size_t numValues) const
+		{
+		projection.geodeticToMap(sources,dests,numValues);
+		}
+	double deviation(const Value& v0,const Value& v1) const // Returns the distance between two results in meters
+		{
+		return Geometry::dist(v0,v1);
+		}
+	};
+
+template <class ProjectionParam>
+class MapToGeodetic // Unprojects points from map to geodetic coordinates
+	{
+	/* Embedded classes: */
+	public:
+	typedef PPoint Value; // Type of converted values
+	
+	/* Elements: */
+	private:
+	const ProjectionParam& projection;
+	
+	/* Constructors and destructors: */
+	public:
+	MapToGeodetic(const ProjectionParam& sProjection)
+		:projection(sProjection)
+		{
+		}
+	
+	/* Methods: */
+	Value convert(const Value& source) const
+		{
+		return projection.mapToGeodetic(source);
+		}
+	void convert(const Value* sources,Value* dests,size_t numValues) const
+		{
+		projection.mapToGeodetic(sources,dests,numValues);
+		}
+	double deviation(const Value& v0,const Value& v1) const // Returns the distance between two results in meters
+		{
+		return Geometry::dist(v0,v1)*projection.getRadius();
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+template <class ConverterParam>
+bool benchmark(const char* name,const ConverterParam& converter,const typename ConverterParam::Value* sources,size_t numValues,int numIterations)
+	{
+	typedef typename ConverterParam::Value Value;
+	
+	Value* refDests=new Value[numValues];
+	Value* dests=new Value[numValues];
+	Misc::Timer t;
+	
+	/* Convert all values one at a time as reference: */
+	double singleTime=1.0e30;
+	for(int iteration=0;iteration<numIterations;++iteration)
+		{
+		t.elapse();
+		for(size_t i=0;i<numValues;++i)
+			refDests[i]=converter.convert(sources[i]);
+		t.elapse();
+		singleTime=Math::min(singleTime,t.getTime());
+		}
+	
+	/* Convert all values in one batch, once with each instruction set: */
+	double batchTimes[2];
+	double maxDeviation=0.0;
+	for(int instructionSet=0;instructionSet<2;++instructionSet)
+		{
+		Math::ArrayKernels::setInstructionSet(Math::ArrayKernels::InstructionSet(instructionSet));
+		batchTimes[instructionSet]=1.0e30;
+		for(int iteration=0;iteration<numIterations;++iteration)
+			{
+			t.elapse();
+			converter.convert(sources,dests,numValues);
+			t.elapse();
+			batchTimes[instructionSet]=Math::min(batchTimes[instructionSet],t.getTime());
+			}
+		
+		/* Compare the batch results against the reference results: */
+		for(size_t i=0;i<numValues;++i)
+			maxDeviation=Math::max(maxDeviation,converter.deviation(refDests[i],dests[i]));
+		}
+	
+	double mps=double(numValues)*1.0e-6;
+	printf("%-24s %10.2f %10.2f %10.2f %8.2fx %10.3g\n",name,mps/singleTime,mps/batchTimes[0],mps/batchTimes[1],singleTime/batchTimes[1],maxDeviation);
+	fflush(stdout);
+	
+	delete[] refDests;
+	delete[] dests;
+	
+	/* Batch results must match the reference results to within a micrometer: */
+	return maxDeviation<=1.0e-6;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int numPoints=1000000;
+	int numIterations=5;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-points")==0&&i+1<argc)
+			numPoints=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-iterations")==0&&i+1<argc)
+			numIterations=atoi(argv[++i]);
+		else
+			{
+			fprintf(stderr,"Usage: %s [-points <number of points>] [-iterations <number of iterations>]\n",argv[0]);
+			return 1;
+			}
+		}
+	if(numPoints<1||numIterations<1)
+		{
+		fprintf(stderr,"%s: Invalid benchmark parameters\n",argv[0]);
+		return 1;
+		}
+	
+	/* Check which instruction set the array kernels select on this CPU: */
+	Math::ArrayKernels::InstructionSet hostInstructionSet=Math::ArrayKernels::getInstructionSet();
+	Math::ArrayKernels::setInstructionSet(Math::ArrayKernels::SSE2);
+	bool haveSSE2=Math::ArrayKernels::getInstructionSet()==Math::ArrayKernels::SSE2;
+	
+	/* Create random geodetic points covering UTM zone 10 north: */
+	double d2r=Math::Constants<double>::pi/180.0;
+	Point* geodetic=new Point[numPoints];
+	PPoint* geodetic2=new PPoint[numPoints];
+	for(int i=0;i<numPoints;++i)
+		{
+		geodetic[i]=Point((-126.0+6.0*double(rand())/double(RAND_MAX))*d2r,(30.0+20.0*double(rand())/double(RAND_MAX))*d2r,-100.0+4100.0*double(rand())/double(RAND_MAX));
+		geodetic2[i]=PPoint(geodetic[i][0],geodetic[i][1]);
+		}
+	
+	/* Create the geoid and map projections: */
+	Geoid geoid;
+	Geometry::TransverseMercatorProjection<double> tm(-123.0*d2r,0.0);
+	tm.setStretching(0.9996);
+	tm.setFalseEasting(500000.0);
+	Geometry::UTMProjection<double> utm(10);
+	Geometry::LambertConformalProjection<double> lcc(-123.0*d2r,23.0*d2r,33.0*d2r,45.0*d2r);
+	Geometry::AlbersEqualAreaProjection<double> aea(-123.0*d2r,23.0*d2r,33.0*d2r,45.0*d2r);
+	
+	/* Create Cartesian and map points as inputs for the inverse transformations: */
+	Point* cartesian=new Point[numPoints];
+	geoid.geodeticToCartesian(geodetic,cartesian,numPoints);
+	PPoint* tmMap=new PPoint[numPoints];
+	tm.geodeticToMap(geodetic2,tmMap,numPoints);
+	PPoint* utmMap=new PPoint[numPoints];
+	utm.geodeticToMap(geodetic2,utmMap,numPoints);
+	PPoint* lccMap=new PPoint[numPoints];
+	lcc.geodeticToMap(geodetic2,lccMap,numPoints);
+	PPoint* aeaMap=new PPoint[numPoints];
+	aea.geodeticToMap(geodetic2,aeaMap,numPoints);
+	
+	printf("%d points, best of %d; rates in million points per second; batch C uses the C library, batch SSE2 uses vectorized kernels (%s):\n",numPoints,numIterations,haveSSE2?"available":"not available, falling back to the C library");
+	printf("%-24s %10s %10s %10s %9s %10s\n","Transformation","per-point","batch C","batch SSE2","speedup","max dev m");
+	bool valid=true;
+	valid=benchmark("Geodetic to Cartesian",GeodeticToCartesian(geoid),geodetic,numPoints,numIterations)&&valid;
+	valid=benchmark("Cartesian to geodetic",CartesianToGeodetic(geoid),cartesian,numPoints,numIterations)&&valid;
+	valid=benchmark("Transverse Mercator fwd",GeodeticToMap<Geometry::TransverseMercatorProjection<double> >(tm),geodetic2,numPoints,numIterations)&&valid;
+	valid=benchmark("Transverse Mercator inv",MapToGeodetic<Geometry::TransverseMercatorProjection<double> >(tm),tmMap,numPoints,numIterations)&&valid;
+	valid=benchmark("UTM fwd",GeodeticToMap<Geometry::UTMProjection<double> >(utm),geodetic2,numPoints,numIterations)&&valid;
+	valid=benchmark("UTM inv",MapToGeodetic<Geometry::UTMProjection<double> >(utm),utmMap,numPoints,numIterations)&&valid;
+	valid=benchmark("Lambert conformal fwd",GeodeticToMap<Geometry::LambertConformalProjection<double> >(lcc),geodetic2,numPoints,numIterations)&&valid;
+	valid=benchmark("Lambert conformal inv",MapToGeodetic<Geometry::LambertConformalProjection<double> >(lcc),lccMap,numPoints,numIterations)&&valid;
+	valid=benchmark("Albers equal area fwd",GeodeticToMap<Geometry::AlbersEqualAreaProjection<double> >(aea),geodetic2,numPoints,numIterations)&&valid;
+	valid=benchmark("Albers equal area inv",MapToGeodetic<Geometry::AlbersEqualAreaProjection<double> >(aea),aeaMap,numPoints,numIterations)&&valid;
+	printf("Valid                    %10s\n",valid?"yes":"NO");
+	
+	Math::ArrayKernels::setInstructionSet(hostInstructionSet);
+	
+	delete[] geodetic;
+	delete[] geodetic2;
+	delete[] cartesian;
+	delete[] tmMap;
+	delete[] utmMap;
+	delete[] lccMap;
+	delete[] aeaMap;
+	
+	return valid?0:1;
+	}
@@ -0,0 +1,256 @@
+/***********************************************************************
+HashTableBenchmark - Program to compare the performance of the chained
+Misc::HashTable and the open-addressing Misc::FlatHashTable for the key
+distributions found in Vrui's per-frame lookups.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <Misc/Timer.h>
+#include <Misc/HashTable.h>
+#include <Misc/FlatHashTable.h>
+#include <Misc/StringHashFunctions.h>
+#include <Math/Math.h>
+
+/**************
+Helper classes:
+**************/
+
+
+struct Results // Structure holding the times of all benchmark operations in ns per operation
+	{
+	/* Elements: */
+	public:
+	double insert; // Time to insert an entry into a table created at a small initial size
+	double hit; // Time to look up an entry that is in the table
+	double miss; // Time to look up an entry that is not in the table
+	double churn; // Time to remove an entry and insert it again
+	double iterate; // Time to visit an entry during iteration over the entire table
+	};
+
+/****************
+Helper functions:
+****************/
+
+size_t checksum=0; // Sum of all looked-up values, to keep the compiler from optimizing lookups away
+
+template <class TableParam,class KeyParam>
+Results runBenchmark(const std::vector<KeyParam>& keys,const std::vector<KeyParam>& missKeys,const std::vector<size_t>& lookupSequence,int numRepeats)
+	{
+	typedef typename TableParam::Entry Entry;
+	
+	/* Report the fastest of all repeats of each operation, to reduce the influence of other processes: */
+	Results result;
+	result.insert=result.hit=result.miss=result.churn=result.iterate=1.0e30;
+	size_t numKeys=keys.size();
+	size_t numLookups=lookupSequence.size();
+	size_t numInserts=numLookups/numKeys+1;
+	size_t numIterations=numLookups/numKeys+1;
+	Misc::Timer t;
+	for(int repeat=0;repeat<numRepeats;++repeat)
+		{
+		/* Time inserting all keys into tables created at the same small initial size as GLContextData and Multiplexer use: */
+		t.elapse();
+		for(size_t i=0;i<numInserts;++i)
+			{
+			TableParam table(17);
+			for(size_t j=0;j<numKeys;++j)
+				table.setEntry(Entry(keys[j],j));
+			checksum+=table.getNumEntries();
+			}
+		t.elapse();
+		result.insert=Math::min(result.insert,t.getTime()*1.0e9/(double(numInserts)*double(numKeys)));
+		
+		TableParam table(17);
+		for(size_t i=0;i<numKeys;++i)
+			table.setEntry(Entry(keys[i],i));
+		
+		/* Time successful lookups in random order: */
+		t.elapse();
+		for(size_t i=0;i<numLookups;++i)
+			{
+			typename TableParam::Iterator eIt=table.findEntry(keys[lookupSequence[i]]);
+			if(!eIt.isFinished())
+				checksum+=eIt->getDest();
+			}
+		t.elapse();
+		result.hit=Math::min(result.hit,t.getTime()*1.0e9/double(numLookups));
+		
+		/* Time unsuccessful lookups in random order: */
+		t.elapse();
+		for(size_t i=0;i<numLookups;++i)
+			{
+			typename TableParam::Iterator eIt=table.findEntry(missKeys[lookupSequence[i]]);
+			if(!eIt.isFinished())
+				checksum+=eIt->getDest();
+			}
+		t.elapse();
+		result.miss=Math::min(result.miss,t.getTime()*1.0e9/double(numLookups));
+		
+		/* Time removing and re-inserting entries in random order, as when things are destroyed and created: */
+		t.elapse();
+		for(size_t i=0;i<numLookups;++i)
+			{
+			size_t keyIndex=lookupSequence[i];
+			table.removeEntry(keys[keyIndex]);
+			table.setEntry(Entry(keys[keyIndex],keyIndex));
+			}
+		t.elapse();
+		result.churn=Math::min(result.churn,t.getTime()*1.0e9/double(numLookups));
+		
+		/* Time iterating over all entries, as when context data objects are destroyed: */
+		t.elapse();
+		for(size_t i=0;i<numIterations;++i)
+			for(typename TableParam::Iterator eIt=table.begin();!eIt.isFinished();++eIt)
+				checksum+=eIt->getDest();
+		t.elapse();
+		result.iterate=Math::min(result.iterate,t.getTime()*1.0e9/(double(numIterations)*double(numKeys)));
+		}
+	
+	return result;
+	}
+
+template <class KeyParam,class HashFunctionParam>
+void compareTables(const char* keyType,const std::vector<KeyParam>& keys,const std::vector<KeyParam>& missKeys,const std::vector<size_t>& lookupSequence,int numRepeats)
+	{
+	Results chained=runBenchmark<Misc::HashTable<KeyParam,size_t,HashFunctionParam> >(keys,missKeys,lookupSequence,numRepeats);
+	Results flat=runBenchmark<Misc::FlatHashTable<KeyParam,size_t,HashFunctionParam> >(keys,missKeys,lookupSequence,numRepeats);
+	
+	printf("%-8s %8u  %-7s %8.2f %8.2f %8.2f %8.2f %8.2f\n",keyType,(unsigned int)(keys.size()),"chained",chained.insert,chained.hit,chained.miss,chained.churn,chained.iterate);
+	printf("%-8s %8u  %-7s %8.2f %8.2f %8.2f %8.2f %8.2f\n",keyType,(unsigned int)(keys.size()),"flat",flat.insert,flat.hit,flat.miss,flat.churn,flat.iterate);
+	printf("%-8s %8u  %-7s %7.2fx %7.2fx %7.2fx %7.2fx %7.2fx\n",keyType,(unsigned int)(keys.size()),"speedup",chained.insert/flat.insert,chained.hit/flat.hit,chained.miss/flat.miss,chained.churn/flat.churn,chained.iterate/flat.iterate);
+	fflush(stdout);
+	}
+
+double timeStringLookups(const Misc::FlatHashTable<std::string,size_t>& table,const std::vector<std::string>& keys,const std::vector<size_t>& lookupSequence,int numRepeats,bool compatible)
+	{
+	/* Look up entries by C strings, either converting them to temporary C++ strings or using them directly: */
+	double result=1.0e30;
+	size_t numLookups=lookupSequence.size();
+	Misc::Timer t;
+	for(int repeat=0;repeat<numRepeats;++repeat)
+		{
+		t.elapse();
+		for(size_t i=0;i<numLookups;++i)
+			{
+			const char* key=keys[lookupSequence[i]].c_str();
+			Misc::FlatHashTable<std::string,size_t>::ConstIterator eIt=compatible?table.findCompatibleEntry(key):table.findEntry(key);
+			if(!eIt.isFinished())
+				checksum+=eIt->getDest();
+			}
+		t.elapse();
+		result=Math::min(result,t.getTime()*1.0e9/double(numLookups));
+		}
+	
+	return result;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	size_t maxNumKeys=65536;
+	size_t numLookups=1000000;
+	int numRepeats=5;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-maxKeys")==0&&i+1<argc)
+			maxNumKeys=size_t(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-lookups")==0&&i+1<argc)
+			numLookups=size_t(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-repeats")==0&&i+1<argc)
+			numRepeats=atoi(argv[++i]);
+		else
+			{
+			fprintf(stderr,"Usage: %s [-maxKeys <max number of keys>] [-lookups <number of lookups>] [-repeats <number of repeats>]\n",argv[0]);
+			return 1;
+			}
+		}
+	if(maxNumKeys<16||numLookups<1||numRepeats<1)
+		{
+		fprintf(stderr,"%s: Invalid benchmark parameters\n",argv[0]);
+		return 1;
+		}
+	
+	printf("Times per operation in ns:\n");
+	printf("Keys      Entries  Table     Insert      Hit     Miss    Churn  Iterate\n");
+	fflush(stdout);
+	
+	srand(1);
+	for(size_t numKeys=16;numKeys<=maxNumKeys;numKeys*=16)
+		{
+		/* Create a random lookup sequence: */
+		std::vector<size_t> lookupSequence(numLookups);
+		for(size_t i=0;i<numLookups;++i)
+			lookupSequence[i]=size_t(rand())%numKeys;
+		
+		/* Create pointer keys by allocating objects of varying sizes on the heap, like GLObjects of different classes, interleaved with non-key objects for misses: */
+		std::vector<char*> things(numKeys*2);
+		for(size_t i=0;i<numKeys*2;++i)
+			things[i]=new char[16+size_t(rand())%240];
+		std::random_shuffle(things.begin(),things.end());
+		std::vector<const char*> pointerKeys(things.begin(),things.begin()+numKeys);
+		std::vector<const char*> pointerMissKeys(things.begin()+numKeys,things.end());
+		compareTables<const char*,Misc::StandardHashFunction<const char*> >("pointer",pointerKeys,pointerMissKeys,lookupSequence,numRepeats);
+		for(size_t i=0;i<numKeys*2;++i)
+			delete[] things[i];
+		
+		/* Create small integer keys as consecutively assigned IDs, with misses being IDs that have not been assigned yet: */
+		std::vector<unsigned int> intKeys(numKeys);
+		std::vector<unsigned int> intMissKeys(numKeys);
+		for(size_t i=0;i<numKeys;++i)
+			{
+			intKeys[i]=(unsigned int)(i);
+			intMissKeys[i]=(unsigned int)(numKeys+i);
+			}
+		compareTables<unsigned int,Misc::StandardHashFunction<unsigned int> >("int",intKeys,intMissKeys,lookupSequence,numRepeats);
+		
+		/* Create string keys resembling attribute and device names: */
+		std::vector<std::string> stringKeys(numKeys);
+		std::vector<std::string> stringMissKeys(numKeys);
+		for(size_t i=0;i<numKeys;++i)
+			{
+			char name[32];
+			snprintf(name,sizeof(name),"WidgetAttribute%u",(unsigned int)(i));
+			stringKeys[i]=name;
+			snprintf(name,sizeof(name),"WidgetAttribute%uX",(unsigned int)(i));
+			stringMissKeys[i]=name;
+			}
+		compareTables<std::string,Misc::StandardHashFunction<std::string> >("string",stringKeys,stringMissKeys,lookupSequence,numRepeats);
+		
+		/* Compare looking up string keys by C strings with and without creating temporary C++ strings: */
+		Misc::FlatHashTable<std::string,size_t> stringTable(17);
+		for(size_t i=0;i<numKeys;++i)
+			stringTable.setEntry(Misc::FlatHashTable<std::string,size_t>::Entry(stringKeys[i],i));
+		double temporaryTime=timeStringLookups(stringTable,stringKeys,lookupSequence,numRepeats,false);
+		double compatibleTime=timeStringLookups(stringTable,stringKeys,lookupSequence,numRepeats,true);
+		printf("%-8s %8u  C string lookups: %.2f ns with temporary std::string, %.2f ns direct\n","string",(unsigned int)(numKeys),temporaryTime,compatibleTime);
+		fflush(stdout);
+		}
+	
+	/* Print the checksum so that lookups cannot be optimized away: */
+	printf("Checksum: %lu\n",(unsigned long)(checksum));
+	
+	return 0;
+	}
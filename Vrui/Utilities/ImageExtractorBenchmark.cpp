@@ -0,0 +1,195 @@
+/***********************************************************************
+ImageExtractorBenchmark - Program to measure the throughput of video
+image extractors' colorspace conversion and debayering paths for all
+supported instruction sets, and to check that they produce the same
+results as the scalar reference.
+Copyright (c) 2018 Oliver Kreylos
+
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Video/FrameBuffer.h>
+#include <Video/BayerPattern.h>
+#include <Video/ColorspaceKernels.h>
+#include <Video/ImageExtractor.h>
+#include <Video/ImageExtractorYUYV.h>
+#include <Video/ImageExtractorUYVY.h>
+#include <Video/ImageExtractorYV12.h>
+#include <Video/ImageExtractorRGB8.h>
+#include <Video/ImageExtractorBA81.h>
+
+/**************
+Helper classes:
+**************/
+
+enum Method // Enumerated type for image extraction methods
+	{
+	GREY=0,RGB,YPCBCR,YPCBCR420,NUM_METHODS
+	};
+
+/****************
+Helper functions:
+****************/
+
+const char* methodNames[NUM_METHODS]={"Grey","RGB","Y'CbCr","Y'CbCr420"};
+const char* instructionSetNames[3]={"Scalar","SSE2","AVX2"};
+
+void extract(Video::ImageExtractor* extractor,Method method,const Video::FrameBuffer* frame,const unsigned int size[2],std::vector<unsigned char>& image)
+	{
+	/* Extract the image in the given method's format: */
+	unsigned int numPixels=size[0]*size[1];
+	switch(method)
+		{
+		case GREY:
+			extractor->extractGrey(frame,&image[0]);
+			break;
+		
+		case RGB:
+			extractor->extractRGB(frame,&image[0]);
+			break;
+		
+		case YPCBCR:
+			extractor->extractYpCbCr(frame,&image[0]);
+			break;
+		
+		case YPCBCR420:
+			extractor->extractYpCbCr420(frame,&image[0],size[0],&image[numPixels],size[0]/2,&image[numPixels+numPixels/4],size[0]/2);
+			break;
+		
+		default:
+			;
+		}
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int size[2]={1920,1080};
+	int numFrames=20;
+	int numRepeats=5;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-size")==0&&i+2<argc)
+			{
+			size[0]=(unsigned int)(atoi(argv[++i]));
+			size[1]=(unsigned int)(atoi(argv[++i]));
+			}
+		else if(strcasecmp(argv[i],"-frames")==0&&i+1<argc)
+			numFrames=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-repeats")==0&&i+1<argc)
+			numRepeats=atoi(argv[++i]);
+		else
+			{
+			fprintf(stderr,"Usage: %s [-size <width> <height>] [-frames <number of frames per repeat>] [-repeats <number of repeats>]\n",argv[0]);
+			return 1;
+			}
+		}
+	if(size[0]<4||size[1]<4||size[0]%2!=0||size[1]%2!=0||numFrames<1||numRepeats<1)
+		{
+		fprintf(stderr,"%s: Invalid benchmark parameters\n",argv[0]);
+		return 1;
+		}
+	unsigned int numPixels=size[0]*size[1];
+	
+	/* Create extractors for all vectorized pixel formats: */
+	static const int numFormats=6;
+	const char* formatNames[numFormats]={"YUYV","UYVY","YV12","RGB8","BA81 BGGR","BA81 RGGB"};
+	size_t frameSizes[numFormats]={size_t(numPixels)*2,size_t(numPixels)*2,size_t(numPixels)*3/2,size_t(numPixels)*3,size_t(numPixels),size_t(numPixels)};
+	Video::ImageExtractor* extractors[numFormats];
+	extractors[0]=new Video::ImageExtractorYUYV(size);
+	extractors[1]=new Video::ImageExtractorUYVY(size);
+	extractors[2]=new Video::ImageExtractorYV12(size,0,size[0],numPixels+numPixels/4,size[0]/2,numPixels,size[0]/2);
+	extractors[3]=new Video::ImageExtractorRGB8(size);
+	extractors[4]=new Video::ImageExtractorBA81(size,Video::BAYER_BGGR);
+	extractors[5]=new Video::ImageExtractorBA81(size,Video::BAYER_RGGB);
+	
+	/* Fill a frame buffer with random data, which is valid input for all pixel formats: */
+	srand(1);
+	std::vector<unsigned char> frameData(size_t(numPixels)*3);
+	for(std::vector<unsigned char>::iterator fdIt=frameData.begin();fdIt!=frameData.end();++fdIt)
+		*fdIt=(unsigned char)(rand()&0xff);
+	Video::FrameBuffer frame;
+	frame.start=&frameData[0];
+	frame.size=frameData.size();
+	
+	/* Determine the instruction sets supported by the host CPU: */
+	Video::ColorspaceKernels::InstructionSet bestInstructionSet=Video::ColorspaceKernels::getInstructionSet();
+	
+	printf("Extraction throughput for %ux%u frames in MPixel/s:\n",size[0],size[1]);
+	printf("Format     Method        Scalar      SSE2      AVX2  Identical\n");
+	fflush(stdout);
+	
+	bool allIdentical=true;
+	std::vector<unsigned char> reference(size_t(numPixels)*3);
+	std::vector<unsigned char> image(size_t(numPixels)*3);
+	for(int format=0;format<numFormats;++format)
+		{
+		frame.used=frameSizes[format];
+		for(int method=0;method<NUM_METHODS;++method)
+			{
+			printf("%-10s %-10s",formatNames[format],methodNames[method]);
+			bool identical=true;
+			for(int is=Video::ColorspaceKernels::SCALAR;is<=Video::ColorspaceKernels::AVX2;++is)
+				{
+				/* Skip instruction sets not supported by the host CPU: */
+				if(is>bestInstructionSet)
+					{
+					printf("  %8s","-");
+					continue;
+					}
+				Video::ColorspaceKernels::setInstructionSet(Video::ColorspaceKernels::InstructionSet(is));
+				
+				/* Time extracting a number of frames, and report the fastest of all repeats: */
+				double bestTime=1.0e30;
+				Misc::Timer t;
+				for(int repeat=0;repeat<numRepeats;++repeat)
+					{
+					t.elapse();
+					for(int i=0;i<numFrames;++i)
+						extract(extractors[format],Method(method),&frame,size,image);
+					t.elapse();
+					bestTime=Math::min(bestTime,t.getTime()/double(numFrames));
+					}
+				printf("  %8.1f",double(numPixels)*1.0e-6/bestTime);
+				
+				/* Compare the extracted image against the scalar reference: */
+				if(is==Video::ColorspaceKernels::SCALAR)
+					reference=image;
+				else if(image!=reference)
+					identical=false;
+				}
+			printf("  %s\n",identical?"yes":"NO");
+			fflush(stdout);
+			allIdentical=allIdentical&&identical;
+			}
+		}
+	
+	/* Restore the best instruction set and clean up: */
+	Video::ColorspaceKernels::setInstructionSet(bestInstructionSet);
+	for(int format=0;format<numFormats;++format)
+		delete extractors[format];
+	
+	return allIdentical?0:1;
+	}
@@ -0,0 +1,226 @@
+/***********************************************************************
+InputDeviceDataSeekBenchmark - Program to measure the time to seek to
+random positions in chunked and indexed input device data files,
+compared to reading the frames of an unindexed file from the beginning.
+Copyright (c) 2018 Oliver Kreylos
+
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Misc/Endianness.h>
+#include <IO/File.h>
+#include <IO/SeekableFile.h>
+#include <IO/OpenFile.h>
+#include <Math/Math.h>
+#include <Vrui/Internal/InputDeviceDataChunkWriter.h>
+#include <Vrui/Internal/InputDeviceDataChunkReader.h>
+
+/**************
+Helper classes:
+**************/
+
+struct Results // Structure holding the results of seeking in a single file
+	{
+	/* Elements: */
+	public:
+	double fileSize; // Size of the file in MB
+	double open; // Time to open the file and read or create its chunk index in ms
+	double seek; // Average time to seek to a random time stamp in ms
+	bool valid; // Flag whether all seeks landed on the expected frame
+	};
+
+/****************
+Helper functions:
+****************/
+
+void writeFrame(IO::File& file,size_t frameIndex,size_t frameSize)
+	{
+	/* Write the frame index followed by filler data standing in for device states: */
+	file.write<double>(double(frameIndex));
+	for(size_t i=sizeof(double);i+sizeof(double)<=frameSize;i+=sizeof(double))
+		file.write<double>(double(frameIndex)*0.001+double(i));
+	}
+
+void writeFile(const char* fileName,size_t numFrames,double frameRate,size_t frameSize,double chunkDuration,bool compress)
+	{
+	IO::SeekableFilePtr file=IO::openSeekableFile(fileName,IO::File::WriteOnly);
+	file->setEndianness(Misc::LittleEndian);
+	
+	if(chunkDuration>0.0)
+		{
+		/* Write a version 5.0 file through a chunk writer: */
+		file->write<char>("Vrui Input Device Data File v5.0\n",34);
+		Vrui::InputDeviceDataChunkWriter writer(file,chunkDuration,~0U,compress);
+		for(size_t i=0;i<numFrames;++i)
+			writeFrame(writer.startFrame(double(i)/frameRate),i,frameSize);
+		writer.finish();
+		}
+	else
+		{
+		/* Write a version 4.0 file as a plain sequence of frames: */
+		file->write<char>("Vrui Input Device Data File v4.0\n",34);
+		for(size_t i=0;i<numFrames;++i)
+			{
+			file->write<double>(double(i)/frameRate);
+			writeFrame(*file,i,frameSize);
+			}
+		}
+	}
+
+bool checkFrame(IO::File& frameFile,double timeStamp,double seekTimeStamp,double frameRate)
+	{
+	/* Check that the frame is the first frame at or after the seek time stamp: */
+	size_t frameIndex=size_t(frameFile.read<double>());
+	return timeStamp==double(frameIndex)/frameRate&&timeStamp>=seekTimeStamp&&(frameIndex==0||double(frameIndex-1)/frameRate<seekTimeStamp);
+	}
+
+Results runBenchmark(const char* fileName,const std::vector<double>& seekTimeStamps,double frameRate,size_t frameSize,bool chunked,int numRepeats)
+	{
+	Results result;
+	result.open=result.seek=1.0e30;
+	result.valid=true;
+	Misc::Timer t;
+	for(int repeat=0;repeat<numRepeats;++repeat)
+		{
+		/* Open the file and read its chunk index: */
+		t.elapse();
+		IO::SeekableFilePtr file=IO::openSeekableFile(fileName);
+		file->setEndianness(Misc::LittleEndian);
+		file->skip<char>(34);
+		IO::SeekableFile::Offset firstFrameOffset=file->getReadPos();
+		Vrui::InputDeviceDataChunkReader* reader=chunked?new Vrui::InputDeviceDataChunkReader(file,firstFrameOffset):0;
+		t.elapse();
+		result.open=Math::min(result.open,t.getTime()*1.0e3);
+		result.fileSize=double(file->getSize())/(1024.0*1024.0);
+		
+		/* Seek to all time stamps in order: */
+		t.elapse();
+		for(std::vector<double>::const_iterator stIt=seekTimeStamps.begin();stIt!=seekTimeStamps.end();++stIt)
+			{
+			IO::File* frameFile;
+			if(reader!=0)
+				{
+				/* Start reading at the first frame of the last chunk starting at or before the seek time stamp: */
+				reader->loadChunk(reader->findChunk(*stIt));
+				frameFile=reader->startNextFrame();
+				}
+			else
+				{
+				/* Start reading at the first frame of the file: */
+				file->setReadPosAbs(firstFrameOffset);
+				frameFile=file.getPointer();
+				}
+			
+			/* Skip frames preceding the seek time stamp: */
+			double timeStamp=frameFile->read<double>();
+			while(timeStamp<*stIt)
+				{
+				frameFile->skip<char>(frameSize);
+				if(reader!=0)
+					frameFile=reader->startNextFrame();
+				timeStamp=frameFile->read<double>();
+				}
+			
+			if(!checkFrame(*frameFile,timeStamp,*stIt,frameRate))
+				result.valid=false;
+			}
+		t.elapse();
+		result.seek=Math::min(result.seek,t.getTime()*1.0e3/double(seekTimeStamps.size()));
+		
+		delete reader;
+		}
+	
+	return result;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	const char* fileName="InputDeviceDataSeekBenchmark.dat";
+	double duration=600.0;
+	double frameRate=90.0;
+	size_t frameSize=512;
+	size_t numSeeks=200;
+	int numRepeats=3;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-file")==0&&i+1<argc)
+			fileName=argv[++i];
+		else if(strcasecmp(argv[i],"-duration")==0&&i+1<argc)
+			duration=atof(argv[++i]);
+		else if(strcasecmp(argv[i],"-rate")==0&&i+1<argc)
+			frameRate=atof(argv[++i]);
+		else if(strcasecmp(argv[i],"-frameSize")==0&&i+1<argc)
+			frameSize=size_t(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-seeks")==0&&i+1<argc)
+			numSeeks=size_t(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-repeats")==0&&i+1<argc)
+			numRepeats=atoi(argv[++i]);
+		else
+			{
+			fprintf(stderr,"Usage: %s [-file <temporary file name>] [-duration <recording length in s>] [-rate <frame rate in Hz>] [-frameSize <frame size in bytes>] [-seeks <number of seeks>] [-repeats <number of repeats>]\n",argv[0]);
+			return 1;
+			}
+		}
+	if(duration<=0.0||frameRate<=0.0||frameSize<sizeof(double)||numSeeks<1||numRepeats<1)
+		{
+		fprintf(stderr,"%s: Invalid benchmark parameters\n",argv[0]);
+		return 1;
+		}
+	frameSize=(frameSize/sizeof(double))*sizeof(double);
+	size_t numFrames=size_t(Math::ceil(duration*frameRate));
+	
+	/* Create a random sequence of seek time stamps that all have a frame at or after them: */
+	srand(1);
+	std::vector<double> seekTimeStamps;
+	seekTimeStamps.reserve(numSeeks);
+	double lastTimeStamp=double(numFrames-1)/frameRate;
+	for(size_t i=0;i<numSeeks;++i)
+		seekTimeStamps.push_back(double(rand())*lastTimeStamp/double(RAND_MAX));
+	
+	printf("Seeking in a %.0f s recording of %u frames of %u bytes:\n",duration,(unsigned int)numFrames,(unsigned int)frameSize);
+	printf("Format    Chunk  Compress   Size (MB)  Open (ms)  Seek (ms)  Valid\n");
+	fflush(stdout);
+	
+	/* Benchmark an unindexed file and chunked files with different chunk durations, with and without compression: */
+	static const double chunkDurations[]={0.0,0.5,2.0,8.0};
+	bool allValid=true;
+	for(int ci=0;ci<4;++ci)
+		for(int compress=0;compress<(chunkDurations[ci]>0.0?2:1);++compress)
+			{
+			writeFile(fileName,numFrames,frameRate,frameSize,chunkDurations[ci],compress!=0);
+			Results r=runBenchmark(fileName,seekTimeStamps,frameRate,frameSize,chunkDurations[ci]>0.0,numRepeats);
+			if(chunkDurations[ci]>0.0)
+				printf("v5.0    %5.1f s  %-8s  %10.2f %10.3f %10.3f  %s\n",chunkDurations[ci],compress?"yes":"no",r.fileSize,r.open,r.seek,r.valid?"yes":"NO");
+			else
+				printf("v4.0          -  %-8s  %10.2f %10.3f %10.3f  %s\n","no",r.fileSize,r.open,r.seek,r.valid?"yes":"NO");
+			fflush(stdout);
+			allValid=allValid&&r.valid;
+			}
+	
+	unlink(fileName);
+	
+	return allValid?0:1;
+	}
@@ -0,0 +1,193 @@
+/***********************************************************************
+KdTreeBenchmark - Program to measure how building array kd-trees and
+batched closest-point queries scale with the number of threads.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <Misc/Timer.h>
+#include <Math/Constants.h>
+#include <Threads/TaskPool.h>
+#include <Geometry/Point.h>
+#include <Geometry/ArrayKdTree.h>
+
+/**************
+Helper classes:
+**************/
+
+struct TreePoint:public Geometry::Point<float,3> // Point type stored in the benchmark's kd-trees
+	{
+	/* Embedded classes: */
+	public:
+	typedef Geometry::Point<float,3> Point;
+	
+	/* Constructors and destructors: */
+	TreePoint(void)
+		{
+		}
+	TreePoint(const Point& sPoint)
+		:Point(sPoint)
+		{
+		}
+	};
+
+typedef Geometry::ArrayKdTree<TreePoint> Tree;
+
+/****************
+Helper functions:
+****************/
+
+TreePoint::Point randomPoint(void)
+	{
+	TreePoint::Point result;
+	for(int i=0;i<3;++i)
+		result[i]=float(rand())/float(RAND_MAX);
+	return result;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int maxNumThreads=Threads::TaskPool::getNumProcessors();
+	int numPoints=4000000;
+	int numQueries=400000;
+	int maxNumNeighbors=8;
+	int numIterations=3;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-threads")==0&&i+1<argc)
+			maxNumThreads=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-points")==0&&i+1<argc)
+			numPoints=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-queries")==0&&i+1<argc)
+			numQueries=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-k")==0&&i+1<argc)
+			maxNumNeighbors=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-iterations")==0&&i+1<argc)
+			numIterations=atoi(argv[++i]);
+		else
+			{
+			fprintf(stderr,"Usage: %s [-threads <max number of threads>] [-points <number of points>] [-queries <number of queries>] [-k <number of neighbors>] [-iterations <number of iterations>]\n",argv[0]);
+			return 1;
+			}
+		}
+	if(maxNumThreads<1||numPoints<1||numQueries<1||maxNumNeighbors<1||numIterations<1)
+		{
+		fprintf(stderr,"%s: Invalid benchmark parameters\n",argv[0]);
+		return 1;
+		}
+	
+	/* Create random points and query positions: */
+	TreePoint* points=new TreePoint[numPoints];
+	for(int i=0;i<numPoints;++i)
+		points[i]=randomPoint();
+	TreePoint::Point* queries=new TreePoint::Point[numQueries];
+	for(int i=0;i<numQueries;++i)
+		queries[i]=randomPoint();
+	
+	/* Answer all queries one at a time as reference: */
+	Tree tree;
+	tree.setPoints(numPoints,points);
+	float* refClosestDists=new float[numQueries];
+	float* refNeighborDists=new float[size_t(numQueries)*maxNumNeighbors];
+	Tree::ClosePointSet closePoints(maxNumNeighbors);
+	Misc::Timer t;
+	for(int i=0;i<numQueries;++i)
+		refClosestDists[i]=Geometry::sqrDist(tree.findClosestPoint(queries[i]),queries[i]);
+	t.elapse();
+	double singleClosestTime=t.getTime();
+	t.elapse();
+	for(int i=0;i<numQueries;++i)
+		{
+		closePoints.clear();
+		tree.findClosestPoints(queries[i],closePoints);
+		for(int j=0;j<closePoints.getNumPoints();++j)
+			refNeighborDists[size_t(i)*maxNumNeighbors+j]=Geometry::sqrDist(closePoints.getPoint(j),queries[i]);
+		}
+	t.elapse();
+	double singleNeighborsTime=t.getTime();
+	
+	printf("%d points, %d queries, %d nearest neighbors; times in ms (best of %d):\n",numPoints,numQueries,maxNumNeighbors,numIterations);
+	printf("Single queries on one thread: closest %.1f, %d-NN %.1f\n",singleClosestTime*1000.0,maxNumNeighbors,singleNeighborsTime*1000.0);
+	printf("Threads       build  batch closest   batch k-NN\n");
+	fflush(stdout);
+	
+	const TreePoint** closest=new const TreePoint*[numQueries];
+	const TreePoint** neighbors=new const TreePoint*[size_t(numQueries)*maxNumNeighbors];
+	int* numNeighbors=new int[numQueries];
+	bool resultsMatch=true;
+	for(int numThreads=1;numThreads<=maxNumThreads;++numThreads)
+		{
+		/* Time building the tree: */
+		double buildTime=0.0;
+		for(int iteration=0;iteration<numIterations;++iteration)
+			{
+			t.elapse();
+			tree.setPoints(numPoints,points,numThreads);
+			t.elapse();
+			if(iteration==0||buildTime>t.getTime())
+				buildTime=t.getTime();
+			}
+		
+		/* Time batched closest-point and k-nearest-neighbor queries: */
+		double closestTime=0.0,neighborsTime=0.0;
+		for(int iteration=0;iteration<numIterations;++iteration)
+			{
+			t.elapse();
+			tree.findClosestPoints(numQueries,queries,closest,numThreads);
+			t.elapse();
+			if(iteration==0||closestTime>t.getTime())
+				closestTime=t.getTime();
+			t.elapse();
+			tree.findClosestPoints(numQueries,queries,maxNumNeighbors,Math::Constants<float>::max,neighbors,numNeighbors,numThreads);
+			t.elapse();
+			if(iteration==0||neighborsTime>t.getTime())
+				neighborsTime=t.getTime();
+			}
+		
+		/* Compare the batched results against the single queries by distance, as the tree's point array is replaced with every build: */
+		for(int i=0;i<numQueries&&resultsMatch;++i)
+			{
+			resultsMatch=Geometry::sqrDist(*closest[i],queries[i])==refClosestDists[i]&&numNeighbors[i]==maxNumNeighbors;
+			for(int j=0;j<maxNumNeighbors&&resultsMatch;++j)
+				{
+				size_t index=size_t(i)*maxNumNeighbors+j;
+				resultsMatch=Geometry::sqrDist(*neighbors[index],queries[i])==refNeighborDists[index];
+				}
+			}
+		
+		printf("%7d  %10.1f  %13.1f  %11.1f\n",numThreads,buildTime*1000.0,closestTime*1000.0,neighborsTime*1000.0);
+		fflush(stdout);
+		}
+	if(!resultsMatch)
+		printf("Batched query results do not match single query results\n");
+	
+	delete[] points;
+	delete[] queries;
+	delete[] refClosestDists;
+	delete[] refNeighborDists;
+	delete[] closest;
+	delete[] neighbors;
+	delete[] numNeighbors;
+	
+	return resultsMatch?0:1;
+	}
@@ -0,0 +1,455 @@
+/***********************************************************************
+MakePointOctree - Program to convert large point clouds in ASCII format
+into memory-mappable multi-resolution octree files for out-of-core
+rendering by PointCloud nodes.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include <Misc/SizedTypes.h>
+#include <Misc/Endianness.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <IO/ValueSource.h>
+#include <SceneGraph/Internal/PointOctreeFile.h>
+
+typedef SceneGraph::PointOctreeFile POF;
+typedef POF::Point OPoint;
+
+/**************************************************
+Helper class to partition points along one axis:
+**************************************************/
+
+class IsBelow
+	{
+	/* Elements: */
+	private:
+	int axis; // Partitioning axis
+	double value; // Partitioning value
+	
+	/* Constructors and destructors: */
+	public:
+	IsBelow(int sAxis,double sValue)
+		:axis(sAxis),value(sValue)
+		{
+		}
+	
+	/* Methods: */
+	bool operator()(const OPoint& p) const
+		{
+		return double(p.position[axis])<value;
+		}
+	};
+
+/*****************************************************
+Class to build octrees from arbitrarily large inputs:
+*****************************************************/
+
+class OctreeBuilder
+	{
+	/* Elements: */
+	private:
+	unsigned int maxNodePoints; // Maximum number of points in any node
+	size_t maxInMemoryPoints; // Maximum number of points to partition in memory
+	unsigned int maxDepth; // Maximum octree depth to protect against duplicate points
+	std::string tempFileNameBase; // Base name for temporary files
+	unsigned int nextTempFileIndex; // Index of the next temporary file
+	std::vector<POF::Node> nodes; // The octree's nodes
+	IO::FilePtr pointFile; // Temporary file receiving node points in the order of their nodes' completion
+	size_t numWrittenPoints; // Number of points written to the point file
+	size_t numDroppedPoints; // Number of points dropped from nodes at maximum depth
+	
+	/* Private methods: */
+	std::string createTempFileName(void) // Returns the name of a new temporary file
+		{
+		char index[16];
+		snprintf(index,sizeof(index),"%u",nextTempFileIndex++);
+		return tempFileNameBase+index;
+		}
+	static void calcChild(const double center[3],double radius,int childIndex,double childCenter[3]) // Calculates the center of the given child of a node
+		{
+		for(int i=0;i<3;++i)
+			childCenter[i]=childIndex&(0x1<<i)?center[i]+radius*0.5:center[i]-radius*0.5;
+		}
+	static void subsample(std::vector<OPoint>& points,size_t maxNumPoints) // Reduces the given point list to a random subset of the given size
+		{
+		if(points.size()>maxNumPoints)
+			{
+			for(size_t i=0;i<maxNumPoints;++i)
+				std::swap(points[i],points[i+size_t(rand())%(points.size()-i)]);
+			points.resize(maxNumPoints);
+			}
+		}
+	void writeNode(unsigned int nodeIndex,const std::vector<OPoint>& points) // Writes the given points as the given node's points
+		{
+		nodes[nodeIndex].firstPoint=numWrittenPoints;
+		nodes[nodeIndex].numPoints=Misc::UInt32(points.size());
+		if(!points.empty())
+			pointFile->writeRaw(&points[0],points.size()*sizeof(OPoint));
+		numWrittenPoints+=points.size();
+		}
+	unsigned int createChildren(unsigned int nodeIndex) // Creates eight empty children for the given node and returns the index of the first child
+		{
+		unsigned int firstChild=nodes.size();
+		nodes[nodeIndex].firstChild=firstChild;
+		POF::Node empty;
+		empty.firstPoint=0;
+		empty.numPoints=0;
+		empty.firstChild=0;
+		nodes.resize(nodes.size()+8,empty);
+		return firstChild;
+		}
+	void finishInteriorNode(unsigned int nodeIndex,std::vector<OPoint> childLods[8],std::vector<OPoint>& lod) // Creates an interior node's points from its children's points
+		{
+		for(int i=0;i<8;++i)
+			lod.insert(lod.end(),childLods[i].begin(),childLods[i].end());
+		subsample(lod,maxNodePoints);
+		writeNode(nodeIndex,lod);
+		}
+	void buildInMemory(unsigned int nodeIndex,OPoint* begin,OPoint* end,const double center[3],double radius,unsigned int depth,std::vector<OPoint>& lod); // Builds the subtree of the given node from the given in-memory points and returns the node's points
+	void buildOutOfCore(unsigned int nodeIndex,const std::string& fileName,size_t numPoints,const double center[3],double radius,unsigned int depth,std::vector<OPoint>& lod); // Ditto, from points in the given temporary file, which is deleted
+	
+	/* Constructors and destructors: */
+	public:
+	OctreeBuilder(unsigned int sMaxNodePoints,size_t sMaxInMemoryPoints,const std::string& sTempFileNameBase)
+		:maxNodePoints(sMaxNodePoints),maxInMemoryPoints(sMaxInMemoryPoints),maxDepth(32),
+		 tempFileNameBase(sTempFileNameBase),nextTempFileIndex(0),
+		 numWrittenPoints(0),numDroppedPoints(0)
+		{
+		}
+	
+	/* Methods: */
+	std::string createPointFile(void) // Creates a new temporary file to receive points and returns its name
+		{
+		return createTempFileName();
+		}
+	std::string build(const std::string& inputFileName,size_t numPoints,const double center[3],double radius); // Builds an octree from points in the given temporary file, which is deleted; returns the name of the temporary file containing node points
+	const std::vector<POF::Node>& getNodes(void) const
+		{
+		return nodes;
+		}
+	size_t getNumWrittenPoints(void) const
+		{
+		return numWrittenPoints;
+		}
+	size_t getNumDroppedPoints(void) const
+		{
+		return numDroppedPoints;
+		}
+	};
+
+void OctreeBuilder::buildInMemory(unsigned int nodeIndex,OPoint* begin,OPoint* end,const double center[3],double radius,unsigned int depth,std::vector<OPoint>& lod)
+	{
+	size_t numPoints=end-begin;
+	if(numPoints<=maxNodePoints||depth>=maxDepth)
+		{
+		/* Create a leaf node: */
+		lod.assign(begin,end);
+		if(lod.size()>maxNodePoints)
+			{
+			numDroppedPoints+=lod.size()-maxNodePoints;
+			subsample(lod,maxNodePoints);
+			}
+		writeNode(nodeIndex,lod);
+		return;
+		}
+	
+	/* Partition the points into octants: */
+	OPoint* splits[9];
+	splits[0]=begin;
+	splits[8]=end;
+	splits[4]=std::partition(splits[0],splits[8],IsBelow(2,center[2]));
+	for(int i=0;i<8;i+=4)
+		splits[i+2]=std::partition(splits[i],splits[i+4],IsBelow(1,center[1]));
+	for(int i=0;i<8;i+=2)
+		splits[i+1]=std::partition(splits[i],splits[i+2],IsBelow(0,center[0]));
+	
+	/* Build the children: */
+	unsigned int firstChild=createChildren(nodeIndex);
+	std::vector<OPoint> childLods[8];
+	for(int i=0;i<8;++i)
+		{
+		double childCenter[3];
+		calcChild(center,radius,i,childCenter);
+		buildInMemory(firstChild+i,splits[i],splits[i+1],childCenter,radius*0.5,depth+1,childLods[i]);
+		}
+	
+	finishInteriorNode(nodeIndex,childLods,lod);
+	}
+
+void OctreeBuilder::buildOutOfCore(unsigned int nodeIndex,const std::string& fileName,size_t numPoints,const double center[3],double radius,unsigned int depth,std::vector<OPoint>& lod)
+	{
+	if(numPoints<=maxInMemoryPoints||depth>=maxDepth)
+		{
+		/* Read the points into memory and continue there: */
+		std::vector<OPoint> points(numPoints);
+		{
+		IO::FilePtr file(IO::openFile(fileName.c_str()));
+		if(numPoints>0)
+			file->readRaw(&points[0],numPoints*sizeof(OPoint));
+		}
+		unlink(fileName.c_str());
+		OPoint* pBegin=numPoints>0?&points[0]:0;
+		buildInMemory(nodeIndex,pBegin,pBegin+numPoints,center,radius,depth,lod);
+		return;
+		}
+	
+	/* Distribute the points into one temporary file per octant: */
+	std::string childFileNames[8];
+	size_t childNumPoints[8];
+	{
+	IO::FilePtr childFiles[8];
+	for(int i=0;i<8;++i)
+		{
+		childFileNames[i]=createTempFileName();
+		childFiles[i]=IO::openFile(childFileNames[i].c_str(),IO::File::WriteOnly);
+		childNumPoints[i]=0;
+		}
+	IO::FilePtr file(IO::openFile(fileName.c_str()));
+	std::vector<OPoint> buffer(65536);
+	for(size_t pointsLeft=numPoints;pointsLeft>0;)
+		{
+		size_t readSize=std::min(pointsLeft,buffer.size());
+		file->readRaw(&buffer[0],readSize*sizeof(OPoint));
+		for(size_t i=0;i<readSize;++i)
+			{
+			int childIndex=0;
+			for(int j=0;j<3;++j)
+				if(double(buffer[i].position[j])>=center[j])
+					childIndex|=0x1<<j;
+			childFiles[childIndex]->writeRaw(&buffer[i],sizeof(OPoint));
+			++childNumPoints[childIndex];
+			}
+		pointsLeft-=readSize;
+		}
+	}
+	unlink(fileName.c_str());
+	
+	/* Build the children: */
+	unsigned int firstChild=createChildren(nodeIndex);
+	std::vector<OPoint> childLods[8];
+	for(int i=0;i<8;++i)
+		{
+		double childCenter[3];
+		calcChild(center,radius,i,childCenter);
+		buildOutOfCore(firstChild+i,childFileNames[i],childNumPoints[i],childCenter,radius*0.5,depth+1,childLods[i]);
+		}
+	
+	finishInteriorNode(nodeIndex,childLods,lod);
+	}
+
+std::string OctreeBuilder::build(const std::string& inputFileName,size_t numPoints,const double center[3],double radius)
+	{
+	/* Create the root node: */
+	nodes.clear();
+	POF::Node root;
+	root.firstPoint=0;
+	root.numPoints=0;
+	root.firstChild=0;
+	nodes.push_back(root);
+	
+	/* Build the octree: */
+	std::string pointFileName=createTempFileName();
+	pointFile=IO::openFile(pointFileName.c_str(),IO::File::WriteOnly);
+	numWrittenPoints=0;
+	std::vector<OPoint> lod;
+	buildOutOfCore(0,inputFileName,numPoints,center,radius,0,lod);
+	pointFile=0;
+	
+	return pointFileName;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	std::vector<const char*> inputFileNames;
+	const char* outputFileName=0;
+	unsigned int maxNodePoints=4096;
+	size_t memorySize=1024;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-o")==0&&i+1<argc)
+			outputFileName=argv[++i];
+		else if(strcasecmp(argv[i],"-nodeSize")==0&&i+1<argc)
+			maxNodePoints=(unsigned int)(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-memory")==0&&i+1<argc)
+			memorySize=size_t(atoi(argv[++i]));
+		else
+			inputFileNames.push_back(argv[i]);
+		}
+	if(inputFileNames.empty()||outputFileName==0)
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" [-nodeSize <max points per node>] [-memory <memory size in MB>] -o <output octree file name> <input file name> [<input file name> ...]"<<std::endl;
+		std::cerr<<"Input files contain one point per line as x y z [r g b], with color components in the range 0-255"<<std::endl;
+		return 1;
+		}
+	if(maxNodePoints<8||memorySize<1)
+		{
+		std::cerr<<"Invalid octree parameters"<<std::endl;
+		return 1;
+		}
+	#if __BYTE_ORDER!=__LITTLE_ENDIAN
+	std::cerr<<"Point octrees can only be created on little-endian hosts"<<std::endl;
+	return 1;
+	#endif
+	size_t maxInMemoryPoints=std::max((memorySize<<20)/sizeof(OPoint),size_t(maxNodePoints)*8);
+	
+	try
+		{
+		OctreeBuilder builder(maxNodePoints,maxInMemoryPoints,std::string(outputFileName)+".tmp");
+		
+		/* Read all input points into a temporary file, relative to the first point: */
+		std::string rawFileName=builder.createPointFile();
+		size_t numPoints=0;
+		double offset[3]={0.0,0.0,0.0};
+		double bbMin[3],bbMax[3];
+		{
+		IO::FilePtr rawFile(IO::openFile(rawFileName.c_str(),IO::File::WriteOnly));
+		for(std::vector<const char*>::iterator ifnIt=inputFileNames.begin();ifnIt!=inputFileNames.end();++ifnIt)
+			{
+			std::cout<<"Reading points from "<<*ifnIt<<"..."<<std::flush;
+			IO::ValueSource source(IO::openFile(*ifnIt));
+			source.setWhitespace(',',true);
+			source.setWhitespace('\n',false);
+			source.setPunctuation('\n',true);
+			source.skipWs();
+			size_t numFilePoints=0;
+			while(!source.eof())
+				{
+				try
+					{
+					/* Read the point position: */
+					double pos[3];
+					for(int i=0;i<3;++i)
+						pos[i]=source.readNumber();
+					
+					/* Read the optional point color: */
+					OPoint p;
+					for(int i=0;i<3;++i)
+						p.color[i]=255;
+					p.color[3]=255;
+					if(!source.eof()&&source.peekc()!='\n')
+						for(int i=0;i<3;++i)
+							p.color[i]=Misc::UInt8(std::max(0,std::min(source.readInteger(),255)));
+					
+					/* Store the point relative to the first point: */
+					if(numPoints==0)
+						{
+						for(int i=0;i<3;++i)
+							{
+							offset[i]=pos[i];
+							bbMin[i]=bbMax[i]=0.0;
+							}
+						}
+					for(int i=0;i<3;++i)
+						{
+						p.position[i]=Misc::Float32(pos[i]-offset[i]);
+						bbMin[i]=std::min(bbMin[i],double(p.position[i]));
+						bbMax[i]=std::max(bbMax[i],double(p.position[i]));
+						}
+					rawFile->writeRaw(&p,sizeof(OPoint));
+					++numPoints;
+					++numFilePoints;
+					}
+				catch(const IO::ValueSource::NumberError&)
+					{
+					/* Ignore malformed lines: */
+					}
+				
+				/* Go to the next line: */
+				source.skipLine();
+				source.skipWs();
+				}
+			std::cout<<" done, "<<numFilePoints<<" points"<<std::endl;
+			}
+		}
+		if(numPoints==0)
+			{
+			unlink(rawFileName.c_str());
+			std::cerr<<"No points in input files"<<std::endl;
+			return 1;
+			}
+		
+		/* Calculate the root node's cube, enlarged slightly to keep all points strictly inside: */
+		double center[3];
+		double radius=0.0;
+		for(int i=0;i<3;++i)
+			{
+			center[i]=(bbMin[i]+bbMax[i])*0.5;
+			radius=std::max(radius,(bbMax[i]-bbMin[i])*0.5);
+			}
+		radius=radius*1.001+1.0e-6;
+		
+		/* Build the octree: */
+		std::cout<<"Building octree from "<<numPoints<<" points..."<<std::flush;
+		std::string pointFileName=builder.build(rawFileName,numPoints,center,radius);
+		std::cout<<" done, "<<builder.getNodes().size()<<" nodes"<<std::endl;
+		if(builder.getNumDroppedPoints()>0)
+			std::cout<<"Dropped "<<builder.getNumDroppedPoints()<<" points from overfull nodes at maximum octree depth"<<std::endl;
+		
+		/* Write the octree file header and nodes: */
+		const std::vector<POF::Node>& nodes=builder.getNodes();
+		Misc::UInt64 nodeOffset=sizeof(POF::magic)+2*sizeof(Misc::UInt32)+7*sizeof(Misc::Float64)+4*sizeof(Misc::UInt64);
+		Misc::UInt64 pointOffset=nodeOffset+nodes.size()*sizeof(POF::Node);
+		pointOffset=(pointOffset+4095)&~Misc::UInt64(4095);
+		IO::FilePtr file(IO::openFile(outputFileName,IO::File::WriteOnly));
+		file->setEndianness(Misc::LittleEndian);
+		file->write(POF::magic,sizeof(POF::magic));
+		file->write<Misc::UInt32>(maxNodePoints);
+		file->write<Misc::UInt32>(0);
+		file->write<Misc::Float64>(offset,3);
+		file->write<Misc::Float64>(center,3);
+		file->write<Misc::Float64>(radius);
+		file->write<Misc::UInt64>(nodes.size());
+		file->write<Misc::UInt64>(builder.getNumWrittenPoints());
+		file->write<Misc::UInt64>(nodeOffset);
+		file->write<Misc::UInt64>(pointOffset);
+		file->writeRaw(&nodes[0],nodes.size()*sizeof(POF::Node));
+		for(Misc::UInt64 pad=nodeOffset+nodes.size()*sizeof(POF::Node);pad<pointOffset;++pad)
+			file->write<Misc::UInt8>(0);
+		
+		/* Copy the node points: */
+		{
+		IO::FilePtr pointFile(IO::openFile(pointFileName.c_str()));
+		std::vector<char> buffer(1<<20);
+		size_t readSize;
+		while((readSize=pointFile->readUpTo(&buffer[0],buffer.size()))>0)
+			file->writeRaw(&buffer[0],readSize);
+		}
+		unlink(pointFileName.c_str());
+		
+		std::cout<<"Wrote "<<builder.getNumWrittenPoints()<<" points in "<<nodes.size()<<" nodes to "<<outputFileName<<std::endl;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Unable to create point octree due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,475 @@
+/***********************************************************************
+MakeTerrainTilePyramid - Program to convert elevation grids in BIL
+format into multi-resolution terrain tile pyramids for view-dependent
+rendering by ElevationGrid nodes.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include <Misc/SizedTypes.h>
+#include <Misc/Endianness.h>
+#include <Misc/ThrowStdErr.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <IO/MemMappedFile.h>
+#include <IO/ValueSource.h>
+#include <Math/Math.h>
+#include <SceneGraph/Internal/TerrainTilePyramid.h>
+
+typedef SceneGraph::TerrainTilePyramid TTP;
+
+struct Grid // Structure accessing a full-resolution elevation grid through a memory map of its BIL image file
+	{
+	/* Elements: */
+	public:
+	unsigned int size[2]; // Number of samples in x and y
+	double origin[2]; // Map coordinates of the first sample
+	double cellSize[2]; // Distance between adjacent samples in x and y
+	bool haveInvalids; // Flag whether the grid has a no-data value
+	float invalidHeight; // The grid's no-data value
+	IO::FilePtr imageFile; // The memory-mapped BIL image file
+	const char* samples; // Pointer to the image's first sample, i.e., the first sample of the grid's top row
+	size_t rowBytes; // Distance between adjacent image rows in bytes
+	bool floatSamples; // Flag whether samples are 32-bit floats instead of 16-bit signed integers
+	bool swapSamples; // Flag whether samples must be endianness-swapped
+	
+	/* Methods: */
+	float operator()(unsigned int x,unsigned int y) const // Returns the given sample's height; the image stores rows from top to bottom
+		{
+		const char* sPtr=samples+size_t(size[1]-1-y)*rowBytes;
+		if(floatSamples)
+			{
+			Misc::Float32 h;
+			memcpy(&h,sPtr+size_t(x)*sizeof(Misc::Float32),sizeof(Misc::Float32));
+			if(swapSamples)
+				Misc::swapEndianness(h);
+			return h;
+			}
+		else
+			{
+			Misc::SInt16 h;
+			memcpy(&h,sPtr+size_t(x)*sizeof(Misc::SInt16),sizeof(Misc::SInt16));
+			if(swapSamples)
+				Misc::swapEndianness(h);
+			return float(h);
+			}
+		}
+	bool isValid(float h) const // Returns true if the given height is valid
+		{
+		return !haveInvalids||h!=invalidHeight;
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+std::string createHeaderFileName(const std::string& bilFileName)
+	{
+	/* Find the BIL file name's extension: */
+	std::string::const_iterator extPtr=bilFileName.end();
+	for(std::string::const_iterator sPtr=bilFileName.begin();sPtr!=bilFileName.end();++sPtr)
+		if(*sPtr=='.')
+			extPtr=sPtr;
+	
+	/* Create the header file name: */
+	std::string result=std::string(bilFileName.begin(),extPtr);
+	result.append(".hdr");
+	
+	return result;
+	}
+
+void loadBILGrid(const std::string& bilFileName,Grid& grid)
+	{
+	/* Open the header file: */
+	IO::ValueSource header(IO::openFile(createHeaderFileName(bilFileName).c_str()));
+	header.skipWs();
+	
+	/* Parse the header file: */
+	grid.size[0]=grid.size[1]=0;
+	unsigned int numBits=16;
+	unsigned int skipBytes=0;
+	unsigned int bandGapBytes=0;
+	unsigned int bandRowBytes=0;
+	unsigned int totalRowBytes=0;
+	Misc::Endianness endianness=Misc::HostEndianness;
+	double map[2]={0.0,0.0};
+	bool mapIsUpperLeft=false;
+	grid.cellSize[0]=grid.cellSize[1]=1.0;
+	grid.haveInvalids=false;
+	grid.invalidHeight=0.0f;
+	while(!header.eof())
+		{
+		/* Read the next token: */
+		std::string token=header.readString();
+		
+		if(token=="LAYOUT"||token=="INTERLEAVING")
+			{
+			std::string layout=header.readString();
+			if(layout!="BIL"&&layout!="BIP"&&layout!="BSQ")
+				Misc::throwStdErr("File %s has unsupported layout %s",bilFileName.c_str(),layout.c_str());
+			}
+		else if(token=="NBANDS"||token=="BANDS")
+			{
+			unsigned int numBands=header.readUnsignedInteger();
+			if(numBands!=1)
+				Misc::throwStdErr("File %s has %d bands instead of 1",bilFileName.c_str(),numBands);
+			}
+		else if(token=="NCOLS"||token=="COLS")
+			grid.size[0]=header.readUnsignedInteger();
+		else if(token=="NROWS"||token=="ROWS")
+			grid.size[1]=header.readUnsignedInteger();
+		else if(token=="NBITS")
+			{
+			numBits=header.readUnsignedInteger();
+			if(numBits!=16&&numBits!=32)
+				Misc::throwStdErr("File %s has unsupported number of bits per sample %d",bilFileName.c_str(),numBits);
+			}
+		else if(token=="SKIPBYTES")
+			skipBytes=header.readUnsignedInteger();
+		else if(token=="BANDGAPBYTES")
+			bandGapBytes=header.readUnsignedInteger();
+		else if(token=="BANDROWBYTES")
+			bandRowBytes=header.readUnsignedInteger();
+		else if(token=="TOTALROWBYTES")
+			totalRowBytes=header.readUnsignedInteger();
+		else if(token=="BYTE_ORDER"||token=="BYTEORDER")
+			{
+			std::string byteOrder=header.readString();
+			if(byteOrder=="LSBFIRST"||byteOrder=="I")
+				endianness=Misc::LittleEndian;
+			else if(byteOrder=="MSBFIRST"||byteOrder=="M")
+				endianness=Misc::BigEndian;
+			else
+				Misc::throwStdErr("File %s has unrecognized byte order %s",bilFileName.c_str(),byteOrder.c_str());
+			}
+		else if(token=="ULXMAP"||token=="UL_X_COORDINATE")
+			{
+			map[0]=header.readNumber();
+			mapIsUpperLeft=true;
+			}
+		else if(token=="ULYMAP"||token=="UL_Y_COORDINATE")
+			{
+			map[1]=header.readNumber();
+			mapIsUpperLeft=true;
+			}
+		else if(token=="XLLCORNER")
+			{
+			map[0]=header.readNumber();
+			mapIsUpperLeft=false;
+			}
+		else if(token=="YLLCORNER")
+			{
+			map[1]=header.readNumber();
+			mapIsUpperLeft=false;
+			}
+		else if(token=="XDIM")
+			grid.cellSize[0]=header.readNumber();
+		else if(token=="YDIM")
+			grid.cellSize[1]=header.readNumber();
+		else if(token=="CELLSIZE")
+			grid.cellSize[0]=grid.cellSize[1]=header.readNumber();
+		else if(token=="NODATA_VALUE"||token=="NODATA")
+			{
+			grid.haveInvalids=true;
+			grid.invalidHeight=float(header.readNumber());
+			}
+		}
+	
+	/* Check the image layout: */
+	if(grid.size[0]<2||grid.size[1]<2)
+		Misc::throwStdErr("File %s has undefined or degenerate image size",bilFileName.c_str());
+	unsigned int numBytes=(numBits+7)/8;
+	if(totalRowBytes!=bandRowBytes||bandRowBytes!=grid.size[0]*numBytes)
+		Misc::throwStdErr("File %s has mismatching row size",bilFileName.c_str());
+	if(bandGapBytes!=0)
+		Misc::throwStdErr("File %s has nonzero band gap",bilFileName.c_str());
+	
+	/* Calculate the map coordinates of the first sample in the same way as ElevationGrid nodes: */
+	for(int i=0;i<2;++i)
+		grid.origin[i]=map[i]+grid.cellSize[i]*0.5;
+	if(mapIsUpperLeft)
+		grid.origin[1]-=double(grid.size[1])*grid.cellSize[1];
+	
+	/* Memory-map the image instead of reading it, so that grids larger than main memory can be processed: */
+	IO::MemMappedFile* imageFile=new IO::MemMappedFile(bilFileName.c_str());
+	grid.imageFile=imageFile;
+	grid.rowBytes=size_t(totalRowBytes);
+	if(IO::SeekableFile::Offset(skipBytes)+IO::SeekableFile::Offset(grid.rowBytes*size_t(grid.size[1]))>imageFile->getSize())
+		Misc::throwStdErr("File %s is truncated",bilFileName.c_str());
+	grid.samples=static_cast<const char*>(imageFile->getMemory())+skipBytes;
+	grid.floatSamples=numBits==32;
+	
+	/* Samples only need to be swapped if they are big-endian, as tile pyramids are only created on little-endian hosts: */
+	grid.swapSamples=endianness==Misc::BigEndian;
+	}
+
+/**************************************************************
+Helper class to evaluate the layout of tiles of a pyramid level:
+**************************************************************/
+
+class TileLayout
+	{
+	/* Elements: */
+	private:
+	const Grid& grid;
+	unsigned int tileSize;
+	const TTP::Level& level;
+	
+	/* Constructors and destructors: */
+	public:
+	TileLayout(const Grid& sGrid,unsigned int sTileSize,const TTP::Level& sLevel)
+		:grid(sGrid),tileSize(sTileSize),level(sLevel)
+		{
+		}
+	
+	/* Methods: */
+	unsigned int getSampleIndex(unsigned int tileCoord,unsigned int sample,int dimension) const // Same as TerrainTilePyramid::getSampleIndex
+		{
+		unsigned int result=(tileCoord*(tileSize-1)+sample)*level.step;
+		return result<grid.size[dimension]-1?result:grid.size[dimension]-1;
+		}
+	unsigned int getNumSamples(unsigned int tileCoord,int dimension) const // Returns the number of samples of the given tile that lie inside the grid
+		{
+		/* The level's last cell is clamped to the grid's last sample: */
+		unsigned int numCells=(grid.size[dimension]-2)/level.step+1;
+		unsigned int result=numCells-tileCoord*(tileSize-1)+1;
+		return result<tileSize?result:tileSize;
+		}
+	};
+
+TTP::Tile calcTile(const Grid& grid,unsigned int tileSize,const TTP::Level& level,const unsigned int tileCoords[2])
+	{
+	TileLayout layout(grid,tileSize,level);
+	TTP::Tile result;
+	unsigned int numSamples[2];
+	std::vector<unsigned int> sampleIndices[2];
+	for(int i=0;i<2;++i)
+		{
+		numSamples[i]=layout.getNumSamples(tileCoords[i],i);
+		result.size[i]=Misc::UInt16(numSamples[i]);
+		for(unsigned int s=0;s<numSamples[i];++s)
+			sampleIndices[i].push_back(layout.getSampleIndex(tileCoords[i],s,i));
+		}
+	
+	/* Compare all full-resolution samples covered by the tile against the tile's triangulation: */
+	float minHeight=0.0f,maxHeight=0.0f;
+	bool empty=true;
+	float error=0.0f;
+	for(unsigned int cz=0;cz<numSamples[1]-1;++cz)
+		for(unsigned int cx=0;cx<numSamples[0]-1;++cx)
+			{
+			/* Get the cell's corner heights: */
+			unsigned int x0=sampleIndices[0][cx];
+			unsigned int x1=sampleIndices[0][cx+1];
+			unsigned int z0=sampleIndices[1][cz];
+			unsigned int z1=sampleIndices[1][cz+1];
+			float h0=grid(x0,z0);
+			float h1=grid(x1,z0);
+			float h2=grid(x1,z1);
+			float h3=grid(x0,z1);
+			bool cellValid=grid.isValid(h0)&&grid.isValid(h1)&&grid.isValid(h2)&&grid.isValid(h3);
+			
+			/* Process all full-resolution samples inside the cell, including the cell's upper edges only for the tile's last cells: */
+			unsigned int zEnd=cz==numSamples[1]-2?z1+1:z1;
+			unsigned int xEnd=cx==numSamples[0]-2?x1+1:x1;
+			for(unsigned int z=z0;z<zEnd;++z)
+				for(unsigned int x=x0;x<xEnd;++x)
+					{
+					float h=grid(x,z);
+					if(!grid.isValid(h))
+						continue;
+					
+					/* Update the height range: */
+					if(empty)
+						{
+						minHeight=maxHeight=h;
+						empty=false;
+						}
+					else if(minHeight>h)
+						minHeight=h;
+					else if(maxHeight<h)
+						maxHeight=h;
+					
+					/* Interpolate the height in the same triangle the renderer uses: */
+					if(cellValid)
+						{
+						float wx=float(x-x0)/float(x1-x0);
+						float wz=float(z-z0)/float(z1-z0);
+						float hi;
+						if(wx>=wz)
+							hi=h0+wx*(h1-h0)+wz*(h2-h1);
+						else
+							hi=h0+wz*(h3-h0)+wx*(h2-h3);
+						float e=Math::abs(h-hi);
+						if(error<e)
+							error=e;
+						}
+					}
+			}
+	
+	result.minHeight=minHeight;
+	result.maxHeight=maxHeight;
+	result.error=error;
+	return result;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	const char* inputFileName=0;
+	const char* outputFileName=0;
+	unsigned int tileSize=129;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-tileSize")==0&&i+1<argc)
+			tileSize=(unsigned int)(atoi(argv[++i]));
+		else if(inputFileName==0)
+			inputFileName=argv[i];
+		else if(outputFileName==0)
+			outputFileName=argv[i];
+		}
+	if(inputFileName==0||outputFileName==0)
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" [-tileSize <2^n+1>] <input BIL file name> <output tile pyramid file name>"<<std::endl;
+		return 1;
+		}
+	if(tileSize<3||((tileSize-1)&(tileSize-2))!=0||tileSize>65535)
+		{
+		std::cerr<<"Tile size "<<tileSize<<" is not of the form 2^n+1"<<std::endl;
+		return 1;
+		}
+	#if __BYTE_ORDER!=__LITTLE_ENDIAN
+	std::cerr<<"Tile pyramids can only be created on little-endian hosts"<<std::endl;
+	return 1;
+	#endif
+	
+	try
+		{
+		/* Open the elevation grid: */
+		Grid grid;
+		loadBILGrid(inputFileName,grid);
+		std::cout<<"Opened "<<grid.size[0]<<"x"<<grid.size[1]<<" elevation grid"<<std::endl;
+		
+		/* Calculate the pyramid's layout: */
+		std::vector<TTP::Level> levels=TTP::calcLevels(grid.size,tileSize);
+		const TTP::Level& finest=levels.back();
+		size_t numTiles=size_t(finest.firstTile)+size_t(finest.numTiles[0])*size_t(finest.numTiles[1]);
+		
+		/* Calculate the tile directory from the finest to the coarsest level: */
+		std::vector<TTP::Tile> tiles(numTiles);
+		for(unsigned int level=levels.size();level>0;--level)
+			{
+			const TTP::Level& l=levels[level-1];
+			std::cout<<"Processing level "<<level-1<<" with "<<l.numTiles[0]<<"x"<<l.numTiles[1]<<" tiles..."<<std::flush;
+			unsigned int tc[2];
+			for(tc[1]=0;tc[1]<l.numTiles[1];++tc[1])
+				for(tc[0]=0;tc[0]<l.numTiles[0];++tc[0])
+					{
+					TTP::Tile& tile=tiles[l.firstTile+tc[1]*l.numTiles[0]+tc[0]];
+					tile=calcTile(grid,tileSize,l,tc);
+					
+					/* Ensure that a tile's error is never smaller than any of its children's: */
+					if(level<levels.size())
+						{
+						const TTP::Level& cl=levels[level];
+						for(unsigned int cz=tc[1]*2;cz<tc[1]*2+2&&cz<cl.numTiles[1];++cz)
+							for(unsigned int cx=tc[0]*2;cx<tc[0]*2+2&&cx<cl.numTiles[0];++cx)
+								{
+								const TTP::Tile& child=tiles[cl.firstTile+cz*cl.numTiles[0]+cx];
+								if(tile.error<child.error)
+									tile.error=child.error;
+								}
+						}
+					}
+			std::cout<<" done"<<std::endl;
+			}
+		
+		/* Calculate the file layout, aligning the tile data to memory pages: */
+		Misc::UInt64 tileDirectoryOffset=sizeof(TTP::magic)+4*sizeof(Misc::UInt32)+4*sizeof(Misc::Float64)+sizeof(Misc::UInt32)+sizeof(Misc::Float32)+2*sizeof(Misc::UInt64);
+		tileDirectoryOffset+=levels.size()*4*sizeof(Misc::UInt32);
+		Misc::UInt64 tileDataOffset=tileDirectoryOffset+numTiles*sizeof(TTP::Tile);
+		tileDataOffset=(tileDataOffset+4095)&~Misc::UInt64(4095);
+		
+		/* Write the file header and level table: */
+		IO::FilePtr file(IO::openFile(outputFileName,IO::File::WriteOnly));
+		file->setEndianness(Misc::LittleEndian);
+		file->write(TTP::magic,sizeof(TTP::magic));
+		file->write<Misc::UInt32>(tileSize);
+		file->write<Misc::UInt32>(levels.size());
+		file->write<Misc::UInt32>(grid.size,2);
+		file->write<Misc::Float64>(grid.origin,2);
+		file->write<Misc::Float64>(grid.cellSize,2);
+		file->write<Misc::UInt32>(grid.haveInvalids?1:0);
+		file->write<Misc::Float32>(grid.invalidHeight);
+		file->write<Misc::UInt64>(tileDirectoryOffset);
+		file->write<Misc::UInt64>(tileDataOffset);
+		for(std::vector<TTP::Level>::iterator lIt=levels.begin();lIt!=levels.end();++lIt)
+			{
+			file->write<Misc::UInt32>(lIt->numTiles,2);
+			file->write<Misc::UInt32>(lIt->firstTile);
+			file->write<Misc::UInt32>(lIt->step);
+			}
+		
+		/* Write the tile directory: */
+		for(std::vector<TTP::Tile>::iterator tIt=tiles.begin();tIt!=tiles.end();++tIt)
+			{
+			file->write<Misc::Float32>(tIt->minHeight);
+			file->write<Misc::Float32>(tIt->maxHeight);
+			file->write<Misc::Float32>(tIt->error);
+			file->write<Misc::UInt16>(tIt->size,2);
+			}
+		for(Misc::UInt64 pad=tileDirectoryOffset+numTiles*sizeof(TTP::Tile);pad<tileDataOffset;++pad)
+			file->write<Misc::UInt8>(0);
+		
+		/* Write the tile heights from the coarsest to the finest level, replicating edge samples outside the grid: */
+		std::vector<Misc::Float32> tileHeights(size_t(tileSize)*size_t(tileSize));
+		for(std::vector<TTP::Level>::iterator lIt=levels.begin();lIt!=levels.end();++lIt)
+			{
+			TileLayout layout(grid,tileSize,*lIt);
+			for(unsigned int tz=0;tz<lIt->numTiles[1];++tz)
+				for(unsigned int tx=0;tx<lIt->numTiles[0];++tx)
+					{
+					Misc::Float32* thPtr=&tileHeights[0];
+					for(unsigned int z=0;z<tileSize;++z)
+						{
+						unsigned int gz=layout.getSampleIndex(tz,z,1);
+						for(unsigned int x=0;x<tileSize;++x,++thPtr)
+							*thPtr=grid(layout.getSampleIndex(tx,x,0),gz);
+						}
+					file->write<Misc::Float32>(&tileHeights[0],tileHeights.size());
+					}
+			}
+		
+		std::cout<<"Wrote "<<levels.size()<<" levels with "<<numTiles<<" tiles to "<<outputFileName<<std::endl;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Unable to create tile pyramid due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,324 @@
+/***********************************************************************
+MovieCaptureBenchmark - Program to measure the cost of reading movie
+frames back from an OpenGL window synchronously and through pixel
+buffers, and the throughput of encoding image sequences on multiple
+threads.
+Copyright (c) 2018 Oliver Kreylos
+
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <vector>
+#include <Misc/Time.h>
+#include <Misc/Timer.h>
+#include <Misc/FileTests.h>
+#include <Misc/StandardValueCoders.h>
+#include <Misc/ConfigurationFile.h>
+#include <Math/Math.h>
+#include <GL/gl.h>
+#include <GL/GLWindow.h>
+#include <Vrui/Internal/MovieSaver.h>
+#include <Vrui/Internal/ImageSequenceMovieSaver.h>
+
+/**************
+Helper classes:
+**************/
+
+class DiscardingMovieSaver:public Vrui::MovieSaver // Movie saver discarding all frames, to time frame readback in isolation
+	{
+	/* Protected methods from MovieSaver: */
+	protected:
+	virtual void frameWritingThreadMethod(void)
+		{
+		/* Consume frames until cancelled: */
+		while(true)
+			{
+			frames.lockNewValue();
+			waitForNextFrame();
+			}
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	DiscardingMovieSaver(const Misc::ConfigurationFileSection& configFileSection)
+		:Vrui::MovieSaver(configFileSection)
+		{
+		}
+	virtual ~DiscardingMovieSaver(void)
+		{
+		if(!frameWritingThread.isJoined())
+			{
+			/* Stop the frame writing thread while this object is still intact: */
+			frameWritingThread.cancel();
+			frameWritingThread.join();
+			}
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+void renderFrame(unsigned int frameIndex,unsigned int numTriangles)
+	{
+	/* Clear the window to a color changing each frame: */
+	glClearColor(float(frameIndex%64)/64.0f,0.25f,0.5f,1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	
+	/* Draw a fan of overlapping triangles to give the GPU some work: */
+	glBegin(GL_TRIANGLES);
+	for(unsigned int i=0;i<numTriangles;++i)
+		{
+		float a=float(i+frameIndex)*0.01f;
+		glColor3f(float(i%7)/7.0f,float(i%11)/11.0f,float(i%13)/13.0f);
+		glVertex2f(0.0f,0.0f);
+		glVertex2f(Math::cos(a),Math::sin(a));
+		glVertex2f(Math::cos(a+0.5f),Math::sin(a+0.5f));
+		}
+	glEnd();
+	}
+
+void benchmarkReadback(int width,int height,unsigned int numFrames,unsigned int numTriangles)
+	{
+	/* Open a window and disable vertical retrace synchronization to expose readback stalls: */
+	GLWindow window("MovieCaptureBenchmark",GLWindow::WindowPos(width,height),true);
+	window.makeCurrent();
+	window.setVsyncInterval(0);
+	width=window.getWindowWidth();
+	height=window.getWindowHeight();
+	glViewport(0,0,width,height);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+	
+	printf("Frame readback from a %dx%d window, times in ms:\n",width,height);
+	printf("Buffers   Capture avg   Capture max     Frame avg\n");
+	fflush(stdout);
+	
+	/* Compare synchronous readback against rings of pixel buffers of different sizes: */
+	static const unsigned int numReadbackBuffers[]={0,2,3,4};
+	for(int bi=0;bi<4;++bi)
+		{
+		Misc::ConfigurationFile configFile;
+		Misc::ConfigurationFileSection cfg=configFile.getCurrentSection();
+		cfg.storeValue<unsigned int>("./movieNumReadbackBuffers",numReadbackBuffers[bi]);
+		DiscardingMovieSaver movieSaver(cfg);
+		
+		/* Render and capture frames, skipping the first few to let the pixel buffer ring fill up: */
+		unsigned int numWarmupFrames=10;
+		double captureTime=0.0;
+		double maxCaptureTime=0.0;
+		Misc::Timer frameTimer;
+		for(unsigned int frame=0;frame<numWarmupFrames+numFrames;++frame)
+			{
+			if(frame==numWarmupFrames)
+				frameTimer.elapse();
+			renderFrame(frame,numTriangles);
+			Misc::Timer captureTimer;
+			movieSaver.captureFrame(width,height);
+			captureTimer.elapse();
+			window.swapBuffers();
+			if(frame>=numWarmupFrames)
+				{
+				captureTime+=captureTimer.getTime();
+				maxCaptureTime=Math::max(maxCaptureTime,captureTimer.getTime());
+				}
+			}
+		glFinish();
+		frameTimer.elapse();
+		movieSaver.releaseGL();
+		
+		if(numReadbackBuffers[bi]>0)
+			printf("%7u  ",numReadbackBuffers[bi]);
+		else
+			printf("   sync  ");
+		printf("%12.3f  %12.3f  %12.3f\n",captureTime*1.0e3/double(numFrames),maxCaptureTime*1.0e3,frameTimer.getTime()*1.0e3/double(numFrames));
+		fflush(stdout);
+		}
+	}
+
+unsigned int countAndRemoveFrames(const char* frameNameTemplate)
+	{
+	/* Count the image files written in sequence, removing them along the way: */
+	unsigned int numFrames=0;
+	while(true)
+		{
+		char frameName[1024];
+		snprintf(frameName,sizeof(frameName),frameNameTemplate,numFrames);
+		if(!Misc::isPathFile(frameName))
+			break;
+		unlink(frameName);
+		++numFrames;
+		}
+	
+	return numFrames;
+	}
+
+bool benchmarkEncoding(int width,int height,unsigned int numFrames,double frameRate,const char* frameNameTemplate,unsigned int maxNumThreads)
+	{
+	/* Create a few frames with smooth gradients and some noise, to compress like rendered images: */
+	std::vector<unsigned char*> frameImages;
+	size_t frameSize=size_t(width)*size_t(height)*3;
+	for(int i=0;i<4;++i)
+		{
+		unsigned char* image=new unsigned char[frameSize];
+		unsigned char* iPtr=image;
+		for(int y=0;y<height;++y)
+			for(int x=0;x<width;++x,iPtr+=3)
+				{
+				int noise=rand()%16;
+				iPtr[0]=(unsigned char)((x*255)/width);
+				iPtr[1]=(unsigned char)((y*255)/height);
+				iPtr[2]=(unsigned char)((i*64+noise)&0xff);
+				}
+		frameImages.push_back(image);
+		}
+	
+	printf("Encoding %u frames of %dx%d pixels captured at %.1f Hz:\n",numFrames,width,height,frameRate);
+	printf("Threads  Written  Dropped  Skipped  Queued  Encode avg (ms)  Drain (s)  Frames/s\n");
+	fflush(stdout);
+	
+	bool allValid=true;
+	for(unsigned int numThreads=1;numThreads<=maxNumThreads;numThreads*=2)
+		{
+		Misc::ConfigurationFile configFile;
+		Misc::ConfigurationFileSection cfg=configFile.getCurrentSection();
+		cfg.storeValue<double>("./movieFrameRate",frameRate);
+		cfg.storeString("./movieFrameNameTemplate",frameNameTemplate);
+		cfg.storeValue<unsigned int>("./movieNumEncoderThreads",numThreads);
+		Vrui::ImageSequenceMovieSaver* movieSaver=new Vrui::ImageSequenceMovieSaver(cfg);
+		
+		/* Post frames at the movie frame rate, as a window would while recording: */
+		Misc::Timer totalTimer;
+		Misc::Time frameInterval(1.0/frameRate);
+		Misc::Time nextFrameTime=Misc::Time::now();
+		for(unsigned int frame=0;frame<numFrames;++frame)
+			{
+			Vrui::MovieSaver::FrameBuffer& frameBuffer=movieSaver->startNewFrame();
+			frameBuffer.setFrameSize(width,height);
+			frameBuffer.prepareWrite();
+			memcpy(frameBuffer.getBuffer(),frameImages[frame%frameImages.size()],frameSize);
+			movieSaver->postNewFrame();
+			
+			nextFrameTime+=frameInterval;
+			Misc::Time now=Misc::Time::now();
+			if(now<nextFrameTime)
+				Misc::sleep(nextFrameTime-now);
+			}
+		
+		/* Get the capture statistics at the end of recording, and wait for all queued frames to be written: */
+		Vrui::MovieSaver::Statistics stats=movieSaver->getStatistics();
+		Misc::Timer drainTimer;
+		delete movieSaver;
+		drainTimer.elapse();
+		totalTimer.elapse();
+		
+		/* Check that all frames were written under consecutive indices despite being encoded out of order: */
+		unsigned int numWritten=countAndRemoveFrames(frameNameTemplate);
+		char extraName[1024];
+		snprintf(extraName,sizeof(extraName),frameNameTemplate,numWritten+1);
+		if(Misc::isPathFile(extraName))
+			{
+			allValid=false;
+			printf("Frame sequence has a gap after frame %u\n",numWritten);
+			}
+		
+		printf("%7u  %7u  %7u  %7u  %6u  %15.2f  %9.2f  %8.2f\n",numThreads,numWritten,stats.numDroppedFrames,stats.numSkippedFrames,stats.numQueuedFrames,stats.averageEncodeTime*1.0e3,drainTimer.getTime(),double(numWritten)/totalTimer.getTime());
+		fflush(stdout);
+		}
+	
+	for(std::vector<unsigned char*>::iterator fiIt=frameImages.begin();fiIt!=frameImages.end();++fiIt)
+		delete[] *fiIt;
+	
+	return allValid;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	bool readback=true;
+	bool encode=true;
+	int width=1920;
+	int height=1080;
+	unsigned int numFrames=60;
+	double frameRate=30.0;
+	unsigned int numTriangles=20000;
+	unsigned int maxNumThreads=8;
+	const char* frameNameTemplate="MovieCaptureBenchmark%06u.png";
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-noReadback")==0)
+			readback=false;
+		else if(strcasecmp(argv[i],"-noEncode")==0)
+			encode=false;
+		else if(strcasecmp(argv[i],"-size")==0&&i+2<argc)
+			{
+			width=atoi(argv[++i]);
+			height=atoi(argv[++i]);
+			}
+		else if(strcasecmp(argv[i],"-frames")==0&&i+1<argc)
+			numFrames=(unsigned int)(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-rate")==0&&i+1<argc)
+			frameRate=atof(argv[++i]);
+		else if(strcasecmp(argv[i],"-triangles")==0&&i+1<argc)
+			numTriangles=(unsigned int)(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-maxThreads")==0&&i+1<argc)
+			maxNumThreads=(unsigned int)(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-template")==0&&i+1<argc)
+			frameNameTemplate=argv[++i];
+		else
+			{
+			fprintf(stderr,"Usage: %s [-noReadback] [-noEncode] [-size <width> <height>] [-frames <number of frames>] [-rate <movie frame rate in Hz>] [-triangles <number of triangles per frame>] [-maxThreads <max number of encoder threads>] [-template <frame file name template>]\n",argv[0]);
+			return 1;
+			}
+		}
+	if(width<1||height<1||numFrames<1||frameRate<=0.0||maxNumThreads<1)
+		{
+		fprintf(stderr,"%s: Invalid benchmark parameters\n",argv[0]);
+		return 1;
+		}
+	
+	if(readback)
+		{
+		try
+			{
+			benchmarkReadback(width,height,numFrames,numTriangles);
+			}
+		catch(std::runtime_error err)
+			{
+			/* Carry on with the encoding benchmark: */
+			fprintf(stderr,"Skipping readback benchmark due to exception %s\n",err.what());
+			}
+		}
+	
+	bool valid=true;
+	if(encode)
+		{
+		srand(1);
+		valid=benchmarkEncoding(width,height,numFrames,frameRate,frameNameTemplate,maxNumThreads);
+		}
+	
+	return valid?0:1;
+	}
@@ -0,0 +1,212 @@
+/***********************************************************************
+PointCloudBenchmark - Vrui application to measure frame times and I/O
+rates of out-of-core point cloud rendering along a scripted camera path.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Geometry/Point.h>
+#include <Geometry/OrthogonalTransformation.h>
+#include <SceneGraph/GroupNode.h>
+#include <SceneGraph/ShapeNode.h>
+#include <SceneGraph/PointCloudNode.h>
+#include <Vrui/Vrui.h>
+#include <Vrui/Application.h>
+#include <Vrui/SceneGraphSupport.h>
+
+class PointCloudBenchmark:public Vrui::Application
+	{
+	/* Elements: */
+	private:
+	SceneGraph::GroupNodePointer root; // Root of the benchmark's scene graph
+	SceneGraph::PointCloudNode* pointCloud; // The benchmarked point cloud node
+	Vrui::Point center; // Center of the point cloud's bounding box
+	Vrui::Scalar radius; // Radius of the point cloud's bounding box
+	int numWarmupFrames; // Number of frames to render before measuring
+	int numFrames; // Number of measured frames along the camera path
+	int frameIndex; // Index of the current frame, including warm-up frames
+	std::vector<double> frameTimes; // Measured frame times in seconds
+	double sumRenderedPoints; // Total number of points rendered during measured frames
+	SceneGraph::PointCloudNode::Statistics startStatistics; // Statistics at the beginning of the measurement
+	Misc::Timer timer; // Wall-clock timer for the measurement
+	
+	/* Private methods: */
+	void setCamera(double t); // Sets the navigation transformation for the given position along the camera path in [0, 1]
+	void printResults(void); // Prints the benchmark results
+	
+	/* Constructors and destructors: */
+	public:
+	PointCloudBenchmark(int& argc,char**& argv);
+	
+	/* Methods from Vrui::Application: */
+	virtual void frame(void);
+	virtual void display(GLContextData& contextData) const;
+	virtual void resetNavigation(void);
+	};
+
+/************************************
+Methods of class PointCloudBenchmark:
+************************************/
+
+void PointCloudBenchmark::setCamera(double t)
+	{
+	/* Orbit twice around the point cloud while zooming in and out, and sweep the orbit center across the point cloud to force streaming: */
+	double angle=t*4.0*Math::Constants<double>::pi;
+	double zoom=0.1+0.9*(0.5+0.5*Math::cos(t*6.0*Math::Constants<double>::pi));
+	Vrui::Point orbitCenter=center;
+	orbitCenter[0]+=radius*0.5*Math::sin(t*2.0*Math::Constants<double>::pi);
+	orbitCenter[1]+=radius*0.5*Math::sin(t*4.0*Math::Constants<double>::pi);
+	
+	Vrui::NavTransform nav=Vrui::NavTransform::translateFromOriginTo(Vrui::getDisplayCenter());
+	nav*=Vrui::NavTransform::scale(Vrui::getDisplaySize()/(radius*zoom));
+	nav*=Vrui::NavTransform::rotate(Vrui::Rotation::rotateX(-Math::rad(60.0)));
+	nav*=Vrui::NavTransform::rotate(Vrui::Rotation::rotateZ(angle));
+	nav*=Vrui::NavTransform::translateToOriginFrom(orbitCenter);
+	Vrui::setNavigationTransformation(nav);
+	}
+
+void PointCloudBenchmark::printResults(void)
+	{
+	timer.elapse();
+	double elapsed=timer.getTime();
+	SceneGraph::PointCloudNode::Statistics endStatistics=pointCloud->getStatistics();
+	
+	/* Calculate frame time statistics: */
+	std::vector<double> sorted=frameTimes;
+	std::sort(sorted.begin(),sorted.end());
+	double sum=0.0;
+	for(std::vector<double>::iterator ftIt=sorted.begin();ftIt!=sorted.end();++ftIt)
+		sum+=*ftIt;
+	size_t n=sorted.size();
+	
+	printf("Frames: %u in %.3f s\n",(unsigned int)(n),elapsed);
+	printf("Frame time (ms): mean %.3f, median %.3f, 95th percentile %.3f, max %.3f\n",sum*1000.0/double(n),sorted[n/2]*1000.0,sorted[(n*95)/100]*1000.0,sorted[n-1]*1000.0);
+	printf("Rendered points per frame: %.0f\n",sumRenderedPoints/double(n));
+	double loadedMB=double(endStatistics.numLoadedBytes-startStatistics.numLoadedBytes)/(1024.0*1024.0);
+	double uploadedMB=double(endStatistics.numUploadedBytes-startStatistics.numUploadedBytes)/(1024.0*1024.0);
+	printf("Loaded nodes: %u, %.3f MB, %.3f MB/s\n",(unsigned int)(endStatistics.numLoadedNodes-startStatistics.numLoadedNodes),loadedMB,loadedMB/elapsed);
+	printf("Uploaded: %.3f MB, %.3f MB/s\n",uploadedMB,uploadedMB/elapsed);
+	fflush(stdout);
+	}
+
+PointCloudBenchmark::PointCloudBenchmark(int& argc,char**& argv)
+	:Vrui::Application(argc,argv),
+	 pointCloud(0),
+	 numWarmupFrames(30),numFrames(1000),frameIndex(0),
+	 sumRenderedPoints(0.0)
+	{
+	/* Parse the command line: */
+	const char* octreeFileName=0;
+	int pointBudget=-1;
+	double pointSize=-1.0;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-frames")==0&&i+1<argc)
+			numFrames=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-warmup")==0&&i+1<argc)
+			numWarmupFrames=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-budget")==0&&i+1<argc)
+			pointBudget=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-pointSize")==0&&i+1<argc)
+			pointSize=atof(argv[++i]);
+		else if(octreeFileName==0)
+			octreeFileName=argv[i];
+		}
+	if(octreeFileName==0||numFrames<1||numWarmupFrames<0)
+		throw std::runtime_error("Usage: PointCloudBenchmark [-frames <number of frames>] [-warmup <number of frames>] [-budget <point budget>] [-pointSize <point size>] <point octree file name>");
+	
+	/* Create the scene graph: */
+	root=new SceneGraph::GroupNode;
+	SceneGraph::ShapeNode* shape=new SceneGraph::ShapeNode;
+	root->children.appendValue(shape);
+	pointCloud=new SceneGraph::PointCloudNode;
+	shape->geometry.setValue(pointCloud);
+	pointCloud->url.appendValue(octreeFileName);
+	if(pointBudget>=0)
+		pointCloud->pointBudget.setValue(pointBudget);
+	if(pointSize>0.0)
+		pointCloud->pointSize.setValue(pointSize);
+	pointCloud->update();
+	shape->update();
+	root->update();
+	
+	/* Calculate the camera path's parameters: */
+	SceneGraph::Box bbox=pointCloud->calcBoundingBox();
+	center=Vrui::Point(Geometry::mid(bbox.min,bbox.max));
+	radius=Vrui::Scalar(Geometry::dist(bbox.min,bbox.max))*Vrui::Scalar(0.5);
+	frameTimes.reserve(numFrames);
+	}
+
+void PointCloudBenchmark::frame(void)
+	{
+	if(frameIndex==numWarmupFrames)
+		{
+		/* Start measuring: */
+		startStatistics=pointCloud->getStatistics();
+		timer.elapse();
+		}
+	else if(frameIndex>numWarmupFrames)
+		{
+		/* Record the previous frame: */
+		frameTimes.push_back(Vrui::getFrameTime());
+		sumRenderedPoints+=double(pointCloud->getStatistics().numRenderedPoints);
+		if(int(frameTimes.size())==numFrames)
+			{
+			printResults();
+			Vrui::shutdown();
+			return;
+			}
+		}
+	
+	/* Move the camera along the path, starting after the warm-up frames: */
+	setCamera(frameIndex>numWarmupFrames?double(frameIndex-numWarmupFrames)/double(numFrames):0.0);
+	++frameIndex;
+	
+	/* Render continuously: */
+	Vrui::scheduleUpdate(Vrui::getApplicationTime());
+	}
+
+void PointCloudBenchmark::display(GLContextData& contextData) const
+	{
+	/* Save OpenGL state: */
+	glPushAttrib(GL_ENABLE_BIT|GL_LIGHTING_BIT|GL_POINT_BIT|GL_TEXTURE_BIT);
+	
+	/* Render the point cloud: */
+	Vrui::renderSceneGraph(root.getPointer(),true,contextData);
+	
+	/* Restore OpenGL state: */
+	glPopAttrib();
+	}
+
+void PointCloudBenchmark::resetNavigation(void)
+	{
+	setCamera(0.0);
+	}
+
+VRUI_APPLICATION_RUN(PointCloudBenchmark)
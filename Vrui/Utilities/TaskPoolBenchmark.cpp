@@ -0,0 +1,137 @@
+/***********************************************************************
+TaskPoolBenchmark - Program to measure how parallel image processing
+operations using the Threads library's global task pool scale with the
+number of processor cores.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <Misc/Timer.h>
+#include <Threads/TaskPool.h>
+#include <Images/BaseImage.h>
+
+/****************
+Helper functions:
+****************/
+
+double timeOperation(const Images::BaseImage& image,int operation,int numIterations)
+	{
+	/* Run the operation once to warm up caches and start the worker threads: */
+	Images::BaseImage result;
+	
+	Misc::Timer t;
+	for(int i=0;i<=numIterations;++i)
+		{
+		if(i==1)
+			t.elapse();
+		switch(operation)
+			{
+			case 0:
+				result=image.toGrey();
+				break;
+			
+			case 1:
+				result=image.toGrey().toRgb();
+				break;
+			
+			case 2:
+				result=image.shrink();
+				break;
+			}
+		}
+	t.elapse();
+	
+	return t.getTime()*1000.0/double(numIterations);
+	}
+
+void runBenchmark(unsigned int numCores,unsigned int imageSize,int numIterations)
+	{
+	/* Size the global task pool such that the waiting thread plus all workers occupy the given number of cores: */
+	Threads::TaskPool::setGlobalPoolSize(numCores-1);
+	
+	/* Create a test image: */
+	Images::BaseImage image(imageSize,imageSize,3,8,GL_RGB,GL_UNSIGNED_BYTE);
+	unsigned char* pPtr=static_cast<unsigned char*>(image.replacePixels());
+	for(size_t i=size_t(imageSize)*size_t(imageSize)*3;i>0;--i,++pPtr)
+		*pPtr=(unsigned char)(rand());
+	
+	/* Time all operations: */
+	double toGreyTime=timeOperation(image,0,numIterations);
+	double toRgbTime=timeOperation(image,1,numIterations)-toGreyTime;
+	double shrinkTime=timeOperation(image,2,numIterations);
+	printf("%5u  %10.3f  %10.3f  %10.3f\n",numCores,toGreyTime,toRgbTime,shrinkTime);
+	fflush(stdout);
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int maxNumCores=Threads::TaskPool::getNumProcessors();
+	unsigned int imageSize=4096;
+	int numIterations=20;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-cores")==0&&i+1<argc)
+			maxNumCores=(unsigned int)(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-size")==0&&i+1<argc)
+			imageSize=(unsigned int)(atoi(argv[++i]))&~1U;
+		else if(strcasecmp(argv[i],"-iterations")==0&&i+1<argc)
+			numIterations=atoi(argv[++i]);
+		else
+			{
+			fprintf(stderr,"Usage: %s [-cores <max number of cores>] [-size <image size>] [-iterations <number of iterations>]\n",argv[0]);
+			return 1;
+			}
+		}
+	if(maxNumCores<1||imageSize<2||numIterations<1)
+		{
+		fprintf(stderr,"%s: Invalid benchmark parameters\n",argv[0]);
+		return 1;
+		}
+	
+	printf("Times per %ux%u RGB image in ms:\n",imageSize,imageSize);
+	printf("Cores      toGrey       toRgb      shrink\n");
+	fflush(stdout);
+	
+	/* Run the benchmark in a separate process for each number of cores, as the global task pool can only be sized once: */
+	for(unsigned int numCores=1;numCores<=maxNumCores;++numCores)
+		{
+		pid_t childPid=fork();
+		if(childPid==0)
+			{
+			runBenchmark(numCores,imageSize,numIterations);
+			return 0;
+			}
+		else if(childPid>0)
+			waitpid(childPid,0,0);
+		else
+			{
+			fprintf(stderr,"%s: Unable to start benchmark process\n",argv[0]);
+			return 1;
+			}
+		}
+	
+	return 0;
+	}
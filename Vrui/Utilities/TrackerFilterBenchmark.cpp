@@ -0,0 +1,402 @@
+/***********************************************************************
+TrackerFilterBenchmark - Program to compare the smoothing, velocity
+estimation, and prediction quality of VR device daemon tracker filters
+on synthetic tracking data or recorded input device data files.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <Misc/Timer.h>
+#include <Misc/StringMarshaller.h>
+#include <Misc/ConfigurationFile.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+
+#include <VRDeviceDaemon/VRTrackerFilter.h>
+
+typedef VRTrackerFilter::TrackerState TrackerState;
+typedef VRTrackerFilter::Point Point;
+typedef VRTrackerFilter::Vector Vector;
+typedef VRTrackerFilter::Rotation Rotation;
+
+/**************
+Helper classes:
+**************/
+
+struct Sample // Structure for a raw tracker sample
+	{
+	/* Elements: */
+	public:
+	double time; // Sample time in seconds
+	TrackerState state; // Raw tracker state
+	};
+
+struct Pose // Structure for a reference tracker pose
+	{
+	/* Elements: */
+	public:
+	Point position;
+	Rotation orientation;
+	};
+
+/****************
+Helper functions:
+****************/
+
+double gaussian(void)
+	{
+	/* Generate a normally distributed random number using the Box-Muller transform: */
+	double u1=(double(rand())+1.0)/(double(RAND_MAX)+2.0);
+	double u2=double(rand())/double(RAND_MAX);
+	return Math::sqrt(-2.0*Math::log(u1))*Math::cos(2.0*Math::Constants<double>::pi*u2);
+	}
+
+Pose syntheticPose(double t)
+	{
+	/* Move along a Lissajous curve while rotating back and forth: */
+	const double twoPi=2.0*Math::Constants<double>::pi;
+	Pose result;
+	result.position=Point(10.0*Math::sin(twoPi*0.5*t),5.0*Math::sin(twoPi*0.8*t+1.0),3.0*Math::cos(twoPi*0.3*t));
+	result.orientation=Rotation::rotateScaledAxis(Vector(0.8*Math::sin(twoPi*0.4*t),0.5*Math::sin(twoPi*0.7*t),0.6*Math::cos(twoPi*0.2*t)));
+	return result;
+	}
+
+void generateSamples(double rate,double duration,double positionNoise,double orientationNoise,std::vector<Sample>& samples)
+	{
+	size_t numSamples=size_t(Math::floor(rate*duration+0.5));
+	for(size_t i=0;i<numSamples;++i)
+		{
+		/* Add noise to the true pose: */
+		Sample s;
+		s.time=double(i)/rate;
+		Pose p=syntheticPose(s.time);
+		p.position+=Vector(gaussian(),gaussian(),gaussian())*positionNoise;
+		p.orientation.leftMultiply(Rotation::rotateScaledAxis(Vector(gaussian(),gaussian(),gaussian())*orientationNoise));
+		s.state.positionOrientation=TrackerState::PositionOrientation(p.position-Point::origin,p.orientation);
+		s.state.linearVelocity=TrackerState::LinearVelocity::zero;
+		s.state.angularVelocity=TrackerState::AngularVelocity::zero;
+		samples.push_back(s);
+		}
+	}
+
+void readSamples(const char* fileName,int deviceIndex,std::vector<Sample>& samples)
+	{
+	/* Open the input device data file and check its version: */
+	IO::FilePtr file=IO::openFile(fileName);
+	file->setEndianness(Misc::LittleEndian);
+	char header[34];
+	file->read<char>(header,34);
+	header[33]='\0';
+	int fileVersion;
+	if(strcmp(header,"Vrui Input Device Data File v2.0\n")==0)
+		fileVersion=2;
+	else if(strcmp(header,"Vrui Input Device Data File v3.0\n")==0)
+		fileVersion=3;
+	else
+		throw std::runtime_error("Unsupported input device data file version");
+	
+	/* Skip the random seed value: */
+	file->read<unsigned int>();
+	
+	/* Read the device layouts: */
+	int numDevices=file->read<int>();
+	if(deviceIndex<0||deviceIndex>=numDevices)
+		throw std::runtime_error("Invalid input device index");
+	std::vector<int> trackTypes,numButtons,numValuators;
+	for(int i=0;i<numDevices;++i)
+		{
+		Misc::readCppString(*file);
+		trackTypes.push_back(file->read<int>());
+		numButtons.push_back(file->read<int>());
+		numValuators.push_back(file->read<int>());
+		if(fileVersion<3)
+			{
+			/* Skip the device ray direction: */
+			double rayDirection[3];
+			file->read(rayDirection,3);
+			}
+		for(int j=0;j<numButtons[i]+numValuators[i];++j)
+			Misc::readCppString(*file);
+		}
+	if(trackTypes[deviceIndex]==0)
+		throw std::runtime_error("Input device is not tracked");
+	
+	/* Read all data frames: */
+	while(true)
+		{
+		Sample s;
+		try
+			{
+			s.time=file->read<double>();
+			}
+		catch(IO::File::ReadError)
+			{
+			/* At end of file */
+			break;
+			}
+		
+		for(int i=0;i<numDevices;++i)
+			{
+			if(trackTypes[i]!=0)
+				{
+				/* Read the device's tracking state: */
+				if(fileVersion>=3)
+					{
+					/* Skip the device ray: */
+					double rayDirection[3];
+					file->read(rayDirection,3);
+					file->read<double>();
+					}
+				double translation[3],quaternion[4];
+				file->read(translation,3);
+				file->read(quaternion,4);
+				if(i==deviceIndex)
+					s.state.positionOrientation=TrackerState::PositionOrientation(Vector(translation),Rotation::fromQuaternion(quaternion));
+				if(fileVersion>=3)
+					{
+					double linearVelocity[3],angularVelocity[3];
+					file->read(linearVelocity,3);
+					file->read(angularVelocity,3);
+					if(i==deviceIndex)
+						{
+						s.state.linearVelocity=TrackerState::LinearVelocity(linearVelocity);
+						s.state.angularVelocity=TrackerState::AngularVelocity(angularVelocity);
+						}
+					}
+				else if(i==deviceIndex)
+					{
+					s.state.linearVelocity=TrackerState::LinearVelocity::zero;
+					s.state.angularVelocity=TrackerState::AngularVelocity::zero;
+					}
+				}
+			
+			/* Skip button and valuator states: */
+			if(fileVersion>=3)
+				{
+				for(int j=0;j<numButtons[i];j+=8)
+					file->read<unsigned char>();
+				}
+			else
+				{
+				for(int j=0;j<numButtons[i];++j)
+					file->read<int>();
+				}
+			for(int j=0;j<numValuators[i];++j)
+				file->read<double>();
+			}
+		
+		/* Skip duplicate frames: */
+		if(samples.empty()||s.time>samples.back().time)
+			samples.push_back(s);
+		}
+	}
+
+void calcFiniteDifferences(const std::vector<Sample>& samples,std::vector<TrackerState>& states)
+	{
+	/* Estimate velocities from consecutive raw samples: */
+	for(size_t i=0;i<samples.size();++i)
+		{
+		TrackerState s=samples[i].state;
+		if(i>0)
+			{
+			const TrackerState& prev=samples[i-1].state;
+			double dt=samples[i].time-samples[i-1].time;
+			s.linearVelocity=TrackerState::LinearVelocity((Point(s.positionOrientation.getOrigin())-Point(prev.positionOrientation.getOrigin()))/dt);
+			Rotation delta=Rotation(s.positionOrientation.getRotation())*Geometry::invert(Rotation(prev.positionOrientation.getRotation()));
+			s.angularVelocity=TrackerState::AngularVelocity(delta.getScaledAxis()/dt);
+			}
+		else
+			{
+			s.linearVelocity=TrackerState::LinearVelocity::zero;
+			s.angularVelocity=TrackerState::AngularVelocity::zero;
+			}
+		states.push_back(s);
+		}
+	}
+
+Pose interpolateSamples(const std::vector<Sample>& samples,size_t& index,double time)
+	{
+	/* Find the pair of samples bracketing the given time: */
+	while(index+2<samples.size()&&samples[index+1].time<=time)
+		++index;
+	const TrackerState& s0=samples[index].state;
+	const TrackerState& s1=samples[index+1].state;
+	double w=(time-samples[index].time)/(samples[index+1].time-samples[index].time);
+	
+	/* Interpolate position and orientation: */
+	Pose result;
+	result.position=Geometry::affineCombination(Point(s0.positionOrientation.getOrigin()),Point(s1.positionOrientation.getOrigin()),w);
+	Rotation r0(s0.positionOrientation.getRotation());
+	Rotation delta=Rotation(s1.positionOrientation.getRotation())*Geometry::invert(r0);
+	result.orientation=Rotation::rotateScaledAxis(delta.getScaledAxis()*w)*r0;
+	return result;
+	}
+
+void printResults(const char* name,const std::vector<Sample>& samples,const std::vector<TrackerState>& states,double predictionTime,bool synthetic,double nsPerSample)
+	{
+	/* Compare predicted poses against the true or recorded poses: */
+	double positionError2=0.0,orientationError2=0.0;
+	size_t numPredictions=0;
+	double jitter2=0.0;
+	size_t numJitters=0;
+	size_t index=0;
+	Point predicted[3];
+	for(size_t i=0;i<states.size();++i)
+		{
+		/* Extrapolate the tracker state: */
+		const TrackerState& s=states[i];
+		Point p=Point(s.positionOrientation.getOrigin())+Vector(s.linearVelocity)*predictionTime;
+		Rotation o=Rotation::rotateScaledAxis(Vector(s.angularVelocity)*predictionTime)*Rotation(s.positionOrientation.getRotation());
+		
+		/* Accumulate the jitter of the predicted position as its second difference: */
+		predicted[0]=predicted[1];
+		predicted[1]=predicted[2];
+		predicted[2]=p;
+		if(i>=2)
+			{
+			jitter2+=Geometry::sqr((predicted[2]-predicted[1])-(predicted[1]-predicted[0]));
+			++numJitters;
+			}
+		
+		/* Calculate the prediction error: */
+		double t=samples[i].time+predictionTime;
+		if(t<=samples.back().time)
+			{
+			Pose ref=synthetic?syntheticPose(t):interpolateSamples(samples,index,t);
+			positionError2+=Geometry::sqr(ref.position-p);
+			orientationError2+=Math::sqr((ref.orientation*Geometry::invert(o)).getScaledAxis().mag());
+			++numPredictions;
+			}
+		}
+	
+	printf("%-20s %10.1f %14.6f %14.6f %14.6f\n",name,nsPerSample,
+	       Math::sqrt(positionError2/double(numPredictions)),
+	       Math::deg(Math::sqrt(orientationError2/double(numPredictions))),
+	       Math::sqrt(jitter2/double(numJitters)));
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	const char* configFileName=0;
+	const char* logFileName=0;
+	int deviceIndex=0;
+	double predictionTime=0.05;
+	double rate=1000.0;
+	double duration=10.0;
+	double positionNoise=0.02;
+	double orientationNoise=0.002;
+	std::vector<std::string> filterSectionNames;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"log")==0&&i+1<argc)
+				logFileName=argv[++i];
+			else if(strcasecmp(argv[i]+1,"device")==0&&i+1<argc)
+				deviceIndex=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"predict")==0&&i+1<argc)
+				predictionTime=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"rate")==0&&i+1<argc)
+				rate=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"duration")==0&&i+1<argc)
+				duration=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"noise")==0&&i+2<argc)
+				{
+				positionNoise=atof(argv[++i]);
+				orientationNoise=atof(argv[++i]);
+				}
+			else
+				fprintf(stderr,"%s: Ignoring unrecognized option %s\n",argv[0],argv[i]);
+			}
+		else if(configFileName==0)
+			configFileName=argv[i];
+		else
+			filterSectionNames.push_back(argv[i]);
+		}
+	if(configFileName==0||rate<=0.0||duration<=0.0)
+		{
+		fprintf(stderr,"Usage: %s [-log <input device data file> [-device <device index>]] [-rate <sample rate>] [-duration <time>] [-noise <position noise> <orientation noise>] [-predict <prediction time>] <filter configuration file> [<filter section name> ...]\n",argv[0]);
+		return 1;
+		}
+	
+	try
+		{
+		/* Load or generate the raw tracker samples: */
+		std::vector<Sample> samples;
+		bool synthetic=logFileName==0;
+		if(synthetic)
+			generateSamples(rate,duration,positionNoise,orientationNoise,samples);
+		else
+			readSamples(logFileName,deviceIndex,samples);
+		if(samples.size()<3)
+			throw std::runtime_error("Not enough tracker samples");
+		double sampleDuration=samples.back().time-samples.front().time;
+		printf("%u samples over %.3f s (%.1f Hz), predicting %.1f ms ahead\n",(unsigned int)(samples.size()),sampleDuration,double(samples.size()-1)/sampleDuration,predictionTime*1000.0);
+		printf("%-20s %10s %14s %14s %14s\n","Filter","ns/sample","Pos error","Angle error","Pos jitter");
+		
+		/* Evaluate unfiltered samples with finite-difference velocities as the baseline: */
+		{
+		Misc::Timer t;
+		std::vector<TrackerState> states;
+		states.reserve(samples.size());
+		calcFiniteDifferences(samples,states);
+		t.elapse();
+		printResults("Unfiltered",samples,states,predictionTime,synthetic,t.getTime()*1.0e9/double(samples.size()));
+		}
+		
+		/* Evaluate all requested filters: */
+		Misc::ConfigurationFile configFile(configFileName);
+		for(std::vector<std::string>::iterator fsnIt=filterSectionNames.begin();fsnIt!=filterSectionNames.end();++fsnIt)
+			{
+			/* Create the filter: */
+			configFile.setCurrentSection(fsnIt->c_str());
+			VRTrackerFilter* filter=VRTrackerFilter::create(configFile);
+			configFile.setCurrentSection("/");
+			
+			/* Filter all samples at device rate: */
+			std::vector<TrackerState> states;
+			states.reserve(samples.size());
+			for(std::vector<Sample>::iterator sIt=samples.begin();sIt!=samples.end();++sIt)
+				states.push_back(sIt->state);
+			Misc::Timer t;
+			for(size_t i=0;i<samples.size();++i)
+				filter->filter(states[i],VRTrackerFilter::TimeStamp(Math::floor(samples[i].time*1.0e6+0.5)));
+			t.elapse();
+			delete filter;
+			
+			printResults(fsnIt->c_str(),samples,states,predictionTime,synthetic,t.getTime()*1.0e9/double(samples.size()));
+			}
+		}
+	catch(std::runtime_error err)
+		{
+		fprintf(stderr,"%s: Caught exception %s\n",argv[0],err.what());
+		return 1;
+		}
+	
+	return 0;
+	}
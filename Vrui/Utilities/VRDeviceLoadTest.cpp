@@ -0,0 +1,351 @@
+/***********************************************************************
+VRDeviceLoadTest - Program to connect many streaming clients to a Vrui
+VR Device Daemon at once, and to measure end-to-end latency, throughput,
+and dropped updates for each of them.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <Misc/SizedTypes.h>
+#include <Misc/Timer.h>
+#include <Misc/FunctionCalls.h>
+#include <Realtime/Time.h>
+#include <Vrui/Internal/VRDeviceState.h>
+#include <Vrui/Internal/VRDeviceClient.h>
+
+/**************
+Helper classes:
+**************/
+
+struct ClientStats // Structure collecting packet statistics for one device client
+	{
+	/* Embedded classes: */
+	public:
+	static const unsigned int binWidth=10; // Width of fine latency histogram bins in microseconds
+	static const unsigned int numBins=10000; // Number of fine latency histogram bins; latencies beyond go into an overflow bin
+	static const unsigned int numLogBins=24; // Number of power-of-two latency histogram bins, starting at 1 microsecond
+	
+	/* Elements: */
+	int sequenceValuatorIndex; // Index of the valuator carrying the device update sequence number, or -1
+	unsigned int delay; // Time to block in each packet callback in microseconds to simulate a slow client
+	size_t numPackets; // Number of received state packets
+	size_t numStale; // Number of packets that did not contain newer tracker states than the previous one
+	size_t numDropped; // Number of device updates that never reached the client according to sequence numbers
+	bool haveTimeStamp; // Flag whether a tracker time stamp has been received
+	Vrui::VRDeviceState::TimeStamp lastTimeStamp; // Newest tracker time stamp in the previous packet
+	bool haveSequence; // Flag whether a sequence number has been received
+	unsigned int lastSequence; // Sequence number in the previous packet
+	size_t numLatencies; // Number of latency measurements
+	double latencySum; // Sum of all latency measurements in microseconds
+	unsigned int maxLatency; // Maximum latency in microseconds
+	unsigned int bins[numBins+1]; // Fine latency histogram
+	unsigned int logBins[numLogBins]; // Power-of-two latency histogram
+	bool error; // Flag whether the client's connection failed
+	
+	/* Constructors and destructors: */
+	ClientStats(int sSequenceValuatorIndex,unsigned int sDelay)
+		:sequenceValuatorIndex(sSequenceValuatorIndex),delay(sDelay),
+		 numPackets(0),numStale(0),numDropped(0),
+		 haveTimeStamp(false),lastTimeStamp(0),haveSequence(false),lastSequence(0),
+		 numLatencies(0),latencySum(0.0),maxLatency(0),
+		 error(false)
+		{
+		memset(bins,0,sizeof(bins));
+		memset(logBins,0,sizeof(logBins));
+		}
+	
+	/* Methods: */
+	void addLatency(unsigned int latency) // Adds a latency measurement in microseconds
+		{
+		++numLatencies;
+		latencySum+=double(latency);
+		if(maxLatency<latency)
+			maxLatency=latency;
+		unsigned int bin=latency/binWidth;
+		++bins[bin<numBins?bin:numBins];
+		unsigned int logBin=0;
+		while(logBin<numLogBins-1&&latency>=(2U<<logBin))
+			++logBin;
+		++logBins[logBin];
+		}
+	double getPercentile(double percentile) const // Returns the given latency percentile in milliseconds, or -1 if it falls into the overflow bin
+		{
+		size_t threshold=size_t(double(numLatencies)*percentile/100.0+0.5);
+		size_t sum=0;
+		for(unsigned int bin=0;bin<numBins;++bin)
+			{
+			sum+=bins[bin];
+			if(sum>=threshold)
+				return double((bin+1)*binWidth)*1.0e-3;
+			}
+		return -1.0;
+		}
+	};
+
+volatile bool measuring=true; // Flag whether packets are still counted; cleared before streaming is stopped
+
+/****************
+Helper functions:
+****************/
+
+inline Vrui::VRDeviceState::TimeStamp getTimeStamp(void) // Returns a time stamp for the current time from the same clock as the VR device daemon's
+	{
+	Realtime::TimePointMonotonic now;
+	return Vrui::VRDeviceState::TimeStamp(now.tv_sec*1000000+(now.tv_nsec+500)/1000);
+	}
+
+inline int timeStampDiff(Vrui::VRDeviceState::TimeStamp ts1,Vrui::VRDeviceState::TimeStamp ts0) // Returns the difference between two periodic time stamps
+	{
+	return int(Misc::SInt32(Misc::UInt32(ts1)-Misc::UInt32(ts0)));
+	}
+
+void packetCallback(Vrui::VRDeviceClient* client,ClientStats* stats)
+	{
+	/* Ignore packets that are still in flight after the measurement period: */
+	if(!measuring)
+		return;
+	
+	/* Sample the arrival time first: */
+	Vrui::VRDeviceState::TimeStamp arrival=getTimeStamp();
+	
+	/* Find the newest tracker time stamp and the sequence number in the new state: */
+	bool haveTimeStamp=false;
+	Vrui::VRDeviceState::TimeStamp newest=0;
+	float sequence=-1.0f;
+	client->lockState();
+	const Vrui::VRDeviceState& state=client->getState();
+	for(int i=0;i<state.getNumTrackers();++i)
+		if(state.getTrackerValid(i))
+			{
+			Vrui::VRDeviceState::TimeStamp ts=state.getTrackerTimeStamp(i);
+			if(!haveTimeStamp||timeStampDiff(ts,newest)>0)
+				newest=ts;
+			haveTimeStamp=true;
+			}
+	if(stats->sequenceValuatorIndex>=0&&stats->sequenceValuatorIndex<state.getNumValuators())
+		sequence=state.getValuatorState(stats->sequenceValuatorIndex);
+	client->unlockState();
+	
+	++stats->numPackets;
+	if(haveTimeStamp)
+		{
+		if(stats->haveTimeStamp&&newest==stats->lastTimeStamp)
+			++stats->numStale;
+		else
+			{
+			/* Measure the time from the device update to the packet's arrival: */
+			int latency=timeStampDiff(arrival,newest);
+			stats->addLatency(latency>0?(unsigned int)(latency):0U);
+			}
+		stats->haveTimeStamp=true;
+		stats->lastTimeStamp=newest;
+		}
+	if(sequence>=0.0f)
+		{
+		/* Count device updates that were skipped since the previous packet: */
+		unsigned int seq=(unsigned int)(sequence);
+		if(stats->haveSequence)
+			{
+			unsigned int gap=(seq-stats->lastSequence)&0xffffffU;
+			if(gap>1U)
+				stats->numDropped+=gap-1U;
+			}
+		stats->haveSequence=true;
+		stats->lastSequence=seq;
+		}
+	
+	/* Simulate a slow client by blocking the receiving thread: */
+	if(stats->delay>0)
+		usleep(stats->delay);
+	}
+
+void errorCallback(const Vrui::VRDeviceClient::ProtocolError& error,ClientStats* stats)
+	{
+	stats->error=true;
+	fprintf(stderr,"VRDeviceLoadTest: %s\n",error.what());
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	const char* serverNamePort="localhost:8555";
+	int numClients=8;
+	int numSlowClients=0;
+	double slowDelay=20.0;
+	double duration=10.0;
+	int sequenceValuatorIndex=-1;
+	bool printHistograms=false;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-clients")==0&&i+1<argc)
+			numClients=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-slow")==0&&i+2<argc)
+			{
+			numSlowClients=atoi(argv[++i]);
+			slowDelay=atof(argv[++i]);
+			}
+		else if(strcasecmp(argv[i],"-duration")==0&&i+1<argc)
+			duration=atof(argv[++i]);
+		else if(strcasecmp(argv[i],"-sequence")==0&&i+1<argc)
+			sequenceValuatorIndex=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-histogram")==0)
+			printHistograms=true;
+		else if(argv[i][0]!='-')
+			serverNamePort=argv[i];
+		else
+			{
+			fprintf(stderr,"Usage: %s [-clients <num clients>] [-slow <num slow clients> <delay in ms>] [-duration <seconds>] [-sequence <valuator index>] [-histogram] [<serverName:serverPort>]\n",argv[0]);
+			return 1;
+			}
+		}
+	if(numClients<1||numSlowClients<0||numSlowClients>numClients||duration<=0.0)
+		{
+		fprintf(stderr,"%s: Invalid test parameters\n",argv[0]);
+		return 1;
+		}
+	
+	/* Split the server name into hostname:port: */
+	const char* colonPtr=0;
+	for(const char* cPtr=serverNamePort;*cPtr!='\0';++cPtr)
+		if(*cPtr==':')
+			colonPtr=cPtr;
+	std::string serverName;
+	int portNumber=8555;
+	if(colonPtr!=0)
+		{
+		serverName=std::string(serverNamePort,colonPtr);
+		portNumber=atoi(colonPtr+1);
+		}
+	else
+		serverName=serverNamePort;
+	
+	/* Connect all clients; the first clients are the slow ones: */
+	std::vector<Vrui::VRDeviceClient*> clients;
+	std::vector<ClientStats*> stats;
+	int result=0;
+	try
+		{
+		for(int i=0;i<numClients;++i)
+			{
+			stats.push_back(new ClientStats(sequenceValuatorIndex,i<numSlowClients?(unsigned int)(slowDelay*1000.0+0.5):0U));
+			clients.push_back(new Vrui::VRDeviceClient(serverName.c_str(),portNumber));
+			clients.back()->activate();
+			}
+		
+		/* Start streaming on all clients at the same time: */
+		printf("Streaming to %d clients (%d slow) for %.1f s...",numClients,numSlowClients,duration);
+		fflush(stdout);
+		for(int i=0;i<numClients;++i)
+			clients[i]->startStream(Misc::createFunctionCall(packetCallback,stats[i]),Misc::createFunctionCall(errorCallback,stats[i]));
+		Misc::Timer t;
+		Realtime::TimePointMonotonic::sleep(Realtime::TimeVector(duration));
+		measuring=false;
+		t.elapse();
+		
+		/* Stop streaming on all clients; slow clients drain their backlogs without delay: */
+		for(int i=0;i<numClients;++i)
+			{
+			try
+				{
+				clients[i]->stopStream();
+				clients[i]->deactivate();
+				}
+			catch(std::runtime_error err)
+				{
+				stats[i]->error=true;
+				}
+			}
+		printf(" done\n");
+		
+		/* Print per-client statistics: */
+		printf("Client Mode   Packets    Rate/s   Stale  Dropped  Mean ms   p50 ms   p90 ms   p99 ms   Max ms\n");
+		size_t totalPackets[2]={0,0};
+		for(int i=0;i<numClients;++i)
+			{
+			const ClientStats& s=*stats[i];
+			printf("%5d%s %-6s %8u %9.1f %7u",i,s.delay>0?"*":" ",clients[i]->isShared()?"shared":"TCP",(unsigned int)s.numPackets,double(s.numPackets)/t.getTime(),(unsigned int)s.numStale);
+			if(sequenceValuatorIndex>=0)
+				printf(" %8u",(unsigned int)s.numDropped);
+			else
+				printf("      n/a");
+			if(s.numLatencies>0)
+				{
+				printf(" %8.3f",s.latencySum*1.0e-3/double(s.numLatencies));
+				double percentiles[3]={50.0,90.0,99.0};
+				for(int j=0;j<3;++j)
+					{
+					double p=s.getPercentile(percentiles[j]);
+					if(p>=0.0)
+						printf(" %8.3f",p);
+					else
+						printf("  >%6.1f",double(ClientStats::numBins*ClientStats::binWidth)*1.0e-3);
+					}
+				printf(" %8.3f",double(s.maxLatency)*1.0e-3);
+				}
+			if(s.error)
+				printf("  connection failed");
+			printf("\n");
+			totalPackets[s.delay>0?1:0]+=s.numPackets;
+			}
+		if(numSlowClients<numClients)
+			printf("Total throughput to %d regular clients: %.1f packets/s\n",numClients-numSlowClients,double(totalPackets[0])/t.getTime());
+		if(numSlowClients>0)
+			printf("Total throughput to %d slow clients (*): %.1f packets/s\n",numSlowClients,double(totalPackets[1])/t.getTime());
+		
+		if(printHistograms)
+			{
+			/* Print per-client power-of-two latency histograms: */
+			for(int i=0;i<numClients;++i)
+				{
+				printf("Client %d latency histogram:\n",i);
+				const ClientStats& s=*stats[i];
+				for(unsigned int bin=0;bin<ClientStats::numLogBins;++bin)
+					if(s.logBins[bin]>0)
+						{
+						if(bin==0)
+							printf("           < %8u us: %u\n",2U,s.logBins[bin]);
+						else if(bin==ClientStats::numLogBins-1)
+							printf("  >= %8u us        : %u\n",1U<<bin,s.logBins[bin]);
+						else
+							printf("  %8u - %8u us: %u\n",1U<<bin,2U<<bin,s.logBins[bin]);
+						}
+				}
+			}
+		}
+	catch(std::runtime_error err)
+		{
+		fprintf(stderr,"%s: Caught exception %s\n",argv[0],err.what());
+		result=1;
+		}
+	
+	/* Disconnect all clients: */
+	for(std::vector<Vrui::VRDeviceClient*>::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		delete *cIt;
+	for(std::vector<ClientStats*>::iterator sIt=stats.begin();sIt!=stats.end();++sIt)
+		delete *sIt;
+	
+	return result;
+	}
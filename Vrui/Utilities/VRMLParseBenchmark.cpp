@@ -0,0 +1,225 @@
+/***********************************************************************
+VRMLParseBenchmark - Program to measure the throughput of the VRML 2.0
+parser on generated large files, with and without binary cache files.
+Copyright (c) 2018 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <string>
+#include <stdexcept>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <IO/TokenSource.h>
+#include <SceneGraph/GroupNode.h>
+#include <SceneGraph/NodeCreator.h>
+#include <SceneGraph/VRMLFile.h>
+
+/****************
+Helper functions:
+****************/
+
+void generateFile(const char* fileName,unsigned int gridSize)
+	{
+	FILE* file=fopen(fileName,"wt");
+	if(file==0)
+		throw std::runtime_error("Unable to create test file");
+	
+	/* Write a single shape with a wavy grid surface using all multi-valued geometry fields: */
+	fprintf(file,"#VRML V2.0 utf8\n\n");
+	fprintf(file,"# Generated by VRMLParseBenchmark\n");
+	fprintf(file,"Shape\n\t{\n\tappearance Appearance { material Material { diffuseColor 0.8 0.8 0.8 } }\n");
+	fprintf(file,"\tgeometry IndexedFaceSet\n\t\t{\n");
+	
+	fprintf(file,"\t\tcoord Coordinate\n\t\t\t{\n\t\t\tpoint\n\t\t\t\t[\n");
+	for(unsigned int y=0;y<gridSize;++y)
+		for(unsigned int x=0;x<gridSize;++x)
+			{
+			double px=double(x)/double(gridSize-1);
+			double py=double(y)/double(gridSize-1);
+			double pz=0.1*Math::sin(px*4.0*Math::Constants<double>::pi)*Math::cos(py*3.0*Math::Constants<double>::pi);
+			fprintf(file,"\t\t\t\t%.7g %.7g %.7g,\n",px*100.0,py*100.0,pz*100.0);
+			}
+	fprintf(file,"\t\t\t\t]\n\t\t\t}\n");
+	
+	fprintf(file,"\t\tcolor Color\n\t\t\t{\n\t\t\tcolor\n\t\t\t\t[\n");
+	for(unsigned int y=0;y<gridSize;++y)
+		for(unsigned int x=0;x<gridSize;++x)
+			fprintf(file,"\t\t\t\t%.4f %.4f %.4f,\n",double(x)/double(gridSize-1),double(y)/double(gridSize-1),0.5);
+	fprintf(file,"\t\t\t\t]\n\t\t\t}\n");
+	
+	fprintf(file,"\t\ttexCoord TextureCoordinate\n\t\t\t{\n\t\t\tpoint\n\t\t\t\t[\n");
+	for(unsigned int y=0;y<gridSize;++y)
+		for(unsigned int x=0;x<gridSize;++x)
+			fprintf(file,"\t\t\t\t%.6f %.6f,\n",double(x)/double(gridSize-1),double(y)/double(gridSize-1));
+	fprintf(file,"\t\t\t\t]\n\t\t\t}\n");
+	
+	fprintf(file,"\t\tcoordIndex\n\t\t\t[\n");
+	for(unsigned int y=0;y<gridSize-1;++y)
+		for(unsigned int x=0;x<gridSize-1;++x)
+			{
+			unsigned int i=y*gridSize+x;
+			fprintf(file,"\t\t\t%u, %u, %u, %u, -1,\n",i,i+1,i+gridSize+1,i+gridSize);
+			}
+	fprintf(file,"\t\t\t]\n");
+	
+	fprintf(file,"\t\t}\n\t}\n");
+	fclose(file);
+	}
+
+double timeTokenizer(const char* fileName,bool scanNumbers,size_t& numNumbers)
+	{
+	/* Set up a token source the same way as the VRML parser: */
+	Misc::Timer t;
+	IO::TokenSource tok(IO::openFile(fileName));
+	tok.setWhitespace(',',true);
+	tok.setPunctuation("#[]{}\n");
+	tok.setQuotes("\"\'");
+	
+	/* Read all tokens, converting all numbers: */
+	numNumbers=0;
+	double sum=0.0;
+	while(!tok.eof())
+		{
+		int c=tok.peekc();
+		bool isNumber=(c>='0'&&c<='9')||c=='-'||c=='+'||c=='.';
+		if(isNumber&&scanNumbers)
+			{
+			/* Scan the number directly from the character source: */
+			double value;
+			if(tok.readNumber(value))
+				sum+=value;
+			++numNumbers;
+			}
+		else
+			{
+			/* Read a token, and convert it to a number the same way the VRML parser used to: */
+			const char* token=tok.readNextToken();
+			if(isNumber)
+				{
+				sum+=strtod(token,0);
+				++numNumbers;
+				}
+			}
+		}
+	t.elapse();
+	
+	/* Use the sum of values to prevent the compiler from optimizing the conversions away: */
+	if(sum==Math::Constants<double>::max)
+		printf("Checksum: %f\n",sum);
+	
+	return t.getTime();
+	}
+
+double timeParser(const char* fileName,bool useCache,SceneGraph::NodeCreator& nodeCreator)
+	{
+	Misc::Timer t;
+	SceneGraph::GroupNodePointer root=new SceneGraph::GroupNode;
+	SceneGraph::VRMLFile vrmlFile(fileName,IO::openFile(fileName),nodeCreator);
+	vrmlFile.setUseCache(useCache);
+	vrmlFile.parse(root);
+	t.elapse();
+	
+	return t.getTime();
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	const char* fileName=0;
+	unsigned int gridSize=1024;
+	bool keepFiles=false;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-size")==0&&i+1<argc)
+			gridSize=(unsigned int)(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-keep")==0)
+			keepFiles=true;
+		else if(fileName==0)
+			fileName=argv[i];
+		else
+			{
+			fprintf(stderr,"Usage: %s [-size <grid size>] [-keep] [<test file name>]\n",argv[0]);
+			return 1;
+			}
+		}
+	if(gridSize<2)
+		{
+		fprintf(stderr,"%s: Invalid grid size\n",argv[0]);
+		return 1;
+		}
+	std::string testFileName=fileName!=0?fileName:"VRMLParseBenchmark.wrl";
+	std::string cacheFileName=testFileName+".cache";
+	
+	try
+		{
+		/* Generate the test file: */
+		printf("Generating %ux%u grid test file %s...",gridSize,gridSize,testFileName.c_str());
+		fflush(stdout);
+		generateFile(testFileName.c_str(),gridSize);
+		unlink(cacheFileName.c_str());
+		struct stat fileStat;
+		stat(testFileName.c_str(),&fileStat);
+		double fileMB=double(fileStat.st_size)/(1024.0*1024.0);
+		printf(" done, %.3f MB\n",fileMB);
+		
+		/* Measure the raw tokenizer with the old and new number conversions: */
+		size_t numNumbers;
+		double tokenTime=timeTokenizer(testFileName.c_str(),false,numNumbers);
+		printf("Tokenize + strtod:   %8.3f s, %8.3f MB/s, %8.3f M numbers/s\n",tokenTime,fileMB/tokenTime,double(numNumbers)*1.0e-6/tokenTime);
+		double scanTime=timeTokenizer(testFileName.c_str(),true,numNumbers);
+		printf("Scan numbers:        %8.3f s, %8.3f MB/s, %8.3f M numbers/s\n",scanTime,fileMB/scanTime,double(numNumbers)*1.0e-6/scanTime);
+		
+		/* Measure the full VRML parser without and with cache files: */
+		SceneGraph::NodeCreator nodeCreator;
+		double parseTime=timeParser(testFileName.c_str(),false,nodeCreator);
+		printf("Parse:               %8.3f s, %8.3f MB/s\n",parseTime,fileMB/parseTime);
+		double recordTime=timeParser(testFileName.c_str(),true,nodeCreator);
+		printf("Parse + write cache: %8.3f s, %8.3f MB/s\n",recordTime,fileMB/recordTime);
+		double replayTime=timeParser(testFileName.c_str(),true,nodeCreator);
+		printf("Load from cache:     %8.3f s, %8.3f MB/s\n",replayTime,fileMB/replayTime);
+		}
+	catch(std::runtime_error err)
+		{
+		fprintf(stderr,"%s: Caught exception %s\n",argv[0],err.what());
+		if(!keepFiles)
+			{
+			unlink(testFileName.c_str());
+			unlink(cacheFileName.c_str());
+			}
+		return 1;
+		}
+	
+	/* Clean up: */
+	if(!keepFiles)
+		{
+		unlink(testFileName.c_str());
+		unlink(cacheFileName.c_str());
+		}
+	
+	return 0;
+	}
@@ -95,6 +95,8 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/Internal/LensCorrector.h>
 #include <Vrui/Internal/ToolKillZone.h>
 #include <Vrui/Internal/MovieSaver.h>
+#include <Vrui/Internal/FrameProfiler.h>
+#include <Vrui/Internal/LateLatcher.h>
 #include <Vrui/Internal/Vrui.h>
 #include <Vrui/Internal/Config.h>
 #if VRUI_INTERNAL_CONFIG_HAVE_XRANDR
@@ -265,6 +267,22 @@ extern int frameTimeIndex;
 Methods of class VRWindow:
 *************************/
 
+void* VRWindow::screenshotWritingThreadMethod(VRWindow::ScreenshotRequest* request)
+	{
+	try
+		{
+		/* Save the image buffer to the requested image file: */
+		Images::writeImageFile(request->image,request->imageFileName.c_str());
+		}
+	catch(std::runtime_error err)
+		{
+		Misc::formattedConsoleError("Vrui::VRWindow: Unable to write screen shot %s due to exception %s",request->imageFileName.c_str(),err.what());
+		}
+	
+	delete request;
+	return 0;
+	}
+
 void VRWindow::moveWindow(const NavTransform& transform)
 	{
 	/* Update display center and size: */
@@ -702,7 +720,7 @@ VRWindow::VRWindow(GLContext* sContext,const OutputConfiguration& sOutputConfigu
 	 trackToolKillZone(false),
 	 dirty(true),
 	 resizeViewport(true),
-	 saveScreenshot(false),
+	 saveScreenshot(false),writeScreenshotInBackground(false),
 	 movieSaver(0)
 	{
 	/* Update the X window's event mask: */
@@ -1380,6 +1398,10 @@ void VRWindow::setViewer(Viewer* newViewer)
 void VRWindow::deinit(void)
 	{
 	makeCurrent();
+	if(vruiState->frameProfiler!=0)
+		vruiState->frameProfiler->releaseWindow(windowIndex);
+	if(movieSaver!=0)
+		movieSaver->releaseGL();
 	if(windowType==INTERLEAVEDVIEWPORT_STEREO)
 		{
 		if(hasFramebufferObjectExtension)
@@ -1914,6 +1936,7 @@ bool VRWindow::processEvent(const XEvent& event)
 				else if(screenshotKey.matches(keySym,keyEvent.state))
 					{
 					saveScreenshot=true;
+					writeScreenshotInBackground=true;
 					char numberedFileName[256];
 					#if IMAGES_CONFIG_HAVE_PNG
 					/* Save the screenshot as a PNG file: */
@@ -2036,6 +2059,7 @@ void VRWindow::requestScreenshot(const char* sScreenshotImageFileName)
 	{
 	/* Set the screenshot flag and remember the given image file name: */
 	saveScreenshot=true;
+	writeScreenshotInBackground=false;
 	screenshotImageFileName=sScreenshotImageFileName;
 	}
 
@@ -2049,6 +2073,14 @@ void VRWindow::draw(void)
 	/* Activate the window's OpenGL context: */
 	makeCurrent();
 	
+	/* Start timing the window's rendering: */
+	if(vruiState->frameProfiler!=0)
+		vruiState->frameProfiler->startWindow(windowIndex);
+	
+	/* Re-sample tracked input devices immediately before setting up the window's projections: */
+	if(vruiState->lateLatcher!=0)
+		vruiState->lateLatcher->latchWindow();
+	
 	/* Check if the window's viewport needs to be resized: */
 	if(resizeViewport)
 		{
@@ -2365,14 +2397,30 @@ void VRWindow::draw(void)
 	/* Take a screen shot if requested: */
 	if(saveScreenshot)
 		{
-		/* Create an RGB image of the same size as the window: */
-		Images::RGBImage image(getWindowWidth(),getWindowHeight());
-		
-		/* Read the window contents into an RGB image: */
-		image.glReadPixels(0,0);
-		
-		/* Save the image buffer to the given image file: */
-		Images::writeImageFile(image,screenshotImageFileName.c_str());
+		if(writeScreenshotInBackground)
+			{
+			/* Wait for the previous screen shot to be written: */
+			if(!screenshotWritingThread.isJoined())
+				screenshotWritingThread.join();
+			
+			/* Read the window contents into an RGB image owned by a new screen shot request: */
+			ScreenshotRequest* request=new ScreenshotRequest(getWindowWidth(),getWindowHeight(),screenshotImageFileName);
+			request->image.glReadPixels(0,0);
+			
+			/* Write the image file in the background to not stall rendering: */
+			screenshotWritingThread.start(this,&VRWindow::screenshotWritingThreadMethod,request);
+			}
+		else
+			{
+			/* Create an RGB image of the same size as the window: */
+			Images::RGBImage image(getWindowWidth(),getWindowHeight());
+			
+			/* Read the window contents into an RGB image: */
+			image.glReadPixels(0,0);
+			
+			/* Save the image buffer to the given image file: */
+			Images::writeImageFile(image,screenshotImageFileName.c_str());
+			}
 		
 		#if SAVE_SCREENSHOT_PROJECTION
 		
@@ -2405,24 +2453,14 @@ void VRWindow::draw(void)
 	/* Check if the window is supposed to save a movie: */
 	if(movieSaver!=0)
 		{
-		/* Get a fresh frame buffer: */
-		MovieSaver::FrameBuffer& frameBuffer=movieSaver->startNewFrame();
-		
-		/* Update the frame buffer's size and prepare it for writing: */
-		frameBuffer.setFrameSize(getWindowWidth(),getWindowHeight());
-		frameBuffer.prepareWrite();
-		
-		/* Read the window contents into the movie saver's frame buffer: */
-		glPixelStorei(GL_PACK_ALIGNMENT,1);
-		glPixelStorei(GL_PACK_SKIP_PIXELS,0);
-		glPixelStorei(GL_PACK_ROW_LENGTH,0);
-		glPixelStorei(GL_PACK_SKIP_ROWS,0);
-		glReadPixels(0,0,getWindowWidth(),getWindowHeight(),GL_RGB,GL_UNSIGNED_BYTE,frameBuffer.getBuffer());
-		
-		/* Post the new frame: */
-		movieSaver->postNewFrame();
+		/* Read the window contents into the movie saver; the frame will be retrieved asynchronously if possible: */
+		movieSaver->captureFrame(getWindowWidth(),getWindowHeight());
 		}
 	
+	/* Finish timing the window's rendering: */
+	if(vruiState->frameProfiler!=0)
+		vruiState->frameProfiler->finishWindow(windowIndex);
+	
 	/* Window is now up-to-date: */
 	resizeViewport=false;
 	dirty=false;
@@ -27,11 +27,13 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <string>
 #include <Realtime/Time.h>
+#include <Threads/Thread.h>
 #include <Geometry/ComponentArray.h>
 #include <Geometry/Point.h>
 #include <Geometry/Ray.h>
 #include <GL/gl.h>
 #include <GL/GLWindow.h>
+#include <Images/RGBImage.h>
 #include <Vrui/Geometry.h>
 #include <Vrui/KeyMapper.h>
 #include <Vrui/GetOutputConfiguration.h>
@@ -73,8 +75,22 @@ class VRWindow:public GLWindow
 		};
 	typedef Realtime::TimePointMonotonic Time; // Type to measure frame times
 	
-	/* Elements: */
 	private:
+	struct ScreenshotRequest // Structure holding a screen shot to be written by a background thread
+		{
+		/* Elements: */
+		public:
+		Images::RGBImage image; // The screen shot image
+		std::string imageFileName; // Name of the image file to write
+		
+		/* Constructors and destructors: */
+		ScreenshotRequest(unsigned int width,unsigned int height,const std::string& sImageFileName) // Creates an uninitialized image of the given size
+			:image(width,height),imageFileName(sImageFileName)
+			{
+			}
+		};
+	
+	/* Elements: */
 	VruiState* vruiState; // Pointer to the Vrui state object this window belongs to
 	int windowIndex; // Index of this window in the environment's total window list
 	VruiWindowGroup* windowGroup; // Pointer to the window group to which this window belongs
@@ -147,11 +163,14 @@ class VRWindow:public GLWindow
 	bool dirty; // Flag if the window needs to be redrawn
 	bool resizeViewport; // Flag if the window's OpenGL viewport needs to be resized on the next draw() call
 	bool saveScreenshot; // Flag if the window is to save its contents after the next draw() call
+	bool writeScreenshotInBackground; // Flag whether the next screen shot's image file is written by a background thread
 	std::string screenshotImageFileName; // Name of the image file into which to save the next screen shot
+	Threads::Thread screenshotWritingThread; // Background thread writing the image file of the most recent interactive screen shot
 	MovieSaver* movieSaver; // Pointer to a movie saver object if the window is supposed to write contents to a movie
 	Time lastFrame; // Time at which the last frame was exposed in front-buffer rendering mode
 	
 	/* Private methods: */
+	void* screenshotWritingThreadMethod(ScreenshotRequest* request); // Writes the given screen shot and deletes the request
 	void moveWindow(const NavTransform& transform); // Applies the given window transformation due to panning or scaling to derived window state
 	void render(const GLWindow::WindowPos& viewportPos,int screenIndex,const Point& eye,bool canRender); // Renders the view of the given eye onto the given screen
 	
@@ -226,7 +245,11 @@ class VRWindow:public GLWindow
 		{
 		return dirty;
 		}
-	void requestScreenshot(const char* sScreenshotImageFileName); // Asks the window to save its contents to the given image file on the next render pass
+	void requestScreenshot(const char* sScreenshotImageFileName); // Asks the window to save its contents to the given image file on the next render pass; image file is complete when the render pass returns
+	const MovieSaver* getMovieSaver(void) const // Returns the window's movie saver, or null if the window is not saving a movie
+		{
+		return movieSaver;
+		}
 	void draw(void); // Redraws the window's contents
 	void swapBuffers(void); // Overridden method from GLWindow
 	};
@@ -24,6 +24,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Vrui/Vislets/Filming.h>
 
+#include <stdio.h>
 #include <vector>
 #include <Misc/SelfDestructPointer.h>
 #include <Misc/SelfDestructArray.h>
@@ -59,6 +60,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/VRWindow.h>
 #include <Vrui/InputGraphManager.h>
 #include <Vrui/VisletManager.h>
+#include <Vrui/Internal/MovieSaver.h>
 
 namespace Vrui {
 
@@ -804,6 +806,25 @@ void Filming::buildFilmingControls(void)
 	
 	toggleBox->manageChild();
 	
+	/* Create labels to show the capture statistics of all windows that are saving movies: */
+	movieStatisticsLabels=new GLMotif::Label*[getNumWindows()];
+	for(int windowIndex=0;windowIndex<getNumWindows();++windowIndex)
+		{
+		movieStatisticsLabels[windowIndex]=0;
+		if(getWindow(windowIndex)!=0&&getWindow(windowIndex)->getMovieSaver()!=0)
+			{
+			char labelName[40];
+			snprintf(labelName,sizeof(labelName),"MovieCaptureLabel%d",windowIndex);
+			char labelText[40];
+			snprintf(labelText,sizeof(labelText),"Movie Capture %d",windowIndex+1);
+			new GLMotif::Label(labelName,filmingControls,labelText);
+			
+			snprintf(labelName,sizeof(labelName),"MovieStatisticsLabel%d",windowIndex);
+			movieStatisticsLabels[windowIndex]=new GLMotif::Label(labelName,filmingControls,"");
+			movieStatisticsLabels[windowIndex]->setHAlignment(GLFont::Left);
+			}
+		}
+	
 	/* Create buttons to load or save the vislet's current state: */
 	new GLMotif::Blind("IOBoxBlind",filmingControls);
 	GLMotif::RowColumn* ioBox=new GLMotif::RowColumn("IOBox",filmingControls,false);
@@ -841,7 +862,8 @@ Filming::Filming(int numArguments,const char* const arguments[])
 	 drawGrid(false),gridDragger(0),
 	 drawDevices(false),
 	 autoActivate(false),
-	 dialogWindow(0)
+	 dialogWindow(0),
+	 movieStatisticsLabels(0)
 	{
 	/* Parse the command line: */
 	for(int i=0;i<numArguments;++i)
@@ -879,6 +901,7 @@ Filming::~Filming(void)
 	delete[] windowFilmings;
 	delete[] originalHeadlightStates;
 	delete[] headlightStates;
+	delete[] movieStatisticsLabels;
 	}
 
 VisletFactory* Filming::getFactory(void) const
@@ -981,6 +1004,19 @@ void Filming::frame(void)
 	{
 	/* Update the filming viewer: */
 	viewer->update();
+	
+	/* Update the capture statistics of all windows that are saving movies: */
+	if(movieStatisticsLabels!=0)
+		{
+		for(int windowIndex=0;windowIndex<getNumWindows();++windowIndex)
+			if(movieStatisticsLabels[windowIndex]!=0)
+				{
+				MovieSaver::Statistics stats=getWindow(windowIndex)->getMovieSaver()->getStatistics();
+				char statsText[128];
+				snprintf(statsText,sizeof(statsText),"%u written, %u queued, %u dropped, encode %.1f ms (max %.1f ms)",stats.numWrittenFrames,stats.numQueuedFrames+stats.numPendingReadbacks,stats.numSkippedFrames+stats.numDroppedFrames,stats.averageEncodeTime*1000.0,stats.maxEncodeTime*1000.0);
+				movieStatisticsLabels[windowIndex]->setString(statsText);
+				}
+		}
 	}
 
 void Filming::display(GLContextData& contextData) const
@@ -45,6 +45,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 namespace GLMotif {
 class PopupWindow;
 class RowColumn;
+class Label;
 class Button;
 class FileSelectionHelper;
 }
@@ -204,6 +205,7 @@ class Filming:public Vrui::Vislet
 	GLMotif::HSVColorSelector* backgroundColorSelector; // Color selector to change the background color
 	GLMotif::ToggleButton* drawGridToggle;
 	GLMotif::ToggleButton* drawDevicesToggle;
+	GLMotif::Label** movieStatisticsLabels; // Array of labels showing movie capture statistics of all windows; entries are null for windows not saving movies
 	
 	/* Private methods: */
 	void changeViewerMode(void); // Updates the GUI after a viewer mode change
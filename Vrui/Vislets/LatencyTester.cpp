@@ -283,13 +283,13 @@ void* LatencyTester::communicationThreadMethod(void)
 					
 					if(testState==WAITING_BLACK)
 						{
-						std::cout<<"White to black: "<<elapsed<<"ms"<<std::endl;
+						std::cout<<"White to black: "<<elapsed<<"ms, estimated motion-to-photon latency: "<<Vrui::getMotionToPhotonLatency()*1000.0<<"ms"<<std::endl;
 						testState=PREPARE_WHITE1;
 						Vrui::requestUpdate();
 						}
 					else if(testState==WAITING_WHITE)
 						{
-						std::cout<<"Black to white: "<<elapsed<<"ms"<<std::endl;
+						std::cout<<"Black to white: "<<elapsed<<"ms, estimated motion-to-photon latency: "<<Vrui::getMotionToPhotonLatency()*1000.0<<"ms"<<std::endl;
 						testState=PREPARE_BLACK1;
 						Vrui::requestUpdate();
 						}
@@ -24,13 +24,11 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/Vislets/SceneGraphViewer.h>
 
 #include <string.h>
+#include <string>
 #include <GL/gl.h>
 #include <GL/GLTransformationWrappers.h>
-#include <SceneGraph/NodeCreator.h>
-#include <SceneGraph/VRMLFile.h>
 #include <Vrui/Vrui.h>
 #include <Vrui/Viewer.h>
-#include <Vrui/OpenFile.h>
 #include <Vrui/VisletManager.h>
 #include <Vrui/SceneGraphSupport.h>
 
@@ -107,16 +105,32 @@ SceneGraphViewerFactory* SceneGraphViewer::factory=0;
 Methods of class SceneGraphViewer:
 *********************************/
 
-SceneGraphViewer::SceneGraphViewer(int numArguments,const char* const arguments[])
-	:navigational(true)
+void SceneGraphViewer::loadCallback(Misc::CallbackData* cbData)
 	{
-	/* Create a node creator: */
-	SceneGraph::NodeCreator nodeCreator;
+	SceneGraph::AsyncVRMLLoader::LoadCallbackData* myCbData=static_cast<SceneGraph::AsyncVRMLLoader::LoadCallbackData*>(cbData);
 	
+	/* Report load failures: */
+	if(myCbData->failed)
+		{
+		std::string message="Could not load VRML file ";
+		message.append(myCbData->url);
+		message.append(" due to exception ");
+		message.append(myCbData->errorMessage);
+		showErrorMessage("SceneGraphViewer",message.c_str());
+		}
+	}
+
+SceneGraphViewer::SceneGraphViewer(int numArguments,const char* const arguments[])
+	:loader(nodeCreator,getClusterMultiplexer()),
+	 navigational(true)
+	{
 	/* Create the scene graph's root node: */
 	root=new SceneGraph::GroupNode;
 	
-	/* Load all VRML files from the command line: */
+	/* Report load failures: */
+	loader.getLoadCallbacks().add(this,&SceneGraphViewer::loadCallback);
+	
+	/* Load all VRML files from the command line in the background: */
 	for(int i=0;i<numArguments;++i)
 		{
 		if(arguments[i][0]=='-')
@@ -126,8 +140,7 @@ SceneGraphViewer::SceneGraphViewer(int numArguments,const char* const arguments[
 			}
 		else
 			{
-			SceneGraph::VRMLFile vrmlFile(arguments[i],Vrui::openFile(arguments[i]),nodeCreator,getClusterMultiplexer());
-			vrmlFile.parse(root);
+			root->children.appendValue(loader.load(arguments[i]));
 			}
 		}
 	}
@@ -141,6 +154,24 @@ VisletFactory* SceneGraphViewer::getFactory(void) const
 	return factory;
 	}
 
+void SceneGraphViewer::frame(void)
+	{
+	/* Graft all VRML files that finished loading: */
+	if(loader.update())
+		{
+		/* Update the root node to account for the grafted scene graphs' extents: */
+		root->update();
+		
+		/* Render a new frame if the vislet is active: */
+		if(isActive())
+			requestUpdate();
+		}
+	
+	/* Keep checking for VRML files that are still loading: */
+	if(loader.getNumPendingRequests()>0)
+		scheduleUpdate(getApplicationTime()+0.1);
+	}
+
 void SceneGraphViewer::display(GLContextData& contextData) const
 	{
 	/* Save OpenGL state: */
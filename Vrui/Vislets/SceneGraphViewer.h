@@ -25,6 +25,8 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #define VRUI_VISLETS_SCENEGRAPHVIEWER_INCLUDED
 
 #include <SceneGraph/GroupNode.h>
+#include <SceneGraph/NodeCreator.h>
+#include <SceneGraph/AsyncVRMLLoader.h>
 #include <Vrui/Vislet.h>
 
 /* Forward declarations: */
@@ -59,9 +61,14 @@ class SceneGraphViewer:public Vrui::Vislet
 	/* Elements: */
 	static SceneGraphViewerFactory* factory; // Pointer to the factory object for this class
 	
+	SceneGraph::NodeCreator nodeCreator; // Node creator to parse VRML files
+	SceneGraph::AsyncVRMLLoader loader; // Loader to load VRML files in the background
 	SceneGraph::GroupNodePointer root; // The scene graph root node
 	bool navigational; // Flag whether to render the scene graph in navigational or physical coordinates
 	
+	/* Private methods: */
+	void loadCallback(Misc::CallbackData* cbData); // Callback called when a VRML file has been loaded
+	
 	/* Constructors and destructors: */
 	public:
 	SceneGraphViewer(int numArguments,const char* const arguments[]);
@@ -70,6 +77,7 @@ class SceneGraphViewer:public Vrui::Vislet
 	/* Methods: */
 	public:
 	virtual VisletFactory* getFactory(void) const;
+	virtual void frame(void);
 	virtual void display(GLContextData& contextData) const;
 	};
 
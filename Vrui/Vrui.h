@@ -279,6 +279,7 @@ Misc::Time getTimeOfDay(void); // Returns the system's wall clock time; requires
 double getApplicationTime(void); // Returns the time since the application was started in seconds; is identical throughout a Vrui frame and across a cluster
 double getFrameTime(void); // Returns the duration of the last frame in seconds
 double getCurrentFrameTime(void); // Returns the current average time between frames (1/framerate) in seconds
+double getMotionToPhotonLatency(void); // Returns the main viewer's average estimated motion-to-photon latency in seconds if latency measurement is enabled, or 0.0
 double getNextAnimationTime(void); // Returns the application time at which the next frame in a general animation should be scheduled
 void addFrameCallback(FrameCallback newFrameCallback,void* newFrameCallbackUserData); // Adds a callback that is called once on every frame; can be called from background threads; callback is removed again if it returns true; can be called from background threads
 